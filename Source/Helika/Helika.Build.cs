@@ -71,6 +71,17 @@ public class Helika : ModuleRules
 		
 		AddEngineThirdPartyPrivateStaticDependencies(Target, "OpenSSL");
 
+		// Curl transport, the engine links libcurl for its own HTTP module on these platforms
+		if (Target.Platform == UnrealTargetPlatform.Linux || Target.Platform == UnrealTargetPlatform.LinuxArm64)
+		{
+			AddEngineThirdPartyPrivateStaticDependencies(Target, "libcurl");
+			PrivateDefinitions.Add("HELIKA_WITH_CURL=1");
+		}
+		else
+		{
+			PrivateDefinitions.Add("HELIKA_WITH_CURL=0");
+		}
+
 		if (Target.Platform == UnrealTargetPlatform.IOS)
 		{
 			PublicFrameworks.AddRange(new string[]
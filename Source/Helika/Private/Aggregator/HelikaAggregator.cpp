@@ -0,0 +1,878 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaAggregator.h"
+
+#include "HelikaAcknowledgement.h"
+#include "HelikaClock.h"
+#include "HelikaColumnarBatch.h"
+#include "HelikaDefines.h"
+#include "HelikaSidecarTransport.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+#if HELIKA_WITH_SIDECAR
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace HelikaAggregator
+{
+	static constexpr int32 PollTimeoutMs = 50;
+	static constexpr int32 ReceiveChunkBytes = 256 << 10;
+	static const TCHAR* RouteFileName = TEXT("route.txt");
+
+	static const FString* FindHeader(const TArray<TPair<FString, FString>>& Headers, const TCHAR* Name)
+	{
+		for (const TPair<FString, FString>& Header : Headers)
+		{
+			if (Header.Key.Equals(Name, ESearchCase::IgnoreCase))
+			{
+				return &Header.Value;
+			}
+		}
+		return nullptr;
+	}
+
+	/// Merged batches are compressed once for the whole host, worth the slower, denser setting
+	static bool CompressBatch(TArray<uint8>& Payload)
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Gzip, Payload.Num());
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(CompressedSize);
+		if (!FCompression::CompressMemory(NAME_Gzip, Compressed.GetData(), CompressedSize, Payload.GetData(), Payload.Num(), COMPRESS_BiasSize) || CompressedSize >= Payload.Num())
+		{
+			return false;
+		}
+		Compressed.SetNum(CompressedSize, false);
+		Payload = MoveTemp(Compressed);
+		return true;
+	}
+
+#if HELIKA_WITH_SIDECAR
+	/// Creates the directory of the socket when it is missing, reachable by this user only
+	static bool MakeSocketDirectory(const FString& Directory)
+	{
+		const FTCHARToUTF8 Path(*Directory);
+		struct stat Info;
+		if (stat(Path.Get(), &Info) != 0)
+		{
+			IFileManager::Get().MakeDirectory(*FPaths::GetPath(Directory), true);
+			if (mkdir(Path.Get(), S_IRWXU) != 0 && errno != EEXIST)
+			{
+				UE_LOG(LogHelika, Error, TEXT("Aggregator could not create the socket directory %s: %s"), *Directory, UTF8_TO_TCHAR(strerror(errno)));
+				return false;
+			}
+		}
+		else if ((Info.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+		{
+			UE_LOG(LogHelika, Warning, TEXT("Aggregator socket directory %s is writable by other users, prefer a directory only this user can reach"), *Directory);
+		}
+		return true;
+	}
+#endif
+}
+
+void FHelikaAggregator::FBatch::AddEvent(TConstArrayView<uint8> Event, uint8 Attempt)
+{
+	if (Ranges.Num() == 0)
+	{
+		OpenedAt = FPlatformTime::Seconds();
+	}
+	else
+	{
+		Events.Add(',');
+	}
+	Ranges.Emplace(Events.Num(), Event.Num());
+	Events.Append(Event.GetData(), Event.Num());
+	Attempts.Add(Attempt);
+}
+
+FHelikaAggregator::FHelikaAggregator(const FHelikaAggregatorConfig& InConfig, const FHelikaTransportPtr& InTransport)
+	: Config(InConfig)
+	, SocketPath(InConfig.SocketPath.IsEmpty() ? FHelikaSidecarFrame::GetDefaultSocketPath() : InConfig.SocketPath)
+	, Transport(InTransport)
+{
+	if (Config.SpillDirectory.IsEmpty())
+	{
+		Config.SpillDirectory = FPaths::ProjectSavedDir() / TEXT("Helika") / TEXT("AggregatorSpill");
+	}
+	if (!Transport.IsValid())
+	{
+		// Uploading to itself would never reach the collector
+		FHelikaTransportConfig TransportConfig = Config.Transport;
+		if (TransportConfig.Kind == EHelikaTransport::HT_Sidecar)
+		{
+			TransportConfig.Kind = EHelikaTransport::HT_Curl;
+		}
+		Transport = IHelikaTransport::Create(TransportConfig);
+	}
+}
+
+FHelikaAggregator::~FHelikaAggregator()
+{
+	Stop();
+
+	// Uploads torn down with the transport complete unanswered, their batches wait on disk for the next run
+	Transport.Reset();
+	TUniquePtr<FUpload> Upload;
+	while (Completed->Dequeue(Upload))
+	{
+		FScopeLock Lock(&RoutesLock);
+		if (const FRoute* Route = Routes.Find(Upload->RouteKey); Route != nullptr && !Upload->Spilled.IsSet())
+		{
+			Spill(MakeRouteBatch(Upload->RouteKey, *Route, MoveTemp(Upload->Batch)));
+		}
+	}
+}
+
+bool FHelikaAggregator::Start()
+{
+#if HELIKA_WITH_SIDECAR
+	LoadSpilledRoutes();
+
+	sockaddr_un Address;
+	FMemory::Memzero(Address);
+	Address.sun_family = AF_UNIX;
+	const FTCHARToUTF8 Path(*SocketPath);
+	if (Path.Length() >= static_cast<int32>(sizeof(Address.sun_path)))
+	{
+		UE_LOG(LogHelika, Error, TEXT("Aggregator socket path %s is too long"), *SocketPath);
+		return false;
+	}
+	FMemory::Memcpy(Address.sun_path, Path.Get(), Path.Length());
+	if (!HelikaAggregator::MakeSocketDirectory(FPaths::GetPath(SocketPath)))
+	{
+		return false;
+	}
+
+	struct stat Info;
+	if (lstat(Path.Get(), &Info) == 0 && S_ISSOCK(Info.st_mode))
+	{
+		// Another aggregator still answers on the socket, taking it over would cut off the processes it serves
+		const int32 Probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		const bool bInUse = Probe >= 0 && connect(Probe, reinterpret_cast<const sockaddr*>(&Address), sizeof(Address)) == 0;
+		if (Probe >= 0)
+		{
+			close(Probe);
+		}
+		if (bInUse)
+		{
+			UE_LOG(LogHelika, Error, TEXT("Another aggregator is listening on %s"), *SocketPath);
+			return false;
+		}
+
+		// Left behind by an aggregator that did not shut down cleanly, it would fail the bind
+		unlink(Path.Get());
+	}
+
+	// Only this user may connect, the peers are checked again on accept
+	ListenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+	if (ListenSocket < 0 || bind(ListenSocket, reinterpret_cast<const sockaddr*>(&Address), sizeof(Address)) != 0 || chmod(Path.Get(), S_IRUSR | S_IWUSR) != 0
+		|| listen(ListenSocket, SOMAXCONN) != 0)
+	{
+		UE_LOG(LogHelika, Error, TEXT("Aggregator could not listen on %s: %s"), *SocketPath, UTF8_TO_TCHAR(strerror(errno)));
+		if (ListenSocket >= 0)
+		{
+			close(ListenSocket);
+			ListenSocket = -1;
+		}
+		return false;
+	}
+
+	bStopping = false;
+	ConnectionsThread = Async(EAsyncExecution::Thread, [this]()
+	{
+		RunConnections();
+	});
+	UE_LOG(LogHelika, Display, TEXT("Helika aggregator listening on %s, uploading through %s"), *SocketPath, Transport->GetName());
+	return true;
+#else
+	UE_LOG(LogHelika, Error, TEXT("The Helika aggregator needs Unix domain sockets, it only runs on Linux"));
+	return false;
+#endif
+}
+
+void FHelikaAggregator::Stop()
+{
+#if HELIKA_WITH_SIDECAR
+	bStopping = true;
+	if (ConnectionsThread.IsValid())
+	{
+		ConnectionsThread.Wait();
+		ConnectionsThread = TFuture<void>();
+	}
+	if (ListenSocket >= 0)
+	{
+		close(ListenSocket);
+		ListenSocket = -1;
+		unlink(TCHAR_TO_UTF8(*SocketPath));
+	}
+#endif
+}
+
+void FHelikaAggregator::RunConnections()
+{
+#if HELIKA_WITH_SIDECAR
+	struct FConnection
+	{
+		int32 Socket = -1;
+		TArray<uint8> Buffer;
+	};
+	TArray<FConnection> Connections;
+	TArray<pollfd> Polls;
+	TArray<uint8> Chunk;
+	Chunk.SetNumUninitialized(HelikaAggregator::ReceiveChunkBytes);
+	bool bPaused = false;
+
+	while (!bStopping)
+	{
+		// Unread frames stay in the socket buffers of the game processes, whose writes then back off
+		const bool bFull = BufferedBytes.load() >= Config.MaxBufferedBytes;
+		if (bFull && !bPaused)
+		{
+			FScopeLock Lock(&StatsLock);
+			++Stats.ReadPauses;
+		}
+		bPaused = bFull;
+
+		Polls.Reset();
+		Polls.Add({ListenSocket, POLLIN, 0});
+		for (const FConnection& Connection : Connections)
+		{
+			Polls.Add({Connection.Socket, static_cast<short>(bPaused ? 0 : POLLIN), 0});
+		}
+		if (poll(Polls.GetData(), Polls.Num(), HelikaAggregator::PollTimeoutMs) <= 0)
+		{
+			continue;
+		}
+
+		if (Polls[0].revents & POLLIN)
+		{
+			int32 Accepted = -1;
+			while ((Accepted = accept4(ListenSocket, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0)
+			{
+				if (!FHelikaSidecarFrame::IsSameUser(Accepted))
+				{
+					UE_LOG(LogHelika, Warning, TEXT("Aggregator closed a connection of a process run by another user"));
+					close(Accepted);
+					FScopeLock Lock(&StatsLock);
+					++Stats.RejectedConnections;
+					continue;
+				}
+				Connections.Add({Accepted, {}});
+				FScopeLock Lock(&StatsLock);
+				++Stats.Connections;
+			}
+		}
+
+		// Backwards, closed connections are swapped out of the array
+		for (int32 Index = Polls.Num() - 2; Index >= 0; --Index)
+		{
+			const short Events = Polls[Index + 1].revents;
+			if (Events == 0)
+			{
+				continue;
+			}
+
+			FConnection& Connection = Connections[Index];
+			bool bClosed = (Events & (POLLERR | POLLNVAL)) != 0;
+			if (!bClosed && (Events & (POLLIN | POLLHUP)) != 0)
+			{
+				const ssize_t Received = recv(Connection.Socket, Chunk.GetData(), Chunk.Num(), 0);
+				if (Received > 0)
+				{
+					Connection.Buffer.Append(Chunk.GetData(), static_cast<int32>(Received));
+					FScopeLock Lock(&StatsLock);
+					Stats.BytesReceived += Received;
+				}
+				else if (Received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+				{
+					bClosed = true;
+				}
+			}
+
+			int32 Consumed = 0;
+			while (!bClosed)
+			{
+				FHelikaSidecarFrame Frame;
+				const int32 FrameBytes = FHelikaSidecarFrame::Parse(TConstArrayView<uint8>(Connection.Buffer).RightChop(Consumed), Frame);
+				if (FrameBytes == 0)
+				{
+					break;
+				}
+				if (FrameBytes == INDEX_NONE || !HandleFrame(Frame))
+				{
+					// Nothing after a bad frame can be trusted to start on a frame boundary
+					UE_LOG(LogHelika, Warning, TEXT("Aggregator dropped a connection that sent a corrupt frame"));
+					FScopeLock Lock(&StatsLock);
+					++Stats.CorruptFrames;
+					bClosed = true;
+					break;
+				}
+				Consumed += FrameBytes;
+			}
+			Connection.Buffer.RemoveAt(0, Consumed, false);
+
+			if (bClosed)
+			{
+				close(Connection.Socket);
+				Connections.RemoveAtSwap(Index);
+			}
+		}
+
+		FScopeLock Lock(&StatsLock);
+		Stats.OpenConnections = Connections.Num();
+	}
+
+	for (const FConnection& Connection : Connections)
+	{
+		close(Connection.Socket);
+	}
+#endif
+}
+
+bool FHelikaAggregator::HandleFrame(const FHelikaSidecarFrame& Frame)
+{
+	// The Sidecar transport never compresses, the aggregator does it for the merged batches
+	const FString* Encoding = HelikaAggregator::FindHeader(Frame.Headers, TEXT("Content-Encoding"));
+	TArray<TPair<int32, int32>> Ranges;
+	if ((Encoding != nullptr && *Encoding != TEXT("identity")) || !SplitEvents(Frame.Body, Ranges))
+	{
+		return false;
+	}
+
+	int64 AddedBytes = 0;
+	{
+		FScopeLock Lock(&RoutesLock);
+		FRoute& Route = FindOrAddRoute(Frame.Url, Frame.Headers);
+		for (const TPair<int32, int32>& Range : Ranges)
+		{
+			if (Route.Open.Num() > 0 && Route.Open.GetBytes() + Range.Value + 1 > Config.MaxBatchBytes)
+			{
+				CloseOpenBatch(Route);
+			}
+			const int64 Before = Route.Open.GetBytes();
+			Route.Open.AddEvent(Frame.Body.Slice(Range.Key, Range.Value), 0);
+			AddedBytes += Route.Open.GetBytes() - Before;
+		}
+	}
+	BufferedBytes += AddedBytes;
+
+	FScopeLock Lock(&StatsLock);
+	++Stats.Frames;
+	Stats.Events += Ranges.Num();
+	return true;
+}
+
+void FHelikaAggregator::Tick()
+{
+	// The in-memory transport answers here
+	Transport->Tick();
+
+	// Batches are picked under the lock and read, compressed or written to disk after it, the I/O thread takes the lock for every frame
+	TArray<FRouteBatch> ToSpill;
+	TArray<FRouteBatch> ToUpload;
+	{
+		FScopeLock Lock(&RoutesLock);
+		TUniquePtr<FUpload> Upload;
+		while (Completed->Dequeue(Upload))
+		{
+			Settle(MoveTemp(*Upload), ToSpill);
+		}
+
+		const double Now = FPlatformTime::Seconds();
+		for (TPair<FString, FRoute>& Pair : Routes)
+		{
+			FRoute& Route = Pair.Value;
+			if (Route.Open.Num() > 0 && Now - Route.Open.OpenedAt >= Config.FlushIntervalSeconds)
+			{
+				CloseOpenBatch(Route);
+			}
+
+			if (Now < Route.BackoffUntil)
+			{
+				// Memory stays flat while the collector cannot take the batches
+				for (FBatch& Batch : Route.Ready)
+				{
+					BufferedBytes -= Batch.GetBytes();
+					ToSpill.Add(MakeRouteBatch(Pair.Key, Route, MoveTemp(Batch)));
+				}
+				Route.Ready.Reset();
+				continue;
+			}
+
+			// After a failure a single upload finds out whether the collector answers again.
+			// Oldest first, spilled batches were closed before the ones in memory.
+			int32 NumSpilled = Route.SpillStore.IsValid() ? Route.SpillStore->Num() : 0;
+			while (NumInFlight < Config.MaxRequestsInFlight && (Route.ConsecutiveFailures == 0 || Route.NumInFlight == 0) && (NumSpilled > 0 || Route.Ready.Num() > 0))
+			{
+				FRouteBatch& Pending = ToUpload.Add_GetRef(MakeRouteBatch(Pair.Key, Route, FBatch()));
+				if (NumSpilled > 0)
+				{
+					Pending.bTakeSpilled = true;
+					--NumSpilled;
+				}
+				else
+				{
+					Pending.Batch = MoveTemp(Route.Ready[0]);
+					Route.Ready.RemoveAt(0);
+				}
+				++NumInFlight;
+				++Route.NumInFlight;
+			}
+		}
+	}
+
+	for (const FRouteBatch& Pending : ToSpill)
+	{
+		Spill(Pending);
+	}
+	for (FRouteBatch& Pending : ToUpload)
+	{
+		if (Pending.bTakeSpilled && !TakeSpilled(Pending))
+		{
+			// Every spilled batch left was unreadable, the slot goes to the next tick
+			FScopeLock Lock(&RoutesLock);
+			--NumInFlight;
+			--Routes.FindChecked(Pending.RouteKey).NumInFlight;
+			continue;
+		}
+		StartUpload(MoveTemp(Pending));
+	}
+}
+
+bool FHelikaAggregator::Drain(float TimeoutSeconds, const TFunction<void(float DeltaSeconds)>& TickTransport)
+{
+	{
+		FScopeLock Lock(&RoutesLock);
+		for (TPair<FString, FRoute>& Pair : Routes)
+		{
+			CloseOpenBatch(Pair.Value);
+		}
+	}
+
+	double LastTick = FPlatformTime::Seconds();
+	const double Deadline = LastTick + TimeoutSeconds;
+	bool bIdle = false;
+	for (;;)
+	{
+		if (TickTransport)
+		{
+			const double Now = FPlatformTime::Seconds();
+			TickTransport(static_cast<float>(Now - LastTick));
+			LastTick = Now;
+		}
+		Tick();
+		{
+			FScopeLock Lock(&RoutesLock);
+			bIdle = NumInFlight == 0 && Completed->IsEmpty();
+			for (const TPair<FString, FRoute>& Pair : Routes)
+			{
+				bIdle &= Pair.Value.Ready.Num() == 0 && Pair.Value.Open.Num() == 0;
+			}
+		}
+		if (bIdle || FPlatformTime::Seconds() >= Deadline)
+		{
+			break;
+		}
+		FPlatformProcess::Sleep(0.01f);
+	}
+
+	// Whatever is still in memory waits on disk for the next run
+	TArray<FRouteBatch> ToSpill;
+	{
+		FScopeLock Lock(&RoutesLock);
+		for (TPair<FString, FRoute>& Pair : Routes)
+		{
+			CloseOpenBatch(Pair.Value);
+			for (FBatch& Batch : Pair.Value.Ready)
+			{
+				BufferedBytes -= Batch.GetBytes();
+				ToSpill.Add(MakeRouteBatch(Pair.Key, Pair.Value, MoveTemp(Batch)));
+			}
+			Pair.Value.Ready.Reset();
+		}
+	}
+	for (const FRouteBatch& Pending : ToSpill)
+	{
+		Spill(Pending);
+	}
+	return bIdle;
+}
+
+FHelikaAggregatorStats FHelikaAggregator::GetStats() const
+{
+	FScopeLock Lock(&StatsLock);
+	FHelikaAggregatorStats Copy = Stats;
+	Copy.BufferedBytes = BufferedBytes.load();
+	return Copy;
+}
+
+FHelikaAggregator::FRoute& FHelikaAggregator::FindOrAddRoute(const FString& Url, const TArray<TPair<FString, FString>>& Headers)
+{
+	const FString Key = MakeRouteKey(Url, Headers);
+	if (FRoute* Route = Routes.Find(Key))
+	{
+		return *Route;
+	}
+
+	FRoute& Route = Routes.Add(Key);
+	Route.Url = Url;
+	for (const TPair<FString, FString>& Header : Headers)
+	{
+		// Set per upload
+		if (!Header.Key.Equals(TEXT("Content-Encoding"), ESearchCase::IgnoreCase) && !Header.Key.Equals(TEXT("Content-Length"), ESearchCase::IgnoreCase))
+		{
+			Route.Headers.Add(Header);
+		}
+	}
+	Route.SpillStore = MakeUnique<FHelikaSpillStore>(Config.SpillDirectory / FMD5::HashAnsiString(*Key));
+	return Route;
+}
+
+void FHelikaAggregator::CloseOpenBatch(FRoute& Route)
+{
+	if (Route.Open.Num() > 0)
+	{
+		Route.Ready.Add(MoveTemp(Route.Open));
+		Route.Open = FBatch();
+	}
+}
+
+FHelikaAggregator::FRouteBatch FHelikaAggregator::MakeRouteBatch(const FString& RouteKey, const FRoute& Route, FBatch&& Batch)
+{
+	FRouteBatch Pending;
+	Pending.RouteKey = RouteKey;
+	Pending.Url = Route.Url;
+	Pending.Headers = Route.Headers;
+	Pending.SpillStore = Route.SpillStore.Get();
+	Pending.Batch = MoveTemp(Batch);
+	return Pending;
+}
+
+bool FHelikaAggregator::TakeSpilled(FRouteBatch& Pending)
+{
+	FHelikaSpilledBatch Spilled;
+	TArray<uint8> Payload;
+	while (Pending.SpillStore != nullptr && Pending.SpillStore->Take(Spilled, Payload))
+	{
+		TArray<TPair<int32, int32>> Ranges;
+		if (!SplitEvents(Payload, Ranges))
+		{
+			UE_LOG(LogHelika, Warning, TEXT("Aggregator removed the unreadable spilled batch %s"), *Spilled.Path);
+			Pending.SpillStore->Remove(Spilled);
+			continue;
+		}
+		for (const TPair<int32, int32>& Range : Ranges)
+		{
+			Pending.Batch.AddEvent(TConstArrayView<uint8>(Payload).Slice(Range.Key, Range.Value), 0);
+		}
+		Pending.Spilled = MoveTemp(Spilled);
+		return true;
+	}
+	return false;
+}
+
+void FHelikaAggregator::StartUpload(FRouteBatch&& Pending)
+{
+	TArray<uint8> Payload = MakeEnvelope(Pending.Batch);
+	const int64 UncompressedBytes = Payload.Num();
+
+	FHelikaTransportRequest Request;
+	Request.Url = MoveTemp(Pending.Url);
+	Request.Headers = MoveTemp(Pending.Headers);
+	TArray<uint8> Columnar;
+	if (Config.bColumnar && FHelikaColumnarBatch::Encode(Payload, Columnar) && Columnar.Num() < Payload.Num())
+	{
+		Request.AddHeader(TEXT("x-helika-batch-format"), FHelikaColumnarBatch::GetFormatName());
+		Payload = MoveTemp(Columnar);
+	}
+	if (HelikaAggregator::CompressBatch(Payload))
+	{
+		Request.AddHeader(TEXT("Content-Encoding"), TEXT("gzip"));
+	}
+	Request.TimeoutSeconds = Config.Transport.TimeoutSeconds;
+	{
+		FScopeLock Lock(&StatsLock);
+		++Stats.Uploads;
+		Stats.BytesBeforeCompression += UncompressedBytes;
+		Stats.BytesUploaded += Payload.Num();
+	}
+	Request.Body = MoveTemp(Payload);
+
+	TUniquePtr<FUpload> Upload = MakeUnique<FUpload>();
+	Upload->RouteKey = MoveTemp(Pending.RouteKey);
+	Upload->Batch = MoveTemp(Pending.Batch);
+	Upload->Spilled = MoveTemp(Pending.Spilled);
+
+	Transport->Send(MoveTemp(Request), [Queue = Completed, Upload = MoveTemp(Upload)](FHelikaTransportResponse&& Response) mutable
+	{
+		Upload->Response = MoveTemp(Response);
+		Queue->Enqueue(MoveTemp(Upload));
+	});
+}
+
+void FHelikaAggregator::Settle(FUpload&& Upload, TArray<FRouteBatch>& OutToSpill)
+{
+	FRoute& Route = Routes.FindChecked(Upload.RouteKey);
+	--NumInFlight;
+	--Route.NumInFlight;
+
+	const FHelikaTransportResponse& Response = Upload.Response;
+	const int32 NumEvents = Upload.Batch.Num();
+	const FHelikaAcknowledgement Acknowledgement = FHelikaAcknowledgement::Parse(NumEvents, Response.bConnected ? Response.Status : 0, Response.Body);
+	if (!Upload.Spilled.IsSet())
+	{
+		BufferedBytes -= Upload.Batch.GetBytes();
+	}
+
+	if (Acknowledgement.NumRetry == NumEvents)
+	{
+		// Unanswered or throttled, the route backs off and the batch waits on disk
+		++Route.ConsecutiveFailures;
+		const float BackoffSeconds = Response.RetryAfterSeconds > 0
+			? FMath::Min(static_cast<float>(Response.RetryAfterSeconds), Config.MaxBackoffSeconds)
+			: FMath::Min(FMath::Pow(2.f, static_cast<float>(FMath::Min(Route.ConsecutiveFailures - 1, 16))), Config.MaxBackoffSeconds);
+		Route.BackoffUntil = FPlatformTime::Seconds() + BackoffSeconds;
+		if (Upload.Spilled.IsSet())
+		{
+			Route.SpillStore->Restore(MoveTemp(*Upload.Spilled));
+		}
+		else
+		{
+			OutToSpill.Add(MakeRouteBatch(Upload.RouteKey, Route, MoveTemp(Upload.Batch)));
+		}
+
+		UE_LOG(LogHelika, Warning, TEXT("Aggregator upload of %d events to %s failed (%s), retrying in %.0f s"), NumEvents, *Route.Url,
+			Response.bConnected ? *FString::Printf(TEXT("status %d"), Response.Status) : *Response.Error, BackoffSeconds);
+		FScopeLock StatsScopeLock(&StatsLock);
+		++Stats.FailedUploads;
+		return;
+	}
+
+	Route.ConsecutiveFailures = 0;
+	Route.BackoffUntil = 0.0;
+	if (Upload.Spilled.IsSet())
+	{
+		Route.SpillStore->Remove(*Upload.Spilled);
+	}
+
+	// Events the collector asked for again go out with the next upload of the route
+	FBatch Retry;
+	int32 NumDropped = 0;
+	for (int32 Index = 0; Index < NumEvents; ++Index)
+	{
+		if (Acknowledgement.Results[Index] != EHelikaEventResult::Retry)
+		{
+			continue;
+		}
+		if (Upload.Batch.Attempts[Index] < Config.MaxEventRetries)
+		{
+			const TPair<int32, int32>& Range = Upload.Batch.Ranges[Index];
+			Retry.AddEvent(TConstArrayView<uint8>(Upload.Batch.Events).Slice(Range.Key, Range.Value), Upload.Batch.Attempts[Index] + 1);
+		}
+		else
+		{
+			++NumDropped;
+		}
+	}
+	if (Retry.Num() > 0)
+	{
+		BufferedBytes += Retry.GetBytes();
+		Route.Ready.Insert(MoveTemp(Retry), 0);
+	}
+
+	FScopeLock StatsScopeLock(&StatsLock);
+	Stats.AcceptedEvents += Acknowledgement.NumAccepted;
+	Stats.InvalidEvents += Acknowledgement.NumInvalid;
+	Stats.RetriedEvents += Acknowledgement.NumRetry - NumDropped;
+	Stats.DroppedEvents += NumDropped;
+}
+
+void FHelikaAggregator::Spill(const FRouteBatch& Pending)
+{
+	// The route is written next to its batches so that a later run knows where to upload them
+	const FString RouteFile = Config.SpillDirectory / FMD5::HashAnsiString(*Pending.RouteKey) / HelikaAggregator::RouteFileName;
+	if (!IFileManager::Get().FileExists(*RouteFile))
+	{
+		TArray<FString> Lines = {Pending.Url};
+		for (const TPair<FString, FString>& Header : Pending.Headers)
+		{
+			Lines.Add(Header.Key + TEXT(": ") + Header.Value);
+		}
+		FFileHelper::SaveStringArrayToFile(Lines, *RouteFile);
+	}
+
+	const int32 NumLost = Pending.SpillStore->Write(EHelikaPriority::HP_Normal, MakeEnvelope(Pending.Batch), Pending.Batch.Num(), Config.MaxSpillBytes);
+	FScopeLock Lock(&StatsLock);
+	++Stats.SpilledBatches;
+	Stats.DroppedEvents += NumLost;
+}
+
+void FHelikaAggregator::LoadSpilledRoutes()
+{
+	TArray<FString> Directories;
+	IFileManager::Get().FindFiles(Directories, *(Config.SpillDirectory / TEXT("*")), false, true);
+
+	FScopeLock Lock(&RoutesLock);
+	for (const FString& Directory : Directories)
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *(Config.SpillDirectory / Directory / HelikaAggregator::RouteFileName)) || Lines.Num() == 0)
+		{
+			continue;
+		}
+
+		TArray<TPair<FString, FString>> Headers;
+		for (int32 Index = 1; Index < Lines.Num(); ++Index)
+		{
+			FString Name;
+			FString Value;
+			if (Lines[Index].Split(TEXT(": "), &Name, &Value))
+			{
+				Headers.Emplace(MoveTemp(Name), MoveTemp(Value));
+			}
+		}
+		FindOrAddRoute(Lines[0], Headers).SpillStore->Load();
+	}
+}
+
+TArray<uint8> FHelikaAggregator::MakeEnvelope(const FBatch& Batch)
+{
+	const FTCHARToUTF8 Prefix(*FString::Printf(TEXT("{\"id\":\"%s\",\"events\":["), *FHelikaClock::NewGuid().ToString()));
+	TArray<uint8> Envelope;
+	Envelope.Reserve(Prefix.Length() + Batch.Events.Num() + 2);
+	Envelope.Append(reinterpret_cast<const uint8*>(Prefix.Get()), Prefix.Length());
+	Envelope.Append(Batch.Events);
+	Envelope.Add(']');
+	Envelope.Add('}');
+	return Envelope;
+}
+
+FString FHelikaAggregator::MakeRouteKey(const FString& Url, const TArray<TPair<FString, FString>>& Headers)
+{
+	const FString* ApiKey = HelikaAggregator::FindHeader(Headers, TEXT("x-api-key"));
+	return Url + TEXT("\n") + (ApiKey != nullptr ? *ApiKey : FString());
+}
+
+bool FHelikaAggregator::SplitEvents(TConstArrayView<uint8> Envelope, TArray<TPair<int32, int32>>& OutRanges)
+{
+	// Only strings and nesting matter, values are copied as they are
+	OutRanges.Reset();
+	int32 Depth = 0;
+	bool bInString = false;
+	bool bEscaped = false;
+	int32 StringStart = INDEX_NONE;
+	bool bAfterEventsKey = false;
+	int32 EventsDepth = INDEX_NONE;
+	int32 ElementStart = INDEX_NONE;
+	int32 ElementEnd = INDEX_NONE;
+
+	for (int32 Index = 0; Index < Envelope.Num(); ++Index)
+	{
+		const uint8 Char = Envelope[Index];
+		if (bInString)
+		{
+			if (bEscaped)
+			{
+				bEscaped = false;
+			}
+			else if (Char == '\\')
+			{
+				bEscaped = true;
+			}
+			else if (Char == '"')
+			{
+				bInString = false;
+				ElementEnd = Index + 1;
+				if (Depth == 1 && EventsDepth == INDEX_NONE)
+				{
+					bAfterEventsKey = Index - StringStart - 1 == 6 && FMemory::Memcmp(&Envelope[StringStart + 1], "events", 6) == 0;
+				}
+			}
+			continue;
+		}
+
+		const bool bInEvents = EventsDepth != INDEX_NONE && Depth == EventsDepth;
+		switch (Char)
+		{
+		case ' ':
+		case '\t':
+		case '\r':
+		case '\n':
+		case ':':
+			break;
+		case '"':
+			bInString = true;
+			StringStart = Index;
+			if (bInEvents && ElementStart == INDEX_NONE)
+			{
+				ElementStart = Index;
+			}
+			break;
+		case '{':
+		case '[':
+			if (Char == '[' && Depth == 1 && bAfterEventsKey && EventsDepth == INDEX_NONE)
+			{
+				EventsDepth = Depth + 1;
+			}
+			else if (bInEvents && ElementStart == INDEX_NONE)
+			{
+				ElementStart = Index;
+			}
+			++Depth;
+			break;
+		case '}':
+		case ']':
+			if (--Depth < 0)
+			{
+				return false;
+			}
+			if (EventsDepth != INDEX_NONE && Depth == EventsDepth - 1)
+			{
+				// End of the events array, ElementEnd still points past the last element
+				if (ElementStart != INDEX_NONE)
+				{
+					OutRanges.Emplace(ElementStart, ElementEnd - ElementStart);
+				}
+				return Char == ']';
+			}
+			ElementEnd = Index + 1;
+			break;
+		case ',':
+			if (bInEvents)
+			{
+				if (ElementStart == INDEX_NONE)
+				{
+					return false;
+				}
+				OutRanges.Emplace(ElementStart, ElementEnd - ElementStart);
+				ElementStart = INDEX_NONE;
+			}
+			else if (Depth == 1)
+			{
+				bAfterEventsKey = false;
+			}
+			break;
+		default:
+			// Numbers, true, false and null
+			if (bInEvents && ElementStart == INDEX_NONE)
+			{
+				ElementStart = Index;
+			}
+			ElementEnd = Index + 1;
+			break;
+		}
+	}
+	return false;
+}
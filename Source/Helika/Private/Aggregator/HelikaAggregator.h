@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include "HelikaSpillStore.h"
+#include "HelikaTransport.h"
+#include <atomic>
+
+struct FHelikaSidecarFrame;
+
+struct FHelikaAggregatorConfig
+{
+	/// Empty for FHelikaSidecarFrame::GetDefaultSocketPath
+	FString SocketPath;
+
+	/// Uncompressed size of a merged envelope
+	int64 MaxBatchBytes = 4ll << 20;
+	/// Longest time events wait for their batch to fill
+	float FlushIntervalSeconds = 2.0f;
+	int32 MaxRequestsInFlight = 4;
+	/// Send merged envelopes in the columnar batch format when that is smaller, see FHelikaColumnarBatch
+	bool bColumnar = false;
+
+	/// Events held in memory (batching, waiting, in flight) beyond which reading from the game processes pauses
+	int64 MaxBufferedBytes = 64ll << 20;
+
+	/// Batches are written here while the collector is unreachable or throttling, one directory per collector route
+	FString SpillDirectory;
+	/// Per collector route, the oldest batches are deleted beyond it
+	int64 MaxSpillBytes = 1024ll << 20;
+
+	/// Uploads of an event the collector answered as retryable, then it is dropped
+	int32 MaxEventRetries = 3;
+	float MaxBackoffSeconds = 60.f;
+
+	/// Client of the uploads, Sidecar is not allowed
+	FHelikaTransportConfig Transport;
+};
+
+struct FHelikaAggregatorStats
+{
+	int64 Connections = 0;
+	/// Closed at once, the process at the other end runs as another user
+	int64 RejectedConnections = 0;
+	int32 OpenConnections = 0;
+	int64 Frames = 0;
+	int64 CorruptFrames = 0;
+	int64 BytesReceived = 0;
+	int64 Events = 0;
+
+	int64 Uploads = 0;
+	int64 FailedUploads = 0;
+	int64 BytesBeforeCompression = 0;
+	int64 BytesUploaded = 0;
+	int64 AcceptedEvents = 0;
+	int64 InvalidEvents = 0;
+	int64 RetriedEvents = 0;
+	int64 DroppedEvents = 0;
+
+	int64 SpilledBatches = 0;
+	/// Times reading from the game processes paused because MaxBufferedBytes was reached
+	int64 ReadPauses = 0;
+	int64 BufferedBytes = 0;
+};
+
+/**
+ * Host-local aggregator fed by the FHelikaSidecarTransport of every game process on the host.
+ *
+ * A dedicated I/O thread reads frames from a Unix domain socket and splices the events of their envelopes into one
+ * open batch per collector route (URL and API key). Batches close once MaxBatchBytes or FlushIntervalSeconds is
+ * reached and are uploaded as one gzip body, so TLS, compression and connection reuse are shared by the whole host.
+ *
+ * Back-pressure is shared too: beyond MaxBufferedBytes the aggregator stops reading, the socket buffers of the
+ * processes fill up and their uploads back off. While a route is backing off after an unanswered or throttled upload,
+ * its batches go to disk and are uploaded oldest first once the collector answers again.
+ *
+ * Linux only, Start fails elsewhere.
+ */
+class FHelikaAggregator
+{
+public:
+	/// Transport overrides Config.Transport, e.g. with an in-memory one in tests
+	explicit FHelikaAggregator(const FHelikaAggregatorConfig& InConfig, const FHelikaTransportPtr& InTransport = nullptr);
+	~FHelikaAggregator();
+
+	/// Listens on the socket, loads the batches spilled by an earlier run. Fails while another aggregator listens on it.
+	bool Start();
+	/// Stops reading, batches still in memory stay until Drain
+	void Stop();
+
+	/// Closes due batches, settles finished uploads and starts new ones. Owner's thread, called every few milliseconds.
+	void Tick();
+
+	/**
+	 * Closes every open batch and ticks until nothing is in memory or the timeout passed, then spills what is left.
+	 * TickTransport is called with the elapsed seconds before every tick, for transports that complete from a tick of their own.
+	 */
+	bool Drain(float TimeoutSeconds, const TFunction<void(float DeltaSeconds)>& TickTransport = nullptr);
+
+	FHelikaAggregatorStats GetStats() const;
+
+	FString GetSocketPath() const { return SocketPath; }
+
+	/// Byte ranges of the elements of the "events" array of an envelope, false when Envelope is not one
+	static bool SplitEvents(TConstArrayView<uint8> Envelope, TArray<TPair<int32, int32>>& OutRanges);
+
+private:
+	/// Comma separated events of one upload
+	struct FBatch
+	{
+		TArray<uint8> Events;
+		/// Offset and size of each event in Events
+		TArray<TPair<int32, int32>> Ranges;
+		/// Uploads of each event so far
+		TArray<uint8> Attempts;
+		double OpenedAt = 0.0;
+
+		int32 Num() const { return Ranges.Num(); }
+		int64 GetBytes() const { return Events.Num(); }
+		void AddEvent(TConstArrayView<uint8> Event, uint8 Attempt);
+	};
+
+	struct FRoute
+	{
+		FString Url;
+		TArray<TPair<FString, FString>> Headers;
+		FBatch Open;
+		TArray<FBatch> Ready;
+		TUniquePtr<FHelikaSpillStore> SpillStore;
+		int32 NumInFlight = 0;
+		int32 ConsecutiveFailures = 0;
+		double BackoffUntil = 0.0;
+	};
+
+	struct FUpload
+	{
+		FString RouteKey;
+		FBatch Batch;
+		/// Set when the batch was read back from the spill store
+		TOptional<FHelikaSpilledBatch> Spilled;
+		FHelikaTransportResponse Response;
+	};
+
+	/// Batch of a route compressed or written to disk after RoutesLock is released, so that the I/O thread keeps reading
+	/// meanwhile. Holds copies of the route's fields as the I/O thread may add routes, which moves them.
+	struct FRouteBatch
+	{
+		FString RouteKey;
+		FString Url;
+		TArray<TPair<FString, FString>> Headers;
+		/// Owned by the route, routes are never removed
+		FHelikaSpillStore* SpillStore = nullptr;
+		FBatch Batch;
+		/// Set when the batch was read back from the spill store
+		TOptional<FHelikaSpilledBatch> Spilled;
+		/// Upload slot reserved for the oldest spilled batch of the route, TakeSpilled reads it
+		bool bTakeSpilled = false;
+	};
+
+	void RunConnections();
+	/// I/O thread, returns false when the frame is not a valid envelope
+	bool HandleFrame(const FHelikaSidecarFrame& Frame);
+
+	/// Called with RoutesLock held
+	FRoute& FindOrAddRoute(const FString& Url, const TArray<TPair<FString, FString>>& Headers);
+	void CloseOpenBatch(FRoute& Route);
+	/// The batch of a failed upload is added to OutToSpill
+	void Settle(FUpload&& Upload, TArray<FRouteBatch>& OutToSpill);
+	static FRouteBatch MakeRouteBatch(const FString& RouteKey, const FRoute& Route, FBatch&& Batch);
+
+	/// Called without RoutesLock, the upload slot was counted in NumInFlight when the batch was picked
+	void StartUpload(FRouteBatch&& Pending);
+	void Spill(const FRouteBatch& Pending);
+	/// Reads the oldest spilled batch of the route into Pending, false when the store has none left
+	static bool TakeSpilled(FRouteBatch& Pending);
+	void LoadSpilledRoutes();
+
+	static TArray<uint8> MakeEnvelope(const FBatch& Batch);
+	static FString MakeRouteKey(const FString& Url, const TArray<TPair<FString, FString>>& Headers);
+
+	FHelikaAggregatorConfig Config;
+	FString SocketPath;
+
+	int32 ListenSocket = -1;
+	TFuture<void> ConnectionsThread;
+	std::atomic<bool> bStopping{false};
+
+	mutable FCriticalSection RoutesLock;
+	TMap<FString, FRoute> Routes;
+	std::atomic<int64> BufferedBytes{0};
+	int32 NumInFlight = 0;
+
+	/// Filled on the transport's completion thread, settled by Tick. Shared with the completions, which may outlive the aggregator.
+	TSharedRef<TQueue<TUniquePtr<FUpload>, EQueueMode::Mpsc>, ESPMode::ThreadSafe> Completed = MakeShared<TQueue<TUniquePtr<FUpload>, EQueueMode::Mpsc>, ESPMode::ThreadSafe>();
+
+	FHelikaAggregatorStats Stats;
+	mutable FCriticalSection StatsLock;
+
+	FHelikaTransportPtr Transport;
+};
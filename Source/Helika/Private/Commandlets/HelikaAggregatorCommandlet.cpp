@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaAggregatorCommandlet.h"
+
+#include "Aggregator/HelikaAggregator.h"
+#include "Containers/Ticker.h"
+#include "HelikaDefines.h"
+#include "HttpManager.h"
+#include "HttpModule.h"
+
+UHelikaAggregatorCommandlet::UHelikaAggregatorCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Host-local Helika aggregator merging, compressing and uploading the batches of every game process on the host");
+	HelpUsage = TEXT("-run=HelikaAggregator [-socket=path] [-maxbatchkb=4096] [-flushms=2000] [-inflight=4] [-columnar] [-buffermb=64] [-spilldir=dir] [-maxspillmb=1024] [-transport=curl|http] [-duration=s]");
+}
+
+int32 UHelikaAggregatorCommandlet::Main(const FString& Params)
+{
+	FHelikaAggregatorConfig Config;
+	FParse::Value(*Params, TEXT("socket="), Config.SocketPath);
+	FParse::Value(*Params, TEXT("spilldir="), Config.SpillDirectory);
+	FParse::Value(*Params, TEXT("inflight="), Config.MaxRequestsInFlight);
+	Config.bColumnar = FParse::Param(*Params, TEXT("columnar"));
+
+	int32 MaxBatchKilobytes = 0;
+	if (FParse::Value(*Params, TEXT("maxbatchkb="), MaxBatchKilobytes) && MaxBatchKilobytes > 0)
+	{
+		Config.MaxBatchBytes = static_cast<int64>(MaxBatchKilobytes) << 10;
+	}
+	int32 FlushMilliseconds = 0;
+	if (FParse::Value(*Params, TEXT("flushms="), FlushMilliseconds) && FlushMilliseconds > 0)
+	{
+		Config.FlushIntervalSeconds = FlushMilliseconds / 1000.f;
+	}
+	int32 BufferMegabytes = 0;
+	if (FParse::Value(*Params, TEXT("buffermb="), BufferMegabytes) && BufferMegabytes > 0)
+	{
+		Config.MaxBufferedBytes = static_cast<int64>(BufferMegabytes) << 20;
+	}
+	int32 MaxSpillMegabytes = 0;
+	if (FParse::Value(*Params, TEXT("maxspillmb="), MaxSpillMegabytes) && MaxSpillMegabytes > 0)
+	{
+		Config.MaxSpillBytes = static_cast<int64>(MaxSpillMegabytes) << 20;
+	}
+
+	FString TransportName = TEXT("curl");
+	FParse::Value(*Params, TEXT("transport="), TransportName);
+	Config.Transport.Kind = TransportName.Equals(TEXT("http"), ESearchCase::IgnoreCase) ? EHelikaTransport::HT_HttpModule : EHelikaTransport::HT_Curl;
+
+	float DurationSeconds = 0.f;
+	FParse::Value(*Params, TEXT("duration="), DurationSeconds);
+
+	FHelikaAggregator Aggregator(Config);
+	if (!Aggregator.Start())
+	{
+		return 1;
+	}
+
+	// The Http Module completes its requests from its manager's tick, uploads still in flight at shutdown need it too
+	const auto TickTransport = [](float DeltaSeconds)
+	{
+		FTSTicker::GetCoreTicker().Tick(DeltaSeconds);
+		FHttpModule::Get().GetHttpManager().Tick(DeltaSeconds);
+	};
+
+	const double StartTime = FPlatformTime::Seconds();
+	double LastTick = StartTime;
+	double NextReport = StartTime + 5.0;
+	while (!IsEngineExitRequested() && (DurationSeconds <= 0.f || FPlatformTime::Seconds() - StartTime < DurationSeconds))
+	{
+		FPlatformProcess::Sleep(0.02f);
+
+		const double Now = FPlatformTime::Seconds();
+		TickTransport(static_cast<float>(Now - LastTick));
+		LastTick = Now;
+
+		Aggregator.Tick();
+
+		if (Now >= NextReport)
+		{
+			NextReport += 5.0;
+			const FHelikaAggregatorStats Stats = Aggregator.GetStats();
+			UE_LOG(LogHelika, Display, TEXT("Aggregator: %d connections, %lld events in, %lld uploads (%lld failed), %lld accepted, %lld spilled batches, %lld buffered bytes, %lld read pauses"),
+				Stats.OpenConnections, Stats.Events, Stats.Uploads, Stats.FailedUploads, Stats.AcceptedEvents, Stats.SpilledBatches, Stats.BufferedBytes, Stats.ReadPauses);
+		}
+	}
+
+	Aggregator.Stop();
+	if (!Aggregator.Drain(30.f, TickTransport))
+	{
+		UE_LOG(LogHelika, Warning, TEXT("Aggregator stopped before every batch was uploaded, the rest is uploaded by the next run"));
+	}
+
+	const FHelikaAggregatorStats Stats = Aggregator.GetStats();
+	UE_LOG(LogHelika, Display, TEXT("Aggregator stopped: %lld frames, %lld events, %lld uploads, %lld bytes before compression, %lld bytes uploaded, %lld dropped events, %lld rejected connections"),
+		Stats.Frames, Stats.Events, Stats.Uploads, Stats.BytesBeforeCompression, Stats.BytesUploaded, Stats.DroppedEvents, Stats.RejectedConnections);
+	return 0;
+}
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HelikaAggregatorCommandlet.generated.h"
+
+/**
+ * Runs the host-local aggregator that game processes using the Sidecar transport upload through.
+ *
+ * UnrealEditor-Cmd <Project> -run=HelikaAggregator [-socket=<path>] [-maxbatchkb=4096] [-flushms=2000]
+ *     [-inflight=4] [-columnar] [-buffermb=64] [-spilldir=<dir>] [-maxspillmb=1024] [-transport=curl|http] [-duration=seconds]
+ */
+UCLASS()
+class UHelikaAggregatorCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UHelikaAggregatorCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
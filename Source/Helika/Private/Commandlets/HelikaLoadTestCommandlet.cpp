@@ -0,0 +1,675 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaLoadTestCommandlet.h"
+
+#include "HelikaDefines.h"
+#include "HelikaLibrary.h"
+#include "HelikaManager.h"
+#include "HelikaMetricsCounters.h"
+#include "HelikaSettings.h"
+#include "HttpManager.h"
+#include "HttpModule.h"
+#include "Async/Async.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "MockCollector/HelikaMockCollector.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace HelikaLoadTest
+{
+	/// Synthetic workload replayed through UHelikaManager
+	struct FProfile
+	{
+		FString Name = TEXT("steady");
+
+		/// Events per second across every producer, 0 sends as fast as possible
+		float EventsPerSecond = 1000.f;
+		float DurationSeconds = 30.f;
+
+		/// Producer threads, 0 sends from the game thread like most games do
+		int32 ProducerThreads = 4;
+
+		/// Size range of the padding string added to every event
+		int32 MinPayloadBytes = 64;
+		int32 MaxPayloadBytes = 512;
+
+		/// Relative weights of SendEvent, SendUserEvent and SendContextEvent
+		float GameEventWeight = 0.7f;
+		float UserEventWeight = 0.2f;
+		float ContextEventWeight = 0.1f;
+
+		/// Player contexts the context events are spread over
+		int32 Contexts = 8;
+
+		/// Events sent at once every BurstIntervalSeconds on top of the steady rate, 0 disables bursts
+		int32 BurstSize = 0;
+		float BurstIntervalSeconds = 5.f;
+
+		int32 Seed = 0;
+
+		void Read(const FJsonObject& Json)
+		{
+			Json.TryGetStringField(TEXT("name"), Name);
+			Json.TryGetNumberField(TEXT("events_per_second"), EventsPerSecond);
+			Json.TryGetNumberField(TEXT("duration_seconds"), DurationSeconds);
+			Json.TryGetNumberField(TEXT("producer_threads"), ProducerThreads);
+			Json.TryGetNumberField(TEXT("min_payload_bytes"), MinPayloadBytes);
+			Json.TryGetNumberField(TEXT("max_payload_bytes"), MaxPayloadBytes);
+			Json.TryGetNumberField(TEXT("contexts"), Contexts);
+			Json.TryGetNumberField(TEXT("burst_size"), BurstSize);
+			Json.TryGetNumberField(TEXT("burst_interval_seconds"), BurstIntervalSeconds);
+			Json.TryGetNumberField(TEXT("seed"), Seed);
+
+			const TSharedPtr<FJsonObject>* Mix = nullptr;
+			if (Json.TryGetObjectField(TEXT("event_mix"), Mix))
+			{
+				(*Mix)->TryGetNumberField(TEXT("game"), GameEventWeight);
+				(*Mix)->TryGetNumberField(TEXT("user"), UserEventWeight);
+				(*Mix)->TryGetNumberField(TEXT("context"), ContextEventWeight);
+			}
+		}
+
+		void ReadCommandLine(const FString& Params)
+		{
+			FParse::Value(*Params, TEXT("rate="), EventsPerSecond);
+			FParse::Value(*Params, TEXT("duration="), DurationSeconds);
+			FParse::Value(*Params, TEXT("threads="), ProducerThreads);
+			FParse::Value(*Params, TEXT("minpayload="), MinPayloadBytes);
+			FParse::Value(*Params, TEXT("maxpayload="), MaxPayloadBytes);
+			FParse::Value(*Params, TEXT("contexts="), Contexts);
+			FParse::Value(*Params, TEXT("burstsize="), BurstSize);
+			FParse::Value(*Params, TEXT("burstinterval="), BurstIntervalSeconds);
+			FParse::Value(*Params, TEXT("seed="), Seed);
+		}
+
+		void Sanitize()
+		{
+			EventsPerSecond = FMath::Max(EventsPerSecond, 0.f);
+			DurationSeconds = FMath::Max(DurationSeconds, 1.f);
+			ProducerThreads = FMath::Clamp(ProducerThreads, 0, 64);
+			MinPayloadBytes = FMath::Max(MinPayloadBytes, 0);
+			MaxPayloadBytes = FMath::Max(MaxPayloadBytes, MinPayloadBytes);
+			Contexts = FMath::Max(Contexts, 1);
+			BurstSize = FMath::Max(BurstSize, 0);
+			BurstIntervalSeconds = FMath::Max(BurstIntervalSeconds, 0.1f);
+			if (GameEventWeight + UserEventWeight + ContextEventWeight <= 0.f)
+			{
+				GameEventWeight = 1.f;
+			}
+		}
+
+		TSharedRef<FJsonObject> ToJson() const
+		{
+			const TSharedRef<FJsonObject> Mix = MakeShared<FJsonObject>();
+			Mix->SetNumberField(TEXT("game"), GameEventWeight);
+			Mix->SetNumberField(TEXT("user"), UserEventWeight);
+			Mix->SetNumberField(TEXT("context"), ContextEventWeight);
+
+			const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetStringField(TEXT("name"), Name);
+			Json->SetNumberField(TEXT("events_per_second"), EventsPerSecond);
+			Json->SetNumberField(TEXT("duration_seconds"), DurationSeconds);
+			Json->SetNumberField(TEXT("producer_threads"), ProducerThreads);
+			Json->SetNumberField(TEXT("min_payload_bytes"), MinPayloadBytes);
+			Json->SetNumberField(TEXT("max_payload_bytes"), MaxPayloadBytes);
+			Json->SetObjectField(TEXT("event_mix"), Mix);
+			Json->SetNumberField(TEXT("contexts"), Contexts);
+			Json->SetNumberField(TEXT("burst_size"), BurstSize);
+			Json->SetNumberField(TEXT("burst_interval_seconds"), BurstIntervalSeconds);
+			Json->SetNumberField(TEXT("seed"), Seed);
+			return Json;
+		}
+	};
+
+	static bool FindBuiltInProfile(const FString& Name, FProfile& OutProfile)
+	{
+		OutProfile = FProfile();
+		OutProfile.Name = Name;
+
+		if (Name == TEXT("steady"))
+		{
+			return true;
+		}
+		if (Name == TEXT("burst"))
+		{
+			// Loading screens and match ends flush thousands of events at once
+			OutProfile.EventsPerSecond = 500.f;
+			OutProfile.ProducerThreads = 0;
+			OutProfile.BurstSize = 5000;
+			OutProfile.BurstIntervalSeconds = 5.f;
+			return true;
+		}
+		if (Name == TEXT("server"))
+		{
+			// Dedicated server sending on behalf of many players
+			OutProfile.EventsPerSecond = 5000.f;
+			OutProfile.ProducerThreads = 8;
+			OutProfile.Contexts = 64;
+			OutProfile.GameEventWeight = 0.1f;
+			OutProfile.UserEventWeight = 0.1f;
+			OutProfile.ContextEventWeight = 0.8f;
+			return true;
+		}
+		if (Name == TEXT("stress"))
+		{
+			OutProfile.EventsPerSecond = 0.f;
+			OutProfile.DurationSeconds = 10.f;
+			OutProfile.ProducerThreads = 8;
+			return true;
+		}
+		return false;
+	}
+
+	/// Percentiles of a latency distribution in milliseconds
+	static TSharedRef<FJsonObject> Summarize(TArray<float>& SamplesMs)
+	{
+		const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+		Json->SetNumberField(TEXT("count"), SamplesMs.Num());
+		if (SamplesMs.IsEmpty())
+		{
+			return Json;
+		}
+
+		SamplesMs.Sort();
+		double Total = 0.0;
+		for (const float Sample : SamplesMs)
+		{
+			Total += Sample;
+		}
+
+		const auto Percentile = [&SamplesMs](double Fraction)
+		{
+			return SamplesMs[FMath::Min(SamplesMs.Num() - 1, static_cast<int32>(Fraction * SamplesMs.Num()))];
+		};
+
+		Json->SetNumberField(TEXT("mean_ms"), Total / SamplesMs.Num());
+		Json->SetNumberField(TEXT("p50_ms"), Percentile(0.5));
+		Json->SetNumberField(TEXT("p99_ms"), Percentile(0.99));
+		Json->SetNumberField(TEXT("p999_ms"), Percentile(0.999));
+		Json->SetNumberField(TEXT("max_ms"), SamplesMs.Last());
+		return Json;
+	}
+
+	/// Name of the detail field carrying the send time in microseconds since the start of the run
+	static const TCHAR* SentAtField = TEXT("load_sent_us");
+
+	/// Sends its share of the profile's events, paced against the start time
+	class FProducer
+	{
+	public:
+		FProducer(UHelikaManager& InManager, const FProfile& InProfile, const TArray<FHelikaContext>& InContexts, const TArray<FString>& InPayloads, int32 NumProducers, int32 Index, double InStartTime)
+			: Manager(InManager)
+			, Profile(InProfile)
+			, Contexts(InContexts)
+			, Payloads(InPayloads)
+			, Rate(InProfile.EventsPerSecond / NumProducers)
+			, BurstShare(InProfile.BurstSize / NumProducers + (Index < InProfile.BurstSize % NumProducers ? 1 : 0))
+			, Random(InProfile.Seed + Index)
+			, StartTime(InStartTime)
+		{
+			const int64 Bursts = BurstShare > 0 ? 1 + static_cast<int64>(Profile.DurationSeconds / Profile.BurstIntervalSeconds) : 0;
+			EnqueueLatenciesMs.Reserve(Rate > 0.0 ? static_cast<int64>(Rate * Profile.DurationSeconds) + Bursts * BurstShare : 1024 * 1024);
+		}
+
+		/// Sends every event due at Now
+		void Step(double Now)
+		{
+			const double Elapsed = Now - StartTime;
+
+			// As fast as possible still returns regularly so the caller can check the time
+			int64 Due = Rate > 0.0 ? static_cast<int64>(Elapsed * Rate) : Produced + 64;
+			if (BurstShare > 0)
+			{
+				Due += BurstShare * (1 + static_cast<int64>(Elapsed / Profile.BurstIntervalSeconds));
+			}
+
+			while (Produced < Due)
+			{
+				SendOne();
+			}
+		}
+
+		int64 Produced = 0;
+		int64 SendFailed = 0;
+		TArray<float> EnqueueLatenciesMs;
+
+	private:
+		void SendOne()
+		{
+			const TSharedPtr<FJsonObject> Detail = MakeShareable(new FJsonObject());
+			Detail->SetStringField("payload", Payloads[Random.RandHelper(Payloads.Num())]);
+			Detail->SetNumberField("sequence", static_cast<double>(Produced));
+
+			const TSharedPtr<FJsonObject> SubEvent = MakeShareable(new FJsonObject());
+			SubEvent->SetObjectField("event_detail", Detail);
+
+			const TSharedPtr<FJsonObject> Event = MakeShareable(new FJsonObject());
+			Event->SetStringField("event_type", "load_test");
+			Event->SetObjectField("event", SubEvent);
+
+			const float Roll = Random.GetFraction() * (Profile.GameEventWeight + Profile.UserEventWeight + Profile.ContextEventWeight);
+			SubEvent->SetStringField("event_sub_type", Roll < Profile.GameEventWeight ? "game" : Roll < Profile.GameEventWeight + Profile.UserEventWeight ? "user" : "context");
+
+			Detail->SetNumberField(SentAtField, FMath::RoundToDouble((FPlatformTime::Seconds() - StartTime) * 1000000.0));
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			bool bSent;
+			if (Roll < Profile.GameEventWeight)
+			{
+				bSent = Manager.SendEvent(Event);
+			}
+			else if (Roll < Profile.GameEventWeight + Profile.UserEventWeight)
+			{
+				bSent = Manager.SendUserEvent(Event);
+			}
+			else
+			{
+				bSent = Manager.SendContextEvent(Contexts[Random.RandHelper(Contexts.Num())], Event);
+			}
+
+			EnqueueLatenciesMs.Add(static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles)));
+			++Produced;
+			SendFailed += bSent ? 0 : 1;
+		}
+
+		UHelikaManager& Manager;
+		const FProfile& Profile;
+		const TArray<FHelikaContext>& Contexts;
+		const TArray<FString>& Payloads;
+		const double Rate;
+		const int32 BurstShare;
+		FRandomStream Random;
+		const double StartTime;
+	};
+
+	/// Matches the events seen by the in-process collector with their send time
+	class FDeliveryRecorder
+	{
+	public:
+		explicit FDeliveryRecorder(double InStartTime)
+			: StartTime(InStartTime)
+		{
+		}
+
+		/// Scans the raw body for the send time instead of parsing it a second time, the collector already validated it
+		void OnBatchAccepted(TConstArrayView<uint8> Body)
+		{
+			const double NowUs = (FPlatformTime::Seconds() - StartTime) * 1000000.0;
+			const FTCHARToUTF8 Marker(*FString::Printf(TEXT("\"%s\":"), SentAtField));
+
+			TArray<float, TInlineAllocator<256>> BatchLatenciesMs;
+			for (int32 Index = 0; Index + Marker.Length() < Body.Num(); ++Index)
+			{
+				if (FMemory::Memcmp(Body.GetData() + Index, Marker.Get(), Marker.Length()) != 0)
+				{
+					continue;
+				}
+
+				ANSICHAR Digits[32];
+				int32 NumDigits = 0;
+				for (Index += Marker.Length(); Index < Body.Num() && FChar::IsDigit(Body[Index]) && NumDigits < UE_ARRAY_COUNT(Digits) - 1; ++Index)
+				{
+					Digits[NumDigits++] = Body[Index];
+				}
+				Digits[NumDigits] = 0;
+				BatchLatenciesMs.Add(static_cast<float>((NowUs - FCStringAnsi::Atoi64(Digits)) / 1000.0));
+			}
+
+			FScopeLock Lock(&CriticalSection);
+			LatenciesMs.Append(BatchLatenciesMs);
+			LastDeliverySeconds = NowUs / 1000000.0;
+		}
+
+		/// Read once the collector is stopped
+		TArray<float> LatenciesMs;
+		double LastDeliverySeconds = 0.0;
+
+	private:
+		const double StartTime;
+		FCriticalSection CriticalSection;
+	};
+
+	/// Settings changed for the run, restored afterwards
+	struct FHelikaSettingsBackup
+	{
+		explicit FHelikaSettingsBackup(const UHelikaSettings& Settings)
+			: HelikaAPIKey(Settings.HelikaAPIKey)
+			, GameId(Settings.GameId)
+			, HelikaEnvironment(Settings.HelikaEnvironment)
+			, Telemetry(Settings.Telemetry)
+			, bPrintEventsToConsole(Settings.bPrintEventsToConsole)
+			, bUploadOnLocalhost(Settings.bUploadOnLocalhost)
+			, MaxBatchSize(Settings.MaxBatchSize)
+			, FlushIntervalSeconds(Settings.FlushIntervalSeconds)
+			, bCompressPayloads(Settings.bCompressPayloads)
+		{
+		}
+
+		void Restore(UHelikaSettings& Settings) const
+		{
+			Settings.HelikaAPIKey = HelikaAPIKey;
+			Settings.GameId = GameId;
+			Settings.HelikaEnvironment = HelikaEnvironment;
+			Settings.Telemetry = Telemetry;
+			Settings.bPrintEventsToConsole = bPrintEventsToConsole;
+			Settings.bUploadOnLocalhost = bUploadOnLocalhost;
+			Settings.MaxBatchSize = MaxBatchSize;
+			Settings.FlushIntervalSeconds = FlushIntervalSeconds;
+			Settings.bCompressPayloads = bCompressPayloads;
+		}
+
+		FString HelikaAPIKey;
+		FString GameId;
+		EHelikaEnvironment HelikaEnvironment;
+		ETelemetryLevel Telemetry;
+		bool bPrintEventsToConsole;
+		bool bUploadOnLocalhost;
+		int32 MaxBatchSize;
+		float FlushIntervalSeconds;
+		bool bCompressPayloads;
+	};
+
+	static FString ToJsonString(const TSharedRef<FJsonObject>& Json)
+	{
+		FString Output;
+		const TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Output);
+		FJsonSerializer::Serialize(Json, Writer);
+		return Output;
+	}
+}
+
+UHelikaLoadTestCommandlet::UHelikaLoadTestCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Drives the Helika SDK with a synthetic workload against the local collector and reports throughput, latency, memory and drops as JSON");
+	HelpUsage = TEXT("-run=HelikaLoadTest [-profile=steady|burst|server|stress] [-profilefile=file] [-rate=N] [-duration=s] [-threads=N] [-minpayload=N] [-maxpayload=N] [-burstsize=N] [-burstinterval=s] [-contexts=N] [-batchsize=N] [-flushinterval=s] [-compress] [-nocollector] [-draintimeout=s] [-verbose] [-output=file]");
+}
+
+int32 UHelikaLoadTestCommandlet::Main(const FString& Params)
+{
+	using namespace HelikaLoadTest;
+
+	FString ProfileName = TEXT("steady");
+	FParse::Value(*Params, TEXT("profile="), ProfileName);
+	FProfile Profile;
+	if (!FindBuiltInProfile(ProfileName, Profile))
+	{
+		UE_LOG(LogHelika, Error, TEXT("Unknown load profile '%s', expected steady, burst, server or stress"), *ProfileName);
+		return 1;
+	}
+
+	FString ProfileFile;
+	if (FParse::Value(*Params, TEXT("profilefile="), ProfileFile))
+	{
+		FString ProfileJson;
+		TSharedPtr<FJsonObject> ProfileObject;
+		if (!FFileHelper::LoadFileToString(ProfileJson, *ProfileFile) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(ProfileJson), ProfileObject) || !ProfileObject.IsValid())
+		{
+			UE_LOG(LogHelika, Error, TEXT("Could not read load profile %s"), *ProfileFile);
+			return 1;
+		}
+		Profile.Read(*ProfileObject);
+	}
+	Profile.ReadCommandLine(Params);
+	Profile.Sanitize();
+
+	// One second of warm-up for the session events before the measured window
+	const double StartTime = FPlatformTime::Seconds() + 1.0;
+	FDeliveryRecorder Delivery(StartTime);
+	TUniquePtr<FHelikaMockCollector> Collector;
+	if (!FParse::Param(*Params, TEXT("nocollector")))
+	{
+		Collector = MakeUnique<FHelikaMockCollector>(FHelikaMockCollectorConfig());
+		Collector->SetOnBatchAccepted([&Delivery](TConstArrayView<uint8> Body) { Delivery.OnBatchAccepted(Body); });
+		if (!Collector->Start())
+		{
+			return 1;
+		}
+	}
+
+	// Point the SDK at the local collector for the duration of the run, the settings are not saved
+	UHelikaSettings* Settings = UHelikaLibrary::GetHelikaSettings();
+	const FHelikaSettingsBackup OriginalSettings(*Settings);
+	Settings->HelikaAPIKey = Settings->HelikaAPIKey.IsEmpty() ? TEXT("LoadTestAPIKey") : Settings->HelikaAPIKey;
+	Settings->GameId = Settings->GameId.IsEmpty() ? TEXT("LoadTestGame") : Settings->GameId;
+	Settings->HelikaEnvironment = EHelikaEnvironment::HE_Localhost;
+	Settings->bUploadOnLocalhost = true;
+	Settings->Telemetry = ETelemetryLevel::TL_TelemetryOnly;
+	Settings->bPrintEventsToConsole = false;
+	FParse::Value(*Params, TEXT("batchsize="), Settings->MaxBatchSize);
+	FParse::Value(*Params, TEXT("flushinterval="), Settings->FlushIntervalSeconds);
+	Settings->bCompressPayloads |= FParse::Param(*Params, TEXT("compress"));
+
+	const ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	if (!FParse::Param(*Params, TEXT("verbose")))
+	{
+		// Every request logs its response otherwise
+		LogHelika.SetVerbosity(ELogVerbosity::Warning);
+	}
+
+	// Synthetic payloads are built once, events pick one at random
+	TArray<FString> Payloads;
+	FRandomStream PayloadRandom(Profile.Seed);
+	for (int32 Index = 0; Index < 32; ++Index)
+	{
+		const int32 Length = PayloadRandom.RandRange(Profile.MinPayloadBytes, Profile.MaxPayloadBytes);
+		FString& Payload = Payloads.AddDefaulted_GetRef();
+		Payload.Reserve(Length);
+		for (int32 Char = 0; Char < Length; ++Char)
+		{
+			Payload.AppendChar(TEXT('a') + PayloadRandom.RandHelper(26));
+		}
+	}
+
+
+	UHelikaManager* Manager = NewObject<UHelikaManager>();
+	Manager->AddToRoot();
+	Manager->InitializeSDK();
+
+	TArray<FHelikaContext> Contexts;
+	for (int32 Index = 0; Index < Profile.Contexts; ++Index)
+	{
+		const TSharedPtr<FJsonObject> UserDetails = MakeShareable(new FJsonObject());
+		UserDetails->SetStringField("user_id", FString::Printf(TEXT("load_player_%d"), Index));
+		Contexts.Add(Manager->CreateContext(UserDetails));
+	}
+
+	const int32 NumProducers = FMath::Max(Profile.ProducerThreads, 1);
+	TArray<TUniquePtr<FProducer>> Producers;
+	for (int32 Index = 0; Index < NumProducers; ++Index)
+	{
+		Producers.Add(MakeUnique<FProducer>(*Manager, Profile, Contexts, Payloads, NumProducers, Index, StartTime));
+	}
+
+	// Let the session events go out before measuring
+	Manager->Flush();
+	while (FPlatformTime::Seconds() < StartTime)
+	{
+		FTSTicker::GetCoreTicker().Tick(0.01f);
+		FHttpModule::Get().GetHttpManager().Tick(0.01f);
+		FPlatformProcess::Sleep(0.01f);
+	}
+
+	const FHelikaMetrics MetricsBefore = FHelikaMetricsCounters::Read();
+	const uint64 BaselineMemory = FPlatformMemory::GetStats().UsedPhysical;
+	const double EndTime = StartTime + Profile.DurationSeconds;
+
+	TArray<TFuture<void>> Threads;
+	for (int32 Index = 0; Index < Profile.ProducerThreads; ++Index)
+	{
+		Threads.Add(Async(EAsyncExecution::Thread, [Producer = Producers[Index].Get(), &Profile, EndTime]()
+		{
+			for (double Now = FPlatformTime::Seconds(); Now < EndTime; Now = FPlatformTime::Seconds())
+			{
+				Producer->Step(Now);
+				if (Profile.EventsPerSecond > 0.f)
+				{
+					FPlatformProcess::Sleep(0.001f);
+				}
+			}
+		}));
+	}
+
+	// The commandlet thread plays the game thread: it ticks the flush and the HTTP completions,
+	// and sends the events itself when the profile has no producer threads
+	uint64 PeakMemory = BaselineMemory;
+	int64 PeakQueueDepth = 0;
+	TArray<float> GameThreadMsPerSecond;
+	uint64 WindowCycles = 0;
+	double WindowStart = StartTime;
+	double LastTick = StartTime;
+
+	float DrainTimeoutSeconds = 30.f;
+	FParse::Value(*Params, TEXT("draintimeout="), DrainTimeoutSeconds);
+	bool bDraining = false;
+
+	for (double Now = FPlatformTime::Seconds(); !IsEngineExitRequested(); Now = FPlatformTime::Seconds())
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		if (Profile.ProducerThreads == 0 && Now < EndTime)
+		{
+			Producers[0]->Step(Now);
+		}
+		FTSTicker::GetCoreTicker().Tick(static_cast<float>(Now - LastTick));
+		WindowCycles += FPlatformTime::Cycles64() - StartCycles;
+
+		FHttpModule::Get().GetHttpManager().Tick(static_cast<float>(Now - LastTick));
+		LastTick = Now;
+
+		PeakMemory = FMath::Max(PeakMemory, FPlatformMemory::GetStats().UsedPhysical);
+		PeakQueueDepth = FMath::Max(PeakQueueDepth, FHelikaMetricsCounters::Sum(EHelikaCounter::QueueDepth));
+
+		if (Now - WindowStart >= 1.0)
+		{
+			GameThreadMsPerSecond.Add(static_cast<float>(FPlatformTime::ToMilliseconds64(WindowCycles) / (Now - WindowStart)));
+			WindowCycles = 0;
+			WindowStart = Now;
+		}
+
+		if (!bDraining && Now >= EndTime)
+		{
+			for (TFuture<void>& Thread : Threads)
+			{
+				Thread.Wait();
+			}
+			Manager->Flush();
+			bDraining = true;
+		}
+
+		if (bDraining && ((FHelikaMetricsCounters::Sum(EHelikaCounter::QueueDepth) == 0 && FHelikaMetricsCounters::Sum(EHelikaCounter::BytesInFlight) == 0) || Now >= EndTime + DrainTimeoutSeconds))
+		{
+			break;
+		}
+
+		FPlatformProcess::Sleep(Profile.ProducerThreads == 0 ? 0.f : 0.001f);
+	}
+
+	const double DurationSeconds = FMath::Min(FPlatformTime::Seconds(), EndTime) - StartTime;
+	const FHelikaMetrics MetricsAfter = FHelikaMetricsCounters::Read();
+
+	Manager->DeinitializeSDK();
+	Manager->RemoveFromRoot();
+	if (Collector.IsValid())
+	{
+		Collector->Stop();
+	}
+
+	const TSharedRef<FJsonObject> SettingsJson = MakeShared<FJsonObject>();
+	SettingsJson->SetNumberField(TEXT("max_batch_size"), Settings->MaxBatchSize);
+	SettingsJson->SetNumberField(TEXT("flush_interval_seconds"), Settings->FlushIntervalSeconds);
+	SettingsJson->SetBoolField(TEXT("compress_payloads"), Settings->bCompressPayloads);
+
+	OriginalSettings.Restore(*Settings);
+	LogHelika.SetVerbosity(OriginalVerbosity);
+
+	int64 Produced = 0;
+	int64 SendFailed = 0;
+	TArray<float> EnqueueLatenciesMs;
+	for (const TUniquePtr<FProducer>& Producer : Producers)
+	{
+		Produced += Producer->Produced;
+		SendFailed += Producer->SendFailed;
+		EnqueueLatenciesMs.Append(Producer->EnqueueLatenciesMs);
+	}
+
+	float GameThreadMsTotal = 0.f;
+	float GameThreadMsMax = 0.f;
+	for (const float Ms : GameThreadMsPerSecond)
+	{
+		GameThreadMsTotal += Ms;
+		GameThreadMsMax = FMath::Max(GameThreadMsMax, Ms);
+	}
+
+	const TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetStringField(TEXT("sdk_version"), Settings->SDKVersion);
+	Result->SetStringField(TEXT("engine_version"), FEngineVersion::Current().ToString());
+	Result->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	Result->SetObjectField(TEXT("profile"), Profile.ToJson());
+	Result->SetObjectField(TEXT("settings"), SettingsJson);
+
+	Result->SetNumberField(TEXT("duration_seconds"), DurationSeconds);
+	Result->SetNumberField(TEXT("events_produced"), Produced);
+	Result->SetNumberField(TEXT("events_per_second"), Produced / DurationSeconds);
+	if (Collector.IsValid())
+	{
+		Result->SetNumberField(TEXT("events_delivered"), Delivery.LatenciesMs.Num());
+		Result->SetNumberField(TEXT("delivered_events_per_second"), Delivery.LastDeliverySeconds > 0.0 ? Delivery.LatenciesMs.Num() / Delivery.LastDeliverySeconds : 0.0);
+	}
+	Result->SetObjectField(TEXT("enqueue_latency"), Summarize(EnqueueLatenciesMs));
+	if (Collector.IsValid())
+	{
+		Result->SetObjectField(TEXT("delivery_latency"), Summarize(Delivery.LatenciesMs));
+	}
+
+	const TSharedRef<FJsonObject> Memory = MakeShared<FJsonObject>();
+	Memory->SetNumberField(TEXT("baseline_bytes"), BaselineMemory);
+	Memory->SetNumberField(TEXT("peak_bytes"), PeakMemory);
+	Memory->SetNumberField(TEXT("peak_delta_bytes"), static_cast<double>(PeakMemory - BaselineMemory));
+	Memory->SetNumberField(TEXT("peak_queue_depth"), PeakQueueDepth);
+	Result->SetObjectField(TEXT("memory"), Memory);
+
+	const TSharedRef<FJsonObject> GameThread = MakeShared<FJsonObject>();
+	GameThread->SetNumberField(TEXT("mean_ms_per_second"), GameThreadMsPerSecond.IsEmpty() ? 0.f : GameThreadMsTotal / GameThreadMsPerSecond.Num());
+	GameThread->SetNumberField(TEXT("max_ms_per_second"), GameThreadMsMax);
+	Result->SetObjectField(TEXT("game_thread"), GameThread);
+
+	const TSharedRef<FJsonObject> Drops = MakeShared<FJsonObject>();
+	Drops->SetNumberField(TEXT("send_failed"), SendFailed);
+	Drops->SetNumberField(TEXT("rejected"), MetricsAfter.EventsRejected - MetricsBefore.EventsRejected);
+	Drops->SetNumberField(TEXT("sampled_out"), MetricsAfter.EventsSampledOut - MetricsBefore.EventsSampledOut);
+	Drops->SetNumberField(TEXT("dropped"), MetricsAfter.EventsDropped - MetricsBefore.EventsDropped);
+	if (Collector.IsValid())
+	{
+		Drops->SetNumberField(TEXT("undelivered"), Produced - Delivery.LatenciesMs.Num());
+	}
+	Result->SetObjectField(TEXT("drops"), Drops);
+
+	const TSharedRef<FJsonObject> Requests = MakeShared<FJsonObject>();
+	Requests->SetNumberField(TEXT("sent"), MetricsAfter.RequestsSent - MetricsBefore.RequestsSent);
+	Requests->SetNumberField(TEXT("succeeded"), MetricsAfter.RequestsSucceeded - MetricsBefore.RequestsSucceeded);
+	Requests->SetNumberField(TEXT("failed"), MetricsAfter.RequestsFailed - MetricsBefore.RequestsFailed);
+	Requests->SetNumberField(TEXT("bytes_before_compression"), MetricsAfter.BytesBeforeCompression - MetricsBefore.BytesBeforeCompression);
+	Requests->SetNumberField(TEXT("bytes_after_compression"), MetricsAfter.BytesAfterCompression - MetricsBefore.BytesAfterCompression);
+	Result->SetObjectField(TEXT("requests"), Requests);
+
+	const FString Json = ToJsonString(Result);
+	UE_LOG(LogHelika, Display, TEXT("HelikaLoadTest: %s"), *Json);
+
+	FString OutputFile = FPaths::ProjectSavedDir() / TEXT("HelikaLoadTest") / FString::Printf(TEXT("%s-%s.json"), *Profile.Name, *FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("output="), OutputFile);
+	if (!FFileHelper::SaveStringToFile(Json, *OutputFile))
+	{
+		UE_LOG(LogHelika, Error, TEXT("Could not write load test results to %s"), *OutputFile);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HelikaLoadTestCommandlet.generated.h"
+
+/**
+ * Drives UHelikaManager with a synthetic workload against the local collector and reports
+ * sustained throughput, enqueue and delivery latency percentiles, peak memory and drops as JSON.
+ *
+ * UnrealEditor-Cmd <Project> -run=HelikaLoadTest [-profile=steady|burst|server|stress] [-profilefile=<file.json>]
+ *     [-rate=events/s] [-duration=seconds] [-threads=N] [-minpayload=bytes] [-maxpayload=bytes]
+ *     [-burstsize=N] [-burstinterval=seconds] [-contexts=N] [-batchsize=N] [-flushinterval=seconds]
+ *     [-compress] [-nocollector] [-draintimeout=seconds] [-verbose] [-output=<file.json>]
+ */
+UCLASS()
+class UHelikaLoadTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UHelikaLoadTestCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
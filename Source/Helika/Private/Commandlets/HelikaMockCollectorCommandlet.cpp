@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaMockCollectorCommandlet.h"
+
+#include "HelikaDefines.h"
+#include "MockCollector/HelikaMockCollector.h"
+#include "Misc/FileHelper.h"
+
+UHelikaMockCollectorCommandlet::UHelikaMockCollectorCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Local Helika collector with latency, error status and connection drop injection");
+	HelpUsage = TEXT("-run=HelikaMockCollector [-port=8181] [-bindany] [-latency=ms] [-jitter=ms] [-errorrate=0..1] [-status=503] [-retryafter=s] [-droprate=0..1] [-rejectrate=0..1] [-retryrate=0..1] [-seed=N] [-duration=s] [-stats=file]");
+}
+
+int32 UHelikaMockCollectorCommandlet::Main(const FString& Params)
+{
+	FHelikaMockCollectorConfig Config;
+	FParse::Value(*Params, TEXT("port="), Config.Port);
+	Config.bBindAny = FParse::Param(*Params, TEXT("bindany"));
+	FParse::Value(*Params, TEXT("latency="), Config.LatencyMs);
+	FParse::Value(*Params, TEXT("jitter="), Config.LatencyJitterMs);
+	FParse::Value(*Params, TEXT("errorrate="), Config.ErrorRate);
+	FParse::Value(*Params, TEXT("status="), Config.ErrorStatus);
+	FParse::Value(*Params, TEXT("retryafter="), Config.RetryAfterSeconds);
+	FParse::Value(*Params, TEXT("droprate="), Config.DropRate);
+	FParse::Value(*Params, TEXT("rejectrate="), Config.EventRejectRate);
+	FParse::Value(*Params, TEXT("retryrate="), Config.EventRetryRate);
+	FParse::Value(*Params, TEXT("seed="), Config.Seed);
+
+	float DurationSeconds = 0.f;
+	FParse::Value(*Params, TEXT("duration="), DurationSeconds);
+	FString StatsFile;
+	FParse::Value(*Params, TEXT("stats="), StatsFile);
+
+	FHelikaMockCollector Collector(Config);
+	if (!Collector.Start())
+	{
+		return 1;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	double NextReport = StartTime + 5.0;
+	while (!IsEngineExitRequested() && (DurationSeconds <= 0.f || FPlatformTime::Seconds() - StartTime < DurationSeconds))
+	{
+		FPlatformProcess::Sleep(0.1f);
+
+		if (FPlatformTime::Seconds() >= NextReport)
+		{
+			NextReport += 5.0;
+			const FHelikaMockCollectorStats Stats = Collector.GetStats();
+			UE_LOG(LogHelika, Display, TEXT("Mock collector: %lld requests, %lld events, %lld accepted, %lld invalid, %lld injected errors, %lld dropped"),
+				Stats.Requests, Stats.Events, Stats.Accepted, Stats.Invalid, Stats.InjectedErrors, Stats.Dropped);
+		}
+	}
+
+	Collector.Stop();
+
+	const FHelikaMockCollectorStats Stats = Collector.GetStats();
+	UE_LOG(LogHelika, Display, TEXT("Mock collector stopped: %lld requests, %lld events, %lld wire bytes, %lld decoded bytes"), Stats.Requests, Stats.Events, Stats.WireBytes, Stats.DecodedBytes);
+	if (!StatsFile.IsEmpty() && !FFileHelper::SaveStringToFile(Stats.ToJson(), *StatsFile))
+	{
+		UE_LOG(LogHelika, Error, TEXT("Could not write mock collector stats to %s"), *StatsFile);
+		return 1;
+	}
+
+	return 0;
+}
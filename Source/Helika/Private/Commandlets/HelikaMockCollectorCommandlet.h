@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HelikaMockCollectorCommandlet.generated.h"
+
+/**
+ * Runs the local mock collector that the Localhost environment points to.
+ *
+ * UnrealEditor-Cmd <Project> -run=HelikaMockCollector [-port=8181] [-bindany] [-latency=ms]
+ *     [-jitter=ms] [-errorrate=0..1] [-status=429|500|503] [-retryafter=seconds] [-droprate=0..1]
+ *     [-rejectrate=0..1] [-retryrate=0..1] [-seed=N] [-duration=seconds] [-stats=<file.json>]
+ */
+UCLASS()
+class UHelikaMockCollectorCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UHelikaMockCollectorCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
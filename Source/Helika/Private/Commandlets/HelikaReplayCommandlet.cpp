@@ -0,0 +1,356 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaReplayCommandlet.h"
+
+#include "HelikaClock.h"
+#include "HelikaDefines.h"
+#include "HelikaEventRecorder.h"
+#include "HelikaJsonWriter.h"
+#include "HelikaLibrary.h"
+#include "HelikaManager.h"
+#include "HelikaMetricsCounters.h"
+#include "HelikaSettings.h"
+#include "HttpManager.h"
+#include "HttpModule.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "MockCollector/HelikaMockCollector.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace HelikaReplay
+{
+	/// Settings changed for the replay, restored afterwards
+	struct FHelikaSettingsBackup
+	{
+		explicit FHelikaSettingsBackup(const UHelikaSettings& Settings)
+			: HelikaAPIKey(Settings.HelikaAPIKey)
+			, GameId(Settings.GameId)
+			, HelikaEnvironment(Settings.HelikaEnvironment)
+			, Telemetry(Settings.Telemetry)
+			, bPrintEventsToConsole(Settings.bPrintEventsToConsole)
+			, bUploadOnLocalhost(Settings.bUploadOnLocalhost)
+			, MaxBatchSize(Settings.MaxBatchSize)
+			, FlushIntervalSeconds(Settings.FlushIntervalSeconds)
+			, CriticalLane(Settings.CriticalLane)
+			, BulkLane(Settings.BulkLane)
+			, EventSampleRate(Settings.EventSampleRate)
+			, GameThreadBudgetMicroseconds(Settings.GameThreadBudgetMicroseconds)
+			, bEnableGameMetrics(Settings.bEnableGameMetrics)
+			, bCompressPayloads(Settings.bCompressPayloads)
+			, bColumnarPayloads(Settings.bColumnarPayloads)
+		{
+		}
+
+		void Restore(UHelikaSettings& Settings) const
+		{
+			Settings.HelikaAPIKey = HelikaAPIKey;
+			Settings.GameId = GameId;
+			Settings.HelikaEnvironment = HelikaEnvironment;
+			Settings.Telemetry = Telemetry;
+			Settings.bPrintEventsToConsole = bPrintEventsToConsole;
+			Settings.bUploadOnLocalhost = bUploadOnLocalhost;
+			Settings.MaxBatchSize = MaxBatchSize;
+			Settings.FlushIntervalSeconds = FlushIntervalSeconds;
+			Settings.CriticalLane = CriticalLane;
+			Settings.BulkLane = BulkLane;
+			Settings.EventSampleRate = EventSampleRate;
+			Settings.GameThreadBudgetMicroseconds = GameThreadBudgetMicroseconds;
+			Settings.bEnableGameMetrics = bEnableGameMetrics;
+			Settings.bCompressPayloads = bCompressPayloads;
+			Settings.bColumnarPayloads = bColumnarPayloads;
+		}
+
+		FString HelikaAPIKey;
+		FString GameId;
+		EHelikaEnvironment HelikaEnvironment;
+		ETelemetryLevel Telemetry;
+		bool bPrintEventsToConsole;
+		bool bUploadOnLocalhost;
+		int32 MaxBatchSize;
+		float FlushIntervalSeconds;
+		FHelikaLaneSettings CriticalLane;
+		FHelikaLaneSettings BulkLane;
+		float EventSampleRate;
+		int32 GameThreadBudgetMicroseconds;
+		bool bEnableGameMetrics;
+		bool bCompressPayloads;
+		bool bColumnarPayloads;
+	};
+
+	/// Flush intervals of the replay, long enough that only full envelopes and the final flush cut batches
+	constexpr float NoTimedFlushSeconds = 24.f * 3600.f;
+
+	static TSharedPtr<FJsonObject> Parse(const TArray<uint8>& Utf8)
+	{
+		TSharedPtr<FJsonObject> Object;
+		if (Utf8.Num() > 0)
+		{
+			FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FHelikaJsonWriter::ToString(Utf8)), Object);
+		}
+		return Object;
+	}
+
+	/// Runs the ticker (scheduled flushes) and the HTTP completions like a frame would
+	static void Pump(float DeltaSeconds)
+	{
+		FTSTicker::GetCoreTicker().Tick(DeltaSeconds);
+		FHttpModule::Get().GetHttpManager().Tick(DeltaSeconds);
+	}
+
+	static FString ToJsonString(const TSharedRef<FJsonObject>& Json)
+	{
+		FString Output;
+		const TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Output);
+		FJsonSerializer::Serialize(Json, Writer);
+		return Output;
+	}
+}
+
+UHelikaReplayCommandlet::UHelikaReplayCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Replays an event recording through the Helika SDK against the local collector with a deterministic clock and ids");
+	HelpUsage = TEXT("-run=HelikaReplay -trace=file [-speed=1] [-seed=N] [-payloads=dir] [-batchsize=N] [-compress] [-columnar] [-nocollector] [-output=file]");
+}
+
+int32 UHelikaReplayCommandlet::Main(const FString& Params)
+{
+	using namespace HelikaReplay;
+
+	FString TraceFile;
+	if (!FParse::Value(*Params, TEXT("trace="), TraceFile))
+	{
+		UE_LOG(LogHelika, Error, TEXT("HelikaReplay needs -trace=<file>"));
+		return 1;
+	}
+
+	FHelikaEventRecordReader Reader;
+	if (!Reader.Open(TraceFile))
+	{
+		return 1;
+	}
+
+	// 1 replays at the recorded pace, 2 twice as fast, 0 as fast as possible
+	float Speed = 1.f;
+	FParse::Value(*Params, TEXT("speed="), Speed);
+	Speed = FMath::Max(Speed, 0.f);
+	uint32 Seed = 0;
+	FParse::Value(*Params, TEXT("seed="), Seed);
+	FString PayloadDirectory;
+	FParse::Value(*Params, TEXT("payloads="), PayloadDirectory);
+
+	// Installed before the session id is generated, created_at follows the recorded timeline at any speed
+	FHelikaManualClock Clock(Reader.GetStartTime());
+	FHelikaSequentialIdGenerator IdGenerator(Seed);
+	FHelikaClock::SetClock(&Clock);
+	FHelikaClock::SetIdGenerator(&IdGenerator);
+
+	TArray<TArray<uint8>> Payloads;
+	FCriticalSection PayloadsLock;
+	TUniquePtr<FHelikaMockCollector> Collector;
+	if (!FParse::Param(*Params, TEXT("nocollector")))
+	{
+		Collector = MakeUnique<FHelikaMockCollector>(FHelikaMockCollectorConfig());
+		Collector->SetOnBatchAccepted([&Payloads, &PayloadsLock](TConstArrayView<uint8> Body)
+		{
+			FScopeLock Lock(&PayloadsLock);
+			Payloads.Emplace(Body);
+		});
+		if (!Collector->Start())
+		{
+			FHelikaClock::SetClock(nullptr);
+			FHelikaClock::SetIdGenerator(nullptr);
+			return 1;
+		}
+	}
+
+	// Point the SDK at the local collector and take timing out of batching, the settings are not saved
+	UHelikaSettings* Settings = UHelikaLibrary::GetHelikaSettings();
+	const FHelikaSettingsBackup OriginalSettings(*Settings);
+	Settings->HelikaAPIKey = Settings->HelikaAPIKey.IsEmpty() ? TEXT("ReplayAPIKey") : Settings->HelikaAPIKey;
+	Settings->GameId = Settings->GameId.IsEmpty() ? TEXT("ReplayGame") : Settings->GameId;
+	Settings->HelikaEnvironment = EHelikaEnvironment::HE_Localhost;
+	Settings->bUploadOnLocalhost = true;
+	Settings->Telemetry = ETelemetryLevel::TL_TelemetryOnly;
+	Settings->bPrintEventsToConsole = false;
+	// The recording holds the events that passed sampling in production
+	Settings->EventSampleRate = 1.f;
+	Settings->bEnableGameMetrics = false;
+	Settings->GameThreadBudgetMicroseconds = 1000000;
+	Settings->FlushIntervalSeconds = NoTimedFlushSeconds;
+	Settings->CriticalLane.FlushIntervalSeconds = NoTimedFlushSeconds;
+	Settings->BulkLane.FlushIntervalSeconds = NoTimedFlushSeconds;
+	FParse::Value(*Params, TEXT("batchsize="), Settings->MaxBatchSize);
+	Settings->bCompressPayloads |= FParse::Param(*Params, TEXT("compress"));
+	Settings->bColumnarPayloads |= FParse::Param(*Params, TEXT("columnar"));
+
+	const ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	if (!FParse::Param(*Params, TEXT("verbose")))
+	{
+		LogHelika.SetVerbosity(ELogVerbosity::Warning);
+	}
+
+	UHelikaManager* Manager = NewObject<UHelikaManager>();
+	Manager->AddToRoot();
+	Manager->InitializeSDK();
+
+	const FHelikaMetrics MetricsBefore = FHelikaMetricsCounters::Read();
+	const double StartTime = FPlatformTime::Seconds();
+	double LastPump = StartTime;
+
+	// Recorded context ids are mapped to the contexts of this run, INDEX_NONE is the manager's own user
+	TMap<int32, FHelikaContext> Contexts;
+	int64 NumEvents = 0;
+	int64 NumContextVersions = 0;
+	int64 NumSendFailed = 0;
+	int64 LastTimestampUs = 0;
+
+	FHelikaRecordedContext RecordedContext;
+	FHelikaRecordedEvent RecordedEvent;
+	for (FHelikaEventRecordReader::ERecord Record = Reader.Next(RecordedContext, RecordedEvent); Record != FHelikaEventRecordReader::ERecord::End && !IsEngineExitRequested();
+		Record = Reader.Next(RecordedContext, RecordedEvent))
+	{
+		if (Record == FHelikaEventRecordReader::ERecord::Context)
+		{
+			++NumContextVersions;
+			const TSharedPtr<FJsonObject> UserDetails = Parse(RecordedContext.UserDetails);
+			const TSharedPtr<FJsonObject> MatchMetadata = Parse(RecordedContext.MatchMetadata);
+			if (RecordedContext.ContextId == INDEX_NONE)
+			{
+				if (UserDetails.IsValid())
+				{
+					Manager->SetUserDetails(UserDetails);
+				}
+			}
+			else if (const FHelikaContext* Context = Contexts.Find(RecordedContext.ContextId))
+			{
+				Manager->SetContextUserDetails(*Context, UserDetails);
+				Manager->SetContextMatchMetadata(*Context, MatchMetadata);
+			}
+			else
+			{
+				Contexts.Add(RecordedContext.ContextId, Manager->CreateContext(UserDetails, MatchMetadata));
+			}
+			continue;
+		}
+
+		// Wait for the recorded time of the event, the SDK keeps ticking meanwhile
+		if (Speed > 0.f)
+		{
+			const double DueTime = StartTime + RecordedEvent.TimestampUs / 1000000.0 / Speed;
+			for (double Now = FPlatformTime::Seconds(); Now < DueTime; Now = FPlatformTime::Seconds())
+			{
+				Pump(static_cast<float>(Now - LastPump));
+				LastPump = Now;
+				FPlatformProcess::Sleep(static_cast<float>(FMath::Min(DueTime - Now, 0.001)));
+			}
+		}
+		Clock.Set(Reader.GetStartTime() + FTimespan::FromMicroseconds(static_cast<double>(RecordedEvent.TimestampUs)));
+		LastTimestampUs = RecordedEvent.TimestampUs;
+
+		const TSharedPtr<FJsonObject> Event = Parse(RecordedEvent.Payload);
+		bool bSent = false;
+		switch (RecordedEvent.Send)
+		{
+		case EHelikaRecordedSend::Game:
+			bSent = Manager->SendEvent(Event, RecordedEvent.Priority);
+			break;
+		case EHelikaRecordedSend::User:
+			bSent = Manager->SendUserEvent(Event, RecordedEvent.Priority);
+			break;
+		case EHelikaRecordedSend::Context:
+			bSent = Manager->SendContextEvent(Contexts.FindRef(RecordedEvent.ContextId), Event, RecordedEvent.Priority);
+			break;
+		}
+		++NumEvents;
+		NumSendFailed += bSent ? 0 : 1;
+
+		// A lane that filled up is flushed before the next event, as it would be in the next frame
+		const double Now = FPlatformTime::Seconds();
+		Pump(static_cast<float>(Now - LastPump));
+		LastPump = Now;
+	}
+	const bool bTraceComplete = !Reader.HasError();
+
+	Manager->Flush();
+	float DrainTimeoutSeconds = 30.f;
+	FParse::Value(*Params, TEXT("draintimeout="), DrainTimeoutSeconds);
+	const double DrainEnd = FPlatformTime::Seconds() + DrainTimeoutSeconds;
+	while (FPlatformTime::Seconds() < DrainEnd && !IsEngineExitRequested()
+		&& (FHelikaMetricsCounters::Sum(EHelikaCounter::QueueDepth) > 0 || FHelikaMetricsCounters::Sum(EHelikaCounter::BytesInFlight) > 0))
+	{
+		Pump(0.01f);
+		FPlatformProcess::Sleep(0.01f);
+	}
+	const double DurationSeconds = FPlatformTime::Seconds() - StartTime;
+	const FHelikaMetrics MetricsAfter = FHelikaMetricsCounters::Read();
+
+	Manager->DeinitializeSDK();
+	Manager->RemoveFromRoot();
+	if (Collector.IsValid())
+	{
+		Collector->Stop();
+	}
+	FHelikaClock::SetClock(nullptr);
+	FHelikaClock::SetIdGenerator(nullptr);
+	OriginalSettings.Restore(*Settings);
+	LogHelika.SetVerbosity(OriginalVerbosity);
+
+	// Requests complete in any order, the deterministic batch ids restore the send order
+	TArray<TPair<FString, int32>> Order;
+	for (int32 Index = 0; Index < Payloads.Num(); ++Index)
+	{
+		const TSharedPtr<FJsonObject> Body = Parse(Payloads[Index]);
+		Order.Emplace(Body.IsValid() ? Body->GetStringField(TEXT("id")) : FString(), Index);
+	}
+	Order.Sort([](const TPair<FString, int32>& A, const TPair<FString, int32>& B) { return A.Key < B.Key; });
+
+	int64 PayloadBytes = 0;
+	for (int32 Position = 0; Position < Order.Num(); ++Position)
+	{
+		const TArray<uint8>& Payload = Payloads[Order[Position].Value];
+		PayloadBytes += Payload.Num();
+		if (!PayloadDirectory.IsEmpty() && !FFileHelper::SaveArrayToFile(Payload, *(PayloadDirectory / FString::Printf(TEXT("%06d.json"), Position))))
+		{
+			UE_LOG(LogHelika, Error, TEXT("Could not write replayed payloads to %s"), *PayloadDirectory);
+			return 1;
+		}
+	}
+
+	const TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetStringField(TEXT("trace"), TraceFile);
+	Result->SetBoolField(TEXT("trace_complete"), bTraceComplete);
+	Result->SetNumberField(TEXT("speed"), Speed);
+	Result->SetNumberField(TEXT("seed"), Seed);
+	Result->SetNumberField(TEXT("recorded_seconds"), LastTimestampUs / 1000000.0);
+	Result->SetNumberField(TEXT("duration_seconds"), DurationSeconds);
+	Result->SetNumberField(TEXT("events_replayed"), NumEvents);
+	Result->SetNumberField(TEXT("context_versions"), NumContextVersions);
+	Result->SetNumberField(TEXT("send_failed"), NumSendFailed);
+	Result->SetNumberField(TEXT("events_sent"), MetricsAfter.EventsSent - MetricsBefore.EventsSent);
+	Result->SetNumberField(TEXT("events_dropped"), MetricsAfter.EventsDropped - MetricsBefore.EventsDropped);
+	Result->SetNumberField(TEXT("requests_sent"), MetricsAfter.RequestsSent - MetricsBefore.RequestsSent);
+	Result->SetNumberField(TEXT("bytes_before_compression"), MetricsAfter.BytesBeforeCompression - MetricsBefore.BytesBeforeCompression);
+	Result->SetNumberField(TEXT("bytes_after_compression"), MetricsAfter.BytesAfterCompression - MetricsBefore.BytesAfterCompression);
+	Result->SetNumberField(TEXT("payloads"), Payloads.Num());
+	Result->SetNumberField(TEXT("payload_bytes"), PayloadBytes);
+
+	const FString Json = ToJsonString(Result);
+	UE_LOG(LogHelika, Display, TEXT("HelikaReplay: %s"), *Json);
+
+	FString OutputFile;
+	if (FParse::Value(*Params, TEXT("output="), OutputFile) && !FFileHelper::SaveStringToFile(Json, *OutputFile))
+	{
+		UE_LOG(LogHelika, Error, TEXT("Could not write replay results to %s"), *OutputFile);
+		return 1;
+	}
+
+	return bTraceComplete ? 0 : 1;
+}
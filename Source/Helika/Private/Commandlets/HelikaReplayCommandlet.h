@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "HelikaReplayCommandlet.generated.h"
+
+/**
+ * Feeds an event recording (see UHelikaManager::StartEventRecording) back through UHelikaManager against the local collector,
+ * at the recorded pace or faster, and writes every uploaded payload so two runs can be diffed.
+ *
+ * Times and ids come from a deterministic clock and id generator and envelopes are only cut by size,
+ * so the same trace replayed with the same settings and -seed produces identical payloads.
+ *
+ * UnrealEditor-Cmd <Project> -run=HelikaReplay -trace=<file> [-speed=1] [-seed=N] [-payloads=<dir>]
+ *     [-batchsize=N] [-compress] [-columnar] [-nocollector] [-output=<file.json>]
+ */
+UCLASS()
+class UHelikaReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UHelikaReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
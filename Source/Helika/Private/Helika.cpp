@@ -2,7 +2,10 @@
 
 #include "Helika.h"
 
+#include "HelikaDebugSink.h"
 #include "HelikaDefines.h"
+#include "HelikaMemoryCounters.h"
+#include "HelikaMetricsCounters.h"
 #include "HelikaSettings.h"
 #include "Developer/Settings/Public/ISettingsModule.h"
 
@@ -21,11 +24,24 @@ void FHelikaModule::StartupModule()
 			ModuleSettings);
 	}
 
+#if STATS
+	StatsTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([](float DeltaTime)
+	{
+		FHelikaMemoryCounters::PublishStats();
+		return FHelikaMetricsCounters::PublishStats(DeltaTime);
+	}));
+#endif
+
 	UE_LOG(LogHelika, Log, TEXT("Helika module started"))
 }
 
 void FHelikaModule::ShutdownModule()
 {
+	FTSTicker::GetCoreTicker().RemoveTicker(StatsTickerHandle);
+	StatsTickerHandle.Reset();
+
+	FHelikaDebugSink::Get().Shutdown();
+
 	if(ISettingsModule* SettingsModule = FModuleManager::GetModulePtr<ISettingsModule>("Settings"))
 	{
 		SettingsModule->UnregisterSettings("Project", "Plugins", "Helika");
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaAcknowledgement.h"
+
+#include "HelikaDefines.h"
+#include "HelikaEventQueue.h"
+#include "HelikaMetricsCounters.h"
+#include "HelikaSpillStore.h"
+#include "HelikaTrace.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+FHelikaAcknowledgement FHelikaAcknowledgement::Parse(int32 NumEvents, int32 Status, TConstArrayView<uint8> Body)
+{
+	HELIKA_TRACE_SCOPE("Acknowledgement");
+
+	const bool bRetryable = IsRetryableStatus(Status);
+	EHelikaEventResult BatchResult = EHttpResponseCodes::IsOk(Status) ? EHelikaEventResult::Accepted : bRetryable ? EHelikaEventResult::Retry : EHelikaEventResult::Invalid;
+
+	// A transient failure says nothing about individual events, only look for a list otherwise
+	const TArray<TSharedPtr<FJsonValue>>* Rejected = nullptr;
+	TSharedPtr<FJsonObject> Answer;
+	if (!bRetryable && Body.Num() > 0 && Body[0] == '{')
+	{
+		const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Body.GetData()), Body.Num());
+		const FString Json(Converter.Length(), Converter.Get());
+		if (FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Answer) && Answer.IsValid() && Answer->TryGetArrayField(TEXT("rejected"), Rejected))
+		{
+			BatchResult = EHelikaEventResult::Accepted;
+		}
+	}
+
+	FHelikaAcknowledgement Acknowledgement;
+	Acknowledgement.Results.Init(BatchResult, NumEvents);
+
+	if (Rejected != nullptr)
+	{
+		for (const TSharedPtr<FJsonValue>& Value : *Rejected)
+		{
+			const TSharedPtr<FJsonObject>* Entry = nullptr;
+			int32 Index = INDEX_NONE;
+			if (!Value.IsValid() || !Value->TryGetObject(Entry) || !(*Entry)->TryGetNumberField(TEXT("index"), Index) || !Acknowledgement.Results.IsValidIndex(Index))
+			{
+				UE_LOG(LogHelika, Warning, TEXT("Ignoring malformed entry in the collector's rejected list"));
+				continue;
+			}
+
+			bool bEntryRetryable = false;
+			(*Entry)->TryGetBoolField(TEXT("retryable"), bEntryRetryable);
+			Acknowledgement.Results[Index] = bEntryRetryable ? EHelikaEventResult::Retry : EHelikaEventResult::Invalid;
+
+			FString Reason;
+			if (!bEntryRetryable && (*Entry)->TryGetStringField(TEXT("reason"), Reason))
+			{
+				UE_LOG(LogHelika, Verbose, TEXT("Collector rejected event %d: %s"), Index, *Reason);
+			}
+		}
+	}
+
+	for (const EHelikaEventResult Result : Acknowledgement.Results)
+	{
+		Acknowledgement.NumAccepted += Result == EHelikaEventResult::Accepted;
+		Acknowledgement.NumInvalid += Result == EHelikaEventResult::Invalid;
+		Acknowledgement.NumRetry += Result == EHelikaEventResult::Retry;
+	}
+	return Acknowledgement;
+}
+
+bool FHelikaAcknowledgement::IsRetryableStatus(int32 Status)
+{
+	return Status == 0 || Status == 408 || Status == 429 || Status >= 500;
+}
+
+int32 FHelikaAcknowledgement::Apply(TArray<FHelikaQueuedEvent>&& Events, FHelikaEventQueue* Queue, int32 MaxRetries) const
+{
+	if (Events.Num() != Results.Num())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Acknowledgement for %d events applied to a batch of %d"), Results.Num(), Events.Num());
+		return 0;
+	}
+
+	int32 NumExhausted = 0;
+	TArray<FHelikaQueuedEvent> ToRetry;
+	if (Queue != nullptr && NumRetry > 0)
+	{
+		ToRetry.Reserve(NumRetry);
+		for (int32 Index = 0; Index < Events.Num(); ++Index)
+		{
+			if (Results[Index] != EHelikaEventResult::Retry)
+			{
+				continue;
+			}
+			if (Events[Index].NumRetries >= MaxRetries)
+			{
+				++NumExhausted;
+				continue;
+			}
+			++Events[Index].NumRetries;
+			ToRetry.Add(MoveTemp(Events[Index]));
+		}
+	}
+	else
+	{
+		NumExhausted = NumRetry;
+	}
+
+	// Requeued events were moved out, the others leave the pipeline here
+	for (int32 Index = 0; Index < Events.Num(); ++Index)
+	{
+		if (Events[Index].Delivery.IsValid())
+		{
+			Events[Index].Delivery->Settle(Results[Index] == EHelikaEventResult::Accepted ? EHelikaDeliveryResult::HD_Delivered
+				: Results[Index] == EHelikaEventResult::Invalid ? EHelikaDeliveryResult::HD_Invalid : EHelikaDeliveryResult::HD_OutOfRetries);
+		}
+	}
+
+	const int32 NumRequeued = ToRetry.Num();
+	if (NumRequeued > 0)
+	{
+		Queue->Requeue(MoveTemp(ToRetry));
+		FHelikaMetricsCounters::Add(EHelikaCounter::QueueDepth, NumRequeued);
+		FHelikaMetricsCounters::Add(EHelikaCounter::Retries, NumRequeued);
+	}
+
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsSent, NumAccepted);
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsDropped, NumInvalid + NumExhausted);
+	if (NumInvalid + NumExhausted > 0)
+	{
+		UE_LOG(LogHelika, Warning, TEXT("Dropped %d events refused by the collector and %d out of retries"), NumInvalid, NumExhausted);
+	}
+	return NumRequeued;
+}
+
+int32 FHelikaAcknowledgement::ApplySpilled(FHelikaSpillStore& SpillStore, const FHelikaSpilledBatch& Batch, int32 MaxRetries, int64 MaxSpillBytes) const
+{
+	// The events are no longer in memory, the ones to retry are copied out of the file before it goes
+	int32 NumExhausted = 0;
+	int32 NumRespilled = 0;
+	if (NumRetry > 0 && Batch.NumRetries < MaxRetries)
+	{
+		TArray<int32> ToRetry;
+		ToRetry.Reserve(NumRetry);
+		for (int32 Index = 0; Index < Results.Num(); ++Index)
+		{
+			if (Results[Index] == EHelikaEventResult::Retry)
+			{
+				ToRetry.Add(Index);
+			}
+		}
+		const int32 NumLost = SpillStore.WriteRetries(Batch, ToRetry, MaxSpillBytes);
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsShed, NumLost);
+		NumRespilled = FMath::Max(NumRetry - NumLost, 0);
+		FHelikaMetricsCounters::Add(EHelikaCounter::Retries, NumRespilled);
+	}
+	else
+	{
+		NumExhausted = NumRetry;
+	}
+	SpillStore.Remove(Batch);
+
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsSent, NumAccepted);
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsDropped, NumInvalid + NumExhausted);
+	if (NumInvalid + NumExhausted > 0)
+	{
+		UE_LOG(LogHelika, Warning, TEXT("Dropped %d spilled events refused by the collector and %d out of retries"), NumInvalid, NumExhausted);
+	}
+	return NumRespilled;
+}
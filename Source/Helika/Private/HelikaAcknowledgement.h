@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaEventTypes.h"
+
+class FHelikaEventQueue;
+class FHelikaSpillStore;
+struct FHelikaSpilledBatch;
+
+/// Outcome of one event of an uploaded batch
+enum class EHelikaEventResult : uint8
+{
+	Accepted,
+	/// Refused by the collector, sending it again cannot succeed
+	Invalid,
+	/// Failed transiently, the event can be queued again
+	Retry
+};
+
+/**
+ * Per-event outcome of an upload, parsed from the collector's answer.
+ *
+ * The collector lists the events it did not store by their position in the batch:
+ *   {"message": "...", "rejected": [{"index": 3, "retryable": false, "reason": "..."}]}
+ * Events that are not listed were stored. Without such a list the status settles the whole batch,
+ * 2xx is accepted, connection failures, 408, 429 and 5xx are retried and anything else is invalid.
+ */
+struct FHelikaAcknowledgement
+{
+	TArray<EHelikaEventResult> Results;
+	int32 NumAccepted = 0;
+	int32 NumInvalid = 0;
+	int32 NumRetry = 0;
+
+	/// Status is 0 when the request could not connect
+	static FHelikaAcknowledgement Parse(int32 NumEvents, int32 Status, TConstArrayView<uint8> Body);
+
+	static bool IsRetryableStatus(int32 Status);
+
+	/**
+	 * Settles the batch the acknowledgement was parsed for: accepted and invalid events are released,
+	 * events to retry go back to the front of Queue until they used MaxRetries attempts.
+	 * Queue may be null once the manager is gone, retries are dropped then. Returns the number of events queued again.
+	 */
+	int32 Apply(TArray<FHelikaQueuedEvent>&& Events, FHelikaEventQueue* Queue, int32 MaxRetries) const;
+
+	/**
+	 * Settles a batch uploaded from the spill directory and deletes its file: events to retry are spilled again as a new batch
+	 * until they used MaxRetries attempts. Returns the number of events spilled again.
+	 */
+	int32 ApplySpilled(FHelikaSpillStore& SpillStore, const FHelikaSpilledBatch& Batch, int32 MaxRetries, int64 MaxSpillBytes) const;
+};
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaAsyncActions.h"
+
+#include "HelikaDelivery.h"
+#include "HelikaManager.h"
+
+UHelikaSendEventAsyncAction* UHelikaSendEventAsyncAction::SendHelikaEventAsync(UObject* WorldContextObject, const FHelikaJsonObject& EventProps, EHelikaPriority Priority, bool bIsUserEvent)
+{
+	UHelikaSendEventAsyncAction* Action = NewObject<UHelikaSendEventAsyncAction>();
+	Action->EventProps = EventProps;
+	Action->Priority = Priority;
+	Action->bIsUserEvent = bIsUserEvent;
+	Action->RegisterWithGameInstance(WorldContextObject);
+	return Action;
+}
+
+void UHelikaSendEventAsyncAction::Activate()
+{
+	// The delivery settles on a later game thread tick, after OnQueued
+	const FHelikaDeliveryPtr Delivery = MakeShared<FHelikaDelivery, ESPMode::ThreadSafe>([WeakThis = TWeakObjectPtr<UHelikaSendEventAsyncAction>(this)](EHelikaDeliveryResult Result)
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->HandleSettled(Result);
+		}
+	});
+
+	if (UHelikaManager::Get()->SendTrackedEvent(EventProps.Object, Priority, bIsUserEvent, Delivery))
+	{
+		OnQueued.Broadcast(EHelikaDeliveryResult::HD_Queued);
+	}
+	EventProps.Object.Reset();
+}
+
+void UHelikaSendEventAsyncAction::HandleSettled(EHelikaDeliveryResult Result)
+{
+	if (Result == EHelikaDeliveryResult::HD_Delivered)
+	{
+		OnDelivered.Broadcast(Result);
+	}
+	else
+	{
+		OnFailed.Broadcast(Result);
+	}
+	SetReadyToDestroy();
+}
+
+UHelikaFlushAsyncAction* UHelikaFlushAsyncAction::FlushHelikaAsync(UObject* WorldContextObject)
+{
+	UHelikaFlushAsyncAction* Action = NewObject<UHelikaFlushAsyncAction>();
+	Action->RegisterWithGameInstance(WorldContextObject);
+	return Action;
+}
+
+void UHelikaFlushAsyncAction::Activate()
+{
+	UHelikaManager::Get()->Flush(MakeShared<FHelikaDelivery, ESPMode::ThreadSafe>([WeakThis = TWeakObjectPtr<UHelikaFlushAsyncAction>(this)](EHelikaDeliveryResult Result)
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->HandleSettled(Result);
+		}
+	}));
+}
+
+void UHelikaFlushAsyncAction::HandleSettled(EHelikaDeliveryResult Result)
+{
+	if (Result == EHelikaDeliveryResult::HD_Delivered)
+	{
+		OnDelivered.Broadcast(Result);
+	}
+	else
+	{
+		OnFailed.Broadcast(Result);
+	}
+	SetReadyToDestroy();
+}
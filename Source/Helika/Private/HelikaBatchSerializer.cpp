@@ -0,0 +1,686 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaBatchSerializer.h"
+
+#include "HelikaClock.h"
+#include "HelikaConfigSnapshot.h"
+#include "HelikaJsonLibrary.h"
+#include "HelikaDefines.h"
+#include "HelikaJsonWriter.h"
+#include "HelikaMetricsCounters.h"
+#include "HelikaTrace.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/App.h"
+
+namespace HelikaBatchSerializer
+{
+	static const FString EventField = TEXT("event");
+	static const FString HelikaDataField = TEXT("helika_data");
+	static const FString AppDetailsField = TEXT("app_details");
+	static const FString UserDetailsField = TEXT("user_details");
+	static const FString MatchMetadataField = TEXT("match_metadata");
+	static const FString EventSubTypeField = TEXT("event_sub_type");
+	static const FString TruncatedField = TEXT("truncated");
+	static const FString SessionIdField = TEXT("session_id");
+	static const FString UserIdField = TEXT("user_id");
+	static const FString GameIdField = TEXT("game_id");
+	static const FString CreatedAtField = TEXT("created_at");
+
+	/// Closing brackets of the envelope, written after the last event
+	constexpr int64 EnvelopeEndBytes = 2;
+	/// Room kept for the "truncated" marker and the "..." of cut strings
+	constexpr int64 TruncationSlackBytes = 32;
+	/// Events encoded by one task of the parallel path
+	constexpr int32 ParallelChunkEvents = 128;
+
+	/// The context blocks WriteInternalEvent adds to the internal event
+	static bool IsContextBlockField(const FString& Key)
+	{
+		return Key == HelikaDataField || Key == AppDetailsField || Key == UserDetailsField || Key == MatchMetadataField;
+	}
+
+	/// Key written for a field of Object, a rename onto a name the object already has keeps the old key so no key is written twice.
+	/// bHasContextBlocks also counts the context blocks of the internal event as taken.
+	static const FString& GetWrittenKey(const FHelikaEventRules::FNode* Node, const FString& Key, const FJsonObject& Object, bool bHasContextBlocks = false)
+	{
+		if (Node == nullptr || Node->RenameTo.IsEmpty() || Object.HasField(Node->RenameTo) || (bHasContextBlocks && IsContextBlockField(Node->RenameTo)))
+		{
+			return Key;
+		}
+		return Node->RenameTo;
+	}
+}
+
+std::atomic<float> FHelikaBatchSerializer::CompressionRatio{0.5f};
+
+void FHelikaBatchSerializer::Serialize(TConstArrayView<FHelikaQueuedEvent> Events, TArray<uint8>& OutPayload)
+{
+	HELIKA_TRACE_SCOPE("Serialization");
+
+	FHelikaJsonWriter Writer(OutPayload);
+	Writer.WriteObjectStart();
+	Writer.WriteStringField(TEXT("id"), FHelikaClock::NewGuid().ToString());
+	Writer.WriteKey(TEXT("events"));
+	Writer.WriteArrayStart();
+	for (const FHelikaQueuedEvent& Event : Events)
+	{
+		const FHelikaEventRules::FRuleSet* Rules = MatchRules(Event);
+		if (Rules != nullptr && Rules->bDrop)
+		{
+			FHelikaMetricsCounters::Add(EHelikaCounter::EventsFiltered);
+			if (Event.Delivery.IsValid())
+			{
+				Event.Delivery->Settle(EHelikaDeliveryResult::HD_Filtered);
+			}
+			continue;
+		}
+		WriteEvent(Writer, Event, Rules);
+	}
+	Writer.WriteArrayEnd();
+	Writer.WriteObjectEnd();
+}
+
+int32 FHelikaBatchSerializer::SerializeBudgeted(TConstArrayView<FHelikaQueuedEvent> Events, const FHelikaBatchLimits& Limits, int64 MaxBatchBytes, TArray<uint8>& OutPayload, TArray<int32>& OutWritten,
+	TArray<int32>* OutFiltered)
+{
+	HELIKA_TRACE_SCOPE("Serialization");
+
+	OutWritten.Reset();
+	if (OutFiltered != nullptr)
+	{
+		OutFiltered->Reset();
+	}
+	FHelikaJsonWriter Writer(OutPayload);
+	Writer.WriteObjectStart();
+	Writer.WriteStringField(TEXT("id"), FHelikaClock::NewGuid().ToString());
+	Writer.WriteKey(TEXT("events"));
+	Writer.WriteArrayStart();
+
+	int32 NumConsumed = 0;
+	if (Limits.ParallelThreshold > 0 && Events.Num() >= Limits.ParallelThreshold && FApp::ShouldUseThreads())
+	{
+		NumConsumed = SerializeParallel(Events, Limits, MaxBatchBytes, Writer, OutPayload, OutWritten, OutFiltered);
+	}
+	else
+	{
+		FEncodedEvent Encoded;
+		for (; NumConsumed < Events.Num(); ++NumConsumed)
+		{
+			// The writer keeps no state besides the buffer, rolling back is cutting it
+			const int32 EventStart = OutPayload.Num();
+			if (OutWritten.Num() > 0)
+			{
+				OutPayload.Add(',');
+			}
+			EncodeEvent(Events[NumConsumed], Limits, OutPayload, Encoded);
+			if (!CommitEvent(Events[NumConsumed], NumConsumed, Encoded, EventStart, Writer, MaxBatchBytes, OutPayload, OutWritten, OutFiltered))
+			{
+				break;
+			}
+		}
+	}
+
+	Writer.WriteArrayEnd();
+	Writer.WriteObjectEnd();
+	return NumConsumed;
+}
+
+int32 FHelikaBatchSerializer::SerializeParallel(TConstArrayView<FHelikaQueuedEvent> Events, const FHelikaBatchLimits& Limits, int64 MaxBatchBytes, FHelikaJsonWriter& Writer,
+	TArray<uint8>& OutPayload, TArray<int32>& OutWritten, TArray<int32>* OutFiltered)
+{
+	using namespace HelikaBatchSerializer;
+	HELIKA_TRACE_SCOPE("ParallelSerialization");
+
+	// The calling thread runs chunks as well
+	const int32 NumThreads = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	const int32 NumTasks = Limits.MaxParallelTasks > 0 ? FMath::Min(Limits.MaxParallelTasks, NumThreads) : NumThreads;
+
+	// Each chunk has its own block caches, the ones of this serializer are not thread safe
+	struct FChunk
+	{
+		FHelikaBatchSerializer Serializer;
+		TArray<uint8> Buffer;
+		TArray<FEncodedEvent> Encoded;
+	};
+	TArray<FChunk> Chunks;
+	Chunks.SetNum(NumTasks);
+
+	// One wave at a time, so that little is encoded in vain past the event where the budget cuts the envelope
+	int32 NumConsumed = 0;
+	while (NumConsumed < Events.Num())
+	{
+		const int32 WaveStart = NumConsumed;
+		const int32 WaveEnd = FMath::Min(WaveStart + NumTasks * ParallelChunkEvents, Events.Num());
+		const int32 NumChunks = FMath::DivideAndRoundUp(WaveEnd - WaveStart, ParallelChunkEvents);
+		ParallelFor(NumChunks, [&Chunks, &Events, &Limits, WaveStart, WaveEnd](int32 ChunkIndex)
+		{
+			FChunk& Chunk = Chunks[ChunkIndex];
+			const int32 First = WaveStart + ChunkIndex * ParallelChunkEvents;
+			const int32 Last = FMath::Min(First + ParallelChunkEvents, WaveEnd);
+			Chunk.Buffer.Reset();
+			Chunk.Encoded.SetNum(Last - First, false);
+			for (int32 Index = First; Index < Last; ++Index)
+			{
+				Chunk.Serializer.EncodeEvent(Events[Index], Limits, Chunk.Buffer, Chunk.Encoded[Index - First]);
+			}
+		});
+
+		// Counters, separators and the budget cut are applied in event order, exactly as on the calling thread
+		for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+		{
+			const FChunk& Chunk = Chunks[ChunkIndex];
+			for (const FEncodedEvent& Encoded : Chunk.Encoded)
+			{
+				const int32 EventStart = OutPayload.Num();
+				if (Encoded.Result == EEncodedResult::Written)
+				{
+					if (OutWritten.Num() > 0)
+					{
+						OutPayload.Add(',');
+					}
+					OutPayload.Append(Chunk.Buffer.GetData() + Encoded.Offset, Encoded.Size);
+				}
+				if (!CommitEvent(Events[NumConsumed], NumConsumed, Encoded, EventStart, Writer, MaxBatchBytes, OutPayload, OutWritten, OutFiltered))
+				{
+					return NumConsumed;
+				}
+				++NumConsumed;
+			}
+		}
+	}
+	return NumConsumed;
+}
+
+void FHelikaBatchSerializer::EncodeEvent(const FHelikaQueuedEvent& Event, const FHelikaBatchLimits& Limits, TArray<uint8>& Buffer, FEncodedEvent& OutEncoded)
+{
+	OutEncoded = FEncodedEvent();
+	OutEncoded.Offset = Buffer.Num();
+
+	const FHelikaEventRules::FRuleSet* Rules = MatchRules(Event);
+	if (Rules != nullptr && Rules->bDrop)
+	{
+		OutEncoded.Result = EEncodedResult::Filtered;
+		return;
+	}
+
+	// A writer of its own, the event does not depend on what is in front of it
+	{
+		FHelikaJsonWriter Writer(Buffer);
+		WriteEvent(Writer, Event, Rules);
+	}
+	int64 EventBytes = Buffer.Num() - OutEncoded.Offset;
+
+	if (EventBytes > Limits.MaxEventBytes)
+	{
+		Buffer.SetNum(OutEncoded.Offset, false);
+		OutEncoded.bOversized = true;
+
+		if (Limits.OversizedEventPolicy == EHelikaOversizedEventPolicy::HOE_Truncate)
+		{
+			FHelikaQueuedEvent Truncated = Event;
+			Truncated.Event = TruncateEvent(Event.Event.IsValid() ? Event.Event : FHelikaEventTemplate::MakeEnrichedEvent(Event), EventBytes - Limits.MaxEventBytes);
+			Truncated.Template = nullptr;
+			FHelikaJsonWriter Writer(Buffer);
+			WriteEvent(Writer, Truncated, Rules);
+			EventBytes = Buffer.Num() - OutEncoded.Offset;
+		}
+
+		if (EventBytes > Limits.MaxEventBytes || Limits.OversizedEventPolicy == EHelikaOversizedEventPolicy::HOE_Reject)
+		{
+			Buffer.SetNum(OutEncoded.Offset, false);
+			OutEncoded.Result = EEncodedResult::Rejected;
+			OutEncoded.RejectedBytes = EventBytes;
+			return;
+		}
+	}
+	OutEncoded.Size = static_cast<int32>(EventBytes);
+}
+
+bool FHelikaBatchSerializer::CommitEvent(const FHelikaQueuedEvent& Event, int32 EventIndex, const FEncodedEvent& Encoded, int32 EventStart, const FHelikaJsonWriter& Writer, int64 MaxBatchBytes,
+	TArray<uint8>& OutPayload, TArray<int32>& OutWritten, TArray<int32>* OutFiltered)
+{
+	if (Encoded.bOversized)
+	{
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsOversized);
+	}
+
+	switch (Encoded.Result)
+	{
+	case EEncodedResult::Filtered:
+		OutPayload.SetNum(EventStart, false);
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsFiltered);
+		if (OutFiltered != nullptr)
+		{
+			OutFiltered->Add(EventIndex);
+		}
+		return true;
+	case EEncodedResult::Rejected:
+	{
+		OutPayload.SetNum(EventStart, false);
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsDropped);
+		FString EventType;
+		if (Event.Template.IsValid())
+		{
+			EventType = Event.Template->GetEventType();
+		}
+		else
+		{
+			Event.Event->TryGetStringField(TEXT("event_type"), EventType);
+		}
+		UE_LOG(LogHelika, Warning, TEXT("Dropped a '%s' event of %lld bytes, over MaxEventKilobytes"), *EventType, Encoded.RejectedBytes);
+		return true;
+	}
+	default:
+		break;
+	}
+
+	if (OutWritten.Num() > 0 && Writer.GetNumBytesWritten() + HelikaBatchSerializer::EnvelopeEndBytes > MaxBatchBytes)
+	{
+		OutPayload.SetNum(EventStart, false);
+		return false;
+	}
+	OutWritten.Add(EventIndex);
+	return true;
+}
+
+int64 FHelikaBatchSerializer::GetBatchBudget(const FHelikaBatchLimits& Limits, bool bCompressed)
+{
+	if (!bCompressed)
+	{
+		return Limits.MaxBatchBytes;
+	}
+	const float Ratio = FMath::Max(CompressionRatio.load(std::memory_order_relaxed), 0.01f);
+	return FMath::Min<int64>(Limits.MaxBatchBytes, static_cast<int64>(Limits.MaxCompressedBatchBytes / Ratio));
+}
+
+void FHelikaBatchSerializer::RecordCompression(int64 UncompressedBytes, int64 CompressedBytes)
+{
+	if (UncompressedBytes <= 0)
+	{
+		return;
+	}
+
+	// Leans towards the worse ratio so a batch of less repetitive events does not overshoot
+	const float Observed = static_cast<float>(CompressedBytes) / UncompressedBytes;
+	const float Previous = CompressionRatio.load(std::memory_order_relaxed);
+	CompressionRatio.store(Observed > Previous ? Observed : Previous * 0.75f + Observed * 0.25f, std::memory_order_relaxed);
+}
+
+TSharedPtr<FJsonObject> FHelikaBatchSerializer::TruncateEvent(const TSharedPtr<FJsonObject>& Event, int64 ExcessBytes)
+{
+	using namespace HelikaBatchSerializer;
+	HELIKA_TRACE_SCOPE("Truncation");
+
+	const TSharedPtr<FJsonObject> Copy = MakeShareable(new FJsonObject());
+	Copy->Values = Event->Values;
+
+	const TSharedPtr<FJsonObject>* InternalEvent = nullptr;
+	if (!Copy->TryGetObjectField(EventField, InternalEvent) || !InternalEvent->IsValid())
+	{
+		return Copy;
+	}
+	const TSharedPtr<FJsonObject> Internal = MakeShareable(new FJsonObject());
+	Internal->Values = (*InternalEvent)->Values;
+	Copy->SetObjectField(EventField, Internal);
+
+	// Largest values first, the sub type is what the collector routes on
+	TArray<TPair<int64, FString>> Sizes;
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Internal->Values)
+	{
+		if (Field.Key != EventSubTypeField)
+		{
+			TArray<uint8> Encoded;
+			FHelikaJsonWriter(Encoded).WriteValue(Field.Value);
+			Sizes.Emplace(Encoded.Num(), Field.Key);
+		}
+	}
+	Sizes.Sort([](const TPair<int64, FString>& A, const TPair<int64, FString>& B) { return A.Key > B.Key; });
+
+	int64 Remaining = ExcessBytes + TruncationSlackBytes;
+	for (const TPair<int64, FString>& Size : Sizes)
+	{
+		if (Remaining <= 0)
+		{
+			break;
+		}
+
+		// Every character takes at least one encoded byte, cutting Remaining characters frees at least Remaining bytes
+		FString Value;
+		if (Internal->TryGetStringField(Size.Value, Value) && Value.Len() > Remaining)
+		{
+			Internal->SetStringField(Size.Value, Value.Left(Value.Len() - Remaining) + TEXT("..."));
+			Remaining = 0;
+		}
+		else
+		{
+			Internal->RemoveField(Size.Value);
+			Remaining -= Size.Key;
+		}
+	}
+
+	Internal->SetBoolField(TruncatedField, true);
+	return Copy;
+}
+
+const FHelikaBatchSerializer::FContextBlocks& FHelikaBatchSerializer::GetContextBlocks(const FHelikaQueuedEvent& Event)
+{
+	const TPair<const FHelikaContextData*, const FHelikaConfigSnapshot*> Key(Event.Context.Get(), Event.Config.Get());
+	if (const FContextBlocks* Found = ContextBlocks.Find(Key))
+	{
+		return *Found;
+	}
+
+	HELIKA_TRACE_SCOPE("Enrichment");
+
+	const FHelikaContextData& Context = *Event.Context;
+	FContextBlocks& Blocks = ContextBlocks.Add(Key);
+	Blocks.HelikaData = FHelikaJsonWriter::SerializeObject(MakeHelikaData(Context, *Event.Config));
+	Blocks.UserDetails = FHelikaJsonWriter::SerializeObject(Context.UserDetails);
+	if (Context.MatchMetadata.IsValid())
+	{
+		Blocks.MatchMetadata = FHelikaJsonWriter::SerializeObject(Context.MatchMetadata);
+	}
+	return Blocks;
+}
+
+const TArray<uint8>& FHelikaBatchSerializer::GetAppDetailsBlock(const FHelikaConfigSnapshot& Config)
+{
+	if (const TArray<uint8>* Found = AppDetailsBlocks.Find(&Config))
+	{
+		return *Found;
+	}
+
+	HELIKA_TRACE_SCOPE("Enrichment");
+	return AppDetailsBlocks.Add(&Config, FHelikaJsonWriter::SerializeObject(Config.AppDetails));
+}
+
+TSharedPtr<FJsonObject> FHelikaBatchSerializer::MakeHelikaData(const FHelikaContextData& Context, const FHelikaConfigSnapshot& Config)
+{
+	const TSharedPtr<FJsonObject> HelikaData = MakeShareable(new FJsonObject());
+
+	HelikaData->SetStringField("anon_id", Context.AnonymousId);
+	HelikaData->SetStringField("taxonomy_ver", "v2");
+	HelikaData->SetStringField("sdk_name", Config.SDKName);
+	HelikaData->SetStringField("sdk_version", Config.SDKVersion);
+	HelikaData->SetStringField("sdk_class", Config.SDKClass);
+	HelikaData->SetStringField("sdk_platform", Config.SDKPlatform);
+	HelikaData->SetStringField("event_source", "client");
+	HelikaData->SetBoolField("pii_tracking", Config.bPiiTracking);
+
+	return HelikaData;
+}
+
+const FHelikaEventRules::FRuleSet* FHelikaBatchSerializer::MatchRules(const FHelikaQueuedEvent& Event)
+{
+	if (!Event.Config.IsValid() || !Event.Config->EventRules.IsValid())
+	{
+		return nullptr;
+	}
+	return Event.Template.IsValid() ? Event.Config->EventRules->Match(Event.Template->GetEventType(), Event.Template->GetEventSubType()) : Event.Config->EventRules->Match(*Event.Event);
+}
+
+void FHelikaBatchSerializer::WriteEvent(FHelikaJsonWriter& Writer, const FHelikaQueuedEvent& Event, const FHelikaEventRules::FRuleSet* Rules)
+{
+	if (Event.Template.IsValid() && Rules == nullptr)
+	{
+		WriteTemplateEvent(Writer, Event);
+		return;
+	}
+
+	// A prototype event only needs its tree when rules apply to it
+	const TSharedPtr<FJsonObject> Tree = Event.Template.IsValid() ? FHelikaEventTemplate::MakeEnrichedEvent(Event) : Event.Event;
+	const FHelikaEventRules::FNode* Root = Rules != nullptr ? &Rules->GetRoot() : nullptr;
+
+	Writer.WriteObjectStart();
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Tree->Values)
+	{
+		const FHelikaEventRules::FNode* Node = Root != nullptr ? Rules->FindChild(*Root, Field.Key) : nullptr;
+		if (Node != nullptr && Node->bRemove)
+		{
+			continue;
+		}
+		Writer.WriteKey(HelikaBatchSerializer::GetWrittenKey(Node, Field.Key, *Tree));
+
+		const TSharedPtr<FJsonObject>* InternalEvent = nullptr;
+		if (Field.Key == HelikaBatchSerializer::EventField && (Node == nullptr || !Node->HasValueAction()) && Field.Value.IsValid() && Field.Value->TryGetObject(InternalEvent) && InternalEvent->IsValid())
+		{
+			WriteInternalEvent(Writer, *InternalEvent, Event, Rules, Node);
+		}
+		else if (Node != nullptr)
+		{
+			WriteRuledValue(Writer, Field.Value, *Rules, *Node);
+		}
+		else
+		{
+			Writer.WriteValue(Field.Value);
+		}
+	}
+	Writer.WriteObjectEnd();
+}
+
+void FHelikaBatchSerializer::WriteTemplateEvent(FHelikaJsonWriter& Writer, const FHelikaQueuedEvent& Event)
+{
+	using namespace HelikaBatchSerializer;
+
+	// Same fields in the same order as the enriched tree of the event, see FHelikaEventTemplate
+	const FHelikaEventTemplate& Template = *Event.Template;
+	Writer.WriteRaw(Template.GetHead());
+	for (int32 Index = 0; Index < Template.GetFieldNames().Num(); ++Index)
+	{
+		Writer.WriteRaw(Template.GetFieldKey(Index));
+		Writer.WriteValue(Event.Values.IsValidIndex(Index) ? Event.Values[Index] : nullptr);
+	}
+	Writer.WriteStringField(SessionIdField, Event.Context->SessionId);
+	Writer.WriteStringField(UserIdField, Event.bIsUserEvent ? Event.Context->GetUserId() : Event.Context->AnonymousId);
+
+	const FContextBlocks& Blocks = GetContextBlocks(Event);
+	Writer.WriteKey(HelikaDataField);
+	Writer.WriteRaw(Blocks.HelikaData);
+	Writer.WriteKey(AppDetailsField);
+	Writer.WriteRaw(GetAppDetailsBlock(*Event.Config));
+	if (Event.bIsUserEvent)
+	{
+		Writer.WriteKey(UserDetailsField);
+		Writer.WriteRaw(Blocks.UserDetails);
+	}
+	if (!Blocks.MatchMetadata.IsEmpty())
+	{
+		Writer.WriteKey(MatchMetadataField);
+		Writer.WriteRaw(Blocks.MatchMetadata);
+	}
+	Writer.WriteObjectEnd();
+
+	Writer.WriteStringField(GameIdField, Event.Config->GameId);
+	Writer.WriteStringField(CreatedAtField, Event.CreatedAt.ToIso8601());
+	Writer.WriteObjectEnd();
+}
+
+void FHelikaBatchSerializer::WriteInternalEvent(FHelikaJsonWriter& Writer, const TSharedPtr<FJsonObject>& InternalEvent, const FHelikaQueuedEvent& Event, const FHelikaEventRules::FRuleSet* Rules,
+	const FHelikaEventRules::FNode* EventNode)
+{
+	using namespace HelikaBatchSerializer;
+
+	const FContextBlocks& Blocks = GetContextBlocks(Event);
+	const bool bHasMatchMetadata = !Blocks.MatchMetadata.IsEmpty();
+
+	bool bWroteHelikaData = false;
+	bool bWroteAppDetails = false;
+	bool bWroteUserDetails = false;
+	bool bWroteMatchMetadata = false;
+
+	Writer.WriteObjectStart();
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : InternalEvent->Values)
+	{
+		// Event values win over the context blocks, merging needs the tree so this is the slow path
+		const TSharedPtr<FJsonObject>* Existing = nullptr;
+		const bool bIsObject = Field.Value.IsValid() && Field.Value->TryGetObject(Existing) && Existing->IsValid();
+		TSharedPtr<FJsonObject> Defaults;
+		if (Field.Key == HelikaDataField)
+		{
+			Defaults = MakeHelikaData(*Event.Context, *Event.Config);
+			bWroteHelikaData = true;
+		}
+		else if (Field.Key == AppDetailsField)
+		{
+			Defaults = Event.Config->AppDetails;
+			bWroteAppDetails = true;
+		}
+		else if (Event.bIsUserEvent && Field.Key == UserDetailsField)
+		{
+			Defaults = Event.Context->UserDetails;
+			bWroteUserDetails = true;
+		}
+		else if (bHasMatchMetadata && Field.Key == MatchMetadataField)
+		{
+			Defaults = Event.Context->MatchMetadata;
+			bWroteMatchMetadata = true;
+		}
+
+		const FHelikaEventRules::FNode* Node = EventNode != nullptr ? Rules->FindChild(*EventNode, Field.Key) : nullptr;
+		if (Node != nullptr && Node->bRemove)
+		{
+			continue;
+		}
+		Writer.WriteKey(GetWrittenKey(Node, Field.Key, *InternalEvent, true));
+
+		if (bIsObject && Defaults.IsValid())
+		{
+			WriteMergedObject(Writer, *Existing, Defaults, Rules, Node);
+		}
+		else if (Node != nullptr)
+		{
+			WriteRuledValue(Writer, Field.Value, *Rules, *Node);
+		}
+		else
+		{
+			Writer.WriteValue(Field.Value);
+		}
+	}
+
+	// Fast path, splice the pre-encoded blocks. A block named by a rule is written from its tree instead,
+	// built by MakeSource only then so rules that never touch the block cost no allocation.
+	const auto WriteBlock = [&Writer, &InternalEvent, Rules, EventNode](const FString& Field, TConstArrayView<uint8> Block, TFunctionRef<TSharedPtr<FJsonObject>()> MakeSource)
+	{
+		const FHelikaEventRules::FNode* Node = EventNode != nullptr ? Rules->FindChild(*EventNode, Field) : nullptr;
+		if (Node == nullptr)
+		{
+			Writer.WriteKey(Field);
+			Writer.WriteRaw(Block);
+		}
+		else if (!Node->bRemove)
+		{
+			const TSharedPtr<FJsonObject> Source = MakeSource();
+			Writer.WriteKey(GetWrittenKey(Node, Field, *InternalEvent, true));
+			WriteRuledValue(Writer, MakeShared<FJsonValueObject>(Source.IsValid() ? Source : MakeShareable(new FJsonObject())), *Rules, *Node);
+		}
+	};
+	if (!bWroteHelikaData)
+	{
+		WriteBlock(HelikaDataField, Blocks.HelikaData, [&Event]() { return MakeHelikaData(*Event.Context, *Event.Config); });
+	}
+	if (!bWroteAppDetails)
+	{
+		WriteBlock(AppDetailsField, GetAppDetailsBlock(*Event.Config), [&Event]() { return Event.Config->AppDetails; });
+	}
+	if (Event.bIsUserEvent && !bWroteUserDetails)
+	{
+		WriteBlock(UserDetailsField, Blocks.UserDetails, [&Event]() { return Event.Context->UserDetails; });
+	}
+	if (bHasMatchMetadata && !bWroteMatchMetadata)
+	{
+		WriteBlock(MatchMetadataField, Blocks.MatchMetadata, [&Event]() { return Event.Context->MatchMetadata; });
+	}
+	Writer.WriteObjectEnd();
+}
+
+void FHelikaBatchSerializer::WriteMergedObject(FHelikaJsonWriter& Writer, const TSharedPtr<FJsonObject>& EventValues, const TSharedPtr<FJsonObject>& Defaults, const FHelikaEventRules::FRuleSet* Rules,
+	const FHelikaEventRules::FNode* Node)
+{
+	HELIKA_TRACE_SCOPE("Enrichment");
+
+	const TSharedPtr<FJsonObject> Merged = MakeShareable(new FJsonObject());
+	Merged->Values = EventValues->Values;
+	UHelikaJsonLibrary::MergeJObjects(Merged, Defaults);
+	if (Node != nullptr)
+	{
+		WriteRuledValue(Writer, MakeShared<FJsonValueObject>(Merged), *Rules, *Node);
+	}
+	else
+	{
+		Writer.WriteObject(Merged);
+	}
+}
+
+void FHelikaBatchSerializer::WriteRuledValue(FHelikaJsonWriter& Writer, const TSharedPtr<FJsonValue>& Value, const FHelikaEventRules::FRuleSet& Rules, const FHelikaEventRules::FNode& Node)
+{
+	if (Node.bHash)
+	{
+		Writer.WriteString(FHelikaEventRules::HashValue(Value, Rules.HashSalt));
+		return;
+	}
+
+	FString Text;
+	if (Node.MaxLength > 0 && Value.IsValid() && Value->Type == EJson::String && Value->TryGetString(Text) && Text.Len() > Node.MaxLength)
+	{
+		// A surrogate pair is kept or cut as a whole
+		const int32 NumKept = StringConv::IsHighSurrogate(Text[Node.MaxLength - 1]) ? Node.MaxLength - 1 : Node.MaxLength;
+		Writer.WriteString(FStringView(Text).Left(NumKept));
+		return;
+	}
+
+	const TSharedPtr<FJsonObject>* Object = nullptr;
+	const TArray<TSharedPtr<FJsonValue>>* Array = nullptr;
+	if (Node.Children.Num() == 0 || !Value.IsValid())
+	{
+		Writer.WriteValue(Value);
+	}
+	else if (Value->TryGetObject(Object) && Object->IsValid())
+	{
+		Writer.WriteObjectStart();
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : (*Object)->Values)
+		{
+			const FHelikaEventRules::FNode* Child = Rules.FindChild(Node, Field.Key);
+			if (Child == nullptr)
+			{
+				Writer.WriteKey(Field.Key);
+				Writer.WriteValue(Field.Value);
+			}
+			else if (!Child->bRemove)
+			{
+				Writer.WriteKey(HelikaBatchSerializer::GetWrittenKey(Child, Field.Key, **Object));
+				WriteRuledValue(Writer, Field.Value, Rules, *Child);
+			}
+		}
+		Writer.WriteObjectEnd();
+	}
+	else if (Value->TryGetArray(Array))
+	{
+		// Paths look through arrays, every element gets the rules of the array
+		Writer.WriteArrayStart();
+		for (const TSharedPtr<FJsonValue>& Element : *Array)
+		{
+			WriteRuledValue(Writer, Element, Rules, Node);
+		}
+		Writer.WriteArrayEnd();
+	}
+	else
+	{
+		Writer.WriteValue(Value);
+	}
+}
+
+int64 FHelikaBatchSerializer::GetAllocatedSize() const
+{
+	int64 Bytes = AppDetailsBlocks.GetAllocatedSize() + ContextBlocks.GetAllocatedSize();
+	for (const TPair<const FHelikaConfigSnapshot*, TArray<uint8>>& Block : AppDetailsBlocks)
+	{
+		Bytes += Block.Value.GetAllocatedSize();
+	}
+	for (const TPair<TPair<const FHelikaContextData*, const FHelikaConfigSnapshot*>, FContextBlocks>& Blocks : ContextBlocks)
+	{
+		Bytes += Blocks.Value.HelikaData.GetAllocatedSize() + Blocks.Value.UserDetails.GetAllocatedSize() + Blocks.Value.MatchMetadata.GetAllocatedSize();
+	}
+	return Bytes;
+}
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaEventRules.h"
+#include "HelikaEventTypes.h"
+#include <atomic>
+
+class FHelikaJsonWriter;
+struct FHelikaBatchLimits;
+
+/**
+ * Writes queued events into a single upload envelope ({"id": ..., "events": [...]}).
+ *
+ * The helika_data, app_details and user_details blocks are identical for every event of a context
+ * and configuration version, they are encoded once per batch and spliced into each event
+ * instead of being merged into every tree.
+ */
+class FHelikaBatchSerializer
+{
+public:
+	void Serialize(TConstArrayView<FHelikaQueuedEvent> Events, TArray<uint8>& OutPayload);
+
+	/**
+	 * Writes events from the front of Events into one envelope, tracking its encoded size, and stops before the event
+	 * that would take it over MaxBatchBytes (the first event always goes in). Events over Limits.MaxEventBytes are
+	 * truncated or left out according to Limits.OversizedEventPolicy.
+	 * Returns the number of events consumed from the front, OutWritten gets the index of every event in the envelope
+	 * and OutFiltered the index of every event dropped by the event rules of its configuration.
+	 * From Limits.ParallelThreshold events on, the events are encoded by task graph workers and the envelope is assembled
+	 * from their fragments, byte for byte the same as on the calling thread.
+	 */
+	int32 SerializeBudgeted(TConstArrayView<FHelikaQueuedEvent> Events, const FHelikaBatchLimits& Limits, int64 MaxBatchBytes, TArray<uint8>& OutPayload, TArray<int32>& OutWritten,
+		TArray<int32>* OutFiltered = nullptr);
+
+	/// Uncompressed budget of an envelope, with compression MaxCompressedBatchBytes is scaled by the recent compression ratio
+	static int64 GetBatchBudget(const FHelikaBatchLimits& Limits, bool bCompressed);
+
+	/// Feeds the compression ratio estimate with an uploaded body
+	static void RecordCompression(int64 UncompressedBytes, int64 CompressedBytes);
+
+	/// Copy of the event with its largest values cut or removed so that it shrinks by at least ExcessBytes
+	static TSharedPtr<FJsonObject> TruncateEvent(const TSharedPtr<FJsonObject>& Event, int64 ExcessBytes);
+
+	/// Memory held by the per-batch block caches
+	int64 GetAllocatedSize() const;
+
+private:
+	enum class EEncodedResult : uint8
+	{
+		Written,
+		/// Dropped by the event rules
+		Filtered,
+		/// Over MaxEventBytes and not truncated below it
+		Rejected,
+	};
+
+	/// One event encoded on its own, without the separator in front of it
+	struct FEncodedEvent
+	{
+		EEncodedResult Result = EEncodedResult::Written;
+		bool bOversized = false;
+		int32 Offset = 0;
+		int32 Size = 0;
+		/// Last encoded size of a rejected event
+		int64 RejectedBytes = 0;
+	};
+
+	/// Appends Event to Buffer, cut or left out according to the limits
+	void EncodeEvent(const FHelikaQueuedEvent& Event, const FHelikaBatchLimits& Limits, TArray<uint8>& Buffer, FEncodedEvent& OutEncoded);
+
+	/**
+	 * Counts an encoded event and decides whether it stays in the envelope, the event and its separator start at EventStart.
+	 * Returns false when it does not fit the budget anymore, the envelope is then rolled back to EventStart.
+	 */
+	static bool CommitEvent(const FHelikaQueuedEvent& Event, int32 EventIndex, const FEncodedEvent& Encoded, int32 EventStart, const FHelikaJsonWriter& Writer, int64 MaxBatchBytes,
+		TArray<uint8>& OutPayload, TArray<int32>& OutWritten, TArray<int32>* OutFiltered);
+
+	int32 SerializeParallel(TConstArrayView<FHelikaQueuedEvent> Events, const FHelikaBatchLimits& Limits, int64 MaxBatchBytes, FHelikaJsonWriter& Writer, TArray<uint8>& OutPayload,
+		TArray<int32>& OutWritten, TArray<int32>* OutFiltered);
+
+	struct FContextBlocks
+	{
+		TArray<uint8> HelikaData;
+		TArray<uint8> UserDetails;
+		TArray<uint8> MatchMetadata;
+	};
+
+	const FContextBlocks& GetContextBlocks(const FHelikaQueuedEvent& Event);
+	const TArray<uint8>& GetAppDetailsBlock(const FHelikaConfigSnapshot& Config);
+	static TSharedPtr<FJsonObject> MakeHelikaData(const FHelikaContextData& Context, const FHelikaConfigSnapshot& Config);
+
+	/// Event rules of the event's configuration that apply to it, null for the common case of none
+	static const FHelikaEventRules::FRuleSet* MatchRules(const FHelikaQueuedEvent& Event);
+
+	void WriteEvent(FHelikaJsonWriter& Writer, const FHelikaQueuedEvent& Event, const FHelikaEventRules::FRuleSet* Rules);
+	/// Splices the values of an event sent by prototype handle into the pre-encoded pieces of its template, without rules
+	void WriteTemplateEvent(FHelikaJsonWriter& Writer, const FHelikaQueuedEvent& Event);
+	void WriteInternalEvent(FHelikaJsonWriter& Writer, const TSharedPtr<FJsonObject>& InternalEvent, const FHelikaQueuedEvent& Event, const FHelikaEventRules::FRuleSet* Rules, const FHelikaEventRules::FNode* EventNode);
+
+	/// Used when the event already carries one of the blocks, event values win over the defaults
+	static void WriteMergedObject(FHelikaJsonWriter& Writer, const TSharedPtr<FJsonObject>& EventValues, const TSharedPtr<FJsonObject>& Defaults, const FHelikaEventRules::FRuleSet* Rules,
+		const FHelikaEventRules::FNode* Node);
+
+	/// Writes Value with the actions of Node and of the nodes below it applied, only used on the paths named by a rule
+	static void WriteRuledValue(FHelikaJsonWriter& Writer, const TSharedPtr<FJsonValue>& Value, const FHelikaEventRules::FRuleSet& Rules, const FHelikaEventRules::FNode& Node);
+
+	/// Compressed over uncompressed size, starts pessimistic until bodies were compressed
+	static std::atomic<float> CompressionRatio;
+
+	TMap<const FHelikaConfigSnapshot*, TArray<uint8>> AppDetailsBlocks;
+	TMap<TPair<const FHelikaContextData*, const FHelikaConfigSnapshot*>, FContextBlocks> ContextBlocks;
+};
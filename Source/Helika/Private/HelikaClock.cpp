@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaClock.h"
+
+std::atomic<IHelikaClock*> FHelikaClock::Clock{nullptr};
+std::atomic<IHelikaIdGenerator*> FHelikaClock::IdGenerator{nullptr};
+
+FDateTime FHelikaClock::UtcNow()
+{
+	IHelikaClock* Installed = Clock.load(std::memory_order_acquire);
+	return Installed != nullptr ? Installed->UtcNow() : FDateTime::UtcNow();
+}
+
+FGuid FHelikaClock::NewGuid()
+{
+	IHelikaIdGenerator* Installed = IdGenerator.load(std::memory_order_acquire);
+	return Installed != nullptr ? Installed->NewGuid() : FGuid::NewGuid();
+}
+
+void FHelikaClock::SetClock(IHelikaClock* InClock)
+{
+	Clock.store(InClock, std::memory_order_release);
+}
+
+void FHelikaClock::SetIdGenerator(IHelikaIdGenerator* InIdGenerator)
+{
+	IdGenerator.store(InIdGenerator, std::memory_order_release);
+}
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/// Wall clock stamped on events (created_at)
+class IHelikaClock
+{
+public:
+	virtual ~IHelikaClock() = default;
+	virtual FDateTime UtcNow() = 0;
+};
+
+/// Ids of sessions, anonymous users and batches
+class IHelikaIdGenerator
+{
+public:
+	virtual ~IHelikaIdGenerator() = default;
+	virtual FGuid NewGuid() = 0;
+};
+
+/**
+ * Source of every time and id the SDK writes into a payload. The defaults use FDateTime::UtcNow and FGuid::NewGuid,
+ * the replay tool installs deterministic ones so two runs of the same trace produce identical payloads.
+ * Installed instances are not owned and must outlive their use, install nullptr to restore the default.
+ */
+class FHelikaClock
+{
+public:
+	static FDateTime UtcNow();
+	static FGuid NewGuid();
+
+	static void SetClock(IHelikaClock* InClock);
+	static void SetIdGenerator(IHelikaIdGenerator* InIdGenerator);
+
+private:
+	static std::atomic<IHelikaClock*> Clock;
+	static std::atomic<IHelikaIdGenerator*> IdGenerator;
+};
+
+/// Clock that only moves when told to, thread safe
+class FHelikaManualClock : public IHelikaClock
+{
+public:
+	explicit FHelikaManualClock(const FDateTime& InStart = FDateTime(2000, 1, 1))
+		: Ticks(InStart.GetTicks())
+	{
+	}
+
+	virtual FDateTime UtcNow() override { return FDateTime(Ticks.load(std::memory_order_relaxed)); }
+
+	void Set(const FDateTime& Time) { Ticks.store(Time.GetTicks(), std::memory_order_relaxed); }
+
+private:
+	std::atomic<int64> Ticks;
+};
+
+/// Ids made of the seed and a sequence number, the same order of calls yields the same ids, thread safe
+class FHelikaSequentialIdGenerator : public IHelikaIdGenerator
+{
+public:
+	explicit FHelikaSequentialIdGenerator(uint32 InSeed = 0)
+		: Seed(InSeed)
+	{
+	}
+
+	virtual FGuid NewGuid() override
+	{
+		const uint64 Sequence = Next.fetch_add(1, std::memory_order_relaxed);
+		return FGuid(Seed, 0x484C4B41, static_cast<uint32>(Sequence >> 32), static_cast<uint32>(Sequence));
+	}
+
+private:
+	const uint32 Seed;
+	std::atomic<uint64> Next{0};
+};
@@ -0,0 +1,992 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaColumnarBatch.h"
+
+#include "HelikaJsonWriter.h"
+#include "HelikaMemoryCounters.h"
+#include "HelikaTrace.h"
+
+namespace HelikaColumnarBatch
+{
+	/// Stands for a value in a shape, compact json has no raw control characters
+	constexpr uint8 SlotByte = 0;
+	/// Deeper nesting is refused rather than recursed into
+	constexpr int32 MaxDepth = 64;
+	/// Integers with more digits stay text so that no delta can overflow
+	constexpr int32 MaxIntegerDigits = 17;
+	constexpr int32 MaxDeltaDigits = 18;
+	constexpr int64 MaxIntegerValue = 99999999999999999ll;
+	/// "YYYY-MM-DDTHH:MM:SS.mmmZ" with its quotes, as written by FDateTime::ToIso8601
+	constexpr int32 TimestampLength = 26;
+
+	/// Bytes [Start, Start + Length) of the envelope
+	struct FSpan
+	{
+		int32 Start = 0;
+		int32 Length = 0;
+	};
+
+	/// Value text as a dictionary key, compared byte for byte
+	struct FValueKey
+	{
+		const uint8* Data = nullptr;
+		int32 Length = 0;
+
+		bool operator==(const FValueKey& Other) const { return Length == Other.Length && FMemory::Memcmp(Data, Other.Data, Length) == 0; }
+		friend uint32 GetTypeHash(const FValueKey& Key) { return FCrc::MemCrc32(Key.Data, Key.Length); }
+	};
+
+	/// Forward-only reader of compact json, whitespace between tokens is an error
+	struct FReader
+	{
+		explicit FReader(TConstArrayView<uint8> InData)
+			: Data(InData.GetData())
+			, Num(InData.Num())
+		{
+		}
+
+		uint8 Peek() const { return Pos < Num ? Data[Pos] : 0; }
+		bool AtEnd() const { return Pos >= Num; }
+
+		bool Consume(uint8 Char)
+		{
+			if (Pos < Num && Data[Pos] == Char)
+			{
+				++Pos;
+				return true;
+			}
+			return false;
+		}
+
+		bool ConsumeLiteral(const ANSICHAR* Literal, int32 Length)
+		{
+			if (Num - Pos < Length || FMemory::Memcmp(Data + Pos, Literal, Length) != 0)
+			{
+				return false;
+			}
+			Pos += Length;
+			return true;
+		}
+
+		bool SkipString()
+		{
+			if (!Consume('"'))
+			{
+				return false;
+			}
+			while (Pos < Num)
+			{
+				const uint8 Char = Data[Pos++];
+				if (Char == '"')
+				{
+					return true;
+				}
+				if (Char < 0x20)
+				{
+					return false;
+				}
+				if (Char == '\\')
+				{
+					// The digits of \u are plain characters
+					++Pos;
+				}
+			}
+			return false;
+		}
+
+		bool SkipScalar()
+		{
+			const uint8 First = Peek();
+			if (First == '"')
+			{
+				return SkipString();
+			}
+			if (First == 't')
+			{
+				return ConsumeLiteral("true", 4);
+			}
+			if (First == 'f')
+			{
+				return ConsumeLiteral("false", 5);
+			}
+			if (First == 'n')
+			{
+				return ConsumeLiteral("null", 4);
+			}
+			if (First != '-' && (First < '0' || First > '9'))
+			{
+				return false;
+			}
+			while (Pos < Num && ((Data[Pos] >= '0' && Data[Pos] <= '9') || Data[Pos] == '-' || Data[Pos] == '+' || Data[Pos] == '.' || Data[Pos] == 'e' || Data[Pos] == 'E'))
+			{
+				++Pos;
+			}
+			return true;
+		}
+
+		bool SkipValue(int32 Depth)
+		{
+			if (Depth > MaxDepth)
+			{
+				return false;
+			}
+			if (Consume('{'))
+			{
+				if (Consume('}'))
+				{
+					return true;
+				}
+				do
+				{
+					if (!SkipString() || !Consume(':') || !SkipValue(Depth + 1))
+					{
+						return false;
+					}
+				}
+				while (Consume(','));
+				return Consume('}');
+			}
+			if (Consume('['))
+			{
+				if (Consume(']'))
+				{
+					return true;
+				}
+				do
+				{
+					if (!SkipValue(Depth + 1))
+					{
+						return false;
+					}
+				}
+				while (Consume(','));
+				return Consume(']');
+			}
+			return SkipScalar();
+		}
+
+		const uint8* Data;
+		int32 Num;
+		int32 Pos = 0;
+	};
+
+	/// Canonical integer text (no sign on zero, no leading zeros) of at most MaxDigits digits
+	bool ParseInteger(const uint8* Text, int32 Length, int32 MaxDigits, int64& OutValue)
+	{
+		const bool bNegative = Length > 0 && Text[0] == '-';
+		const int32 First = bNegative ? 1 : 0;
+		const int32 NumDigits = Length - First;
+		if (NumDigits < 1 || NumDigits > MaxDigits || (Text[First] == '0' && (NumDigits > 1 || bNegative)))
+		{
+			return false;
+		}
+
+		int64 Value = 0;
+		for (int32 Index = First; Index < Length; ++Index)
+		{
+			if (Text[Index] < '0' || Text[Index] > '9')
+			{
+				return false;
+			}
+			Value = Value * 10 + (Text[Index] - '0');
+		}
+		OutValue = bNegative ? -Value : Value;
+		return true;
+	}
+
+	int64 GetUnixEpochTicks()
+	{
+		static const int64 Ticks = FDateTime(1970, 1, 1).GetTicks();
+		return Ticks;
+	}
+
+	void FormatTimestamp(const FDateTime& Time, ANSICHAR (&OutText)[TimestampLength + 1])
+	{
+		FCStringAnsi::Snprintf(OutText, UE_ARRAY_COUNT(OutText), "\"%04d-%02d-%02dT%02d:%02d:%02d.%03dZ\"", Time.GetYear(), Time.GetMonth(), Time.GetDay(), Time.GetHour(), Time.GetMinute(),
+			Time.GetSecond(), Time.GetMillisecond());
+	}
+
+	/// Milliseconds since the Unix epoch of a time string that formats back to the same text
+	bool ParseTimestamp(const uint8* Text, int32 Length, int64& OutMilliseconds)
+	{
+		if (Length != TimestampLength || Text[0] != '"')
+		{
+			return false;
+		}
+
+		auto ParseDigits = [Text](int32 Start, int32 NumDigits)
+		{
+			int32 Value = 0;
+			for (int32 Index = Start; Index < Start + NumDigits; ++Index)
+			{
+				if (Text[Index] < '0' || Text[Index] > '9')
+				{
+					return -1;
+				}
+				Value = Value * 10 + (Text[Index] - '0');
+			}
+			return Value;
+		};
+		const int32 Year = ParseDigits(1, 4);
+		const int32 Month = ParseDigits(6, 2);
+		const int32 Day = ParseDigits(9, 2);
+		const int32 Hour = ParseDigits(12, 2);
+		const int32 Minute = ParseDigits(15, 2);
+		const int32 Second = ParseDigits(18, 2);
+		const int32 Millisecond = ParseDigits(21, 3);
+		if (FMath::Min(FMath::Min3(Year, Month, Day), FMath::Min3(Hour, Minute, FMath::Min(Second, Millisecond))) < 0 || !FDateTime::Validate(Year, Month, Day, Hour, Minute, Second, Millisecond))
+		{
+			return false;
+		}
+
+		// The separators must be the ones the decoder writes back
+		const FDateTime Time(Year, Month, Day, Hour, Minute, Second, Millisecond);
+		ANSICHAR Formatted[TimestampLength + 1];
+		FormatTimestamp(Time, Formatted);
+		if (FMemory::Memcmp(Formatted, Text, TimestampLength) != 0)
+		{
+			return false;
+		}
+		OutMilliseconds = (Time.GetTicks() - GetUnixEpochTicks()) / ETimespan::TicksPerMillisecond;
+		return true;
+	}
+
+	void WriteInteger(FHelikaJsonWriter& Writer, int64 Value)
+	{
+		ANSICHAR Digits[24];
+		const int32 Length = FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%lld", static_cast<long long>(Value));
+		Writer.WriteRaw(TConstArrayView<uint8>(reinterpret_cast<const uint8*>(Digits), Length));
+	}
+
+	/// The first number then the difference of every number to the previous one
+	void WriteDeltas(FHelikaJsonWriter& Writer, const TCHAR* Key, TConstArrayView<int64> Numbers)
+	{
+		Writer.WriteObjectStart();
+		Writer.WriteKey(Key);
+		Writer.WriteArrayStart();
+		int64 Previous = 0;
+		for (const int64 Number : Numbers)
+		{
+			WriteInteger(Writer, Number - Previous);
+			Previous = Number;
+		}
+		Writer.WriteArrayEnd();
+		Writer.WriteObjectEnd();
+	}
+
+	/// Shape bytes between two slots as a json string, they only need their quotes and backslashes escaped
+	void WriteFragment(FHelikaJsonWriter& Writer, TConstArrayView<uint8> Fragment, TArray<uint8>& Scratch)
+	{
+		Scratch.Reset();
+		Scratch.Add('"');
+		for (const uint8 Char : Fragment)
+		{
+			if (Char == '"' || Char == '\\')
+			{
+				Scratch.Add('\\');
+			}
+			Scratch.Add(Char);
+		}
+		Scratch.Add('"');
+		Writer.WriteRaw(Scratch);
+	}
+
+	/// Writes the values as the smallest encoding they qualify for
+	void WriteColumn(FHelikaJsonWriter& Writer, const uint8* Data, TConstArrayView<FSpan> Values, TArray<uint8>& Scratch, TArray<uint8>& Best)
+	{
+		auto GetText = [Data](const FSpan& Value) { return TConstArrayView<uint8>(Data + Value.Start, Value.Length); };
+
+		TMap<FValueKey, int32> Dictionary;
+		TArray<FSpan> Entries;
+		TArray<int32> Indices;
+		Indices.Reserve(Values.Num());
+		for (const FSpan& Value : Values)
+		{
+			const int32 Next = Entries.Num();
+			const int32 Index = Dictionary.FindOrAdd(FValueKey{Data + Value.Start, Value.Length}, Next);
+			if (Index == Next)
+			{
+				Entries.Add(Value);
+			}
+			Indices.Add(Index);
+		}
+
+		if (Entries.Num() == 1)
+		{
+			Writer.WriteObjectStart();
+			Writer.WriteKey(TEXT("c"));
+			Writer.WriteRaw(GetText(Entries[0]));
+			Writer.WriteObjectEnd();
+			return;
+		}
+
+		Best.Reset();
+		auto KeepSmaller = [&Scratch, &Best]()
+		{
+			if (Best.IsEmpty() || Scratch.Num() < Best.Num())
+			{
+				Swap(Scratch, Best);
+			}
+		};
+
+		{
+			Scratch.Reset();
+			FHelikaJsonWriter Candidate(Scratch);
+			Candidate.WriteObjectStart();
+			Candidate.WriteKey(TEXT("v"));
+			Candidate.WriteArrayStart();
+			for (const FSpan& Value : Values)
+			{
+				Candidate.WriteRaw(GetText(Value));
+			}
+			Candidate.WriteArrayEnd();
+			Candidate.WriteObjectEnd();
+			KeepSmaller();
+		}
+
+		if (Entries.Num() < Values.Num())
+		{
+			Scratch.Reset();
+			FHelikaJsonWriter Candidate(Scratch);
+			Candidate.WriteObjectStart();
+			Candidate.WriteKey(TEXT("d"));
+			Candidate.WriteArrayStart();
+			for (const FSpan& Entry : Entries)
+			{
+				Candidate.WriteRaw(GetText(Entry));
+			}
+			Candidate.WriteArrayEnd();
+			Candidate.WriteKey(TEXT("i"));
+			Candidate.WriteArrayStart();
+			for (const int32 Index : Indices)
+			{
+				WriteInteger(Candidate, Index);
+			}
+			Candidate.WriteArrayEnd();
+			Candidate.WriteObjectEnd();
+			KeepSmaller();
+		}
+
+		TArray<int64> Numbers;
+		Numbers.Reserve(Values.Num());
+		for (const FSpan& Value : Values)
+		{
+			int64 Milliseconds;
+			if (!ParseTimestamp(Data + Value.Start, Value.Length, Milliseconds))
+			{
+				break;
+			}
+			Numbers.Add(Milliseconds);
+		}
+		if (Numbers.Num() == Values.Num())
+		{
+			Scratch.Reset();
+			FHelikaJsonWriter Candidate(Scratch);
+			WriteDeltas(Candidate, TEXT("t"), Numbers);
+			KeepSmaller();
+		}
+
+		Numbers.Reset();
+		for (const FSpan& Value : Values)
+		{
+			int64 Number;
+			if (!ParseInteger(Data + Value.Start, Value.Length, MaxIntegerDigits, Number))
+			{
+				break;
+			}
+			Numbers.Add(Number);
+		}
+		if (Numbers.Num() == Values.Num())
+		{
+			Scratch.Reset();
+			FHelikaJsonWriter Candidate(Scratch);
+			WriteDeltas(Candidate, TEXT("n"), Numbers);
+			KeepSmaller();
+		}
+
+		Writer.WriteRaw(Best);
+	}
+
+	/// Events of one shape
+	struct FGroup
+	{
+		/// The event with a SlotByte in place of every scalar value
+		TArray<uint8> Shape;
+		int32 NumRows = 0;
+		/// Values of every slot, row by row
+		TArray<TArray<FSpan>> Columns;
+	};
+
+	/// Appends the structure of the value at the reader to OutShape and the text of its scalars to OutValues
+	bool Flatten(FReader& Reader, TArray<uint8>& OutShape, TArray<FSpan>& OutValues, int32 Depth)
+	{
+		if (Depth > MaxDepth)
+		{
+			return false;
+		}
+
+		const uint8 Open = Reader.Peek();
+		if (Open != '{' && Open != '[')
+		{
+			const int32 Start = Reader.Pos;
+			if (!Reader.SkipScalar())
+			{
+				return false;
+			}
+			OutShape.Add(SlotByte);
+			OutValues.Add({Start, Reader.Pos - Start});
+			return true;
+		}
+
+		const uint8 Close = Open == '{' ? '}' : ']';
+		Reader.Consume(Open);
+		OutShape.Add(Open);
+		if (Reader.Consume(Close))
+		{
+			OutShape.Add(Close);
+			return true;
+		}
+		for (;;)
+		{
+			if (Open == '{')
+			{
+				const int32 KeyStart = Reader.Pos;
+				if (!Reader.SkipString() || !Reader.Consume(':'))
+				{
+					return false;
+				}
+				OutShape.Append(Reader.Data + KeyStart, Reader.Pos - KeyStart);
+			}
+			if (!Flatten(Reader, OutShape, OutValues, Depth + 1))
+			{
+				return false;
+			}
+			if (!Reader.Consume(','))
+			{
+				break;
+			}
+			OutShape.Add(',');
+		}
+		if (!Reader.Consume(Close))
+		{
+			return false;
+		}
+		OutShape.Add(Close);
+		return true;
+	}
+
+	/// Reads the events array at the reader and writes it as the "columnar" field
+	bool EncodeEvents(FReader& Reader, FHelikaJsonWriter& Writer)
+	{
+		if (!Reader.Consume('[') || Reader.Peek() != '{')
+		{
+			return false;
+		}
+
+		TArray<FGroup> Groups;
+		TMultiMap<uint32, int32> GroupsByHash;
+		/// Runs of consecutive events of one group
+		TArray<TPair<int32, int32>> Order;
+		TArray<uint8> Shape;
+		TArray<FSpan> Values;
+		do
+		{
+			Shape.Reset();
+			Values.Reset();
+			if (Reader.Peek() != '{' || !Flatten(Reader, Shape, Values, 0))
+			{
+				return false;
+			}
+
+			const uint32 Hash = FCrc::MemCrc32(Shape.GetData(), Shape.Num());
+			int32 GroupIndex = INDEX_NONE;
+			for (TMultiMap<uint32, int32>::TConstKeyIterator It = GroupsByHash.CreateConstKeyIterator(Hash); It; ++It)
+			{
+				if (Groups[It.Value()].Shape == Shape)
+				{
+					GroupIndex = It.Value();
+					break;
+				}
+			}
+			if (GroupIndex == INDEX_NONE)
+			{
+				GroupIndex = Groups.AddDefaulted();
+				Groups[GroupIndex].Shape = Shape;
+				Groups[GroupIndex].Columns.SetNum(Values.Num());
+				GroupsByHash.Add(Hash, GroupIndex);
+			}
+
+			FGroup& Group = Groups[GroupIndex];
+			++Group.NumRows;
+			for (int32 Slot = 0; Slot < Values.Num(); ++Slot)
+			{
+				Group.Columns[Slot].Add(Values[Slot]);
+			}
+			if (Order.Num() > 0 && Order.Last().Key == GroupIndex)
+			{
+				++Order.Last().Value;
+			}
+			else
+			{
+				Order.Emplace(GroupIndex, 1);
+			}
+		}
+		while (Reader.Consume(','));
+		if (!Reader.Consume(']'))
+		{
+			return false;
+		}
+
+		Writer.WriteKey(TEXT("columnar"));
+		Writer.WriteObjectStart();
+		Writer.WriteKey(TEXT("order"));
+		Writer.WriteArrayStart();
+		for (const TPair<int32, int32>& Run : Order)
+		{
+			WriteInteger(Writer, Run.Key);
+			WriteInteger(Writer, Run.Value);
+		}
+		Writer.WriteArrayEnd();
+
+		TArray<uint8> Scratch;
+		TArray<uint8> Best;
+		Writer.WriteKey(TEXT("groups"));
+		Writer.WriteArrayStart();
+		for (const FGroup& Group : Groups)
+		{
+			Writer.WriteObjectStart();
+			Writer.WriteKey(TEXT("rows"));
+			WriteInteger(Writer, Group.NumRows);
+
+			// One more fragment than slots, the text before the first value and after every value
+			Writer.WriteKey(TEXT("shape"));
+			Writer.WriteArrayStart();
+			int32 FragmentStart = 0;
+			for (int32 Index = 0; Index <= Group.Shape.Num(); ++Index)
+			{
+				if (Index == Group.Shape.Num() || Group.Shape[Index] == SlotByte)
+				{
+					WriteFragment(Writer, TConstArrayView<uint8>(Group.Shape.GetData() + FragmentStart, Index - FragmentStart), Scratch);
+					FragmentStart = Index + 1;
+				}
+			}
+			Writer.WriteArrayEnd();
+
+			Writer.WriteKey(TEXT("columns"));
+			Writer.WriteArrayStart();
+			for (const TArray<FSpan>& Column : Group.Columns)
+			{
+				WriteColumn(Writer, Reader.Data, Column, Scratch, Best);
+			}
+			Writer.WriteArrayEnd();
+			Writer.WriteObjectEnd();
+		}
+		Writer.WriteArrayEnd();
+		Writer.WriteObjectEnd();
+		return true;
+	}
+
+	/// Values of a decoded column, the distinct ones back to back and the entry of every row
+	struct FDecodedColumn
+	{
+		TArray<uint8> Text;
+		TArray<int32> Ends;
+		/// Empty when every row has its own entry
+		TArray<int32> Indices;
+		bool bConstant = false;
+
+		void AddEntry(const uint8* Data, int32 Length)
+		{
+			Text.Append(Data, Length);
+			Ends.Add(Text.Num());
+		}
+
+		bool HasRows(int32 NumRows) const
+		{
+			return bConstant ? Ends.Num() == 1 : (Indices.Num() > 0 ? Indices.Num() : Ends.Num()) == NumRows;
+		}
+
+		TConstArrayView<uint8> GetRow(int32 Row) const
+		{
+			const int32 Entry = bConstant ? 0 : Indices.Num() > 0 ? Indices[Row] : Row;
+			const int32 Start = Entry > 0 ? Ends[Entry - 1] : 0;
+			return TConstArrayView<uint8>(Text.GetData() + Start, Ends[Entry] - Start);
+		}
+	};
+
+	struct FDecodedGroup
+	{
+		int32 NumRows = 0;
+		/// Rows already written to the envelope
+		int32 NextRow = 0;
+		TArray<TArray<uint8>> Fragments;
+		TArray<FDecodedColumn> Columns;
+	};
+
+	/// Calls Visit with the text of every scalar of the array at the reader
+	template <typename VisitorType>
+	bool ParseScalars(FReader& Reader, VisitorType&& Visit)
+	{
+		if (!Reader.Consume('['))
+		{
+			return false;
+		}
+		if (Reader.Consume(']'))
+		{
+			return true;
+		}
+		do
+		{
+			const int32 Start = Reader.Pos;
+			if (!Reader.SkipScalar() || !Visit(Reader.Data + Start, Reader.Pos - Start))
+			{
+				return false;
+			}
+		}
+		while (Reader.Consume(','));
+		return Reader.Consume(']');
+	}
+
+	bool ParseFragment(FReader& Reader, TArray<uint8>& OutFragment)
+	{
+		if (!Reader.Consume('"'))
+		{
+			return false;
+		}
+		while (!Reader.AtEnd())
+		{
+			uint8 Char = Reader.Data[Reader.Pos++];
+			if (Char == '"')
+			{
+				return true;
+			}
+			if (Char < 0x20)
+			{
+				return false;
+			}
+			if (Char == '\\')
+			{
+				// The encoder only escapes quotes and backslashes
+				Char = Reader.Peek();
+				if ((Char != '"' && Char != '\\') || !Reader.Consume(Char))
+				{
+					return false;
+				}
+			}
+			OutFragment.Add(Char);
+		}
+		return false;
+	}
+
+	bool ParseColumn(FReader& Reader, FDecodedColumn& OutColumn)
+	{
+		if (!Reader.Consume('{'))
+		{
+			return false;
+		}
+
+		auto AddEntry = [&OutColumn](const uint8* Text, int32 Length)
+		{
+			OutColumn.AddEntry(Text, Length);
+			return true;
+		};
+
+		bool bParsed = false;
+		if (Reader.ConsumeLiteral("\"c\":", 4))
+		{
+			const int32 Start = Reader.Pos;
+			OutColumn.bConstant = true;
+			bParsed = Reader.SkipScalar() && AddEntry(Reader.Data + Start, Reader.Pos - Start);
+		}
+		else if (Reader.ConsumeLiteral("\"v\":", 4))
+		{
+			bParsed = ParseScalars(Reader, AddEntry);
+		}
+		else if (Reader.ConsumeLiteral("\"d\":", 4))
+		{
+			bParsed = ParseScalars(Reader, AddEntry) && Reader.Consume(',') && Reader.ConsumeLiteral("\"i\":", 4) && ParseScalars(Reader, [&OutColumn](const uint8* Text, int32 Length)
+			{
+				int64 Index;
+				if (!ParseInteger(Text, Length, 9, Index) || Index < 0 || Index >= OutColumn.Ends.Num())
+				{
+					return false;
+				}
+				OutColumn.Indices.Add(static_cast<int32>(Index));
+				return true;
+			}) && OutColumn.Indices.Num() > 0;
+		}
+		else if (Reader.ConsumeLiteral("\"n\":", 4))
+		{
+			int64 Value = 0;
+			bParsed = ParseScalars(Reader, [&OutColumn, &Value](const uint8* Text, int32 Length)
+			{
+				int64 Delta;
+				if (!ParseInteger(Text, Length, MaxDeltaDigits, Delta) || FMath::Abs(Value + Delta) > MaxIntegerValue)
+				{
+					return false;
+				}
+				Value += Delta;
+				ANSICHAR Digits[24];
+				const int32 NumDigits = FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%lld", static_cast<long long>(Value));
+				OutColumn.AddEntry(reinterpret_cast<const uint8*>(Digits), NumDigits);
+				return true;
+			});
+		}
+		else if (Reader.ConsumeLiteral("\"t\":", 4))
+		{
+			const int64 MinMilliseconds = -GetUnixEpochTicks() / ETimespan::TicksPerMillisecond;
+			const int64 MaxMilliseconds = (FDateTime::MaxValue().GetTicks() - GetUnixEpochTicks()) / ETimespan::TicksPerMillisecond;
+			int64 Value = 0;
+			bParsed = ParseScalars(Reader, [&OutColumn, &Value, MinMilliseconds, MaxMilliseconds](const uint8* Text, int32 Length)
+			{
+				int64 Delta;
+				if (!ParseInteger(Text, Length, MaxDeltaDigits, Delta) || Value + Delta < MinMilliseconds || Value + Delta > MaxMilliseconds)
+				{
+					return false;
+				}
+				Value += Delta;
+				ANSICHAR Formatted[TimestampLength + 1];
+				FormatTimestamp(FDateTime(GetUnixEpochTicks() + Value * ETimespan::TicksPerMillisecond), Formatted);
+				OutColumn.AddEntry(reinterpret_cast<const uint8*>(Formatted), TimestampLength);
+				return true;
+			});
+		}
+		return bParsed && Reader.Consume('}');
+	}
+
+	bool ParseGroup(FReader& Reader, FDecodedGroup& OutGroup)
+	{
+		int32 RowsStart;
+		int64 NumRows;
+		if (!Reader.Consume('{') || !Reader.ConsumeLiteral("\"rows\":", 7) || (RowsStart = Reader.Pos, !Reader.SkipScalar())
+			|| !ParseInteger(Reader.Data + RowsStart, Reader.Pos - RowsStart, 9, NumRows) || NumRows < 1)
+		{
+			return false;
+		}
+		OutGroup.NumRows = static_cast<int32>(NumRows);
+
+		if (!Reader.Consume(',') || !Reader.ConsumeLiteral("\"shape\":", 8) || !Reader.Consume('['))
+		{
+			return false;
+		}
+		do
+		{
+			if (!ParseFragment(Reader, OutGroup.Fragments.AddDefaulted_GetRef()))
+			{
+				return false;
+			}
+		}
+		while (Reader.Consume(','));
+
+		if (!Reader.Consume(']') || !Reader.Consume(',') || !Reader.ConsumeLiteral("\"columns\":", 10) || !Reader.Consume('['))
+		{
+			return false;
+		}
+		if (!Reader.Consume(']'))
+		{
+			do
+			{
+				FDecodedColumn& Column = OutGroup.Columns.AddDefaulted_GetRef();
+				if (!ParseColumn(Reader, Column) || !Column.HasRows(OutGroup.NumRows))
+				{
+					return false;
+				}
+			}
+			while (Reader.Consume(','));
+			if (!Reader.Consume(']'))
+			{
+				return false;
+			}
+		}
+		return Reader.Consume('}') && OutGroup.Fragments.Num() == OutGroup.Columns.Num() + 1;
+	}
+
+	/// Reads the "columnar" field at the reader and appends the events array it stands for
+	bool DecodeEvents(FReader& Reader, int64 MaxEnvelopeBytes, TArray<uint8>& OutEnvelope, FString& OutError)
+	{
+		OutError = TEXT("Malformed columnar batch");
+
+		TArray<int64> Order;
+		if (!Reader.Consume('{') || !Reader.ConsumeLiteral("\"order\":", 8) || !ParseScalars(Reader, [&Order](const uint8* Text, int32 Length)
+		{
+			int64 Number;
+			return ParseInteger(Text, Length, 9, Number) && Order.Add(Number) >= 0;
+		}))
+		{
+			return false;
+		}
+
+		TArray<FDecodedGroup> Groups;
+		if (!Reader.Consume(',') || !Reader.ConsumeLiteral("\"groups\":", 9) || !Reader.Consume('['))
+		{
+			return false;
+		}
+		do
+		{
+			if (!ParseGroup(Reader, Groups.AddDefaulted_GetRef()))
+			{
+				return false;
+			}
+		}
+		while (Reader.Consume(','));
+		if (!Reader.Consume(']') || !Reader.Consume('}'))
+		{
+			return false;
+		}
+
+		static const ANSICHAR EventsKey[] = "\"events\":[";
+		OutEnvelope.Append(reinterpret_cast<const uint8*>(EventsKey), UE_ARRAY_COUNT(EventsKey) - 1);
+		bool bFirstEvent = true;
+		for (int32 Run = 0; Run + 1 < Order.Num(); Run += 2)
+		{
+			if (Order[Run] < 0 || Order[Run] >= Groups.Num() || Order[Run + 1] < 1)
+			{
+				OutError = TEXT("Columnar order does not match the groups");
+				return false;
+			}
+
+			FDecodedGroup& Group = Groups[Order[Run]];
+			if (Order[Run + 1] > Group.NumRows - Group.NextRow)
+			{
+				OutError = TEXT("Columnar order does not match the groups");
+				return false;
+			}
+			for (int64 Index = 0; Index < Order[Run + 1]; ++Index, ++Group.NextRow)
+			{
+				if (!bFirstEvent)
+				{
+					OutEnvelope.Add(',');
+				}
+				bFirstEvent = false;
+				for (int32 Slot = 0; Slot < Group.Columns.Num(); ++Slot)
+				{
+					OutEnvelope.Append(Group.Fragments[Slot]);
+					OutEnvelope.Append(Group.Columns[Slot].GetRow(Group.NextRow));
+				}
+				OutEnvelope.Append(Group.Fragments.Last());
+			}
+			if (OutEnvelope.Num() > MaxEnvelopeBytes)
+			{
+				OutError = TEXT("Decoded batch is too large");
+				return false;
+			}
+		}
+		OutEnvelope.Add(']');
+
+		for (const FDecodedGroup& Group : Groups)
+		{
+			if (Group.NextRow != Group.NumRows || Order.Num() % 2 != 0)
+			{
+				OutError = TEXT("Columnar order does not match the groups");
+				return false;
+			}
+		}
+		OutError.Reset();
+		return true;
+	}
+}
+
+bool FHelikaColumnarBatch::Encode(TConstArrayView<uint8> Envelope, TArray<uint8>& OutColumnar)
+{
+	using namespace HelikaColumnarBatch;
+	HELIKA_TRACE_SCOPE("Serialization");
+	HELIKA_LLM_SCOPE(Serialization);
+
+	OutColumnar.Reset();
+	FHelikaJsonWriter Writer(OutColumnar);
+	FReader Reader(Envelope);
+	if (!Reader.Consume('{'))
+	{
+		return false;
+	}
+	Writer.WriteObjectStart();
+
+	// Fields other than the events are kept as they are, in their place
+	bool bEncodedEvents = false;
+	do
+	{
+		const int32 KeyStart = Reader.Pos;
+		if (!bEncodedEvents && Reader.ConsumeLiteral("\"events\":", 9))
+		{
+			if (!EncodeEvents(Reader, Writer))
+			{
+				return false;
+			}
+			bEncodedEvents = true;
+			continue;
+		}
+
+		if (!Reader.SkipString() || !Reader.Consume(':'))
+		{
+			return false;
+		}
+		const int32 ValueStart = Reader.Pos;
+		if (!Reader.SkipValue(0))
+		{
+			return false;
+		}
+		Writer.WriteRaw(TConstArrayView<uint8>(Envelope.GetData() + KeyStart, ValueStart - KeyStart));
+		Writer.WriteRaw(TConstArrayView<uint8>(Envelope.GetData() + ValueStart, Reader.Pos - ValueStart));
+	}
+	while (Reader.Consume(','));
+
+	if (!Reader.Consume('}') || !Reader.AtEnd() || !bEncodedEvents)
+	{
+		return false;
+	}
+	Writer.WriteObjectEnd();
+	return true;
+}
+
+bool FHelikaColumnarBatch::Decode(TConstArrayView<uint8> Columnar, int64 MaxEnvelopeBytes, TArray<uint8>& OutEnvelope, FString& OutError)
+{
+	using namespace HelikaColumnarBatch;
+
+	OutEnvelope.Reset();
+	FReader Reader(Columnar);
+	if (!Reader.Consume('{'))
+	{
+		OutError = TEXT("Columnar batch is not a json object");
+		return false;
+	}
+	OutEnvelope.Add('{');
+
+	bool bDecodedEvents = false;
+	bool bFirstField = true;
+	do
+	{
+		if (!bFirstField)
+		{
+			OutEnvelope.Add(',');
+		}
+		bFirstField = false;
+
+		if (!bDecodedEvents && Reader.ConsumeLiteral("\"columnar\":", 11))
+		{
+			if (!DecodeEvents(Reader, MaxEnvelopeBytes, OutEnvelope, OutError))
+			{
+				return false;
+			}
+			bDecodedEvents = true;
+			continue;
+		}
+
+		const int32 FieldStart = Reader.Pos;
+		if (!Reader.SkipString() || !Reader.Consume(':') || !Reader.SkipValue(0))
+		{
+			OutError = TEXT("Malformed columnar batch");
+			return false;
+		}
+		OutEnvelope.Append(Columnar.GetData() + FieldStart, Reader.Pos - FieldStart);
+	}
+	while (Reader.Consume(','));
+
+	if (!Reader.Consume('}') || !Reader.AtEnd() || !bDecodedEvents)
+	{
+		OutError = TEXT("Malformed columnar batch");
+		return false;
+	}
+	OutEnvelope.Add('}');
+	return true;
+}
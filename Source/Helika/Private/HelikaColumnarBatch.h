@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Column oriented encoding of an upload envelope, sent with the x-helika-batch-format: columnar header.
+ *
+ * The events of a batch mostly share their keys and repeat the same few values (map, team, session and the spliced
+ * context blocks). The encoder groups events by shape, the event with every scalar value cut out, writes each shape
+ * once and each of its value slots as a column:
+ *   {"id":..,"columnar":{"order":[group,count,..],"groups":[{"rows":N,"shape":["{\"event_type\":",..],"columns":[..]},..]}}
+ * A column is {"c":value} when constant, {"d":[values],"i":[indices]} as a dictionary, {"t":[first,deltas..]} for
+ * ISO 8601 times in milliseconds, {"n":[first,deltas..]} for integers or {"v":[values]}, whichever is the smallest.
+ * Values keep their JSON text and "order" keeps the event order, so Decode rebuilds the envelope byte for byte.
+ */
+class FHelikaColumnarBatch
+{
+public:
+	/// Value of the x-helika-batch-format header of columnar bodies
+	static const TCHAR* GetFormatName() { return TEXT("columnar"); }
+
+	/// False when Envelope is not a compact envelope as written by FHelikaBatchSerializer
+	static bool Encode(TConstArrayView<uint8> Envelope, TArray<uint8>& OutColumnar);
+
+	/// Rebuilds the row envelope, false with OutError set for malformed input or an envelope over MaxEnvelopeBytes
+	static bool Decode(TConstArrayView<uint8> Columnar, int64 MaxEnvelopeBytes, TArray<uint8>& OutEnvelope, FString& OutError);
+};
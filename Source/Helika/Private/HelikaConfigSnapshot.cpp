@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaConfigSnapshot.h"
+
+#include "HelikaDefines.h"
+#include "HelikaLibrary.h"
+#include "HelikaSettings.h"
+#include "HelikaSidecarTransport.h"
+
+void FHelikaConfigSnapshot::CaptureSettings(const UHelikaSettings& Settings)
+{
+	HelikaAPIKey = Settings.HelikaAPIKey;
+	GameId = Settings.GameId;
+	HelikaEnvironment = Settings.HelikaEnvironment;
+	BaseUrl = UHelikaLibrary::ConvertUrl(Settings.HelikaEnvironment);
+
+	// If Localhost is set, force print events unless the local mock collector is used
+	Telemetry = Settings.HelikaEnvironment != EHelikaEnvironment::HE_Localhost || Settings.bUploadOnLocalhost ? Settings.Telemetry : ETelemetryLevel::TL_None;
+	bPrintEventsToConsole = Settings.bPrintEventsToConsole;
+
+	SDKName = Settings.SDKName;
+	SDKVersion = Settings.SDKVersion;
+	SDKClass = Settings.SDKClass;
+	SDKPlatform = UHelikaLibrary::GetPlatformName();
+
+	EventSampleRate = FMath::Clamp(Settings.EventSampleRate, 0.f, 1.f);
+	// The aggregator compresses the merged batches of every process on the host
+	bCompressPayloads = Settings.bCompressPayloads && Settings.Transport != EHelikaTransport::HT_Sidecar;
+	bColumnarPayloads = Settings.bColumnarPayloads && Settings.Transport != EHelikaTransport::HT_Sidecar;
+	BatchLimits.MaxBatchBytes = static_cast<int64>(FMath::Max(Settings.MaxBatchKilobytes, 1)) << 10;
+	BatchLimits.MaxCompressedBatchBytes = static_cast<int64>(FMath::Max(Settings.MaxCompressedBatchKilobytes, 1)) << 10;
+	BatchLimits.MaxEventBytes = static_cast<int64>(FMath::Max(Settings.MaxEventKilobytes, 1)) << 10;
+	BatchLimits.OversizedEventPolicy = Settings.OversizedEventPolicy;
+	BatchLimits.ParallelThreshold = FMath::Max(Settings.ParallelSerializationThreshold, 0);
+	if (Settings.Transport == EHelikaTransport::HT_Sidecar)
+	{
+		BatchLimits.MaxBatchBytes = FMath::Min<int64>(BatchLimits.MaxBatchBytes, FHelikaSidecarFrame::MaxGameBatchBytes);
+		BatchLimits.MaxEventBytes = FMath::Min(BatchLimits.MaxEventBytes, BatchLimits.MaxBatchBytes);
+	}
+
+	// The Normal lane keeps the top level batching settings
+	const FHelikaLaneSettings NormalLane(Settings.MaxBatchSize, Settings.FlushIntervalSeconds, Settings.MaxEventRetries, Settings.MaxQueuedEvents, Settings.MaxBackoffSeconds);
+	const FHelikaLaneSettings* LaneSettings[] = {&Settings.CriticalLane, &NormalLane, &Settings.BulkLane};
+	static_assert(UE_ARRAY_COUNT(LaneSettings) == static_cast<int32>(EHelikaPriority::Count), "Every priority needs lane settings");
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(LaneSettings); ++Index)
+	{
+		Lanes[Index].MaxBatchSize = FMath::Max(LaneSettings[Index]->MaxBatchSize, 1);
+		Lanes[Index].FlushIntervalSeconds = FMath::Max(LaneSettings[Index]->FlushIntervalSeconds, 0.f);
+		Lanes[Index].MaxEventRetries = FMath::Max(LaneSettings[Index]->MaxEventRetries, 0);
+		Lanes[Index].MaxQueuedEvents = FMath::Max(LaneSettings[Index]->MaxQueuedEvents, 0);
+		Lanes[Index].MaxBackoffSeconds = FMath::Max(LaneSettings[Index]->MaxBackoffSeconds, 0.f);
+	}
+	EventTypePriorities = Settings.EventTypePriorities;
+
+	Connectivity.OfflineAfterFailures = FMath::Max(Settings.OfflineAfterFailures, 1);
+	Connectivity.ProbeIntervalSeconds = FMath::Max(Settings.ProbeIntervalSeconds, 0.1f);
+	Connectivity.MaxProbeIntervalSeconds = FMath::Max(Settings.MaxProbeIntervalSeconds, Connectivity.ProbeIntervalSeconds);
+	Connectivity.MaxDrainRequests = FMath::Max(Settings.MaxDrainRequests, 1);
+	Connectivity.bUseConnectivityHints = Settings.bUseConnectivityHints;
+	Connectivity.bSpillWhileOffline = Settings.bSpillWhileOffline;
+	Connectivity.MaxSpillBytes = static_cast<int64>(FMath::Max(Settings.MaxSpillMegabytes, 1)) << 20;
+
+	GameMetrics.bEnabled = Settings.bEnableGameMetrics;
+	GameMetrics.IntervalSeconds = FMath::Max(Settings.GameMetricsIntervalSeconds, 1.f);
+	GameMetrics.RelativeAccuracy = FMath::Clamp(Settings.GameMetricsRelativeAccuracy, 0.0001f, 0.2f);
+	GameMetrics.HistogramBins = FMath::Max(Settings.GameMetricsHistogramBins, 16);
+	GameMetrics.MaxSeries = FMath::Max(Settings.MaxGameMetricSeries, 1);
+
+	Scheduler.BudgetMicroseconds = FMath::Max(Settings.GameThreadBudgetMicroseconds, 0);
+	Scheduler.FrameTargetMs = FMath::Max(Settings.FrameTargetMs, 0.f);
+	Scheduler.MaxDeferralSeconds = FMath::Max(Settings.MaxDeferralSeconds, 0.f);
+
+	Transport.Kind = Settings.Transport;
+	Transport.MaxConnections = FMath::Max(Settings.TransportMaxConnections, 1);
+	Transport.TimeoutSeconds = FMath::Max(Settings.TransportTimeoutSeconds, 0.f);
+	Transport.SidecarSocketPath = Settings.SidecarSocketPath;
+
+	// A salt known only to the project keeps hashed fields from being reversed with a dictionary
+	const bool bHashes = Settings.EventRules.ContainsByPredicate([](const FHelikaEventRule& Rule) { return Rule.Action == EHelikaEventRuleAction::HER_HashField; });
+	if (bHashes && Settings.EventRuleHashSalt.IsEmpty())
+	{
+		UE_LOG(LogHelika, Warning, TEXT("EventRuleHashSalt is empty, hashed fields are keyed by the GameId, set a secret salt for this project"));
+	}
+	EventRules = FHelikaEventRules::Compile(Settings.EventRules, Settings.EventRuleHashSalt.IsEmpty() ? Settings.GameId : Settings.EventRuleHashSalt);
+}
+
+EHelikaPriority FHelikaConfigSnapshot::ResolvePriority(const FJsonObject& Event, EHelikaPriority Requested) const
+{
+	FString EventType;
+	if (Requested != EHelikaPriority::HP_Normal || EventTypePriorities.IsEmpty() || !Event.TryGetStringField(TEXT("event_type"), EventType))
+	{
+		return Requested;
+	}
+	return ResolvePriority(EventType, Requested);
+}
+
+EHelikaPriority FHelikaConfigSnapshot::ResolvePriority(const FString& EventType, EHelikaPriority Requested) const
+{
+	if (Requested != EHelikaPriority::HP_Normal || EventTypePriorities.IsEmpty())
+	{
+		return Requested;
+	}
+
+	const EHelikaPriority* Mapped = EventTypePriorities.Find(EventType);
+	return Mapped && *Mapped != EHelikaPriority::Count ? *Mapped : Requested;
+}
+
+float FHelikaConfigSnapshot::GetFlushTickInterval() const
+{
+	float Interval = Lanes[0].FlushIntervalSeconds;
+	for (const FHelikaLaneConfig& Lane : Lanes)
+	{
+		Interval = FMath::Min(Interval, Lane.FlushIntervalSeconds);
+	}
+	return Interval;
+}
+
+TSharedPtr<FJsonObject> FHelikaConfigSnapshot::CopyJsonObject(const TSharedPtr<FJsonObject>& Source)
+{
+	const TSharedPtr<FJsonObject> Copy = MakeShareable(new FJsonObject());
+	if (Source.IsValid())
+	{
+		Copy->Values.Reserve(Source->Values.Num());
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Source->Values)
+		{
+			Copy->Values.Add(Pair.Key, CopyJsonValue(Pair.Value));
+		}
+	}
+	return Copy;
+}
+
+TSharedPtr<FJsonValue> FHelikaConfigSnapshot::CopyJsonValue(const TSharedPtr<FJsonValue>& Source)
+{
+	if (!Source.IsValid())
+	{
+		return Source;
+	}
+
+	switch (Source->Type)
+	{
+	case EJson::Object:
+		return MakeShared<FJsonValueObject>(CopyJsonObject(Source->AsObject()));
+	case EJson::Array:
+	{
+		TArray<TSharedPtr<FJsonValue>> Elements;
+		Elements.Reserve(Source->AsArray().Num());
+		for (const TSharedPtr<FJsonValue>& Element : Source->AsArray())
+		{
+			Elements.Add(CopyJsonValue(Element));
+		}
+		return MakeShared<FJsonValueArray>(MoveTemp(Elements));
+	}
+	default:
+		return Source;
+	}
+}
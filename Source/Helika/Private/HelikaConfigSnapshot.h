@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaEventRules.h"
+#include "HelikaEventTypes.h"
+#include "HelikaTypes.h"
+
+class UHelikaSettings;
+
+/// Batching, retries, shedding and backoff of one EHelikaPriority lane
+struct FHelikaLaneConfig
+{
+	int32 MaxBatchSize = 100;
+	float FlushIntervalSeconds = 1.0f;
+	int32 MaxEventRetries = 3;
+	/// 0 keeps every event
+	int32 MaxQueuedEvents = 0;
+	float MaxBackoffSeconds = 60.0f;
+};
+
+/// Byte budget of one upload envelope
+struct FHelikaBatchLimits
+{
+	int64 MaxBatchBytes = 1024ll << 10;
+	/// Only applies to compressed uploads
+	int64 MaxCompressedBatchBytes = 256ll << 10;
+	int64 MaxEventBytes = 64ll << 10;
+	EHelikaOversizedEventPolicy OversizedEventPolicy = EHelikaOversizedEventPolicy::HOE_Truncate;
+	/// Batches of at least this many events are enriched and encoded in parallel, 0 never
+	int32 ParallelThreshold = 0;
+	/// Upper bound of the tasks encoding one envelope, 0 uses every worker thread
+	int32 MaxParallelTasks = 0;
+};
+
+/// Offline detection, probing, draining and spilling of the upload scheduler
+struct FHelikaConnectivityConfig
+{
+	int32 OfflineAfterFailures = 3;
+	float ProbeIntervalSeconds = 2.0f;
+	float MaxProbeIntervalSeconds = 60.0f;
+	int32 MaxDrainRequests = 2;
+	bool bUseConnectivityHints = true;
+	bool bSpillWhileOffline = true;
+	int64 MaxSpillBytes = 32ll << 20;
+};
+
+/// Per-frame game thread budget of the deferred SDK work
+struct FHelikaSchedulerConfig
+{
+	int32 BudgetMicroseconds = 500;
+	/// 0 follows t.MaxFPS
+	float FrameTargetMs = 0.0f;
+	float MaxDeferralSeconds = 0.5f;
+};
+
+/// HTTP client of the uploads and probes
+struct FHelikaTransportConfig
+{
+	EHelikaTransport Kind = EHelikaTransport::HT_HttpModule;
+	int32 MaxConnections = 4;
+	/// 0 keeps the client's default
+	float TimeoutSeconds = 30.0f;
+	/// Empty for FHelikaSidecarFrame::GetDefaultSocketPath
+	FString SidecarSocketPath;
+
+	bool operator==(const FHelikaTransportConfig& Other) const
+	{
+		return Kind == Other.Kind && MaxConnections == Other.MaxConnections && TimeoutSeconds == Other.TimeoutSeconds && SidecarSocketPath == Other.SidecarSocketPath;
+	}
+
+	bool operator!=(const FHelikaTransportConfig& Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+/// Recording and periodic summary of the gauges, counters and histograms of the game
+struct FHelikaGameMetricsConfig
+{
+	bool bEnabled = true;
+	float IntervalSeconds = 60.0f;
+	double RelativeAccuracy = 0.01;
+	int32 HistogramBins = 2048;
+	int32 MaxSeries = 256;
+};
+
+/**
+ * Immutable view of the settings, app details and user details used by the send path.
+ * A new version is published by UHelikaManager whenever one of them changes.
+ */
+struct FHelikaConfigSnapshot
+{
+	uint32 Version = 0;
+
+	FString HelikaAPIKey;
+	FString GameId;
+	FString BaseUrl;
+	EHelikaEnvironment HelikaEnvironment = EHelikaEnvironment::HE_Localhost;
+	ETelemetryLevel Telemetry = ETelemetryLevel::TL_None;
+	bool bPrintEventsToConsole = true;
+	bool bPiiTracking = false;
+
+	FString SDKName;
+	FString SDKVersion;
+	FString SDKClass;
+	FString SDKPlatform;
+
+	float EventSampleRate = 1.0f;
+	bool bCompressPayloads = false;
+	bool bColumnarPayloads = false;
+	FHelikaBatchLimits BatchLimits;
+
+	FHelikaLaneConfig Lanes[static_cast<int32>(EHelikaPriority::Count)];
+	TMap<FString, EHelikaPriority> EventTypePriorities;
+
+	FHelikaConnectivityConfig Connectivity;
+
+	FHelikaGameMetricsConfig GameMetrics;
+
+	FHelikaSchedulerConfig Scheduler;
+
+	FHelikaTransportConfig Transport;
+
+	/// Compiled EventRules, null when there are none
+	TSharedPtr<const FHelikaEventRules, ESPMode::ThreadSafe> EventRules;
+
+	TSharedPtr<FJsonObject> AppDetails;
+
+	/// Context used by the non-context sends (global user details, session and anon id)
+	FHelikaContextDataPtr DefaultContext;
+
+	/// Copies the plugin settings, manager state has to be filled by the caller
+	void CaptureSettings(const UHelikaSettings& Settings);
+
+	const FHelikaLaneConfig& GetLane(EHelikaPriority Priority) const
+	{
+		return Lanes[static_cast<int32>(Priority)];
+	}
+
+	/// Normal requests go to the lane listed in EventTypePriorities for the event's event_type
+	EHelikaPriority ResolvePriority(const FJsonObject& Event, EHelikaPriority Requested) const;
+	EHelikaPriority ResolvePriority(const FString& EventType, EHelikaPriority Requested) const;
+
+	/// Shortest flush interval of the lanes, the rate of the flush ticker
+	float GetFlushTickInterval() const;
+
+	/// Deep copy so later edits of the source object, nested objects and arrays included, are not observed.
+	/// Strings, numbers, booleans and null cannot be edited and are shared.
+	static TSharedPtr<FJsonObject> CopyJsonObject(const TSharedPtr<FJsonObject>& Source);
+	static TSharedPtr<FJsonValue> CopyJsonValue(const TSharedPtr<FJsonValue>& Source);
+};
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaConnectivity.h"
+
+#include "HelikaDefines.h"
+#include "HelikaTrace.h"
+#include "HelikaTransport.h"
+
+namespace
+{
+	/// Probes only need the status line, a dead route must not hold a socket for the default timeout
+	constexpr float ProbeTimeoutSeconds = 5.f;
+}
+
+void FHelikaConnectivity::Configure(const FHelikaConnectivityConfig& InConfig)
+{
+	FScopeLock ScopeLock(&Lock);
+	Config = InConfig;
+	ProbeInterval = FMath::Clamp(ProbeInterval, Config.ProbeIntervalSeconds, Config.MaxProbeIntervalSeconds);
+}
+
+EHelikaConnectivity FHelikaConnectivity::GetState() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return State;
+}
+
+int32 FHelikaConnectivity::GetUploadsInFlight() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return UploadsInFlight;
+}
+
+bool FHelikaConnectivity::TryBeginUpload(bool bBacklog)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (State == EHelikaConnectivity::HC_Offline)
+	{
+		return false;
+	}
+	if ((bBacklog || State == EHelikaConnectivity::HC_Draining) && UploadsInFlight >= Config.MaxDrainRequests)
+	{
+		return false;
+	}
+	++UploadsInFlight;
+	return true;
+}
+
+void FHelikaConnectivity::EndUpload(bool bReachedCollector, double Now)
+{
+	FScopeLock ScopeLock(&Lock);
+	UploadsInFlight = FMath::Max(UploadsInFlight - 1, 0);
+
+	// Requests that were in flight when the state changed say nothing new
+	if (State == EHelikaConnectivity::HC_Offline)
+	{
+		return;
+	}
+
+	if (bReachedCollector)
+	{
+		ConsecutiveFailures = 0;
+	}
+	else if (++ConsecutiveFailures >= Config.OfflineAfterFailures)
+	{
+		GoOffline(Now, TEXT("uploads get no answer"));
+	}
+}
+
+void FHelikaConnectivity::CancelUpload()
+{
+	FScopeLock ScopeLock(&Lock);
+	UploadsInFlight = FMath::Max(UploadsInFlight - 1, 0);
+}
+
+bool FHelikaConnectivity::TryBeginProbe(double Now)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (State != EHelikaConnectivity::HC_Offline || bProbeInFlight || bPlatformOffline || Now < NextProbeTime)
+	{
+		return false;
+	}
+	bProbeInFlight = true;
+	return true;
+}
+
+void FHelikaConnectivity::EndProbe(bool bReachedCollector, double Now)
+{
+	FScopeLock ScopeLock(&Lock);
+	bProbeInFlight = false;
+	if (State != EHelikaConnectivity::HC_Offline)
+	{
+		return;
+	}
+
+	if (bReachedCollector)
+	{
+		UE_LOG(LogHelika, Log, TEXT("Helika collector is reachable again, uploading the backlog"));
+		State = EHelikaConnectivity::HC_Draining;
+		ConsecutiveFailures = 0;
+		return;
+	}
+
+	ProbeInterval = FMath::Min(ProbeInterval * 2.f, Config.MaxProbeIntervalSeconds);
+	NextProbeTime = Now + ProbeInterval;
+}
+
+void FHelikaConnectivity::SetPlatformHint(bool bHasNetwork, double Now)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (!Config.bUseConnectivityHints || bHasNetwork != bPlatformOffline)
+	{
+		return;
+	}
+
+	bPlatformOffline = !bHasNetwork;
+	if (bPlatformOffline)
+	{
+		if (State != EHelikaConnectivity::HC_Offline)
+		{
+			GoOffline(Now, TEXT("the platform reports no network connection"));
+		}
+	}
+	else if (State == EHelikaConnectivity::HC_Offline)
+	{
+		ProbeInterval = Config.ProbeIntervalSeconds;
+		NextProbeTime = Now;
+	}
+}
+
+void FHelikaConnectivity::FinishDrain()
+{
+	FScopeLock ScopeLock(&Lock);
+	if (State == EHelikaConnectivity::HC_Draining)
+	{
+		UE_LOG(LogHelika, Log, TEXT("Helika backlog uploaded, back online"));
+		State = EHelikaConnectivity::HC_Online;
+	}
+}
+
+bool FHelikaConnectivity::IsPlatformOffline()
+{
+	// Desktop platforms answer Unknown, which is no hint at all
+	const ENetworkConnectionType Type = FPlatformMisc::GetNetworkConnectionType();
+	return Type == ENetworkConnectionType::None || Type == ENetworkConnectionType::AirplaneMode;
+}
+
+void FHelikaConnectivity::SendProbe(IHelikaTransport& Transport, const FString& BaseUrl, TUniqueFunction<void(bool bReachedCollector)>&& OnComplete)
+{
+	HELIKA_TRACE_SCOPE("Probe");
+
+	FHelikaTransportRequest Request;
+	Request.Verb = TEXT("HEAD");
+	Request.Url = BaseUrl;
+	Request.TimeoutSeconds = ProbeTimeoutSeconds;
+	Transport.Send(MoveTemp(Request), [OnComplete = MoveTemp(OnComplete)](FHelikaTransportResponse&& Response) mutable
+	{
+		OnComplete(Response.bConnected && Response.Status > 0);
+	});
+}
+
+void FHelikaConnectivity::GoOffline(double Now, const TCHAR* Reason)
+{
+	UE_LOG(LogHelika, Warning, TEXT("Helika collector is unreachable (%s), holding uploads until a probe gets an answer"), Reason);
+	State = EHelikaConnectivity::HC_Offline;
+	ConsecutiveFailures = 0;
+	ProbeInterval = Config.ProbeIntervalSeconds;
+	NextProbeTime = Now + ProbeInterval;
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaConfigSnapshot.h"
+#include "HelikaTypes.h"
+
+class IHelikaTransport;
+
+/**
+ * Connectivity state machine of the upload scheduler.
+ *
+ * Online:   every due batch is uploaded.
+ * Offline:  entered after OfflineAfterFailures uploads in a row got no answer, or when the platform reports no network.
+ *           No batch is uploaded, a lightweight probe is sent every ProbeIntervalSeconds (doubled while unanswered).
+ * Draining: the first answered probe leaves Offline, the backlog is uploaded with at most MaxDrainRequests requests
+ *           in flight and the scheduler goes Online once it is gone.
+ *
+ * Only answers matter: an error status still proves the collector is reachable and is handled by the lane backoff.
+ */
+class FHelikaConnectivity
+{
+public:
+	void Configure(const FHelikaConnectivityConfig& InConfig);
+
+	EHelikaConnectivity GetState() const;
+	int32 GetUploadsInFlight() const;
+
+	/**
+	 * Reserves a request slot, fails while offline and while draining once MaxDrainRequests requests are in flight.
+	 * Backlog uploads (spilled batches) are held to MaxDrainRequests in every state.
+	 */
+	bool TryBeginUpload(bool bBacklog = false);
+
+	/// Releases the slot of an upload, bReachedCollector is false when the request got no answer at all
+	void EndUpload(bool bReachedCollector, double Now);
+
+	/// Releases a slot that was reserved but not used
+	void CancelUpload();
+
+	/// True when a probe is due, the caller sends it and reports the outcome through EndProbe
+	bool TryBeginProbe(double Now);
+	void EndProbe(bool bReachedCollector, double Now);
+
+	/// Platform hint: losing the network goes offline at once, getting it back makes the next probe due now
+	void SetPlatformHint(bool bHasNetwork, double Now);
+
+	/// Called by the scheduler once the backlog is uploaded
+	void FinishDrain();
+
+	/// Whether the platform can tell and reports no usable network connection
+	static bool IsPlatformOffline();
+
+	/// Sends a HEAD request to BaseUrl through Transport, any answer counts as reachable. OnComplete runs on the transport's completion thread.
+	static void SendProbe(IHelikaTransport& Transport, const FString& BaseUrl, TUniqueFunction<void(bool bReachedCollector)>&& OnComplete);
+
+private:
+	/// Called with the lock held
+	void GoOffline(double Now, const TCHAR* Reason);
+
+	mutable FCriticalSection Lock;
+	FHelikaConnectivityConfig Config;
+	EHelikaConnectivity State = EHelikaConnectivity::HC_Online;
+	int32 ConsecutiveFailures = 0;
+	int32 UploadsInFlight = 0;
+	bool bProbeInFlight = false;
+	bool bPlatformOffline = false;
+	double NextProbeTime = 0.0;
+	float ProbeInterval = 0.f;
+};
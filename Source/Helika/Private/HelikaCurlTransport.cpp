@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaCurlTransport.h"
+
+#if HELIKA_WITH_CURL
+
+#include "HelikaDefines.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	/// Longest wait of the I/O thread for socket activity, Send and Stop wake it earlier
+	constexpr int32 PollTimeoutMs = 250;
+	constexpr long ConnectTimeoutMs = 10000;
+	constexpr float DefaultTimeoutSeconds = 30.f;
+	/// Idle easy handles kept per allowed connection
+	constexpr int32 IdleHandlesPerConnection = 2;
+}
+
+FHelikaCurlTransport::FHelikaCurlTransport(const FHelikaTransportConfig& InConfig)
+	: Config(InConfig)
+{
+	// Reference counted by libcurl, the engine's own HTTP module may have initialized it already
+	curl_global_init(CURL_GLOBAL_ALL);
+
+	// The engine's bundle, the system store of libcurl when the project does not stage it
+	const FString EngineCertificates = FPaths::EngineContentDir() / TEXT("Certificates/ThirdParty/cacert.pem");
+	if (FPaths::FileExists(EngineCertificates))
+	{
+		CertificatePath = FPaths::ConvertRelativePathToFull(EngineCertificates);
+	}
+
+	Multi = curl_multi_init();
+	curl_multi_setopt(Multi, CURLMOPT_PIPELINING, static_cast<long>(CURLPIPE_MULTIPLEX));
+	curl_multi_setopt(Multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(Config.MaxConnections));
+	curl_multi_setopt(Multi, CURLMOPT_MAXCONNECTS, static_cast<long>(Config.MaxConnections * IdleHandlesPerConnection));
+
+	Thread = FRunnableThread::Create(this, TEXT("HelikaCurlTransport"), 0, TPri_BelowNormal);
+	UE_CLOG(Thread == nullptr, LogHelika, Error, TEXT("Helika Curl transport could not start its I/O thread, uploads complete unanswered"));
+}
+
+FHelikaCurlTransport::~FHelikaCurlTransport()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	// Without a thread nothing drained the queue
+	AbortAll();
+
+	for (CURL* Easy : IdleHandles)
+	{
+		curl_easy_cleanup(Easy);
+	}
+	IdleHandles.Empty();
+	curl_multi_cleanup(Multi);
+	curl_global_cleanup();
+}
+
+void FHelikaCurlTransport::Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete)
+{
+	TUniquePtr<FTransfer> Transfer = MakeUnique<FTransfer>();
+	Transfer->Request = MoveTemp(Request);
+	Transfer->OnComplete = MoveTemp(OnComplete);
+	Incoming.Enqueue(MoveTemp(Transfer));
+	curl_multi_wakeup(Multi);
+}
+
+uint32 FHelikaCurlTransport::Run()
+{
+	while (!bStopping.load(std::memory_order_relaxed))
+	{
+		TUniquePtr<FTransfer> Transfer;
+		while (Incoming.Dequeue(Transfer))
+		{
+			StartTransfer(MoveTemp(Transfer));
+		}
+
+		int NumRunning = 0;
+		curl_multi_perform(Multi, &NumRunning);
+
+		int NumMessages = 0;
+		while (CURLMsg* Message = curl_multi_info_read(Multi, &NumMessages))
+		{
+			if (Message->msg == CURLMSG_DONE)
+			{
+				FinishTransfer(Message->easy_handle, Message->data.result);
+			}
+		}
+
+		curl_multi_poll(Multi, nullptr, 0, PollTimeoutMs, nullptr);
+	}
+
+	AbortAll();
+	return 0;
+}
+
+void FHelikaCurlTransport::Stop()
+{
+	bStopping.store(true, std::memory_order_relaxed);
+	curl_multi_wakeup(Multi);
+}
+
+void FHelikaCurlTransport::StartTransfer(TUniquePtr<FTransfer>&& Transfer)
+{
+	FHelikaTransportRequest& Request = Transfer->Request;
+	CURL* Easy = AcquireEasy();
+
+	curl_easy_setopt(Easy, CURLOPT_URL, TCHAR_TO_UTF8(*Request.Url));
+	curl_easy_setopt(Easy, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(Easy, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+	// Wait for a multiplexed stream on an existing connection rather than opening another one
+	curl_easy_setopt(Easy, CURLOPT_PIPEWAIT, 1L);
+	curl_easy_setopt(Easy, CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(Easy, CURLOPT_CONNECTTIMEOUT_MS, ConnectTimeoutMs);
+	const float TimeoutSeconds = Request.TimeoutSeconds > 0.f ? Request.TimeoutSeconds : Config.TimeoutSeconds > 0.f ? Config.TimeoutSeconds : DefaultTimeoutSeconds;
+	curl_easy_setopt(Easy, CURLOPT_TIMEOUT_MS, static_cast<long>(TimeoutSeconds * 1000.f));
+	if (!CertificatePath.IsEmpty())
+	{
+		curl_easy_setopt(Easy, CURLOPT_CAINFO, TCHAR_TO_UTF8(*CertificatePath));
+	}
+
+	if (Request.Verb == TEXT("HEAD"))
+	{
+		curl_easy_setopt(Easy, CURLOPT_NOBODY, 1L);
+	}
+	else
+	{
+		if (Request.Verb != TEXT("POST"))
+		{
+			curl_easy_setopt(Easy, CURLOPT_CUSTOMREQUEST, TCHAR_TO_UTF8(*Request.Verb));
+		}
+		// The body is read in place, the transfer owns it until FinishTransfer
+		curl_easy_setopt(Easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(Request.Body.Num()));
+		curl_easy_setopt(Easy, CURLOPT_POSTFIELDS, Request.Body.GetData());
+	}
+
+	for (const TPair<FString, FString>& Header : Request.Headers)
+	{
+		Transfer->Headers = curl_slist_append(Transfer->Headers, TCHAR_TO_UTF8(*FString::Printf(TEXT("%s: %s"), *Header.Key, *Header.Value)));
+	}
+	// Collectors answer at once, waiting for 100-continue only costs a round trip
+	Transfer->Headers = curl_slist_append(Transfer->Headers, "Expect:");
+	curl_easy_setopt(Easy, CURLOPT_HTTPHEADER, Transfer->Headers);
+
+	curl_easy_setopt(Easy, CURLOPT_WRITEFUNCTION, &FHelikaCurlTransport::OnBody);
+	curl_easy_setopt(Easy, CURLOPT_WRITEDATA, Transfer.Get());
+	curl_easy_setopt(Easy, CURLOPT_HEADERFUNCTION, &FHelikaCurlTransport::OnHeader);
+	curl_easy_setopt(Easy, CURLOPT_HEADERDATA, Transfer.Get());
+
+	const CURLMcode Result = curl_multi_add_handle(Multi, Easy);
+	if (Result != CURLM_OK)
+	{
+		Transfer->Response.Error = UTF8_TO_TCHAR(curl_multi_strerror(Result));
+		curl_slist_free_all(Transfer->Headers);
+		ReleaseEasy(Easy);
+		Transfer->OnComplete(MoveTemp(Transfer->Response));
+		return;
+	}
+	Running.Add(Easy, MoveTemp(Transfer));
+}
+
+void FHelikaCurlTransport::FinishTransfer(CURL* Easy, int32 Result)
+{
+	TUniquePtr<FTransfer> Transfer;
+	Running.RemoveAndCopyValue(Easy, Transfer);
+	curl_multi_remove_handle(Multi, Easy);
+	if (!Transfer.IsValid())
+	{
+		ReleaseEasy(Easy);
+		return;
+	}
+
+	FHelikaTransportResponse& Response = Transfer->Response;
+	if (Result == CURLE_OK)
+	{
+		long Status = 0;
+		curl_easy_getinfo(Easy, CURLINFO_RESPONSE_CODE, &Status);
+		Response.bConnected = true;
+		Response.Status = static_cast<int32>(Status);
+	}
+	else
+	{
+		Response.bConnected = false;
+		Response.Status = 0;
+		Response.Body.Reset();
+		Response.Error = UTF8_TO_TCHAR(curl_easy_strerror(static_cast<CURLcode>(Result)));
+	}
+
+	curl_slist_free_all(Transfer->Headers);
+	Transfer->Headers = nullptr;
+	ReleaseEasy(Easy);
+	Transfer->OnComplete(MoveTemp(Response));
+}
+
+void FHelikaCurlTransport::AbortAll()
+{
+	TUniquePtr<FTransfer> Transfer;
+	while (Incoming.Dequeue(Transfer))
+	{
+		Transfer->Response.Error = TEXT("Transport stopped");
+		Transfer->OnComplete(MoveTemp(Transfer->Response));
+	}
+
+	for (TPair<CURL*, TUniquePtr<FTransfer>>& Entry : Running)
+	{
+		curl_multi_remove_handle(Multi, Entry.Key);
+		curl_easy_cleanup(Entry.Key);
+		FTransfer& Aborted = *Entry.Value;
+		curl_slist_free_all(Aborted.Headers);
+		Aborted.Response = FHelikaTransportResponse();
+		Aborted.Response.Error = TEXT("Transport stopped");
+		Aborted.OnComplete(MoveTemp(Aborted.Response));
+	}
+	Running.Empty();
+}
+
+CURL* FHelikaCurlTransport::AcquireEasy()
+{
+	return IdleHandles.Num() > 0 ? IdleHandles.Pop(false) : curl_easy_init();
+}
+
+void FHelikaCurlTransport::ReleaseEasy(CURL* Easy)
+{
+	// Connections live in the multi handle, a reset handle only keeps its DNS and TLS session caches
+	curl_easy_reset(Easy);
+	if (IdleHandles.Num() < Config.MaxConnections * IdleHandlesPerConnection)
+	{
+		IdleHandles.Add(Easy);
+	}
+	else
+	{
+		curl_easy_cleanup(Easy);
+	}
+}
+
+size_t FHelikaCurlTransport::OnBody(char* Data, size_t Size, size_t Count, void* UserData)
+{
+	FTransfer* Transfer = static_cast<FTransfer*>(UserData);
+	const size_t NumBytes = Size * Count;
+	Transfer->Response.Body.Append(reinterpret_cast<const uint8*>(Data), static_cast<int32>(NumBytes));
+	return NumBytes;
+}
+
+size_t FHelikaCurlTransport::OnHeader(char* Data, size_t Size, size_t Count, void* UserData)
+{
+	FTransfer* Transfer = static_cast<FTransfer*>(UserData);
+	const size_t NumBytes = Size * Count;
+
+	// A new status line starts the headers of the final response after interim ones
+	const FUTF8ToTCHAR Converted(Data, static_cast<int32>(NumBytes));
+	const FString Line = FString(Converted.Length(), Converted.Get()).TrimStartAndEnd();
+	FString Name;
+	FString Value;
+	if (Line.StartsWith(TEXT("HTTP/")))
+	{
+		Transfer->Response.RetryAfterSeconds = 0;
+	}
+	else if (Line.Split(TEXT(":"), &Name, &Value) && Name.TrimEnd().Equals(TEXT("Retry-After"), ESearchCase::IgnoreCase))
+	{
+		Transfer->Response.RetryAfterSeconds = ParseRetryAfter(Value);
+	}
+	return NumBytes;
+}
+
+#endif
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaTransport.h"
+
+#if HELIKA_WITH_CURL
+
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+#include "curl/curl.h"
+
+/**
+ * libcurl multi handle driven by its own I/O thread, so neither the game thread nor the engine's HTTP thread wait on uploads.
+ *
+ * Connections are kept alive and shared by every request to a host, up to MaxConnections of them, and HTTP/2 multiplexes
+ * requests over one connection where the collector offers it. Easy handles are pooled and reused.
+ * Request bodies are handed to libcurl in place and stay owned by the transfer until it completes.
+ * Completions run on the I/O thread.
+ */
+class FHelikaCurlTransport : public IHelikaTransport, public FRunnable
+{
+public:
+	explicit FHelikaCurlTransport(const FHelikaTransportConfig& InConfig);
+	virtual ~FHelikaCurlTransport() override;
+
+	virtual void Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete) override;
+	virtual const TCHAR* GetName() const override { return TEXT("Curl"); }
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	//~ End FRunnable Interface
+
+private:
+	struct FTransfer
+	{
+		FHelikaTransportRequest Request;
+		FOnComplete OnComplete;
+		FHelikaTransportResponse Response;
+		curl_slist* Headers = nullptr;
+	};
+
+	/// I/O thread, adds the transfer to the multi handle or completes it at once when that fails
+	void StartTransfer(TUniquePtr<FTransfer>&& Transfer);
+	/// I/O thread, Result is a CURLcode
+	void FinishTransfer(CURL* Easy, int32 Result);
+	/// I/O thread, completes every queued and running transfer unanswered
+	void AbortAll();
+
+	CURL* AcquireEasy();
+	void ReleaseEasy(CURL* Easy);
+
+	static size_t OnBody(char* Data, size_t Size, size_t Count, void* UserData);
+	static size_t OnHeader(char* Data, size_t Size, size_t Count, void* UserData);
+
+	FHelikaTransportConfig Config;
+	FString CertificatePath;
+
+	CURLM* Multi = nullptr;
+	FRunnableThread* Thread = nullptr;
+	std::atomic<bool> bStopping{false};
+
+	/// Filled by Send on any thread, drained by the I/O thread
+	TQueue<TUniquePtr<FTransfer>, EQueueMode::Mpsc> Incoming;
+
+	/// I/O thread only
+	TMap<CURL*, TUniquePtr<FTransfer>> Running;
+	TArray<CURL*> IdleHandles;
+};
+
+#endif
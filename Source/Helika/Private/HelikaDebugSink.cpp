@@ -0,0 +1,323 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaDebugSink.h"
+
+#include "HelikaDefines.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+
+namespace HelikaDebugSink
+{
+	static constexpr uint32 RingCapacity = 256;
+
+	static FString GetFilePath(int32 Index)
+	{
+		const FString Directory = FPaths::ProjectLogDir() / TEXT("Helika");
+		return Index == 0 ? Directory / TEXT("HelikaEvents.log") : Directory / FString::Printf(TEXT("HelikaEvents.%d.log"), Index);
+	}
+
+	static FAutoConsoleCommandWithWorldArgsAndOutputDevice DumpEventsCommand(
+		TEXT("Helika.DumpEvents"),
+		TEXT("Prints the last payloads and responses seen by the Helika debug sink. Usage: Helika.DumpEvents [Count]"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : MAX_int32;
+			for (const FString& Entry : FHelikaDebugSink::Get().GetHistory(Count))
+			{
+				Ar.Log(Entry);
+			}
+
+			const FHelikaDebugSinkStats Stats = FHelikaDebugSink::Get().GetStats();
+			Ar.Logf(TEXT("Helika debug sink: %lld pushed, %lld written, %lld suppressed, %lld truncated, %lld dropped (ring full)"),
+				Stats.Pushed, Stats.Written, Stats.Suppressed, Stats.Truncated, Stats.DroppedFull);
+		}));
+}
+
+FHelikaDebugSink& FHelikaDebugSink::Get()
+{
+	static FHelikaDebugSink Sink;
+	return Sink;
+}
+
+FHelikaDebugSink::FHelikaDebugSink()
+	: Ring(HelikaDebugSink::RingCapacity)
+{
+}
+
+FHelikaDebugSink::~FHelikaDebugSink()
+{
+	Shutdown();
+}
+
+void FHelikaDebugSink::Push(EHelikaDebugEntryKind Kind, TConstArrayView<uint8> Body, int32 NumEvents, int32 Status)
+{
+	FHelikaDebugEntry Entry;
+	Entry.Kind = Kind;
+	Entry.Time = FDateTime::Now();
+	Entry.NumEvents = NumEvents;
+	Entry.Status = Status;
+	Entry.OriginalBytes = Body.Num();
+	Entry.Body.Append(Body.GetData(), FMath::Min(Body.Num(), MaxEntryBytes.load(std::memory_order_relaxed)));
+
+	if (!bThreadStarted.load(std::memory_order_acquire))
+	{
+		StartThread();
+	}
+
+	Pushed.fetch_add(1, std::memory_order_relaxed);
+	if (!Ring.Push(MoveTemp(Entry)))
+	{
+		DroppedFull.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (Thread == nullptr)
+	{
+		// No multithreading on this platform, the caller does the consumer's work
+		FScopeLock Lock(&StartLock);
+		ProcessEntries();
+	}
+}
+
+void FHelikaDebugSink::Configure(const FHelikaDebugSinkConfig& InConfig)
+{
+	FScopeLock Lock(&ConfigLock);
+	Config = InConfig;
+	Config.MaxEntriesPerSecond = FMath::Max(Config.MaxEntriesPerSecond, 1);
+	Config.MaxEntryBytes = FMath::Max(Config.MaxEntryBytes, 0);
+	Config.HistorySize = FMath::Max(Config.HistorySize, 0);
+	Config.MaxFiles = FMath::Max(Config.MaxFiles, 1);
+	MaxEntryBytes.store(Config.MaxEntryBytes, std::memory_order_relaxed);
+}
+
+bool FHelikaDebugSink::WaitUntilIdle(float TimeoutSeconds)
+{
+	const double EndTime = FPlatformTime::Seconds() + TimeoutSeconds;
+	while (Processed.load(std::memory_order_relaxed) < Pushed.load(std::memory_order_relaxed) - DroppedFull.load(std::memory_order_relaxed))
+	{
+		if (FPlatformTime::Seconds() >= EndTime)
+		{
+			return false;
+		}
+		if (WakeEvent != nullptr)
+		{
+			WakeEvent->Trigger();
+		}
+		FPlatformProcess::Sleep(0.001f);
+	}
+	return true;
+}
+
+void FHelikaDebugSink::Shutdown()
+{
+	FScopeLock Lock(&StartLock);
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+	if (WakeEvent != nullptr)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+	}
+	File.Reset();
+	bThreadStarted.store(false, std::memory_order_release);
+}
+
+TArray<FString> FHelikaDebugSink::GetHistory(int32 MaxEntries) const
+{
+	FScopeLock Lock(&HistoryLock);
+	const int32 Count = FMath::Min(MaxEntries, History.Num());
+
+	TArray<FString> Entries;
+	Entries.Reserve(Count);
+	for (int32 Index = History.Num() - Count; Index < History.Num(); ++Index)
+	{
+		// HistoryNext is the oldest entry once the buffer has wrapped
+		Entries.Add(Format(History[(HistoryNext + Index) % History.Num()]));
+	}
+	return Entries;
+}
+
+FHelikaDebugSinkStats FHelikaDebugSink::GetStats() const
+{
+	FHelikaDebugSinkStats Stats;
+	Stats.Pushed = Pushed.load(std::memory_order_relaxed);
+	Stats.DroppedFull = DroppedFull.load(std::memory_order_relaxed);
+	Stats.Suppressed = Suppressed.load(std::memory_order_relaxed);
+	Stats.Truncated = Truncated.load(std::memory_order_relaxed);
+	Stats.Written = Written.load(std::memory_order_relaxed);
+	return Stats;
+}
+
+FString FHelikaDebugSink::Format(const FHelikaDebugEntry& Entry)
+{
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Entry.Body.GetData()), Entry.Body.Num());
+	const FString Body(Converted.Length(), Converted.Get());
+
+	FString Message = Entry.Kind == EHelikaDebugEntryKind::Response
+		? FString::Printf(TEXT("[Helika] Server Response %d: %s"), Entry.Status, *Body)
+		: FString::Printf(TEXT("[Helika] Event Sent: %s (%d events)\nEvent:\n%s"), Entry.Kind == EHelikaDebugEntryKind::Sent ? TEXT("Sent") : TEXT("Print Only"), Entry.NumEvents, *Body);
+
+	if (Entry.OriginalBytes > Entry.Body.Num())
+	{
+		Message += FString::Printf(TEXT("... (truncated, %d of %d bytes)"), Entry.Body.Num(), Entry.OriginalBytes);
+	}
+	return Message;
+}
+
+uint32 FHelikaDebugSink::Run()
+{
+	while (!bStopping.load(std::memory_order_relaxed))
+	{
+		ProcessEntries();
+		WakeEvent->Wait(50);
+	}
+
+	// Whatever was pushed before shutdown is still written
+	ProcessEntries();
+	return 0;
+}
+
+void FHelikaDebugSink::Stop()
+{
+	bStopping.store(true, std::memory_order_relaxed);
+	if (WakeEvent != nullptr)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FHelikaDebugSink::StartThread()
+{
+	FScopeLock Lock(&StartLock);
+	if (bThreadStarted.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	bStopping.store(false, std::memory_order_relaxed);
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FPlatformProcess::SupportsMultithreading() ? FRunnableThread::Create(this, TEXT("HelikaDebugSink"), 0, TPri_BelowNormal) : nullptr;
+	bThreadStarted.store(true, std::memory_order_release);
+}
+
+void FHelikaDebugSink::ProcessEntries()
+{
+	const FHelikaDebugSinkConfig CurrentConfig = GetConfig();
+
+	FHelikaDebugEntry Entry;
+	while (Ring.Pop(Entry))
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now - WindowStart >= 1.0)
+		{
+			if (WindowSuppressed > 0)
+			{
+				Write(FString::Printf(TEXT("[Helika] %lld printed payloads suppressed by DebugMaxEntriesPerSecond"), WindowSuppressed), FDateTime::Now(), CurrentConfig);
+			}
+			WindowStart = Now;
+			WindowEntries = 0;
+			WindowSuppressed = 0;
+		}
+
+		if (Entry.OriginalBytes > Entry.Body.Num())
+		{
+			Truncated.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if (WindowEntries < CurrentConfig.MaxEntriesPerSecond)
+		{
+			++WindowEntries;
+			Write(Format(Entry), Entry.Time, CurrentConfig);
+			Written.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			++WindowSuppressed;
+			Suppressed.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		{
+			FScopeLock Lock(&HistoryLock);
+			if (History.Num() > CurrentConfig.HistorySize)
+			{
+				History.Reset();
+				HistoryNext = 0;
+			}
+
+			if (History.Num() < CurrentConfig.HistorySize)
+			{
+				History.Add(MoveTemp(Entry));
+			}
+			else if (CurrentConfig.HistorySize > 0)
+			{
+				History[HistoryNext] = MoveTemp(Entry);
+				HistoryNext = (HistoryNext + 1) % CurrentConfig.HistorySize;
+			}
+		}
+
+		Processed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (File.IsValid())
+	{
+		File->Flush();
+	}
+}
+
+void FHelikaDebugSink::Write(const FString& Line, const FDateTime& Time, const FHelikaDebugSinkConfig& CurrentConfig)
+{
+	if (CurrentConfig.Output != EHelikaDebugOutput::HDO_File)
+	{
+		UE_LOG(LogHelika, Display, TEXT("%s"), *Line);
+	}
+	if (CurrentConfig.Output != EHelikaDebugOutput::HDO_Log)
+	{
+		WriteToFile(FString::Printf(TEXT("[%s]%s"), *Time.ToString(TEXT("%Y.%m.%d-%H.%M.%S:%s")), *Line), CurrentConfig);
+	}
+}
+
+void FHelikaDebugSink::WriteToFile(const FString& Line, const FHelikaDebugSinkConfig& CurrentConfig)
+{
+	using namespace HelikaDebugSink;
+
+	const FTCHARToUTF8 Utf8(*(Line + LINE_TERMINATOR));
+
+	if (File.IsValid() && FileBytes + Utf8.Length() > CurrentConfig.MaxFileBytes)
+	{
+		File.Reset();
+
+		// HelikaEvents.log and the rotated files make MaxFiles, the oldest one goes
+		IFileManager::Get().Delete(*GetFilePath(CurrentConfig.MaxFiles - 1), false, false, true);
+		for (int32 Index = CurrentConfig.MaxFiles - 2; Index >= 0; --Index)
+		{
+			if (IFileManager::Get().FileExists(*GetFilePath(Index)))
+			{
+				IFileManager::Get().Move(*GetFilePath(Index + 1), *GetFilePath(Index), true);
+			}
+		}
+	}
+
+	if (!File.IsValid())
+	{
+		File.Reset(IFileManager::Get().CreateFileWriter(*GetFilePath(0), FILEWRITE_Append | FILEWRITE_AllowRead));
+		FileBytes = FMath::Max<int64>(IFileManager::Get().FileSize(*GetFilePath(0)), 0);
+	}
+
+	if (File.IsValid())
+	{
+		File->Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+		FileBytes += Utf8.Length();
+	}
+}
+
+FHelikaDebugSinkConfig FHelikaDebugSink::GetConfig() const
+{
+	FScopeLock Lock(&ConfigLock);
+	return Config;
+}
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HelikaRingBuffer.h"
+#include "HelikaTypes.h"
+#include <atomic>
+
+class FArchive;
+class FEvent;
+class FRunnableThread;
+
+enum class EHelikaDebugEntryKind : uint8
+{
+	/// Payload uploaded to the collector
+	Sent,
+	/// Payload printed instead of uploaded (telemetry None or Localhost)
+	PrintOnly,
+	/// Body returned by the collector
+	Response
+};
+
+/// One payload or response waiting to be printed, the body is UTF-8 and already truncated
+struct FHelikaDebugEntry
+{
+	EHelikaDebugEntryKind Kind = EHelikaDebugEntryKind::Sent;
+	FDateTime Time;
+	int32 NumEvents = 0;
+	int32 Status = 0;
+	/// Size before truncation
+	int32 OriginalBytes = 0;
+	TArray<uint8> Body;
+};
+
+struct FHelikaDebugSinkConfig
+{
+	EHelikaDebugOutput Output = EHelikaDebugOutput::HDO_Log;
+	int32 MaxEntriesPerSecond = 10;
+	int32 MaxEntryBytes = 4096;
+	int32 HistorySize = 50;
+
+	/// The file output rotates to HelikaEvents.1.log ... once it reaches this size
+	int64 MaxFileBytes = 8 * 1024 * 1024;
+	/// Files kept, HelikaEvents.log included
+	int32 MaxFiles = 3;
+};
+
+struct FHelikaDebugSinkStats
+{
+	int64 Pushed = 0;
+	/// Entries lost because the ring was full
+	int64 DroppedFull = 0;
+	/// Entries consumed but not written because of the per-second limit
+	int64 Suppressed = 0;
+	int64 Truncated = 0;
+	int64 Written = 0;
+};
+
+/**
+ * Debug output of bPrintEventsToConsole.
+ *
+ * The calling thread copies at most MaxEntryBytes of the body into a lock-free ring, a background
+ * thread formats the entries and writes them to the log or a rotating file under a per-second limit.
+ * The last HistorySize entries are kept for the 'Helika.DumpEvents [N]' console command.
+ */
+class FHelikaDebugSink : public FRunnable
+{
+public:
+	static FHelikaDebugSink& Get();
+
+	FHelikaDebugSink();
+	virtual ~FHelikaDebugSink() override;
+
+	/// Copies up to MaxEntryBytes of Body, never blocks, the entry is dropped when the ring is full
+	void Push(EHelikaDebugEntryKind Kind, TConstArrayView<uint8> Body, int32 NumEvents = 0, int32 Status = 0);
+
+	void Configure(const FHelikaDebugSinkConfig& InConfig);
+
+	/// Waits until every pushed entry has been processed, for tests and shutdown
+	bool WaitUntilIdle(float TimeoutSeconds);
+
+	/// Stops the background thread after writing what is left in the ring
+	void Shutdown();
+
+	/// Formatted last entries, oldest first
+	TArray<FString> GetHistory(int32 MaxEntries = MAX_int32) const;
+
+	FHelikaDebugSinkStats GetStats() const;
+
+	static FString Format(const FHelikaDebugEntry& Entry);
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	void StartThread();
+	void ProcessEntries();
+	void Write(const FString& Line, const FDateTime& Time, const FHelikaDebugSinkConfig& CurrentConfig);
+	void WriteToFile(const FString& Line, const FHelikaDebugSinkConfig& CurrentConfig);
+	FHelikaDebugSinkConfig GetConfig() const;
+
+	THelikaRingBuffer<FHelikaDebugEntry> Ring;
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	FCriticalSection StartLock;
+	std::atomic<bool> bThreadStarted{false};
+	std::atomic<bool> bStopping{false};
+
+	FHelikaDebugSinkConfig Config;
+	mutable FCriticalSection ConfigLock;
+	std::atomic<int32> MaxEntryBytes{4096};
+
+	/// Written by the consumer, read by the console command
+	TArray<FHelikaDebugEntry> History;
+	int32 HistoryNext = 0;
+	mutable FCriticalSection HistoryLock;
+
+	std::atomic<int64> Pushed{0};
+	std::atomic<int64> DroppedFull{0};
+	std::atomic<int64> Processed{0};
+	std::atomic<int64> Suppressed{0};
+	std::atomic<int64> Truncated{0};
+	std::atomic<int64> Written{0};
+
+	/// Consumer thread only
+	double WindowStart = 0.0;
+	int32 WindowEntries = 0;
+	int64 WindowSuppressed = 0;
+	TUniquePtr<FArchive> File;
+	int64 FileBytes = 0;
+};
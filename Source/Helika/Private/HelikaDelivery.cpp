@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaDelivery.h"
+
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "CoreGlobals.h"
+
+FHelikaDelivery::~FHelikaDelivery()
+{
+	if (!bSettled.load(std::memory_order_acquire))
+	{
+		Dispatch(EHelikaDeliveryResult::HD_Dropped);
+	}
+}
+
+void FHelikaDelivery::Settle(EHelikaDeliveryResult Result, int32 Num)
+{
+	if (Result != EHelikaDeliveryResult::HD_Delivered)
+	{
+		uint8 Expected = static_cast<uint8>(EHelikaDeliveryResult::HD_Delivered);
+		FirstFailure.compare_exchange_strong(Expected, static_cast<uint8>(Result), std::memory_order_relaxed);
+	}
+
+	if (NumPending.fetch_sub(Num, std::memory_order_acq_rel) == Num)
+	{
+		Dispatch(static_cast<EHelikaDeliveryResult>(FirstFailure.load(std::memory_order_relaxed)));
+	}
+}
+
+void FHelikaDelivery::Dispatch(EHelikaDeliveryResult Result)
+{
+	if (bSettled.exchange(true, std::memory_order_acq_rel) || !OnSettled)
+	{
+		return;
+	}
+	// Deliveries released while the engine shuts down, e.g. with the manager's queues, have nobody left to tell
+	// and no game thread tick to run on
+	if (IsEngineExitRequested() || !FTaskGraphInterface::IsRunning())
+	{
+		return;
+	}
+
+	AsyncTask(ENamedThreads::GameThread, [Callback = MoveTemp(OnSettled), Result]()
+	{
+		Callback(Result);
+	});
+}
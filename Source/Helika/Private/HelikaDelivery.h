@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaTypes.h"
+#include <atomic>
+
+/**
+ * Completion signal of one or more events, or of the uploads started by a flush.
+ *
+ * Every pending item is settled once by the pipeline stage where it leaves (acknowledgement, shedding, spilling, ...).
+ * When the last one is settled OnSettled runs on the game thread with HD_Delivered, or with the first failure.
+ * Items that are never settled, e.g. events still queued when the SDK is deinitialized, are reported as HD_Dropped once the delivery
+ * is released. Nothing is reported once the engine is exiting.
+ */
+class FHelikaDelivery
+{
+public:
+	typedef TUniqueFunction<void(EHelikaDeliveryResult)> FOnSettled;
+
+	explicit FHelikaDelivery(FOnSettled&& InOnSettled, int32 InNumPending = 1)
+		: OnSettled(MoveTemp(InOnSettled))
+		, NumPending(InNumPending)
+	{
+	}
+
+	~FHelikaDelivery();
+
+	/// Thread safe
+	void AddPending(int32 Num = 1)
+	{
+		NumPending.fetch_add(Num, std::memory_order_relaxed);
+	}
+
+	/// Thread safe, settles Num pending items with Result
+	void Settle(EHelikaDeliveryResult Result, int32 Num = 1);
+
+	bool IsSettled() const { return bSettled.load(std::memory_order_acquire); }
+
+private:
+	/// Runs OnSettled on the game thread, never inline so callers finish first
+	void Dispatch(EHelikaDeliveryResult Result);
+
+	FOnSettled OnSettled;
+	std::atomic<int32> NumPending;
+	/// HD_Delivered until the first failure
+	std::atomic<uint8> FirstFailure{static_cast<uint8>(EHelikaDeliveryResult::HD_Delivered)};
+	std::atomic<bool> bSettled{false};
+};
+
+typedef TSharedPtr<FHelikaDelivery, ESPMode::ThreadSafe> FHelikaDeliveryPtr;
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaEventTypes.h"
+#include "HelikaMemoryCounters.h"
+#include <atomic>
+
+/**
+ * Thread safe queue shared by every sender (global and per-player contexts).
+ * Producers only pay for a locked append, batches are cut by the flush.
+ */
+class FHelikaEventQueue
+{
+public:
+	~FHelikaEventQueue()
+	{
+		FHelikaMemoryCounters::Add(EHelikaMemoryTag::IngestQueue, -TrackedBytes);
+	}
+
+	/// Adds the event and returns the queue depth after insertion
+	int32 Enqueue(FHelikaQueuedEvent&& Event)
+	{
+		// Walking every tree would cost about as much as serializing it, the size is sampled instead
+		if ((NumEnqueued.fetch_add(1, std::memory_order_relaxed) & (EventSizeSampleInterval - 1)) == 0)
+		{
+			int64 EventBytes = FHelikaMemoryCounters::EstimateJsonBytes(Event.Event) + Event.Values.GetAllocatedSize();
+			for (const TSharedPtr<FJsonValue>& Value : Event.Values)
+			{
+				EventBytes += FHelikaMemoryCounters::EstimateJsonBytes(Value);
+			}
+			const int64 Average = AverageEventBytes.load(std::memory_order_relaxed);
+			AverageEventBytes.store(Average == 0 ? EventBytes : (Average * 7 + EventBytes) / 8, std::memory_order_relaxed);
+		}
+
+		HELIKA_LLM_SCOPE(IngestQueue);
+		FScopeLock Lock(&CriticalSection);
+		Events.Add(MoveTemp(Event));
+		UpdateTrackedBytes();
+		return Events.Num();
+	}
+
+	/// Moves up to MaxEvents events (oldest first) into OutEvents, returns false once the queue is empty
+	bool DequeueBatch(TArray<FHelikaQueuedEvent>& OutEvents, int32 MaxEvents)
+	{
+		FScopeLock Lock(&CriticalSection);
+		if (Events.IsEmpty())
+		{
+			return false;
+		}
+
+		const int32 Count = FMath::Clamp(MaxEvents, 1, Events.Num());
+		OutEvents.Reset(Count);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			OutEvents.Add(MoveTemp(Events[Index]));
+		}
+		Events.RemoveAt(0, Count, false);
+		UpdateTrackedBytes();
+		return true;
+	}
+
+	/// Puts events back at the front of the queue so retried events stay ahead of newer ones
+	void Requeue(TArray<FHelikaQueuedEvent>&& InEvents)
+	{
+		HELIKA_LLM_SCOPE(IngestQueue);
+		FScopeLock Lock(&CriticalSection);
+		Events.Insert(MoveTemp(InEvents), 0);
+		UpdateTrackedBytes();
+	}
+
+	/// Drops the oldest events until at most MaxEvents remain, returns the number dropped
+	int32 Shed(int32 MaxEvents)
+	{
+		FScopeLock Lock(&CriticalSection);
+		const int32 Count = FMath::Max(Events.Num() - MaxEvents, 0);
+		if (Count > 0)
+		{
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				if (Events[Index].Delivery.IsValid())
+				{
+					Events[Index].Delivery->Settle(EHelikaDeliveryResult::HD_Shed);
+				}
+			}
+			Events.RemoveAt(0, Count, false);
+			UpdateTrackedBytes();
+		}
+		return Count;
+	}
+
+	int32 Num() const
+	{
+		FScopeLock Lock(&CriticalSection);
+		return Events.Num();
+	}
+
+	void Empty()
+	{
+		FScopeLock Lock(&CriticalSection);
+		Events.Empty();
+		UpdateTrackedBytes();
+	}
+
+private:
+	static constexpr uint32 EventSizeSampleInterval = 32;
+
+	/// Queue storage plus the estimated trees of the queued events, called with the lock held
+	void UpdateTrackedBytes()
+	{
+		const int64 Bytes = Events.GetAllocatedSize() + Events.Num() * AverageEventBytes.load(std::memory_order_relaxed);
+		FHelikaMemoryCounters::Add(EHelikaMemoryTag::IngestQueue, Bytes - TrackedBytes);
+		TrackedBytes = Bytes;
+	}
+
+	mutable FCriticalSection CriticalSection;
+	TArray<FHelikaQueuedEvent> Events;
+
+	std::atomic<uint32> NumEnqueued{0};
+	std::atomic<int64> AverageEventBytes{0};
+	int64 TrackedBytes = 0;
+};
@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaEventRecorder.h"
+
+#include "HelikaDefines.h"
+#include "HelikaJsonWriter.h"
+#include "HAL/FileManager.h"
+#include "Serialization/Archive.h"
+
+namespace
+{
+	enum : uint8
+	{
+		ContextRecord = 1,
+		EventRecord = 2
+	};
+
+	/// Largest payload accepted by the reader, guards against reading a corrupt length
+	constexpr uint32 MaxRecordBytes = 64 * 1024 * 1024;
+
+	void WriteBytes(FArchive& Ar, TArray<uint8>& Bytes)
+	{
+		uint32 Length = Bytes.Num();
+		Ar.SerializeIntPacked(Length);
+		Ar.Serialize(Bytes.GetData(), Length);
+	}
+
+	bool ReadBytes(FArchive& Ar, TArray<uint8>& OutBytes)
+	{
+		uint32 Length = 0;
+		Ar.SerializeIntPacked(Length);
+		if (Ar.IsError() || Length > MaxRecordBytes || Ar.Tell() + Length > Ar.TotalSize())
+		{
+			return false;
+		}
+		OutBytes.SetNumUninitialized(Length);
+		Ar.Serialize(OutBytes.GetData(), Length);
+		return !Ar.IsError();
+	}
+
+	TArray<uint8> Encode(const TSharedPtr<FJsonObject>& Object)
+	{
+		return Object.IsValid() ? FHelikaJsonWriter::SerializeObject(Object) : TArray<uint8>();
+	}
+}
+
+FHelikaEventRecorder& FHelikaEventRecorder::Get()
+{
+	static FHelikaEventRecorder Recorder;
+	return Recorder;
+}
+
+FHelikaEventRecorder::~FHelikaEventRecorder()
+{
+	Stop();
+}
+
+bool FHelikaEventRecorder::Start(const FString& FilePath)
+{
+	Stop();
+
+	FScopeLock Lock(&CriticalSection);
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Could not create the event recording %s"), *FilePath);
+		return false;
+	}
+
+	uint32 HeaderMagic = Magic;
+	uint32 HeaderVersion = FormatVersion;
+	int64 StartTicks = FDateTime::UtcNow().GetTicks();
+	*Writer << HeaderMagic << HeaderVersion << StartTicks;
+
+	StartSeconds = FPlatformTime::Seconds();
+	LastTimestampUs = 0;
+	ContextVersions.Reset();
+	NumRecorded.store(0, std::memory_order_relaxed);
+	bRecording.store(true, std::memory_order_relaxed);
+
+	UE_LOG(LogHelika, Log, TEXT("Recording accepted events to %s"), *FilePath);
+	return true;
+}
+
+void FHelikaEventRecorder::Stop()
+{
+	FScopeLock Lock(&CriticalSection);
+	if (!Writer.IsValid())
+	{
+		return;
+	}
+
+	bRecording.store(false, std::memory_order_relaxed);
+	Writer->Close();
+	Writer.Reset();
+	ContextVersions.Reset();
+	UE_LOG(LogHelika, Log, TEXT("Recorded %lld events"), NumRecorded.load(std::memory_order_relaxed));
+}
+
+void FHelikaEventRecorder::Record(EHelikaRecordedSend Send, EHelikaPriority Priority, const TSharedPtr<FJsonObject>& Event, const FHelikaContextDataPtr& Context, uint32 ConfigVersion)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	// Encoded outside of the lock, the caller still owns the event
+	TArray<uint8> Payload = Encode(Event);
+	const int64 TimestampUs = static_cast<int64>((FPlatformTime::Seconds() - StartSeconds) * 1000000.0);
+	uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+	const int32 ContextId = Context.IsValid() ? Context->Id : INDEX_NONE;
+
+	FScopeLock Lock(&CriticalSection);
+	if (!Writer.IsValid())
+	{
+		return;
+	}
+	FArchive& Ar = *Writer;
+
+	FContextVersion& ContextVersion = ContextVersions.FindOrAdd(ContextId);
+	if (Context.IsValid() && ContextVersion.Data != Context)
+	{
+		ContextVersion.Data = Context;
+		++ContextVersion.Version;
+
+		uint8 Kind = ContextRecord;
+		uint32 PackedId = ContextId + 1;
+		TArray<uint8> UserDetails = Encode(Context->UserDetails);
+		TArray<uint8> MatchMetadata = Encode(Context->MatchMetadata);
+		Ar << Kind;
+		Ar.SerializeIntPacked(PackedId);
+		Ar.SerializeIntPacked(ContextVersion.Version);
+		WriteBytes(Ar, UserDetails);
+		WriteBytes(Ar, MatchMetadata);
+	}
+
+	// Threads race for the lock, the timestamps of the file never go backwards
+	uint64 DeltaUs = FMath::Max(TimestampUs - LastTimestampUs, 0ll);
+	LastTimestampUs += DeltaUs;
+
+	uint8 Kind = EventRecord;
+	uint8 SendKind = static_cast<uint8>(Send);
+	uint8 PriorityKind = static_cast<uint8>(Priority);
+	uint32 PackedId = ContextId + 1;
+	Ar << Kind;
+	Ar.SerializeIntPacked64(DeltaUs);
+	Ar.SerializeIntPacked(ThreadId);
+	Ar << SendKind << PriorityKind;
+	Ar.SerializeIntPacked(PackedId);
+	Ar.SerializeIntPacked(ContextVersion.Version);
+	Ar.SerializeIntPacked(ConfigVersion);
+	WriteBytes(Ar, Payload);
+
+	NumRecorded.fetch_add(1, std::memory_order_relaxed);
+}
+
+FHelikaEventRecordReader::~FHelikaEventRecordReader() = default;
+
+bool FHelikaEventRecordReader::Open(const FString& FilePath)
+{
+	Reader.Reset(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Reader.IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Could not open the event recording %s"), *FilePath);
+		return false;
+	}
+
+	uint32 HeaderMagic = 0;
+	uint32 HeaderVersion = 0;
+	int64 StartTicks = 0;
+	*Reader << HeaderMagic << HeaderVersion << StartTicks;
+	if (Reader->IsError() || HeaderMagic != FHelikaEventRecorder::Magic || HeaderVersion != FHelikaEventRecorder::FormatVersion)
+	{
+		UE_LOG(LogHelika, Error, TEXT("%s is not an event recording of this version"), *FilePath);
+		Reader.Reset();
+		return false;
+	}
+
+	StartTime = FDateTime(StartTicks);
+	TimestampUs = 0;
+	bError = false;
+	return true;
+}
+
+FHelikaEventRecordReader::ERecord FHelikaEventRecordReader::Next(FHelikaRecordedContext& OutContext, FHelikaRecordedEvent& OutEvent)
+{
+	if (!Reader.IsValid() || bError || Reader->AtEnd())
+	{
+		return ERecord::End;
+	}
+	FArchive& Ar = *Reader;
+
+	uint8 Kind = 0;
+	Ar << Kind;
+	if (Kind == ContextRecord)
+	{
+		uint32 PackedId = 0;
+		Ar.SerializeIntPacked(PackedId);
+		Ar.SerializeIntPacked(OutContext.Version);
+		OutContext.ContextId = static_cast<int32>(PackedId) - 1;
+		if (ReadBytes(Ar, OutContext.UserDetails) && ReadBytes(Ar, OutContext.MatchMetadata))
+		{
+			return ERecord::Context;
+		}
+	}
+	else if (Kind == EventRecord)
+	{
+		uint64 DeltaUs = 0;
+		uint8 SendKind = 0;
+		uint8 PriorityKind = 0;
+		uint32 PackedId = 0;
+		Ar.SerializeIntPacked64(DeltaUs);
+		Ar.SerializeIntPacked(OutEvent.ThreadId);
+		Ar << SendKind << PriorityKind;
+		Ar.SerializeIntPacked(PackedId);
+		Ar.SerializeIntPacked(OutEvent.ContextVersion);
+		Ar.SerializeIntPacked(OutEvent.ConfigVersion);
+		if (SendKind <= static_cast<uint8>(EHelikaRecordedSend::Context) && PriorityKind < static_cast<uint8>(EHelikaPriority::Count) && ReadBytes(Ar, OutEvent.Payload))
+		{
+			TimestampUs += DeltaUs;
+			OutEvent.TimestampUs = TimestampUs;
+			OutEvent.Send = static_cast<EHelikaRecordedSend>(SendKind);
+			OutEvent.Priority = static_cast<EHelikaPriority>(PriorityKind);
+			OutEvent.ContextId = static_cast<int32>(PackedId) - 1;
+			return ERecord::Event;
+		}
+	}
+
+	UE_LOG(LogHelika, Error, TEXT("Event recording is truncated or corrupt at offset %lld"), Ar.Tell());
+	bError = true;
+	return ERecord::End;
+}
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaEventTypes.h"
+#include "HelikaTypes.h"
+#include <atomic>
+
+class FArchive;
+
+/// Send call an event was recorded from, the replay makes the same call
+enum class EHelikaRecordedSend : uint8
+{
+	Game,
+	User,
+	Context
+};
+
+/// Event accepted by UHelikaManager, as the game passed it in (before enrichment)
+struct FHelikaRecordedEvent
+{
+	/// Microseconds since the recording started
+	int64 TimestampUs = 0;
+	uint32 ThreadId = 0;
+	EHelikaRecordedSend Send = EHelikaRecordedSend::Game;
+	EHelikaPriority Priority = EHelikaPriority::HP_Normal;
+	/// INDEX_NONE for the default context of SendEvent and SendUserEvent
+	int32 ContextId = INDEX_NONE;
+	/// Version of the context (see FHelikaRecordedContext) and of the configuration snapshot the event was captured under
+	uint32 ContextVersion = 0;
+	uint32 ConfigVersion = 0;
+	/// UTF-8 JSON
+	TArray<uint8> Payload;
+};
+
+/// Recorded before the first event of every new version of a context
+struct FHelikaRecordedContext
+{
+	int32 ContextId = INDEX_NONE;
+	uint32 Version = 0;
+	/// UTF-8 JSON, empty when not set
+	TArray<uint8> UserDetails;
+	TArray<uint8> MatchMetadata;
+};
+
+/**
+ * Capture mode writing every event accepted by UHelikaManager to a compact binary trace, for the HelikaReplay commandlet.
+ *
+ * Format, little endian, integers marked packed use FArchive::SerializeIntPacked:
+ *   header  uint32 'HLKR', uint32 format version, int64 FDateTime ticks (UTC) of the start
+ *   records uint8 kind, then for kind 1 (context): packed id + 1, packed version, packed length + user details, packed length + match metadata
+ *                           for kind 2 (event): packed64 microseconds since the previous record, packed thread id, uint8 send,
+ *                           uint8 priority, packed context id + 1, packed context version, packed config version, packed length + payload
+ *
+ * Recording costs a JSON encoding and a locked buffered write per event, it is off unless started.
+ */
+class FHelikaEventRecorder
+{
+public:
+	static constexpr uint32 Magic = 0x524B4C48;
+	static constexpr uint32 FormatVersion = 1;
+
+	static FHelikaEventRecorder& Get();
+
+	~FHelikaEventRecorder();
+
+	/// Stops a running recording and starts writing to FilePath
+	bool Start(const FString& FilePath);
+	void Stop();
+
+	bool IsRecording() const { return bRecording.load(std::memory_order_relaxed); }
+
+	/// Thread safe, does nothing unless recording
+	void Record(EHelikaRecordedSend Send, EHelikaPriority Priority, const TSharedPtr<FJsonObject>& Event, const FHelikaContextDataPtr& Context, uint32 ConfigVersion);
+
+	int64 GetNumRecorded() const { return NumRecorded.load(std::memory_order_relaxed); }
+
+private:
+	struct FContextVersion
+	{
+		/// Kept alive so a new version is never mistaken for the recorded one
+		FHelikaContextDataPtr Data;
+		uint32 Version = 0;
+	};
+
+	std::atomic<bool> bRecording{false};
+	std::atomic<int64> NumRecorded{0};
+
+	FCriticalSection CriticalSection;
+	TUniquePtr<FArchive> Writer;
+	double StartSeconds = 0.0;
+	int64 LastTimestampUs = 0;
+	TMap<int32, FContextVersion> ContextVersions;
+};
+
+/// Reads a trace written by FHelikaEventRecorder
+class FHelikaEventRecordReader
+{
+public:
+	enum class ERecord : uint8
+	{
+		Context,
+		Event,
+		/// End of the file, or a truncated or corrupt record
+		End
+	};
+
+	~FHelikaEventRecordReader();
+
+	bool Open(const FString& FilePath);
+
+	/// UTC time the recording started
+	FDateTime GetStartTime() const { return StartTime; }
+
+	/// Reads the next record into OutContext or OutEvent
+	ERecord Next(FHelikaRecordedContext& OutContext, FHelikaRecordedEvent& OutEvent);
+
+	/// The last record was cut or malformed rather than the end of the file
+	bool HasError() const { return bError; }
+
+private:
+	TUniquePtr<FArchive> Reader;
+	FDateTime StartTime;
+	int64 TimestampUs = 0;
+	bool bError = false;
+};
@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaEventRules.h"
+
+#include "HelikaDefines.h"
+#include "HelikaHashing.h"
+#include "HelikaJsonWriter.h"
+#include "HelikaSettings.h"
+#include "Dom/JsonObject.h"
+
+namespace HelikaEventRules
+{
+	static const FString EventTypeField = TEXT("event_type");
+	static const FString EventField = TEXT("event");
+	static const FString EventSubTypeField = TEXT("event_sub_type");
+
+	static bool IsValid(const FHelikaEventRule& Rule)
+	{
+		if (Rule.Action == EHelikaEventRuleAction::HER_Drop)
+		{
+			return true;
+		}
+		if (Rule.FieldPath.IsEmpty())
+		{
+			UE_LOG(LogHelika, Warning, TEXT("Helika event rule for '%s' has no FieldPath and is ignored"), *Rule.EventType);
+			return false;
+		}
+		if (Rule.Action == EHelikaEventRuleAction::HER_RenameField && Rule.NewName.IsEmpty())
+		{
+			UE_LOG(LogHelika, Warning, TEXT("Helika rename rule of '%s' has no NewName and is ignored"), *Rule.FieldPath);
+			return false;
+		}
+		return true;
+	}
+}
+
+TSharedPtr<const FHelikaEventRules, ESPMode::ThreadSafe> FHelikaEventRules::Compile(TConstArrayView<FHelikaEventRule> Rules, const FString& HashSalt)
+{
+	TArray<const FHelikaEventRule*> Active;
+	TSet<FString> Types;
+	TSet<FString> SubTypes;
+	for (const FHelikaEventRule& Rule : Rules)
+	{
+		if ((Rule.bShippingOnly && !UE_BUILD_SHIPPING) || !HelikaEventRules::IsValid(Rule))
+		{
+			continue;
+		}
+		Active.Add(&Rule);
+		if (!Rule.EventType.IsEmpty())
+		{
+			Types.Add(Rule.EventType);
+		}
+		if (!Rule.EventSubType.IsEmpty())
+		{
+			SubTypes.Add(Rule.EventSubType);
+		}
+	}
+	if (Active.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	// Null Type or SubType stands for a name no rule mentions, only the rules without one apply
+	const auto Merge = [&Active, &HashSalt](const FString* Type, const FString* SubType)
+	{
+		FRuleSet RuleSet;
+		RuleSet.HashSalt = HashSalt;
+		for (const FHelikaEventRule* Rule : Active)
+		{
+			if ((Rule->EventType.IsEmpty() || (Type != nullptr && *Type == Rule->EventType)) && (Rule->EventSubType.IsEmpty() || (SubType != nullptr && *SubType == Rule->EventSubType)))
+			{
+				AddRule(RuleSet, *Rule);
+			}
+		}
+		return RuleSet;
+	};
+	const auto Fill = [&Merge, &SubTypes](FTypeRules& TypeRules, const FString* Type)
+	{
+		TypeRules.AnySubType = Merge(Type, nullptr);
+		for (const FString& SubType : SubTypes)
+		{
+			FRuleSet RuleSet = Merge(Type, &SubType);
+			if (!IsEmpty(RuleSet))
+			{
+				TypeRules.BySubType.Add(SubType, MoveTemp(RuleSet));
+			}
+		}
+	};
+
+	const TSharedRef<FHelikaEventRules, ESPMode::ThreadSafe> Compiled = MakeShared<FHelikaEventRules, ESPMode::ThreadSafe>();
+	Fill(Compiled->AnyType, nullptr);
+	for (const FString& Type : Types)
+	{
+		Fill(Compiled->ByType.Add(Type), &Type);
+	}
+	return Compiled;
+}
+
+void FHelikaEventRules::AddRule(FRuleSet& RuleSet, const FHelikaEventRule& Rule)
+{
+	if (RuleSet.Nodes.Num() == 0)
+	{
+		RuleSet.Nodes.AddDefaulted();
+	}
+	if (Rule.Action == EHelikaEventRuleAction::HER_Drop)
+	{
+		RuleSet.bDrop = true;
+		return;
+	}
+
+	// Indices, adding a node may move the others
+	TArray<FString> Path;
+	Rule.FieldPath.ParseIntoArray(Path, TEXT("."));
+	int32 NodeIndex = 0;
+	int32 ParentIndex = 0;
+	for (const FString& Key : Path)
+	{
+		ParentIndex = NodeIndex;
+		if (const int32* Child = RuleSet.Nodes[NodeIndex].Children.Find(Key))
+		{
+			NodeIndex = *Child;
+		}
+		else
+		{
+			const int32 NewIndex = RuleSet.Nodes.AddDefaulted();
+			RuleSet.Nodes[NodeIndex].Children.Add(Key, NewIndex);
+			NodeIndex = NewIndex;
+		}
+	}
+
+	FNode& Node = RuleSet.Nodes[NodeIndex];
+	switch (Rule.Action)
+	{
+	case EHelikaEventRuleAction::HER_RemoveField:
+		Node.bRemove = true;
+		break;
+	case EHelikaEventRuleAction::HER_HashField:
+		Node.bHash = true;
+		break;
+	case EHelikaEventRuleAction::HER_RenameField:
+		// Two fields renamed to one name would write the key twice, the serializer checks the names the event already has
+		for (const TPair<FString, int32>& Sibling : RuleSet.Nodes[ParentIndex].Children)
+		{
+			if (Sibling.Value != NodeIndex && RuleSet.Nodes[Sibling.Value].RenameTo == Rule.NewName)
+			{
+				UE_LOG(LogHelika, Warning, TEXT("Helika rename rule of '%s' reuses the NewName '%s' of '%s' and is ignored"), *Rule.FieldPath, *Rule.NewName, *Sibling.Key);
+				return;
+			}
+		}
+		Node.RenameTo = Rule.NewName;
+		break;
+	case EHelikaEventRuleAction::HER_TruncateField:
+		// The shortest cut wins when several rules truncate the same field
+		Node.MaxLength = Node.MaxLength > 0 ? FMath::Min(Node.MaxLength, FMath::Max(Rule.MaxLength, 1)) : FMath::Max(Rule.MaxLength, 1);
+		break;
+	default:
+		break;
+	}
+}
+
+const FHelikaEventRules::FRuleSet* FHelikaEventRules::Match(const FJsonObject& Event) const
+{
+	using namespace HelikaEventRules;
+
+	FString Type;
+	const TSharedPtr<FJsonValue>* TypeValue = Event.Values.Find(EventTypeField);
+	if (TypeValue != nullptr && TypeValue->IsValid())
+	{
+		(*TypeValue)->TryGetString(Type);
+	}
+	const FTypeRules* TypeRules = ByType.Find(Type);
+	if (TypeRules == nullptr)
+	{
+		TypeRules = &AnyType;
+	}
+
+	if (TypeRules->BySubType.Num() > 0)
+	{
+		const TSharedPtr<FJsonValue>* InternalValue = Event.Values.Find(EventField);
+		const TSharedPtr<FJsonObject>* InternalEvent = nullptr;
+		FString SubType;
+		if (InternalValue != nullptr && InternalValue->IsValid() && (*InternalValue)->TryGetObject(InternalEvent) && InternalEvent->IsValid() && (*InternalEvent)->TryGetStringField(EventSubTypeField, SubType))
+		{
+			if (const FRuleSet* RuleSet = TypeRules->BySubType.Find(SubType))
+			{
+				return RuleSet;
+			}
+		}
+	}
+	return IsEmpty(TypeRules->AnySubType) ? nullptr : &TypeRules->AnySubType;
+}
+
+const FHelikaEventRules::FRuleSet* FHelikaEventRules::Match(const FString& EventType, const FString& EventSubType) const
+{
+	using namespace HelikaEventRules;
+
+	const FTypeRules* TypeRules = ByType.Find(EventType);
+	if (TypeRules == nullptr)
+	{
+		TypeRules = &AnyType;
+	}
+
+	if (TypeRules->BySubType.Num() > 0)
+	{
+		if (const FRuleSet* RuleSet = TypeRules->BySubType.Find(EventSubType))
+		{
+			return RuleSet;
+		}
+	}
+	return IsEmpty(TypeRules->AnySubType) ? nullptr : &TypeRules->AnySubType;
+}
+
+FString FHelikaEventRules::HashValue(const TSharedPtr<FJsonValue>& Value, const FString& Salt)
+{
+	FString Text;
+	if (!Value.IsValid() || Value->Type != EJson::String || !Value->TryGetString(Text))
+	{
+		TArray<uint8> Json;
+		FHelikaJsonWriter(Json).WriteValue(Value);
+		Text = FHelikaJsonWriter::ToString(Json);
+	}
+
+	// A keyed hasher computes its key states once, serializer threads keep one each
+	static thread_local TUniquePtr<FHelikaHasher> Hasher;
+	static thread_local FString HasherSalt;
+	if (!Hasher.IsValid() || !HasherSalt.Equals(Salt, ESearchCase::CaseSensitive))
+	{
+		Hasher = MakeUnique<FHelikaHasher>(Salt);
+		HasherSalt = Salt;
+	}
+	return Hasher->Hash(Text);
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+class FJsonValue;
+struct FHelikaEventRule;
+
+/**
+ * UHelikaSettings::EventRules compiled for the serializer.
+ *
+ * The rules of every event_type / event_sub_type pair named by a rule are merged ahead of time into one FRuleSet,
+ * a path trie whose nodes carry the actions of their field. Matching an event is one map lookup on its event_type,
+ * plus one on its sub type when a rule names one, so events that no rule matches cost next to nothing.
+ */
+class FHelikaEventRules
+{
+public:
+	/// Field of a rule path, the root node stands for the event itself
+	struct FNode
+	{
+		TMap<FString, int32> Children;
+		bool bRemove = false;
+		bool bHash = false;
+		FString RenameTo;
+		/// 0 keeps the whole string
+		int32 MaxLength = 0;
+
+		bool HasValueAction() const { return bHash || MaxLength > 0; }
+	};
+
+	/// Every rule that applies to one kind of event
+	struct FRuleSet
+	{
+		bool bDrop = false;
+		TArray<FNode> Nodes;
+		/// Key of the hash actions, see HashValue
+		FString HashSalt;
+
+		const FNode& GetRoot() const { return Nodes[0]; }
+
+		const FNode* FindChild(const FNode& Parent, const FString& Key) const
+		{
+			const int32* Child = Parent.Children.Num() > 0 ? Parent.Children.Find(Key) : nullptr;
+			return Child != nullptr ? &Nodes[*Child] : nullptr;
+		}
+	};
+
+	/// Null when no rule is left for this build configuration, HashSalt keys the hash actions
+	static TSharedPtr<const FHelikaEventRules, ESPMode::ThreadSafe> Compile(TConstArrayView<FHelikaEventRule> Rules, const FString& HashSalt);
+
+	/// Rules that apply to Event, null when there are none
+	const FRuleSet* Match(const FJsonObject& Event) const;
+
+	/// Rules that apply to events of this type and sub type, for events sent by prototype handle
+	const FRuleSet* Match(const FString& EventType, const FString& EventSubType) const;
+
+	/// Hex HMAC-SHA256 keyed by Salt of a string's text or of the JSON of any other value,
+	/// the salt keeps dictionaries of known emails or ids from reversing the digests
+	static FString HashValue(const TSharedPtr<FJsonValue>& Value, const FString& Salt);
+
+private:
+	struct FTypeRules
+	{
+		/// Sub types named by some rule, with the rules that apply to every sub type merged in
+		TMap<FString, FRuleSet> BySubType;
+		/// Any other sub type, empty when no rule applies
+		FRuleSet AnySubType;
+	};
+
+	static void AddRule(FRuleSet& RuleSet, const FHelikaEventRule& Rule);
+	static bool IsEmpty(const FRuleSet& RuleSet) { return !RuleSet.bDrop && RuleSet.Nodes.Num() <= 1; }
+
+	TMap<FString, FTypeRules> ByType;
+	/// Event types no rule names
+	FTypeRules AnyType;
+};
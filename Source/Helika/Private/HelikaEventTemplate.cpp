@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaEventTemplate.h"
+
+#include "HelikaConfigSnapshot.h"
+#include "HelikaEventTypes.h"
+#include "HelikaJsonWriter.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+
+namespace HelikaEventTemplate
+{
+	/// Fields of the internal event written by the SDK, a prototype field of the same name would be replaced or merged
+	static const TCHAR* const ReservedFields[] = {
+		TEXT("event_sub_type"), TEXT("session_id"), TEXT("user_id"), TEXT("helika_data"), TEXT("app_details"), TEXT("user_details"), TEXT("match_metadata"),
+	};
+}
+
+TSharedPtr<const FHelikaEventTemplate, ESPMode::ThreadSafe> FHelikaEventTemplate::Create(const FString& EventType, const FString& EventSubType, const TArray<FString>& FieldNames, FString& OutError)
+{
+	if (EventType.TrimStartAndEnd().IsEmpty() || EventSubType.TrimStartAndEnd().IsEmpty())
+	{
+		OutError = TEXT("'event_type' and 'event_sub_type' cannot be empty");
+		return nullptr;
+	}
+
+	TSet<FString> Seen;
+	for (const FString& FieldName : FieldNames)
+	{
+		bool bReserved = false;
+		for (const TCHAR* Reserved : HelikaEventTemplate::ReservedFields)
+		{
+			bReserved |= FieldName.Equals(Reserved, ESearchCase::CaseSensitive);
+		}
+		bool bRepeated = false;
+		Seen.Add(FieldName, &bRepeated);
+
+		if (FieldName.IsEmpty() || bReserved || bRepeated)
+		{
+			OutError = FString::Printf(TEXT("field '%s' is empty, repeated or filled in by the SDK"), *FieldName);
+			return nullptr;
+		}
+	}
+
+	const TSharedRef<FHelikaEventTemplate, ESPMode::ThreadSafe> Template = MakeShared<FHelikaEventTemplate, ESPMode::ThreadSafe>();
+	Template->EventType = EventType;
+	Template->EventSubType = EventSubType;
+	Template->FieldNames = FieldNames;
+
+	FHelikaJsonWriter Writer(Template->Encoded);
+	Writer.WriteObjectStart();
+	Writer.WriteStringField(TEXT("event_type"), EventType);
+	Writer.WriteKey(TEXT("event"));
+	Writer.WriteObjectStart();
+	Writer.WriteStringField(TEXT("event_sub_type"), EventSubType);
+	Template->FieldKeyEnds.Add(Template->Encoded.Num());
+
+	for (const FString& FieldName : FieldNames)
+	{
+		// No separator in the key, the writer it is spliced into adds it
+		FHelikaJsonWriter KeyWriter(Template->Encoded);
+		KeyWriter.WriteKey(FieldName);
+		Template->FieldKeyEnds.Add(Template->Encoded.Num());
+	}
+	return Template;
+}
+
+bool FHelikaEventTemplate::Matches(const FString& InEventType, const FString& InEventSubType, const TArray<FString>& InFieldNames) const
+{
+	if (!EventType.Equals(InEventType, ESearchCase::CaseSensitive) || !EventSubType.Equals(InEventSubType, ESearchCase::CaseSensitive) || FieldNames.Num() != InFieldNames.Num())
+	{
+		return false;
+	}
+	for (int32 Index = 0; Index < FieldNames.Num(); ++Index)
+	{
+		if (!FieldNames[Index].Equals(InFieldNames[Index], ESearchCase::CaseSensitive))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+TSharedPtr<FJsonObject> FHelikaEventTemplate::MakeEvent(TConstArrayView<TSharedPtr<FJsonValue>> Values) const
+{
+	const TSharedPtr<FJsonObject> InternalEvent = MakeShareable(new FJsonObject());
+	InternalEvent->SetStringField("event_sub_type", EventSubType);
+	for (int32 Index = 0; Index < FieldNames.Num(); ++Index)
+	{
+		InternalEvent->SetField(FieldNames[Index], Values.IsValidIndex(Index) && Values[Index].IsValid() ? Values[Index] : MakeShared<FJsonValueNull>());
+	}
+
+	const TSharedPtr<FJsonObject> Event = MakeShareable(new FJsonObject());
+	Event->SetStringField("event_type", EventType);
+	Event->SetObjectField("event", InternalEvent);
+	return Event;
+}
+
+TSharedPtr<FJsonObject> FHelikaEventTemplate::MakeEnrichedEvent(const FHelikaQueuedEvent& Event)
+{
+	const TSharedPtr<FJsonObject> Enriched = Event.Template->MakeEvent(Event.Values);
+	Enriched->SetStringField("game_id", Event.Config->GameId);
+	Enriched->SetStringField("created_at", Event.CreatedAt.ToIso8601());
+
+	const TSharedPtr<FJsonObject> InternalEvent = Enriched->GetObjectField(TEXT("event"));
+	InternalEvent->SetStringField("session_id", Event.Context->SessionId);
+	InternalEvent->SetStringField("user_id", Event.bIsUserEvent ? Event.Context->GetUserId() : Event.Context->AnonymousId);
+	return Enriched;
+}
+
+int64 FHelikaEventTemplate::GetAllocatedSize() const
+{
+	int64 Bytes = sizeof(FHelikaEventTemplate) + EventType.GetAllocatedSize() + EventSubType.GetAllocatedSize() + FieldNames.GetAllocatedSize() + Encoded.GetAllocatedSize()
+		+ FieldKeyEnds.GetAllocatedSize();
+	for (const FString& FieldName : FieldNames)
+	{
+		Bytes += FieldName.GetAllocatedSize();
+	}
+	return Bytes;
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+class FJsonValue;
+struct FHelikaQueuedEvent;
+
+/**
+ * Pre-encoded shape of the events of a prototype registered with UHelikaManager::RegisterEventPrototype.
+ *
+ * The constant parts (event type, sub type and the field names) are encoded once, the serializer splices the values of
+ * each send into them. The result is byte for byte what SendEvent writes for the same event given as a json tree:
+ *   {"event_type":..,"event":{"event_sub_type":..,<fields>,"session_id":..,"user_id":..,<context blocks>},"game_id":..,"created_at":..}
+ */
+class FHelikaEventTemplate
+{
+public:
+	/// Null with the reason in OutError when a field name is empty, repeated or one the SDK fills in
+	static TSharedPtr<const FHelikaEventTemplate, ESPMode::ThreadSafe> Create(const FString& EventType, const FString& EventSubType, const TArray<FString>& FieldNames, FString& OutError);
+
+	const FString& GetEventType() const { return EventType; }
+	const FString& GetEventSubType() const { return EventSubType; }
+	const TArray<FString>& GetFieldNames() const { return FieldNames; }
+
+	/// Whether the template describes these events
+	bool Matches(const FString& InEventType, const FString& InEventSubType, const TArray<FString>& InFieldNames) const;
+
+	/// {"event_type":"..","event":{"event_sub_type":".."
+	TConstArrayView<uint8> GetHead() const { return TConstArrayView<uint8>(Encoded.GetData(), FieldKeyEnds[0]); }
+
+	/// "name": of the field at Index, spliced in front of its value
+	TConstArrayView<uint8> GetFieldKey(int32 Index) const { return TConstArrayView<uint8>(Encoded.GetData() + FieldKeyEnds[Index], FieldKeyEnds[Index + 1] - FieldKeyEnds[Index]); }
+
+	/// The event as the game would have passed it to SendEvent, for the recorder
+	TSharedPtr<FJsonObject> MakeEvent(TConstArrayView<TSharedPtr<FJsonValue>> Values) const;
+
+	/// Tree of a queued event sent by prototype, enriched like UHelikaManager::AppendAttributesToJsonObject does.
+	/// Only built for the paths that work on trees: event rules applying to the prototype and truncation.
+	static TSharedPtr<FJsonObject> MakeEnrichedEvent(const FHelikaQueuedEvent& Event);
+
+	int64 GetAllocatedSize() const;
+
+private:
+	FString EventType;
+	FString EventSubType;
+	TArray<FString> FieldNames;
+
+	/// Head followed by the key of every field
+	TArray<uint8> Encoded;
+	/// End of the head, then the end of every field key
+	TArray<int32> FieldKeyEnds;
+};
+
+typedef TSharedPtr<const FHelikaEventTemplate, ESPMode::ThreadSafe> FHelikaEventTemplatePtr;
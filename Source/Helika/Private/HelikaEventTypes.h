@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "HelikaDelivery.h"
+#include "HelikaEventTemplate.h"
+
+struct FHelikaConfigSnapshot;
+
+/**
+ * Immutable state of a player context. A new instance is published whenever something changes,
+ * so queued events can keep referencing the version they were captured with.
+ */
+struct FHelikaContextData
+{
+	int32 Id = INDEX_NONE;
+	FString SessionId;
+	FString AnonymousId;
+	TSharedPtr<FJsonObject> UserDetails;
+	TSharedPtr<FJsonObject> MatchMetadata;
+
+	FString GetUserId() const
+	{
+		FString UserId;
+		if (UserDetails.IsValid() && UserDetails->TryGetStringField(TEXT("user_id"), UserId) && !UserId.IsEmpty())
+		{
+			return UserId;
+		}
+		return AnonymousId;
+	}
+};
+
+typedef TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe> FHelikaContextDataPtr;
+typedef TSharedPtr<const FHelikaConfigSnapshot, ESPMode::ThreadSafe> FHelikaConfigSnapshotPtr;
+
+/// Event waiting in the upload queue, enrichment blocks are added when the batch is serialized
+struct FHelikaQueuedEvent
+{
+	/// Null for events sent by prototype handle, see Template
+	TSharedPtr<FJsonObject> Event;
+	FHelikaContextDataPtr Context;
+	/// Configuration version the event was captured under
+	FHelikaConfigSnapshotPtr Config;
+	bool bIsUserEvent = false;
+	/// Times the event was queued again after a transient upload failure
+	int32 NumRetries = 0;
+	/// Settled where the event leaves the pipeline, only set for events sent by the Blueprint async node
+	FHelikaDeliveryPtr Delivery;
+
+	/// Set for events sent by prototype handle, the serializer splices Values into its pre-encoded pieces
+	FHelikaEventTemplatePtr Template;
+	/// One value per field of the template, in its order
+	TArray<TSharedPtr<FJsonValue>> Values;
+	/// Send time of a prototype event, tree events carry it as "created_at"
+	FDateTime CreatedAt;
+};
@@ -0,0 +1,374 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaGameMetrics.h"
+
+#include "HelikaDefines.h"
+#include "Dom/JsonObject.h"
+#include "Hash/CityHash.h"
+#include <atomic>
+#include <limits>
+
+struct FHelikaSeries
+{
+	EHelikaSeriesType Type = EHelikaSeriesType::Gauge;
+	FString Name;
+	TMap<FString, FString> Tags;
+
+	std::atomic<int64> Count{0};
+	std::atomic<double> Sum{0.0};
+	std::atomic<double> Min{std::numeric_limits<double>::infinity()};
+	std::atomic<double> Max{-std::numeric_limits<double>::infinity()};
+	/// Gauges only, kept across intervals
+	std::atomic<double> Last{0.0};
+
+	// Histograms only
+	double RelativeAccuracy = 0.0;
+	double LogGamma = 0.0;
+	/// Absolute index of Bins[0]
+	int32 MinIndex = 0;
+	int32 NumBins = 0;
+	TUniquePtr<std::atomic<uint32>[]> Bins;
+	std::atomic<uint32> ZeroCount{0};
+
+	bool Matches(EHelikaSeriesType InType, const FString& InName, const TMap<FString, FString>& InTags) const
+	{
+		if (Type != InType || !Name.Equals(InName, ESearchCase::CaseSensitive) || Tags.Num() != InTags.Num())
+		{
+			return false;
+		}
+		for (const TPair<FString, FString>& Tag : InTags)
+		{
+			const FString* Found = Tags.Find(Tag.Key);
+			if (Found == nullptr || !Found->Equals(Tag.Value, ESearchCase::CaseSensitive))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+namespace
+{
+	struct FSeriesCacheEntry
+	{
+		uint32 InstanceId = 0;
+		FHelikaSeries* Series = nullptr;
+	};
+
+	/// Series already recorded into by this thread, only the owning thread touches it
+	thread_local TMap<uint64, FSeriesCacheEntry> SeriesCache;
+
+	std::atomic<uint32> NextInstanceId{1};
+
+	void AtomicAdd(std::atomic<double>& Target, double Value)
+	{
+		double Current = Target.load(std::memory_order_relaxed);
+		while (!Target.compare_exchange_weak(Current, Current + Value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void AtomicMin(std::atomic<double>& Target, double Value)
+	{
+		double Current = Target.load(std::memory_order_relaxed);
+		while (Value < Current && !Target.compare_exchange_weak(Current, Value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void AtomicMax(std::atomic<double>& Target, double Value)
+	{
+		double Current = Target.load(std::memory_order_relaxed);
+		while (Value > Current && !Target.compare_exchange_weak(Current, Value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	uint64 HashString(const FString& String, uint64 Seed)
+	{
+		return CityHash64WithSeed(reinterpret_cast<const char*>(*String), String.Len() * sizeof(TCHAR), Seed);
+	}
+
+	/// Independent of the order of the tags
+	uint64 HashSeries(EHelikaSeriesType Type, const FString& Name, const TMap<FString, FString>& Tags)
+	{
+		uint64 TagsHash = 0;
+		for (const TPair<FString, FString>& Tag : Tags)
+		{
+			TagsHash += HashString(Tag.Value, HashString(Tag.Key, 0));
+		}
+		return HashString(Name, TagsHash * 31 + static_cast<uint64>(Type));
+	}
+
+	int32 GetBinIndex(double Value, double LogGamma)
+	{
+		return FMath::CeilToInt32(FMath::Loge(Value) / LogGamma);
+	}
+
+	/// Value reported for an absolute bin, within the relative accuracy of every value of the bin
+	double GetBinValue(int32 Index, double LogGamma)
+	{
+		const double Gamma = FMath::Exp(LogGamma);
+		return 2.0 * FMath::Exp(Index * LogGamma) / (Gamma + 1.0);
+	}
+
+	TSharedPtr<FJsonObject> MakeSummaryObject(const FHelikaSeries& Series, const TCHAR* Type)
+	{
+		const TSharedPtr<FJsonObject> Object = MakeShareable(new FJsonObject());
+		Object->SetStringField("name", Series.Name);
+		Object->SetStringField("type", Type);
+		const TSharedPtr<FJsonObject> Tags = MakeShareable(new FJsonObject());
+		for (const TPair<FString, FString>& Tag : Series.Tags)
+		{
+			Tags->SetStringField(Tag.Key, Tag.Value);
+		}
+		Object->SetObjectField("tags", Tags);
+		return Object;
+	}
+
+	int32 EstimateHeaderBytes(const FHelikaSeries& Series)
+	{
+		int32 Bytes = 96 + Series.Name.Len();
+		for (const TPair<FString, FString>& Tag : Series.Tags)
+		{
+			Bytes += Tag.Key.Len() + Tag.Value.Len() + 6;
+		}
+		return Bytes;
+	}
+}
+
+FHelikaGameMetrics& FHelikaGameMetrics::Get()
+{
+	static FHelikaGameMetrics GameMetrics;
+	return GameMetrics;
+}
+
+FHelikaGameMetrics::FHelikaGameMetrics()
+	: InstanceId(NextInstanceId.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
+FHelikaGameMetrics::~FHelikaGameMetrics() = default;
+
+void FHelikaGameMetrics::Configure(const FHelikaGameMetricsConfig& InConfig)
+{
+	FScopeLock ScopeLock(&Lock);
+	Config = InConfig;
+	bEnabled.store(InConfig.bEnabled, std::memory_order_relaxed);
+}
+
+bool FHelikaGameMetrics::Record(EHelikaSeriesType Type, const FString& Name, double Value, const TMap<FString, FString>& Tags)
+{
+	if (!bEnabled.load(std::memory_order_relaxed) || Name.IsEmpty() || !FMath::IsFinite(Value))
+	{
+		return false;
+	}
+
+	const uint64 Hash = HashSeries(Type, Name, Tags);
+	FSeriesCacheEntry& Cached = SeriesCache.FindOrAdd(Hash);
+	FHelikaSeries* Series = Cached.InstanceId == InstanceId && Cached.Series->Matches(Type, Name, Tags) ? Cached.Series : nullptr;
+	if (Series == nullptr)
+	{
+		Series = FindOrAdd(Type, Name, Tags, Hash);
+		if (Series == nullptr)
+		{
+			return false;
+		}
+		Cached.InstanceId = InstanceId;
+		Cached.Series = Series;
+	}
+
+	switch (Type)
+	{
+	case EHelikaSeriesType::Gauge:
+		Series->Last.store(Value, std::memory_order_relaxed);
+		break;
+	case EHelikaSeriesType::Histogram:
+		if (Value <= 0.0)
+		{
+			Series->ZeroCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			const int32 Bin = FMath::Clamp(GetBinIndex(FMath::Max(Value, MinTrackedValue), Series->LogGamma) - Series->MinIndex, 0, Series->NumBins - 1);
+			Series->Bins[Bin].fetch_add(1, std::memory_order_relaxed);
+		}
+		break;
+	default:
+		break;
+	}
+	AtomicAdd(Series->Sum, Value);
+	AtomicMin(Series->Min, Value);
+	AtomicMax(Series->Max, Value);
+	Series->Count.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+FHelikaSeries* FHelikaGameMetrics::FindOrAdd(EHelikaSeriesType Type, const FString& Name, const TMap<FString, FString>& Tags, uint64 Hash)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	TArray<FHelikaSeries*, TInlineAllocator<1>> Candidates;
+	SeriesByHash.MultiFind(Hash, Candidates);
+	for (FHelikaSeries* Candidate : Candidates)
+	{
+		if (Candidate->Matches(Type, Name, Tags))
+		{
+			return Candidate;
+		}
+	}
+
+	if (Series.Num() >= Config.MaxSeries)
+	{
+		UE_CLOG(!bWarnedFull, LogHelika, Warning, TEXT("Helika game metrics reached MaxGameMetricSeries (%d), values of new series such as '%s' are ignored"), Config.MaxSeries, *Name);
+		bWarnedFull = true;
+		return nullptr;
+	}
+
+	TUniquePtr<FHelikaSeries> Added = MakeUnique<FHelikaSeries>();
+	Added->Type = Type;
+	Added->Name = Name;
+	Added->Tags = Tags;
+	if (Type == EHelikaSeriesType::Histogram)
+	{
+		const double Gamma = (1.0 + Config.RelativeAccuracy) / (1.0 - Config.RelativeAccuracy);
+		Added->RelativeAccuracy = Config.RelativeAccuracy;
+		Added->LogGamma = FMath::Loge(Gamma);
+		Added->MinIndex = GetBinIndex(MinTrackedValue, Added->LogGamma);
+		Added->NumBins = Config.HistogramBins;
+		Added->Bins = MakeUnique<std::atomic<uint32>[]>(Added->NumBins);
+		for (int32 Bin = 0; Bin < Added->NumBins; ++Bin)
+		{
+			Added->Bins[Bin].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	AllocatedSize += sizeof(FHelikaSeries) + Added->Name.GetAllocatedSize() + Added->Tags.GetAllocatedSize() + Added->NumBins * sizeof(std::atomic<uint32>);
+	for (const TPair<FString, FString>& Tag : Added->Tags)
+	{
+		AllocatedSize += Tag.Key.GetAllocatedSize() + Tag.Value.GetAllocatedSize();
+	}
+
+	FHelikaSeries* Result = Added.Get();
+	SeriesByHash.Add(Hash, Result);
+	Series.Add(MoveTemp(Added));
+	return Result;
+}
+
+TArray<FHelikaSeriesSummary> FHelikaGameMetrics::Collect()
+{
+	TArray<FHelikaSeriesSummary> Summaries;
+
+	FScopeLock ScopeLock(&Lock);
+	for (const TUniquePtr<FHelikaSeries>& Entry : Series)
+	{
+		FHelikaSeries& Current = *Entry;
+		const int64 Count = Current.Count.exchange(0, std::memory_order_relaxed);
+		if (Count == 0)
+		{
+			continue;
+		}
+		const double Sum = Current.Sum.exchange(0.0, std::memory_order_relaxed);
+		const double Min = Current.Min.exchange(std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+		const double Max = Current.Max.exchange(-std::numeric_limits<double>::infinity(), std::memory_order_relaxed);
+
+		FHelikaSeriesSummary& Summary = Summaries.AddDefaulted_GetRef();
+		Summary.EstimatedBytes = EstimateHeaderBytes(Current);
+		switch (Current.Type)
+		{
+		case EHelikaSeriesType::Gauge:
+			Summary.Object = MakeSummaryObject(Current, TEXT("gauge"));
+			Summary.Object->SetNumberField("count", Count);
+			Summary.Object->SetNumberField("last", Current.Last.load(std::memory_order_relaxed));
+			Summary.Object->SetNumberField("min", Min);
+			Summary.Object->SetNumberField("max", Max);
+			Summary.Object->SetNumberField("sum", Sum);
+			break;
+		case EHelikaSeriesType::Counter:
+			Summary.Object = MakeSummaryObject(Current, TEXT("counter"));
+			Summary.Object->SetNumberField("count", Count);
+			Summary.Object->SetNumberField("value", Sum);
+			break;
+		case EHelikaSeriesType::Histogram:
+		{
+			// Bins are read and cleared one by one, the count of the summary is the one of the bins
+			TArray<uint32> Bins;
+			Bins.SetNumUninitialized(Current.NumBins);
+			int32 FirstBin = INDEX_NONE;
+			int32 LastBin = INDEX_NONE;
+			int64 NumValues = Current.ZeroCount.exchange(0, std::memory_order_relaxed);
+			const int64 ZeroCount = NumValues;
+			for (int32 Bin = 0; Bin < Current.NumBins; ++Bin)
+			{
+				Bins[Bin] = Current.Bins[Bin].exchange(0, std::memory_order_relaxed);
+				if (Bins[Bin] > 0)
+				{
+					FirstBin = FirstBin == INDEX_NONE ? Bin : FirstBin;
+					LastBin = Bin;
+					NumValues += Bins[Bin];
+				}
+			}
+
+			auto Quantile = [&](double Q)
+			{
+				const double Rank = Q * (NumValues - 1);
+				int64 Seen = ZeroCount;
+				if (Rank < Seen)
+				{
+					return FMath::Clamp(0.0, Min, Max);
+				}
+				for (int32 Bin = FirstBin; Bin <= LastBin && Bin != INDEX_NONE; ++Bin)
+				{
+					Seen += Bins[Bin];
+					if (Seen > Rank)
+					{
+						return FMath::Clamp(GetBinValue(Bin + Current.MinIndex, Current.LogGamma), Min, Max);
+					}
+				}
+				return Max;
+			};
+
+			Summary.Object = MakeSummaryObject(Current, TEXT("histogram"));
+			Summary.Object->SetNumberField("count", NumValues);
+			Summary.Object->SetNumberField("sum", Sum);
+			Summary.Object->SetNumberField("min", Min);
+			Summary.Object->SetNumberField("max", Max);
+			Summary.Object->SetNumberField("p50", Quantile(0.5));
+			Summary.Object->SetNumberField("p90", Quantile(0.9));
+			Summary.Object->SetNumberField("p99", Quantile(0.99));
+			Summary.Object->SetNumberField("relative_accuracy", Current.RelativeAccuracy);
+			Summary.Object->SetNumberField("zero_count", ZeroCount);
+
+			// Dense run from the first to the last non-empty bin, bin_offset is the absolute index of the first one
+			TArray<TSharedPtr<FJsonValue>> Counts;
+			if (FirstBin != INDEX_NONE)
+			{
+				Counts.Reserve(LastBin - FirstBin + 1);
+				for (int32 Bin = FirstBin; Bin <= LastBin; ++Bin)
+				{
+					Counts.Add(MakeShareable(new FJsonValueNumber(Bins[Bin])));
+				}
+			}
+			Summary.Object->SetNumberField("bin_offset", FirstBin == INDEX_NONE ? 0 : FirstBin + Current.MinIndex);
+			Summary.Object->SetArrayField("bin_counts", Counts);
+			Summary.EstimatedBytes += 160 + Counts.Num() * 6;
+			break;
+		}
+		}
+	}
+	return Summaries;
+}
+
+int32 FHelikaGameMetrics::GetNumSeries() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Series.Num();
+}
+
+int64 FHelikaGameMetrics::GetAllocatedSize() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return AllocatedSize;
+}
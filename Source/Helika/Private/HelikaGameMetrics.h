@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaConfigSnapshot.h"
+#include <atomic>
+
+class FJsonObject;
+struct FHelikaSeries;
+
+enum class EHelikaSeriesType : uint8
+{
+	/// Latest value, summarized as last/min/max/sum/count
+	Gauge,
+	/// Sum of the increments of the interval
+	Counter,
+	/// Log-bucketed distribution with relative accuracy, summarized as quantiles and mergeable bins
+	Histogram
+};
+
+/// Summary of one series for the interval, EstimatedBytes is the encoded size used to split summary events
+struct FHelikaSeriesSummary
+{
+	TSharedPtr<FJsonObject> Object;
+	int32 EstimatedBytes = 0;
+};
+
+/**
+ * Gauges, counters and histograms of the game (FPS, ping, memory, queue lengths), keyed by name and tags.
+ *
+ * Recording is lock-free: every thread caches the series it records into, only the first value of a
+ * series on a thread takes the registry lock. Values are plain atomics, a value recorded while Collect
+ * runs may be split across two summaries.
+ *
+ * Histograms are DDSketch style: bin i holds the values in (gamma^(i-1), gamma^i] with
+ * gamma = (1 + RelativeAccuracy) / (1 - RelativeAccuracy), so any quantile is within RelativeAccuracy
+ * of the true value. The absolute bin indices are uploaded, histograms of the same accuracy merge by
+ * adding bins. Each histogram holds HistogramBins counters starting at MinTrackedValue, values outside
+ * that range land in the edge bins, min and max stay exact.
+ *
+ * Series live as long as the registry, MaxSeries bounds their number.
+ */
+class FHelikaGameMetrics
+{
+public:
+	/// Smallest positive value with its own bin, anything at or below zero goes to the zero bin
+	static constexpr double MinTrackedValue = 1e-3;
+
+	static FHelikaGameMetrics& Get();
+
+	FHelikaGameMetrics();
+	~FHelikaGameMetrics();
+
+	/// Accuracy and bins only apply to histograms created afterwards
+	void Configure(const FHelikaGameMetricsConfig& InConfig);
+
+	/// Returns false when disabled, the name is empty or MaxSeries is reached
+	bool Record(EHelikaSeriesType Type, const FString& Name, double Value, const TMap<FString, FString>& Tags);
+
+	/// Summaries of the series recorded since the previous call, the series are reset
+	TArray<FHelikaSeriesSummary> Collect();
+
+	int32 GetNumSeries() const;
+
+	/// Bytes held by the series and their bins
+	int64 GetAllocatedSize() const;
+
+private:
+	FHelikaSeries* FindOrAdd(EHelikaSeriesType Type, const FString& Name, const TMap<FString, FString>& Tags, uint64 Hash);
+
+	/// Tells the thread caches of different registries apart, never reused
+	const uint32 InstanceId;
+	std::atomic<bool> bEnabled{true};
+
+	mutable FCriticalSection Lock;
+	FHelikaGameMetricsConfig Config;
+	TArray<TUniquePtr<FHelikaSeries>> Series;
+	TMultiMap<uint64, FHelikaSeries*> SeriesByHash;
+	int64 AllocatedSize = 0;
+	bool bWarnedFull = false;
+};
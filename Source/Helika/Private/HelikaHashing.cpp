@@ -0,0 +1,286 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaHashing.h"
+
+#include "HelikaSha256.h"
+
+namespace
+{
+	constexpr int32 BlockBytes = 64;
+	constexpr int32 DigestBytes = 32;
+	/// Values padded and hashed together, keeps the scratch buffers small
+	constexpr int32 ChunkValues = 256;
+
+	void EncodeDigest(const uint8* Digest, EHelikaHashEncoding Encoding, ANSICHAR* Out)
+	{
+		if (Encoding == EHelikaHashEncoding::HHE_Hex)
+		{
+			static const ANSICHAR Hex[] = "0123456789abcdef";
+			for (int32 Byte = 0; Byte < DigestBytes; ++Byte)
+			{
+				Out[Byte * 2] = Hex[Digest[Byte] >> 4];
+				Out[Byte * 2 + 1] = Hex[Digest[Byte] & 0x0F];
+			}
+			return;
+		}
+
+		static const ANSICHAR Base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		int32 Byte = 0;
+		for (; Byte + 3 <= DigestBytes; Byte += 3)
+		{
+			const uint32 Group = (Digest[Byte] << 16) | (Digest[Byte + 1] << 8) | Digest[Byte + 2];
+			*Out++ = Base64[(Group >> 18) & 0x3F];
+			*Out++ = Base64[(Group >> 12) & 0x3F];
+			*Out++ = Base64[(Group >> 6) & 0x3F];
+			*Out++ = Base64[Group & 0x3F];
+		}
+		// 32 bytes leave two for the last group
+		const uint32 Group = (Digest[Byte] << 16) | (Digest[Byte + 1] << 8);
+		*Out++ = Base64[(Group >> 18) & 0x3F];
+		*Out++ = Base64[(Group >> 12) & 0x3F];
+		*Out++ = Base64[(Group >> 6) & 0x3F];
+		*Out++ = '=';
+	}
+}
+
+FHelikaHasher::FHelikaHasher(const FString& Salt, int32 InCacheCapacity)
+	: bSalted(!Salt.IsEmpty())
+	, CacheCapacity(FMath::Max(InCacheCapacity, 0))
+{
+	FMemory::Memcpy(InnerState, FHelikaSha256::InitialState, sizeof(InnerState));
+	FMemory::Memcpy(OuterState, FHelikaSha256::InitialState, sizeof(OuterState));
+	if (!bSalted)
+	{
+		return;
+	}
+
+	// HMAC key block, keys longer than a block are hashed first (RFC 2104)
+	const FTCHARToUTF8 Utf8(*Salt, Salt.Len());
+	uint8 Key[BlockBytes] = {};
+	if (Utf8.Length() > BlockBytes)
+	{
+		TArray<uint8> Blocks;
+		const int32 NumBlocks = FHelikaSha256::AppendPadded(Blocks, TConstArrayView<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length()));
+		const FHelikaSha256Message Messages[] = {{Blocks.GetData(), NumBlocks}};
+		uint32 State[8];
+		FHelikaSha256::HashBlocks(Messages, FHelikaSha256::InitialState, State);
+		uint8 Digest[DigestBytes];
+		FHelikaSha256::GetDigest(State, Digest);
+		FMemory::Memcpy(Key, Digest, DigestBytes);
+	}
+	else
+	{
+		FMemory::Memcpy(Key, Utf8.Get(), Utf8.Length());
+	}
+
+	uint8 Pads[2][BlockBytes];
+	for (int32 Byte = 0; Byte < BlockBytes; ++Byte)
+	{
+		Pads[0][Byte] = Key[Byte] ^ 0x36;
+		Pads[1][Byte] = Key[Byte] ^ 0x5c;
+	}
+	const FHelikaSha256Message KeyBlocks[] = {{Pads[0], 1}, {Pads[1], 1}};
+	uint32 KeyStates[16];
+	FHelikaSha256::HashBlocks(KeyBlocks, FHelikaSha256::InitialState, KeyStates);
+	FMemory::Memcpy(InnerState, KeyStates, sizeof(InnerState));
+	FMemory::Memcpy(OuterState, KeyStates + 8, sizeof(OuterState));
+}
+
+int32 FHelikaHasher::GetEncodedLength(EHelikaHashEncoding Encoding)
+{
+	return Encoding == EHelikaHashEncoding::HHE_Hex ? DigestBytes * 2 : (DigestBytes + 2) / 3 * 4;
+}
+
+void FHelikaHasher::HashBatch(TConstArrayView<FStringView> Values, EHelikaHashEncoding Encoding, TArrayView<ANSICHAR> Out)
+{
+	const int32 Length = GetEncodedLength(Encoding);
+	check(Out.Num() >= Values.Num() * Length);
+
+	uint8 Digests[ChunkValues * DigestBytes];
+	for (int32 First = 0; First < Values.Num(); First += ChunkValues)
+	{
+		const int32 Count = FMath::Min(ChunkValues, Values.Num() - First);
+		HashChunk(Values.Slice(First, Count), Digests);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			EncodeDigest(Digests + Index * DigestBytes, Encoding, Out.GetData() + (First + Index) * Length);
+		}
+	}
+}
+
+void FHelikaHasher::HashBatch(const TArray<FString>& Values, EHelikaHashEncoding Encoding, TArray<FString>& OutHashes)
+{
+	TArray<FStringView> Views;
+	Views.Reserve(Values.Num());
+	for (const FString& Value : Values)
+	{
+		Views.Add(Value);
+	}
+
+	const int32 Length = GetEncodedLength(Encoding);
+	TArray<ANSICHAR> Encoded;
+	Encoded.SetNumUninitialized(Values.Num() * Length);
+	HashBatch(Views, Encoding, Encoded);
+
+	OutHashes.Reset(Values.Num());
+	for (int32 Index = 0; Index < Values.Num(); ++Index)
+	{
+		OutHashes.Add(FString(Length, Encoded.GetData() + Index * Length));
+	}
+}
+
+FString FHelikaHasher::Hash(FStringView Value, EHelikaHashEncoding Encoding)
+{
+	ANSICHAR Encoded[DigestBytes * 2];
+	HashBatch(MakeArrayView(&Value, 1), Encoding, Encoded);
+	return FString(GetEncodedLength(Encoding), Encoded);
+}
+
+void FHelikaHasher::HashChunk(TConstArrayView<FStringView> Values, uint8* Digests)
+{
+	Padded.Reset();
+	Offsets.Reset();
+	Misses.Reset();
+	MissSlots.Reset();
+
+	// The inner message of HMAC follows the key block
+	const int64 PrefixBytes = bSalted ? BlockBytes : 0;
+	TArray<FHelikaSha256Message, TInlineAllocator<ChunkValues>> Messages;
+	for (int32 Index = 0; Index < Values.Num(); ++Index)
+	{
+		if (CacheCapacity > 0)
+		{
+			FString Value(Values[Index]);
+			if (FindCached(Value, Digests + Index * DigestBytes))
+			{
+				continue;
+			}
+			Misses.Add(MoveTemp(Value));
+		}
+
+		const FTCHARToUTF8 Utf8(Values[Index].GetData(), Values[Index].Len());
+		MissSlots.Add(Index);
+		Offsets.Add(Padded.Num());
+		Messages.Add({nullptr, FHelikaSha256::AppendPadded(Padded, TConstArrayView<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length()), PrefixBytes)});
+	}
+	if (Messages.Num() == 0)
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < Messages.Num(); ++Index)
+	{
+		Messages[Index].Blocks = Padded.GetData() + Offsets[Index];
+	}
+	States.SetNumUninitialized(Messages.Num() * 8);
+	FHelikaSha256::HashBlocks(Messages, bSalted ? InnerState : FHelikaSha256::InitialState, States.GetData());
+
+	if (bSalted)
+	{
+		// The outer message is the inner digest, a single block after the outer key block
+		Padded.Reset();
+		for (int32 Index = 0; Index < Messages.Num(); ++Index)
+		{
+			uint8 InnerDigest[DigestBytes];
+			FHelikaSha256::GetDigest(States.GetData() + Index * 8, InnerDigest);
+			FHelikaSha256::AppendPadded(Padded, InnerDigest, BlockBytes);
+		}
+		for (int32 Index = 0; Index < Messages.Num(); ++Index)
+		{
+			Messages[Index] = {Padded.GetData() + Index * BlockBytes, 1};
+		}
+		FHelikaSha256::HashBlocks(Messages, OuterState, States.GetData());
+	}
+
+	for (int32 Index = 0; Index < Messages.Num(); ++Index)
+	{
+		uint8 Digest[DigestBytes];
+		FHelikaSha256::GetDigest(States.GetData() + Index * 8, Digest);
+		FMemory::Memcpy(Digests + MissSlots[Index] * DigestBytes, Digest, DigestBytes);
+		if (CacheCapacity > 0)
+		{
+			AddCached(MoveTemp(Misses[Index]), Digest);
+		}
+	}
+}
+
+bool FHelikaHasher::FindCached(const FString& Value, uint8* OutDigest)
+{
+	const int32* Entry = CacheIndex.Find(Value);
+	if (Entry == nullptr)
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(OutDigest, CacheEntries[*Entry].Digest, DigestBytes);
+	Unlink(*Entry);
+	LinkFront(*Entry);
+	++CacheHits;
+	return true;
+}
+
+void FHelikaHasher::AddCached(FString&& Value, const uint8* Digest)
+{
+	// A value repeated within one chunk misses every time
+	if (CacheIndex.Contains(Value))
+	{
+		return;
+	}
+
+	int32 Entry;
+	if (CacheEntries.Num() < CacheCapacity)
+	{
+		Entry = CacheEntries.AddDefaulted();
+	}
+	else
+	{
+		Entry = Tail;
+		Unlink(Entry);
+		CacheIndex.Remove(CacheEntries[Entry].Value);
+	}
+
+	FCacheEntry& Cached = CacheEntries[Entry];
+	Cached.Value = MoveTemp(Value);
+	FMemory::Memcpy(Cached.Digest, Digest, DigestBytes);
+	CacheIndex.Add(Cached.Value, Entry);
+	LinkFront(Entry);
+}
+
+void FHelikaHasher::Unlink(int32 Entry)
+{
+	FCacheEntry& Cached = CacheEntries[Entry];
+	if (Cached.Prev != INDEX_NONE)
+	{
+		CacheEntries[Cached.Prev].Next = Cached.Next;
+	}
+	else
+	{
+		Head = Cached.Next;
+	}
+	if (Cached.Next != INDEX_NONE)
+	{
+		CacheEntries[Cached.Next].Prev = Cached.Prev;
+	}
+	else
+	{
+		Tail = Cached.Prev;
+	}
+	Cached.Prev = INDEX_NONE;
+	Cached.Next = INDEX_NONE;
+}
+
+void FHelikaHasher::LinkFront(int32 Entry)
+{
+	FCacheEntry& Cached = CacheEntries[Entry];
+	Cached.Next = Head;
+	if (Head != INDEX_NONE)
+	{
+		CacheEntries[Head].Prev = Entry;
+	}
+	Head = Entry;
+	if (Tail == INDEX_NONE)
+	{
+		Tail = Entry;
+	}
+}
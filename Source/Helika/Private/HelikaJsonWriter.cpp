@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaJsonWriter.h"
+
+#include "HelikaStringKernels.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+
+FHelikaJsonWriter::FHelikaJsonWriter(TArray<uint8>& InBuffer)
+	: Buffer(InBuffer), StartOffset(InBuffer.Num())
+{
+}
+
+void FHelikaJsonWriter::WriteObjectStart()
+{
+	WriteSeparator();
+	Buffer.Add('{');
+}
+
+void FHelikaJsonWriter::WriteObjectEnd()
+{
+	Buffer.Add('}');
+}
+
+void FHelikaJsonWriter::WriteArrayStart()
+{
+	WriteSeparator();
+	Buffer.Add('[');
+}
+
+void FHelikaJsonWriter::WriteArrayEnd()
+{
+	Buffer.Add(']');
+}
+
+void FHelikaJsonWriter::WriteKey(FStringView Key)
+{
+	WriteSeparator();
+	WriteEscapedString(Key);
+	Buffer.Add(':');
+}
+
+void FHelikaJsonWriter::WriteString(FStringView Value)
+{
+	WriteSeparator();
+	WriteEscapedString(Value);
+}
+
+void FHelikaJsonWriter::WriteNumber(double Value)
+{
+	WriteSeparator();
+	if (!FMath::IsFinite(Value))
+	{
+		// json has no representation for NaN/Inf
+		Buffer.Append(reinterpret_cast<const uint8*>("null"), 4);
+		return;
+	}
+
+	// Same precision as TJsonWriter, 17 significant digits round trips any double
+	ANSICHAR Digits[32];
+	const int32 Length = FCStringAnsi::Snprintf(Digits, UE_ARRAY_COUNT(Digits), "%.17g", Value);
+	Buffer.Append(reinterpret_cast<const uint8*>(Digits), FMath::Clamp(Length, 0, static_cast<int32>(UE_ARRAY_COUNT(Digits)) - 1));
+}
+
+void FHelikaJsonWriter::WriteBool(bool bValue)
+{
+	WriteSeparator();
+	if (bValue)
+	{
+		Buffer.Append(reinterpret_cast<const uint8*>("true"), 4);
+	}
+	else
+	{
+		Buffer.Append(reinterpret_cast<const uint8*>("false"), 5);
+	}
+}
+
+void FHelikaJsonWriter::WriteNull()
+{
+	WriteSeparator();
+	Buffer.Append(reinterpret_cast<const uint8*>("null"), 4);
+}
+
+void FHelikaJsonWriter::WriteRaw(TConstArrayView<uint8> Fragment)
+{
+	WriteSeparator();
+	Buffer.Append(Fragment.GetData(), Fragment.Num());
+}
+
+void FHelikaJsonWriter::WriteValue(const TSharedPtr<FJsonValue>& Value)
+{
+	if (!Value.IsValid())
+	{
+		WriteNull();
+		return;
+	}
+
+	switch (Value->Type)
+	{
+	case EJson::String:
+		WriteString(Value->AsString());
+		break;
+	case EJson::Number:
+		WriteNumber(Value->AsNumber());
+		break;
+	case EJson::Boolean:
+		WriteBool(Value->AsBool());
+		break;
+	case EJson::Array:
+		WriteArrayStart();
+		for (const TSharedPtr<FJsonValue>& Element : Value->AsArray())
+		{
+			WriteValue(Element);
+		}
+		WriteArrayEnd();
+		break;
+	case EJson::Object:
+		WriteObject(Value->AsObject());
+		break;
+	case EJson::None:
+	case EJson::Null:
+	default:
+		WriteNull();
+		break;
+	}
+}
+
+void FHelikaJsonWriter::WriteObject(const TSharedPtr<FJsonObject>& Object)
+{
+	if (!Object.IsValid())
+	{
+		WriteNull();
+		return;
+	}
+
+	WriteObjectStart();
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Object->Values)
+	{
+		WriteKey(Field.Key);
+		WriteValue(Field.Value);
+	}
+	WriteObjectEnd();
+}
+
+TArray<uint8> FHelikaJsonWriter::SerializeObject(const TSharedPtr<FJsonObject>& Object)
+{
+	TArray<uint8> Fragment;
+	FHelikaJsonWriter Writer(Fragment);
+	Writer.WriteObject(Object);
+	return Fragment;
+}
+
+FString FHelikaJsonWriter::ToString(TConstArrayView<uint8> Utf8)
+{
+	const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Utf8.GetData()), Utf8.Num());
+	return FString(Converter.Length(), Converter.Get());
+}
+
+void FHelikaJsonWriter::WriteSeparator()
+{
+	if (Buffer.Num() > StartOffset)
+	{
+		const uint8 Last = Buffer.Last();
+		if (Last != '{' && Last != '[' && Last != ':')
+		{
+			Buffer.Add(',');
+		}
+	}
+}
+
+void FHelikaJsonWriter::WriteEscapedString(FStringView Value)
+{
+	Buffer.Add('"');
+	FHelikaStringKernels::AppendEscapedUtf8(Buffer, Value);
+	Buffer.Add('"');
+}
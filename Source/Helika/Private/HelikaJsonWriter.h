@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+class FJsonValue;
+
+/**
+ * Minimal forward-only JSON writer that produces UTF-8 directly into a byte buffer.
+ *
+ * Unlike TJsonWriter it does not go through an intermediate FString, and it can splice
+ * already serialized fragments (see WriteRaw) which lets shared blocks be encoded once per batch.
+ */
+class FHelikaJsonWriter
+{
+public:
+	explicit FHelikaJsonWriter(TArray<uint8>& InBuffer);
+
+	void WriteObjectStart();
+	void WriteObjectEnd();
+	void WriteArrayStart();
+	void WriteArrayEnd();
+
+	/// Writes the identifier of the next object field, the value must follow
+	void WriteKey(FStringView Key);
+
+	void WriteString(FStringView Value);
+	void WriteNumber(double Value);
+	void WriteBool(bool bValue);
+	void WriteNull();
+
+	/// Splices an already serialized JSON value as is
+	void WriteRaw(TConstArrayView<uint8> Fragment);
+
+	void WriteValue(const TSharedPtr<FJsonValue>& Value);
+	void WriteObject(const TSharedPtr<FJsonObject>& Object);
+
+	void WriteStringField(FStringView Key, FStringView Value) { WriteKey(Key); WriteString(Value); }
+	void WriteBoolField(FStringView Key, bool bValue) { WriteKey(Key); WriteBool(bValue); }
+
+	/// Number of bytes written by this writer so far
+	int64 GetNumBytesWritten() const { return Buffer.Num() - StartOffset; }
+
+	/// Encodes a single json object to a standalone UTF-8 fragment
+	static TArray<uint8> SerializeObject(const TSharedPtr<FJsonObject>& Object);
+
+	/// Converts a UTF-8 payload back to FString, mainly for logging
+	static FString ToString(TConstArrayView<uint8> Utf8);
+
+private:
+	void WriteSeparator();
+	void WriteEscapedString(FStringView Value);
+
+	TArray<uint8>& Buffer;
+	int32 StartOffset;
+};
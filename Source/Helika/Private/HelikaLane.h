@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaEventQueue.h"
+#include "HelikaTypes.h"
+#include <atomic>
+
+/**
+ * Upload lane of one EHelikaPriority. Each lane has its own queue, flush schedule and backoff,
+ * so a throttled or backed off lane never delays the others.
+ */
+class FHelikaLane
+{
+public:
+	explicit FHelikaLane(EHelikaPriority InPriority)
+		: Priority(InPriority)
+	{
+	}
+
+	EHelikaPriority GetPriority() const { return Priority; }
+
+	FHelikaEventQueue& GetQueue() { return Queue; }
+	const FHelikaEventQueue& GetQueue() const { return Queue; }
+
+	/// FPlatformTime::Seconds before which the lane does not upload on its own
+	double GetBackoffUntil() const { return BackoffUntil.load(std::memory_order_relaxed); }
+	bool IsBackingOff(double Now) const { return Now < GetBackoffUntil(); }
+
+	int32 GetConsecutiveFailures() const { return ConsecutiveFailures.load(std::memory_order_relaxed); }
+
+	/**
+	 * Called from the acknowledgement of every upload of the lane. A transient failure of the whole
+	 * batch doubles the pause up to MaxBackoffSeconds, RetryAfterSeconds (when the collector sent one) replaces it within the same cap.
+	 */
+	void RecordUploadResult(bool bTransientFailure, int32 RetryAfterSeconds, float MaxBackoffSeconds)
+	{
+		if (!bTransientFailure)
+		{
+			ConsecutiveFailures.store(0, std::memory_order_relaxed);
+			BackoffUntil.store(0.0, std::memory_order_relaxed);
+			return;
+		}
+
+		const int32 Failures = ConsecutiveFailures.fetch_add(1, std::memory_order_relaxed) + 1;
+		const double Delay = RetryAfterSeconds > 0
+			? FMath::Min<double>(MaxBackoffSeconds, RetryAfterSeconds)
+			: FMath::Min<double>(MaxBackoffSeconds, FMath::Pow(2.0, FMath::Min(Failures - 1, 16)));
+		BackoffUntil.store(FPlatformTime::Seconds() + Delay, std::memory_order_relaxed);
+	}
+
+	/// Game thread only, FPlatformTime::Seconds of the next scheduled flush
+	double NextFlushTime = 0.0;
+
+	/// A flush of the lane is waiting in the scheduler
+	std::atomic<bool> bFlushScheduled{false};
+
+private:
+	const EHelikaPriority Priority;
+	FHelikaEventQueue Queue;
+
+	std::atomic<double> BackoffUntil{0.0};
+	std::atomic<int32> ConsecutiveFailures{0};
+};
+
+typedef TSharedPtr<FHelikaLane, ESPMode::ThreadSafe> FHelikaLanePtr;
@@ -1,572 +1,1774 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-
-#include "HelikaManager.h"
-
-#include "HelikaDefines.h"
-#include "HelikaJsonLibrary.h"
-#include "HelikaLibrary.h"
-#include "HelikaSettings.h"
-#include "HttpModule.h"
-#include "Interfaces/IHttpRequest.h"
-#include "Interfaces/IHttpResponse.h"
-
-#if WITH_EDITOR
-#include "Editor.h"
-#endif
-
-UHelikaManager* UHelikaManager::Instance = nullptr;
-
-void UHelikaManager::InitializeSDK()
-{
-	if (bIsInitialized)
-	{
-		UE_LOG(LogHelika, Log, TEXT("HelikaActor is already initialized"));
-		return;
-	}
-
-	if (UHelikaLibrary::GetHelikaSettings()->HelikaAPIKey.IsEmpty() || UHelikaLibrary::GetHelikaSettings()->HelikaAPIKey.TrimStartAndEnd().IsEmpty())
-	{
-		UE_LOG(LogHelika, Error, TEXT("Helika API Key is empty. Please add the API key to editor settings"));
-		return;
-	}
-
-	if (UHelikaLibrary::GetHelikaSettings()->GameId.IsEmpty() || UHelikaLibrary::GetHelikaSettings()->GameId.TrimStartAndEnd().IsEmpty())
-	{
-		UE_LOG(LogHelika, Error, TEXT("Game ID is empty. Please add the API key to editor settings"));
-		return;
-	}
-
-	BaseUrl = UHelikaLibrary::ConvertUrl(UHelikaLibrary::GetHelikaSettings()->HelikaEnvironment);
-	SessionId = UHelikaLibrary::CreateNewGuid();
-	bIsInitialized = true;
-
-	AnonymousId = GenerateAnonymousId(SessionId, true);
-
-	if (!UserDetails->HasField(TEXT("user_id")))
-	{
-		UserDetails->SetStringField("user_id", AnonymousId);
-	}
-
-	// If Localhost is set, force print events
-	Telemetry = UHelikaLibrary::GetHelikaSettings()->HelikaEnvironment != EHelikaEnvironment::HE_Localhost ? UHelikaLibrary::GetHelikaSettings()->Telemetry : ETelemetryLevel::TL_None;
-
-	if (Telemetry > ETelemetryLevel::TL_TelemetryOnly)
-	{
-		bPiiTracking = true;
-	}
-
-	CreateSession();
-
-#if WITH_EDITOR
-	FEditorDelegates::EndPIE.AddStatic(&EndSession);
-#endif
-}
-
-void UHelikaManager::DeinitializeSDK()
-{
-	BaseUrl = "";
-	SessionId = "";
-	Telemetry = ETelemetryLevel::TL_None;
-	bIsInitialized = false;
-}
-
-void UHelikaManager::SendEvent(const FHelikaJsonObject& EventProps)
-{
-	SendEvent(EventProps.Object);
-}
-
-void UHelikaManager::SendEvents(TArray<FHelikaJsonObject> EventProps)
-{
-	TArray<TSharedPtr<FJsonObject>> JsonArray;
-	for (auto EventProp : EventProps)
-	{
-		JsonArray.Add(EventProp.Object);
-	}
-
-	SendEvents(JsonArray);
-}
-
-void UHelikaManager::SendUserEvent(const FHelikaJsonObject& EventProps)
-{
-	SendUserEvent(EventProps.Object);
-}
-
-void UHelikaManager::SendUserEvents(TArray<FHelikaJsonObject> EventProps)
-{
-	TArray<TSharedPtr<FJsonObject>> JsonArray;
-	for (auto EventProp : EventProps)
-	{
-		JsonArray.Add(EventProp.Object);
-	}
-
-	SendUserEvents(JsonArray);
-}
-
-bool UHelikaManager::SendEvent(TSharedPtr<FJsonObject> EventProps)
-{
-	if (!bIsInitialized)
-	{
-		UE_LOG(LogHelika, Error, TEXT("Helika Subsystem is not yet initialized"));
-		return false;
-	}
-
-	if (!EventProps.IsValid())
-	{
-		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be null"));
-		return false;
-	}
-
-	// adding unique id to event
-	const TSharedPtr<FJsonObject> FinalEvent = MakeShareable(new FJsonObject());
-	FinalEvent->SetStringField("id", FGuid::NewGuid().ToString());
-
-	TArray<TSharedPtr<FJsonValue>> EventArrayJsonObject;
-	const TSharedPtr<FJsonValueObject> JsonValueObject = MakeShareable(new FJsonValueObject(AppendAttributesToJsonObject(EventProps, false)));
-	EventArrayJsonObject.Add(JsonValueObject);
-	FinalEvent->SetArrayField("events", EventArrayJsonObject);
-
-	// converting Json object to string
-	FString JsonString;
-	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
-	if (!FJsonSerializer::Serialize(FinalEvent.ToSharedRef(), Writer))
-	{
-		UE_LOG(LogHelika, Error, TEXT("Failed to serialize event data to JSON"));
-		return false;
-	}
-
-	// send event to helika API
-	SendHTTPPost("/events/", JsonString);
-	return true;
-}
-
-bool UHelikaManager::SendEvents(TArray<TSharedPtr<FJsonObject>> EventProps)
-{
-	if (!bIsInitialized)
-	{
-		UE_LOG(LogHelika, Warning, TEXT("Helika Subsystem is not yet initialized"));
-		return false;
-	}
-
-	if (EventProps.IsEmpty())
-	{
-		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be empty"));
-		return false;
-	}
-
-	const TSharedPtr<FJsonObject> FinalEvent = MakeShareable(new FJsonObject());
-	FinalEvent->SetStringField("id", FGuid::NewGuid().ToString());
-
-	TArray<TSharedPtr<FJsonValue>> EventArrayJsonObject;
-	for (auto EventProp : EventProps)
-	{
-		if (!EventProp.IsValid())
-		{
-			UE_LOG(LogHelika, Error, TEXT("'Event Props' contains invalid/null object"));
-			return false;
-		}
-		const TSharedPtr<FJsonValueObject> JsonValueObject = MakeShareable(new FJsonValueObject(AppendAttributesToJsonObject(EventProp, false)));
-		EventArrayJsonObject.Add(JsonValueObject);
-	}
-	FinalEvent->SetArrayField("events", EventArrayJsonObject);
-
-	// converting Json object to string
-	FString JsonString;
-	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
-	if (!FJsonSerializer::Serialize(FinalEvent.ToSharedRef(), Writer))
-	{
-		UE_LOG(LogHelika, Error, TEXT("Failed to serialize event data to JSON"));
-		return false;
-	}
-
-	// send event to helika API
-	SendHTTPPost("/events/", JsonString);
-
-	return true;
-}
-
-
-bool UHelikaManager::SendUserEvent(TSharedPtr<FJsonObject> EventProps)
-{
-	if (!bIsInitialized)
-	{
-		UE_LOG(LogHelika, Log, TEXT("Helika Subsystem is not yet initialized"));
-		return false;
-	}
-
-	if (!EventProps.IsValid())
-	{
-		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be null"));
-		return false;
-	}
-
-	// adding unique id to event
-	const TSharedPtr<FJsonObject> FinalEvent = MakeShareable(new FJsonObject());
-	FinalEvent->SetStringField("id", FGuid::NewGuid().ToString());
-
-	TArray<TSharedPtr<FJsonValue>> EventArrayJsonObject;
-	const TSharedPtr<FJsonValueObject> JsonValueObject = MakeShareable(new FJsonValueObject(AppendAttributesToJsonObject(EventProps, true)));
-	EventArrayJsonObject.Add(JsonValueObject);
-	FinalEvent->SetArrayField("events", EventArrayJsonObject);
-
-	// converting Json object to string
-	FString JsonString;
-	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
-	if (!FJsonSerializer::Serialize(FinalEvent.ToSharedRef(), Writer))
-	{
-		UE_LOG(LogHelika, Error, TEXT("Failed to serialize event data to JSON"));
-		return false;
-	}
-
-	// send event to helika API
-	SendHTTPPost("/events/", JsonString);
-	return true;
-}
-
-bool UHelikaManager::SendUserEvents(TArray<TSharedPtr<FJsonObject>> EventProps)
-{
-	if (!bIsInitialized)
-	{
-		UE_LOG(LogHelika, Log, TEXT("Helika Subsystem is not yet initialized"));
-		return false;
-	}
-
-	if (EventProps.IsEmpty())
-	{
-		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be empty"));
-		return false;
-	}
-
-	const TSharedPtr<FJsonObject> FinalEvent = MakeShareable(new FJsonObject());
-	FinalEvent->SetStringField("id", FGuid::NewGuid().ToString());
-
-	TArray<TSharedPtr<FJsonValue>> EventArrayJsonObject;
-	for (auto EventProp : EventProps)
-	{
-		if (!EventProp.IsValid())
-		{
-			UE_LOG(LogHelika, Error, TEXT("'Event Props' contains invalid/null object"));
-			return false;
-		}
-		const TSharedPtr<FJsonValueObject> JsonValueObject = MakeShareable(new FJsonValueObject(AppendAttributesToJsonObject(EventProp, true)));
-		EventArrayJsonObject.Add(JsonValueObject);
-	}
-	FinalEvent->SetArrayField("events", EventArrayJsonObject);
-
-	// converting Json object to string
-	FString JsonString;
-	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
-	if (!FJsonSerializer::Serialize(FinalEvent.ToSharedRef(), Writer))
-	{
-		UE_LOG(LogHelika, Error, TEXT("Failed to serialize event data to JSON"));
-		return false;
-	}
-
-	// send event to helika API
-	SendHTTPPost("/events/", JsonString);
-
-	return true;
-}
-
-void UHelikaManager::SetPrintToConsole(bool bInPrintEventsToConsole)
-{
-	UHelikaLibrary::GetHelikaSettings()->bPrintEventsToConsole = bInPrintEventsToConsole;
-}
-
-bool UHelikaManager::IsSDKInitialized()
-{
-	return bIsInitialized;
-}
-
-FString UHelikaManager::GetSessionId() const
-{
-	return SessionId;
-}
-
-TSharedPtr<FJsonObject> UHelikaManager::AppendAttributesToJsonObject(TSharedPtr<FJsonObject> JsonObject, bool bIsUserEvent)
-{
-	// Add game_id only if the event doesn't already have it
-	UHelikaLibrary::AddOrReplace(JsonObject, "game_id", UHelikaLibrary::GetHelikaSettings()->GameId);
-
-	// Convert to ISO 8601 format string using "o" specifier
-	UHelikaLibrary::AddOrReplace(JsonObject, "created_at", FDateTime::UtcNow().ToIso8601());
-
-	if (!JsonObject->HasField(TEXT("event_type")) || JsonObject->GetStringField(TEXT("event_type")).IsEmpty() || JsonObject->GetStringField(TEXT("event_type")).TrimStartAndEnd().IsEmpty())
-	{
-		UE_LOG(LogHelika, Error, TEXT("Invalid Event: Missing 'event_type' field"));
-	}
-
-	if (!JsonObject->HasField(TEXT("event")))
-	{
-		UE_LOG(LogHelika, Error, TEXT("Invalid Event: 'event' field does not have any event info"));
-	}
-
-	if (JsonObject->GetObjectField(TEXT("event")) == nullptr)
-	{
-		UE_LOG(LogHelika, Error, TEXT("Invalid Event: 'event' field must be of type [JsonObject]"));
-	}
-
-	if (!JsonObject->GetObjectField(TEXT("event"))->HasField(TEXT("event_sub_type")) || JsonObject->GetObjectField(TEXT("event"))->GetStringField(TEXT("event_sub_type")).IsEmpty() || JsonObject->GetObjectField(TEXT("event"))->GetStringField(TEXT("event_sub_type")).TrimStartAndEnd().IsEmpty())
-	{
-		UE_LOG(LogHelika, Error, TEXT("Invalid Event: Missing 'event_sub_type' field"));
-	}
-
-	const TSharedPtr<FJsonObject> InternalEvent = JsonObject->GetObjectField(TEXT("event"));
-	UHelikaLibrary::AddOrReplace(InternalEvent, "session_id", GetSessionId());
-
-	UHelikaLibrary::AddOrReplace(InternalEvent, "user_id", bIsUserEvent ? UserDetails->GetStringField(TEXT("user_id")) : AnonymousId);
-
-	AppendHelikaData(InternalEvent);
-	AppendAppDetails(InternalEvent);
-
-	if (bIsUserEvent)
-	{
-		AppendUserDetails(InternalEvent);
-	}
-
-	return JsonObject;
-}
-
-void UHelikaManager::CreateSession()
-{
-	TSharedPtr<FJsonObject> CreateSessionEvent = GetTemplateEvent("session_created", "session_created");
-	TSharedPtr<FJsonObject> InternalEvent = CreateSessionEvent->GetObjectField(TEXT("event"));
-	AppendHelikaData(InternalEvent);
-	AppendUserDetails(InternalEvent);
-	AppendAppDetails(InternalEvent);
-	if (bPiiTracking)
-	{
-		AppendPIITracking(InternalEvent);
-	}
-
-	const TSharedPtr<FJsonObject> Event = MakeShareable(new FJsonObject());
-	Event->SetStringField("id", FGuid::NewGuid().ToString());
-	TArray<TSharedPtr<FJsonValue>> EventArrayJsonObject;
-	const TSharedPtr<FJsonValueObject> JsonValueObject = MakeShareable(new FJsonValueObject(CreateSessionEvent));
-	EventArrayJsonObject.Add(JsonValueObject);
-	Event->SetArrayField("events", EventArrayJsonObject);
-
-	FString JSONPayload;
-	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JSONPayload);
-	if (!FJsonSerializer::Serialize(Event.ToSharedRef(), Writer))
-	{
-		UE_LOG(LogHelika, Error, TEXT("Failed to serialize event data to JSON"));
-		return;
-	}
-
-	SendHTTPPost("/events/", JSONPayload);
-}
-
-void UHelikaManager::SendHTTPPost(const FString& Url, const FString& Data) const
-{
-	if (UHelikaLibrary::GetHelikaSettings()->bPrintEventsToConsole)
-	{
-		FString Message = FString::Printf(TEXT("[Helika] Event Sent: %s\nEvent:\n%s"), Telemetry > ETelemetryLevel::TL_None ? TEXT("Sent") : TEXT("Print Only"), *Data);
-		UE_LOG(LogHelika, Display, TEXT("%s"), *Message);
-
-	}
-	if (Telemetry > ETelemetryLevel::TL_None)
-	{
-		const FString URIBase = BaseUrl + Url;
-		FHttpModule& HTTPModule = FHttpModule::Get();
-		const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> PRequest = HTTPModule.CreateRequest();
-
-		PRequest->SetVerb(TEXT("POST"));
-		PRequest->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-		PRequest->SetHeader(TEXT("x-api-key"), UHelikaLibrary::GetHelikaSettings()->HelikaAPIKey);
-
-		const FString RequestContent = Data;
-		PRequest->SetContentAsString(RequestContent);
-		PRequest->SetURL(URIBase);
-		PRequest->OnProcessRequestComplete().BindLambda(
-			[&](
-			const FHttpRequestPtr& Request,
-			const FHttpResponsePtr& Response,
-			const bool bConnectedSuccessfully) mutable
-			{
-				if (bConnectedSuccessfully)
-				{
-					ProcessEventTrackResponse(Response->GetContentAsString());
-				}
-				else
-				{
-					UE_LOG(LogHelika, Error, TEXT("Request failed..! due to %d"), static_cast<int32>(Request->GetStatus()));
-
-				}
-			});
-
-		PRequest->ProcessRequest();
-	}
-}
-
-void UHelikaManager::ProcessEventTrackResponse(const FString& Data)
-{
-	UE_LOG(LogHelika, Display, TEXT("Helika Server Responce : %s"), *Data);
-}
-
-void UHelikaManager::EndSession(bool bIsSimulating)
-{
-	Get()->DeinitializeSDK();
-}
-
-FString UHelikaManager::GenerateAnonymousId(FString Seed, bool bCreateNewAnonId)
-{
-	if (bCreateNewAnonId)
-	{
-		return "anon_" + UHelikaLibrary::ComputeSha256Hash(Seed);
-	}
-	return AnonymousId;
-}
-
-TSharedPtr<FJsonObject> UHelikaManager::GetTemplateEvent(const FString& EventType, const FString& EventSubType) const
-{
-	TSharedPtr<FJsonObject> TemplateEvent = MakeShareable(new FJsonObject());
-	TemplateEvent->SetStringField("created_at", FDateTime::UtcNow().ToIso8601());
-	TemplateEvent->SetStringField("game_id", UHelikaLibrary::GetHelikaSettings()->GameId);
-	TemplateEvent->SetStringField("event_type", EventType);
-
-	TSharedPtr<FJsonObject> TemplateSubEvent = MakeShareable(new FJsonObject());
-	TemplateSubEvent->SetStringField("user_id", UserDetails->GetStringField(TEXT("user_id")));
-	TemplateSubEvent->SetStringField("session_id", GetSessionId());
-	TemplateSubEvent->SetStringField("event_sub_type", EventSubType);
-	TemplateSubEvent->SetObjectField("event_detail", MakeShareable(new FJsonObject()));
-
-	TemplateEvent->SetObjectField("event", TemplateSubEvent);
-
-	return TemplateEvent;
-}
-
-void UHelikaManager::AppendHelikaData(const TSharedPtr<FJsonObject>& GameEvent) const
-{
-	const TSharedPtr<FJsonObject> HelikaData = MakeShareable(new FJsonObject());
-
-	HelikaData->SetStringField("anon_id", AnonymousId);
-	HelikaData->SetStringField("taxonomy_ver", "v2");
-	HelikaData->SetStringField("sdk_name", UHelikaLibrary::GetHelikaSettings()->SDKName);
-	HelikaData->SetStringField("sdk_version", UHelikaLibrary::GetHelikaSettings()->SDKVersion);
-	HelikaData->SetStringField("sdk_class", UHelikaLibrary::GetHelikaSettings()->SDKClass);
-	HelikaData->SetStringField("sdk_platform", UHelikaLibrary::GetPlatformName());
-	HelikaData->SetStringField("event_source", "client");
-	HelikaData->SetBoolField("pii_tracking", bPiiTracking);
-
-	UHelikaLibrary::AddIfNull(GameEvent, "helika_data", MakeShareable(new FJsonObject()));
-	UHelikaJsonLibrary::MergeJObjects(GameEvent->GetObjectField(TEXT("helika_data")), HelikaData);
-}
-
-void UHelikaManager::AppendUserDetails(const TSharedPtr<FJsonObject>& GameEvent) const
-{
-	UHelikaLibrary::AddIfNull(GameEvent, "user_details", MakeShareable(new FJsonObject()));
-	UHelikaJsonLibrary::MergeJObjects(GameEvent->GetObjectField(TEXT("user_details")), UserDetails);
-}
-
-void UHelikaManager::AppendAppDetails(const TSharedPtr<FJsonObject>& GameEvent) const
-{
-	UHelikaLibrary::AddIfNull(GameEvent, "app_details", MakeShareable(new FJsonObject()));
-	UHelikaJsonLibrary::MergeJObjects(GameEvent->GetObjectField(TEXT("app_details")), AppDetails);
-}
-
-void UHelikaManager::AppendPIITracking(const TSharedPtr<FJsonObject>& GameEvent)
-{
-	const TSharedPtr<FJsonObject> PiiData = MakeShareable(new FJsonObject());
-
-	PiiData->SetStringField("os", UHelikaLibrary::GetOSVersion());
-	PiiData->SetStringField("os_family", UHelikaLibrary::GetPlatformName());
-	PiiData->SetStringField("device_model", FPlatformMisc::GetDeviceMakeAndModel());
-	PiiData->SetStringField("device_name", FPlatformProcess::ComputerName());
-	PiiData->SetStringField("device_type", UHelikaLibrary::GetDeviceType());
-	PiiData->SetStringField("device_ue_unique_identifier", UHelikaLibrary::GetDeviceUniqueIdentifier());
-	PiiData->SetStringField("device_processor_type", UHelikaLibrary::GetDeviceProcessor());
-
-	UHelikaLibrary::AddIfNull(GameEvent, "helika_data", MakeShareable(new FJsonObject()));
-	UHelikaLibrary::AddOrReplace(GameEvent->GetObjectField(TEXT("helika_data")), "additional_user_info", PiiData);
-}
-
-TSharedPtr<FJsonObject> UHelikaManager::GetUserDetails()
-{
-	return UserDetails;
-}
-
-void UHelikaManager::SetUserDetails(TSharedPtr<FJsonObject> InUserDetails, bool bCreateNewAnonId)
-{
-	if (!InUserDetails->HasField(TEXT("user_id")) || InUserDetails->GetStringField(TEXT("user_id")).IsEmpty())
-	{
-		AnonymousId = GenerateAnonymousId(FGuid::NewGuid().ToString(), bCreateNewAnonId);
-		InUserDetails = MakeShareable(new FJsonObject());
-		InUserDetails->SetStringField("user_id", AnonymousId);
-		InUserDetails->SetObjectField("email", nullptr);
-		InUserDetails->SetObjectField("wallet", nullptr);
-	}
-	UserDetails = InUserDetails;
-}
-
-FHelikaJsonObject UHelikaManager::GetUserDetailsAsJson()
-{
-	FHelikaJsonObject UserDetailsJsonObject;
-	UserDetailsJsonObject.Object = GetUserDetails();
-	return UserDetailsJsonObject;
-}
-
-void UHelikaManager::SetUserDetails(const FHelikaJsonObject& InUserDetails, bool bCreateNewAnonId)
-{
-	SetUserDetails(InUserDetails.Object, bCreateNewAnonId);
-}
-
-TSharedPtr<FJsonObject> UHelikaManager::GetAppDetails()
-{
-	return AppDetails;
-}
-
-void UHelikaManager::SetAppDetails(const TSharedPtr<FJsonObject>& InAppDetails)
-{
-	AppDetails = InAppDetails;
-}
-
-FHelikaJsonObject UHelikaManager::GetAppDetailsAsJson()
-{
-	FHelikaJsonObject AppDetailsJsonObject;
-	AppDetailsJsonObject.Object = GetAppDetails();
-	return AppDetailsJsonObject;
-}
-
-void UHelikaManager::SetAppDetails(const FHelikaJsonObject& InAppDetails)
-{
-	SetAppDetails(InAppDetails.Object);
-}
-
-bool UHelikaManager::GetPIITracking() const
-{
-	return bPiiTracking;
-}
-
-void UHelikaManager::SetPIITracking(bool bInPiiTracking, bool bSendPiiTrackingEvent)
-{
-	bPiiTracking = bInPiiTracking;
-
-	if (bIsInitialized && bPiiTracking && bSendPiiTrackingEvent)
-	{
-		TSharedPtr<FJsonObject> CreateSessionEvent = GetTemplateEvent("session_created", "session_data_updated");
-		TSharedPtr<FJsonObject> InnerEvent = CreateSessionEvent->GetObjectField(TEXT("event"));
-		UHelikaLibrary::AddIfNull(InnerEvent, "type", "Session Data Refresh");
-		AppendHelikaData(InnerEvent);
-		AppendUserDetails(InnerEvent);
-		AppendAppDetails(InnerEvent);
-		AppendPIITracking(InnerEvent);
-
-		const TSharedPtr<FJsonObject> Event = MakeShareable(new FJsonObject());
-		Event->SetStringField("id", FGuid::NewGuid().ToString());
-		TArray<TSharedPtr<FJsonValue>> EventArrayJsonObject;
-		const TSharedPtr<FJsonValueObject> JsonValueObject = MakeShareable(new FJsonValueObject(CreateSessionEvent));
-		EventArrayJsonObject.Add(JsonValueObject);
-		Event->SetArrayField("events", EventArrayJsonObject);
-
-		FString JSONPayload;
-		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JSONPayload);
-		if (!FJsonSerializer::Serialize(Event.ToSharedRef(), Writer))
-		{
-			UE_LOG(LogHelika, Error, TEXT("Unable to serialize Session event object..!"));
-			return;
-		}
-
-		SendHTTPPost("/events/", JSONPayload);
-	}
-}
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaManager.h"
+
+#include "HelikaAcknowledgement.h"
+#include "HelikaBatchSerializer.h"
+#include "HelikaClock.h"
+#include "HelikaColumnarBatch.h"
+#include "HelikaConfigSnapshot.h"
+#include "HelikaConnectivity.h"
+#include "HelikaDebugSink.h"
+#include "HelikaDefines.h"
+#include "HelikaDelivery.h"
+#include "HelikaEventRecorder.h"
+#include "HelikaEventTemplate.h"
+#include "HelikaGameMetrics.h"
+#include "HelikaJsonLibrary.h"
+#include "HelikaLane.h"
+#include "HelikaLibrary.h"
+#include "HelikaMemoryCounters.h"
+#include "HelikaMetricsCounters.h"
+#include "HelikaScheduler.h"
+#include "HelikaSettings.h"
+#include "HelikaSpillStore.h"
+#include "HelikaTrace.h"
+#include "HelikaTransport.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTLS.h"
+#include "Interfaces/IHttpResponse.h"
+#include "JsonObjectConverter.h"
+#include "Misc/App.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#endif
+
+UHelikaManager* UHelikaManager::Instance = nullptr;
+
+namespace
+{
+	int64 EstimateContextBytes(const FHelikaContextData& Context)
+	{
+		return sizeof(FHelikaContextData) + Context.SessionId.GetAllocatedSize() + Context.AnonymousId.GetAllocatedSize()
+			+ FHelikaMemoryCounters::EstimateJsonBytes(Context.UserDetails) + FHelikaMemoryCounters::EstimateJsonBytes(Context.MatchMetadata);
+	}
+
+	/// Accounting of one request body, released by FinishUpload
+	struct FHelikaUploadBody
+	{
+		double StartTime = 0.0;
+		int64 Size = 0;
+		int64 AllocatedSize = 0;
+	};
+
+	FHelikaTransportRequest CreateUploadRequest(const FHelikaConfigSnapshot& Snapshot, const FString& Url, TArray<uint8>&& Payload, FHelikaUploadBody& OutBody)
+	{
+		HELIKA_TRACE_SCOPE("HttpSubmit");
+		HELIKA_LLM_SCOPE(HttpBodies);
+
+		FHelikaTransportRequest PRequest;
+		PRequest.Verb = TEXT("POST");
+		PRequest.AddHeader(TEXT("Content-Type"), TEXT("application/json"));
+		PRequest.AddHeader(TEXT("x-api-key"), Snapshot.HelikaAPIKey);
+
+		const int64 UncompressedSize = Payload.Num();
+		FHelikaMetricsCounters::Add(EHelikaCounter::BytesBeforeCompression, UncompressedSize);
+
+		// Batch budgets stay in row bytes, so the compression ratio below includes what the columns saved
+		TArray<uint8> Columnar;
+		if (Snapshot.bColumnarPayloads && FHelikaColumnarBatch::Encode(Payload, Columnar) && Columnar.Num() < Payload.Num())
+		{
+			PRequest.AddHeader(TEXT("x-helika-batch-format"), FHelikaColumnarBatch::GetFormatName());
+			Payload = MoveTemp(Columnar);
+		}
+
+		if (Snapshot.bCompressPayloads && UHelikaLibrary::GzipCompress(Payload))
+		{
+			PRequest.AddHeader(TEXT("Content-Encoding"), TEXT("gzip"));
+			FHelikaBatchSerializer::RecordCompression(UncompressedSize, Payload.Num());
+			UE_CLOG(Payload.Num() > Snapshot.BatchLimits.MaxCompressedBatchBytes, LogHelika, Verbose, TEXT("Compressed batch of %d bytes is over MaxCompressedBatchKilobytes, the estimate adapts"), Payload.Num());
+		}
+
+		OutBody.StartTime = FPlatformTime::Seconds();
+		OutBody.Size = Payload.Num();
+		OutBody.AllocatedSize = Payload.GetAllocatedSize();
+		FHelikaMetricsCounters::Add(EHelikaCounter::BytesAfterCompression, OutBody.Size);
+		FHelikaMetricsCounters::Add(EHelikaCounter::BytesInFlight, OutBody.Size);
+		FHelikaMemoryCounters::Add(EHelikaMemoryTag::HttpBodies, OutBody.AllocatedSize);
+		FHelikaMetricsCounters::Add(EHelikaCounter::RequestsSent);
+
+		PRequest.Body = MoveTemp(Payload);
+		PRequest.Url = Snapshot.BaseUrl + Url;
+		return PRequest;
+	}
+
+	void FinishUpload(const FHelikaUploadBody& Body, const FHelikaTransportResponse& Response)
+	{
+		FHelikaMetricsCounters::RecordRequestLatency(FPlatformTime::Seconds() - Body.StartTime);
+		FHelikaMetricsCounters::Add(EHelikaCounter::BytesInFlight, -Body.Size);
+		FHelikaMemoryCounters::Add(EHelikaMemoryTag::HttpBodies, -Body.AllocatedSize);
+
+		const bool bAccepted = Response.bConnected && EHttpResponseCodes::IsOk(Response.Status);
+		FHelikaMetricsCounters::Add(bAccepted ? EHelikaCounter::RequestsSucceeded : EHelikaCounter::RequestsFailed);
+
+		if (!Response.bConnected)
+		{
+			UE_LOG(LogHelika, Error, TEXT("Request failed..! due to %s"), *Response.Error);
+		}
+	}
+
+	/// Events enriched by one task of EnrichEvents
+	constexpr int32 EnrichChunkEvents = 128;
+
+}
+
+void UHelikaManager::BeginDestroy()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(FlushTickerHandle);
+	FlushTickerHandle.Reset();
+	FTSTicker::GetCoreTicker().RemoveTicker(SchedulerTickerHandle);
+	SchedulerTickerHandle.Reset();
+
+	FHelikaMemoryCounters::Add(EHelikaMemoryTag::Contexts, -ContextsMemoryBytes - ConfigMemoryBytes - EventTemplatesMemoryBytes);
+	ContextsMemoryBytes = 0;
+	EventTemplatesMemoryBytes = 0;
+	ConfigMemoryBytes = 0;
+
+	Super::BeginDestroy();
+}
+
+void UHelikaManager::InitializeSDK()
+{
+	FHelikaGameThreadScope GameThreadScope;
+	LLM_SCOPE_BYTAG(Helika);
+
+	if (bIsInitialized)
+	{
+		UE_LOG(LogHelika, Log, TEXT("HelikaActor is already initialized"));
+		return;
+	}
+
+	if (UHelikaLibrary::GetHelikaSettings()->HelikaAPIKey.IsEmpty() || UHelikaLibrary::GetHelikaSettings()->HelikaAPIKey.TrimStartAndEnd().IsEmpty())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika API Key is empty. Please add the API key to editor settings"));
+		return;
+	}
+
+	if (UHelikaLibrary::GetHelikaSettings()->GameId.IsEmpty() || UHelikaLibrary::GetHelikaSettings()->GameId.TrimStartAndEnd().IsEmpty())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Game ID is empty. Please add the API key to editor settings"));
+		return;
+	}
+
+	SessionId = UHelikaLibrary::CreateNewGuid();
+	bIsInitialized = true;
+
+	if (!Scheduler.IsValid())
+	{
+		Scheduler = MakeShared<FHelikaScheduler, ESPMode::ThreadSafe>();
+	}
+
+	AnonymousId = GenerateAnonymousId(SessionId, true);
+
+	if (!UserDetails->HasField(TEXT("user_id")))
+	{
+		UserDetails->SetStringField("user_id", AnonymousId);
+	}
+
+	// Telemetry is forced to None on Localhost, see FHelikaConfigSnapshot::CaptureSettings
+	PublishConfig();
+
+	if (Config.Get()->Telemetry > ETelemetryLevel::TL_TelemetryOnly)
+	{
+		SetPIITracking(true);
+	}
+
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(Lanes); ++Index)
+	{
+		if (!Lanes[Index].IsValid())
+		{
+			Lanes[Index] = MakeShared<FHelikaLane, ESPMode::ThreadSafe>(static_cast<EHelikaPriority>(Index));
+		}
+	}
+
+	if (!Connectivity.IsValid())
+	{
+		Connectivity = MakeShared<FHelikaConnectivity, ESPMode::ThreadSafe>();
+		Connectivity->Configure(Config.Get()->Connectivity);
+	}
+	if (!SpillStore.IsValid())
+	{
+		// Batches spilled before an earlier shutdown are uploaded with the backlog
+		SpillStore = MakeShared<FHelikaSpillStore, ESPMode::ThreadSafe>(FHelikaSpillStore::GetDefaultDirectory());
+		SpillStore->Load();
+	}
+
+	RegisterFlushTicker(Config.Get()->GetFlushTickInterval());
+	FTSTicker::GetCoreTicker().RemoveTicker(SchedulerTickerHandle);
+	SchedulerTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UHelikaManager::HandleSchedulerTick));
+	LastGameMetricsTime = FPlatformTime::Seconds();
+	SettingsChangedHandle = UHelikaLibrary::GetHelikaSettings()->OnSettingsChanged.AddUObject(this, &UHelikaManager::RefreshSettings);
+
+#if !UE_BUILD_SHIPPING
+	// Players could otherwise write every event, user details included, to a file of their choosing
+	FString RecordingPath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("HelikaRecord="), RecordingPath))
+	{
+		StartEventRecording(RecordingPath);
+	}
+#endif
+
+	CreateSession();
+
+#if WITH_EDITOR
+	FEditorDelegates::EndPIE.AddStatic(&EndSession);
+#endif
+}
+
+void UHelikaManager::DeinitializeSDK()
+{
+	// Send whatever is still waiting before the session goes away
+	if (bIsInitialized)
+	{
+		SendGameMetrics(Config.Get(), FPlatformTime::Seconds() - LastGameMetricsTime);
+	}
+	Flush();
+	StopEventRecording();
+
+	FTSTicker::GetCoreTicker().RemoveTicker(FlushTickerHandle);
+	FlushTickerHandle.Reset();
+	FTSTicker::GetCoreTicker().RemoveTicker(SchedulerTickerHandle);
+	SchedulerTickerHandle.Reset();
+	UHelikaLibrary::GetHelikaSettings()->OnSettingsChanged.Remove(SettingsChangedHandle);
+	SettingsChangedHandle.Reset();
+
+	{
+		FWriteScopeLock Lock(ContextsLock);
+		Contexts.Empty();
+		AddContextsMemory(-ContextsMemoryBytes);
+	}
+
+	SessionId = "";
+	bIsInitialized = false;
+	PublishConfig();
+}
+
+void UHelikaManager::SendEvent(const FHelikaJsonObject& EventProps, EHelikaPriority Priority)
+{
+	SendEvent(EventProps.Object, Priority);
+}
+
+void UHelikaManager::SendEvents(TArray<FHelikaJsonObject> EventProps, EHelikaPriority Priority)
+{
+	TArray<TSharedPtr<FJsonObject>> JsonArray;
+	for (auto EventProp : EventProps)
+	{
+		JsonArray.Add(EventProp.Object);
+	}
+
+	SendEvents(JsonArray, Priority);
+}
+
+void UHelikaManager::SendUserEvent(const FHelikaJsonObject& EventProps, EHelikaPriority Priority)
+{
+	SendUserEvent(EventProps.Object, Priority);
+}
+
+void UHelikaManager::SendUserEvents(TArray<FHelikaJsonObject> EventProps, EHelikaPriority Priority)
+{
+	TArray<TSharedPtr<FJsonObject>> JsonArray;
+	for (auto EventProp : EventProps)
+	{
+		JsonArray.Add(EventProp.Object);
+	}
+
+	SendUserEvents(JsonArray, Priority);
+}
+
+bool UHelikaManager::SendEvent(TSharedPtr<FJsonObject> EventProps, EHelikaPriority Priority)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Ingest");
+	HELIKA_LLM_SCOPE(IngestQueue);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika Subsystem is not yet initialized"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	if (!EventProps.IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be null"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsAccepted);
+	if (!IsSampledOut(*Snapshot))
+	{
+		FHelikaEventRecorder::Get().Record(EHelikaRecordedSend::Game, Priority, EventProps, Snapshot->DefaultContext, Snapshot->Version);
+		EnqueueEvent(AppendAttributesToJsonObject(FHelikaConfigSnapshot::CopyJsonObject(EventProps), false, *Snapshot->DefaultContext, *Snapshot), Snapshot->DefaultContext, Snapshot, false, Priority);
+	}
+	return true;
+}
+
+bool UHelikaManager::SendEvents(TArray<TSharedPtr<FJsonObject>> EventProps, EHelikaPriority Priority)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Ingest");
+	HELIKA_LLM_SCOPE(IngestQueue);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Warning, TEXT("Helika Subsystem is not yet initialized"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected, EventProps.Num());
+		return false;
+	}
+
+	if (EventProps.IsEmpty())
+	{
+		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be empty"));
+		return false;
+	}
+
+	for (const TSharedPtr<FJsonObject>& EventProp : EventProps)
+	{
+		if (!EventProp.IsValid())
+		{
+			UE_LOG(LogHelika, Error, TEXT("'Event Props' contains invalid/null object"));
+			FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected, EventProps.Num());
+			return false;
+		}
+	}
+
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsAccepted, EventProps.Num());
+	EventProps.RemoveAll([&Snapshot](const TSharedPtr<FJsonObject>&) { return IsSampledOut(*Snapshot); });
+	for (const TSharedPtr<FJsonObject>& EventProp : EventProps)
+	{
+		FHelikaEventRecorder::Get().Record(EHelikaRecordedSend::Game, Priority, EventProp, Snapshot->DefaultContext, Snapshot->Version);
+	}
+	EnrichEvents(EventProps, false, *Snapshot->DefaultContext, *Snapshot);
+	for (const TSharedPtr<FJsonObject>& EventProp : EventProps)
+	{
+		EnqueueEvent(EventProp, Snapshot->DefaultContext, Snapshot, false, Priority);
+	}
+
+	return true;
+}
+
+
+bool UHelikaManager::SendUserEvent(TSharedPtr<FJsonObject> EventProps, EHelikaPriority Priority)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Ingest");
+	HELIKA_LLM_SCOPE(IngestQueue);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Log, TEXT("Helika Subsystem is not yet initialized"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	if (!EventProps.IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be null"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsAccepted);
+	if (!IsSampledOut(*Snapshot))
+	{
+		FHelikaEventRecorder::Get().Record(EHelikaRecordedSend::User, Priority, EventProps, Snapshot->DefaultContext, Snapshot->Version);
+		EnqueueEvent(AppendAttributesToJsonObject(FHelikaConfigSnapshot::CopyJsonObject(EventProps), true, *Snapshot->DefaultContext, *Snapshot), Snapshot->DefaultContext, Snapshot, true, Priority);
+	}
+	return true;
+}
+
+bool UHelikaManager::SendUserEvents(TArray<TSharedPtr<FJsonObject>> EventProps, EHelikaPriority Priority)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Ingest");
+	HELIKA_LLM_SCOPE(IngestQueue);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Log, TEXT("Helika Subsystem is not yet initialized"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected, EventProps.Num());
+		return false;
+	}
+
+	if (EventProps.IsEmpty())
+	{
+		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be empty"));
+		return false;
+	}
+
+	for (const TSharedPtr<FJsonObject>& EventProp : EventProps)
+	{
+		if (!EventProp.IsValid())
+		{
+			UE_LOG(LogHelika, Error, TEXT("'Event Props' contains invalid/null object"));
+			FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected, EventProps.Num());
+			return false;
+		}
+	}
+
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsAccepted, EventProps.Num());
+	EventProps.RemoveAll([&Snapshot](const TSharedPtr<FJsonObject>&) { return IsSampledOut(*Snapshot); });
+	for (const TSharedPtr<FJsonObject>& EventProp : EventProps)
+	{
+		FHelikaEventRecorder::Get().Record(EHelikaRecordedSend::User, Priority, EventProp, Snapshot->DefaultContext, Snapshot->Version);
+	}
+	EnrichEvents(EventProps, true, *Snapshot->DefaultContext, *Snapshot);
+	for (const TSharedPtr<FJsonObject>& EventProp : EventProps)
+	{
+		EnqueueEvent(EventProp, Snapshot->DefaultContext, Snapshot, true, Priority);
+	}
+
+	return true;
+}
+
+bool UHelikaManager::SendTrackedEvent(TSharedPtr<FJsonObject> EventProps, EHelikaPriority Priority, bool bIsUserEvent, const FHelikaDeliveryPtr& Delivery)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Ingest");
+	HELIKA_LLM_SCOPE(IngestQueue);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika Subsystem is not yet initialized"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		Delivery->Settle(EHelikaDeliveryResult::HD_Invalid);
+		return false;
+	}
+
+	if (!EventProps.IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be null"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		Delivery->Settle(EHelikaDeliveryResult::HD_Invalid);
+		return false;
+	}
+
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsAccepted);
+	if (IsSampledOut(*Snapshot))
+	{
+		Delivery->Settle(EHelikaDeliveryResult::HD_SampledOut);
+		return false;
+	}
+
+	FHelikaEventRecorder::Get().Record(bIsUserEvent ? EHelikaRecordedSend::User : EHelikaRecordedSend::Game, Priority, EventProps, Snapshot->DefaultContext, Snapshot->Version);
+	EnqueueEvent(AppendAttributesToJsonObject(FHelikaConfigSnapshot::CopyJsonObject(EventProps), bIsUserEvent, *Snapshot->DefaultContext, *Snapshot), Snapshot->DefaultContext, Snapshot, bIsUserEvent, Priority, Delivery);
+	return true;
+}
+
+void UHelikaManager::Flush()
+{
+	Flush(nullptr);
+}
+
+void UHelikaManager::Flush(const FHelikaDeliveryPtr& Delivery)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Flush");
+
+	// Session events and summaries still waiting in the scheduler go with this flush
+	if (Scheduler.IsValid())
+	{
+		Scheduler->RunAll();
+	}
+
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	for (const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane : Lanes)
+	{
+		if (Lane.IsValid())
+		{
+			FlushLane(Lane, *Snapshot, false, false, Delivery);
+		}
+	}
+
+	// Releases the hold the delivery was created with, it settles as delivered when nothing had to be uploaded
+	if (Delivery.IsValid())
+	{
+		Delivery->Settle(EHelikaDeliveryResult::HD_Delivered);
+	}
+}
+
+bool UHelikaManager::FlushLane(const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane, const FHelikaConfigSnapshot& InConfig, bool bRespectBackoff, bool bWithinBudget, const FHelikaDeliveryPtr& Delivery)
+{
+	HELIKA_TRACE_SCOPE("FlushLane");
+
+	const FHelikaLaneConfig& LaneConfig = InConfig.GetLane(Lane->GetPriority());
+	Lane->NextFlushTime = FPlatformTime::Seconds() + LaneConfig.FlushIntervalSeconds;
+
+	// Without telemetry batches are only printed, there is no request to hold back
+	const bool bUploads = InConfig.Telemetry > ETelemetryLevel::TL_None;
+
+	TArray<FHelikaQueuedEvent> Batch;
+	TArray<uint8> Payload;
+	while (!(bRespectBackoff && Lane->IsBackingOff(FPlatformTime::Seconds())) && Lane->GetQueue().Num() > 0)
+	{
+		if (bWithinBudget && !Scheduler->HasBudget())
+		{
+			return false;
+		}
+		if (bUploads && !Connectivity->TryBeginUpload())
+		{
+			// Offline full batches go to disk as they fill, an explicit flush (e.g. on shutdown) spills everything
+			if (InConfig.Connectivity.bSpillWhileOffline && (!bRespectBackoff || Connectivity->GetState() == EHelikaConnectivity::HC_Offline))
+			{
+				SpillLane(*Lane, InConfig, !bRespectBackoff);
+				if (Delivery.IsValid())
+				{
+					Delivery->AddPending();
+					Delivery->Settle(EHelikaDeliveryResult::HD_Spilled);
+				}
+			}
+			else if (Delivery.IsValid())
+			{
+				// Held in memory until the collector answers again
+				Delivery->AddPending();
+				Delivery->Settle(EHelikaDeliveryResult::HD_Requeued);
+			}
+			return true;
+		}
+		if (!BuildEnvelope(*Lane, InConfig, Batch, Payload) || Batch.IsEmpty())
+		{
+			// Empty queue, or every event of the envelope was over MaxEventKilobytes
+			if (bUploads)
+			{
+				Connectivity->CancelUpload();
+			}
+			continue;
+		}
+
+		// send event to helika API
+		SendHTTPPost("/events/", MoveTemp(Payload), MoveTemp(Batch), Lane, Delivery);
+	}
+	return true;
+}
+
+void UHelikaManager::ScheduleLaneFlush(const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane)
+{
+	if (Lane->bFlushScheduled.exchange(true))
+	{
+		return;
+	}
+
+	Scheduler->Schedule([this, Lane]()
+	{
+		if (!FlushLane(Lane, *Config.Get(), true, true))
+		{
+			return false;
+		}
+		// A lane filling up again after this point schedules a new flush
+		Lane->bFlushScheduled.store(false);
+		return true;
+	});
+}
+
+bool UHelikaManager::BuildEnvelope(FHelikaLane& Lane, const FHelikaConfigSnapshot& InConfig, TArray<FHelikaQueuedEvent>& OutEvents, TArray<uint8>& OutPayload)
+{
+	TArray<FHelikaQueuedEvent> Batch;
+	if (!Lane.GetQueue().DequeueBatch(Batch, InConfig.GetLane(Lane.GetPriority()).MaxBatchSize))
+	{
+		return false;
+	}
+
+	// Context blocks are encoded once per batch by the serializer
+	HELIKA_LLM_SCOPE(Serialization);
+	FHelikaBatchSerializer Serializer;
+	TArray<int32> Written;
+	TArray<int32> Filtered;
+	OutPayload.Reset();
+	const int32 NumConsumed = Serializer.SerializeBudgeted(Batch, InConfig.BatchLimits, FHelikaBatchSerializer::GetBatchBudget(InConfig.BatchLimits, InConfig.bCompressPayloads), OutPayload, Written, &Filtered);
+	const FHelikaTrackedBytes SerializationBytes(EHelikaMemoryTag::Serialization, OutPayload.GetAllocatedSize() + Serializer.GetAllocatedSize());
+
+	// Events past the byte budget go back to the front of the lane for the next envelope
+	if (NumConsumed < Batch.Num())
+	{
+		TArray<FHelikaQueuedEvent> Rest;
+		Rest.Reserve(Batch.Num() - NumConsumed);
+		for (int32 Index = NumConsumed; Index < Batch.Num(); ++Index)
+		{
+			Rest.Add(MoveTemp(Batch[Index]));
+		}
+		Lane.GetQueue().Requeue(MoveTemp(Rest));
+	}
+	FHelikaMetricsCounters::Add(EHelikaCounter::QueueDepth, -NumConsumed);
+
+	OutEvents.Reset(Written.Num());
+	for (const int32 Index : Written)
+	{
+		OutEvents.Add(MoveTemp(Batch[Index]));
+	}
+	for (const int32 Index : Filtered)
+	{
+		if (Batch[Index].Delivery.IsValid())
+		{
+			Batch[Index].Delivery->Settle(EHelikaDeliveryResult::HD_Filtered);
+			Batch[Index].Delivery.Reset();
+		}
+	}
+	// What is left of the consumed events was over MaxEventKilobytes
+	for (int32 Index = 0; Index < NumConsumed; ++Index)
+	{
+		if (Batch[Index].Delivery.IsValid())
+		{
+			Batch[Index].Delivery->Settle(EHelikaDeliveryResult::HD_Invalid);
+		}
+	}
+	return true;
+}
+
+void UHelikaManager::SpillLane(FHelikaLane& Lane, const FHelikaConfigSnapshot& InConfig, bool bIncludePartialBatch)
+{
+	HELIKA_TRACE_SCOPE("Spill");
+
+	const int32 MaxBatchSize = InConfig.GetLane(Lane.GetPriority()).MaxBatchSize;
+	TArray<FHelikaQueuedEvent> Batch;
+	TArray<uint8> Payload;
+	while ((bIncludePartialBatch || Lane.GetQueue().Num() >= MaxBatchSize) && BuildEnvelope(Lane, InConfig, Batch, Payload))
+	{
+		if (!Batch.IsEmpty())
+		{
+			// The file keeps the attempts of the most retried event
+			int32 NumRetries = 0;
+			for (const FHelikaQueuedEvent& Event : Batch)
+			{
+				if (Event.Delivery.IsValid())
+				{
+					Event.Delivery->Settle(EHelikaDeliveryResult::HD_Spilled);
+				}
+				NumRetries = FMath::Max(NumRetries, Event.NumRetries);
+			}
+			FHelikaMetricsCounters::Add(EHelikaCounter::EventsSpilled, Batch.Num());
+			FHelikaMetricsCounters::Add(EHelikaCounter::EventsShed, SpillStore->Write(Lane.GetPriority(), Payload, Batch.Num(), InConfig.Connectivity.MaxSpillBytes, NumRetries));
+		}
+	}
+}
+
+bool UHelikaManager::StartEventRecording(const FString& FilePath)
+{
+	return FHelikaEventRecorder::Get().Start(FilePath);
+}
+
+void UHelikaManager::StopEventRecording()
+{
+	FHelikaEventRecorder::Get().Stop();
+}
+
+EHelikaConnectivity UHelikaManager::GetConnectivityState() const
+{
+	return Connectivity.IsValid() ? Connectivity->GetState() : EHelikaConnectivity::HC_Online;
+}
+
+bool UHelikaManager::UpdateConnectivity(const FHelikaConfigSnapshot& InConfig, double Now)
+{
+	if (InConfig.Telemetry == ETelemetryLevel::TL_None)
+	{
+		return false;
+	}
+
+	Connectivity->SetPlatformHint(!FHelikaConnectivity::IsPlatformOffline(), Now);
+	if (Connectivity->TryBeginProbe(Now))
+	{
+		FHelikaConnectivity::SendProbe(*Transport, InConfig.BaseUrl, [WeakConnectivity = TWeakPtr<FHelikaConnectivity, ESPMode::ThreadSafe>(Connectivity)](bool bReachedCollector)
+		{
+			if (const TSharedPtr<FHelikaConnectivity, ESPMode::ThreadSafe> PinnedConnectivity = WeakConnectivity.Pin())
+			{
+				PinnedConnectivity->EndProbe(bReachedCollector, FPlatformTime::Seconds());
+			}
+		});
+		return false;
+	}
+
+	// A throttling collector holds back the spilled backlog too
+	for (const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane : Lanes)
+	{
+		if (Lane.IsValid() && Lane->IsBackingOff(Now))
+		{
+			return false;
+		}
+	}
+	return Connectivity->GetState() != EHelikaConnectivity::HC_Offline;
+}
+
+bool UHelikaManager::DrainSpillStore(const FHelikaConfigSnapshot& InConfig)
+{
+	HELIKA_TRACE_SCOPE("DrainSpill");
+
+	// Spilled batches are the oldest events, they go first but never take more than MaxDrainRequests requests
+	FHelikaSpilledBatch Batch;
+	TArray<uint8> Payload;
+	while (!SpillStore->IsEmpty() && Connectivity->TryBeginUpload(true))
+	{
+		if (!Scheduler->HasBudget())
+		{
+			Connectivity->CancelUpload();
+			return false;
+		}
+		if (!SpillStore->Take(Batch, Payload))
+		{
+			Connectivity->CancelUpload();
+			break;
+		}
+		SendSpilledBatch(MoveTemp(Batch), MoveTemp(Payload), InConfig);
+	}
+	return true;
+}
+
+FHelikaContext UHelikaManager::CreateContext(const FHelikaJsonObject& InUserDetails, const FHelikaJsonObject& InMatchMetadata)
+{
+	return CreateContext(InUserDetails.Object, InMatchMetadata.Object);
+}
+
+FHelikaContext UHelikaManager::CreateContext(TSharedPtr<FJsonObject> InUserDetails, TSharedPtr<FJsonObject> InMatchMetadata)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_LLM_SCOPE(Contexts);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika Subsystem is not yet initialized"));
+		return FHelikaContext();
+	}
+
+	const TSharedRef<FHelikaContextData, ESPMode::ThreadSafe> Data = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>();
+	Data->SessionId = UHelikaLibrary::CreateNewGuid();
+	Data->AnonymousId = GenerateAnonymousId(Data->SessionId, true);
+	Data->UserDetails = InUserDetails.IsValid() ? InUserDetails : MakeShareable(new FJsonObject());
+	Data->MatchMetadata = InMatchMetadata;
+
+	{
+		FWriteScopeLock Lock(ContextsLock);
+		Data->Id = ++NextContextId;
+		Contexts.Add(Data->Id, Data);
+		AddContextsMemory(EstimateContextBytes(*Data));
+	}
+
+	CreateContextSession(Data, Config.Get());
+
+	return FHelikaContext(Data->Id);
+}
+
+void UHelikaManager::DestroyContext(FHelikaContext Context)
+{
+	FWriteScopeLock Lock(ContextsLock);
+	TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe> Removed;
+	if (Contexts.RemoveAndCopyValue(Context.GetId(), Removed))
+	{
+		AddContextsMemory(-EstimateContextBytes(*Removed));
+	}
+}
+
+bool UHelikaManager::IsContextValid(FHelikaContext Context) const
+{
+	return FindContext(Context).IsValid();
+}
+
+FString UHelikaManager::GetContextSessionId(FHelikaContext Context) const
+{
+	const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe> Data = FindContext(Context);
+	return Data.IsValid() ? Data->SessionId : FString();
+}
+
+void UHelikaManager::SetContextUserDetails(FHelikaContext Context, const FHelikaJsonObject& InUserDetails)
+{
+	SetContextUserDetails(Context, InUserDetails.Object);
+}
+
+void UHelikaManager::SetContextUserDetails(FHelikaContext Context, TSharedPtr<FJsonObject> InUserDetails)
+{
+	UpdateContext(Context, [&InUserDetails](FHelikaContextData& Data)
+	{
+		Data.UserDetails = InUserDetails.IsValid() ? InUserDetails : MakeShareable(new FJsonObject());
+	});
+}
+
+void UHelikaManager::SetContextMatchMetadata(FHelikaContext Context, const FHelikaJsonObject& InMatchMetadata)
+{
+	SetContextMatchMetadata(Context, InMatchMetadata.Object);
+}
+
+void UHelikaManager::SetContextMatchMetadata(FHelikaContext Context, TSharedPtr<FJsonObject> InMatchMetadata)
+{
+	UpdateContext(Context, [&InMatchMetadata](FHelikaContextData& Data)
+	{
+		Data.MatchMetadata = InMatchMetadata;
+	});
+}
+
+void UHelikaManager::SendContextEvent(FHelikaContext Context, const FHelikaJsonObject& EventProps, EHelikaPriority Priority)
+{
+	SendContextEvent(Context, EventProps.Object, Priority);
+}
+
+void UHelikaManager::SendContextEvents(FHelikaContext Context, TArray<FHelikaJsonObject> EventProps, EHelikaPriority Priority)
+{
+	TArray<TSharedPtr<FJsonObject>> JsonArray;
+	for (auto EventProp : EventProps)
+	{
+		JsonArray.Add(EventProp.Object);
+	}
+
+	SendContextEvents(Context, JsonArray, Priority);
+}
+
+bool UHelikaManager::SendContextEvent(FHelikaContext Context, TSharedPtr<FJsonObject> EventProps, EHelikaPriority Priority)
+{
+	return SendContextEvents(Context, {EventProps}, Priority);
+}
+
+bool UHelikaManager::SendContextEvents(FHelikaContext Context, TArray<TSharedPtr<FJsonObject>> EventProps, EHelikaPriority Priority)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Ingest");
+	HELIKA_LLM_SCOPE(IngestQueue);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Log, TEXT("Helika Subsystem is not yet initialized"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected, EventProps.Num());
+		return false;
+	}
+
+	const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe> Data = FindContext(Context);
+	if (!Data.IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika context %d is invalid or has been destroyed"), Context.GetId());
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected, EventProps.Num());
+		return false;
+	}
+
+	if (EventProps.IsEmpty())
+	{
+		UE_LOG(LogHelika, Error, TEXT("'Event Props' cannot be empty"));
+		return false;
+	}
+
+	for (const TSharedPtr<FJsonObject>& EventProp : EventProps)
+	{
+		if (!EventProp.IsValid())
+		{
+			UE_LOG(LogHelika, Error, TEXT("'Event Props' contains invalid/null object"));
+			FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected, EventProps.Num());
+			return false;
+		}
+	}
+
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsAccepted, EventProps.Num());
+	EventProps.RemoveAll([&Snapshot](const TSharedPtr<FJsonObject>&) { return IsSampledOut(*Snapshot); });
+	for (const TSharedPtr<FJsonObject>& EventProp : EventProps)
+	{
+		FHelikaEventRecorder::Get().Record(EHelikaRecordedSend::Context, Priority, EventProp, Data, Snapshot->Version);
+	}
+	EnrichEvents(EventProps, true, *Data, *Snapshot);
+	for (const TSharedPtr<FJsonObject>& EventProp : EventProps)
+	{
+		EnqueueEvent(EventProp, Data, Snapshot, true, Priority);
+	}
+
+	return true;
+}
+
+FHelikaEventPrototype UHelikaManager::RegisterEventPrototype(const FString& EventType, const FString& EventSubType, const TArray<FString>& FieldNames)
+{
+	HELIKA_LLM_SCOPE(Contexts);
+	FWriteScopeLock Lock(EventTemplatesLock);
+	for (int32 Index = 0; Index < EventTemplates.Num(); ++Index)
+	{
+		if (EventTemplates[Index]->Matches(EventType, EventSubType, FieldNames))
+		{
+			return FHelikaEventPrototype(Index);
+		}
+	}
+
+	FString Error;
+	FHelikaEventTemplatePtr Template = FHelikaEventTemplate::Create(EventType, EventSubType, FieldNames, Error);
+	if (!Template.IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Cannot register event prototype '%s'/'%s': %s"), *EventType, *EventSubType, *Error);
+		return FHelikaEventPrototype();
+	}
+
+	EventTemplatesMemoryBytes += Template->GetAllocatedSize();
+	FHelikaMemoryCounters::Add(EHelikaMemoryTag::Contexts, Template->GetAllocatedSize());
+	return FHelikaEventPrototype(EventTemplates.Add(MoveTemp(Template)));
+}
+
+void UHelikaManager::SendPrototypeEvent(FHelikaEventPrototype Prototype, const TArray<FHelikaJsonValue>& Values, EHelikaPriority Priority)
+{
+	TArray<TSharedPtr<FJsonValue>> JsonValues;
+	for (const FHelikaJsonValue& Value : Values)
+	{
+		JsonValues.Add(Value.Value);
+	}
+
+	SendPrototypeEvent(Prototype, MoveTemp(JsonValues), Priority);
+}
+
+void UHelikaManager::SendUserPrototypeEvent(FHelikaEventPrototype Prototype, const TArray<FHelikaJsonValue>& Values, EHelikaPriority Priority)
+{
+	TArray<TSharedPtr<FJsonValue>> JsonValues;
+	for (const FHelikaJsonValue& Value : Values)
+	{
+		JsonValues.Add(Value.Value);
+	}
+
+	SendUserPrototypeEvent(Prototype, MoveTemp(JsonValues), Priority);
+}
+
+void UHelikaManager::SendContextPrototypeEvent(FHelikaContext Context, FHelikaEventPrototype Prototype, const TArray<FHelikaJsonValue>& Values, EHelikaPriority Priority)
+{
+	TArray<TSharedPtr<FJsonValue>> JsonValues;
+	for (const FHelikaJsonValue& Value : Values)
+	{
+		JsonValues.Add(Value.Value);
+	}
+
+	SendContextPrototypeEvent(Context, Prototype, MoveTemp(JsonValues), Priority);
+}
+
+DEFINE_FUNCTION(UHelikaManager::execSendPrototypeEventFromStruct)
+{
+	P_GET_STRUCT(FHelikaEventPrototype, Prototype);
+
+	// The wildcard struct is read as whatever struct the Blueprint connected
+	Stack.MostRecentPropertyAddress = nullptr;
+	Stack.MostRecentProperty = nullptr;
+	Stack.StepCompiledIn<FStructProperty>(nullptr);
+	const FStructProperty* ValuesProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+	const void* ValuesData = Stack.MostRecentPropertyAddress;
+
+	P_GET_ENUM(EHelikaPriority, Priority);
+	P_FINISH;
+
+	if (ValuesProperty == nullptr || ValuesData == nullptr)
+	{
+		UE_LOG(LogHelika, Error, TEXT("'Values' must be a struct"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return;
+	}
+
+	P_NATIVE_BEGIN;
+	P_THIS->SendPrototypeEventFromStruct(Prototype, ValuesProperty->Struct, ValuesData, Priority);
+	P_NATIVE_END;
+}
+
+bool UHelikaManager::SendPrototypeEvent(FHelikaEventPrototype Prototype, TArray<TSharedPtr<FJsonValue>> Values, EHelikaPriority Priority)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Ingest");
+	HELIKA_LLM_SCOPE(IngestQueue);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika Subsystem is not yet initialized"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	return EnqueuePrototypeEvent(Prototype, MoveTemp(Values), Snapshot->DefaultContext, Snapshot, EHelikaRecordedSend::Game, Priority);
+}
+
+bool UHelikaManager::SendUserPrototypeEvent(FHelikaEventPrototype Prototype, TArray<TSharedPtr<FJsonValue>> Values, EHelikaPriority Priority)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Ingest");
+	HELIKA_LLM_SCOPE(IngestQueue);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika Subsystem is not yet initialized"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	return EnqueuePrototypeEvent(Prototype, MoveTemp(Values), Snapshot->DefaultContext, Snapshot, EHelikaRecordedSend::User, Priority);
+}
+
+bool UHelikaManager::SendContextPrototypeEvent(FHelikaContext Context, FHelikaEventPrototype Prototype, TArray<TSharedPtr<FJsonValue>> Values, EHelikaPriority Priority)
+{
+	FHelikaGameThreadScope GameThreadScope;
+	HELIKA_TRACE_SCOPE("Ingest");
+	HELIKA_LLM_SCOPE(IngestQueue);
+
+	if (!bIsInitialized)
+	{
+		UE_LOG(LogHelika, Log, TEXT("Helika Subsystem is not yet initialized"));
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe> Data = FindContext(Context);
+	if (!Data.IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika context %d is invalid or has been destroyed"), Context.GetId());
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	return EnqueuePrototypeEvent(Prototype, MoveTemp(Values), Data, Config.Get(), EHelikaRecordedSend::Context, Priority);
+}
+
+bool UHelikaManager::SendPrototypeEventFromStruct(FHelikaEventPrototype Prototype, const UScriptStruct* Struct, const void* StructData, EHelikaPriority Priority)
+{
+	// Members map to the fields in declaration order, their names do not matter (Blueprint structs mangle them)
+	TArray<TSharedPtr<FJsonValue>> Values;
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		Values.Add(FJsonObjectConverter::UPropertyToJsonValue(*It, It->ContainerPtrToValuePtr<void>(StructData)));
+	}
+
+	return SendPrototypeEvent(Prototype, MoveTemp(Values), Priority);
+}
+
+void UHelikaManager::SetPrintToConsole(bool bInPrintEventsToConsole)
+{
+	UHelikaLibrary::GetHelikaSettings()->bPrintEventsToConsole = bInPrintEventsToConsole;
+	PublishConfig();
+}
+
+void UHelikaManager::RefreshSettings()
+{
+	PublishConfig();
+
+	if (bIsInitialized)
+	{
+		RegisterFlushTicker(Config.Get()->GetFlushTickInterval());
+	}
+}
+
+bool UHelikaManager::IsSDKInitialized()
+{
+	return bIsInitialized;
+}
+
+FString UHelikaManager::GetSessionId() const
+{
+	return SessionId;
+}
+
+TSharedPtr<FJsonObject> UHelikaManager::AppendAttributesToJsonObject(TSharedPtr<FJsonObject> JsonObject, bool bIsUserEvent, const FHelikaContextData& Context, const FHelikaConfigSnapshot& InConfig)
+{
+	HELIKA_TRACE_SCOPE("Validation");
+
+	// Add game_id only if the event doesn't already have it
+	UHelikaLibrary::AddOrReplace(JsonObject, "game_id", InConfig.GameId);
+
+	// Convert to ISO 8601 format string using "o" specifier
+	UHelikaLibrary::AddOrReplace(JsonObject, "created_at", FHelikaClock::UtcNow().ToIso8601());
+
+	if (!JsonObject->HasField(TEXT("event_type")) || JsonObject->GetStringField(TEXT("event_type")).IsEmpty() || JsonObject->GetStringField(TEXT("event_type")).TrimStartAndEnd().IsEmpty())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Invalid Event: Missing 'event_type' field"));
+	}
+
+	const TSharedPtr<FJsonObject>* EventObject = nullptr;
+	if (!JsonObject->HasField(TEXT("event")))
+	{
+		UE_LOG(LogHelika, Error, TEXT("Invalid Event: 'event' field does not have any event info"));
+	}
+	else if (!JsonObject->TryGetObjectField(TEXT("event"), EventObject) || !EventObject->IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Invalid Event: 'event' field must be of type [JsonObject]"));
+	}
+
+	if (EventObject == nullptr || !EventObject->IsValid())
+	{
+		// Enrichment still needs somewhere to go
+		UHelikaLibrary::AddOrReplace(JsonObject, "event", MakeShareable(new FJsonObject()));
+	}
+
+	const TSharedPtr<FJsonObject> InternalEvent = JsonObject->GetObjectField(TEXT("event"));
+	if (!InternalEvent->HasField(TEXT("event_sub_type")) || InternalEvent->GetStringField(TEXT("event_sub_type")).IsEmpty() || InternalEvent->GetStringField(TEXT("event_sub_type")).TrimStartAndEnd().IsEmpty())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Invalid Event: Missing 'event_sub_type' field"));
+	}
+
+	{
+		HELIKA_TRACE_SCOPE("Enrichment");
+		UHelikaLibrary::AddOrReplace(InternalEvent, "session_id", Context.SessionId);
+
+		UHelikaLibrary::AddOrReplace(InternalEvent, "user_id", bIsUserEvent ? Context.GetUserId() : Context.AnonymousId);
+	}
+
+	// helika_data, app_details and user_details are appended once per batch by the serializer
+
+	return JsonObject;
+}
+
+void UHelikaManager::EnrichEvents(TArrayView<TSharedPtr<FJsonObject>> Events, bool bIsUserEvent, const FHelikaContextData& Context, const FHelikaConfigSnapshot& InConfig)
+{
+	// The caller keeps its objects, every event is enriched in a copy of its own even when an object is passed twice
+	const int32 Threshold = InConfig.BatchLimits.ParallelThreshold;
+	if (Threshold <= 0 || Events.Num() < Threshold || !FApp::ShouldUseThreads())
+	{
+		for (TSharedPtr<FJsonObject>& Event : Events)
+		{
+			Event = AppendAttributesToJsonObject(FHelikaConfigSnapshot::CopyJsonObject(Event), bIsUserEvent, Context, InConfig);
+		}
+		return;
+	}
+
+	// Copies only read the caller's objects, chunks of them are spread over the workers
+	HELIKA_TRACE_SCOPE("ParallelEnrichment");
+	ParallelFor(FMath::DivideAndRoundUp(Events.Num(), EnrichChunkEvents), [this, Events, bIsUserEvent, &Context, &InConfig](int32 ChunkIndex)
+	{
+		const int32 Last = FMath::Min((ChunkIndex + 1) * EnrichChunkEvents, Events.Num());
+		for (int32 Index = ChunkIndex * EnrichChunkEvents; Index < Last; ++Index)
+		{
+			Events[Index] = AppendAttributesToJsonObject(FHelikaConfigSnapshot::CopyJsonObject(Events[Index]), bIsUserEvent, Context, InConfig);
+		}
+	});
+}
+
+void UHelikaManager::EnqueueEvent(const TSharedPtr<FJsonObject>& Event, const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe>& Context, const TSharedPtr<const FHelikaConfigSnapshot, ESPMode::ThreadSafe>& InConfig, bool bIsUserEvent, EHelikaPriority Priority,
+	const FHelikaDeliveryPtr& Delivery)
+{
+	FHelikaQueuedEvent QueuedEvent;
+	QueuedEvent.Event = Event;
+	QueuedEvent.Context = Context;
+	QueuedEvent.Config = InConfig;
+	QueuedEvent.bIsUserEvent = bIsUserEvent;
+	QueuedEvent.Delivery = Delivery;
+
+	EnqueueToLane(MoveTemp(QueuedEvent), *InConfig, InConfig->ResolvePriority(*Event, Priority));
+}
+
+bool UHelikaManager::EnqueuePrototypeEvent(FHelikaEventPrototype Prototype, TArray<TSharedPtr<FJsonValue>>&& Values, const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe>& Context,
+	const TSharedPtr<const FHelikaConfigSnapshot, ESPMode::ThreadSafe>& InConfig, EHelikaRecordedSend Send, EHelikaPriority Priority)
+{
+	FHelikaEventTemplatePtr Template;
+	{
+		FReadScopeLock Lock(EventTemplatesLock);
+		if (EventTemplates.IsValidIndex(Prototype.GetId()))
+		{
+			Template = EventTemplates[Prototype.GetId()];
+		}
+	}
+
+	if (!Template.IsValid())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika event prototype %d is not registered"), Prototype.GetId());
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	if (Values.Num() != Template->GetFieldNames().Num())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Event prototype '%s'/'%s' has %d fields, %d values were given"), *Template->GetEventType(), *Template->GetEventSubType(),
+			Template->GetFieldNames().Num(), Values.Num());
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsRejected);
+		return false;
+	}
+
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsAccepted);
+	if (IsSampledOut(*InConfig))
+	{
+		return true;
+	}
+
+	// Objects and arrays are copied so the caller can reuse them, the values are only encoded at flush
+	for (TSharedPtr<FJsonValue>& Value : Values)
+	{
+		Value = Value.IsValid() ? FHelikaConfigSnapshot::CopyJsonValue(Value) : MakeShared<FJsonValueNull>();
+	}
+
+	// The recorder keeps trees, only build one while it records
+	if (FHelikaEventRecorder::Get().IsRecording())
+	{
+		FHelikaEventRecorder::Get().Record(Send, Priority, Template->MakeEvent(Values), Context, InConfig->Version);
+	}
+
+	const EHelikaPriority Resolved = InConfig->ResolvePriority(Template->GetEventType(), Priority);
+
+	FHelikaQueuedEvent QueuedEvent;
+	QueuedEvent.Template = MoveTemp(Template);
+	QueuedEvent.Values = MoveTemp(Values);
+	QueuedEvent.CreatedAt = FHelikaClock::UtcNow();
+	QueuedEvent.Context = Context;
+	QueuedEvent.Config = InConfig;
+	QueuedEvent.bIsUserEvent = Send != EHelikaRecordedSend::Game;
+
+	EnqueueToLane(MoveTemp(QueuedEvent), *InConfig, Resolved);
+	return true;
+}
+
+void UHelikaManager::EnqueueToLane(FHelikaQueuedEvent&& QueuedEvent, const FHelikaConfigSnapshot& InConfig, EHelikaPriority Priority)
+{
+	const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane = Lanes[static_cast<int32>(Priority)];
+	const FHelikaLaneConfig& LaneConfig = InConfig.GetLane(Priority);
+
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsQueued);
+	FHelikaMetricsCounters::Add(EHelikaCounter::QueueDepth);
+
+	int32 QueueDepth = Lane->GetQueue().Enqueue(MoveTemp(QueuedEvent));
+	if (LaneConfig.MaxQueuedEvents > 0 && QueueDepth > LaneConfig.MaxQueuedEvents)
+	{
+		// The lane is not keeping up, the oldest events go first
+		const int32 NumShed = Lane->GetQueue().Shed(LaneConfig.MaxQueuedEvents);
+		FHelikaMetricsCounters::Add(EHelikaCounter::QueueDepth, -NumShed);
+		FHelikaMetricsCounters::Add(EHelikaCounter::EventsShed, NumShed);
+		QueueDepth -= NumShed;
+	}
+
+	// Serialization and the request are not capture work, they run in the scheduler's budget
+	if (QueueDepth >= LaneConfig.MaxBatchSize)
+	{
+		ScheduleLaneFlush(Lane);
+	}
+}
+
+bool UHelikaManager::IsSampledOut(const FHelikaConfigSnapshot& InConfig)
+{
+	// Called from any thread, FMath::FRand shares the state of the C runtime's rand between them
+	static thread_local FRandomStream Random(static_cast<int32>(FPlatformTime::Cycles() ^ (FPlatformTLS::GetCurrentThreadId() * 2654435761u)));
+	if (InConfig.EventSampleRate >= 1.f || Random.GetFraction() < InConfig.EventSampleRate)
+	{
+		return false;
+	}
+
+	FHelikaMetricsCounters::Add(EHelikaCounter::EventsSampledOut);
+	return true;
+}
+
+bool UHelikaManager::HandleFlushTick(float DeltaTime)
+{
+	FHelikaGameThreadScope GameThreadScope;
+
+	// Every lane keeps its own flush age, a lane backing off waits without holding back the others.
+	// Only the decisions are made here, the uploads run in the scheduler's budget.
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	const double Now = FPlatformTime::Seconds();
+	if (UpdateConnectivity(*Snapshot, Now) && !SpillStore->IsEmpty() && !bSpillDrainScheduled)
+	{
+		bSpillDrainScheduled = true;
+		Scheduler->Schedule([this]()
+		{
+			const bool bDone = DrainSpillStore(*Config.Get());
+			bSpillDrainScheduled = !bDone;
+			return bDone;
+		});
+	}
+
+	if (Now - LastGameMetricsTime >= Snapshot->GameMetrics.IntervalSeconds)
+	{
+		Scheduler->Schedule([this, Snapshot, IntervalSeconds = Now - LastGameMetricsTime]()
+		{
+			SendGameMetrics(Snapshot, IntervalSeconds);
+			return true;
+		});
+		LastGameMetricsTime = Now;
+	}
+
+	bool bHasBacklog = !SpillStore->IsEmpty();
+	for (const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane : Lanes)
+	{
+		if (Lane.IsValid() && Now >= Lane->NextFlushTime && !Lane->IsBackingOff(Now) && Lane->GetQueue().Num() > 0)
+		{
+			ScheduleLaneFlush(Lane);
+		}
+		bHasBacklog |= Lane.IsValid() && Lane->GetQueue().Num() >= Snapshot->GetLane(Lane->GetPriority()).MaxBatchSize;
+	}
+
+	if (!bHasBacklog && Connectivity->GetState() == EHelikaConnectivity::HC_Draining)
+	{
+		Connectivity->FinishDrain();
+	}
+	return true;
+}
+
+bool UHelikaManager::HandleSchedulerTick(float DeltaTime)
+{
+	Scheduler->Tick(FHelikaScheduler::GetFrameElapsedSeconds());
+	if (Transport.IsValid())
+	{
+		Transport->Tick();
+	}
+	for (int32 Index = RetiredTransports.Num() - 1; Index >= 0; --Index)
+	{
+		RetiredTransports[Index]->Tick();
+		if (RetiredTransports[Index]->IsIdle())
+		{
+			RetiredTransports.RemoveAtSwap(Index);
+		}
+	}
+
+	// Sampled once per tick instead of on every submit, a sum over the threads' counters takes the registry lock
+	HELIKA_TRACE_COUNTER_SET(HelikaQueueDepth, FHelikaMetricsCounters::Sum(EHelikaCounter::QueueDepth));
+	HELIKA_TRACE_COUNTER_SET(HelikaBytesInFlight, FHelikaMetricsCounters::Sum(EHelikaCounter::BytesInFlight));
+	return true;
+}
+
+void UHelikaManager::PublishConfig()
+{
+	HELIKA_LLM_SCOPE(Contexts);
+
+	const TSharedRef<FHelikaContextData, ESPMode::ThreadSafe> DefaultContext = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>();
+	DefaultContext->SessionId = SessionId;
+	DefaultContext->AnonymousId = AnonymousId;
+	DefaultContext->UserDetails = FHelikaConfigSnapshot::CopyJsonObject(UserDetails);
+
+	const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+	Snapshot->Version = ++ConfigVersion;
+	Snapshot->CaptureSettings(*UHelikaLibrary::GetHelikaSettings());
+	Snapshot->bPiiTracking = bPiiTracking;
+	Snapshot->AppDetails = FHelikaConfigSnapshot::CopyJsonObject(AppDetails);
+	Snapshot->DefaultContext = DefaultContext;
+
+	const FHelikaConfigSnapshotPtr Previous = Config.Get();
+	Config.Publish(Snapshot);
+
+	// Requests in flight on a replaced transport complete on it, HandleSchedulerTick releases it once they did
+	if (!Transport.IsValid() || !Previous.IsValid() || Previous->Transport != Snapshot->Transport)
+	{
+		if (Transport.IsValid() && !Transport->IsIdle())
+		{
+			RetiredTransports.Add(Transport.ToSharedRef());
+		}
+		Transport = MakeShared<FHelikaTrackedTransport, ESPMode::ThreadSafe>(IHelikaTransport::Create(Snapshot->Transport));
+		UE_LOG(LogHelika, Verbose, TEXT("Helika uploads through the %s transport"), Transport->GetName());
+	}
+
+	if (Connectivity.IsValid())
+	{
+		Connectivity->Configure(Snapshot->Connectivity);
+	}
+	FHelikaGameMetrics::Get().Configure(Snapshot->GameMetrics);
+	if (Scheduler.IsValid())
+	{
+		Scheduler->Configure(Snapshot->Scheduler);
+	}
+
+	const UHelikaSettings* Settings = UHelikaLibrary::GetHelikaSettings();
+	FHelikaDebugSinkConfig DebugConfig;
+	DebugConfig.Output = Settings->DebugOutput;
+	DebugConfig.MaxEntriesPerSecond = Settings->DebugMaxEntriesPerSecond;
+	DebugConfig.MaxEntryBytes = Settings->DebugMaxEntryBytes;
+	DebugConfig.HistorySize = Settings->DebugHistorySize;
+	FHelikaDebugSink::Get().Configure(DebugConfig);
+
+	// Queued events may still hold older versions, only the published one is accounted
+	const int64 SnapshotBytes = sizeof(FHelikaConfigSnapshot) + FHelikaMemoryCounters::EstimateJsonBytes(Snapshot->AppDetails) + EstimateContextBytes(*DefaultContext);
+	FHelikaMemoryCounters::Add(EHelikaMemoryTag::Contexts, SnapshotBytes - ConfigMemoryBytes);
+	ConfigMemoryBytes = SnapshotBytes;
+}
+
+void UHelikaManager::RegisterFlushTicker(float IntervalSeconds)
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(FlushTickerHandle);
+	FlushTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UHelikaManager::HandleFlushTick), IntervalSeconds);
+}
+
+TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe> UHelikaManager::FindContext(FHelikaContext Context) const
+{
+	FReadScopeLock Lock(ContextsLock);
+	const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe>* Found = Contexts.Find(Context.GetId());
+	return Found ? *Found : nullptr;
+}
+
+void UHelikaManager::UpdateContext(FHelikaContext Context, TFunctionRef<void(FHelikaContextData&)> Update)
+{
+	HELIKA_LLM_SCOPE(Contexts);
+	FWriteScopeLock Lock(ContextsLock);
+	TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe>* Found = Contexts.Find(Context.GetId());
+	if (Found == nullptr)
+	{
+		UE_LOG(LogHelika, Error, TEXT("Helika context %d is invalid or has been destroyed"), Context.GetId());
+		return;
+	}
+
+	// Queued events keep the previous version, publish a modified copy
+	const TSharedRef<FHelikaContextData, ESPMode::ThreadSafe> Data = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>(**Found);
+	Update(*Data);
+	AddContextsMemory(EstimateContextBytes(*Data) - EstimateContextBytes(**Found));
+	*Found = Data;
+}
+
+void UHelikaManager::AddContextsMemory(int64 Delta)
+{
+	ContextsMemoryBytes += Delta;
+	FHelikaMemoryCounters::Add(EHelikaMemoryTag::Contexts, Delta);
+}
+
+void UHelikaManager::CreateContextSession(const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe>& Context, const TSharedPtr<const FHelikaConfigSnapshot, ESPMode::ThreadSafe>& InConfig)
+{
+	// The template captures the time and ids, the device queries of the PII block are deferred
+	TSharedPtr<FJsonObject> CreateSessionEvent = GetTemplateEvent("session_created", "session_created", *Context, *InConfig);
+	Scheduler->Schedule([this, CreateSessionEvent, Context, InConfig]()
+	{
+		if (InConfig->bPiiTracking)
+		{
+			AppendPIITracking(CreateSessionEvent->GetObjectField(TEXT("event")));
+		}
+
+		EnqueueEvent(CreateSessionEvent, Context, InConfig, true, EHelikaPriority::HP_Critical);
+		return true;
+	});
+}
+
+void UHelikaManager::CreateSession()
+{
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	CreateContextSession(Snapshot->DefaultContext, Snapshot);
+}
+
+void UHelikaManager::SendHTTPPost(const FString& Url, TArray<uint8>&& Payload, TArray<FHelikaQueuedEvent>&& Events, const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane, const FHelikaDeliveryPtr& Delivery) const
+{
+	const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+	const int32 NumEvents = Events.Num();
+
+	if (Snapshot->bPrintEventsToConsole)
+	{
+		FHelikaDebugSink::Get().Push(Snapshot->Telemetry > ETelemetryLevel::TL_None ? EHelikaDebugEntryKind::Sent : EHelikaDebugEntryKind::PrintOnly, Payload, NumEvents);
+	}
+	if (Snapshot->Telemetry == ETelemetryLevel::TL_None)
+	{
+		for (const FHelikaQueuedEvent& Event : Events)
+		{
+			if (Event.Delivery.IsValid())
+			{
+				Event.Delivery->Settle(EHelikaDeliveryResult::HD_NotUploaded);
+			}
+		}
+		if (Delivery.IsValid())
+		{
+			Delivery->AddPending();
+			Delivery->Settle(EHelikaDeliveryResult::HD_NotUploaded);
+		}
+	}
+	else
+	{
+		if (Delivery.IsValid())
+		{
+			Delivery->AddPending();
+		}
+
+		FHelikaUploadBody Body;
+		FHelikaTransportRequest PRequest = CreateUploadRequest(*Snapshot, Url, MoveTemp(Payload), Body);
+		PRequest.TimeoutSeconds = Snapshot->Transport.TimeoutSeconds;
+		// Completes on the transport's thread, everything touched here is thread safe
+		Transport->Send(MoveTemp(PRequest),
+			[Body, NumEvents, bPrintEventsToConsole = Snapshot->bPrintEventsToConsole, LaneConfig = Snapshot->GetLane(Lane->GetPriority()),
+				Batch = MakeShared<TArray<FHelikaQueuedEvent>, ESPMode::ThreadSafe>(MoveTemp(Events)), WeakLane = TWeakPtr<FHelikaLane, ESPMode::ThreadSafe>(Lane), Delivery,
+				WeakConnectivity = TWeakPtr<FHelikaConnectivity, ESPMode::ThreadSafe>(Connectivity)](FHelikaTransportResponse&& Response) mutable
+			{
+				HELIKA_TRACE_SCOPE("HttpComplete");
+
+				FinishUpload(Body, Response);
+				if (Response.bConnected)
+				{
+					ProcessEventTrackResponse(Response, bPrintEventsToConsole);
+				}
+				if (const TSharedPtr<FHelikaConnectivity, ESPMode::ThreadSafe> PinnedConnectivity = WeakConnectivity.Pin())
+				{
+					PinnedConnectivity->EndUpload(Response.bConnected, FPlatformTime::Seconds());
+				}
+
+				// Matching the answer to 1000 events is not game thread work, the queue is thread safe
+				Async(EAsyncExecution::TaskGraph, [Answer = MoveTemp(Response), Batch, WeakLane, NumEvents, LaneConfig, Delivery]()
+				{
+					const FHelikaAcknowledgement Acknowledgement = Answer.bConnected
+						? FHelikaAcknowledgement::Parse(NumEvents, Answer.Status, Answer.Body)
+						: FHelikaAcknowledgement::Parse(NumEvents, 0, TConstArrayView<uint8>());
+
+					const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe> Lane = WeakLane.Pin();
+					const int32 NumRequeued = Acknowledgement.Apply(MoveTemp(*Batch), Lane.IsValid() ? &Lane->GetQueue() : nullptr, LaneConfig.MaxEventRetries);
+					if (Delivery.IsValid())
+					{
+						Delivery->Settle(Acknowledgement.NumAccepted == NumEvents ? EHelikaDeliveryResult::HD_Delivered
+							: Acknowledgement.NumInvalid > 0 ? EHelikaDeliveryResult::HD_Invalid
+							: NumRequeued > 0 ? EHelikaDeliveryResult::HD_Requeued : EHelikaDeliveryResult::HD_OutOfRetries);
+					}
+					if (Lane.IsValid())
+					{
+						Lane->RecordUploadResult(Acknowledgement.NumRetry == NumEvents, Answer.RetryAfterSeconds, LaneConfig.MaxBackoffSeconds);
+					}
+				});
+			});
+	}
+}
+
+void UHelikaManager::SendSpilledBatch(FHelikaSpilledBatch&& Batch, TArray<uint8>&& Payload, const FHelikaConfigSnapshot& InConfig) const
+{
+	if (InConfig.bPrintEventsToConsole)
+	{
+		FHelikaDebugSink::Get().Push(EHelikaDebugEntryKind::Sent, Payload, Batch.NumEvents);
+	}
+
+	const EHelikaPriority Priority = Batch.Priority;
+	FHelikaUploadBody Body;
+	FHelikaTransportRequest PRequest = CreateUploadRequest(InConfig, TEXT("/events/"), MoveTemp(Payload), Body);
+	PRequest.TimeoutSeconds = InConfig.Transport.TimeoutSeconds;
+	Transport->Send(MoveTemp(PRequest),
+		[Body, Batch = MoveTemp(Batch), bPrintEventsToConsole = InConfig.bPrintEventsToConsole, LaneConfig = InConfig.GetLane(Priority), MaxSpillBytes = InConfig.Connectivity.MaxSpillBytes,
+			WeakLane = TWeakPtr<FHelikaLane, ESPMode::ThreadSafe>(Lanes[static_cast<int32>(Priority)]),
+			WeakConnectivity = TWeakPtr<FHelikaConnectivity, ESPMode::ThreadSafe>(Connectivity), WeakSpillStore = TWeakPtr<FHelikaSpillStore, ESPMode::ThreadSafe>(SpillStore)](
+		FHelikaTransportResponse&& Response) mutable
+		{
+			HELIKA_TRACE_SCOPE("HttpComplete");
+
+			FinishUpload(Body, Response);
+			if (Response.bConnected)
+			{
+				ProcessEventTrackResponse(Response, bPrintEventsToConsole);
+			}
+			if (const TSharedPtr<FHelikaConnectivity, ESPMode::ThreadSafe> PinnedConnectivity = WeakConnectivity.Pin())
+			{
+				PinnedConnectivity->EndUpload(Response.bConnected, FPlatformTime::Seconds());
+			}
+
+			Async(EAsyncExecution::TaskGraph, [Answer = MoveTemp(Response), Batch = MoveTemp(Batch), WeakLane, WeakSpillStore, LaneConfig, MaxSpillBytes]() mutable
+			{
+				const FHelikaAcknowledgement Acknowledgement = Answer.bConnected
+					? FHelikaAcknowledgement::Parse(Batch.NumEvents, Answer.Status, Answer.Body)
+					: FHelikaAcknowledgement::Parse(Batch.NumEvents, 0, TConstArrayView<uint8>());
+
+				const TSharedPtr<FHelikaSpillStore, ESPMode::ThreadSafe> PinnedSpillStore = WeakSpillStore.Pin();
+				if (!PinnedSpillStore.IsValid())
+				{
+					// The file stays on disk for the next run
+					return;
+				}
+
+				// The file is kept until the collector settled the batch, a transient failure keeps it for the next drain
+				// and the events to retry of a partial answer are spilled again on their own
+				const bool bTransientFailure = Acknowledgement.NumRetry == Batch.NumEvents;
+				if (bTransientFailure)
+				{
+					PinnedSpillStore->Restore(MoveTemp(Batch));
+				}
+				else
+				{
+					Acknowledgement.ApplySpilled(*PinnedSpillStore, Batch, LaneConfig.MaxEventRetries, MaxSpillBytes);
+				}
+
+				if (const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe> Lane = WeakLane.Pin())
+				{
+					Lane->RecordUploadResult(bTransientFailure, Answer.RetryAfterSeconds, LaneConfig.MaxBackoffSeconds);
+				}
+			});
+		});
+}
+
+void UHelikaManager::SendGameMetrics(const FHelikaConfigSnapshotPtr& InConfig, double IntervalSeconds)
+{
+	HELIKA_TRACE_SCOPE("GameMetrics");
+
+	if (!InConfig->GameMetrics.bEnabled)
+	{
+		return;
+	}
+
+	const TArray<FHelikaSeriesSummary> Summaries = FHelikaGameMetrics::Get().Collect();
+
+	// Usually a single event, split by series before it would run into MaxEventKilobytes
+	const int64 MaxEventBytes = InConfig->BatchLimits.MaxEventBytes / 2;
+	int32 Next = 0;
+	while (Next < Summaries.Num())
+	{
+		TArray<TSharedPtr<FJsonValue>> Series;
+		int64 EventBytes = 0;
+		for (; Next < Summaries.Num() && (Series.IsEmpty() || EventBytes + Summaries[Next].EstimatedBytes <= MaxEventBytes); ++Next)
+		{
+			EventBytes += Summaries[Next].EstimatedBytes;
+			Series.Add(MakeShareable(new FJsonValueObject(Summaries[Next].Object)));
+		}
+
+		TSharedPtr<FJsonObject> SummaryEvent = GetTemplateEvent("game_metrics", "game_metrics_summary", *InConfig->DefaultContext, *InConfig);
+		const TSharedPtr<FJsonObject> EventDetail = SummaryEvent->GetObjectField(TEXT("event"))->GetObjectField(TEXT("event_detail"));
+		EventDetail->SetNumberField("interval_seconds", IntervalSeconds);
+		EventDetail->SetArrayField("series", Series);
+
+		EnqueueEvent(SummaryEvent, InConfig->DefaultContext, InConfig, true, EHelikaPriority::HP_Bulk);
+	}
+}
+
+void UHelikaManager::ProcessEventTrackResponse(const FHelikaTransportResponse& Response, bool bPrintEventsToConsole)
+{
+	if (!Response.bConnected)
+	{
+		return;
+	}
+
+	if (bPrintEventsToConsole)
+	{
+		FHelikaDebugSink::Get().Push(EHelikaDebugEntryKind::Response, Response.Body, 0, Response.Status);
+	}
+	else if (!EHttpResponseCodes::IsOk(Response.Status))
+	{
+		const FUTF8ToTCHAR Content(reinterpret_cast<const ANSICHAR*>(Response.Body.GetData()), FMath::Min(Response.Body.Num(), 256));
+		UE_LOG(LogHelika, Warning, TEXT("Helika Server Response %d: %s"), Response.Status, *FString(Content.Length(), Content.Get()));
+	}
+}
+
+void UHelikaManager::EndSession(bool bIsSimulating)
+{
+	Get()->DeinitializeSDK();
+}
+
+FString UHelikaManager::GenerateAnonymousId(FString Seed, bool bCreateNewAnonId)
+{
+	if (bCreateNewAnonId)
+	{
+		return "anon_" + UHelikaLibrary::ComputeSha256Hash(Seed);
+	}
+	return AnonymousId;
+}
+
+TSharedPtr<FJsonObject> UHelikaManager::GetTemplateEvent(const FString& EventType, const FString& EventSubType, const FHelikaContextData& Context, const FHelikaConfigSnapshot& InConfig) const
+{
+	TSharedPtr<FJsonObject> TemplateEvent = MakeShareable(new FJsonObject());
+	TemplateEvent->SetStringField("created_at", FHelikaClock::UtcNow().ToIso8601());
+	TemplateEvent->SetStringField("game_id", InConfig.GameId);
+	TemplateEvent->SetStringField("event_type", EventType);
+
+	TSharedPtr<FJsonObject> TemplateSubEvent = MakeShareable(new FJsonObject());
+	TemplateSubEvent->SetStringField("user_id", Context.GetUserId());
+	TemplateSubEvent->SetStringField("session_id", Context.SessionId);
+	TemplateSubEvent->SetStringField("event_sub_type", EventSubType);
+	TemplateSubEvent->SetObjectField("event_detail", MakeShareable(new FJsonObject()));
+
+	TemplateEvent->SetObjectField("event", TemplateSubEvent);
+
+	return TemplateEvent;
+}
+
+void UHelikaManager::AppendPIITracking(const TSharedPtr<FJsonObject>& GameEvent)
+{
+	// The device does not change while the game runs, query it once
+	static const TSharedPtr<FJsonObject> PiiData = []()
+	{
+		const TSharedPtr<FJsonObject> Data = MakeShareable(new FJsonObject());
+		Data->SetStringField("os", UHelikaLibrary::GetOSVersion());
+		Data->SetStringField("os_family", UHelikaLibrary::GetPlatformName());
+		Data->SetStringField("device_model", FPlatformMisc::GetDeviceMakeAndModel());
+		Data->SetStringField("device_name", FPlatformProcess::ComputerName());
+		Data->SetStringField("device_type", UHelikaLibrary::GetDeviceType());
+		Data->SetStringField("device_ue_unique_identifier", UHelikaLibrary::GetDeviceUniqueIdentifier());
+		Data->SetStringField("device_processor_type", UHelikaLibrary::GetDeviceProcessor());
+		return Data;
+	}();
+
+	UHelikaLibrary::AddIfNull(GameEvent, "helika_data", MakeShareable(new FJsonObject()));
+	UHelikaLibrary::AddOrReplace(GameEvent->GetObjectField(TEXT("helika_data")), "additional_user_info", PiiData);
+}
+
+TSharedPtr<FJsonObject> UHelikaManager::GetUserDetails()
+{
+	return UserDetails;
+}
+
+void UHelikaManager::SetUserDetails(TSharedPtr<FJsonObject> InUserDetails, bool bCreateNewAnonId)
+{
+	if (!InUserDetails->HasField(TEXT("user_id")) || InUserDetails->GetStringField(TEXT("user_id")).IsEmpty())
+	{
+		AnonymousId = GenerateAnonymousId(FHelikaClock::NewGuid().ToString(), bCreateNewAnonId);
+		InUserDetails = MakeShareable(new FJsonObject());
+		InUserDetails->SetStringField("user_id", AnonymousId);
+		InUserDetails->SetObjectField("email", nullptr);
+		InUserDetails->SetObjectField("wallet", nullptr);
+	}
+	UserDetails = InUserDetails;
+	PublishConfig();
+}
+
+FHelikaJsonObject UHelikaManager::GetUserDetailsAsJson()
+{
+	FHelikaJsonObject UserDetailsJsonObject;
+	UserDetailsJsonObject.Object = GetUserDetails();
+	return UserDetailsJsonObject;
+}
+
+void UHelikaManager::SetUserDetails(const FHelikaJsonObject& InUserDetails, bool bCreateNewAnonId)
+{
+	SetUserDetails(InUserDetails.Object, bCreateNewAnonId);
+}
+
+TSharedPtr<FJsonObject> UHelikaManager::GetAppDetails()
+{
+	return AppDetails;
+}
+
+void UHelikaManager::SetAppDetails(const TSharedPtr<FJsonObject>& InAppDetails)
+{
+	AppDetails = InAppDetails;
+	PublishConfig();
+}
+
+FHelikaJsonObject UHelikaManager::GetAppDetailsAsJson()
+{
+	FHelikaJsonObject AppDetailsJsonObject;
+	AppDetailsJsonObject.Object = GetAppDetails();
+	return AppDetailsJsonObject;
+}
+
+void UHelikaManager::SetAppDetails(const FHelikaJsonObject& InAppDetails)
+{
+	SetAppDetails(InAppDetails.Object);
+}
+
+FHelikaMetrics UHelikaManager::GetMetrics() const
+{
+	return FHelikaMetricsCounters::Read();
+}
+
+FHelikaMemoryUsage UHelikaManager::GetMemoryUsage() const
+{
+	return FHelikaMemoryCounters::Read();
+}
+
+void UHelikaManager::ResetMemoryPeaks()
+{
+	FHelikaMemoryCounters::ResetPeaks();
+}
+
+void UHelikaManager::SetGauge(const FString& Name, double Value, const TMap<FString, FString>& Tags)
+{
+	FHelikaGameMetrics::Get().Record(EHelikaSeriesType::Gauge, Name, Value, Tags);
+}
+
+void UHelikaManager::IncrementCounter(const FString& Name, double Delta, const TMap<FString, FString>& Tags)
+{
+	FHelikaGameMetrics::Get().Record(EHelikaSeriesType::Counter, Name, Delta, Tags);
+}
+
+void UHelikaManager::RecordHistogram(const FString& Name, double Value, const TMap<FString, FString>& Tags)
+{
+	FHelikaGameMetrics::Get().Record(EHelikaSeriesType::Histogram, Name, Value, Tags);
+}
+
+bool UHelikaManager::GetPIITracking() const
+{
+	return bPiiTracking;
+}
+
+void UHelikaManager::SetPIITracking(bool bInPiiTracking, bool bSendPiiTrackingEvent)
+{
+	FHelikaGameThreadScope GameThreadScope;
+
+	bPiiTracking = bInPiiTracking;
+	PublishConfig();
+
+	if (bIsInitialized && bPiiTracking && bSendPiiTrackingEvent)
+	{
+		const FHelikaConfigSnapshotPtr Snapshot = Config.Get();
+		TSharedPtr<FJsonObject> CreateSessionEvent = GetTemplateEvent("session_created", "session_data_updated", *Snapshot->DefaultContext, *Snapshot);
+		Scheduler->Schedule([this, CreateSessionEvent, Snapshot]()
+		{
+			TSharedPtr<FJsonObject> InnerEvent = CreateSessionEvent->GetObjectField(TEXT("event"));
+			UHelikaLibrary::AddIfNull(InnerEvent, "type", "Session Data Refresh");
+			AppendPIITracking(InnerEvent);
+
+			EnqueueEvent(CreateSessionEvent, Snapshot->DefaultContext, Snapshot, true, EHelikaPriority::HP_Critical);
+			return true;
+		});
+	}
+}
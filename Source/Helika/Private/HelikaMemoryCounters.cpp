@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaMemoryCounters.h"
+
+#include "HelikaDefines.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+#include <atomic>
+
+LLM_DEFINE_TAG(Helika);
+LLM_DEFINE_TAG(Helika_IngestQueue);
+LLM_DEFINE_TAG(Helika_Contexts);
+LLM_DEFINE_TAG(Helika_Serialization);
+LLM_DEFINE_TAG(Helika_Compression);
+LLM_DEFINE_TAG(Helika_HttpBodies);
+
+DECLARE_MEMORY_STAT(TEXT("Memory Ingest Queue"), STAT_HelikaMemoryIngestQueue, STATGROUP_Helika);
+DECLARE_MEMORY_STAT(TEXT("Memory Contexts"), STAT_HelikaMemoryContexts, STATGROUP_Helika);
+DECLARE_MEMORY_STAT(TEXT("Memory Serialization"), STAT_HelikaMemorySerialization, STATGROUP_Helika);
+DECLARE_MEMORY_STAT(TEXT("Memory Compression"), STAT_HelikaMemoryCompression, STATGROUP_Helika);
+DECLARE_MEMORY_STAT(TEXT("Memory HTTP Bodies"), STAT_HelikaMemoryHttpBodies, STATGROUP_Helika);
+
+namespace
+{
+	constexpr int32 NumTags = static_cast<int32>(EHelikaMemoryTag::Count);
+
+	std::atomic<int64> CurrentBytes[NumTags];
+	std::atomic<int64> PeakBytes[NumTags];
+
+	/// Reference controller of a TSharedPtr created with MakeShareable
+	constexpr int64 SharedReferenceOverhead = 2 * sizeof(void*) + 2 * sizeof(int32);
+}
+
+void FHelikaMemoryCounters::Add(EHelikaMemoryTag Tag, int64 Delta)
+{
+	const int32 Index = static_cast<int32>(Tag);
+	const int64 Current = CurrentBytes[Index].fetch_add(Delta, std::memory_order_relaxed) + Delta;
+	if (Delta <= 0)
+	{
+		return;
+	}
+
+	int64 Peak = PeakBytes[Index].load(std::memory_order_relaxed);
+	while (Current > Peak && !PeakBytes[Index].compare_exchange_weak(Peak, Current, std::memory_order_relaxed))
+	{
+	}
+}
+
+FHelikaMemoryUsage FHelikaMemoryCounters::Read()
+{
+	FHelikaMemoryUsage Usage;
+	Usage.Tags.Reserve(NumTags);
+	for (int32 Index = 0; Index < NumTags; ++Index)
+	{
+		FHelikaMemoryTagUsage& TagUsage = Usage.Tags.AddDefaulted_GetRef();
+		TagUsage.Tag = static_cast<EHelikaMemoryTag>(Index);
+		TagUsage.CurrentBytes = CurrentBytes[Index].load(std::memory_order_relaxed);
+		TagUsage.PeakBytes = FMath::Max(PeakBytes[Index].load(std::memory_order_relaxed), TagUsage.CurrentBytes);
+		Usage.TotalBytes += TagUsage.CurrentBytes;
+	}
+	return Usage;
+}
+
+void FHelikaMemoryCounters::ResetPeaks()
+{
+	for (int32 Index = 0; Index < NumTags; ++Index)
+	{
+		PeakBytes[Index].store(CurrentBytes[Index].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+int64 FHelikaMemoryCounters::EstimateJsonBytes(const TSharedPtr<FJsonObject>& Object)
+{
+	if (!Object.IsValid())
+	{
+		return 0;
+	}
+
+	int64 Bytes = sizeof(FJsonObject) + SharedReferenceOverhead + Object->Values.GetAllocatedSize();
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Object->Values)
+	{
+		Bytes += Pair.Key.GetAllocatedSize() + EstimateJsonBytes(Pair.Value);
+	}
+	return Bytes;
+}
+
+int64 FHelikaMemoryCounters::EstimateJsonBytes(const TSharedPtr<FJsonValue>& Value)
+{
+	if (!Value.IsValid())
+	{
+		return 0;
+	}
+
+	switch (Value->Type)
+	{
+	case EJson::String:
+		// FJsonValue only hands out copies, the length is what matters
+		return sizeof(FJsonValueString) + SharedReferenceOverhead + (Value->AsString().Len() + 1) * sizeof(TCHAR);
+	case EJson::Object:
+		return sizeof(FJsonValueObject) + SharedReferenceOverhead + EstimateJsonBytes(Value->AsObject());
+	case EJson::Array:
+	{
+		const TArray<TSharedPtr<FJsonValue>>& Array = Value->AsArray();
+		int64 Bytes = sizeof(FJsonValueArray) + SharedReferenceOverhead + Array.GetAllocatedSize();
+		for (const TSharedPtr<FJsonValue>& Element : Array)
+		{
+			Bytes += EstimateJsonBytes(Element);
+		}
+		return Bytes;
+	}
+	case EJson::Number:
+		return sizeof(FJsonValueNumber) + SharedReferenceOverhead;
+	default:
+		return sizeof(FJsonValueBoolean) + SharedReferenceOverhead;
+	}
+}
+
+#if STATS
+void FHelikaMemoryCounters::PublishStats()
+{
+	SET_MEMORY_STAT(STAT_HelikaMemoryIngestQueue, CurrentBytes[static_cast<int32>(EHelikaMemoryTag::IngestQueue)].load(std::memory_order_relaxed));
+	SET_MEMORY_STAT(STAT_HelikaMemoryContexts, CurrentBytes[static_cast<int32>(EHelikaMemoryTag::Contexts)].load(std::memory_order_relaxed));
+	SET_MEMORY_STAT(STAT_HelikaMemorySerialization, CurrentBytes[static_cast<int32>(EHelikaMemoryTag::Serialization)].load(std::memory_order_relaxed));
+	SET_MEMORY_STAT(STAT_HelikaMemoryCompression, CurrentBytes[static_cast<int32>(EHelikaMemoryTag::Compression)].load(std::memory_order_relaxed));
+	SET_MEMORY_STAT(STAT_HelikaMemoryHttpBodies, CurrentBytes[static_cast<int32>(EHelikaMemoryTag::HttpBodies)].load(std::memory_order_relaxed));
+}
+#endif
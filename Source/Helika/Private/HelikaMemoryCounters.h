@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "HelikaMemory.h"
+
+class FJsonObject;
+class FJsonValue;
+
+// Low-Level Memory tracker tags, shown under 'Helika' by 'stat LLMFULL' and memreport when running with -llm
+LLM_DECLARE_TAG(Helika);
+LLM_DECLARE_TAG(Helika_IngestQueue);
+LLM_DECLARE_TAG(Helika_Contexts);
+LLM_DECLARE_TAG(Helika_Serialization);
+LLM_DECLARE_TAG(Helika_Compression);
+LLM_DECLARE_TAG(Helika_HttpBodies);
+
+/// Attributes the allocations of the enclosing scope to a Helika LLM tag, e.g. HELIKA_LLM_SCOPE(IngestQueue)
+#define HELIKA_LLM_SCOPE(Tag) LLM_SCOPE_BYTAG(Helika_##Tag)
+
+/**
+ * Current and peak bytes per EHelikaMemoryTag, independent of LLM so budgets can be checked in shipping builds.
+ */
+class FHelikaMemoryCounters
+{
+public:
+	/// Adds Delta (negative on release) to the tag and raises its peak
+	static void Add(EHelikaMemoryTag Tag, int64 Delta);
+
+	static FHelikaMemoryUsage Read();
+
+	static void ResetPeaks();
+
+	/// Approximate heap size of a json tree, values, keys and shared pointer overhead included
+	static int64 EstimateJsonBytes(const TSharedPtr<FJsonObject>& Object);
+	static int64 EstimateJsonBytes(const TSharedPtr<FJsonValue>& Value);
+
+#if STATS
+	/// Copies the current bytes of every tag to STATGROUP_Helika
+	static void PublishStats();
+#endif
+};
+
+/// Counts Bytes against Tag for the lifetime of the scope
+class FHelikaTrackedBytes
+{
+public:
+	FHelikaTrackedBytes(EHelikaMemoryTag InTag, int64 InBytes)
+		: Tag(InTag)
+		, Bytes(InBytes)
+	{
+		FHelikaMemoryCounters::Add(Tag, Bytes);
+	}
+
+	~FHelikaTrackedBytes()
+	{
+		FHelikaMemoryCounters::Add(Tag, -Bytes);
+	}
+
+	FHelikaTrackedBytes(const FHelikaTrackedBytes&) = delete;
+	FHelikaTrackedBytes& operator=(const FHelikaTrackedBytes&) = delete;
+
+private:
+	EHelikaMemoryTag Tag;
+	int64 Bytes;
+};
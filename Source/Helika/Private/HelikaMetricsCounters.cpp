@@ -0,0 +1,304 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaMetricsCounters.h"
+
+#include "HelikaDefines.h"
+#include <atomic>
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Accepted"), STAT_HelikaEventsAccepted, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Sampled Out"), STAT_HelikaEventsSampledOut, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Rejected"), STAT_HelikaEventsRejected, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Queued"), STAT_HelikaEventsQueued, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Sent"), STAT_HelikaEventsSent, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Dropped"), STAT_HelikaEventsDropped, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Shed"), STAT_HelikaEventsShed, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Spilled"), STAT_HelikaEventsSpilled, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Oversized"), STAT_HelikaEventsOversized, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Events Filtered"), STAT_HelikaEventsFiltered, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queue Depth"), STAT_HelikaQueueDepth, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes Before Compression"), STAT_HelikaBytesBeforeCompression, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes After Compression"), STAT_HelikaBytesAfterCompression, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes In Flight"), STAT_HelikaBytesInFlight, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests Sent"), STAT_HelikaRequestsSent, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests Failed"), STAT_HelikaRequestsFailed, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Retries"), STAT_HelikaRetries, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Budget Overruns"), STAT_HelikaBudgetOverruns, STATGROUP_Helika);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Work Deferrals"), STAT_HelikaWorkDeferrals, STATGROUP_Helika);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Request Latency p50 (ms)"), STAT_HelikaLatencyP50, STATGROUP_Helika);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Request Latency p99 (ms)"), STAT_HelikaLatencyP99, STATGROUP_Helika);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Game Thread Time (ms)"), STAT_HelikaGameThreadMs, STATGROUP_Helika);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Game Thread Time Peak (ms)"), STAT_HelikaGameThreadPeakMs, STATGROUP_Helika);
+
+const float FHelikaMetricsCounters::LatencyBucketsMs[NumLatencyBuckets] = {10.f, 25.f, 50.f, 100.f, 250.f, 500.f, 1000.f, 2500.f, 5000.f, MAX_flt};
+
+int32 FHelikaGameThreadScope::Depth = 0;
+
+namespace
+{
+	constexpr int32 NumCounters = static_cast<int32>(EHelikaCounter::Count);
+
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FThreadCounters
+	{
+		std::atomic<int64> Values[NumCounters];
+
+		FThreadCounters()
+		{
+			for (std::atomic<int64>& Value : Values)
+			{
+				Value.store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	struct FCounterRegistry
+	{
+		FCriticalSection Lock;
+		/// Blocks of the live threads
+		TArray<FThreadCounters*> Blocks;
+		/// Totals of the threads that exited
+		FThreadCounters Retired;
+	};
+
+	FCounterRegistry& GetRegistry()
+	{
+		static FCounterRegistry Registry;
+		return Registry;
+	}
+
+	/// Trivially destructible, still readable by thread_local destructors that run after the block was folded
+	thread_local bool bThreadBlockReleased = false;
+
+	/// Owns the block of its thread, folds it into FCounterRegistry::Retired at thread exit so that no block is leaked
+	struct FThreadBlock
+	{
+		TUniquePtr<FThreadCounters> Counters = MakeUnique<FThreadCounters>();
+
+		FThreadBlock()
+		{
+			FCounterRegistry& Registry = GetRegistry();
+			FScopeLock Lock(&Registry.Lock);
+			Registry.Blocks.Add(Counters.Get());
+		}
+
+		~FThreadBlock()
+		{
+			// Under the lock so that readers never see the values in both places or in neither
+			FCounterRegistry& Registry = GetRegistry();
+			FScopeLock Lock(&Registry.Lock);
+			for (int32 Index = 0; Index < NumCounters; ++Index)
+			{
+				Registry.Retired.Values[Index].fetch_add(Counters->Values[Index].load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+			Registry.Blocks.RemoveSingleSwap(Counters.Get());
+			bThreadBlockReleased = true;
+		}
+	};
+
+	/// Null once the calling thread is exiting and its block was folded
+	FThreadCounters* GetThreadCounters()
+	{
+		if (bThreadBlockReleased)
+		{
+			return nullptr;
+		}
+		static thread_local FThreadBlock ThreadBlock;
+		return ThreadBlock.Counters.Get();
+	}
+
+	// Written by the game thread only, read from anywhere
+	std::atomic<uint64> GameThreadFrame{0};
+	std::atomic<uint64> GameThreadFrameCycles{0};
+	std::atomic<uint64> GameThreadLastFrameCycles{0};
+	std::atomic<uint64> GameThreadPeakFrameCycles{0};
+	std::atomic<uint64> GameThreadTotalCycles{0};
+}
+
+void FHelikaMetricsCounters::Add(EHelikaCounter Counter, int64 Value)
+{
+	FThreadCounters* Counters = GetThreadCounters();
+	if (Counters == nullptr)
+	{
+		// Recorded by a destructor of an exiting thread
+		GetRegistry().Retired.Values[static_cast<int32>(Counter)].fetch_add(Value, std::memory_order_relaxed);
+		return;
+	}
+
+	// Only the owning thread writes its block, a relaxed load/store pair is enough
+	std::atomic<int64>& Slot = Counters->Values[static_cast<int32>(Counter)];
+	Slot.store(Slot.load(std::memory_order_relaxed) + Value, std::memory_order_relaxed);
+}
+
+void FHelikaMetricsCounters::RecordRequestLatency(double Seconds)
+{
+	const float Milliseconds = static_cast<float>(Seconds * 1000.0);
+	int32 Bucket = 0;
+	while (Bucket < NumLatencyBuckets - 1 && Milliseconds > LatencyBucketsMs[Bucket])
+	{
+		++Bucket;
+	}
+	Add(static_cast<EHelikaCounter>(static_cast<int32>(EHelikaCounter::LatencyBucketFirst) + Bucket));
+}
+
+void FHelikaMetricsCounters::AddGameThreadCycles(uint64 Cycles)
+{
+	GameThreadTotalCycles.store(GameThreadTotalCycles.load(std::memory_order_relaxed) + Cycles, std::memory_order_relaxed);
+
+	const uint64 Frame = GFrameCounter;
+	if (GameThreadFrame.load(std::memory_order_relaxed) != Frame)
+	{
+		// Frames without any SDK call in between count as zero
+		const bool bPreviousFrame = GameThreadFrame.load(std::memory_order_relaxed) + 1 == Frame;
+		GameThreadLastFrameCycles.store(bPreviousFrame ? GameThreadFrameCycles.load(std::memory_order_relaxed) : 0, std::memory_order_relaxed);
+		GameThreadFrameCycles.store(0, std::memory_order_relaxed);
+		GameThreadFrame.store(Frame, std::memory_order_relaxed);
+	}
+
+	const uint64 FrameCycles = GameThreadFrameCycles.load(std::memory_order_relaxed) + Cycles;
+	GameThreadFrameCycles.store(FrameCycles, std::memory_order_relaxed);
+	if (FrameCycles > GameThreadPeakFrameCycles.load(std::memory_order_relaxed))
+	{
+		GameThreadPeakFrameCycles.store(FrameCycles, std::memory_order_relaxed);
+	}
+}
+
+uint64 FHelikaMetricsCounters::GetGameThreadTotalCycles()
+{
+	return GameThreadTotalCycles.load(std::memory_order_relaxed);
+}
+
+FHelikaMetrics FHelikaMetricsCounters::Read()
+{
+	int64 Totals[NumCounters] = {};
+	{
+		FCounterRegistry& Registry = GetRegistry();
+		FScopeLock Lock(&Registry.Lock);
+		for (int32 Index = 0; Index < NumCounters; ++Index)
+		{
+			Totals[Index] = Registry.Retired.Values[Index].load(std::memory_order_relaxed);
+		}
+		for (const FThreadCounters* Block : Registry.Blocks)
+		{
+			for (int32 Index = 0; Index < NumCounters; ++Index)
+			{
+				Totals[Index] += Block->Values[Index].load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	auto Total = [&Totals](EHelikaCounter Counter)
+	{
+		return Totals[static_cast<int32>(Counter)];
+	};
+
+	FHelikaMetrics Metrics;
+	Metrics.EventsAccepted = Total(EHelikaCounter::EventsAccepted);
+	Metrics.EventsSampledOut = Total(EHelikaCounter::EventsSampledOut);
+	Metrics.EventsRejected = Total(EHelikaCounter::EventsRejected);
+	Metrics.EventsQueued = Total(EHelikaCounter::EventsQueued);
+	Metrics.EventsSent = Total(EHelikaCounter::EventsSent);
+	Metrics.EventsDropped = Total(EHelikaCounter::EventsDropped);
+	Metrics.EventsShed = Total(EHelikaCounter::EventsShed);
+	Metrics.EventsSpilled = Total(EHelikaCounter::EventsSpilled);
+	Metrics.EventsOversized = Total(EHelikaCounter::EventsOversized);
+	Metrics.EventsFiltered = Total(EHelikaCounter::EventsFiltered);
+	Metrics.QueueDepth = Total(EHelikaCounter::QueueDepth);
+	Metrics.BytesBeforeCompression = Total(EHelikaCounter::BytesBeforeCompression);
+	Metrics.BytesAfterCompression = Total(EHelikaCounter::BytesAfterCompression);
+	Metrics.BytesInFlight = Total(EHelikaCounter::BytesInFlight);
+	Metrics.RequestsSent = Total(EHelikaCounter::RequestsSent);
+	Metrics.RequestsSucceeded = Total(EHelikaCounter::RequestsSucceeded);
+	Metrics.RequestsFailed = Total(EHelikaCounter::RequestsFailed);
+	Metrics.Retries = Total(EHelikaCounter::Retries);
+	Metrics.BudgetOverruns = Total(EHelikaCounter::BudgetOverruns);
+	Metrics.WorkDeferrals = Total(EHelikaCounter::WorkDeferrals);
+
+	Metrics.RequestLatencyBucketsMs.Append(LatencyBucketsMs, NumLatencyBuckets);
+	Metrics.RequestLatencyHistogram.Append(&Totals[static_cast<int32>(EHelikaCounter::LatencyBucketFirst)], NumLatencyBuckets);
+
+	const uint64 Frame = GameThreadFrame.load(std::memory_order_relaxed);
+	uint64 LastFrameCycles = 0;
+	if (GFrameCounter == Frame)
+	{
+		LastFrameCycles = GameThreadLastFrameCycles.load(std::memory_order_relaxed);
+	}
+	else if (GFrameCounter == Frame + 1)
+	{
+		LastFrameCycles = GameThreadFrameCycles.load(std::memory_order_relaxed);
+	}
+	Metrics.GameThreadMsLastFrame = static_cast<float>(FPlatformTime::ToMilliseconds64(LastFrameCycles));
+	Metrics.GameThreadMsPeak = static_cast<float>(FPlatformTime::ToMilliseconds64(GameThreadPeakFrameCycles.load(std::memory_order_relaxed)));
+
+	return Metrics;
+}
+
+int64 FHelikaMetricsCounters::Sum(EHelikaCounter Counter)
+{
+	FCounterRegistry& Registry = GetRegistry();
+	FScopeLock Lock(&Registry.Lock);
+	int64 Total = Registry.Retired.Values[static_cast<int32>(Counter)].load(std::memory_order_relaxed);
+	for (const FThreadCounters* Block : Registry.Blocks)
+	{
+		Total += Block->Values[static_cast<int32>(Counter)].load(std::memory_order_relaxed);
+	}
+	return Total;
+}
+
+#if STATS
+namespace
+{
+	/// Upper bound of the bucket holding the given quantile, 0 when nothing was recorded
+	float GetLatencyQuantileMs(const FHelikaMetrics& Metrics, double Quantile)
+	{
+		int64 Count = 0;
+		for (const int64 BucketCount : Metrics.RequestLatencyHistogram)
+		{
+			Count += BucketCount;
+		}
+
+		const int64 Rank = FMath::CeilToInt64(Count * Quantile);
+		int64 Seen = 0;
+		for (int32 Bucket = 0; Bucket < Metrics.RequestLatencyHistogram.Num() && Count > 0; ++Bucket)
+		{
+			Seen += Metrics.RequestLatencyHistogram[Bucket];
+			if (Seen >= Rank)
+			{
+				// The unbounded bucket reports the last finite bound
+				return Metrics.RequestLatencyBucketsMs[FMath::Min(Bucket, Metrics.RequestLatencyBucketsMs.Num() - 2)];
+			}
+		}
+		return 0.f;
+	}
+}
+
+bool FHelikaMetricsCounters::PublishStats(float DeltaTime)
+{
+	const FHelikaMetrics Metrics = Read();
+
+	SET_DWORD_STAT(STAT_HelikaEventsAccepted, Metrics.EventsAccepted);
+	SET_DWORD_STAT(STAT_HelikaEventsSampledOut, Metrics.EventsSampledOut);
+	SET_DWORD_STAT(STAT_HelikaEventsRejected, Metrics.EventsRejected);
+	SET_DWORD_STAT(STAT_HelikaEventsQueued, Metrics.EventsQueued);
+	SET_DWORD_STAT(STAT_HelikaEventsSent, Metrics.EventsSent);
+	SET_DWORD_STAT(STAT_HelikaEventsDropped, Metrics.EventsDropped);
+	SET_DWORD_STAT(STAT_HelikaEventsShed, Metrics.EventsShed);
+	SET_DWORD_STAT(STAT_HelikaEventsSpilled, Metrics.EventsSpilled);
+	SET_DWORD_STAT(STAT_HelikaEventsOversized, Metrics.EventsOversized);
+	SET_DWORD_STAT(STAT_HelikaEventsFiltered, Metrics.EventsFiltered);
+	SET_DWORD_STAT(STAT_HelikaQueueDepth, Metrics.QueueDepth);
+	SET_DWORD_STAT(STAT_HelikaBytesBeforeCompression, Metrics.BytesBeforeCompression);
+	SET_DWORD_STAT(STAT_HelikaBytesAfterCompression, Metrics.BytesAfterCompression);
+	SET_DWORD_STAT(STAT_HelikaBytesInFlight, Metrics.BytesInFlight);
+	SET_DWORD_STAT(STAT_HelikaRequestsSent, Metrics.RequestsSent);
+	SET_DWORD_STAT(STAT_HelikaRequestsFailed, Metrics.RequestsFailed);
+	SET_DWORD_STAT(STAT_HelikaRetries, Metrics.Retries);
+	SET_DWORD_STAT(STAT_HelikaBudgetOverruns, Metrics.BudgetOverruns);
+	SET_DWORD_STAT(STAT_HelikaWorkDeferrals, Metrics.WorkDeferrals);
+	SET_FLOAT_STAT(STAT_HelikaLatencyP50, GetLatencyQuantileMs(Metrics, 0.5));
+	SET_FLOAT_STAT(STAT_HelikaLatencyP99, GetLatencyQuantileMs(Metrics, 0.99));
+	SET_FLOAT_STAT(STAT_HelikaGameThreadMs, Metrics.GameThreadMsLastFrame);
+	SET_FLOAT_STAT(STAT_HelikaGameThreadPeakMs, Metrics.GameThreadMsPeak);
+
+	return true;
+}
+#endif
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CoreGlobals.h"
+#include "HelikaMetrics.h"
+
+enum class EHelikaCounter : uint8
+{
+	EventsAccepted,
+	EventsSampledOut,
+	EventsRejected,
+	EventsQueued,
+	EventsSent,
+	EventsDropped,
+	EventsShed,
+	EventsSpilled,
+	EventsOversized,
+	EventsFiltered,
+	QueueDepth,
+	BytesBeforeCompression,
+	BytesAfterCompression,
+	BytesInFlight,
+	RequestsSent,
+	RequestsSucceeded,
+	RequestsFailed,
+	Retries,
+	BudgetOverruns,
+	WorkDeferrals,
+	LatencyBucketFirst,
+	LatencyBucketLast = LatencyBucketFirst + 9,
+
+	Count
+};
+
+/**
+ * Process wide pipeline counters that are cheap enough to stay on in shipping builds.
+ *
+ * Every thread increments its own cache line sized block without atomic read-modify-write,
+ * readers sum the blocks of the live threads. A thread folds its block into a shared total when it exits.
+ */
+class FHelikaMetricsCounters
+{
+public:
+	static constexpr int32 NumLatencyBuckets = static_cast<int32>(EHelikaCounter::LatencyBucketLast) - static_cast<int32>(EHelikaCounter::LatencyBucketFirst) + 1;
+
+	/// Upper bound in milliseconds of each latency bucket, the last one is unbounded
+	static const float LatencyBucketsMs[NumLatencyBuckets];
+
+	/// Adds Value to the calling thread's counter, negative values are allowed for gauges
+	static void Add(EHelikaCounter Counter, int64 Value = 1);
+
+	static void RecordRequestLatency(double Seconds);
+
+	/// Accumulates the game thread time of one UHelikaManager call into the current frame
+	static void AddGameThreadCycles(uint64 Cycles);
+
+	/// Game thread time of every UHelikaManager call since the process started
+	static uint64 GetGameThreadTotalCycles();
+
+	/// Sums the counters of every thread
+	static FHelikaMetrics Read();
+
+	/// Sums a single counter of every thread without building the whole FHelikaMetrics
+	static int64 Sum(EHelikaCounter Counter);
+
+#if STATS
+	/// Copies the aggregated counters to STATGROUP_Helika, called once per frame
+	static bool PublishStats(float DeltaTime);
+#endif
+};
+
+/// Measures the game thread time of the outermost UHelikaManager call on the stack
+class FHelikaGameThreadScope
+{
+public:
+	FHelikaGameThreadScope()
+		: StartCycles(IsInGameThread() && Depth++ == 0 ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FHelikaGameThreadScope()
+	{
+		if (StartCycles != 0)
+		{
+			FHelikaMetricsCounters::AddGameThreadCycles(FPlatformTime::Cycles64() - StartCycles);
+		}
+		if (IsInGameThread())
+		{
+			--Depth;
+		}
+	}
+
+private:
+	uint64 StartCycles;
+	static int32 Depth;
+};
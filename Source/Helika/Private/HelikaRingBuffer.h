@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Bounded lock-free queue for many producers and a single consumer.
+ *
+ * Every slot carries a sequence number telling whether it is free for the producer at a given
+ * position or holds a value for the consumer, so a push is one compare-exchange and a move.
+ * Pushing into a full ring fails instead of blocking or allocating.
+ */
+template<typename T>
+class THelikaRingBuffer
+{
+public:
+	/// Capacity is rounded up to a power of two
+	explicit THelikaRingBuffer(uint32 InCapacity)
+		: Slots(new FSlot[FMath::RoundUpToPowerOfTwo(FMath::Max(InCapacity, 2u))])
+		, Mask(FMath::RoundUpToPowerOfTwo(FMath::Max(InCapacity, 2u)) - 1)
+	{
+		for (uint64 Index = 0; Index <= Mask; ++Index)
+		{
+			Slots[Index].Sequence.store(Index, std::memory_order_relaxed);
+		}
+	}
+
+	THelikaRingBuffer(const THelikaRingBuffer&) = delete;
+	THelikaRingBuffer& operator=(const THelikaRingBuffer&) = delete;
+
+	/// Safe from any thread, returns false and leaves Value untouched when the ring is full
+	bool Push(T&& Value)
+	{
+		uint64 Position = PushPosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			FSlot& Slot = Slots[Position & Mask];
+			const int64 Difference = static_cast<int64>(Slot.Sequence.load(std::memory_order_acquire)) - static_cast<int64>(Position);
+			if (Difference == 0)
+			{
+				if (PushPosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+				{
+					Slot.Value = MoveTemp(Value);
+					Slot.Sequence.store(Position + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (Difference < 0)
+			{
+				return false;
+			}
+			else
+			{
+				Position = PushPosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/// Consumer thread only, returns false when nothing is ready
+	bool Pop(T& OutValue)
+	{
+		FSlot& Slot = Slots[PopPosition & Mask];
+		if (Slot.Sequence.load(std::memory_order_acquire) != PopPosition + 1)
+		{
+			return false;
+		}
+
+		OutValue = MoveTemp(Slot.Value);
+		Slot.Value = T();
+		Slot.Sequence.store(PopPosition + Mask + 1, std::memory_order_release);
+		++PopPosition;
+		return true;
+	}
+
+	uint32 GetCapacity() const { return static_cast<uint32>(Mask + 1); }
+
+private:
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FSlot
+	{
+		std::atomic<uint64> Sequence{0};
+		T Value;
+	};
+
+	TUniquePtr<FSlot[]> Slots;
+	const uint64 Mask;
+
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> PushPosition{0};
+	alignas(PLATFORM_CACHE_LINE_SIZE) uint64 PopPosition = 0;
+};
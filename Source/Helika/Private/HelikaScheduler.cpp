@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaScheduler.h"
+
+#include "HelikaDefines.h"
+#include "HelikaMetricsCounters.h"
+#include "HelikaTrace.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+
+namespace
+{
+	uint64 SecondsToCycles(double Seconds)
+	{
+		return static_cast<uint64>(FMath::Max(Seconds, 0.0) / FPlatformTime::GetSecondsPerCycle64());
+	}
+
+	/// FrameTargetMs, or the frame rate limit of the engine when it is 0. 0 when there is none.
+	double GetFrameTargetSeconds(const FHelikaSchedulerConfig& Config)
+	{
+		if (Config.FrameTargetMs > 0.f)
+		{
+			return Config.FrameTargetMs / 1000.0;
+		}
+		static const IConsoleVariable* MaxFPS = IConsoleManager::Get().FindConsoleVariable(TEXT("t.MaxFPS"));
+		const float FrameRateLimit = MaxFPS != nullptr ? MaxFPS->GetFloat() : 0.f;
+		return FrameRateLimit > 0.f ? 1.0 / FrameRateLimit : 0.0;
+	}
+}
+
+void FHelikaScheduler::Configure(const FHelikaSchedulerConfig& InConfig)
+{
+	Config = InConfig;
+}
+
+void FHelikaScheduler::Schedule(FWork&& Work)
+{
+	Incoming.Enqueue({MoveTemp(Work), FPlatformTime::Seconds()});
+	NumIncoming.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FHelikaScheduler::Tick(double FrameElapsedSeconds)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const uint64 BudgetCycles = SecondsToCycles(Config.BudgetMicroseconds / 1000000.0);
+	// SDK calls made on the game thread since the previous tick already used part of the budget
+	const uint64 InlineCycles = FHelikaMetricsCounters::GetGameThreadTotalCycles() - TotalCyclesAfterTick;
+
+	if (!IsEmpty())
+	{
+		const double FrameTargetSeconds = GetFrameTargetSeconds(Config);
+		const bool bOverdue = FPlatformTime::Seconds() - GetOldestScheduledTime() >= Config.MaxDeferralSeconds;
+		const bool bFrameOverTarget = FrameTargetSeconds > 0.0 && FrameElapsedSeconds > FrameTargetSeconds;
+		if ((bFrameOverTarget || InlineCycles >= BudgetCycles) && !bOverdue)
+		{
+			FHelikaMetricsCounters::Add(EHelikaCounter::WorkDeferrals);
+		}
+		else
+		{
+			HELIKA_TRACE_SCOPE("ScheduledWork");
+			FHelikaGameThreadScope GameThreadScope;
+
+			// Overdue work makes progress even without budget, one item at a time
+			DeadlineCycles = StartCycles + (BudgetCycles > InlineCycles ? BudgetCycles - InlineCycles : 0);
+			do
+			{
+				RunNext();
+			}
+			while (HasBudget() && !IsEmpty());
+			DeadlineCycles = MAX_uint64;
+		}
+	}
+
+	const uint64 TotalCycles = FHelikaMetricsCounters::GetGameThreadTotalCycles();
+	const uint64 FrameCycles = TotalCycles - TotalCyclesAfterTick;
+	TotalCyclesAfterTick = TotalCycles;
+	if (FrameCycles > BudgetCycles)
+	{
+		FHelikaMetricsCounters::Add(EHelikaCounter::BudgetOverruns);
+		UE_LOG(LogHelika, Verbose, TEXT("Helika used %.0f us of game thread time this frame, over its budget of %d us"), FPlatformTime::ToMilliseconds64(FrameCycles) * 1000.0, Config.BudgetMicroseconds);
+	}
+}
+
+void FHelikaScheduler::RunAll()
+{
+	HELIKA_TRACE_SCOPE("ScheduledWork");
+	while (RunNext())
+	{
+	}
+}
+
+bool FHelikaScheduler::HasBudget() const
+{
+	return FPlatformTime::Cycles64() < DeadlineCycles;
+}
+
+bool FHelikaScheduler::IsEmpty() const
+{
+	return !Current.IsSet() && NumIncoming.load(std::memory_order_relaxed) == 0;
+}
+
+double FHelikaScheduler::GetFrameElapsedSeconds()
+{
+	if (IsRunningCommandlet() || FApp::UseFixedTimeStep())
+	{
+		return 0.0;
+	}
+	// The core ticker runs after the world tick, the frame started at FApp::GetCurrentTime
+	return FMath::Max(FPlatformTime::Seconds() - FApp::GetCurrentTime(), 0.0);
+}
+
+bool FHelikaScheduler::RunNext()
+{
+	if (!Current.IsSet())
+	{
+		FItem Item;
+		if (!Incoming.Dequeue(Item))
+		{
+			return false;
+		}
+		NumIncoming.fetch_sub(1, std::memory_order_relaxed);
+		Current.Emplace(MoveTemp(Item));
+	}
+
+	// Work may schedule more work, it goes behind the current item
+	if (Current->Work())
+	{
+		Current.Reset();
+	}
+	return true;
+}
+
+double FHelikaScheduler::GetOldestScheduledTime()
+{
+	if (Current.IsSet())
+	{
+		return Current->ScheduledTime;
+	}
+	const FItem* Next = Incoming.Peek();
+	return Next != nullptr ? Next->ScheduledTime : FPlatformTime::Seconds();
+}
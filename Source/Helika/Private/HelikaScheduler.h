@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HelikaConfigSnapshot.h"
+#include <atomic>
+
+/**
+ * Runs the deferred SDK work (lane flushes, session events, spilled batch uploads, game metrics summaries)
+ * on the game thread under a per-frame time budget, so a burst of SDK calls never turns into a hitch.
+ *
+ * Work is scheduled from any thread and runs in order from the core ticker. The budget covers every SDK call
+ * on the game thread since the previous tick, so inline capture work leaves less room for deferred work.
+ * While the frame is already over its target, work waits unless it has been waiting for MaxDeferralSeconds.
+ * Frames whose SDK time exceeds the budget are counted as BudgetOverruns.
+ */
+class FHelikaScheduler
+{
+public:
+	/// Returns true once done, false only when HasBudget turned false and the rest should continue in a later tick
+	typedef TUniqueFunction<bool()> FWork;
+
+	/// Game thread
+	void Configure(const FHelikaSchedulerConfig& InConfig);
+
+	/// Thread safe
+	void Schedule(FWork&& Work);
+
+	/// Game thread, once per frame. FrameElapsedSeconds is how long the current frame has already taken.
+	void Tick(double FrameElapsedSeconds);
+
+	/// Game thread, runs every scheduled work to completion regardless of the budget
+	void RunAll();
+
+	/// Whether work running in Tick may continue, always true outside of Tick
+	bool HasBudget() const;
+
+	bool IsEmpty() const;
+
+	/// Time the current frame has taken so far, 0 where it is not meaningful (commandlets, fixed time step)
+	static double GetFrameElapsedSeconds();
+
+private:
+	struct FItem
+	{
+		FWork Work;
+		double ScheduledTime = 0.0;
+	};
+
+	/// Runs the next item once, returns false when there was nothing to run
+	bool RunNext();
+
+	/// Game thread only
+	double GetOldestScheduledTime();
+
+	FHelikaSchedulerConfig Config;
+
+	TQueue<FItem, EQueueMode::Mpsc> Incoming;
+	std::atomic<int32> NumIncoming{0};
+	/// Work that asked to continue, it runs before anything scheduled after it
+	TOptional<FItem> Current;
+
+	uint64 DeadlineCycles = MAX_uint64;
+	uint64 TotalCyclesAfterTick = 0;
+};
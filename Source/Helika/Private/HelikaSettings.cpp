@@ -1,5 +1,13 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-
-#include "HelikaSettings.h"
-
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaSettings.h"
+
+#if WITH_EDITOR
+void UHelikaSettings::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	OnSettingsChanged.Broadcast();
+}
+#endif
@@ -0,0 +1,446 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaSha256.h"
+
+#include <atomic>
+#include <openssl/sha.h>
+
+#if PLATFORM_CPU_X86_FAMILY
+#define HELIKA_SHA256_X86 1
+#include <immintrin.h>
+#if PLATFORM_WINDOWS
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define HELIKA_SHA256_X86 0
+#endif
+
+// The SHA and AVX2 kernels are only compiled for the functions that use them
+#if HELIKA_SHA256_X86 && (defined(__clang__) || defined(__GNUC__))
+#define HELIKA_TARGET_SHA __attribute__((target("sha,sse4.1")))
+#define HELIKA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HELIKA_TARGET_SHA
+#define HELIKA_TARGET_AVX2
+#endif
+
+const uint32 FHelikaSha256::InitialState[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+namespace HelikaSha256
+{
+	constexpr int32 BlockBytes = 64;
+	constexpr int32 NumLanes = 8;
+
+	alignas(16) static const uint32 RoundConstants[64] = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+	};
+
+	/// NumBlocks blocks of one message into State
+	typedef void (*FCompress)(uint32* State, const uint8* Blocks, int32 NumBlocks);
+	/// NumBlocks blocks of eight messages into their states
+	typedef void (*FCompress8)(uint32* const* States, const uint8* const* Blocks, int32 NumBlocks);
+
+	struct FKernelTable
+	{
+		EHelikaSha256Kernel Kernel;
+		FCompress Compress;
+		/// Null for kernels that hash one message at a time
+		FCompress8 Compress8;
+	};
+
+	static void CompressOpenSSL(uint32* State, const uint8* Blocks, int32 NumBlocks)
+	{
+		SHA256_CTX Context;
+		static_assert(sizeof(Context.h) == sizeof(uint32) * 8, "OpenSSL keeps the state as eight 32-bit words");
+		FMemory::Memcpy(Context.h, State, sizeof(Context.h));
+		for (int32 Block = 0; Block < NumBlocks; ++Block)
+		{
+			SHA256_Transform(&Context, Blocks + Block * BlockBytes);
+		}
+		FMemory::Memcpy(State, Context.h, sizeof(Context.h));
+	}
+
+#if HELIKA_SHA256_X86
+	static bool HasShaExtensions()
+	{
+		// SHA (leaf 7 EBX bit 29), with SSSE3 (leaf 1 ECX bit 9) and SSE4.1 (bit 19) for the shuffles around it
+#if PLATFORM_WINDOWS
+		int32 Info[4];
+		__cpuid(Info, 0);
+		if (Info[0] < 7)
+		{
+			return false;
+		}
+		__cpuidex(Info, 1, 0);
+		const uint32 Features = static_cast<uint32>(Info[2]);
+		__cpuidex(Info, 7, 0);
+		const uint32 ExtendedFeatures = static_cast<uint32>(Info[1]);
+#else
+		if (__get_cpuid_max(0, nullptr) < 7)
+		{
+			return false;
+		}
+		uint32 Eax, Ebx, Ecx, Edx;
+		__cpuid_count(1, 0, Eax, Ebx, Ecx, Edx);
+		const uint32 Features = Ecx;
+		__cpuid_count(7, 0, Eax, Ebx, Ecx, Edx);
+		const uint32 ExtendedFeatures = Ebx;
+#endif
+		return (Features & (1u << 9)) != 0 && (Features & (1u << 19)) != 0 && (ExtendedFeatures & (1u << 29)) != 0;
+	}
+
+	HELIKA_TARGET_SHA static void CompressSHANI(uint32* State, const uint8* Blocks, int32 NumBlocks)
+	{
+		const __m128i ByteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bll, 0x0405060700010203ll);
+
+		// The instructions work on the ABEF and CDGH halves of the state
+		__m128i Temp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(State)), 0xB1);
+		__m128i State1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(State + 4)), 0x1B);
+		__m128i State0 = _mm_alignr_epi8(Temp, State1, 8);
+		State1 = _mm_blend_epi16(State1, Temp, 0xF0);
+
+		for (int32 Block = 0; Block < NumBlocks; ++Block)
+		{
+			const uint8* Data = Blocks + Block * BlockBytes;
+			const __m128i SavedState0 = State0;
+			const __m128i SavedState1 = State1;
+
+			// Four rounds per group, the schedule of the next groups is computed alongside
+			__m128i Schedule[4];
+			for (int32 Index = 0; Index < 4; ++Index)
+			{
+				Schedule[Index] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + Index * 16)), ByteSwap);
+			}
+			for (int32 Group = 0; Group < 16; ++Group)
+			{
+				__m128i Message = _mm_add_epi32(Schedule[Group & 3], _mm_load_si128(reinterpret_cast<const __m128i*>(RoundConstants + Group * 4)));
+				State1 = _mm_sha256rnds2_epu32(State1, State0, Message);
+				if (Group >= 3 && Group <= 14)
+				{
+					__m128i& Next = Schedule[(Group + 1) & 3];
+					Next = _mm_add_epi32(Next, _mm_alignr_epi8(Schedule[Group & 3], Schedule[(Group - 1) & 3], 4));
+					Next = _mm_sha256msg2_epu32(Next, Schedule[Group & 3]);
+				}
+				Message = _mm_shuffle_epi32(Message, 0x0E);
+				State0 = _mm_sha256rnds2_epu32(State0, State1, Message);
+				if (Group >= 1 && Group <= 12)
+				{
+					Schedule[(Group - 1) & 3] = _mm_sha256msg1_epu32(Schedule[(Group - 1) & 3], Schedule[Group & 3]);
+				}
+			}
+
+			State0 = _mm_add_epi32(State0, SavedState0);
+			State1 = _mm_add_epi32(State1, SavedState1);
+		}
+
+		Temp = _mm_shuffle_epi32(State0, 0x1B);
+		State1 = _mm_shuffle_epi32(State1, 0xB1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(State), _mm_blend_epi16(Temp, State1, 0xF0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(State + 4), _mm_alignr_epi8(State1, Temp, 8));
+	}
+
+	HELIKA_TARGET_AVX2 static FORCEINLINE __m256i RotateRight(__m256i Value, int32 Bits)
+	{
+		return _mm256_or_si256(_mm256_srli_epi32(Value, Bits), _mm256_slli_epi32(Value, 32 - Bits));
+	}
+
+	/// Word Index of every lane, byte swapped, from eight 32-byte rows
+	HELIKA_TARGET_AVX2 static void LoadTransposed(const uint8* const* Rows, int32 Offset, __m256i* OutWords)
+	{
+		const __m256i ByteSwap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+		__m256i Row[NumLanes];
+		for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+		{
+			Row[Lane] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Rows[Lane] + Offset));
+		}
+
+		// 8x8 transpose of 32-bit words: pairs, then quads within each 128-bit half, then the halves
+		const __m256i T0 = _mm256_unpacklo_epi32(Row[0], Row[1]);
+		const __m256i T1 = _mm256_unpackhi_epi32(Row[0], Row[1]);
+		const __m256i T2 = _mm256_unpacklo_epi32(Row[2], Row[3]);
+		const __m256i T3 = _mm256_unpackhi_epi32(Row[2], Row[3]);
+		const __m256i T4 = _mm256_unpacklo_epi32(Row[4], Row[5]);
+		const __m256i T5 = _mm256_unpackhi_epi32(Row[4], Row[5]);
+		const __m256i T6 = _mm256_unpacklo_epi32(Row[6], Row[7]);
+		const __m256i T7 = _mm256_unpackhi_epi32(Row[6], Row[7]);
+
+		const __m256i U0 = _mm256_unpacklo_epi64(T0, T2);
+		const __m256i U1 = _mm256_unpackhi_epi64(T0, T2);
+		const __m256i U2 = _mm256_unpacklo_epi64(T1, T3);
+		const __m256i U3 = _mm256_unpackhi_epi64(T1, T3);
+		const __m256i U4 = _mm256_unpacklo_epi64(T4, T6);
+		const __m256i U5 = _mm256_unpackhi_epi64(T4, T6);
+		const __m256i U6 = _mm256_unpacklo_epi64(T5, T7);
+		const __m256i U7 = _mm256_unpackhi_epi64(T5, T7);
+
+		OutWords[0] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(U0, U4, 0x20), ByteSwap);
+		OutWords[1] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(U1, U5, 0x20), ByteSwap);
+		OutWords[2] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(U2, U6, 0x20), ByteSwap);
+		OutWords[3] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(U3, U7, 0x20), ByteSwap);
+		OutWords[4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(U0, U4, 0x31), ByteSwap);
+		OutWords[5] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(U1, U5, 0x31), ByteSwap);
+		OutWords[6] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(U2, U6, 0x31), ByteSwap);
+		OutWords[7] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(U3, U7, 0x31), ByteSwap);
+	}
+
+	HELIKA_TARGET_AVX2 static void Compress8AVX2(uint32* const* States, const uint8* const* Blocks, int32 NumBlocks)
+	{
+		// Lane L of vector W holds word W of message L
+		__m256i Hash[8];
+		for (int32 Word = 0; Word < 8; ++Word)
+		{
+			Hash[Word] = _mm256_set_epi32(States[7][Word], States[6][Word], States[5][Word], States[4][Word], States[3][Word], States[2][Word], States[1][Word], States[0][Word]);
+		}
+
+		for (int32 Block = 0; Block < NumBlocks; ++Block)
+		{
+			__m256i Schedule[16];
+			LoadTransposed(Blocks, Block * BlockBytes, Schedule);
+			LoadTransposed(Blocks, Block * BlockBytes + 32, Schedule + 8);
+
+			__m256i A = Hash[0], B = Hash[1], C = Hash[2], D = Hash[3], E = Hash[4], F = Hash[5], G = Hash[6], H = Hash[7];
+			for (int32 Round = 0; Round < 64; ++Round)
+			{
+				if (Round >= 16)
+				{
+					const __m256i W15 = Schedule[(Round - 15) & 15];
+					const __m256i W2 = Schedule[(Round - 2) & 15];
+					const __m256i Sigma0 = _mm256_xor_si256(_mm256_xor_si256(RotateRight(W15, 7), RotateRight(W15, 18)), _mm256_srli_epi32(W15, 3));
+					const __m256i Sigma1 = _mm256_xor_si256(_mm256_xor_si256(RotateRight(W2, 17), RotateRight(W2, 19)), _mm256_srli_epi32(W2, 10));
+					Schedule[Round & 15] = _mm256_add_epi32(_mm256_add_epi32(Schedule[Round & 15], Sigma0), _mm256_add_epi32(Schedule[(Round - 7) & 15], Sigma1));
+				}
+
+				const __m256i Sum1 = _mm256_xor_si256(_mm256_xor_si256(RotateRight(E, 6), RotateRight(E, 11)), RotateRight(E, 25));
+				const __m256i Choice = _mm256_xor_si256(_mm256_and_si256(E, F), _mm256_andnot_si256(E, G));
+				const __m256i Temp1 = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(H, Sum1), _mm256_add_epi32(Choice, _mm256_set1_epi32(static_cast<int32>(RoundConstants[Round])))), Schedule[Round & 15]);
+				const __m256i Sum0 = _mm256_xor_si256(_mm256_xor_si256(RotateRight(A, 2), RotateRight(A, 13)), RotateRight(A, 22));
+				const __m256i Majority = _mm256_or_si256(_mm256_and_si256(A, B), _mm256_and_si256(C, _mm256_or_si256(A, B)));
+				const __m256i Temp2 = _mm256_add_epi32(Sum0, Majority);
+
+				H = G;
+				G = F;
+				F = E;
+				E = _mm256_add_epi32(D, Temp1);
+				D = C;
+				C = B;
+				B = A;
+				A = _mm256_add_epi32(Temp1, Temp2);
+			}
+
+			Hash[0] = _mm256_add_epi32(Hash[0], A);
+			Hash[1] = _mm256_add_epi32(Hash[1], B);
+			Hash[2] = _mm256_add_epi32(Hash[2], C);
+			Hash[3] = _mm256_add_epi32(Hash[3], D);
+			Hash[4] = _mm256_add_epi32(Hash[4], E);
+			Hash[5] = _mm256_add_epi32(Hash[5], F);
+			Hash[6] = _mm256_add_epi32(Hash[6], G);
+			Hash[7] = _mm256_add_epi32(Hash[7], H);
+		}
+
+		for (int32 Word = 0; Word < 8; ++Word)
+		{
+			alignas(32) uint32 Lanes[NumLanes];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(Lanes), Hash[Word]);
+			for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+			{
+				States[Lane][Word] = Lanes[Lane];
+			}
+		}
+	}
+#endif
+
+	static const FKernelTable* FindTable(EHelikaSha256Kernel Kernel)
+	{
+		static const FKernelTable OpenSSL{EHelikaSha256Kernel::OpenSSL, &CompressOpenSSL, nullptr};
+#if HELIKA_SHA256_X86
+		static const FKernelTable SHANI{EHelikaSha256Kernel::SHANI, &CompressSHANI, nullptr};
+		// Fewer than eight messages of a length are left to OpenSSL
+		static const FKernelTable AVX2{EHelikaSha256Kernel::AVX2, &CompressOpenSSL, &Compress8AVX2};
+		static const bool bHasShaExtensions = HasShaExtensions();
+		static const bool bHasAVX2 = FPlatformMisc::HasAVX2InstructionSupport();
+#endif
+
+		switch (Kernel)
+		{
+		case EHelikaSha256Kernel::OpenSSL:
+			return &OpenSSL;
+#if HELIKA_SHA256_X86
+		case EHelikaSha256Kernel::SHANI:
+			return bHasShaExtensions ? &SHANI : nullptr;
+		case EHelikaSha256Kernel::AVX2:
+			return bHasAVX2 ? &AVX2 : nullptr;
+#endif
+		default:
+			return nullptr;
+		}
+	}
+
+	/// The SHA extensions beat eight AVX2 lanes wherever both exist
+	static const FKernelTable& FindBestTable()
+	{
+		for (const EHelikaSha256Kernel Kernel : {EHelikaSha256Kernel::SHANI, EHelikaSha256Kernel::AVX2})
+		{
+			if (const FKernelTable* Table = FindTable(Kernel))
+			{
+				return *Table;
+			}
+		}
+		return *FindTable(EHelikaSha256Kernel::OpenSSL);
+	}
+
+	/// Picked on first use
+	static std::atomic<const FKernelTable*> ActiveTable{nullptr};
+
+	static const FKernelTable& GetActiveTable()
+	{
+		const FKernelTable* Table = ActiveTable.load(std::memory_order_acquire);
+		if (Table == nullptr)
+		{
+			Table = &FindBestTable();
+			ActiveTable.store(Table, std::memory_order_release);
+		}
+		return *Table;
+	}
+}
+
+int32 FHelikaSha256::AppendPadded(TArray<uint8>& Out, TConstArrayView<uint8> Data, int64 PrefixBytes)
+{
+	using namespace HelikaSha256;
+
+	// The 0x80 marker and the 64-bit length follow the data, zeros fill the last block
+	const int32 NumBlocks = (Data.Num() + 1 + 8 + BlockBytes - 1) / BlockBytes;
+	const int32 Start = Out.Num();
+	Out.AddZeroed(NumBlocks * BlockBytes);
+	uint8* Blocks = Out.GetData() + Start;
+	if (Data.Num() > 0)
+	{
+		FMemory::Memcpy(Blocks, Data.GetData(), Data.Num());
+	}
+	Blocks[Data.Num()] = 0x80;
+
+	const uint64 NumBits = static_cast<uint64>(PrefixBytes + Data.Num()) * 8;
+	for (int32 Byte = 0; Byte < 8; ++Byte)
+	{
+		Blocks[NumBlocks * BlockBytes - 1 - Byte] = static_cast<uint8>(NumBits >> (Byte * 8));
+	}
+	return NumBlocks;
+}
+
+void FHelikaSha256::HashBlocks(TConstArrayView<FHelikaSha256Message> Messages, const uint32 (&Start)[8], uint32* OutStates)
+{
+	using namespace HelikaSha256;
+
+	for (int32 Index = 0; Index < Messages.Num(); ++Index)
+	{
+		FMemory::Memcpy(OutStates + Index * 8, Start, sizeof(Start));
+	}
+
+	const FKernelTable& Kernels = GetActiveTable();
+	if (Kernels.Compress8 == nullptr)
+	{
+		for (int32 Index = 0; Index < Messages.Num(); ++Index)
+		{
+			Kernels.Compress(OutStates + Index * 8, Messages[Index].Blocks, Messages[Index].NumBlocks);
+		}
+		return;
+	}
+
+	// Lanes are filled with messages of the same length, most identifiers fit in one block
+	TArray<int32> Order;
+	Order.Reserve(Messages.Num());
+	for (int32 Index = 0; Index < Messages.Num(); ++Index)
+	{
+		Order.Add(Index);
+	}
+	Order.StableSort([&Messages](int32 A, int32 B) { return Messages[A].NumBlocks < Messages[B].NumBlocks; });
+
+	int32 First = 0;
+	while (First < Order.Num())
+	{
+		const int32 NumBlocks = Messages[Order[First]].NumBlocks;
+		int32 Last = First + 1;
+		while (Last < Order.Num() && Last - First < NumLanes && Messages[Order[Last]].NumBlocks == NumBlocks)
+		{
+			++Last;
+		}
+
+		if (Last - First == NumLanes)
+		{
+			uint32* States[NumLanes];
+			const uint8* Blocks[NumLanes];
+			for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+			{
+				States[Lane] = OutStates + Order[First + Lane] * 8;
+				Blocks[Lane] = Messages[Order[First + Lane]].Blocks;
+			}
+			Kernels.Compress8(States, Blocks, NumBlocks);
+		}
+		else
+		{
+			for (int32 Index = First; Index < Last; ++Index)
+			{
+				Kernels.Compress(OutStates + Order[Index] * 8, Messages[Order[Index]].Blocks, NumBlocks);
+			}
+		}
+		First = Last;
+	}
+}
+
+void FHelikaSha256::GetDigest(const uint32* State, uint8 (&OutDigest)[32])
+{
+	for (int32 Word = 0; Word < 8; ++Word)
+	{
+		OutDigest[Word * 4] = static_cast<uint8>(State[Word] >> 24);
+		OutDigest[Word * 4 + 1] = static_cast<uint8>(State[Word] >> 16);
+		OutDigest[Word * 4 + 2] = static_cast<uint8>(State[Word] >> 8);
+		OutDigest[Word * 4 + 3] = static_cast<uint8>(State[Word]);
+	}
+}
+
+EHelikaSha256Kernel FHelikaSha256::GetKernel()
+{
+	return HelikaSha256::GetActiveTable().Kernel;
+}
+
+bool FHelikaSha256::SetKernel(EHelikaSha256Kernel Kernel)
+{
+	const HelikaSha256::FKernelTable* Table = HelikaSha256::FindTable(Kernel);
+	if (Table == nullptr)
+	{
+		return false;
+	}
+	HelikaSha256::ActiveTable.store(Table, std::memory_order_release);
+	return true;
+}
+
+void FHelikaSha256::ResetKernel()
+{
+	HelikaSha256::ActiveTable.store(&HelikaSha256::FindBestTable(), std::memory_order_release);
+}
+
+bool FHelikaSha256::IsSupported(EHelikaSha256Kernel Kernel)
+{
+	return HelikaSha256::FindTable(Kernel) != nullptr;
+}
+
+const TCHAR* FHelikaSha256::LexToString(EHelikaSha256Kernel Kernel)
+{
+	switch (Kernel)
+	{
+	case EHelikaSha256Kernel::OpenSSL: return TEXT("OpenSSL");
+	case EHelikaSha256Kernel::SHANI: return TEXT("SHANI");
+	case EHelikaSha256Kernel::AVX2: return TEXT("AVX2");
+	default: return TEXT("Unknown");
+	}
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// Implementation of the SHA-256 compression function
+enum class EHelikaSha256Kernel : uint8
+{
+	/// SHA256_Transform of the engine's OpenSSL, one message at a time
+	OpenSSL,
+	/// x86 SHA extensions, one message at a time
+	SHANI,
+	/// Eight messages of the same length side by side in AVX2 registers
+	AVX2,
+	Num
+};
+
+/// Message padded to whole 64-byte blocks
+struct FHelikaSha256Message
+{
+	const uint8* Blocks = nullptr;
+	int32 NumBlocks = 0;
+};
+
+/**
+ * Block level SHA-256 for FHelikaHasher. Messages are padded up front so that the kernels only ever see whole blocks,
+ * which lets a keyed hash start from a precomputed state and lets messages of the same length be hashed side by side.
+ */
+class FHelikaSha256
+{
+public:
+	static const uint32 InitialState[8];
+
+	/// Appends Data padded to whole blocks, PrefixBytes is what already went through the state the message starts from.
+	/// Returns the number of blocks appended.
+	static int32 AppendPadded(TArray<uint8>& Out, TConstArrayView<uint8> Data, int64 PrefixBytes = 0);
+
+	/// Runs every message through the compression function from Start, OutStates gets 8 words per message
+	static void HashBlocks(TConstArrayView<FHelikaSha256Message> Messages, const uint32 (&Start)[8], uint32* OutStates);
+
+	/// Big endian digest of a final state
+	static void GetDigest(const uint32* State, uint8 (&OutDigest)[32]);
+
+	/// Kernel used by HashBlocks, the fastest one available unless overridden
+	static EHelikaSha256Kernel GetKernel();
+
+	/// Forces a kernel for tests and benchmarks, false when this build or CPU lacks it
+	static bool SetKernel(EHelikaSha256Kernel Kernel);
+
+	/// Goes back to the fastest available kernel
+	static void ResetKernel();
+
+	static bool IsSupported(EHelikaSha256Kernel Kernel);
+
+	static const TCHAR* LexToString(EHelikaSha256Kernel Kernel);
+};
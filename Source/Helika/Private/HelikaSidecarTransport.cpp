@@ -0,0 +1,307 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaSidecarTransport.h"
+
+#include "HelikaDefines.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/Paths.h"
+
+#if HELIKA_WITH_SIDECAR
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/sockios.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace HelikaSidecar
+{
+	static void WriteUInt32(TArray<uint8>& Out, uint32 Value)
+	{
+		Out.Add(static_cast<uint8>(Value));
+		Out.Add(static_cast<uint8>(Value >> 8));
+		Out.Add(static_cast<uint8>(Value >> 16));
+		Out.Add(static_cast<uint8>(Value >> 24));
+	}
+
+	static uint32 ReadUInt32(const uint8* Data)
+	{
+		return Data[0] | (Data[1] << 8) | (Data[2] << 16) | (static_cast<uint32>(Data[3]) << 24);
+	}
+
+	static void WriteLine(TArray<uint8>& Out, const FString& Line)
+	{
+		const FTCHARToUTF8 Converted(*Line);
+		Out.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+		Out.Add('\n');
+	}
+
+#if HELIKA_WITH_SIDECAR
+	/// Socket buffer requested so that a full batch usually fits one write, the kernel caps it at wmem_max
+	static constexpr int32 SendBufferBytes = 4 << 20;
+	static constexpr double ReconnectIntervalSeconds = 1.0;
+	/// Status of a frame the aggregator took over
+	static constexpr int32 AcceptedStatus = 202;
+#endif
+}
+
+void FHelikaSidecarFrame::WriteHeader(const FHelikaTransportRequest& Request, TArray<uint8>& OutHeader)
+{
+	TArray<uint8> Text;
+	HelikaSidecar::WriteLine(Text, TEXT("POST ") + Request.Url);
+	for (const TPair<FString, FString>& Header : Request.Headers)
+	{
+		HelikaSidecar::WriteLine(Text, Header.Key + TEXT(": ") + Header.Value);
+	}
+
+	OutHeader.Reset(PrefixBytes + Text.Num());
+	HelikaSidecar::WriteUInt32(OutHeader, Magic);
+	HelikaSidecar::WriteUInt32(OutHeader, Text.Num());
+	HelikaSidecar::WriteUInt32(OutHeader, Request.Body.Num());
+	OutHeader.Append(Text);
+}
+
+int32 FHelikaSidecarFrame::Parse(TConstArrayView<uint8> Buffer, FHelikaSidecarFrame& OutFrame)
+{
+	if (Buffer.Num() < PrefixBytes)
+	{
+		return 0;
+	}
+
+	const uint32 HeaderBytes = HelikaSidecar::ReadUInt32(Buffer.GetData() + 4);
+	const uint32 BodyBytes = HelikaSidecar::ReadUInt32(Buffer.GetData() + 8);
+	if (HelikaSidecar::ReadUInt32(Buffer.GetData()) != Magic || HeaderBytes > static_cast<uint32>(MaxHeaderBytes) || BodyBytes > static_cast<uint32>(MaxBodyBytes))
+	{
+		return INDEX_NONE;
+	}
+	const int32 FrameBytes = PrefixBytes + static_cast<int32>(HeaderBytes) + static_cast<int32>(BodyBytes);
+	if (Buffer.Num() < FrameBytes)
+	{
+		return 0;
+	}
+
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Buffer.GetData() + PrefixBytes), static_cast<int32>(HeaderBytes));
+	TArray<FString> Lines;
+	FString(Converted.Length(), Converted.Get()).ParseIntoArray(Lines, TEXT("\n"));
+	if (Lines.Num() == 0 || !Lines[0].StartsWith(TEXT("POST ")))
+	{
+		return INDEX_NONE;
+	}
+
+	OutFrame.Url = Lines[0].Mid(5);
+	OutFrame.Headers.Reset();
+	for (int32 Index = 1; Index < Lines.Num(); ++Index)
+	{
+		FString Name;
+		FString Value;
+		if (!Lines[Index].Split(TEXT(": "), &Name, &Value))
+		{
+			return INDEX_NONE;
+		}
+		OutFrame.Headers.Emplace(MoveTemp(Name), MoveTemp(Value));
+	}
+	OutFrame.Body = Buffer.Slice(PrefixBytes + static_cast<int32>(HeaderBytes), static_cast<int32>(BodyBytes));
+	return FrameBytes;
+}
+
+FString FHelikaSidecarFrame::GetDefaultSocketPath()
+{
+	// Any user of the host could take over or squat a socket in a shared directory such as /tmp
+	const FString RuntimeDirectory = FPlatformMisc::GetEnvironmentVariable(TEXT("XDG_RUNTIME_DIR"));
+	if (!RuntimeDirectory.IsEmpty())
+	{
+		return RuntimeDirectory / TEXT("helika-aggregator.sock");
+	}
+	return FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("Helika") / TEXT("Sidecar") / TEXT("aggregator.sock"));
+}
+
+#if HELIKA_WITH_SIDECAR
+bool FHelikaSidecarFrame::IsSameUser(int32 Socket)
+{
+	ucred Credentials;
+	socklen_t CredentialsBytes = sizeof(Credentials);
+	return getsockopt(Socket, SOL_SOCKET, SO_PEERCRED, &Credentials, &CredentialsBytes) == 0 && Credentials.uid == geteuid();
+}
+#endif
+
+#if HELIKA_WITH_SIDECAR
+
+FHelikaSidecarTransport::FHelikaSidecarTransport(const FHelikaTransportConfig& InConfig)
+	: SocketPath(InConfig.SidecarSocketPath.IsEmpty() ? FHelikaSidecarFrame::GetDefaultSocketPath() : InConfig.SidecarSocketPath)
+	, TimeoutSeconds(InConfig.TimeoutSeconds > 0.f ? InConfig.TimeoutSeconds : 30.f)
+{
+}
+
+FHelikaSidecarTransport::~FHelikaSidecarTransport()
+{
+	Close();
+}
+
+void FHelikaSidecarTransport::Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete)
+{
+	FHelikaTransportResponse Response;
+	if (Request.Verb == TEXT("HEAD"))
+	{
+		FScopeLock ScopeLock(&Lock);
+		Response.bConnected = EnsureConnected(Response.Error);
+		Response.Status = Response.bConnected ? 200 : 0;
+	}
+	else
+	{
+		TArray<uint8> Header;
+		FHelikaSidecarFrame::WriteHeader(Request, Header);
+
+		FScopeLock ScopeLock(&Lock);
+		if (EnsureConnected(Response.Error))
+		{
+			switch (WriteFrame(Header, Request.Body, Request.TimeoutSeconds > 0.f ? Request.TimeoutSeconds : TimeoutSeconds, Response.Error))
+			{
+			case EWriteResult::Written:
+				Response.bConnected = true;
+				Response.Status = HelikaSidecar::AcceptedStatus;
+				break;
+			case EWriteResult::Busy:
+				Response.bConnected = true;
+				Response.Status = 503;
+				Response.RetryAfterSeconds = 1;
+				break;
+			default:
+				Close();
+				break;
+			}
+		}
+	}
+
+	// Completions may send again, they run without the lock
+	OnComplete(MoveTemp(Response));
+}
+
+bool FHelikaSidecarTransport::EnsureConnected(FString& OutError)
+{
+	if (Socket >= 0)
+	{
+		return true;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now < NextConnectTime)
+	{
+		OutError = FString::Printf(TEXT("No aggregator at %s"), *SocketPath);
+		return false;
+	}
+	NextConnectTime = Now + HelikaSidecar::ReconnectIntervalSeconds;
+
+	sockaddr_un Address;
+	FMemory::Memzero(Address);
+	Address.sun_family = AF_UNIX;
+	const FTCHARToUTF8 Path(*SocketPath);
+	if (Path.Length() >= static_cast<int32>(sizeof(Address.sun_path)))
+	{
+		OutError = FString::Printf(TEXT("Socket path %s is too long"), *SocketPath);
+		return false;
+	}
+	FMemory::Memcpy(Address.sun_path, Path.Get(), Path.Length());
+
+	Socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (Socket < 0 || connect(Socket, reinterpret_cast<const sockaddr*>(&Address), sizeof(Address)) != 0)
+	{
+		OutError = FString::Printf(TEXT("No aggregator at %s (%s)"), *SocketPath, UTF8_TO_TCHAR(strerror(errno)));
+		Close();
+		return false;
+	}
+	if (!FHelikaSidecarFrame::IsSameUser(Socket))
+	{
+		// Uploads carry the API key, they only go to an aggregator of this user
+		OutError = FString::Printf(TEXT("Aggregator at %s runs as another user"), *SocketPath);
+		Close();
+		return false;
+	}
+
+	setsockopt(Socket, SOL_SOCKET, SO_SNDBUF, &HelikaSidecar::SendBufferBytes, sizeof(HelikaSidecar::SendBufferBytes));
+	socklen_t OptionBytes = sizeof(SendBufferSize);
+	getsockopt(Socket, SOL_SOCKET, SO_SNDBUF, &SendBufferSize, &OptionBytes);
+	fcntl(Socket, F_SETFL, fcntl(Socket, F_GETFL) | O_NONBLOCK);
+	UE_LOG(LogHelika, Log, TEXT("Helika uploads go to the aggregator at %s"), *SocketPath);
+	return true;
+}
+
+FHelikaSidecarTransport::EWriteResult FHelikaSidecarTransport::WriteFrame(const TArray<uint8>& Header, const TArray<uint8>& Body, float InTimeoutSeconds, FString& OutError)
+{
+	iovec Parts[2];
+	Parts[0].iov_base = const_cast<uint8*>(Header.GetData());
+	Parts[0].iov_len = Header.Num();
+	Parts[1].iov_base = const_cast<uint8*>(Body.GetData());
+	Parts[1].iov_len = Body.Num();
+	const size_t TotalBytes = Header.Num() + Body.Num();
+
+	msghdr Message;
+	FMemory::Memzero(Message);
+	Message.msg_iov = Parts;
+	Message.msg_iovlen = Body.Num() > 0 ? 2 : 1;
+
+	// A frame that does not fit the free buffer would have to wait for the aggregator, the lane backs off instead.
+	// Batches are capped at MaxGameBatchBytes so that a frame fits the buffer once it drained
+	int Queued = 0;
+	if (ioctl(Socket, SIOCOUTQ, &Queued) == 0 && Queued > 0 && static_cast<int64>(SendBufferSize) - Queued < static_cast<int64>(TotalBytes))
+	{
+		return EWriteResult::Busy;
+	}
+
+	// Usually the whole frame goes out with this one call
+	ssize_t Written = sendmsg(Socket, &Message, MSG_NOSIGNAL | MSG_DONTWAIT);
+	if (Written < 0)
+	{
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			return EWriteResult::Busy;
+		}
+		OutError = FString::Printf(TEXT("Aggregator connection lost (%s)"), UTF8_TO_TCHAR(strerror(errno)));
+		return EWriteResult::Failed;
+	}
+
+	// A frame cut short would corrupt the stream, the rest has to follow
+	size_t Sent = static_cast<size_t>(Written);
+	const double Deadline = FPlatformTime::Seconds() + InTimeoutSeconds;
+	while (Sent < TotalBytes)
+	{
+		const size_t Offset = Sent < Parts[0].iov_len ? Sent : Sent - Parts[0].iov_len;
+		const iovec& Part = Sent < Parts[0].iov_len ? Parts[0] : Parts[1];
+		Written = send(Socket, static_cast<const uint8*>(Part.iov_base) + Offset, Part.iov_len - Offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if (Written >= 0)
+		{
+			Sent += Written;
+			continue;
+		}
+		if (errno != EAGAIN && errno != EWOULDBLOCK)
+		{
+			OutError = FString::Printf(TEXT("Aggregator connection lost (%s)"), UTF8_TO_TCHAR(strerror(errno)));
+			return EWriteResult::Failed;
+		}
+
+		const double Remaining = Deadline - FPlatformTime::Seconds();
+		pollfd Poll = {Socket, POLLOUT, 0};
+		if (Remaining <= 0.0 || poll(&Poll, 1, static_cast<int>(Remaining * 1000.0)) <= 0)
+		{
+			OutError = TEXT("Aggregator stopped reading in the middle of a frame");
+			return EWriteResult::Failed;
+		}
+	}
+	return EWriteResult::Written;
+}
+
+void FHelikaSidecarTransport::Close()
+{
+	if (Socket >= 0)
+	{
+		close(Socket);
+		Socket = -1;
+	}
+}
+
+#endif
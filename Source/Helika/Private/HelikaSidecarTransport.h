@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaTransport.h"
+
+/// Unix domain sockets with MSG_NOSIGNAL, the dedicated server hosts the aggregator is meant for
+#define HELIKA_WITH_SIDECAR PLATFORM_LINUX
+
+/**
+ * Wire format between FHelikaSidecarTransport and the host-local aggregator, one frame per upload on a stream socket:
+ *   uint32 magic, uint32 header bytes, uint32 body bytes (little endian)
+ *   header: "POST <url>\n" followed by one "Name: Value\n" line per request header (UTF-8)
+ *   body: the request body as is
+ */
+struct FHelikaSidecarFrame
+{
+	static constexpr uint32 Magic = 0x534B4C48; // "HLKS"
+	static constexpr int32 PrefixBytes = 12;
+	static constexpr int32 MaxHeaderBytes = 16 << 10;
+	static constexpr int32 MaxBodyBytes = 64 << 20;
+	/// Batches of a game process are capped at this so that a frame fits an empty socket buffer at the default net.core.wmem_max
+	/// and is written whole, larger frames would be finished by polling on the sending thread
+	static constexpr int32 MaxGameBatchBytes = 192 << 10;
+
+	FString Url;
+	TArray<TPair<FString, FString>> Headers;
+	TConstArrayView<uint8> Body;
+
+	/// Prefix and header of the frame of Request, the body is written after it without being copied
+	static void WriteHeader(const FHelikaTransportRequest& Request, TArray<uint8>& OutHeader);
+
+	/// Parses the frame at the front of Buffer, Body points into Buffer.
+	/// Returns the size of the frame, 0 while it is incomplete or INDEX_NONE when the stream is corrupt.
+	static int32 Parse(TConstArrayView<uint8> Buffer, FHelikaSidecarFrame& OutFrame);
+
+	/// Used when SidecarSocketPath is empty, in a directory only this user can reach: $XDG_RUNTIME_DIR,
+	/// else Saved/Helika/Sidecar of the project which the aggregator creates with mode 0700
+	static FString GetDefaultSocketPath();
+
+#if HELIKA_WITH_SIDECAR
+	/// True when the process at the other end of a connected Unix domain socket runs as this user (SO_PEERCRED)
+	static bool IsSameUser(int32 Socket);
+#endif
+};
+
+#if HELIKA_WITH_SIDECAR
+
+/**
+ * Hands uploads to the host-local aggregator (-run=HelikaAggregator) instead of the collector.
+ *
+ * An upload costs one non-blocking write of an uncompressed frame; TLS, compression, merging with the batches
+ * of the other processes on the host and retries are done by the aggregator. A written frame completes at once as
+ * 202 Accepted. While the aggregator holds back (its socket buffer is full) uploads complete as 503 with Retry-After
+ * so the lane backs off. Without an aggregator they complete unanswered, which takes the SDK offline and spills locally.
+ * Probes succeed while the socket is connected or can be connected. Completions run inline on the sending thread.
+ */
+class FHelikaSidecarTransport : public IHelikaTransport
+{
+public:
+	explicit FHelikaSidecarTransport(const FHelikaTransportConfig& InConfig);
+	virtual ~FHelikaSidecarTransport() override;
+
+	virtual void Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete) override;
+	virtual const TCHAR* GetName() const override { return TEXT("Sidecar"); }
+
+private:
+	enum class EWriteResult : uint8
+	{
+		Written,
+		/// Nothing was written, the aggregator is not reading fast enough
+		Busy,
+		Failed
+	};
+
+	/// Called with the lock held, reconnects at most once per second
+	bool EnsureConnected(FString& OutError);
+	/// Called with the lock held, a frame cut short is finished within the request timeout or the socket is closed
+	EWriteResult WriteFrame(const TArray<uint8>& Header, const TArray<uint8>& Body, float InTimeoutSeconds, FString& OutError);
+	void Close();
+
+	const FString SocketPath;
+	const float TimeoutSeconds;
+
+	FCriticalSection Lock;
+	int32 Socket = -1;
+	int32 SendBufferSize = 0;
+	double NextConnectTime = 0.0;
+};
+
+#endif
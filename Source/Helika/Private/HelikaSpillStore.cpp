@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaSpillStore.h"
+
+#include "HelikaClock.h"
+#include "HelikaDefines.h"
+#include "Aggregator/HelikaAggregator.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+FHelikaSpillStore::FHelikaSpillStore(const FString& InDirectory)
+	: Directory(InDirectory)
+{
+}
+
+FString FHelikaSpillStore::GetDefaultDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Helika") / TEXT("Spill");
+}
+
+void FHelikaSpillStore::Load()
+{
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *(Directory / TEXT("*.json")), true, false);
+
+	FScopeLock ScopeLock(&Lock);
+	for (const FString& File : Files)
+	{
+		TArray<FString> Parts;
+		FPaths::GetBaseFilename(File).ParseIntoArray(Parts, TEXT("_"));
+		// Files written before retries were counted have no fourth part
+		const int32 Priority = Parts.Num() == 3 || Parts.Num() == 4 ? FCString::Atoi(*Parts[1]) : INDEX_NONE;
+		if (Priority < 0 || Priority >= static_cast<int32>(EHelikaPriority::Count))
+		{
+			UE_LOG(LogHelika, Warning, TEXT("Ignoring unexpected file %s in the spill directory"), *File);
+			continue;
+		}
+
+		FHelikaSpilledBatch Batch;
+		Batch.Path = Directory / File;
+		Batch.Sequence = FCString::Strtoui64(*Parts[0], nullptr, 10);
+		Batch.Priority = static_cast<EHelikaPriority>(Priority);
+		Batch.NumEvents = FCString::Atoi(*Parts[2]);
+		Batch.NumRetries = Parts.Num() == 4 ? FCString::Atoi(*Parts[3]) : 0;
+		Batch.Bytes = IFileManager::Get().FileSize(*Batch.Path);
+		NextSequence = FMath::Max(NextSequence, Batch.Sequence + 1);
+		Insert(MoveTemp(Batch));
+	}
+
+	if (Batches.Num() > 0)
+	{
+		UE_LOG(LogHelika, Log, TEXT("Found %d events spilled by a previous run"), NumEvents);
+	}
+}
+
+int32 FHelikaSpillStore::Write(EHelikaPriority Priority, TConstArrayView<uint8> Payload, int32 InNumEvents, int64 MaxBytes, int32 NumRetries)
+{
+	if (Payload.Num() > MaxBytes)
+	{
+		return InNumEvents;
+	}
+
+	FHelikaSpilledBatch Batch;
+	Batch.Priority = Priority;
+	Batch.NumEvents = InNumEvents;
+	Batch.Bytes = Payload.Num();
+	Batch.NumRetries = NumRetries;
+	{
+		FScopeLock ScopeLock(&Lock);
+		Batch.Sequence = NextSequence++;
+	}
+	Batch.Path = Directory / FString::Printf(TEXT("%020llu_%d_%d_%d.json"), Batch.Sequence, static_cast<int32>(Priority), InNumEvents, NumRetries);
+
+	if (!FFileHelper::SaveArrayToFile(Payload, *Batch.Path))
+	{
+		UE_LOG(LogHelika, Error, TEXT("Could not spill %d events to %s"), InNumEvents, *Batch.Path);
+		return InNumEvents;
+	}
+
+	TArray<FString> Evicted;
+	int32 NumEvicted = 0;
+	{
+		FScopeLock ScopeLock(&Lock);
+		Insert(MoveTemp(Batch));
+
+		// Least urgent lane first, oldest first within it
+		while (TotalBytes > MaxBytes && Batches.Num() > 0)
+		{
+			int32 Victim = Batches.Num() - 1;
+			while (Victim > 0 && Batches[Victim - 1].Priority == Batches.Last().Priority)
+			{
+				--Victim;
+			}
+			NumEvicted += Batches[Victim].NumEvents;
+			NumEvents -= Batches[Victim].NumEvents;
+			TotalBytes -= Batches[Victim].Bytes;
+			Evicted.Add(MoveTemp(Batches[Victim].Path));
+			Batches.RemoveAt(Victim);
+		}
+	}
+
+	for (const FString& Path : Evicted)
+	{
+		IFileManager::Get().Delete(*Path, false, false, true);
+	}
+	return NumEvicted;
+}
+
+int32 FHelikaSpillStore::WriteRetries(const FHelikaSpilledBatch& Batch, TConstArrayView<int32> Indices, int64 MaxBytes)
+{
+	if (Indices.IsEmpty())
+	{
+		return 0;
+	}
+
+	// The collector numbers events by their position, a file that splits differently cannot be matched to the answer
+	TArray<uint8> Payload;
+	TArray<TPair<int32, int32>> Ranges;
+	if (!FFileHelper::LoadFileToArray(Payload, *Batch.Path) || !FHelikaAggregator::SplitEvents(Payload, Ranges) || Ranges.Num() != Batch.NumEvents)
+	{
+		UE_LOG(LogHelika, Warning, TEXT("Could not read spilled batch %s again, its %d events to retry are lost"), *Batch.Path, Indices.Num());
+		return Indices.Num();
+	}
+
+	const FTCHARToUTF8 Prefix(*FString::Printf(TEXT("{\"id\":\"%s\",\"events\":["), *FHelikaClock::NewGuid().ToString()));
+	TArray<uint8> Envelope;
+	Envelope.Reserve(Payload.Num());
+	Envelope.Append(reinterpret_cast<const uint8*>(Prefix.Get()), Prefix.Length());
+	for (const int32 Index : Indices)
+	{
+		if (Envelope.Num() > Prefix.Length())
+		{
+			Envelope.Add(',');
+		}
+		Envelope.Append(&Payload[Ranges[Index].Key], Ranges[Index].Value);
+	}
+	Envelope.Add(']');
+	Envelope.Add('}');
+	return Write(Batch.Priority, Envelope, Indices.Num(), MaxBytes, Batch.NumRetries + 1);
+}
+
+bool FHelikaSpillStore::Take(FHelikaSpilledBatch& OutBatch, TArray<uint8>& OutPayload)
+{
+	while (true)
+	{
+		{
+			FScopeLock ScopeLock(&Lock);
+			if (Batches.IsEmpty())
+			{
+				return false;
+			}
+			OutBatch = MoveTemp(Batches[0]);
+			Batches.RemoveAt(0);
+			NumEvents -= OutBatch.NumEvents;
+			TotalBytes -= OutBatch.Bytes;
+		}
+
+		if (FFileHelper::LoadFileToArray(OutPayload, *OutBatch.Path))
+		{
+			return true;
+		}
+
+		// Deleted or unreadable since it was indexed, nothing to upload
+		UE_LOG(LogHelika, Warning, TEXT("Could not read spilled batch %s, its %d events are lost"), *OutBatch.Path, OutBatch.NumEvents);
+		IFileManager::Get().Delete(*OutBatch.Path, false, false, true);
+	}
+}
+
+void FHelikaSpillStore::Remove(const FHelikaSpilledBatch& Batch)
+{
+	IFileManager::Get().Delete(*Batch.Path, false, false, true);
+}
+
+void FHelikaSpillStore::Restore(FHelikaSpilledBatch&& Batch)
+{
+	FScopeLock ScopeLock(&Lock);
+	Insert(MoveTemp(Batch));
+}
+
+bool FHelikaSpillStore::IsEmpty() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Batches.IsEmpty();
+}
+
+int32 FHelikaSpillStore::Num() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Batches.Num();
+}
+
+int32 FHelikaSpillStore::GetNumEvents() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return NumEvents;
+}
+
+int64 FHelikaSpillStore::GetTotalBytes() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return TotalBytes;
+}
+
+void FHelikaSpillStore::Insert(FHelikaSpilledBatch&& Batch)
+{
+	NumEvents += Batch.NumEvents;
+	TotalBytes += Batch.Bytes;
+
+	const int32 Index = Algo::LowerBoundBy(Batches, TPair<EHelikaPriority, uint64>(Batch.Priority, Batch.Sequence), [](const FHelikaSpilledBatch& Entry)
+	{
+		return TPair<EHelikaPriority, uint64>(Entry.Priority, Entry.Sequence);
+	});
+	Batches.Insert(MoveTemp(Batch), Index);
+}
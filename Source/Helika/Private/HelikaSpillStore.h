@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaTypes.h"
+
+/// Serialized batch written to disk while the collector was unreachable
+struct FHelikaSpilledBatch
+{
+	FString Path;
+	uint64 Sequence = 0;
+	EHelikaPriority Priority = EHelikaPriority::HP_Normal;
+	int32 NumEvents = 0;
+	int64 Bytes = 0;
+	/// Uploads the events already failed transiently
+	int32 NumRetries = 0;
+};
+
+/**
+ * Batches spilled to disk by the upload scheduler while offline, one file per serialized batch named
+ * <sequence>_<priority>_<events>_<retries>.json so the index can be rebuilt from the directory after a restart.
+ *
+ * Batches are handed out most urgent lane first, oldest first within a lane. A batch taken for upload
+ * stays on disk until Remove, Restore puts it back when the upload failed transiently.
+ */
+class FHelikaSpillStore
+{
+public:
+	explicit FHelikaSpillStore(const FString& InDirectory);
+
+	/// Default location, Saved/Helika/Spill
+	static FString GetDefaultDirectory();
+
+	/// Indexes the batches left by a previous run
+	void Load();
+
+	/**
+	 * Writes a batch, then deletes batches of the least urgent lane, oldest first, while the store holds more than MaxBytes.
+	 * Returns the number of events lost, including the batch itself when it could not be written.
+	 */
+	int32 Write(EHelikaPriority Priority, TConstArrayView<uint8> Payload, int32 NumEvents, int64 MaxBytes, int32 NumRetries = 0);
+
+	/**
+	 * Spills the events at Indices of a taken batch again as a new batch one retry further, the taken batch is left as it is.
+	 * Returns the number of events lost, see Write.
+	 */
+	int32 WriteRetries(const FHelikaSpilledBatch& Batch, TConstArrayView<int32> Indices, int64 MaxBytes);
+
+	/// Takes the next batch to upload and reads its payload, false when the store is empty
+	bool Take(FHelikaSpilledBatch& OutBatch, TArray<uint8>& OutPayload);
+
+	/// Deletes an uploaded batch
+	void Remove(const FHelikaSpilledBatch& Batch);
+
+	/// Gives back a batch whose upload failed transiently
+	void Restore(FHelikaSpilledBatch&& Batch);
+
+	bool IsEmpty() const;
+	int32 Num() const;
+	int32 GetNumEvents() const;
+	int64 GetTotalBytes() const;
+
+private:
+	/// Called with the lock held
+	void Insert(FHelikaSpilledBatch&& Batch);
+
+	const FString Directory;
+
+	mutable FCriticalSection Lock;
+	/// Sorted by priority then sequence
+	TArray<FHelikaSpilledBatch> Batches;
+	uint64 NextSequence = 0;
+	int32 NumEvents = 0;
+	int64 TotalBytes = 0;
+};
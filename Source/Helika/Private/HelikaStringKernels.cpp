@@ -0,0 +1,440 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaStringKernels.h"
+
+#include <atomic>
+
+#if PLATFORM_CPU_X86_FAMILY
+#define HELIKA_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define HELIKA_KERNELS_X86 0
+#endif
+
+#if PLATFORM_CPU_ARM_FAMILY && PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+#define HELIKA_KERNELS_NEON 1
+#include <arm_neon.h>
+#else
+#define HELIKA_KERNELS_NEON 0
+#endif
+
+// AVX2 is only compiled for the functions that use it, the rest of the module keeps the baseline instruction set
+#if HELIKA_KERNELS_X86 && (defined(__clang__) || defined(__GNUC__))
+#define HELIKA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HELIKA_TARGET_AVX2
+#endif
+
+static_assert(sizeof(TCHAR) == sizeof(uint16), "The string kernels read UTF-16 code units");
+
+namespace HelikaStringKernels
+{
+	static const uint8 HexDigits[] = "0123456789abcdef";
+
+	/// Longest encoding of one UTF-16 unit (\u00XX), the room reserved before a segment is encoded
+	constexpr int32 MaxBytesPerUnit = 6;
+	/// Units encoded per reservation, keeps the worst case room of long strings small
+	constexpr int32 SegmentUnits = 4096;
+
+	/// Encodes the leading units of Src that it handles, returns how many. May write up to one block past them.
+	typedef int32 (*FKernel)(const uint16* Src, int32 Length, uint8* Dst);
+
+	struct FKernelTable
+	{
+		EHelikaKernelSet Set;
+		/// Plain ASCII, one byte per unit
+		FKernel CopyPlainAscii;
+		/// U+0080 to U+07FF, two bytes per unit
+		FKernel EncodeTwoByte;
+	};
+
+	FORCEINLINE bool IsPlainAscii(uint32 Unit)
+	{
+		return Unit - 0x20 < 0x60 && Unit != '"' && Unit != '\\';
+	}
+
+	FORCEINLINE bool IsTwoByte(uint32 Unit)
+	{
+		return Unit - 0x80 < 0x780;
+	}
+
+	static int32 CopyPlainAsciiScalar(const uint16* Src, int32 Length, uint8* Dst)
+	{
+		int32 Index = 0;
+		while (Index < Length && IsPlainAscii(Src[Index]))
+		{
+			Dst[Index] = static_cast<uint8>(Src[Index]);
+			++Index;
+		}
+		return Index;
+	}
+
+	static int32 EncodeTwoByteScalar(const uint16* Src, int32 Length, uint8* Dst)
+	{
+		int32 Index = 0;
+		while (Index < Length && IsTwoByte(Src[Index]))
+		{
+			Dst[Index * 2] = static_cast<uint8>(0xC0 | (Src[Index] >> 6));
+			Dst[Index * 2 + 1] = static_cast<uint8>(0x80 | (Src[Index] & 0x3F));
+			++Index;
+		}
+		return Index;
+	}
+
+	/// Escapes or encodes the unit at Index, or the surrogate pair starting there, and moves Index past it
+	static uint8* EncodeUnit(const uint16* Src, int32 Length, int32& Index, uint8* Dst)
+	{
+		uint32 CodePoint = Src[Index++];
+
+		if (CodePoint < 0x80)
+		{
+			switch (CodePoint)
+			{
+			case '"': *Dst++ = '\\'; *Dst++ = '"'; break;
+			case '\\': *Dst++ = '\\'; *Dst++ = '\\'; break;
+			case '\b': *Dst++ = '\\'; *Dst++ = 'b'; break;
+			case '\f': *Dst++ = '\\'; *Dst++ = 'f'; break;
+			case '\n': *Dst++ = '\\'; *Dst++ = 'n'; break;
+			case '\r': *Dst++ = '\\'; *Dst++ = 'r'; break;
+			case '\t': *Dst++ = '\\'; *Dst++ = 't'; break;
+			default:
+				if (CodePoint < 0x20)
+				{
+					*Dst++ = '\\';
+					*Dst++ = 'u';
+					*Dst++ = '0';
+					*Dst++ = '0';
+					*Dst++ = HexDigits[CodePoint >> 4];
+					*Dst++ = HexDigits[CodePoint & 0xF];
+				}
+				else
+				{
+					*Dst++ = static_cast<uint8>(CodePoint);
+				}
+				break;
+			}
+			return Dst;
+		}
+
+		// Combine UTF-16 surrogate pairs, lone surrogates are replaced as they can't be encoded
+		if (CodePoint >= 0xD800 && CodePoint <= 0xDBFF)
+		{
+			const uint32 Next = Index < Length ? Src[Index] : 0;
+			if (Next >= 0xDC00 && Next <= 0xDFFF)
+			{
+				CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Next - 0xDC00);
+				++Index;
+			}
+			else
+			{
+				CodePoint = 0xFFFD;
+			}
+		}
+		else if (CodePoint >= 0xDC00 && CodePoint <= 0xDFFF)
+		{
+			CodePoint = 0xFFFD;
+		}
+
+		if (CodePoint < 0x800)
+		{
+			*Dst++ = static_cast<uint8>(0xC0 | (CodePoint >> 6));
+			*Dst++ = static_cast<uint8>(0x80 | (CodePoint & 0x3F));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			*Dst++ = static_cast<uint8>(0xE0 | (CodePoint >> 12));
+			*Dst++ = static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F));
+			*Dst++ = static_cast<uint8>(0x80 | (CodePoint & 0x3F));
+		}
+		else
+		{
+			*Dst++ = static_cast<uint8>(0xF0 | (CodePoint >> 18));
+			*Dst++ = static_cast<uint8>(0x80 | ((CodePoint >> 12) & 0x3F));
+			*Dst++ = static_cast<uint8>(0x80 | ((CodePoint >> 6) & 0x3F));
+			*Dst++ = static_cast<uint8>(0x80 | (CodePoint & 0x3F));
+		}
+		return Dst;
+	}
+
+#if HELIKA_KERNELS_X86
+	// SSE2 has no unsigned 16-bit compare, Unit - Low < Size is tested as a signed compare with the range moved to the bottom
+	static int32 CopyPlainAsciiSSE2(const uint16* Src, int32 Length, uint8* Dst)
+	{
+		const __m128i Bias = _mm_set1_epi16(static_cast<int16>(0x8000 - 0x20));
+		const __m128i Limit = _mm_set1_epi16(static_cast<int16>(0x8000 + 0x60));
+		const __m128i Quote = _mm_set1_epi16('"');
+		const __m128i Backslash = _mm_set1_epi16('\\');
+
+		int32 Index = 0;
+		for (; Index + 8 <= Length; Index += 8)
+		{
+			const __m128i Units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Index));
+			const __m128i Escaped = _mm_or_si128(_mm_cmpeq_epi16(Units, Quote), _mm_cmpeq_epi16(Units, Backslash));
+			const __m128i Plain = _mm_andnot_si128(Escaped, _mm_cmplt_epi16(_mm_add_epi16(Units, Bias), Limit));
+
+			// The whole block is narrowed, only its plain prefix counts
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(Dst + Index), _mm_packus_epi16(Units, Units));
+			const uint32 Mask = static_cast<uint32>(_mm_movemask_epi8(Plain));
+			if (Mask != 0xFFFF)
+			{
+				return Index + FMath::CountTrailingZeros(~Mask) / 2;
+			}
+		}
+		return Index + CopyPlainAsciiScalar(Src + Index, Length - Index, Dst + Index);
+	}
+
+	static int32 EncodeTwoByteSSE2(const uint16* Src, int32 Length, uint8* Dst)
+	{
+		const __m128i Bias = _mm_set1_epi16(static_cast<int16>(0x8000 - 0x80));
+		const __m128i Limit = _mm_set1_epi16(static_cast<int16>(0x8000 + 0x780));
+		const __m128i LeadMarker = _mm_set1_epi16(0xC0);
+		const __m128i TrailMarker = _mm_set1_epi16(0x80);
+		const __m128i TrailBits = _mm_set1_epi16(0x3F);
+
+		int32 Index = 0;
+		for (; Index + 8 <= Length; Index += 8)
+		{
+			const __m128i Units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Index));
+			const __m128i InRange = _mm_cmplt_epi16(_mm_add_epi16(Units, Bias), Limit);
+
+			// Lead byte in the low half of each lane, trail byte in the high half, which is their order in memory
+			const __m128i Lead = _mm_or_si128(_mm_srli_epi16(Units, 6), LeadMarker);
+			const __m128i Trail = _mm_slli_epi16(_mm_or_si128(_mm_and_si128(Units, TrailBits), TrailMarker), 8);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Index * 2), _mm_or_si128(Lead, Trail));
+			const uint32 Mask = static_cast<uint32>(_mm_movemask_epi8(InRange));
+			if (Mask != 0xFFFF)
+			{
+				return Index + FMath::CountTrailingZeros(~Mask) / 2;
+			}
+		}
+		return Index + EncodeTwoByteScalar(Src + Index, Length - Index, Dst + Index * 2);
+	}
+
+	HELIKA_TARGET_AVX2 static int32 CopyPlainAsciiAVX2(const uint16* Src, int32 Length, uint8* Dst)
+	{
+		const __m256i Bias = _mm256_set1_epi16(static_cast<int16>(0x8000 - 0x20));
+		const __m256i Limit = _mm256_set1_epi16(static_cast<int16>(0x8000 + 0x60));
+		const __m256i Quote = _mm256_set1_epi16('"');
+		const __m256i Backslash = _mm256_set1_epi16('\\');
+
+		int32 Index = 0;
+		for (; Index + 16 <= Length; Index += 16)
+		{
+			const __m256i Units = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + Index));
+			const __m256i Escaped = _mm256_or_si256(_mm256_cmpeq_epi16(Units, Quote), _mm256_cmpeq_epi16(Units, Backslash));
+			const __m256i Plain = _mm256_andnot_si256(Escaped, _mm256_cmpgt_epi16(Limit, _mm256_add_epi16(Units, Bias)));
+
+			// Packing works per 128-bit lane, the two halves are brought back together before the store
+			const __m256i Packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(Units, Units), 0x08);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Index), _mm256_castsi256_si128(Packed));
+			const uint32 Mask = static_cast<uint32>(_mm256_movemask_epi8(Plain));
+			if (Mask != 0xFFFFFFFF)
+			{
+				return Index + FMath::CountTrailingZeros(~Mask) / 2;
+			}
+		}
+		return Index + CopyPlainAsciiSSE2(Src + Index, Length - Index, Dst + Index);
+	}
+
+	HELIKA_TARGET_AVX2 static int32 EncodeTwoByteAVX2(const uint16* Src, int32 Length, uint8* Dst)
+	{
+		const __m256i Bias = _mm256_set1_epi16(static_cast<int16>(0x8000 - 0x80));
+		const __m256i Limit = _mm256_set1_epi16(static_cast<int16>(0x8000 + 0x780));
+		const __m256i LeadMarker = _mm256_set1_epi16(0xC0);
+		const __m256i TrailMarker = _mm256_set1_epi16(0x80);
+		const __m256i TrailBits = _mm256_set1_epi16(0x3F);
+
+		int32 Index = 0;
+		for (; Index + 16 <= Length; Index += 16)
+		{
+			const __m256i Units = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Src + Index));
+			const __m256i InRange = _mm256_cmpgt_epi16(Limit, _mm256_add_epi16(Units, Bias));
+
+			const __m256i Lead = _mm256_or_si256(_mm256_srli_epi16(Units, 6), LeadMarker);
+			const __m256i Trail = _mm256_slli_epi16(_mm256_or_si256(_mm256_and_si256(Units, TrailBits), TrailMarker), 8);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(Dst + Index * 2), _mm256_or_si256(Lead, Trail));
+			const uint32 Mask = static_cast<uint32>(_mm256_movemask_epi8(InRange));
+			if (Mask != 0xFFFFFFFF)
+			{
+				return Index + FMath::CountTrailingZeros(~Mask) / 2;
+			}
+		}
+		return Index + EncodeTwoByteSSE2(Src + Index, Length - Index, Dst + Index * 2);
+	}
+#endif
+
+#if HELIKA_KERNELS_NEON
+	// NEON has no movemask, the lane masks are narrowed to one byte per unit and read as a 64-bit integer
+	static int32 CopyPlainAsciiNEON(const uint16* Src, int32 Length, uint8* Dst)
+	{
+		int32 Index = 0;
+		for (; Index + 8 <= Length; Index += 8)
+		{
+			const uint16x8_t Units = vld1q_u16(Src + Index);
+			const uint16x8_t Escaped = vorrq_u16(vceqq_u16(Units, vdupq_n_u16('"')), vceqq_u16(Units, vdupq_n_u16('\\')));
+			const uint16x8_t Special = vorrq_u16(Escaped, vcgeq_u16(vsubq_u16(Units, vdupq_n_u16(0x20)), vdupq_n_u16(0x60)));
+
+			vst1_u8(Dst + Index, vmovn_u16(Units));
+			const uint64 Mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(Special)), 0);
+			if (Mask != 0)
+			{
+				return Index + static_cast<int32>(FMath::CountTrailingZeros64(Mask) / 8);
+			}
+		}
+		return Index + CopyPlainAsciiScalar(Src + Index, Length - Index, Dst + Index);
+	}
+
+	static int32 EncodeTwoByteNEON(const uint16* Src, int32 Length, uint8* Dst)
+	{
+		int32 Index = 0;
+		for (; Index + 8 <= Length; Index += 8)
+		{
+			const uint16x8_t Units = vld1q_u16(Src + Index);
+			const uint16x8_t Outside = vcgeq_u16(vsubq_u16(Units, vdupq_n_u16(0x80)), vdupq_n_u16(0x780));
+
+			const uint16x8_t Lead = vorrq_u16(vshrq_n_u16(Units, 6), vdupq_n_u16(0xC0));
+			const uint16x8_t Trail = vshlq_n_u16(vorrq_u16(vandq_u16(Units, vdupq_n_u16(0x3F)), vdupq_n_u16(0x80)), 8);
+			vst1q_u8(Dst + Index * 2, vreinterpretq_u8_u16(vorrq_u16(Lead, Trail)));
+			const uint64 Mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(Outside)), 0);
+			if (Mask != 0)
+			{
+				return Index + static_cast<int32>(FMath::CountTrailingZeros64(Mask) / 8);
+			}
+		}
+		return Index + EncodeTwoByteScalar(Src + Index, Length - Index, Dst + Index * 2);
+	}
+#endif
+
+	static const FKernelTable* FindTable(EHelikaKernelSet KernelSet)
+	{
+		static const FKernelTable Scalar{EHelikaKernelSet::Scalar, &CopyPlainAsciiScalar, &EncodeTwoByteScalar};
+#if HELIKA_KERNELS_X86
+		static const FKernelTable SSE2{EHelikaKernelSet::SSE2, &CopyPlainAsciiSSE2, &EncodeTwoByteSSE2};
+		static const FKernelTable AVX2{EHelikaKernelSet::AVX2, &CopyPlainAsciiAVX2, &EncodeTwoByteAVX2};
+		static const bool bHasAVX2 = FPlatformMisc::HasAVX2InstructionSupport();
+#endif
+#if HELIKA_KERNELS_NEON
+		static const FKernelTable NEON{EHelikaKernelSet::NEON, &CopyPlainAsciiNEON, &EncodeTwoByteNEON};
+#endif
+
+		switch (KernelSet)
+		{
+		case EHelikaKernelSet::Scalar:
+			return &Scalar;
+#if HELIKA_KERNELS_X86
+		case EHelikaKernelSet::SSE2:
+			return &SSE2;
+		case EHelikaKernelSet::AVX2:
+			return bHasAVX2 ? &AVX2 : nullptr;
+#endif
+#if HELIKA_KERNELS_NEON
+		case EHelikaKernelSet::NEON:
+			return &NEON;
+#endif
+		default:
+			return nullptr;
+		}
+	}
+
+	static const FKernelTable& FindBestTable()
+	{
+		for (const EHelikaKernelSet KernelSet : {EHelikaKernelSet::AVX2, EHelikaKernelSet::SSE2, EHelikaKernelSet::NEON})
+		{
+			if (const FKernelTable* Table = FindTable(KernelSet))
+			{
+				return *Table;
+			}
+		}
+		return *FindTable(EHelikaKernelSet::Scalar);
+	}
+
+	/// Picked on first use
+	static std::atomic<const FKernelTable*> ActiveTable{nullptr};
+
+	static const FKernelTable& GetActiveTable()
+	{
+		const FKernelTable* Table = ActiveTable.load(std::memory_order_acquire);
+		if (Table == nullptr)
+		{
+			Table = &FindBestTable();
+			ActiveTable.store(Table, std::memory_order_release);
+		}
+		return *Table;
+	}
+}
+
+void FHelikaStringKernels::AppendEscapedUtf8(TArray<uint8>& Out, FStringView Value)
+{
+	using namespace HelikaStringKernels;
+
+	const FKernelTable& Kernels = GetActiveTable();
+	const uint16* Src = reinterpret_cast<const uint16*>(Value.GetData());
+	const int32 Length = Value.Len();
+
+	int32 Index = 0;
+	while (Index < Length)
+	{
+		// Room for the worst case, cut back to what was written. A surrogate pair may end one unit past the segment.
+		const int32 SegmentEnd = FMath::Min(Index + SegmentUnits, Length);
+		const int32 Start = Out.Num();
+		Out.AddUninitialized((SegmentEnd - Index) * MaxBytesPerUnit);
+		uint8* const SegmentStart = Out.GetData() + Start;
+		uint8* Dst = SegmentStart;
+
+		while (Index < SegmentEnd)
+		{
+			const int32 NumAscii = Kernels.CopyPlainAscii(Src + Index, SegmentEnd - Index, Dst);
+			Index += NumAscii;
+			Dst += NumAscii;
+
+			const int32 NumTwoByte = Index < SegmentEnd ? Kernels.EncodeTwoByte(Src + Index, SegmentEnd - Index, Dst) : 0;
+			Index += NumTwoByte;
+			Dst += NumTwoByte * 2;
+
+			if (NumAscii == 0 && NumTwoByte == 0)
+			{
+				Dst = EncodeUnit(Src, Length, Index, Dst);
+			}
+		}
+		Out.SetNum(Start + static_cast<int32>(Dst - SegmentStart), false);
+	}
+}
+
+EHelikaKernelSet FHelikaStringKernels::GetKernelSet()
+{
+	return HelikaStringKernels::GetActiveTable().Set;
+}
+
+bool FHelikaStringKernels::SetKernelSet(EHelikaKernelSet KernelSet)
+{
+	const HelikaStringKernels::FKernelTable* Table = HelikaStringKernels::FindTable(KernelSet);
+	if (Table == nullptr)
+	{
+		return false;
+	}
+	HelikaStringKernels::ActiveTable.store(Table, std::memory_order_release);
+	return true;
+}
+
+void FHelikaStringKernels::ResetKernelSet()
+{
+	HelikaStringKernels::ActiveTable.store(&HelikaStringKernels::FindBestTable(), std::memory_order_release);
+}
+
+bool FHelikaStringKernels::IsSupported(EHelikaKernelSet KernelSet)
+{
+	return HelikaStringKernels::FindTable(KernelSet) != nullptr;
+}
+
+const TCHAR* FHelikaStringKernels::LexToString(EHelikaKernelSet KernelSet)
+{
+	switch (KernelSet)
+	{
+	case EHelikaKernelSet::Scalar: return TEXT("Scalar");
+	case EHelikaKernelSet::SSE2: return TEXT("SSE2");
+	case EHelikaKernelSet::AVX2: return TEXT("AVX2");
+	case EHelikaKernelSet::NEON: return TEXT("NEON");
+	default: return TEXT("Unknown");
+	}
+}
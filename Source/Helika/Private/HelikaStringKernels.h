@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// Instruction set of the string kernels
+enum class EHelikaKernelSet : uint8
+{
+	Scalar,
+	SSE2,
+	AVX2,
+	NEON,
+	Num
+};
+
+/**
+ * Encoding of JSON string values, escaping and UTF-16 to UTF-8 transcoding in a single pass.
+ *
+ * Runs of plain ASCII (no quote, backslash or control character) are narrowed 8 or 16 units at a time and runs of
+ * two-byte characters (U+0080 to U+07FF) are encoded as many at a time, everything else goes through the scalar path.
+ * The kernel set is picked at runtime from what the CPU supports, every set produces the same bytes as Scalar.
+ */
+class FHelikaStringKernels
+{
+public:
+	/// Appends Value to Out as the UTF-8 content of a JSON string, without the quotes. Lone surrogates become U+FFFD.
+	static void AppendEscapedUtf8(TArray<uint8>& Out, FStringView Value);
+
+	/// Kernel set used by AppendEscapedUtf8, the best one available unless overridden
+	static EHelikaKernelSet GetKernelSet();
+
+	/// Forces a kernel set for tests and benchmarks, false when this build or CPU lacks it
+	static bool SetKernelSet(EHelikaKernelSet KernelSet);
+
+	/// Goes back to the best available kernel set
+	static void ResetKernelSet();
+
+	static bool IsSupported(EHelikaKernelSet KernelSet);
+
+	static const TCHAR* LexToString(EHelikaKernelSet KernelSet);
+};
@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(HelikaChannel)
+
+TRACE_DECLARE_INT_COUNTER(HelikaQueueDepth, TEXT("Helika/Queue Depth"));
+TRACE_DECLARE_MEMORY_COUNTER(HelikaBytesInFlight, TEXT("Helika/Bytes In Flight"));
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+// Unreal Insights channel of the event pipeline, enable it with '-trace=default,Helika'
+UE_TRACE_CHANNEL_EXTERN(HelikaChannel)
+
+TRACE_DECLARE_INT_COUNTER_EXTERN(HelikaQueueDepth);
+TRACE_DECLARE_MEMORY_COUNTER_EXTERN(HelikaBytesInFlight);
+
+/// Timing scope of one pipeline stage, compiled out with tracing and free while the channel is off
+#define HELIKA_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Helika::" Name, HelikaChannel)
+
+/// Counters are only emitted, and Value only evaluated, while HelikaChannel is enabled. A single statement, safe in an unbraced if/else.
+#define HELIKA_TRACE_COUNTER_SET(Counter, Value) \
+	do \
+	{ \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(HelikaChannel)) \
+		{ \
+			TRACE_COUNTER_SET(Counter, Value); \
+		} \
+	} \
+	while (0)
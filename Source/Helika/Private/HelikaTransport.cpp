@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaTransport.h"
+
+#include "HelikaClock.h"
+#include "HelikaCurlTransport.h"
+#include "HelikaDefines.h"
+#include "HelikaSidecarTransport.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+
+const FString* FHelikaTransportRequest::FindHeader(const TCHAR* Name) const
+{
+	for (const TPair<FString, FString>& Header : Headers)
+	{
+		if (Header.Key.Equals(Name, ESearchCase::IgnoreCase))
+		{
+			return &Header.Value;
+		}
+	}
+	return nullptr;
+}
+
+TSharedRef<IHelikaTransport, ESPMode::ThreadSafe> IHelikaTransport::Create(const FHelikaTransportConfig& Config)
+{
+	switch (Config.Kind)
+	{
+	case EHelikaTransport::HT_Curl:
+#if HELIKA_WITH_CURL
+		return MakeShared<FHelikaCurlTransport, ESPMode::ThreadSafe>(Config);
+#else
+		UE_LOG(LogHelika, Warning, TEXT("Helika Curl transport is not available on this platform, using the Http Module"));
+		break;
+#endif
+	case EHelikaTransport::HT_InMemory:
+		return MakeShared<FHelikaInMemoryTransport, ESPMode::ThreadSafe>();
+	case EHelikaTransport::HT_Sidecar:
+#if HELIKA_WITH_SIDECAR
+		return MakeShared<FHelikaSidecarTransport, ESPMode::ThreadSafe>(Config);
+#else
+		UE_LOG(LogHelika, Warning, TEXT("Helika Sidecar transport is not available on this platform, using the Http Module"));
+		break;
+#endif
+	default:
+		break;
+	}
+	return MakeShared<FHelikaHttpModuleTransport, ESPMode::ThreadSafe>(Config);
+}
+
+int32 IHelikaTransport::ParseRetryAfter(const FString& Value)
+{
+	const FString Trimmed = Value.TrimStartAndEnd();
+	if (Trimmed.IsEmpty())
+	{
+		return 0;
+	}
+
+	bool bIsDelay = true;
+	for (const TCHAR Char : Trimmed)
+	{
+		bIsDelay &= FChar::IsDigit(Char);
+	}
+	if (bIsDelay)
+	{
+		// Clamped rather than wrapped, the lane caps it at MaxBackoffSeconds
+		return static_cast<int32>(FMath::Min<int64>(FCString::Atoi64(*Trimmed), MAX_int32));
+	}
+
+	FDateTime Date;
+	if (FDateTime::ParseHttpDate(Trimmed, Date))
+	{
+		return static_cast<int32>(FMath::Clamp<double>(FMath::CeilToDouble((Date - FHelikaClock::UtcNow()).GetTotalSeconds()), 0.0, MAX_int32));
+	}
+	return 0;
+}
+
+void FHelikaHttpModuleTransport::Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete)
+{
+	const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> HttpRequest = FHttpModule::Get().CreateRequest();
+	HttpRequest->SetVerb(Request.Verb);
+	HttpRequest->SetURL(Request.Url);
+	for (const TPair<FString, FString>& Header : Request.Headers)
+	{
+		HttpRequest->SetHeader(Header.Key, Header.Value);
+	}
+	const float TimeoutSeconds = Request.TimeoutSeconds > 0.f ? Request.TimeoutSeconds : Config.TimeoutSeconds;
+	if (TimeoutSeconds > 0.f)
+	{
+		HttpRequest->SetTimeout(TimeoutSeconds);
+	}
+	if (Request.Body.Num() > 0)
+	{
+		HttpRequest->SetContent(MoveTemp(Request.Body));
+	}
+
+	// Delegates copy their functors, the move-only callback is shared instead
+	HttpRequest->OnProcessRequestComplete().BindLambda(
+		[Callback = MakeShared<FOnComplete, ESPMode::ThreadSafe>(MoveTemp(OnComplete))](const FHttpRequestPtr& InRequest, const FHttpResponsePtr& HttpResponse, const bool bConnectedSuccessfully)
+		{
+			FHelikaTransportResponse Response;
+			Response.bConnected = bConnectedSuccessfully && HttpResponse.IsValid();
+			if (Response.bConnected)
+			{
+				Response.Status = HttpResponse->GetResponseCode();
+				Response.Body = HttpResponse->GetContent();
+				Response.RetryAfterSeconds = ParseRetryAfter(HttpResponse->GetHeader(TEXT("Retry-After")));
+			}
+			else
+			{
+				Response.Error = InRequest.IsValid() ? EHttpRequestStatus::ToString(InRequest->GetStatus()) : TEXT("Failed");
+			}
+			(*Callback)(MoveTemp(Response));
+		});
+	HttpRequest->ProcessRequest();
+}
+
+FHelikaInMemoryTransport::~FHelikaInMemoryTransport()
+{
+	// Requests never answered complete unanswered, like a connection torn down
+	TArray<FPending> Unanswered;
+	{
+		FScopeLock ScopeLock(&Lock);
+		Unanswered = MoveTemp(Pending);
+	}
+	for (FPending& Request : Unanswered)
+	{
+		FHelikaTransportResponse Response;
+		Response.Error = TEXT("Transport destroyed");
+		Request.OnComplete(MoveTemp(Response));
+	}
+}
+
+void FHelikaInMemoryTransport::Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete)
+{
+	FScopeLock ScopeLock(&Lock);
+	Sent.Add(Request);
+	Pending.Add({MoveTemp(Request), MoveTemp(OnComplete)});
+}
+
+void FHelikaInMemoryTransport::Tick()
+{
+	AnswerPending();
+}
+
+void FHelikaInMemoryTransport::SetHandler(FHandler&& InHandler)
+{
+	FScopeLock ScopeLock(&Lock);
+	Handler = MoveTemp(InHandler);
+}
+
+int32 FHelikaInMemoryTransport::AnswerPending()
+{
+	TArray<FPending> Answering;
+	FHandler CurrentHandler;
+	{
+		FScopeLock ScopeLock(&Lock);
+		Answering = MoveTemp(Pending);
+		CurrentHandler = Handler;
+	}
+
+	// Completions may send again, they run without the lock
+	for (FPending& Request : Answering)
+	{
+		FHelikaTransportResponse Response;
+		if (CurrentHandler)
+		{
+			Response = CurrentHandler(Request.Request);
+		}
+		else
+		{
+			Response.bConnected = true;
+			Response.Status = 200;
+		}
+		Request.OnComplete(MoveTemp(Response));
+	}
+	return Answering.Num();
+}
+
+int32 FHelikaInMemoryTransport::GetNumPending() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Pending.Num();
+}
+
+TArray<FHelikaTransportRequest> FHelikaInMemoryTransport::GetSent() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Sent;
+}
+
+void FHelikaInMemoryTransport::ResetSent()
+{
+	FScopeLock ScopeLock(&Lock);
+	Sent.Reset();
+}
+
+void FHelikaTrackedTransport::Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete)
+{
+	NumInFlight->fetch_add(1, std::memory_order_relaxed);
+	Inner->Send(MoveTemp(Request), [NumInFlight = NumInFlight, OnComplete = MoveTemp(OnComplete)](FHelikaTransportResponse&& Response) mutable
+	{
+		OnComplete(MoveTemp(Response));
+		NumInFlight->fetch_sub(1, std::memory_order_release);
+	});
+}
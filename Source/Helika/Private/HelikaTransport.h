@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaConfigSnapshot.h"
+#include <atomic>
+
+/// One request of the upload pipeline, owned by the transport once sent
+struct FHelikaTransportRequest
+{
+	FString Url;
+	FString Verb = TEXT("POST");
+	TArray<TPair<FString, FString>> Headers;
+	/// Sent as is, transports keep it alive until the request completed instead of copying it
+	TArray<uint8> Body;
+	/// 0 keeps the transport's default
+	float TimeoutSeconds = 0.f;
+
+	void AddHeader(const FString& Name, const FString& Value)
+	{
+		Headers.Emplace(Name, Value);
+	}
+
+	const FString* FindHeader(const TCHAR* Name) const;
+};
+
+struct FHelikaTransportResponse
+{
+	/// False when no answer arrived (DNS, connection, TLS, timeout, shutdown), Status is 0 then
+	bool bConnected = false;
+	int32 Status = 0;
+	TArray<uint8> Body;
+	/// Retry-After header in seconds, 0 when absent or unreadable so that the lane's own backoff applies
+	int32 RetryAfterSeconds = 0;
+	/// Why no answer arrived, for the log
+	FString Error;
+};
+
+/**
+ * HTTP client of the uploads and probes, selected by UHelikaSettings::Transport.
+ *
+ * Send is thread safe. OnComplete runs exactly once, on whatever thread the transport finishes the request on,
+ * so it must not touch game thread state. Requests still in flight when the transport is destroyed complete unanswered.
+ */
+class IHelikaTransport
+{
+public:
+	typedef TUniqueFunction<void(FHelikaTransportResponse&&)> FOnComplete;
+
+	virtual ~IHelikaTransport() = default;
+
+	virtual void Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete) = 0;
+
+	/// Game thread, once per frame
+	virtual void Tick()
+	{
+	}
+
+	virtual const TCHAR* GetName() const = 0;
+
+	/// The transport selected by Config.Kind, or the Http Module one where it is not available on this platform
+	static TSharedRef<IHelikaTransport, ESPMode::ThreadSafe> Create(const FHelikaTransportConfig& Config);
+
+	/// Seconds of a Retry-After value, delay-seconds or an HTTP-date. 0 when it is empty, malformed or in the past.
+	static int32 ParseRetryAfter(const FString& Value);
+};
+
+typedef TSharedPtr<IHelikaTransport, ESPMode::ThreadSafe> FHelikaTransportPtr;
+
+/// The engine's FHttpModule, completions run on the game thread
+class FHelikaHttpModuleTransport : public IHelikaTransport
+{
+public:
+	explicit FHelikaHttpModuleTransport(const FHelikaTransportConfig& InConfig)
+		: Config(InConfig)
+	{
+	}
+
+	virtual void Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete) override;
+	virtual const TCHAR* GetName() const override { return TEXT("HttpModule"); }
+
+private:
+	FHelikaTransportConfig Config;
+};
+
+/**
+ * Keeps the requests in memory and answers them from Tick or AnswerPending, nothing leaves the process.
+ * Every request is answered with 200 and an empty body unless a handler is set.
+ */
+class FHelikaInMemoryTransport : public IHelikaTransport
+{
+public:
+	typedef TFunction<FHelikaTransportResponse(const FHelikaTransportRequest&)> FHandler;
+
+	virtual ~FHelikaInMemoryTransport() override;
+
+	virtual void Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete) override;
+	virtual void Tick() override;
+	virtual const TCHAR* GetName() const override { return TEXT("InMemory"); }
+
+	/// Thread safe, the handler runs on the thread answering the requests
+	void SetHandler(FHandler&& InHandler);
+
+	/// Answers every pending request on the calling thread, returns how many
+	int32 AnswerPending();
+
+	int32 GetNumPending() const;
+
+	/// Copies of every request sent so far
+	TArray<FHelikaTransportRequest> GetSent() const;
+
+	void ResetSent();
+
+private:
+	struct FPending
+	{
+		FHelikaTransportRequest Request;
+		FOnComplete OnComplete;
+	};
+
+	mutable FCriticalSection Lock;
+	TArray<FPending> Pending;
+	TArray<FHelikaTransportRequest> Sent;
+	FHandler Handler;
+};
+
+/**
+ * Counts the requests in flight on another transport. A transport replaced by a settings change is kept until
+ * its requests completed instead of being torn down under them, which would fail them unanswered.
+ */
+class FHelikaTrackedTransport : public IHelikaTransport
+{
+public:
+	explicit FHelikaTrackedTransport(const TSharedRef<IHelikaTransport, ESPMode::ThreadSafe>& InInner)
+		: Inner(InInner)
+	{
+	}
+
+	virtual void Send(FHelikaTransportRequest&& Request, FOnComplete&& OnComplete) override;
+	virtual void Tick() override { Inner->Tick(); }
+	virtual const TCHAR* GetName() const override { return Inner->GetName(); }
+
+	/// True once every request sent through it has completed
+	bool IsIdle() const { return NumInFlight->load(std::memory_order_acquire) == 0; }
+
+	/// The wrapped client, e.g. to answer an in-memory transport in tests
+	IHelikaTransport& GetInner() const { return *Inner; }
+
+private:
+	TSharedRef<IHelikaTransport, ESPMode::ThreadSafe> Inner;
+	/// Shared with the completions, the inner transport completes what is left when it is destroyed
+	TSharedRef<std::atomic<int32>, ESPMode::ThreadSafe> NumInFlight = MakeShared<std::atomic<int32>, ESPMode::ThreadSafe>(0);
+};
@@ -0,0 +1,711 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HelikaMockCollector.h"
+
+#include "HelikaColumnarBatch.h"
+#include "HelikaDefines.h"
+#include "Async/Async.h"
+#include "Common/TcpListener.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Misc/Compression.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+namespace HelikaMockCollector
+{
+	static constexpr int32 MaxHeaderBytes = 64 * 1024;
+	static constexpr int64 MaxBodyBytes = 64 * 1024 * 1024;
+	static constexpr int32 MaxRecords = 100000;
+
+	static const TCHAR* GetReasonPhrase(int32 Status)
+	{
+		switch (Status)
+		{
+		case 100: return TEXT("Continue");
+		case 200: return TEXT("OK");
+		case 400: return TEXT("Bad Request");
+		case 401: return TEXT("Unauthorized");
+		case 404: return TEXT("Not Found");
+		case 411: return TEXT("Length Required");
+		case 413: return TEXT("Payload Too Large");
+		case 415: return TEXT("Unsupported Media Type");
+		case 429: return TEXT("Too Many Requests");
+		case 500: return TEXT("Internal Server Error");
+		case 503: return TEXT("Service Unavailable");
+		default: return TEXT("Unknown");
+		}
+	}
+
+	static bool SendAll(FSocket* Socket, const uint8* Data, int32 Num)
+	{
+		while (Num > 0)
+		{
+			int32 Sent = 0;
+			if (!Socket->Send(Data, Num, Sent) || Sent <= 0)
+			{
+				return false;
+			}
+			Data += Sent;
+			Num -= Sent;
+		}
+		return true;
+	}
+
+	static int32 FindHeaderEnd(const TArray<uint8>& Buffer)
+	{
+		for (int32 Index = 0; Index + 3 < Buffer.Num(); ++Index)
+		{
+			if (Buffer[Index] == '\r' && Buffer[Index + 1] == '\n' && Buffer[Index + 2] == '\r' && Buffer[Index + 3] == '\n')
+			{
+				return Index;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	/// Empty when the event is well formed
+	static FString ValidateEvent(const TSharedPtr<FJsonValue>& Value, int32 Index)
+	{
+		const TSharedPtr<FJsonObject>* Event = nullptr;
+		const TSharedPtr<FJsonObject>* InternalEvent = nullptr;
+		FString Field;
+		if (!Value.IsValid() || !Value->TryGetObject(Event))
+		{
+			return FString::Printf(TEXT("Event %d is not an object"), Index);
+		}
+		for (const TCHAR* Name : {TEXT("event_type"), TEXT("game_id"), TEXT("created_at")})
+		{
+			if (!(*Event)->TryGetStringField(Name, Field) || Field.IsEmpty())
+			{
+				return FString::Printf(TEXT("Event %d is missing '%s'"), Index, Name);
+			}
+		}
+		if (!(*Event)->TryGetObjectField(TEXT("event"), InternalEvent))
+		{
+			return FString::Printf(TEXT("Event %d is missing 'event'"), Index);
+		}
+		if (!(*InternalEvent)->TryGetStringField(TEXT("session_id"), Field) || Field.IsEmpty())
+		{
+			return FString::Printf(TEXT("Event %d is missing 'event.session_id'"), Index);
+		}
+		return FString();
+	}
+
+	static bool IsEventsPath(const FString& Path)
+	{
+		return Path == TEXT("/v1/events/") || Path == TEXT("/v1/events") || Path == TEXT("/events/") || Path == TEXT("/events");
+	}
+}
+
+FString FHelikaMockCollectorStats::ToJson() const
+{
+	const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetNumberField(TEXT("requests"), Requests);
+	Json->SetNumberField(TEXT("accepted"), Accepted);
+	Json->SetNumberField(TEXT("invalid"), Invalid);
+	Json->SetNumberField(TEXT("injected_errors"), InjectedErrors);
+	Json->SetNumberField(TEXT("dropped"), Dropped);
+	Json->SetNumberField(TEXT("probes"), Probes);
+	Json->SetNumberField(TEXT("events"), Events);
+	Json->SetNumberField(TEXT("rejected_events"), RejectedEvents);
+	Json->SetNumberField(TEXT("retryable_events"), RetryableEvents);
+	Json->SetNumberField(TEXT("wire_bytes"), WireBytes);
+	Json->SetNumberField(TEXT("decoded_bytes"), DecodedBytes);
+
+	const TSharedRef<FJsonObject> Encodings = MakeShared<FJsonObject>();
+	for (const TPair<FString, int64>& Encoding : RequestsPerEncoding)
+	{
+		Encodings->SetNumberField(Encoding.Key, Encoding.Value);
+	}
+	Json->SetObjectField(TEXT("requests_per_encoding"), Encodings);
+
+	const TSharedRef<FJsonObject> Formats = MakeShared<FJsonObject>();
+	for (const TPair<FString, int64>& Format : RequestsPerFormat)
+	{
+		Formats->SetNumberField(Format.Key, Format.Value);
+	}
+	Json->SetObjectField(TEXT("requests_per_format"), Formats);
+
+	TArray<TSharedPtr<FJsonValue>> RecordValues;
+	RecordValues.Reserve(Records.Num());
+	for (const FHelikaMockRequestRecord& Record : Records)
+	{
+		const TSharedRef<FJsonObject> RecordJson = MakeShared<FJsonObject>();
+		RecordJson->SetNumberField(TEXT("time"), Record.TimeSeconds);
+		RecordJson->SetStringField(TEXT("path"), Record.Path);
+		RecordJson->SetStringField(TEXT("encoding"), Record.Encoding);
+		RecordJson->SetStringField(TEXT("format"), Record.Format);
+		RecordJson->SetNumberField(TEXT("wire_bytes"), Record.WireBytes);
+		RecordJson->SetNumberField(TEXT("decoded_bytes"), Record.DecodedBytes);
+		RecordJson->SetNumberField(TEXT("events"), Record.NumEvents);
+		RecordJson->SetNumberField(TEXT("rejected"), Record.NumRejected);
+		RecordJson->SetNumberField(TEXT("retryable"), Record.NumRetryable);
+		RecordJson->SetNumberField(TEXT("status"), Record.Status);
+		RecordJson->SetNumberField(TEXT("latency_ms"), Record.InjectedLatencyMs);
+		if (!Record.Error.IsEmpty())
+		{
+			RecordJson->SetStringField(TEXT("error"), Record.Error);
+		}
+		RecordValues.Add(MakeShared<FJsonValueObject>(RecordJson));
+	}
+	Json->SetArrayField(TEXT("records"), RecordValues);
+
+	FString Result;
+	const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Result);
+	FJsonSerializer::Serialize(Json, Writer);
+	return Result;
+}
+
+FHelikaMockCollector::FHelikaMockCollector(const FHelikaMockCollectorConfig& InConfig)
+	: Config(InConfig)
+	, Random(InConfig.Seed)
+{
+}
+
+FHelikaMockCollector::~FHelikaMockCollector()
+{
+	Stop();
+}
+
+bool FHelikaMockCollector::Start()
+{
+	if (IsRunning())
+	{
+		return true;
+	}
+
+	bStopping = false;
+
+	const FHelikaMockCollectorConfig StartConfig = GetConfig();
+	const FIPv4Endpoint Endpoint(StartConfig.bBindAny ? FIPv4Address::Any : FIPv4Address(127, 0, 0, 1), StartConfig.Port);
+	Listener = MakeUnique<FTcpListener>(Endpoint, FTimespan::FromMilliseconds(100), false);
+	if (!Listener->IsActive())
+	{
+		UE_LOG(LogHelika, Error, TEXT("Mock collector could not listen on %s"), *Endpoint.ToString());
+		Listener.Reset();
+		return false;
+	}
+
+	Listener->OnConnectionAccepted().BindRaw(this, &FHelikaMockCollector::HandleConnectionAccepted);
+	UE_LOG(LogHelika, Display, TEXT("Mock collector listening on %s"), *Endpoint.ToString());
+	return true;
+}
+
+void FHelikaMockCollector::Stop()
+{
+	bStopping = true;
+	Listener.Reset();
+
+	// Connection loops notice bStopping within one socket wait
+	TArray<TFuture<void>> Pending;
+	{
+		FScopeLock Lock(&ConnectionsLock);
+		Pending = MoveTemp(Connections);
+	}
+	for (TFuture<void>& Connection : Pending)
+	{
+		Connection.Wait();
+	}
+}
+
+void FHelikaMockCollector::SetConfig(const FHelikaMockCollectorConfig& InConfig)
+{
+	FScopeLock Lock(&ConfigLock);
+	if (InConfig.Seed != Config.Seed)
+	{
+		Random.Initialize(InConfig.Seed);
+	}
+	Config = InConfig;
+}
+
+FHelikaMockCollectorConfig FHelikaMockCollector::GetConfig() const
+{
+	FScopeLock Lock(&ConfigLock);
+	return Config;
+}
+
+FHelikaMockCollectorStats FHelikaMockCollector::GetStats() const
+{
+	FScopeLock Lock(&StatsLock);
+	return Stats;
+}
+
+void FHelikaMockCollector::ResetStats()
+{
+	FScopeLock Lock(&StatsLock);
+	Stats = FHelikaMockCollectorStats();
+}
+
+int32 FHelikaMockCollector::ValidateEnvelope(TConstArrayView<uint8> Body, FString& OutError, TArray<TPair<int32, FString>>* OutInvalidEvents)
+{
+	const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Body.GetData()), Body.Num());
+	const FString Json(Converter.Length(), Converter.Get());
+
+	TSharedPtr<FJsonObject> Envelope;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Envelope) || !Envelope.IsValid())
+	{
+		OutError = TEXT("Body is not a json object");
+		return INDEX_NONE;
+	}
+
+	FString Id;
+	if (!Envelope->TryGetStringField(TEXT("id"), Id) || Id.IsEmpty())
+	{
+		OutError = TEXT("Missing 'id'");
+		return INDEX_NONE;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Events = nullptr;
+	if (!Envelope->TryGetArrayField(TEXT("events"), Events) || Events->IsEmpty())
+	{
+		OutError = TEXT("Missing or empty 'events'");
+		return INDEX_NONE;
+	}
+
+	for (int32 Index = 0; Index < Events->Num(); ++Index)
+	{
+		const FString EventError = ValidateEvent((*Events)[Index], Index);
+		if (EventError.IsEmpty())
+		{
+			continue;
+		}
+		if (OutInvalidEvents == nullptr)
+		{
+			OutError = EventError;
+			return INDEX_NONE;
+		}
+		OutInvalidEvents->Emplace(Index, EventError);
+	}
+
+	return Events->Num();
+}
+
+bool FHelikaMockCollector::DecodeBody(const FString& Encoding, TArray<uint8>&& Body, TArray<uint8>& OutDecoded, FString& OutError)
+{
+	if (Encoding.IsEmpty() || Encoding == TEXT("identity"))
+	{
+		OutDecoded = MoveTemp(Body);
+		return true;
+	}
+
+	if (Encoding == TEXT("gzip"))
+	{
+		// The gzip trailer ends with the uncompressed size modulo 2^32
+		if (Body.Num() < 18)
+		{
+			OutError = TEXT("Truncated gzip body");
+			return false;
+		}
+		const uint8* Trailer = Body.GetData() + Body.Num() - 4;
+		const uint32 Size = Trailer[0] | (Trailer[1] << 8) | (Trailer[2] << 16) | (static_cast<uint32>(Trailer[3]) << 24);
+		if (Size > HelikaMockCollector::MaxBodyBytes)
+		{
+			OutError = TEXT("Decoded body is too large");
+			return false;
+		}
+
+		OutDecoded.SetNumUninitialized(Size);
+		if (!FCompression::UncompressMemory(NAME_Gzip, OutDecoded.GetData(), Size, Body.GetData(), Body.Num()))
+		{
+			OutError = TEXT("Corrupt gzip body");
+			return false;
+		}
+		return true;
+	}
+
+	OutError = FString::Printf(TEXT("Unsupported Content-Encoding '%s'"), *Encoding);
+	return false;
+}
+
+bool FHelikaMockCollector::DecodeBatchFormat(const FString& Format, TArray<uint8>& InOutBody, FString& OutError)
+{
+	if (Format.IsEmpty() || Format == TEXT("json"))
+	{
+		return true;
+	}
+
+	if (Format == FHelikaColumnarBatch::GetFormatName())
+	{
+		TArray<uint8> Envelope;
+		if (!FHelikaColumnarBatch::Decode(InOutBody, HelikaMockCollector::MaxBodyBytes, Envelope, OutError))
+		{
+			return false;
+		}
+		InOutBody = MoveTemp(Envelope);
+		return true;
+	}
+
+	OutError = FString::Printf(TEXT("Unsupported x-helika-batch-format '%s'"), *Format);
+	return false;
+}
+
+bool FHelikaMockCollector::HandleConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint)
+{
+	if (bStopping)
+	{
+		return false;
+	}
+
+	FScopeLock Lock(&ConnectionsLock);
+	Connections.RemoveAll([](const TFuture<void>& Connection)
+	{
+		return Connection.IsReady();
+	});
+	Connections.Add(Async(EAsyncExecution::Thread, [this, Socket]()
+	{
+		ServeConnection(Socket);
+	}));
+	return true;
+}
+
+void FHelikaMockCollector::ServeConnection(FSocket* Socket)
+{
+	TArray<uint8> Pending;
+	bool bKeepAlive = true;
+	while (bKeepAlive && !bStopping)
+	{
+		FRequest Request;
+		if (!ReadRequest(Socket, Pending, Request))
+		{
+			break;
+		}
+		HandleRequest(Socket, MoveTemp(Request), bKeepAlive);
+	}
+
+	Socket->Close();
+	ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+}
+
+bool FHelikaMockCollector::Receive(FSocket* Socket, TArray<uint8>& Pending) const
+{
+	while (!bStopping)
+	{
+		if (!Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromMilliseconds(100)))
+		{
+			if (Socket->GetConnectionState() != SCS_Connected)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		uint8 Chunk[16 * 1024];
+		int32 BytesRead = 0;
+		if (!Socket->Recv(Chunk, sizeof(Chunk), BytesRead) || BytesRead <= 0)
+		{
+			// Peer closed the connection
+			return false;
+		}
+		Pending.Append(Chunk, BytesRead);
+		return true;
+	}
+	return false;
+}
+
+bool FHelikaMockCollector::ReadRequest(FSocket* Socket, TArray<uint8>& Pending, FRequest& OutRequest)
+{
+	using namespace HelikaMockCollector;
+
+	int32 HeaderEnd = FindHeaderEnd(Pending);
+	while (HeaderEnd == INDEX_NONE)
+	{
+		if (Pending.Num() > MaxHeaderBytes || !Receive(Socket, Pending))
+		{
+			return false;
+		}
+		HeaderEnd = FindHeaderEnd(Pending);
+	}
+
+	const FString HeaderText(HeaderEnd, reinterpret_cast<const ANSICHAR*>(Pending.GetData()));
+	TArray<FString> Lines;
+	HeaderText.ParseIntoArray(Lines, TEXT("\r\n"));
+	if (Lines.IsEmpty())
+	{
+		return false;
+	}
+
+	TArray<FString> RequestLine;
+	Lines[0].ParseIntoArrayWS(RequestLine);
+	if (RequestLine.Num() < 2)
+	{
+		return false;
+	}
+	OutRequest.Method = RequestLine[0];
+	OutRequest.Path = RequestLine[1];
+
+	for (int32 Index = 1; Index < Lines.Num(); ++Index)
+	{
+		FString Name;
+		FString Value;
+		if (Lines[Index].Split(TEXT(":"), &Name, &Value))
+		{
+			OutRequest.Headers.Add(Name.TrimStartAndEnd().ToLower(), Value.TrimStartAndEnd());
+		}
+	}
+
+	const FString* ContentLengthHeader = OutRequest.Headers.Find(TEXT("content-length"));
+	const int64 ContentLength = ContentLengthHeader ? FCString::Atoi64(**ContentLengthHeader) : 0;
+	if (ContentLength < 0 || ContentLength > MaxBodyBytes)
+	{
+		SendResponse(Socket, 413, TEXT("{\"message\":\"Payload too large\"}"), 0);
+		return false;
+	}
+
+	const int64 RequestEnd = HeaderEnd + 4 + ContentLength;
+	const FString* Expect = OutRequest.Headers.Find(TEXT("expect"));
+	if (Pending.Num() < RequestEnd && Expect && Expect->Equals(TEXT("100-continue"), ESearchCase::IgnoreCase))
+	{
+		static const ANSICHAR Continue[] = "HTTP/1.1 100 Continue\r\n\r\n";
+		SendAll(Socket, reinterpret_cast<const uint8*>(Continue), sizeof(Continue) - 1);
+	}
+
+	while (Pending.Num() < RequestEnd)
+	{
+		if (!Receive(Socket, Pending))
+		{
+			return false;
+		}
+	}
+
+	OutRequest.Body.Append(Pending.GetData() + HeaderEnd + 4, ContentLength);
+	Pending.RemoveAt(0, RequestEnd, false);
+	return true;
+}
+
+void FHelikaMockCollector::HandleRequest(FSocket* Socket, FRequest&& Request, bool& bOutKeepAlive)
+{
+	using namespace HelikaMockCollector;
+
+	FHelikaMockRequestRecord Record;
+	Record.TimeSeconds = FPlatformTime::Seconds();
+	Record.Path = Request.Path;
+	const FString* EncodingHeader = Request.Headers.Find(TEXT("content-encoding"));
+	Record.Encoding = EncodingHeader ? EncodingHeader->ToLower() : TEXT("identity");
+	const FString* FormatHeader = Request.Headers.Find(TEXT("x-helika-batch-format"));
+	Record.Format = FormatHeader ? FormatHeader->ToLower() : TEXT("json");
+	Record.WireBytes = Request.Body.Num();
+
+	const FString* ConnectionHeader = Request.Headers.Find(TEXT("connection"));
+	bOutKeepAlive = !(ConnectionHeader && ConnectionHeader->Equals(TEXT("close"), ESearchCase::IgnoreCase));
+
+	// Always draw the same number of values so a seed replays the same faults
+	bool bDrop;
+	bool bInjectError;
+	int32 ErrorStatus;
+	int32 RetryAfterSeconds;
+	{
+		FScopeLock Lock(&ConfigLock);
+		const float Jitter = Random.GetFraction();
+		const float DropRoll = Random.GetFraction();
+		const float ErrorRoll = Random.GetFraction();
+		Record.InjectedLatencyMs = Config.LatencyMs + Config.LatencyJitterMs * Jitter;
+		bDrop = DropRoll < Config.DropRate;
+		bInjectError = !bDrop && ErrorRoll < Config.ErrorRate;
+		ErrorStatus = Config.ErrorStatus;
+		RetryAfterSeconds = (ErrorStatus == 429 || ErrorStatus == 503) ? Config.RetryAfterSeconds : 0;
+	}
+
+	if (Record.InjectedLatencyMs > 0.f)
+	{
+		FPlatformProcess::Sleep(Record.InjectedLatencyMs / 1000.f);
+	}
+
+	if (bDrop)
+	{
+		Record.Error = TEXT("Injected connection drop");
+		Record.bInjectedFault = true;
+		bOutKeepAlive = false;
+		AddRecord(MoveTemp(Record));
+		return;
+	}
+
+	FString ResponseBody;
+	if (bInjectError)
+	{
+		Record.Status = ErrorStatus;
+		Record.Error = TEXT("Injected failure");
+		Record.bInjectedFault = true;
+		ResponseBody = TEXT("{\"message\":\"Injected failure\"}");
+	}
+	else if (Request.Method == TEXT("HEAD"))
+	{
+		// Reachability probe of the upload scheduler, answered on every route
+		Record.Status = 200;
+		Record.bProbe = true;
+	}
+	else if (Request.Method != TEXT("POST") || !IsEventsPath(Request.Path))
+	{
+		Record.Status = 404;
+		Record.Error = TEXT("Unknown route");
+		ResponseBody = TEXT("{\"message\":\"Not found\"}");
+	}
+	else if (!Request.Headers.Contains(TEXT("x-api-key")))
+	{
+		Record.Status = 401;
+		Record.Error = TEXT("Missing x-api-key");
+		ResponseBody = TEXT("{\"message\":\"Missing x-api-key\"}");
+	}
+	else if (Record.Encoding != TEXT("identity") && Record.Encoding != TEXT("gzip"))
+	{
+		Record.Status = 415;
+		Record.Error = FString::Printf(TEXT("Unsupported Content-Encoding '%s'"), *Record.Encoding);
+		ResponseBody = TEXT("{\"message\":\"Unsupported Content-Encoding\"}");
+	}
+	else if (Record.Format != TEXT("json") && Record.Format != FHelikaColumnarBatch::GetFormatName())
+	{
+		Record.Status = 415;
+		Record.Error = FString::Printf(TEXT("Unsupported x-helika-batch-format '%s'"), *Record.Format);
+		ResponseBody = TEXT("{\"message\":\"Unsupported x-helika-batch-format\"}");
+	}
+	else
+	{
+		TArray<uint8> Decoded;
+		if (!DecodeBody(Record.Encoding, MoveTemp(Request.Body), Decoded, Record.Error))
+		{
+			// The encoding is supported, the body is corrupt
+			Record.Status = 400;
+		}
+		else
+		{
+			Record.DecodedBytes = Decoded.Num();
+			TArray<TPair<int32, FString>> Rejected;
+			const int32 NumEvents = DecodeBatchFormat(Record.Format, Decoded, Record.Error) ? ValidateEnvelope(Decoded, Record.Error, &Rejected) : INDEX_NONE;
+			if (NumEvents == INDEX_NONE)
+			{
+				Record.Status = 400;
+			}
+			else
+			{
+				TArray<int32> Retryable;
+				InjectEventFaults(NumEvents, Rejected, Retryable);
+
+				Record.NumRejected = Rejected.Num();
+				Record.NumRetryable = Retryable.Num();
+				Record.NumEvents = NumEvents - Record.NumRejected - Record.NumRetryable;
+				Record.Status = Record.NumRejected == NumEvents ? 400 : 200;
+				if (Record.NumRejected + Record.NumRetryable > 0)
+				{
+					Record.Error = FString::Printf(TEXT("%d events rejected, %d to retry"), Record.NumRejected, Record.NumRetryable);
+				}
+				if (Record.Status == 200 && OnBatchAccepted)
+				{
+					OnBatchAccepted(Decoded);
+				}
+				ResponseBody = MakeAcknowledgement(Record.NumEvents, Rejected, Retryable);
+			}
+		}
+
+		if (ResponseBody.IsEmpty())
+		{
+			ResponseBody = FString::Printf(TEXT("{\"message\":\"%s\"}"), *Record.Error.ReplaceCharWithEscapedChar());
+		}
+	}
+
+	if (!SendResponse(Socket, Record.Status, ResponseBody, bInjectError ? RetryAfterSeconds : 0))
+	{
+		bOutKeepAlive = false;
+	}
+	AddRecord(MoveTemp(Record));
+}
+
+void FHelikaMockCollector::InjectEventFaults(int32 NumEvents, TArray<TPair<int32, FString>>& InOutRejected, TArray<int32>& OutRetryable)
+{
+	FScopeLock Lock(&ConfigLock);
+	if (Config.EventRejectRate <= 0.f && Config.EventRetryRate <= 0.f)
+	{
+		return;
+	}
+
+	// One draw per event, malformed ones included, so a seed replays the same answers
+	int32 NextMalformed = 0;
+	for (int32 Index = 0; Index < NumEvents; ++Index)
+	{
+		const float Roll = Random.GetFraction();
+		if (InOutRejected.IsValidIndex(NextMalformed) && InOutRejected[NextMalformed].Key == Index)
+		{
+			++NextMalformed;
+			continue;
+		}
+		if (Roll < Config.EventRejectRate)
+		{
+			InOutRejected.Emplace(Index, TEXT("Injected rejection"));
+		}
+		else if (Roll < Config.EventRejectRate + Config.EventRetryRate)
+		{
+			OutRetryable.Add(Index);
+		}
+	}
+}
+
+FString FHelikaMockCollector::MakeAcknowledgement(int32 NumStored, const TArray<TPair<int32, FString>>& Rejected, const TArray<int32>& Retryable)
+{
+	FString Entries;
+	for (const TPair<int32, FString>& Entry : Rejected)
+	{
+		Entries += FString::Printf(TEXT("%s{\"index\":%d,\"retryable\":false,\"reason\":\"%s\"}"), Entries.IsEmpty() ? TEXT("") : TEXT(","), Entry.Key, *Entry.Value.ReplaceCharWithEscapedChar());
+	}
+	for (const int32 Index : Retryable)
+	{
+		Entries += FString::Printf(TEXT("%s{\"index\":%d,\"retryable\":true,\"reason\":\"Injected transient failure\"}"), Entries.IsEmpty() ? TEXT("") : TEXT(","), Index);
+	}
+	return FString::Printf(TEXT("{\"message\":\"%s\",\"events\":%d,\"rejected\":[%s]}"), NumStored > 0 || !Retryable.IsEmpty() ? TEXT("Event Track Success") : TEXT("Invalid events"), NumStored, *Entries);
+}
+
+bool FHelikaMockCollector::SendResponse(FSocket* Socket, int32 Status, const FString& Body, int32 RetryAfterSeconds)
+{
+	const FTCHARToUTF8 BodyUtf8(*Body);
+
+	FString Header = FString::Printf(TEXT("HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %d\r\n"), Status, HelikaMockCollector::GetReasonPhrase(Status), BodyUtf8.Length());
+	if (RetryAfterSeconds > 0)
+	{
+		Header += FString::Printf(TEXT("Retry-After: %d\r\n"), RetryAfterSeconds);
+	}
+	Header += TEXT("\r\n");
+	const FTCHARToUTF8 HeaderUtf8(*Header);
+
+	return HelikaMockCollector::SendAll(Socket, reinterpret_cast<const uint8*>(HeaderUtf8.Get()), HeaderUtf8.Length())
+		&& HelikaMockCollector::SendAll(Socket, reinterpret_cast<const uint8*>(BodyUtf8.Get()), BodyUtf8.Length());
+}
+
+void FHelikaMockCollector::AddRecord(FHelikaMockRequestRecord&& Record)
+{
+	FScopeLock Lock(&StatsLock);
+	++Stats.Requests;
+	Stats.WireBytes += Record.WireBytes;
+	Stats.DecodedBytes += Record.DecodedBytes;
+	Stats.RequestsPerEncoding.FindOrAdd(Record.Encoding)++;
+	Stats.RequestsPerFormat.FindOrAdd(Record.Format)++;
+
+	if (Record.Status == 0)
+	{
+		++Stats.Dropped;
+	}
+	else if (Record.bProbe)
+	{
+		++Stats.Probes;
+	}
+	else if (Record.Status == 200)
+	{
+		++Stats.Accepted;
+		Stats.Events += Record.NumEvents;
+	}
+	else if (Record.bInjectedFault)
+	{
+		++Stats.InjectedErrors;
+	}
+	else
+	{
+		++Stats.Invalid;
+	}
+	Stats.RejectedEvents += Record.NumRejected;
+	Stats.RetryableEvents += Record.NumRetryable;
+
+	if (Stats.Records.Num() < HelikaMockCollector::MaxRecords)
+	{
+		Stats.Records.Add(MoveTemp(Record));
+	}
+}
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Math/RandomStream.h"
+#include <atomic>
+
+class FSocket;
+class FTcpListener;
+struct FIPv4Endpoint;
+
+/// Faults injected by the mock collector, every rate is a probability per request
+struct FHelikaMockCollectorConfig
+{
+	int32 Port = 8181;
+	/// Listen on every interface instead of loopback only, exposes the fault injection to the network
+	bool bBindAny = false;
+
+	/// Delay added before answering
+	float LatencyMs = 0.f;
+	float LatencyJitterMs = 0.f;
+
+	/// Fraction of requests answered with ErrorStatus instead of being processed
+	float ErrorRate = 0.f;
+	int32 ErrorStatus = 503;
+
+	/// Retry-After seconds sent with injected 429/503 answers, 0 to omit the header
+	int32 RetryAfterSeconds = 0;
+
+	/// Fraction of requests whose connection is closed without any answer
+	float DropRate = 0.f;
+
+	/// Fraction of the events of a valid batch answered as invalid or as failed transiently, for partial acknowledgements
+	float EventRejectRate = 0.f;
+	float EventRetryRate = 0.f;
+
+	/// Seed of the fault injection so runs are reproducible
+	int32 Seed = 0;
+};
+
+/// What the collector saw and answered for one request
+struct FHelikaMockRequestRecord
+{
+	double TimeSeconds = 0.0;
+	FString Path;
+	FString Encoding;
+	/// x-helika-batch-format of the body, json for the row envelope
+	FString Format;
+	int64 WireBytes = 0;
+	int64 DecodedBytes = 0;
+	/// Events stored
+	int32 NumEvents = 0;
+	/// Events listed in the answer as invalid or as retryable
+	int32 NumRejected = 0;
+	int32 NumRetryable = 0;
+	/// Status sent back, 0 when the connection was dropped
+	int32 Status = 0;
+	float InjectedLatencyMs = 0.f;
+	/// The status or drop was injected rather than caused by the request
+	bool bInjectedFault = false;
+	/// HEAD reachability probe, not counted as an accepted batch
+	bool bProbe = false;
+	FString Error;
+};
+
+struct FHelikaMockCollectorStats
+{
+	int64 Requests = 0;
+	int64 Accepted = 0;
+	int64 Invalid = 0;
+	int64 InjectedErrors = 0;
+	int64 Dropped = 0;
+	int64 Probes = 0;
+	int64 Events = 0;
+	int64 RejectedEvents = 0;
+	int64 RetryableEvents = 0;
+	int64 WireBytes = 0;
+	int64 DecodedBytes = 0;
+	TMap<FString, int64> RequestsPerEncoding;
+	TMap<FString, int64> RequestsPerFormat;
+	TArray<FHelikaMockRequestRecord> Records;
+
+	/// Summary and every request record as JSON
+	FString ToJson() const;
+};
+
+/**
+ * Minimal HTTP/1.1 stand-in for the Helika collector used by the Localhost environment.
+ *
+ * Accepts POST /events/ (with or without the /v1 prefix) in every encoding and batch format the SDK produces and HEAD probes on any route,
+ * validates the envelope, records per-request stats and injects latency, error statuses,
+ * Retry-After headers, connection drops and per-event rejections so the upload pipeline can be exercised offline.
+ * Malformed or rejected events are listed in the answer as {"rejected": [{"index", "retryable", "reason"}]}.
+ */
+class FHelikaMockCollector
+{
+public:
+	explicit FHelikaMockCollector(const FHelikaMockCollectorConfig& InConfig);
+	~FHelikaMockCollector();
+
+	bool Start();
+	void Stop();
+	bool IsRunning() const { return Listener.IsValid(); }
+
+	/// Changes the injected faults while running
+	void SetConfig(const FHelikaMockCollectorConfig& InConfig);
+	FHelikaMockCollectorConfig GetConfig() const;
+
+	FHelikaMockCollectorStats GetStats() const;
+	void ResetStats();
+
+	/// Called on the connection thread with the decoded body of every accepted batch, set it before Start
+	void SetOnBatchAccepted(TFunction<void(TConstArrayView<uint8>)>&& InOnBatchAccepted) { OnBatchAccepted = MoveTemp(InOnBatchAccepted); }
+
+	/**
+	 * Validates a decoded envelope, returns the number of events or INDEX_NONE with OutError set.
+	 * With OutInvalidEvents, malformed events are listed there by index instead of failing the envelope.
+	 */
+	static int32 ValidateEnvelope(TConstArrayView<uint8> Body, FString& OutError, TArray<TPair<int32, FString>>* OutInvalidEvents = nullptr);
+
+	/// Decodes the body according to Content-Encoding, returns false for unsupported or corrupt payloads
+	static bool DecodeBody(const FString& Encoding, TArray<uint8>&& Body, TArray<uint8>& OutDecoded, FString& OutError);
+
+	/// Turns a decoded body of the given x-helika-batch-format back into the row envelope, returns false for unsupported or corrupt batches
+	static bool DecodeBatchFormat(const FString& Format, TArray<uint8>& InOutBody, FString& OutError);
+
+private:
+	struct FRequest
+	{
+		FString Method;
+		FString Path;
+		TMap<FString, FString> Headers;
+		TArray<uint8> Body;
+	};
+
+	bool HandleConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint);
+	void ServeConnection(FSocket* Socket);
+	bool Receive(FSocket* Socket, TArray<uint8>& Pending) const;
+	bool ReadRequest(FSocket* Socket, TArray<uint8>& Pending, FRequest& OutRequest);
+	void HandleRequest(FSocket* Socket, FRequest&& Request, bool& bOutKeepAlive);
+	/// Rolls EventRejectRate and EventRetryRate for every event that is not already rejected
+	void InjectEventFaults(int32 NumEvents, TArray<TPair<int32, FString>>& InOutRejected, TArray<int32>& OutRetryable);
+	static FString MakeAcknowledgement(int32 NumStored, const TArray<TPair<int32, FString>>& Rejected, const TArray<int32>& Retryable);
+	static bool SendResponse(FSocket* Socket, int32 Status, const FString& Body, int32 RetryAfterSeconds);
+	void AddRecord(FHelikaMockRequestRecord&& Record);
+
+	TUniquePtr<FTcpListener> Listener;
+	TArray<TFuture<void>> Connections;
+	FCriticalSection ConnectionsLock;
+	std::atomic<bool> bStopping{false};
+
+	FHelikaMockCollectorConfig Config;
+	FRandomStream Random;
+	mutable FCriticalSection ConfigLock;
+
+	FHelikaMockCollectorStats Stats;
+	mutable FCriticalSection StatsLock;
+
+	TFunction<void(TConstArrayView<uint8>)> OnBatchAccepted;
+};
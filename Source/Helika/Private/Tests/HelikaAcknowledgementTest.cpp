@@ -0,0 +1,85 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaAcknowledgement.h"
+#include "HelikaDefines.h"
+#include "HelikaEventQueue.h"
+#include "HelikaMetricsCounters.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	TArray<uint8> ToUtf8(const FString& Text)
+	{
+		const FTCHARToUTF8 Utf8(*Text);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	TArray<FHelikaQueuedEvent> MakeBatch(int32 NumEvents)
+	{
+		TArray<FHelikaQueuedEvent> Batch;
+		for (int32 Index = 0; Index < NumEvents; ++Index)
+		{
+			FHelikaQueuedEvent& Event = Batch.AddDefaulted_GetRef();
+			Event.Event = MakeShareable(new FJsonObject());
+			Event.Event->SetNumberField("position", Index);
+		}
+		return Batch;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaAcknowledgementTest, "Helika.HelikaAcknowledgementTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaAcknowledgementTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// Without a list the status settles the whole batch
+	TestEqual("Success accepts every event", FHelikaAcknowledgement::Parse(4, 200, ToUtf8(TEXT("{\"message\":\"Event Track Success\"}"))).NumAccepted, 4);
+	TestEqual("Server errors are retried", FHelikaAcknowledgement::Parse(4, 503, TArray<uint8>()).NumRetry, 4);
+	TestEqual("Throttling is retried", FHelikaAcknowledgement::Parse(4, 429, TArray<uint8>()).NumRetry, 4);
+	TestEqual("Connection failures are retried", FHelikaAcknowledgement::Parse(4, 0, TArray<uint8>()).NumRetry, 4);
+	TestEqual("Refused batches are invalid", FHelikaAcknowledgement::Parse(4, 400, ToUtf8(TEXT("{\"message\":\"Missing 'id'\"}"))).NumInvalid, 4);
+
+	// Listed events are settled one by one, malformed entries are ignored
+	const FHelikaAcknowledgement Partial = FHelikaAcknowledgement::Parse(5, 200, ToUtf8(TEXT("{\"rejected\":[{\"index\":1,\"reason\":\"bad\"},{\"index\":3,\"retryable\":true},{\"index\":9},\"oops\"]}")));
+	TestEqual("Unlisted events are accepted", Partial.NumAccepted, 3);
+	TestTrue("Rejected event is invalid", Partial.Results[1] == EHelikaEventResult::Invalid);
+	TestTrue("Retryable event is retried", Partial.Results[3] == EHelikaEventResult::Retry);
+
+	const FHelikaAcknowledgement AllInvalid = FHelikaAcknowledgement::Parse(2, 400, ToUtf8(TEXT("{\"rejected\":[{\"index\":0},{\"index\":1}]}")));
+	TestEqual("A listed refusal only drops the listed events", AllInvalid.NumInvalid, 2);
+
+	// Only the retryable event goes back to the queue
+	FHelikaEventQueue Queue;
+	const FHelikaMetrics Before = FHelikaMetricsCounters::Read();
+	TestEqual("One event is queued again", Partial.Apply(MakeBatch(5), &Queue, 1), 1);
+	const FHelikaMetrics After = FHelikaMetricsCounters::Read();
+	TestEqual("Accepted events are counted as sent", After.EventsSent - Before.EventsSent, 3ll);
+	TestEqual("Invalid events are counted as dropped", After.EventsDropped - Before.EventsDropped, 1ll);
+	TestEqual("Retries are counted", After.Retries - Before.Retries, 1ll);
+
+	TArray<FHelikaQueuedEvent> Retried;
+	if (TestTrue("Retried event is queued", Queue.DequeueBatch(Retried, 10)) && TestEqual("Only the retryable event", Retried.Num(), 1))
+	{
+		FHelikaMetricsCounters::Add(EHelikaCounter::QueueDepth, -Retried.Num());
+
+		TestEqual("The retryable event is queued", Retried[0].Event->GetIntegerField("position"), 3);
+		TestEqual("The attempt is counted", Retried[0].NumRetries, 1);
+
+		// Out of retries, the event is dropped
+		const FHelikaAcknowledgement Failed = FHelikaAcknowledgement::Parse(1, 503, TArray<uint8>());
+		TestEqual("Exhausted events are not queued", Failed.Apply(MoveTemp(Retried), &Queue, 1), 0);
+		TestEqual("Queue stays empty", Queue.Num(), 0);
+	}
+
+	// Retries are dropped once the manager and its queue are gone
+	TestEqual("No queue, no retry", FHelikaAcknowledgement::Parse(2, 503, TArray<uint8>()).Apply(MakeBatch(2), nullptr, 3), 0);
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
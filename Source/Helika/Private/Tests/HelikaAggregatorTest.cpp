@@ -0,0 +1,183 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Aggregator/HelikaAggregator.h"
+#include "HelikaDefines.h"
+#include "HelikaSidecarTransport.h"
+#include "HelikaTransport.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Compression.h"
+#include "Misc/Paths.h"
+
+#if HELIKA_WITH_SIDECAR
+#include <sys/stat.h>
+#endif
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace HelikaAggregatorTest
+{
+	static TArray<uint8> ToBytes(const FString& Text)
+	{
+		const FTCHARToUTF8 Converted(*Text);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+	}
+
+	static FString ToString(TConstArrayView<uint8> Bytes)
+	{
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Bytes.GetData()), Bytes.Num());
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	static FHelikaTransportRequest MakeRequest(const FString& Envelope)
+	{
+		FHelikaTransportRequest Request;
+		Request.Url = TEXT("http://collector/events/");
+		Request.AddHeader(TEXT("Content-Type"), TEXT("application/json"));
+		Request.AddHeader(TEXT("x-api-key"), TEXT("TestAPIKey"));
+		Request.Body = ToBytes(Envelope);
+		return Request;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaAggregatorTest, "Helika.HelikaAggregatorTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaAggregatorTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// Frames survive the stream byte for byte and are only parsed once complete
+	const FHelikaTransportRequest Request = HelikaAggregatorTest::MakeRequest(TEXT("{\"id\":\"a\",\"events\":[{\"n\":1}]}"));
+	TArray<uint8> Stream;
+	FHelikaSidecarFrame::WriteHeader(Request, Stream);
+	Stream.Append(Request.Body);
+	FHelikaSidecarFrame Frame;
+	TestEqual("Incomplete frame waits", FHelikaSidecarFrame::Parse(TConstArrayView<uint8>(Stream).LeftChop(1), Frame), 0);
+	TestEqual("Complete frame is parsed", FHelikaSidecarFrame::Parse(Stream, Frame), Stream.Num());
+	TestEqual("Url is kept", Frame.Url, Request.Url);
+	TestEqual("Headers are kept", Frame.Headers.Num(), 2);
+	TestTrue("Body is kept", Frame.Body == TConstArrayView<uint8>(Request.Body));
+	Stream[0] ^= 0xFF;
+	TestEqual("Bad magic is corrupt", FHelikaSidecarFrame::Parse(Stream, Frame), static_cast<int32>(INDEX_NONE));
+
+	// Events are split at the top level of the events array only, strings may contain anything
+	const TArray<uint8> Envelope = HelikaAggregatorTest::ToBytes(TEXT("{\"id\":\"b\", \"events\": [ {\"s\":\"],{\\\"\",\"a\":[1,2]}, 3 ,\"x\"], \"events2\":[]}"));
+	TArray<TPair<int32, int32>> Ranges;
+	TestTrue("Envelope is split", FHelikaAggregator::SplitEvents(Envelope, Ranges));
+	if (TestEqual("Every event is found", Ranges.Num(), 3))
+	{
+		TestEqual("Nested event", HelikaAggregatorTest::ToString(TConstArrayView<uint8>(Envelope).Slice(Ranges[0].Key, Ranges[0].Value)), FString(TEXT("{\"s\":\"],{\\\"\",\"a\":[1,2]}")));
+		TestEqual("Number event", HelikaAggregatorTest::ToString(TConstArrayView<uint8>(Envelope).Slice(Ranges[1].Key, Ranges[1].Value)), FString(TEXT("3")));
+		TestEqual("String event", HelikaAggregatorTest::ToString(TConstArrayView<uint8>(Envelope).Slice(Ranges[2].Key, Ranges[2].Value)), FString(TEXT("\"x\"")));
+	}
+	TestTrue("Empty batch is valid", FHelikaAggregator::SplitEvents(HelikaAggregatorTest::ToBytes(TEXT("{\"events\":[]}")), Ranges) && Ranges.Num() == 0);
+	TestFalse("Truncated envelope is refused", FHelikaAggregator::SplitEvents(HelikaAggregatorTest::ToBytes(TEXT("{\"events\":[{\"n\":1}")), Ranges));
+	TestFalse("Envelope without events is refused", FHelikaAggregator::SplitEvents(HelikaAggregatorTest::ToBytes(TEXT("{\"id\":\"c\"}")), Ranges));
+
+#if HELIKA_WITH_SIDECAR
+	// Two processes upload through the aggregator, their batches leave the host as one compressed request
+	const FString Directory = FPaths::ProjectIntermediateDir() / TEXT("HelikaAggregatorTest");
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	FHelikaAggregatorConfig Config;
+	const FString SocketDirectory = FString::Printf(TEXT("/tmp/helika-aggregator-test-%u"), FPlatformProcess::GetCurrentProcessId());
+	Config.SocketPath = SocketDirectory / TEXT("aggregator.sock");
+	Config.SpillDirectory = Directory / TEXT("Spill");
+	const TSharedRef<FHelikaInMemoryTransport, ESPMode::ThreadSafe> Upstream = MakeShared<FHelikaInMemoryTransport, ESPMode::ThreadSafe>();
+	{
+		FHelikaAggregator Aggregator(Config, Upstream);
+		if (TestTrue("Aggregator listens", Aggregator.Start()))
+		{
+			struct stat Info;
+			TestTrue("Socket directory is private", stat(TCHAR_TO_UTF8(*SocketDirectory), &Info) == 0 && (Info.st_mode & 0777) == S_IRWXU);
+			TestTrue("Socket is private", stat(TCHAR_TO_UTF8(*Config.SocketPath), &Info) == 0 && (Info.st_mode & 0777) == (S_IRUSR | S_IWUSR));
+			FHelikaAggregator Rival(Config, Upstream);
+			TestFalse("Socket of a running aggregator is not taken over", Rival.Start());
+
+			FHelikaTransportConfig TransportConfig;
+			TransportConfig.SidecarSocketPath = Config.SocketPath;
+			FHelikaSidecarTransport First(TransportConfig);
+			FHelikaSidecarTransport Second(TransportConfig);
+			TArray<int32> Statuses;
+			const auto OnComplete = [&Statuses](FHelikaTransportResponse&& Response) { Statuses.Add(Response.Status); };
+			First.Send(HelikaAggregatorTest::MakeRequest(TEXT("{\"id\":\"1\",\"events\":[{\"n\":1},{\"n\":2}]}")), OnComplete);
+			Second.Send(HelikaAggregatorTest::MakeRequest(TEXT("{\"id\":\"2\",\"events\":[{\"n\":3},{\"n\":4},{\"n\":5}]}")), OnComplete);
+			TestTrue("Processes hand their uploads over at once", Statuses.Num() == 2 && Statuses[0] == 202 && Statuses[1] == 202);
+
+			const double Deadline = FPlatformTime::Seconds() + 5.0;
+			while (Aggregator.GetStats().Events < 5 && FPlatformTime::Seconds() < Deadline)
+			{
+				FPlatformProcess::Sleep(0.01f);
+			}
+			TestTrue("Aggregator drains", Aggregator.Drain(5.f));
+
+			const TArray<FHelikaTransportRequest> Sent = Upstream->GetSent();
+			if (TestEqual("Batches are merged into one upload", Sent.Num(), 1))
+			{
+				const FString* Encoding = Sent[0].FindHeader(TEXT("Content-Encoding"));
+				TestTrue("Upload is compressed", Encoding != nullptr && *Encoding == TEXT("gzip"));
+				TestTrue("API key is forwarded", Sent[0].FindHeader(TEXT("x-api-key")) != nullptr);
+
+				// The uncompressed size is the last field of the gzip trailer
+				const TArray<uint8>& Body = Sent[0].Body;
+				TArray<uint8> Uncompressed;
+				Uncompressed.SetNumUninitialized(Body.Num() >= 4 ? Body[Body.Num() - 4] | (Body[Body.Num() - 3] << 8) | (Body[Body.Num() - 2] << 16) : 0);
+				TestTrue("Upload is valid gzip", FCompression::UncompressMemory(NAME_Gzip, Uncompressed.GetData(), Uncompressed.Num(), Body.GetData(), Body.Num()));
+				TestTrue("Upload carries every event", FHelikaAggregator::SplitEvents(Uncompressed, Ranges) && Ranges.Num() == 5);
+			}
+			TestEqual("Every event is accepted", Aggregator.GetStats().AcceptedEvents, static_cast<int64>(5));
+
+			// Without an aggregator the processes go offline instead of blocking
+			Aggregator.Stop();
+			FHelikaSidecarTransport Late(TransportConfig);
+			Statuses.Reset();
+			Late.Send(HelikaAggregatorTest::MakeRequest(TEXT("{\"id\":\"3\",\"events\":[]}")), OnComplete);
+			TestTrue("Upload without aggregator is unanswered", Statuses.Num() == 1 && Statuses[0] == 0);
+		}
+	}
+
+	// Batches the collector could not take are kept on disk and uploaded by the next run
+	Upstream->ResetSent();
+	Upstream->SetHandler([](const FHelikaTransportRequest&) { return FHelikaTransportResponse(); });
+	{
+		FHelikaAggregator Aggregator(Config, Upstream);
+		if (TestTrue("Aggregator listens again", Aggregator.Start()))
+		{
+			FHelikaTransportConfig TransportConfig;
+			TransportConfig.SidecarSocketPath = Config.SocketPath;
+			FHelikaSidecarTransport Process(TransportConfig);
+			Process.Send(HelikaAggregatorTest::MakeRequest(TEXT("{\"id\":\"4\",\"events\":[{\"n\":6}]}")), [](FHelikaTransportResponse&&) {});
+			const double Deadline = FPlatformTime::Seconds() + 5.0;
+			while (Aggregator.GetStats().Events < 1 && FPlatformTime::Seconds() < Deadline)
+			{
+				FPlatformProcess::Sleep(0.01f);
+			}
+			Aggregator.Stop();
+			Aggregator.Drain(1.f);
+			TestEqual("Unanswered upload fails", Aggregator.GetStats().FailedUploads, static_cast<int64>(1));
+			TestEqual("Unanswered batch is spilled", Aggregator.GetStats().SpilledBatches, static_cast<int64>(1));
+		}
+	}
+	Upstream->ResetSent();
+	Upstream->SetHandler(nullptr);
+	{
+		FHelikaAggregator Aggregator(Config, Upstream);
+		if (TestTrue("Aggregator restarts", Aggregator.Start()))
+		{
+			Aggregator.Tick();
+			Aggregator.Tick();
+			TestEqual("Spilled batch is uploaded", Upstream->GetSent().Num(), 1);
+			TestEqual("Spilled event is accepted", Aggregator.GetStats().AcceptedEvents, static_cast<int64>(1));
+			Aggregator.Stop();
+		}
+	}
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	IFileManager::Get().DeleteDirectory(*SocketDirectory, false, true);
+#endif
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
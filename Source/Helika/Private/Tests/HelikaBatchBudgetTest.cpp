@@ -0,0 +1,161 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaBatchSerializer.h"
+#include "HelikaClock.h"
+#include "HelikaConfigSnapshot.h"
+#include "HelikaDefines.h"
+#include "HelikaJsonWriter.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	FHelikaQueuedEvent MakeEvent(const FHelikaConfigSnapshotPtr& Config, const FHelikaContextDataPtr& Context, int32 PayloadChars)
+	{
+		FHelikaQueuedEvent Event;
+		Event.Event = MakeShareable(new FJsonObject());
+		Event.Event->SetStringField("event_type", "test");
+		const TSharedPtr<FJsonObject> SubEvent = MakeShareable(new FJsonObject());
+		SubEvent->SetStringField("event_sub_type", "test_sub");
+		SubEvent->SetStringField("blob", FString::ChrN(PayloadChars, TEXT('a')));
+		SubEvent->SetNumberField("level", 3);
+		Event.Event->SetObjectField("event", SubEvent);
+		Event.Context = Context;
+		Event.Config = Config;
+		return Event;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> ParseEvents(TConstArrayView<uint8> Payload)
+	{
+		TSharedPtr<FJsonObject> Envelope;
+		const TArray<TSharedPtr<FJsonValue>>* Events = nullptr;
+		if (FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FHelikaJsonWriter::ToString(Payload)), Envelope) && Envelope.IsValid() && Envelope->TryGetArrayField(TEXT("events"), Events))
+		{
+			return *Events;
+		}
+		return {};
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaBatchBudgetTest, "Helika.HelikaBatchBudgetTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaBatchBudgetTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> Config = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+	Config->AppDetails = MakeShareable(new FJsonObject());
+	const TSharedRef<FHelikaContextData, ESPMode::ThreadSafe> Context = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>();
+	Context->AnonymousId = "anon";
+	Context->UserDetails = MakeShareable(new FJsonObject());
+
+	FHelikaBatchLimits Limits;
+	Limits.MaxBatchBytes = 4000;
+	Limits.MaxEventBytes = 3000;
+
+	TArray<FHelikaQueuedEvent> Events;
+	for (int32 Index = 0; Index < 10; ++Index)
+	{
+		Events.Add(MakeEvent(Config, Context, 1000));
+	}
+
+	// The envelope is cut before the event that would exceed the budget
+	FHelikaBatchSerializer Serializer;
+	TArray<uint8> Payload;
+	TArray<int32> Written;
+	const int32 NumConsumed = Serializer.SerializeBudgeted(Events, Limits, Limits.MaxBatchBytes, Payload, Written);
+	TestTrue("Batch is cut", NumConsumed > 1 && NumConsumed < Events.Num());
+	TestEqual("Every consumed event is written", Written.Num(), NumConsumed);
+	TestTrue("Envelope stays within the budget", Payload.Num() <= Limits.MaxBatchBytes);
+	TestEqual("Cut envelope is valid json", ParseEvents(Payload).Num(), NumConsumed);
+
+	// Splitting the whole array writes every event exactly once
+	int32 Offset = 0;
+	int32 NumEnvelopes = 0;
+	while (Offset < Events.Num())
+	{
+		Payload.Reset();
+		Offset += Serializer.SerializeBudgeted(TConstArrayView<FHelikaQueuedEvent>(Events).RightChop(Offset), Limits, Limits.MaxBatchBytes, Payload, Written);
+		TestTrue("Every envelope stays within the budget", Payload.Num() <= Limits.MaxBatchBytes);
+		++NumEnvelopes;
+	}
+	TestTrue("Large arrays are split across envelopes", NumEnvelopes >= 3);
+
+	// An event larger than the batch budget but under the event cap travels alone
+	Payload.Reset();
+	const TArray<FHelikaQueuedEvent> Large = {MakeEvent(Config, Context, 2500), MakeEvent(Config, Context, 2500)};
+	TestEqual("Large event is consumed alone", Serializer.SerializeBudgeted(Large, Limits, 2000, Payload, Written), 1);
+	TestEqual("Large event is written", Written.Num(), 1);
+
+	// Oversized events are truncated below the cap or dropped
+	Payload.Reset();
+	const TArray<FHelikaQueuedEvent> Oversized = {MakeEvent(Config, Context, 10000), MakeEvent(Config, Context, 10)};
+	TestEqual("Truncate policy consumes both", Serializer.SerializeBudgeted(Oversized, Limits, Limits.MaxBatchBytes, Payload, Written), 2);
+	TestEqual("Truncated event is kept", Written.Num(), 2);
+	const TArray<TSharedPtr<FJsonValue>> Parsed = ParseEvents(Payload);
+	if (TestEqual("Truncated envelope is valid json", Parsed.Num(), 2))
+	{
+		const TSharedPtr<FJsonObject> Internal = Parsed[0]->AsObject()->GetObjectField(TEXT("event"));
+		TestTrue("Truncated event is marked", Internal->GetBoolField(TEXT("truncated")));
+		TestEqual("Routing fields are kept", Internal->GetStringField(TEXT("event_sub_type")), FString("test_sub"));
+		TestTrue("Largest value is cut", Internal->GetStringField(TEXT("blob")).Len() < 3000);
+		TestTrue("Envelope fits the event cap plus the small event", Payload.Num() < Limits.MaxEventBytes + 1000);
+	}
+
+	Limits.OversizedEventPolicy = EHelikaOversizedEventPolicy::HOE_Reject;
+	Payload.Reset();
+	TestEqual("Reject policy consumes both", Serializer.SerializeBudgeted(Oversized, Limits, Limits.MaxBatchBytes, Payload, Written), 2);
+	TestTrue("Only the small event is written", Written.Num() == 1 && Written[0] == 1);
+	TestEqual("Rejected envelope is valid json", ParseEvents(Payload).Num(), 1);
+
+	// The parallel path assembles the same envelope as the serial one, budget cut and oversized events included
+	TArray<FHelikaQueuedEvent> Mixed;
+	for (int32 Index = 0; Index < 700; ++Index)
+	{
+		Mixed.Add(MakeEvent(Config, Context, Index % 97 == 0 ? 10000 : 100 + (Index % 13) * 40));
+	}
+	const auto SerializeWith = [&Serializer, &Mixed](const FHelikaBatchLimits& InLimits, int64 MaxBatchBytes, TArray<uint8>& OutPayload, TArray<int32>& OutWritten)
+	{
+		// Same envelope id for every run
+		FHelikaSequentialIdGenerator IdGenerator(1);
+		FHelikaClock::SetIdGenerator(&IdGenerator);
+		OutPayload.Reset();
+		const int32 Consumed = Serializer.SerializeBudgeted(Mixed, InLimits, MaxBatchBytes, OutPayload, OutWritten);
+		FHelikaClock::SetIdGenerator(nullptr);
+		return Consumed;
+	};
+	for (const EHelikaOversizedEventPolicy Policy : {EHelikaOversizedEventPolicy::HOE_Truncate, EHelikaOversizedEventPolicy::HOE_Reject})
+	{
+		for (const int64 MaxBatchBytes : {int64(1) << 30, int64(200000)})
+		{
+			FHelikaBatchLimits SerialLimits = Limits;
+			SerialLimits.OversizedEventPolicy = Policy;
+			FHelikaBatchLimits ParallelLimits = SerialLimits;
+			ParallelLimits.ParallelThreshold = 1;
+			ParallelLimits.MaxParallelTasks = 2;
+
+			TArray<uint8> SerialPayload;
+			TArray<int32> SerialWritten;
+			TArray<uint8> ParallelPayload;
+			TArray<int32> ParallelWritten;
+			const int32 SerialConsumed = SerializeWith(SerialLimits, MaxBatchBytes, SerialPayload, SerialWritten);
+			TestEqual("Parallel path consumes the same events", SerializeWith(ParallelLimits, MaxBatchBytes, ParallelPayload, ParallelWritten), SerialConsumed);
+			TestEqual("Parallel path writes the same events", ParallelWritten, SerialWritten);
+			TestTrue("Parallel envelope is identical", ParallelPayload == SerialPayload);
+			TestEqual("Parallel envelope is valid json", ParseEvents(ParallelPayload).Num(), ParallelWritten.Num());
+		}
+	}
+
+	// The compressed budget is turned into an uncompressed one
+	TestEqual("Uncompressed budget", FHelikaBatchSerializer::GetBatchBudget(Limits, false), Limits.MaxBatchBytes);
+	TestTrue("Compressed budget never exceeds the uncompressed one", FHelikaBatchSerializer::GetBatchBudget(Limits, true) <= Limits.MaxBatchBytes);
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
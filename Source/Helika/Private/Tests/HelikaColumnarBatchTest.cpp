@@ -0,0 +1,135 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaBatchSerializer.h"
+#include "HelikaColumnarBatch.h"
+#include "HelikaConfigSnapshot.h"
+#include "HelikaDefines.h"
+#include "MockCollector/HelikaMockCollector.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	const TCHAR* Maps[] = {TEXT("arctic"), TEXT("dust"), TEXT("inferno")};
+	const TCHAR* Teams[] = {TEXT("counter-terrorists"), TEXT("terrorists")};
+
+	FHelikaQueuedEvent MakeKillEvent(const FHelikaConfigSnapshotPtr& Config, const FHelikaContextDataPtr& Context, int32 Index)
+	{
+		FHelikaQueuedEvent Event;
+		Event.Event = MakeShareable(new FJsonObject());
+		Event.Event->SetStringField("event_type", "kill");
+		Event.Event->SetStringField("created_at", (FDateTime(2026, 10, 19, 12) + FTimespan::FromMilliseconds(Index * 250 + Index % 7)).ToIso8601());
+		const TSharedPtr<FJsonObject> SubEvent = MakeShareable(new FJsonObject());
+		SubEvent->SetStringField("event_sub_type", "player_killed");
+		SubEvent->SetStringField("map", Maps[Index % UE_ARRAY_COUNT(Maps)]);
+		SubEvent->SetStringField("team", Teams[(Index / 3) % UE_ARRAY_COUNT(Teams)]);
+		SubEvent->SetNumberField("sequence", 1000 + Index);
+		SubEvent->SetNumberField("damage", (Index * 37) % 100);
+		Event.Event->SetObjectField("event", SubEvent);
+		Event.Context = Context;
+		Event.Config = Config;
+		return Event;
+	}
+
+	FHelikaQueuedEvent MakePurchaseEvent(const FHelikaConfigSnapshotPtr& Config, const FHelikaContextDataPtr& Context, int32 Index)
+	{
+		FHelikaQueuedEvent Event;
+		Event.Event = MakeShareable(new FJsonObject());
+		Event.Event->SetStringField("event_type", "purchase");
+		const TSharedPtr<FJsonObject> SubEvent = MakeShareable(new FJsonObject());
+		SubEvent->SetStringField("item", FString::Printf(TEXT("crate \"%d\"\\\n"), Index));
+		SubEvent->SetNumberField("price", 4.99 + Index);
+		SubEvent->SetBoolField("gift", Index % 2 == 0);
+		SubEvent->SetArrayField("bundle", {MakeShared<FJsonValueNumber>(1), MakeShared<FJsonValueString>(TEXT("skin")), MakeShared<FJsonValueNull>()});
+		Event.Event->SetObjectField("event", SubEvent);
+		Event.Context = Context;
+		Event.Config = Config;
+		return Event;
+	}
+
+	TArray<uint8> ToUtf8(const FString& Text)
+	{
+		const FTCHARToUTF8 Utf8(*Text);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaColumnarBatchTest, "Helika.HelikaColumnarBatchTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaColumnarBatchTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> Config = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+	Config->AppDetails = MakeShareable(new FJsonObject());
+	const TSharedRef<FHelikaContextData, ESPMode::ThreadSafe> Context = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>();
+	Context->SessionId = "session";
+	Context->AnonymousId = "anon";
+	Context->UserDetails = MakeShareable(new FJsonObject());
+
+	FHelikaBatchLimits Limits;
+	Limits.MaxBatchBytes = 16ll << 20;
+
+	// A homogeneous run shrinks several-fold before compression
+	TArray<FHelikaQueuedEvent> Kills;
+	for (int32 Index = 0; Index < 200; ++Index)
+	{
+		Kills.Add(MakeKillEvent(Config, Context, Index));
+	}
+	FHelikaBatchSerializer Serializer;
+	TArray<uint8> Payload;
+	TArray<int32> Written;
+	Serializer.SerializeBudgeted(Kills, Limits, Limits.MaxBatchBytes, Payload, Written);
+
+	TArray<uint8> Columnar;
+	TArray<uint8> Decoded;
+	FString Error;
+	if (TestTrue("Homogeneous batch is encoded", FHelikaColumnarBatch::Encode(Payload, Columnar)))
+	{
+		TestTrue("Columns are at least three times smaller", Columnar.Num() * 3 <= Payload.Num());
+		TestTrue("Homogeneous batch is decoded", FHelikaColumnarBatch::Decode(Columnar, Limits.MaxBatchBytes, Decoded, Error));
+		TestTrue("Homogeneous batch round trips", Decoded == Payload);
+	}
+
+	// Interleaved event types, escapes, arrays and null keep their order and bytes
+	TArray<FHelikaQueuedEvent> Mixed;
+	for (int32 Index = 0; Index < 50; ++Index)
+	{
+		Mixed.Add(Index % 4 == 3 ? MakePurchaseEvent(Config, Context, Index) : MakeKillEvent(Config, Context, Index));
+	}
+	Serializer.SerializeBudgeted(Mixed, Limits, Limits.MaxBatchBytes, Payload, Written);
+	if (TestTrue("Mixed batch is encoded", FHelikaColumnarBatch::Encode(Payload, Columnar)))
+	{
+		TestTrue("Mixed batch is decoded", FHelikaColumnarBatch::Decode(Columnar, Limits.MaxBatchBytes, Decoded, Error));
+		TestTrue("Mixed batch round trips", Decoded == Payload);
+		TestFalse("Decoded size is capped", FHelikaColumnarBatch::Decode(Columnar, Payload.Num() / 2, Decoded, Error));
+
+		// The mock collector turns the format back into the row envelope
+		TArray<uint8> Body = Columnar;
+		TestTrue("Collector decodes the columnar format", FHelikaMockCollector::DecodeBatchFormat(FHelikaColumnarBatch::GetFormatName(), Body, Error) && Body == Payload);
+		TestFalse("Collector refuses unknown formats", FHelikaMockCollector::DecodeBatchFormat(TEXT("avro"), Body, Error));
+	}
+
+	// Values outside the delta encodings stay text
+	const TArray<uint8> Edge = ToUtf8(TEXT("{\"id\":\"batch\",\"events\":[{\"n\":-0,\"t\":\"2026-02-30T00:00:00.000Z\"},{\"n\":123456789012345678901,\"t\":\"0001-01-01T00:00:00.000Z\"},{\"n\":1e5,\"t\":\"9999-12-31T23:59:59.999Z\"},{}]}"));
+	TestTrue("Edge values round trip", FHelikaColumnarBatch::Encode(Edge, Columnar) && FHelikaColumnarBatch::Decode(Columnar, Limits.MaxBatchBytes, Decoded, Error) && Decoded == Edge);
+
+	// Input that is not a compact envelope is left to the row format
+	TestFalse("Empty events are not encoded", FHelikaColumnarBatch::Encode(ToUtf8(TEXT("{\"id\":\"batch\",\"events\":[]}")), Columnar));
+	TestFalse("Whitespace is not encoded", FHelikaColumnarBatch::Encode(ToUtf8(TEXT("{\"id\":\"batch\", \"events\":[{}]}")), Columnar));
+	TestFalse("Trailing bytes are not encoded", FHelikaColumnarBatch::Encode(ToUtf8(TEXT("{\"events\":[{\"a\":1}]}x")), Columnar));
+
+	// Inconsistent columns are refused
+	TestFalse("Column shorter than its group", FHelikaColumnarBatch::Decode(ToUtf8(TEXT("{\"columnar\":{\"order\":[0,2],\"groups\":[{\"rows\":2,\"shape\":[\"{\\\"a\\\":\",\"}\"],\"columns\":[{\"v\":[1]}]}]}}")), Limits.MaxBatchBytes, Decoded, Error));
+	TestFalse("Order longer than the group", FHelikaColumnarBatch::Decode(ToUtf8(TEXT("{\"columnar\":{\"order\":[0,3],\"groups\":[{\"rows\":2,\"shape\":[\"{\\\"a\\\":\",\"}\"],\"columns\":[{\"c\":1}]}]}}")), Limits.MaxBatchBytes, Decoded, Error));
+	TestFalse("Dictionary index out of range", FHelikaColumnarBatch::Decode(ToUtf8(TEXT("{\"columnar\":{\"order\":[0,2],\"groups\":[{\"rows\":2,\"shape\":[\"{\\\"a\\\":\",\"}\"],\"columns\":[{\"d\":[1,2],\"i\":[0,2]}]}]}}")), Limits.MaxBatchBytes, Decoded, Error));
+	TestTrue("Consistent columns are decoded", FHelikaColumnarBatch::Decode(ToUtf8(TEXT("{\"columnar\":{\"order\":[0,2],\"groups\":[{\"rows\":2,\"shape\":[\"{\\\"a\\\":\",\"}\"],\"columns\":[{\"n\":[5,-2]}]}]}}")), Limits.MaxBatchBytes, Decoded, Error)
+		&& Decoded == ToUtf8(TEXT("{\"events\":[{\"a\":5},{\"a\":3}]}")));
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaAtomicSnapshot.h"
+#include "HelikaConfigSnapshot.h"
+#include "Async/Async.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaConfigSnapshotTest, "Helika.HelikaConfigSnapshotTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaConfigSnapshotTest::RunTest(const FString& Parameters)
+{
+	THelikaAtomicSnapshot<FHelikaConfigSnapshot> Snapshots;
+	TestFalse("Nothing is published initially", Snapshots.Get().IsValid());
+
+	const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> First = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+	First->Version = 1;
+	First->GameId = "FirstGame";
+	Snapshots.Publish(First);
+
+	const FHelikaConfigSnapshotPtr Captured = Snapshots.Get();
+	TestEqual("Published snapshot is visible", Captured->Version, 1u);
+
+	const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> Second = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+	Second->Version = 2;
+	Second->GameId = "SecondGame";
+	Snapshots.Publish(Second);
+
+	TestEqual("Latest snapshot is returned", Snapshots.Get()->Version, 2u);
+	TestEqual("Captured snapshot is not modified", Captured->GameId, FString("FirstGame"));
+
+	// Source objects can be edited after publishing without affecting the snapshot
+	const TSharedPtr<FJsonObject> AppDetails = MakeShareable(new FJsonObject());
+	AppDetails->SetStringField("store_id", "EpicGames");
+	const TSharedPtr<FJsonObject> Copy = FHelikaConfigSnapshot::CopyJsonObject(AppDetails);
+	AppDetails->SetStringField("store_id", "Steam");
+	TestEqual("Copied json is isolated from the source", Copy->GetStringField(TEXT("store_id")), FString("EpicGames"));
+
+	// Nested objects and arrays are copied too
+	const TSharedPtr<FJsonObject> Build = MakeShareable(new FJsonObject());
+	Build->SetStringField("branch", "main");
+	AppDetails->SetObjectField("build", Build);
+	AppDetails->SetArrayField("tags", {MakeShared<FJsonValueObject>(Build)});
+	const TSharedPtr<FJsonObject> DeepCopy = FHelikaConfigSnapshot::CopyJsonObject(AppDetails);
+	Build->SetStringField("branch", "release");
+	TestEqual("Nested object is copied", DeepCopy->GetObjectField(TEXT("build"))->GetStringField(TEXT("branch")), FString("main"));
+	TestEqual("Objects in arrays are copied", DeepCopy->GetArrayField(TEXT("tags"))[0]->AsObject()->GetStringField(TEXT("branch")), FString("main"));
+
+	// Readers racing with a writer only ever observe fully published versions, in order
+	std::atomic<bool> bOutOfOrder = false;
+	std::atomic<bool> bStop = false;
+	TArray<TFuture<void>> Readers;
+	for (int32 ReaderIndex = 0; ReaderIndex < 4; ++ReaderIndex)
+	{
+		Readers.Add(Async(EAsyncExecution::Thread, [&Snapshots, &bOutOfOrder, &bStop]()
+		{
+			uint32 LastVersion = 0;
+			while (!bStop)
+			{
+				const FHelikaConfigSnapshotPtr Snapshot = Snapshots.Get();
+				if (Snapshot->Version < LastVersion || (Snapshot->Version > 2 && Snapshot->GameId != FString::FromInt(Snapshot->Version)))
+				{
+					bOutOfOrder = true;
+				}
+				LastVersion = Snapshot->Version;
+			}
+		}));
+	}
+
+	for (uint32 Version = 3; Version < 2000; ++Version)
+	{
+		const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> Next = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+		Next->Version = Version;
+		Next->GameId = FString::FromInt(Version);
+		Snapshots.Publish(Next);
+	}
+	bStop = true;
+
+	for (TFuture<void>& Reader : Readers)
+	{
+		Reader.Wait();
+	}
+
+	TestFalse("Readers observe consistent, monotonically increasing versions", bOutOfOrder.load());
+	TestEqual("Last publish wins", Snapshots.Get()->Version, 1999u);
+
+	return true;
+}
+
+
+#endif
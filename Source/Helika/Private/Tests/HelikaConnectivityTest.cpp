@@ -0,0 +1,223 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaAcknowledgement.h"
+#include "HelikaConnectivity.h"
+#include "HelikaDefines.h"
+#include "HelikaSpillStore.h"
+#include "HelikaTransport.h"
+#include "HttpManager.h"
+#include "HttpModule.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "MockCollector/HelikaMockCollector.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/// Sends a probe and ticks the HTTP manager until it completes, unset after a timeout
+	TOptional<bool> Probe(const FString& Url)
+	{
+		const TSharedRef<TOptional<bool>, ESPMode::ThreadSafe> Result = MakeShared<TOptional<bool>, ESPMode::ThreadSafe>();
+		FHelikaHttpModuleTransport Transport{FHelikaTransportConfig()};
+		FHelikaConnectivity::SendProbe(Transport, Url, [Result](bool bReachedCollector)
+		{
+			*Result = bReachedCollector;
+		});
+
+		const double Deadline = FPlatformTime::Seconds() + 10.0;
+		while (!Result->IsSet() && FPlatformTime::Seconds() < Deadline)
+		{
+			FHttpModule::Get().GetHttpManager().Tick(0.01f);
+			FPlatformProcess::Sleep(0.01f);
+		}
+		return *Result;
+	}
+
+	TArray<uint8> ToUtf8(const FString& Text)
+	{
+		const FTCHARToUTF8 Utf8(*Text);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaConnectivityStateTest, "Helika.HelikaConnectivityStateTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaConnectivityStateTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	FHelikaConnectivityConfig Config;
+	Config.OfflineAfterFailures = 2;
+	Config.ProbeIntervalSeconds = 1.f;
+	Config.MaxProbeIntervalSeconds = 4.f;
+	Config.MaxDrainRequests = 1;
+
+	FHelikaConnectivity Connectivity;
+	Connectivity.Configure(Config);
+	double Now = 100.0;
+
+	// Unanswered uploads in a row take the scheduler offline, an answer in between resets the count
+	TestTrue("Online uploads are not limited", Connectivity.TryBeginUpload() && Connectivity.TryBeginUpload() && Connectivity.TryBeginUpload());
+	Connectivity.EndUpload(false, Now);
+	Connectivity.EndUpload(true, Now);
+	Connectivity.EndUpload(false, Now);
+	TestTrue("One failure in a row keeps uploading", Connectivity.GetState() == EHelikaConnectivity::HC_Online);
+	TestTrue("Slot", Connectivity.TryBeginUpload());
+	Connectivity.EndUpload(false, Now);
+	TestTrue("Consecutive failures go offline", Connectivity.GetState() == EHelikaConnectivity::HC_Offline);
+	TestFalse("No upload while offline", Connectivity.TryBeginUpload());
+
+	// Probes back off while unanswered
+	TestFalse("Probe waits for its interval", Connectivity.TryBeginProbe(Now + 0.5));
+	TestTrue("Probe is due", Connectivity.TryBeginProbe(Now + 1.0));
+	TestFalse("One probe at a time", Connectivity.TryBeginProbe(Now + 1.5));
+	Now += 1.0;
+	Connectivity.EndProbe(false, Now);
+	TestFalse("Interval doubled", Connectivity.TryBeginProbe(Now + 1.5));
+	TestTrue("Second probe", Connectivity.TryBeginProbe(Now + 2.0));
+
+	// An answer drains with a bounded number of requests
+	Connectivity.EndProbe(true, Now + 2.0);
+	TestTrue("Answered probe drains", Connectivity.GetState() == EHelikaConnectivity::HC_Draining);
+	TestTrue("First drain request", Connectivity.TryBeginUpload());
+	TestFalse("Drain window is full", Connectivity.TryBeginUpload());
+	Connectivity.EndUpload(true, Now);
+	TestTrue("Window reopens", Connectivity.TryBeginUpload());
+	Connectivity.CancelUpload();
+	Connectivity.FinishDrain();
+	TestTrue("Back online", Connectivity.GetState() == EHelikaConnectivity::HC_Online);
+	TestTrue("Backlog uploads stay bounded online", Connectivity.TryBeginUpload(true) && !Connectivity.TryBeginUpload(true));
+	Connectivity.CancelUpload();
+
+	// Platform hints skip the failures and the probe interval
+	Connectivity.SetPlatformHint(false, Now);
+	TestTrue("Losing the network goes offline", Connectivity.GetState() == EHelikaConnectivity::HC_Offline);
+	TestFalse("No probe without a network", Connectivity.TryBeginProbe(Now + 10.0));
+	Connectivity.SetPlatformHint(true, Now + 10.0);
+	TestTrue("Probe right when the network is back", Connectivity.TryBeginProbe(Now + 10.0));
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaSpillStoreTest, "Helika.HelikaSpillStoreTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaSpillStoreTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	const FString Directory = FPaths::ProjectIntermediateDir() / TEXT("HelikaSpillStoreTest");
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	TArray<uint8> Payload;
+	Payload.Init('x', 100);
+
+	{
+		FHelikaSpillStore Store(Directory);
+		TestEqual("Nothing lost", Store.Write(EHelikaPriority::HP_Bulk, Payload, 10, 1000), 0);
+		TestEqual("Nothing lost", Store.Write(EHelikaPriority::HP_Normal, Payload, 5, 1000), 0);
+		TestEqual("Nothing lost", Store.Write(EHelikaPriority::HP_Critical, Payload, 1, 1000), 0);
+		TestEqual("Nothing lost", Store.Write(EHelikaPriority::HP_Bulk, Payload, 20, 1000), 0);
+		TestEqual("Events are counted", Store.GetNumEvents(), 36);
+
+		// Over budget the oldest Bulk batch goes first
+		TestEqual("Oldest Bulk batch is evicted", Store.Write(EHelikaPriority::HP_Normal, Payload, 7, 400), 10);
+		TestEqual("Store is within budget", Store.GetTotalBytes(), 400ll);
+		TestEqual("Oversized batches are refused", Store.Write(EHelikaPriority::HP_Critical, Payload, 3, 50), 3);
+	}
+
+	// The index is rebuilt from the directory, most urgent lane first and oldest first within a lane
+	FHelikaSpillStore Store(Directory);
+	Store.Load();
+	TestEqual("Batches survive a restart", Store.Num(), 4);
+
+	FHelikaSpilledBatch Batch;
+	TArray<uint8> Read;
+	TestTrue("Take", Store.Take(Batch, Read));
+	TestTrue("Critical first", Batch.Priority == EHelikaPriority::HP_Critical);
+	TestEqual("Payload is read back", Read, Payload);
+	Store.Restore(MoveTemp(Batch));
+	TestTrue("Take again", Store.Take(Batch, Read));
+	TestTrue("Restored batch keeps its place", Batch.Priority == EHelikaPriority::HP_Critical);
+	Store.Remove(Batch);
+
+	TestTrue("Take", Store.Take(Batch, Read));
+	TestEqual("Older Normal batch first", Batch.NumEvents, 5);
+	Store.Remove(Batch);
+	TestTrue("Take", Store.Take(Batch, Read));
+	TestEqual("Newer Normal batch", Batch.NumEvents, 7);
+	Store.Remove(Batch);
+	TestTrue("Take", Store.Take(Batch, Read));
+	TestEqual("Remaining Bulk batch", Batch.NumEvents, 20);
+	Store.Remove(Batch);
+	TestFalse("Store is empty", Store.Take(Batch, Read));
+
+	// A partial answer settles the accepted and invalid events, the ones to retry are spilled again with one more attempt
+	TestEqual("Nothing lost", Store.Write(EHelikaPriority::HP_Normal, ToUtf8(TEXT("{\"id\":\"batch\",\"events\":[{\"n\":0},{\"n\":1,\"s\":\"a,b]\"},{\"n\":2},{\"n\":3}]}")), 4, 1000), 0);
+	TestTrue("Take", Store.Take(Batch, Read));
+	const FHelikaAcknowledgement Partial = FHelikaAcknowledgement::Parse(4, 207, ToUtf8(TEXT("{\"rejected\":[{\"index\":1,\"retryable\":true},{\"index\":2},{\"index\":3,\"retryable\":true}]}")));
+	TestEqual("Events to retry are spilled again", Partial.ApplySpilled(Store, Batch, 2, 1000), 2);
+	TestTrue("Take the retries", Store.Take(Batch, Read));
+	TestEqual("Only the events to retry", Batch.NumEvents, 2);
+	TestEqual("One more attempt", Batch.NumRetries, 1);
+	const FUTF8ToTCHAR Retried(reinterpret_cast<const ANSICHAR*>(Read.GetData()), Read.Num());
+	TestTrue("Retried events are kept as they were", FString(Retried.Length(), Retried.Get()).EndsWith(TEXT("\"events\":[{\"n\":1,\"s\":\"a,b]\"},{\"n\":3}]}")));
+
+	// The attempt count survives a restart and stops the retries once used up
+	Store.Restore(MoveTemp(Batch));
+	FHelikaSpillStore Reloaded(Directory);
+	Reloaded.Load();
+	TestTrue("Take after a restart", Reloaded.Take(Batch, Read));
+	TestEqual("Attempts are read from the file name", Batch.NumRetries, 1);
+	const FHelikaAcknowledgement Again = FHelikaAcknowledgement::Parse(2, 207, ToUtf8(TEXT("{\"rejected\":[{\"index\":0,\"retryable\":true}]}")));
+	TestEqual("Out of retries", Again.ApplySpilled(Reloaded, Batch, 1, 1000), 0);
+	TestFalse("Reloaded store is empty", Reloaded.Take(Batch, Read));
+
+	TArray<FString> Remaining;
+	IFileManager::Get().FindFiles(Remaining, *(Directory / TEXT("*.json")), true, false);
+	TestEqual("Uploaded batches are deleted", Remaining.Num(), 0);
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaConnectivityProbeTest, "Helika.HelikaConnectivityProbeTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaConnectivityProbeTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// Toggling the mock collector is what the scheduler sees when the network goes away and comes back
+	FHelikaMockCollectorConfig Config;
+	Config.Port = 18183;
+	const FString Url = FString::Printf(TEXT("http://127.0.0.1:%d"), Config.Port);
+	FHelikaMockCollector Collector(Config);
+
+	const TOptional<bool> WhileStopped = Probe(Url);
+	TestTrue("Probe completes while the collector is down", WhileStopped.IsSet());
+	TestFalse("Collector is unreachable", WhileStopped.Get(true));
+
+	if (TestTrue("Collector started", Collector.Start()))
+	{
+		const TOptional<bool> WhileRunning = Probe(Url);
+		TestTrue("Probe completes", WhileRunning.IsSet());
+		TestTrue("Collector is reachable", WhileRunning.Get(false));
+		TestEqual("Probe is not counted as a batch", Collector.GetStats().Accepted, 0ll);
+		TestEqual("Probe is recorded", Collector.GetStats().Probes, 1ll);
+		Collector.Stop();
+	}
+
+	const TOptional<bool> AfterStop = Probe(Url);
+	TestFalse("Collector is unreachable again", AfterStop.Get(true));
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
@@ -0,0 +1,159 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaBatchSerializer.h"
+#include "HelikaConfigSnapshot.h"
+#include "HelikaDefines.h"
+#include "HelikaJsonWriter.h"
+#include "HelikaLibrary.h"
+#include "Misc/AutomationTest.h"
+#include "HelikaManager.h"
+#include "HelikaSettings.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaContextLifetimeTest, "Helika.HelikaContextLifetimeTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaContextLifetimeTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	UHelikaManager* HelikaManager = NewObject<UHelikaManager>();
+	UHelikaLibrary::GetHelikaSettings()->HelikaAPIKey = "TestAPIKey";
+	UHelikaLibrary::GetHelikaSettings()->GameId = "ValidGameId";
+
+	// Calling before initialization
+	TestFalse("Context cannot be created before initialization", HelikaManager->CreateContext(MakeShareable(new FJsonObject())).IsValid());
+
+	HelikaManager->InitializeSDK();
+
+	TSharedPtr<FJsonObject> PlayerOne = MakeShareable(new FJsonObject());
+	PlayerOne->SetStringField("user_id", "player_one");
+	TSharedPtr<FJsonObject> Match = MakeShareable(new FJsonObject());
+	Match->SetStringField("map", "arctic");
+
+	const FHelikaContext ContextOne = HelikaManager->CreateContext(PlayerOne, Match);
+	const FHelikaContext ContextTwo = HelikaManager->CreateContext(nullptr);
+
+	TestTrue("Context is valid", HelikaManager->IsContextValid(ContextOne));
+	TestTrue("Contexts are unique", ContextOne != ContextTwo);
+	TestFalse("Contexts have their own session", HelikaManager->GetContextSessionId(ContextOne) == HelikaManager->GetContextSessionId(ContextTwo));
+	TestFalse("Context session differs from the global session", HelikaManager->GetContextSessionId(ContextOne) == HelikaManager->GetSessionId());
+
+	{
+		TSharedPtr<FJsonObject> EventData = MakeShareable(new FJsonObject());
+		EventData->SetStringField("event_type", "player_event");
+		TSharedPtr<FJsonObject> SubEvent = MakeShareable(new FJsonObject());
+		SubEvent->SetStringField("event_sub_type", "player_killed");
+		EventData->SetObjectField("event", SubEvent);
+
+		TestTrue("Context event is accepted", HelikaManager->SendContextEvent(ContextOne, EventData));
+		TestEqual("Context user id is used", SubEvent->GetStringField(TEXT("user_id")), FString("player_one"));
+		TestEqual("Context session id is used", SubEvent->GetStringField(TEXT("session_id")), HelikaManager->GetContextSessionId(ContextOne));
+	}
+
+	// Invalid parameters
+	TestFalse("Event data cannot be null", HelikaManager->SendContextEvent(ContextOne, nullptr));
+	TestFalse("Event data cannot be empty", HelikaManager->SendContextEvents(ContextOne, TArray<TSharedPtr<FJsonObject>>()));
+	TestFalse("Invalid handle is rejected", HelikaManager->SendContextEvent(FHelikaContext(), MakeShareable(new FJsonObject())));
+
+	HelikaManager->DestroyContext(ContextOne);
+	TestFalse("Context is invalid after destroy", HelikaManager->IsContextValid(ContextOne));
+	TestFalse("Destroyed context rejects events", HelikaManager->SendContextEvent(ContextOne, MakeShareable(new FJsonObject())));
+	TestTrue("Other contexts are unaffected", HelikaManager->IsContextValid(ContextTwo));
+
+	HelikaManager->DeinitializeSDK();
+	TestFalse("Contexts are released on deinitialize", HelikaManager->IsContextValid(ContextTwo));
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaBatchSerializerTest, "Helika.HelikaBatchSerializerTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaBatchSerializerTest::RunTest(const FString& Parameters)
+{
+	const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> Config = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+	Config->AppDetails = MakeShareable(new FJsonObject());
+	Config->AppDetails->SetStringField("client_app_version", "0.1.1");
+	Config->SDKName = "Unreal";
+
+	auto MakeContext = [](const FString& UserId)
+	{
+		const TSharedRef<FHelikaContextData, ESPMode::ThreadSafe> Data = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>();
+		Data->AnonymousId = "anon_" + UserId;
+		Data->UserDetails = MakeShareable(new FJsonObject());
+		Data->UserDetails->SetStringField("user_id", UserId);
+		Data->UserDetails->SetStringField("email", TEXT("\"quoted\"\n\u00e9\u4e2d"));
+		return FHelikaContextDataPtr(Data);
+	};
+
+	auto MakeEvent = [&Config](const FHelikaContextDataPtr& Context, bool bIsUserEvent)
+	{
+		FHelikaQueuedEvent Event;
+		Event.Event = MakeShareable(new FJsonObject());
+		Event.Event->SetStringField("event_type", "test");
+		TSharedPtr<FJsonObject> SubEvent = MakeShareable(new FJsonObject());
+		SubEvent->SetStringField("event_sub_type", "test_sub");
+		Event.Event->SetObjectField("event", SubEvent);
+		Event.Context = Context;
+		Event.Config = Config;
+		Event.bIsUserEvent = bIsUserEvent;
+		return Event;
+	};
+
+	const FHelikaContextDataPtr ContextOne = MakeContext("player_one");
+	const FHelikaContextDataPtr ContextTwo = MakeContext("player_two");
+
+	TArray<FHelikaQueuedEvent> Events;
+	Events.Add(MakeEvent(ContextOne, true));
+	Events.Add(MakeEvent(ContextTwo, true));
+	Events.Add(MakeEvent(ContextOne, false));
+
+	// Events that already carry a block keep their own values
+	FHelikaQueuedEvent Overridden = MakeEvent(ContextTwo, true);
+	TSharedPtr<FJsonObject> OwnHelikaData = MakeShareable(new FJsonObject());
+	OwnHelikaData->SetStringField("sdk_name", "Custom");
+	Overridden.Event->GetObjectField(TEXT("event"))->SetObjectField("helika_data", OwnHelikaData);
+	Events.Add(Overridden);
+
+	TArray<uint8> Payload;
+	FHelikaBatchSerializer Serializer;
+	Serializer.Serialize(Events, Payload);
+
+	TSharedPtr<FJsonObject> Envelope;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(FHelikaJsonWriter::ToString(Payload));
+	if (!TestTrue("Payload is valid json", FJsonSerializer::Deserialize(Reader, Envelope) && Envelope.IsValid()))
+	{
+		return false;
+	}
+
+	TestTrue("Envelope has an id", Envelope->HasTypedField<EJson::String>(TEXT("id")));
+
+	const TArray<TSharedPtr<FJsonValue>>& EventArray = Envelope->GetArrayField(TEXT("events"));
+	if (!TestEqual("Every event is written", EventArray.Num(), 4))
+	{
+		return false;
+	}
+
+	auto GetInternal = [&EventArray](int32 Index)
+	{
+		return EventArray[Index]->AsObject()->GetObjectField(TEXT("event"));
+	};
+
+	TestEqual("User details of the first context", GetInternal(0)->GetObjectField(TEXT("user_details"))->GetStringField(TEXT("user_id")), FString("player_one"));
+	TestEqual("User details of the second context", GetInternal(1)->GetObjectField(TEXT("user_details"))->GetStringField(TEXT("user_id")), FString("player_two"));
+	TestEqual("Strings are escaped", GetInternal(0)->GetObjectField(TEXT("user_details"))->GetStringField(TEXT("email")), FString(TEXT("\"quoted\"\n\u00e9\u4e2d")));
+	TestEqual("Helika data carries the context anon id", GetInternal(1)->GetObjectField(TEXT("helika_data"))->GetStringField(TEXT("anon_id")), FString("anon_player_two"));
+	TestEqual("App details are shared", GetInternal(1)->GetObjectField(TEXT("app_details"))->GetStringField(TEXT("client_app_version")), FString("0.1.1"));
+	TestFalse("Non user events have no user details", GetInternal(2)->HasField(TEXT("user_details")));
+	TestEqual("Event values win over the context block", GetInternal(3)->GetObjectField(TEXT("helika_data"))->GetStringField(TEXT("sdk_name")), FString("Custom"));
+	TestEqual("Missing values are merged from the context block", GetInternal(3)->GetObjectField(TEXT("helika_data"))->GetStringField(TEXT("anon_id")), FString("anon_player_two"));
+
+	return true;
+}
+
+
+#endif
@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaDebugSink.h"
+#include "HelikaDefines.h"
+#include "HelikaRingBuffer.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaDebugSinkTest, "Helika.HelikaDebugSinkTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaDebugSinkTest::RunTest(const FString& Parameters)
+{
+	// Ring keeps order and refuses pushes once full
+	THelikaRingBuffer<int32> Ring(5);
+	TestEqual("Capacity is rounded to a power of two", Ring.GetCapacity(), 8u);
+	for (int32 Value = 0; Value < 8; ++Value)
+	{
+		TestTrue("Push fits", Ring.Push(int32(Value)));
+	}
+	TestFalse("Push into a full ring fails", Ring.Push(8));
+
+	int32 Popped = -1;
+	for (int32 Value = 0; Value < 8; ++Value)
+	{
+		TestTrue("Pop returns a value", Ring.Pop(Popped));
+		TestEqual("Values come out in order", Popped, Value);
+	}
+	TestFalse("Empty ring pops nothing", Ring.Pop(Popped));
+
+	// Concurrent producers never lose or duplicate a value
+	THelikaRingBuffer<int32> SharedRing(4096);
+	ParallelFor(4, [&SharedRing](int32 Producer)
+	{
+		for (int32 Index = 0; Index < 1000; ++Index)
+		{
+			SharedRing.Push(Producer * 1000 + Index);
+		}
+	});
+	TSet<int32> Seen;
+	while (SharedRing.Pop(Popped))
+	{
+		Seen.Add(Popped);
+	}
+	TestEqual("Every pushed value is popped once", Seen.Num(), 4000);
+
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	FHelikaDebugSinkConfig Config;
+	Config.Output = EHelikaDebugOutput::HDO_Log;
+	Config.MaxEntriesPerSecond = 5;
+	Config.MaxEntryBytes = 256;
+	Config.HistorySize = 10;
+
+	FHelikaDebugSink Sink;
+	Sink.Configure(Config);
+
+	const FString Event = FString::Printf(TEXT("[{\"event_type\":\"%s\"}]"), *FString::ChrN(1000, TEXT('a')));
+	const FTCHARToUTF8 Body(*Event);
+	for (int32 Index = 0; Index < 50; ++Index)
+	{
+		Sink.Push(EHelikaDebugEntryKind::Sent, TConstArrayView<uint8>(reinterpret_cast<const uint8*>(Body.Get()), Body.Length()), 1);
+	}
+	TestTrue("Sink drains the ring", Sink.WaitUntilIdle(5.0f));
+
+	// The limit window may roll over once while draining
+	const FHelikaDebugSinkStats Stats = Sink.GetStats();
+	TestEqual("Every entry is pushed", Stats.Pushed, int64(50));
+	TestEqual("Every body is truncated", Stats.Truncated, int64(50));
+	TestTrue("Writes are rate limited", Stats.Written >= 5 && Stats.Written <= 10);
+	TestEqual("The rest is suppressed", Stats.Written + Stats.Suppressed + Stats.DroppedFull, int64(50));
+
+	const TArray<FString> History = Sink.GetHistory();
+	TestEqual("History is bounded", History.Num(), 10);
+	TestEqual("History returns the last entries", Sink.GetHistory(3).Num(), 3);
+	TestTrue("Entries are formatted", History.Num() > 0 && History[0].StartsWith(TEXT("[Helika] Event Sent: Sent (1 events)")));
+	TestTrue("Truncation is shown", History.Num() > 0 && History[0].Contains(TEXT("truncated, 256 of")));
+
+	Sink.Shutdown();
+
+	// Rotation keeps MaxFiles files, HelikaEvents.log included
+	const FString LogDirectory = FPaths::ProjectLogDir() / TEXT("Helika");
+	const FString RotatedFiles[] = {LogDirectory / TEXT("HelikaEvents.log"), LogDirectory / TEXT("HelikaEvents.1.log"), LogDirectory / TEXT("HelikaEvents.2.log")};
+	for (const FString& RotatedFile : RotatedFiles)
+	{
+		IFileManager::Get().Delete(*RotatedFile, false, false, true);
+	}
+
+	FHelikaDebugSinkConfig FileConfig = Config;
+	FileConfig.Output = EHelikaDebugOutput::HDO_File;
+	FileConfig.MaxEntriesPerSecond = 1000;
+	FileConfig.MaxFileBytes = 300;
+	FileConfig.MaxFiles = 2;
+	FHelikaDebugSink FileSink;
+	FileSink.Configure(FileConfig);
+	for (int32 Index = 0; Index < 10; ++Index)
+	{
+		FileSink.Push(EHelikaDebugEntryKind::Sent, TConstArrayView<uint8>(reinterpret_cast<const uint8*>(Body.Get()), Body.Length()), 1);
+	}
+	TestTrue("File sink drains the ring", FileSink.WaitUntilIdle(5.0f));
+	FileSink.Shutdown();
+
+	TestTrue("Current file is written", IFileManager::Get().FileExists(*RotatedFiles[0]));
+	TestTrue("One rotated file is kept", IFileManager::Get().FileExists(*RotatedFiles[1]));
+	TestFalse("Older files are deleted", IFileManager::Get().FileExists(*RotatedFiles[2]));
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
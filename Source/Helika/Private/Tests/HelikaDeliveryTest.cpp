@@ -0,0 +1,112 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaAcknowledgement.h"
+#include "HelikaDefines.h"
+#include "HelikaDelivery.h"
+#include "HelikaEventQueue.h"
+#include "HelikaManager.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/// Collects the results of the deliveries it creates
+	struct FDeliveryRecorder
+	{
+		TSharedRef<TArray<EHelikaDeliveryResult>> Results = MakeShared<TArray<EHelikaDeliveryResult>>();
+
+		FHelikaDeliveryPtr Make(int32 NumPending = 1) const
+		{
+			return MakeShared<FHelikaDelivery, ESPMode::ThreadSafe>([Results = Results](EHelikaDeliveryResult Result)
+			{
+				Results->Add(Result);
+			}, NumPending);
+		}
+	};
+
+	/// Settled deliveries report on the game thread
+	void RunGameThreadTasks()
+	{
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+	}
+
+	TArray<FHelikaQueuedEvent> MakeBatch(const FDeliveryRecorder& Recorder, int32 NumEvents)
+	{
+		TArray<FHelikaQueuedEvent> Batch;
+		for (int32 Index = 0; Index < NumEvents; ++Index)
+		{
+			FHelikaQueuedEvent& Event = Batch.AddDefaulted_GetRef();
+			Event.Event = MakeShareable(new FJsonObject());
+			Event.Delivery = Recorder.Make();
+		}
+		return Batch;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaDeliveryTest, "Helika.HelikaDeliveryTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaDeliveryTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// A delivery reports once its last item settles, with the first failure
+	{
+		FDeliveryRecorder Recorder;
+		const FHelikaDeliveryPtr Delivery = Recorder.Make(3);
+		Delivery->Settle(EHelikaDeliveryResult::HD_Delivered);
+		Delivery->Settle(EHelikaDeliveryResult::HD_Shed);
+		RunGameThreadTasks();
+		TestEqual("Nothing is reported while items are pending", Recorder.Results->Num(), 0);
+		Delivery->Settle(EHelikaDeliveryResult::HD_Invalid);
+		TestEqual("The report is never inline", Recorder.Results->Num(), 0);
+		RunGameThreadTasks();
+		TestEqual("The last item reports the first failure", *Recorder.Results, TArray<EHelikaDeliveryResult>({EHelikaDeliveryResult::HD_Shed}));
+	}
+
+	// A delivery released with pending items reports them as dropped
+	{
+		FDeliveryRecorder Recorder;
+		Recorder.Make();
+		RunGameThreadTasks();
+		TestEqual("Lost items are dropped", *Recorder.Results, TArray<EHelikaDeliveryResult>({EHelikaDeliveryResult::HD_Dropped}));
+	}
+
+	// The acknowledgement settles every event that leaves the pipeline, requeued ones stay pending
+	{
+		FDeliveryRecorder Recorder;
+		FHelikaAcknowledgement Acknowledgement;
+		Acknowledgement.Results = {EHelikaEventResult::Accepted, EHelikaEventResult::Invalid, EHelikaEventResult::Retry, EHelikaEventResult::Retry};
+		Acknowledgement.NumAccepted = 1;
+		Acknowledgement.NumInvalid = 1;
+		Acknowledgement.NumRetry = 2;
+
+		FHelikaEventQueue Queue;
+		TArray<FHelikaQueuedEvent> Batch = MakeBatch(Recorder, 4);
+		Batch[3].NumRetries = 5;
+		TestEqual("One event is queued again", Acknowledgement.Apply(MoveTemp(Batch), &Queue, 5), 1);
+		RunGameThreadTasks();
+		TestEqual("Settled events report", *Recorder.Results, TArray<EHelikaDeliveryResult>({EHelikaDeliveryResult::HD_Delivered, EHelikaDeliveryResult::HD_Invalid, EHelikaDeliveryResult::HD_OutOfRetries}));
+
+		// Shedding settles the dropped events
+		Queue.Shed(0);
+		RunGameThreadTasks();
+		TestTrue("Shed events report", Recorder.Results->Num() == 4 && Recorder.Results->Last() == EHelikaDeliveryResult::HD_Shed);
+	}
+
+	// Events refused before they are queued report at once
+	{
+		FDeliveryRecorder Recorder;
+		UHelikaManager* HelikaManager = NewObject<UHelikaManager>();
+		TestFalse("Nothing is queued before initialization", HelikaManager->SendTrackedEvent(MakeShareable(new FJsonObject()), EHelikaPriority::HP_Normal, false, Recorder.Make()));
+		RunGameThreadTasks();
+		TestEqual("Refused events are invalid", *Recorder.Results, TArray<EHelikaDeliveryResult>({EHelikaDeliveryResult::HD_Invalid}));
+	}
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
@@ -0,0 +1,161 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaBatchSerializer.h"
+#include "HelikaClock.h"
+#include "HelikaConfigSnapshot.h"
+#include "HelikaDefines.h"
+#include "HelikaEventRules.h"
+#include "HelikaEventTemplate.h"
+#include "HelikaJsonWriter.h"
+#include "HelikaLibrary.h"
+#include "HelikaManager.h"
+#include "HelikaMetricsCounters.h"
+#include "HelikaSettings.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaEventPrototypeTest, "Helika.HelikaEventPrototypeTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaEventPrototypeTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// Names the SDK writes itself cannot be fields
+	FString Error;
+	TestFalse("Empty sub type is rejected", FHelikaEventTemplate::Create(TEXT("level"), TEXT(""), {TEXT("score")}, Error).IsValid());
+	TestFalse("Reserved field is rejected", FHelikaEventTemplate::Create(TEXT("level"), TEXT("complete"), {TEXT("user_id")}, Error).IsValid());
+	TestFalse("Repeated field is rejected", FHelikaEventTemplate::Create(TEXT("level"), TEXT("complete"), {TEXT("score"), TEXT("score")}, Error).IsValid());
+	TestFalse("Empty field is rejected", FHelikaEventTemplate::Create(TEXT("level"), TEXT("complete"), {TEXT("")}, Error).IsValid());
+
+	const TArray<FString> FieldNames = {TEXT("level"), TEXT("score"), TEXT("note"), TEXT("tags")};
+	const FHelikaEventTemplatePtr Template = FHelikaEventTemplate::Create(TEXT("level"), TEXT("complete"), FieldNames, Error);
+	if (!TestTrue("Template is created", Template.IsValid()))
+	{
+		LogHelika.SetVerbosity(OriginalVerbosity);
+		return false;
+	}
+
+	const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> Config = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+	Config->GameId = TEXT("game");
+	Config->AppDetails = MakeShareable(new FJsonObject());
+	Config->AppDetails->SetStringField("platform_id", "Linux");
+
+	const TSharedRef<FHelikaContextData, ESPMode::ThreadSafe> Context = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>();
+	Context->SessionId = TEXT("session");
+	Context->AnonymousId = TEXT("anonymous");
+	Context->UserDetails = MakeShareable(new FJsonObject());
+	Context->UserDetails->SetStringField("user_id", "player");
+	Context->MatchMetadata = MakeShareable(new FJsonObject());
+	Context->MatchMetadata->SetStringField("match_id", "m1");
+
+	const FDateTime CreatedAt(2024, 5, 6, 7, 8, 9, 10);
+	TArray<TSharedPtr<FJsonValue>> Values;
+	Values.Add(MakeShared<FJsonValueNumber>(3));
+	Values.Add(MakeShared<FJsonValueNumber>(1250.5));
+	Values.Add(MakeShared<FJsonValueString>(TEXT("said \"gg\"\n")));
+	Values.Add(MakeShared<FJsonValueArray>(TArray<TSharedPtr<FJsonValue>>({MakeShared<FJsonValueString>(TEXT("speedrun")), MakeShared<FJsonValueBoolean>(true)})));
+
+	auto MakePrototypeEvent = [&](bool bIsUserEvent)
+	{
+		FHelikaQueuedEvent Event;
+		Event.Template = Template;
+		Event.Values = Values;
+		Event.CreatedAt = CreatedAt;
+		Event.Context = Context;
+		Event.Config = Config;
+		Event.bIsUserEvent = bIsUserEvent;
+		return Event;
+	};
+
+	// The same event as SendEvent queues it once enriched
+	auto MakeTreeEvent = [&](bool bIsUserEvent)
+	{
+		TSharedPtr<FJsonObject> InternalEvent = MakeShareable(new FJsonObject());
+		InternalEvent->SetStringField("event_sub_type", "complete");
+		for (int32 Index = 0; Index < FieldNames.Num(); ++Index)
+		{
+			InternalEvent->SetField(FieldNames[Index], Values[Index]);
+		}
+		InternalEvent->SetStringField("session_id", Context->SessionId);
+		InternalEvent->SetStringField("user_id", bIsUserEvent ? Context->GetUserId() : Context->AnonymousId);
+
+		FHelikaQueuedEvent Event;
+		Event.Event = MakeShareable(new FJsonObject());
+		Event.Event->SetStringField("event_type", "level");
+		Event.Event->SetObjectField("event", InternalEvent);
+		Event.Event->SetStringField("game_id", Config->GameId);
+		Event.Event->SetStringField("created_at", CreatedAt.ToIso8601());
+		Event.Context = Context;
+		Event.Config = Config;
+		Event.bIsUserEvent = bIsUserEvent;
+		return Event;
+	};
+
+	auto SerializeOne = [](const FHelikaQueuedEvent& Event)
+	{
+		FHelikaSequentialIdGenerator IdGenerator(49);
+		FHelikaClock::SetIdGenerator(&IdGenerator);
+		TArray<uint8> Payload;
+		FHelikaBatchSerializer().Serialize(MakeArrayView(&Event, 1), Payload);
+		FHelikaClock::SetIdGenerator(nullptr);
+		return Payload;
+	};
+
+	// Splicing the values into the template writes what the tree path writes
+	for (const bool bIsUserEvent : {false, true})
+	{
+		const TArray<uint8> FromTemplate = SerializeOne(MakePrototypeEvent(bIsUserEvent));
+		const TArray<uint8> FromTree = SerializeOne(MakeTreeEvent(bIsUserEvent));
+		TestEqual(bIsUserEvent ? TEXT("User event matches the tree payload") : TEXT("Game event matches the tree payload"), FHelikaJsonWriter::ToString(FromTemplate), FHelikaJsonWriter::ToString(FromTree));
+	}
+
+	// Rules still apply, the event falls back to a tree
+	FHelikaEventRule Rule;
+	Rule.EventType = TEXT("level");
+	Rule.Action = EHelikaEventRuleAction::HER_RemoveField;
+	Rule.FieldPath = TEXT("event.note");
+	Config->EventRules = FHelikaEventRules::Compile({Rule}, TEXT("salt"));
+
+	TSharedPtr<FJsonObject> Envelope;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(FHelikaJsonWriter::ToString(SerializeOne(MakePrototypeEvent(true))));
+	if (TestTrue("Payload is valid json", FJsonSerializer::Deserialize(Reader, Envelope) && Envelope.IsValid()))
+	{
+		const TSharedPtr<FJsonObject> Written = Envelope->GetArrayField(TEXT("events"))[0]->AsObject()->GetObjectField(TEXT("event"));
+		TestFalse("Rule removes the field", Written->HasField(TEXT("note")));
+		TestEqual("Other fields are kept", Written->GetNumberField(TEXT("score")), 1250.5);
+		TestEqual("Enrichment is kept", Written->GetStringField(TEXT("user_id")), FString(TEXT("player")));
+	}
+	Config->EventRules = nullptr;
+
+	// Registration through the manager reuses handles and checks the values of each send
+	UHelikaManager* HelikaManager = NewObject<UHelikaManager>();
+	UHelikaLibrary::GetHelikaSettings()->HelikaAPIKey = "TestAPIKey";
+	UHelikaLibrary::GetHelikaSettings()->GameId = "ValidGameId";
+
+	const FHelikaEventPrototype Prototype = HelikaManager->RegisterEventPrototype(TEXT("level"), TEXT("complete"), FieldNames);
+	TestTrue("Prototype is registered", Prototype.IsValid());
+	TestTrue("Same prototype gets the same handle", HelikaManager->RegisterEventPrototype(TEXT("level"), TEXT("complete"), FieldNames) == Prototype);
+	TestTrue("Other fields get another handle", HelikaManager->RegisterEventPrototype(TEXT("level"), TEXT("complete"), {TEXT("level")}) != Prototype);
+	TestFalse("Invalid prototype gets no handle", HelikaManager->RegisterEventPrototype(TEXT("level"), TEXT("complete"), {TEXT("session_id")}).IsValid());
+
+	TestFalse("Not initialized", HelikaManager->SendPrototypeEvent(Prototype, Values));
+	HelikaManager->InitializeSDK();
+
+	const FHelikaMetrics Before = FHelikaMetricsCounters::Read();
+	TestFalse("Unknown handle is rejected", HelikaManager->SendPrototypeEvent(FHelikaEventPrototype(), Values));
+	TestFalse("Missing values are rejected", HelikaManager->SendPrototypeEvent(Prototype, TArray<TSharedPtr<FJsonValue>>({Values[0]})));
+	TestEqual("Rejections are counted", FHelikaMetricsCounters::Read().EventsRejected - Before.EventsRejected, 2ll);
+	TestTrue("Event is queued", HelikaManager->SendPrototypeEvent(Prototype, Values));
+	TestTrue("User event is queued", HelikaManager->SendUserPrototypeEvent(Prototype, Values));
+	TestEqual("Accepted events are counted", FHelikaMetricsCounters::Read().EventsAccepted - Before.EventsAccepted, 2ll);
+
+	HelikaManager->DeinitializeSDK();
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
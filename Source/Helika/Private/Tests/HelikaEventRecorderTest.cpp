@@ -0,0 +1,128 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaClock.h"
+#include "HelikaDefines.h"
+#include "HelikaEventRecorder.h"
+#include "HelikaJsonWriter.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	TSharedPtr<FJsonObject> MakeEvent(const FString& EventType)
+	{
+		const TSharedPtr<FJsonObject> Event = MakeShareable(new FJsonObject());
+		Event->SetStringField("event_type", EventType);
+		return Event;
+	}
+
+	FHelikaContextDataPtr MakeContext(int32 Id, const FString& UserId)
+	{
+		const TSharedPtr<FHelikaContextData, ESPMode::ThreadSafe> Data = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>();
+		Data->Id = Id;
+		Data->UserDetails = MakeShareable(new FJsonObject());
+		Data->UserDetails->SetStringField("user_id", UserId);
+		return Data;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaEventRecorderTest, "Helika.HelikaEventRecorderTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaEventRecorderTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	const FString TraceFile = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("HelikaRecording"), TEXT(".bin"));
+	FHelikaEventRecorder& Recorder = FHelikaEventRecorder::Get();
+
+	// Events are recorded with their context, a new context version is recorded once before its first event
+	const FHelikaContextDataPtr DefaultContext = MakeContext(INDEX_NONE, TEXT("local"));
+	const FHelikaContextDataPtr Player = MakeContext(4, TEXT("player_a"));
+	const FHelikaContextDataPtr PlayerRenamed = MakeContext(4, TEXT("player_b"));
+
+	Recorder.Record(EHelikaRecordedSend::Game, EHelikaPriority::HP_Normal, MakeEvent("ignored"), DefaultContext, 1);
+	TestTrue("Recording starts", Recorder.Start(TraceFile));
+	Recorder.Record(EHelikaRecordedSend::Game, EHelikaPriority::HP_Normal, MakeEvent("first"), DefaultContext, 1);
+	Recorder.Record(EHelikaRecordedSend::Context, EHelikaPriority::HP_Bulk, MakeEvent("second"), Player, 1);
+	Recorder.Record(EHelikaRecordedSend::Context, EHelikaPriority::HP_Bulk, MakeEvent("third"), Player, 2);
+	Recorder.Record(EHelikaRecordedSend::Context, EHelikaPriority::HP_Critical, MakeEvent("fourth"), PlayerRenamed, 2);
+	TestEqual("Only events recorded while running count", Recorder.GetNumRecorded(), 4ll);
+	Recorder.Stop();
+	TestFalse("Recording stops", Recorder.IsRecording());
+
+	FHelikaEventRecordReader Reader;
+	if (TestTrue("Recording opens", Reader.Open(TraceFile)))
+	{
+		TArray<FString> Sequence;
+		FHelikaRecordedContext Context;
+		FHelikaRecordedEvent Event;
+		int64 LastTimestampUs = 0;
+		for (FHelikaEventRecordReader::ERecord Record = Reader.Next(Context, Event); Record != FHelikaEventRecordReader::ERecord::End; Record = Reader.Next(Context, Event))
+		{
+			if (Record == FHelikaEventRecordReader::ERecord::Context)
+			{
+				Sequence.Add(FString::Printf(TEXT("context %d v%u %s"), Context.ContextId, Context.Version, *FHelikaJsonWriter::ToString(Context.UserDetails)));
+				continue;
+			}
+			TestTrue("Timestamps never go backwards", Event.TimestampUs >= LastTimestampUs);
+			LastTimestampUs = Event.TimestampUs;
+			TestEqual("Thread is recorded", Event.ThreadId, FPlatformTLS::GetCurrentThreadId());
+			Sequence.Add(FString::Printf(TEXT("event %d v%u config %u priority %d %s"), Event.ContextId, Event.ContextVersion, Event.ConfigVersion, static_cast<int32>(Event.Priority), *FHelikaJsonWriter::ToString(Event.Payload)));
+		}
+		TestFalse("The whole file is read", Reader.HasError());
+		TestEqual("Records", Sequence, TArray<FString>({
+			TEXT("context -1 v1 {\"user_id\":\"local\"}"),
+			TEXT("event -1 v1 config 1 priority 1 {\"event_type\":\"first\"}"),
+			TEXT("context 4 v1 {\"user_id\":\"player_a\"}"),
+			TEXT("event 4 v1 config 1 priority 2 {\"event_type\":\"second\"}"),
+			TEXT("event 4 v1 config 2 priority 2 {\"event_type\":\"third\"}"),
+			TEXT("context 4 v2 {\"user_id\":\"player_b\"}"),
+			TEXT("event 4 v2 config 2 priority 0 {\"event_type\":\"fourth\"}")}));
+	}
+
+	// A cut file reads up to the last whole record and reports the error
+	TArray<uint8> Bytes;
+	FFileHelper::LoadFileToArray(Bytes, *TraceFile);
+	Bytes.SetNum(Bytes.Num() - 3);
+	FFileHelper::SaveArrayToFile(Bytes, *TraceFile);
+	FHelikaEventRecordReader CutReader;
+	if (TestTrue("Cut recording opens", CutReader.Open(TraceFile)))
+	{
+		FHelikaRecordedContext Context;
+		FHelikaRecordedEvent Event;
+		int32 NumRecords = 0;
+		while (CutReader.Next(Context, Event) != FHelikaEventRecordReader::ERecord::End)
+		{
+			++NumRecords;
+		}
+		TestEqual("Whole records are read", NumRecords, 6);
+		TestTrue("The cut is reported", CutReader.HasError());
+	}
+	IFileManager::Get().Delete(*TraceFile);
+
+	// The deterministic clock and ids replace the defaults while installed
+	FHelikaManualClock Clock(FDateTime(2024, 5, 1));
+	FHelikaSequentialIdGenerator IdGenerator(7);
+	FHelikaClock::SetClock(&Clock);
+	FHelikaClock::SetIdGenerator(&IdGenerator);
+	TestEqual("Clock is installed", FHelikaClock::UtcNow(), FDateTime(2024, 5, 1));
+	Clock.Set(FDateTime(2024, 5, 2));
+	TestEqual("Clock moves when told", FHelikaClock::UtcNow(), FDateTime(2024, 5, 2));
+	const FGuid FirstId = FHelikaClock::NewGuid();
+	const FGuid SecondId = FHelikaClock::NewGuid();
+	TestTrue("Ids are sequential", FirstId.A == 7 && FirstId.D == 0 && SecondId.D == 1);
+	TestTrue("Ids sort in creation order", FirstId.ToString() < SecondId.ToString());
+	FHelikaClock::SetClock(nullptr);
+	FHelikaClock::SetIdGenerator(nullptr);
+	TestNotEqual("Default clock is restored", FHelikaClock::UtcNow(), FDateTime(2024, 5, 2));
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
@@ -0,0 +1,187 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaBatchSerializer.h"
+#include "HelikaConfigSnapshot.h"
+#include "HelikaDefines.h"
+#include "HelikaEventRules.h"
+#include "HelikaHashing.h"
+#include "HelikaJsonWriter.h"
+#include "HelikaMetricsCounters.h"
+#include "HelikaSettings.h"
+#include "Misc/AutomationTest.h"
+#include "Serialization/JsonSerializer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaEventRulesTest, "Helika.HelikaEventRulesTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaEventRulesTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	auto MakeRule = [](const FString& EventType, const FString& EventSubType, EHelikaEventRuleAction Action, const FString& FieldPath)
+	{
+		FHelikaEventRule Rule;
+		Rule.EventType = EventType;
+		Rule.EventSubType = EventSubType;
+		Rule.Action = Action;
+		Rule.FieldPath = FieldPath;
+		return Rule;
+	};
+
+	TArray<FHelikaEventRule> Rules;
+	Rules.Add(MakeRule(TEXT("debug"), FString(), EHelikaEventRuleAction::HER_Drop, FString()));
+	Rules.Add(MakeRule(TEXT("login"), FString(), EHelikaEventRuleAction::HER_HashField, TEXT("event.email")));
+	Rules.Add(MakeRule(TEXT("login"), TEXT("failed"), EHelikaEventRuleAction::HER_RemoveField, TEXT("event.password")));
+	Rules.Add(MakeRule(FString(), FString(), EHelikaEventRuleAction::HER_RenameField, TEXT("event.lvl")));
+	Rules.Last().NewName = TEXT("level");
+	Rules.Add(MakeRule(FString(), TEXT("chat"), EHelikaEventRuleAction::HER_TruncateField, TEXT("event.messages.text")));
+	Rules.Last().MaxLength = 4;
+	Rules.Add(MakeRule(FString(), FString(), EHelikaEventRuleAction::HER_RemoveField, TEXT("event.user_details.email")));
+	Rules.Add(MakeRule(TEXT("ignored"), FString(), EHelikaEventRuleAction::HER_RenameField, TEXT("event.lvl")));
+	Rules.Add(MakeRule(TEXT("debug_shipping"), FString(), EHelikaEventRuleAction::HER_Drop, FString()));
+	Rules.Last().bShippingOnly = true;
+
+	const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> Config = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+	Config->AppDetails = MakeShareable(new FJsonObject());
+	Config->EventRules = FHelikaEventRules::Compile(Rules, TEXT("project salt"));
+	if (!TestTrue("Rules are compiled", Config->EventRules.IsValid()))
+	{
+		LogHelika.SetVerbosity(OriginalVerbosity);
+		return false;
+	}
+
+	const TSharedRef<FHelikaContextData, ESPMode::ThreadSafe> Context = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>();
+	Context->UserDetails = MakeShareable(new FJsonObject());
+	Context->UserDetails->SetStringField("user_id", "player");
+	Context->UserDetails->SetStringField("email", "player@example.com");
+
+	auto MakeEvent = [&Config, &Context](const FString& EventType, const FString& EventSubType)
+	{
+		FHelikaQueuedEvent Event;
+		Event.Event = MakeShareable(new FJsonObject());
+		Event.Event->SetStringField("event_type", EventType);
+		TSharedPtr<FJsonObject> SubEvent = MakeShareable(new FJsonObject());
+		SubEvent->SetStringField("event_sub_type", EventSubType);
+		SubEvent->SetStringField("email", "player@example.com");
+		SubEvent->SetStringField("password", "hunter2");
+		SubEvent->SetNumberField("lvl", 7);
+		Event.Event->SetObjectField("event", SubEvent);
+		Event.Context = Context;
+		Event.Config = Config;
+		Event.bIsUserEvent = true;
+		return Event;
+	};
+
+	// Matching costs one lookup, events of other types get nothing
+	TestTrue("Unnamed type only gets the rules for every type", Config->EventRules->Match(*MakeEvent(TEXT("other"), TEXT("x")).Event) != nullptr);
+	TestTrue("Drop rule is merged", Config->EventRules->Match(*MakeEvent(TEXT("debug"), TEXT("x")).Event)->bDrop);
+#if !UE_BUILD_SHIPPING
+	TestFalse("Shipping only rule is left out", Config->EventRules->Match(*MakeEvent(TEXT("debug_shipping"), TEXT("x")).Event)->bDrop);
+#endif
+	// Projects with different salts get unrelated digests of the same value
+	const TSharedPtr<FJsonValue> Email = MakeShared<FJsonValueString>(TEXT("player@example.com"));
+	TestNotEqual("Different salts give different hashes", FHelikaEventRules::HashValue(Email, TEXT("first project")), FHelikaEventRules::HashValue(Email, TEXT("second project")));
+	TestEqual("Same salt gives the same hash", FHelikaEventRules::HashValue(Email, TEXT("first project")), FHelikaEventRules::HashValue(Email, TEXT("first project")));
+
+	TestFalse("No rules compile to nothing", FHelikaEventRules::Compile(TArray<FHelikaEventRule>(), FString()).IsValid());
+
+	TArray<FHelikaQueuedEvent> Events;
+	Events.Add(MakeEvent(TEXT("login"), TEXT("failed")));
+	Events.Add(MakeEvent(TEXT("debug"), TEXT("trace")));
+	Events.Add(MakeEvent(TEXT("login"), TEXT("success")));
+	FHelikaQueuedEvent Chat = MakeEvent(TEXT("social"), TEXT("chat"));
+	TArray<TSharedPtr<FJsonValue>> Messages;
+	for (const TCHAR* Text : {TEXT("hello there"), TEXT("gg"), TEXT("ggg\U0001F600")})
+	{
+		TSharedPtr<FJsonObject> Message = MakeShareable(new FJsonObject());
+		Message->SetStringField("text", Text);
+		Messages.Add(MakeShared<FJsonValueObject>(Message));
+	}
+	Chat.Event->GetObjectField(TEXT("event"))->SetArrayField("messages", Messages);
+	Events.Add(Chat);
+
+	const FHelikaMetrics Before = FHelikaMetricsCounters::Read();
+	TArray<uint8> Payload;
+	TArray<int32> Written;
+	TArray<int32> Filtered;
+	FHelikaBatchSerializer Serializer;
+	TestEqual("Every event is consumed", Serializer.SerializeBudgeted(Events, FHelikaBatchLimits(), 1 << 20, Payload, Written, &Filtered), 4);
+	TestEqual("Dropped event is reported", Filtered, TArray<int32>({1}));
+	TestEqual("Dropped event is counted", FHelikaMetricsCounters::Read().EventsFiltered - Before.EventsFiltered, 1ll);
+
+	TSharedPtr<FJsonObject> Envelope;
+	const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(FHelikaJsonWriter::ToString(Payload));
+	if (!TestTrue("Payload is valid json", FJsonSerializer::Deserialize(Reader, Envelope) && Envelope.IsValid()))
+	{
+		LogHelika.SetVerbosity(OriginalVerbosity);
+		return false;
+	}
+	const TArray<TSharedPtr<FJsonValue>>& EventArray = Envelope->GetArrayField(TEXT("events"));
+	if (TestEqual("Dropped event is left out", EventArray.Num(), 3))
+	{
+		const TSharedPtr<FJsonObject> Failed = EventArray[0]->AsObject()->GetObjectField(TEXT("event"));
+		const TSharedPtr<FJsonObject> Success = EventArray[1]->AsObject()->GetObjectField(TEXT("event"));
+		const TSharedPtr<FJsonObject> Social = EventArray[2]->AsObject()->GetObjectField(TEXT("event"));
+
+		TestEqual("Field is hashed", Failed->GetStringField(TEXT("email")), FHelikaEventRules::HashValue(MakeShared<FJsonValueString>(TEXT("player@example.com")), TEXT("project salt")));
+		TestEqual("Hash is hex SHA-256", Failed->GetStringField(TEXT("email")).Len(), 64);
+		TestEqual("Hash is keyed by the salt", Failed->GetStringField(TEXT("email")), FHelikaHasher(TEXT("project salt")).Hash(TEXT("player@example.com")));
+		TestNotEqual("Hash is not plain SHA-256", Failed->GetStringField(TEXT("email")), FHelikaHasher().Hash(TEXT("player@example.com")));
+		TestFalse("Sub type rule removes the field", Failed->HasField(TEXT("password")));
+		TestTrue("Sub type rule is scoped", Success->HasField(TEXT("password")));
+		TestTrue("Field is renamed", Success->HasField(TEXT("level")) && !Success->HasField(TEXT("lvl")));
+		TestFalse("Rules of other types do not apply", Social->HasField(TEXT("email")) && Social->GetStringField(TEXT("email")).Len() == 64);
+
+		const TArray<TSharedPtr<FJsonValue>>& WrittenMessages = Social->GetArrayField(TEXT("messages"));
+		TestEqual("Array elements are truncated", WrittenMessages[0]->AsObject()->GetStringField(TEXT("text")), FString(TEXT("hell")));
+		TestEqual("Short strings are kept", WrittenMessages[1]->AsObject()->GetStringField(TEXT("text")), FString(TEXT("gg")));
+		TestEqual("Surrogate pairs are not split", WrittenMessages[2]->AsObject()->GetStringField(TEXT("text")), FString(sizeof(TCHAR) == 2 ? TEXT("ggg") : TEXT("ggg\U0001F600")));
+
+		// Blocks added by the SDK go through the rules too
+		TestFalse("Rule applies to the spliced user details", Failed->GetObjectField(TEXT("user_details"))->HasField(TEXT("email")));
+		TestEqual("Rest of the block is kept", Failed->GetObjectField(TEXT("user_details"))->GetStringField(TEXT("user_id")), FString(TEXT("player")));
+		TestTrue("Sub type is kept", Failed->GetStringField(TEXT("event_sub_type")) == TEXT("failed"));
+	}
+
+	// A rename never writes a key twice
+	TArray<FHelikaEventRule> RenameRules;
+	RenameRules.Add(MakeRule(FString(), FString(), EHelikaEventRuleAction::HER_RenameField, TEXT("event.lvl")));
+	RenameRules.Last().NewName = TEXT("level");
+	RenameRules.Add(MakeRule(FString(), FString(), EHelikaEventRuleAction::HER_RenameField, TEXT("event.email")));
+	RenameRules.Last().NewName = TEXT("app_details");
+	RenameRules.Add(MakeRule(FString(), FString(), EHelikaEventRuleAction::HER_RenameField, TEXT("event.password")));
+	RenameRules.Last().NewName = TEXT("level");
+	RenameRules.Add(MakeRule(TEXT("debug"), FString(), EHelikaEventRuleAction::HER_Drop, FString()));
+	Config->EventRules = FHelikaEventRules::Compile(RenameRules, TEXT("project salt"));
+
+	TArray<FHelikaQueuedEvent> RenameEvents;
+	RenameEvents.Add(MakeEvent(TEXT("login"), TEXT("success")));
+	RenameEvents[0].Event->GetObjectField(TEXT("event"))->SetNumberField("level", 3);
+	RenameEvents.Add(MakeEvent(TEXT("debug"), TEXT("trace")));
+	RenameEvents[1].Delivery = MakeShared<FHelikaDelivery, ESPMode::ThreadSafe>([](EHelikaDeliveryResult) {});
+	TArray<uint8> RenamePayload;
+	Serializer.Serialize(RenameEvents, RenamePayload);
+	TestTrue("Dropped event is settled", RenameEvents[1].Delivery->IsSettled());
+
+	const FString RenameJson = FHelikaJsonWriter::ToString(RenamePayload);
+	TSharedPtr<FJsonObject> RenameEnvelope;
+	const TSharedRef<TJsonReader<>> RenameReader = TJsonReaderFactory<>::Create(RenameJson);
+	if (TestTrue("Renamed payload is valid json", FJsonSerializer::Deserialize(RenameReader, RenameEnvelope) && RenameEnvelope.IsValid())
+		&& TestEqual("Dropped event is left out of the payload", RenameEnvelope->GetArrayField(TEXT("events")).Num(), 1))
+	{
+		const TSharedPtr<FJsonObject> Renamed = RenameEnvelope->GetArrayField(TEXT("events"))[0]->AsObject()->GetObjectField(TEXT("event"));
+		TestEqual("Rename onto an existing field keeps the old key", Renamed->GetNumberField(TEXT("lvl")), 7.0);
+		TestEqual("Existing field is kept", Renamed->GetNumberField(TEXT("level")), 3.0);
+		TestTrue("Rename onto a context block keeps the old key", Renamed->HasField(TEXT("email")));
+		TestTrue("Second rename onto the same name is ignored", Renamed->HasField(TEXT("password")));
+		TestEqual("Each key is written once", RenameJson.Find(TEXT("\"level\"")), RenameJson.Find(TEXT("\"level\""), ESearchCase::CaseSensitive, ESearchDir::FromEnd));
+		TestEqual("Block key is written once", RenameJson.Find(TEXT("\"app_details\"")), RenameJson.Find(TEXT("\"app_details\""), ESearchCase::CaseSensitive, ESearchDir::FromEnd));
+	}
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
@@ -0,0 +1,132 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaDefines.h"
+#include "HelikaGameMetrics.h"
+#include "Async/ParallelFor.h"
+#include "Dom/JsonObject.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	TSharedPtr<FJsonObject> FindSummary(const TArray<FHelikaSeriesSummary>& Summaries, const FString& Name, const TMap<FString, FString>& Tags = {})
+	{
+		for (const FHelikaSeriesSummary& Summary : Summaries)
+		{
+			const TSharedPtr<FJsonObject> SummaryTags = Summary.Object->GetObjectField(TEXT("tags"));
+			bool bTagsMatch = SummaryTags->Values.Num() == Tags.Num();
+			for (const TPair<FString, FString>& Tag : Tags)
+			{
+				FString Value;
+				bTagsMatch &= SummaryTags->TryGetStringField(Tag.Key, Value) && Value == Tag.Value;
+			}
+			if (bTagsMatch && Summary.Object->GetStringField(TEXT("name")) == Name)
+			{
+				return Summary.Object;
+			}
+		}
+		return nullptr;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaGameMetricsTest, "Helika.HelikaGameMetricsTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaGameMetricsTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	FHelikaGameMetricsConfig Config;
+	Config.RelativeAccuracy = 0.01;
+	Config.HistogramBins = 2048;
+	Config.MaxSeries = 8;
+	FHelikaGameMetrics GameMetrics;
+	GameMetrics.Configure(Config);
+
+	// Counters recorded from many threads lose nothing
+	ParallelFor(8, [&GameMetrics](int32 Index)
+	{
+		for (int32 Value = 0; Value < 10000; ++Value)
+		{
+			GameMetrics.Record(EHelikaSeriesType::Counter, TEXT("kills"), 1.0, {});
+		}
+	});
+
+	GameMetrics.Record(EHelikaSeriesType::Gauge, TEXT("fps"), 60.0, {{TEXT("map"), TEXT("arena")}, {TEXT("mode"), TEXT("duel")}});
+	GameMetrics.Record(EHelikaSeriesType::Gauge, TEXT("fps"), 30.0, {{TEXT("mode"), TEXT("duel")}, {TEXT("map"), TEXT("arena")}});
+	GameMetrics.Record(EHelikaSeriesType::Gauge, TEXT("fps"), 45.0, {{TEXT("map"), TEXT("arena")}, {TEXT("mode"), TEXT("duel")}});
+	GameMetrics.Record(EHelikaSeriesType::Gauge, TEXT("fps"), 120.0, {{TEXT("map"), TEXT("lobby")}});
+
+	for (int32 Value = 1; Value <= 10000; ++Value)
+	{
+		GameMetrics.Record(EHelikaSeriesType::Histogram, TEXT("frame_ms"), Value, {});
+	}
+	GameMetrics.Record(EHelikaSeriesType::Histogram, TEXT("ping_ms"), 0.0, {});
+	TestEqual("Series are keyed by name and tags in any order", GameMetrics.GetNumSeries(), 5);
+
+	const TArray<FHelikaSeriesSummary> Summaries = GameMetrics.Collect();
+	TestEqual("Every recorded series is summarized", Summaries.Num(), 5);
+
+	const TSharedPtr<FJsonObject> Kills = FindSummary(Summaries, TEXT("kills"));
+	if (TestTrue("Counter summary", Kills.IsValid()))
+	{
+		TestEqual("Counter sums every thread", Kills->GetNumberField(TEXT("value")), 80000.0);
+	}
+
+	const TSharedPtr<FJsonObject> Fps = FindSummary(Summaries, TEXT("fps"), {{TEXT("map"), TEXT("arena")}, {TEXT("mode"), TEXT("duel")}});
+	if (TestTrue("Gauge summary", Fps.IsValid()))
+	{
+		TestEqual("Last", Fps->GetNumberField(TEXT("last")), 45.0);
+		TestEqual("Min", Fps->GetNumberField(TEXT("min")), 30.0);
+		TestEqual("Max", Fps->GetNumberField(TEXT("max")), 60.0);
+		TestEqual("Count", Fps->GetNumberField(TEXT("count")), 3.0);
+	}
+	TestTrue("Other tags are another series", FindSummary(Summaries, TEXT("fps"), {{TEXT("map"), TEXT("lobby")}}).IsValid());
+
+	const TSharedPtr<FJsonObject> Frame = FindSummary(Summaries, TEXT("frame_ms"));
+	if (TestTrue("Histogram summary", Frame.IsValid()))
+	{
+		TestEqual("Count", Frame->GetNumberField(TEXT("count")), 10000.0);
+		TestTrue("p50 within the accuracy", FMath::Abs(Frame->GetNumberField(TEXT("p50")) - 5000.0) <= 5000.0 * 0.01 + 1.0);
+		TestTrue("p99 within the accuracy", FMath::Abs(Frame->GetNumberField(TEXT("p99")) - 9900.0) <= 9900.0 * 0.01 + 1.0);
+		TestEqual("Max is exact", Frame->GetNumberField(TEXT("max")), 10000.0);
+
+		// Bins are absolute so they merge across clients, their counts add up to the count
+		double BinTotal = 0.0;
+		for (const TSharedPtr<FJsonValue>& Bin : Frame->GetArrayField(TEXT("bin_counts")))
+		{
+			BinTotal += Bin->AsNumber();
+		}
+		TestEqual("Bins hold every value", BinTotal, 10000.0);
+		const double Gamma = 1.01 / 0.99;
+		TestEqual("First bin holds 1", static_cast<int32>(Frame->GetNumberField(TEXT("bin_offset"))), FMath::CeilToInt32(FMath::Loge(1.0) / FMath::Loge(Gamma)));
+	}
+
+	const TSharedPtr<FJsonObject> Ping = FindSummary(Summaries, TEXT("ping_ms"));
+	if (TestTrue("Zero values", Ping.IsValid()))
+	{
+		TestEqual("Zero bin", Ping->GetNumberField(TEXT("zero_count")), 1.0);
+		TestEqual("Quantile of zeros", Ping->GetNumberField(TEXT("p50")), 0.0);
+	}
+
+	TestEqual("Collect resets the series", GameMetrics.Collect().Num(), 0);
+
+	// Memory is bounded by the number of series and the bins of each histogram
+	TestTrue("Histograms hold their bins", GameMetrics.GetAllocatedSize() >= 2 * Config.HistogramBins * 4);
+	for (int32 Index = 0; Index < 10; ++Index)
+	{
+		GameMetrics.Record(EHelikaSeriesType::Gauge, FString::Printf(TEXT("extra_%d"), Index), 1.0, {});
+	}
+	TestEqual("Series beyond MaxSeries are refused", GameMetrics.GetNumSeries(), Config.MaxSeries);
+	TestFalse("Refused series report it", GameMetrics.Record(EHelikaSeriesType::Gauge, TEXT("one_more"), 1.0, {}));
+
+	Config.bEnabled = false;
+	GameMetrics.Configure(Config);
+	TestFalse("Disabled metrics record nothing", GameMetrics.Record(EHelikaSeriesType::Counter, TEXT("kills"), 1.0, {}));
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
@@ -0,0 +1,128 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaDefines.h"
+#include "HelikaHashing.h"
+#include "HelikaLibrary.h"
+#include "HelikaSha256.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include <openssl/sha.h>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	FString ToHex(const uint8* Digest)
+	{
+		return BytesToHex(Digest, 32).ToLower();
+	}
+
+	/// One-shot OpenSSL digest of the UTF-8 of Value
+	FString ReferenceSha256(const FString& Value)
+	{
+		const FTCHARToUTF8 Utf8(*Value, Value.Len());
+		uint8 Digest[32];
+		SHA256(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length(), Digest);
+		return ToHex(Digest);
+	}
+
+	FString RandomValue(FRandomStream& Random, int32 MaxLength)
+	{
+		FString Value;
+		const int32 Length = Random.RandRange(0, MaxLength);
+		for (int32 Index = 0; Index < Length; ++Index)
+		{
+			// Mostly ASCII with some multi byte characters so that UTF-8 lengths differ from the character counts
+			Value.AppendChar(Random.RandRange(0, 9) == 0 ? static_cast<TCHAR>(Random.RandRange(0x80, 0x4FFF)) : static_cast<TCHAR>(Random.RandRange(0x20, 0x7E)));
+		}
+		return Value;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaHashingTest, "Helika.HelikaHashingTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaHashingTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// Known digests (FIPS 180-2 and RFC 4231 test case 2)
+	FHelikaHasher Hasher;
+	TestEqual("Empty string", Hasher.Hash(TEXT("")), FString("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+	TestEqual("abc", Hasher.Hash(TEXT("abc")), FString("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+	TestEqual("Two block message", Hasher.Hash(TEXT("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")), FString("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+	TestEqual("Base64", Hasher.Hash(TEXT("abc"), EHelikaHashEncoding::HHE_Base64), FString("ungWv48Bz+pBQUDeXa4iI7ADYaOWF3qctBD/YfIAFa0="));
+	TestEqual("ComputeSha256Hash goes through the hasher", UHelikaLibrary::ComputeSha256Hash(TEXT("abc")), FString("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+
+	FHelikaHasher Salted(TEXT("Jefe"));
+	TestTrue("Salt enables HMAC", Salted.IsSalted());
+	TestEqual("HMAC-SHA256", Salted.Hash(TEXT("what do ya want for nothing?")), FString("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+	FHelikaHasher LongSalt(FString::ChrN(100, TEXT('k')));
+	TestEqual("Salts longer than a block are hashed first", LongSalt.Hash(TEXT("player@example.com")), FString("46458da3af496f5e30522068a20a36fb5790ce59df2d9101f295f86f2067ffa8"));
+
+	// Every kernel available here must match OpenSSL on mixed lengths, one and several blocks, full and partial lanes
+	FRandomStream Random(48);
+	TArray<FString> Values;
+	for (int32 Index = 0; Index < 700; ++Index)
+	{
+		Values.Add(RandomValue(Random, Index % 5 == 0 ? 300 : 40));
+	}
+	TArray<FString> Expected;
+	for (const FString& Value : Values)
+	{
+		Expected.Add(ReferenceSha256(Value));
+	}
+
+	for (uint8 Kernel = 0; Kernel < static_cast<uint8>(EHelikaSha256Kernel::Num); ++Kernel)
+	{
+		const TCHAR* KernelName = FHelikaSha256::LexToString(static_cast<EHelikaSha256Kernel>(Kernel));
+		if (!FHelikaSha256::SetKernel(static_cast<EHelikaSha256Kernel>(Kernel)))
+		{
+			AddInfo(FString::Printf(TEXT("%s kernel is not available"), KernelName));
+			continue;
+		}
+
+		TArray<FString> Hashes;
+		FHelikaHasher().HashBatch(Values, EHelikaHashEncoding::HHE_Hex, Hashes);
+		int32 NumMismatches = 0;
+		for (int32 Index = 0; Index < Values.Num(); ++Index)
+		{
+			NumMismatches += Hashes[Index] == Expected[Index] ? 0 : 1;
+		}
+		TestEqual(FString::Printf(TEXT("%s digests match OpenSSL"), KernelName), NumMismatches, 0);
+
+		TArray<FString> SaltedHashes;
+		FHelikaHasher(TEXT("Jefe")).HashBatch({TEXT("what do ya want for nothing?")}, EHelikaHashEncoding::HHE_Hex, SaltedHashes);
+		TestEqual(FString::Printf(TEXT("%s HMAC"), KernelName), SaltedHashes[0], FString("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"));
+	}
+	FHelikaSha256::ResetKernel();
+
+	// The buffer API writes fixed width digests back to back and nothing past them
+	TArray<FStringView> Views = {TEXT("abc"), TEXT("")};
+	TArray<ANSICHAR> Buffer;
+	Buffer.Init('#', Views.Num() * FHelikaHasher::GetEncodedLength(EHelikaHashEncoding::HHE_Base64) + 1);
+	Hasher.HashBatch(Views, EHelikaHashEncoding::HHE_Base64, Buffer);
+	TestEqual("Base64 digests are 44 characters", FHelikaHasher::GetEncodedLength(EHelikaHashEncoding::HHE_Base64), 44);
+	TestEqual("Second digest follows the first", FString(44, Buffer.GetData() + 44), FString("47DEQpj8HBSa+/TImW+5JCeuQeRkm5NMpJWZG3hSuFU="));
+	TestTrue("Nothing is written past the digests", Buffer.Last() == '#');
+
+	// The cache answers repeated values, is case sensitive and keeps the most recently used ones
+	FHelikaHasher Cached(FString(), 2);
+	TArray<FString> Hashes;
+	Cached.HashBatch({TEXT("player@example.com"), TEXT("Player@example.com")}, EHelikaHashEncoding::HHE_Hex, Hashes);
+	TestEqual("Values differing in case are both hashed", Cached.GetCacheHits(), static_cast<int64>(0));
+	TestNotEqual("Values differing in case have different digests", Hashes[0], Hashes[1]);
+	Cached.HashBatch({TEXT("player@example.com"), TEXT("0xwallet")}, EHelikaHashEncoding::HHE_Hex, Hashes);
+	TestEqual("Repeated value is a hit", Cached.GetCacheHits(), static_cast<int64>(1));
+	TestEqual("Cached digest is the real one", Hashes[0], ReferenceSha256(TEXT("player@example.com")));
+	TestEqual("Cache stays at capacity", Cached.GetCacheNum(), 2);
+	Cached.HashBatch({TEXT("Player@example.com")}, EHelikaHashEncoding::HHE_Hex, Hashes);
+	TestEqual("Least recently used value was evicted", Cached.GetCacheHits(), static_cast<int64>(1));
+	Cached.HashBatch({TEXT("0xwallet")}, EHelikaHashEncoding::HHE_Hex, Hashes);
+	TestEqual("Recently used value was kept", Cached.GetCacheHits(), static_cast<int64>(2));
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaConfigSnapshot.h"
+#include "HelikaDefines.h"
+#include "HelikaLane.h"
+#include "HelikaLibrary.h"
+#include "HelikaManager.h"
+#include "HelikaScheduler.h"
+#include "HelikaSettings.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	TSharedPtr<FJsonObject> MakeEvent(const FString& EventType)
+	{
+		const TSharedPtr<FJsonObject> Event = MakeShareable(new FJsonObject());
+		Event->SetStringField("event_type", EventType);
+		const TSharedPtr<FJsonObject> InternalEvent = MakeShareable(new FJsonObject());
+		InternalEvent->SetStringField("event_sub_type", EventType);
+		Event->SetObjectField("event", InternalEvent);
+		return Event;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaLaneTest, "Helika.HelikaLaneTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaLaneTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// Normal events are routed by event_type, explicit priorities are kept
+	FHelikaConfigSnapshot Snapshot;
+	Snapshot.EventTypePriorities.Add(TEXT("purchase"), EHelikaPriority::HP_Critical);
+	TestTrue("Listed event types change lane", Snapshot.ResolvePriority(*MakeEvent("purchase"), EHelikaPriority::HP_Normal) == EHelikaPriority::HP_Critical);
+	TestTrue("Explicit priorities win", Snapshot.ResolvePriority(*MakeEvent("purchase"), EHelikaPriority::HP_Bulk) == EHelikaPriority::HP_Bulk);
+	TestTrue("Other event types stay Normal", Snapshot.ResolvePriority(*MakeEvent("player_killed"), EHelikaPriority::HP_Normal) == EHelikaPriority::HP_Normal);
+
+	// Consecutive transient failures back off exponentially, Retry-After wins, a success resets
+	FHelikaLane Lane(EHelikaPriority::HP_Bulk);
+	const double Start = FPlatformTime::Seconds();
+	Lane.RecordUploadResult(true, 0, 30.f);
+	Lane.RecordUploadResult(true, 0, 30.f);
+	TestTrue("Second failure waits two seconds", Lane.GetBackoffUntil() >= Start + 2.0 && Lane.GetBackoffUntil() < Start + 3.0);
+	Lane.RecordUploadResult(true, 7, 30.f);
+	TestTrue("Retry-After is honored", Lane.GetBackoffUntil() >= Start + 7.0);
+	for (int32 Failure = 0; Failure < 20; ++Failure)
+	{
+		Lane.RecordUploadResult(true, 0, 30.f);
+	}
+	TestTrue("Backoff is capped", Lane.GetBackoffUntil() <= FPlatformTime::Seconds() + 30.0);
+	Lane.RecordUploadResult(false, 0, 30.f);
+	TestFalse("Success ends the backoff", Lane.IsBackingOff(FPlatformTime::Seconds()));
+	TestEqual("Success resets the failures", Lane.GetConsecutiveFailures(), 0);
+
+	UHelikaSettings* Settings = UHelikaLibrary::GetHelikaSettings();
+	const FHelikaLaneSettings OriginalCriticalLane = Settings->CriticalLane;
+	const FHelikaLaneSettings OriginalBulkLane = Settings->BulkLane;
+	const bool bOriginalPrintEventsToConsole = Settings->bPrintEventsToConsole;
+	Settings->HelikaAPIKey = "TestAPIKey";
+	Settings->GameId = "ValidGameId";
+	Settings->bPrintEventsToConsole = false;
+	Settings->CriticalLane.MaxBatchSize = 1;
+	Settings->BulkLane.MaxBatchSize = 1000;
+	Settings->BulkLane.MaxQueuedEvents = 5;
+
+	UHelikaManager* HelikaManager = NewObject<UHelikaManager>();
+	HelikaManager->InitializeSDK();
+
+	// Lets the session event through
+	HelikaManager->Scheduler->RunAll();
+
+	// Critical events leave on the next scheduler run, Bulk ones wait and are shed beyond MaxQueuedEvents
+	const FHelikaMetrics Before = HelikaManager->GetMetrics();
+	HelikaManager->SendEvent(MakeEvent("purchase"));
+	TestEqual("Critical event is queued inline", HelikaManager->GetMetrics().QueueDepth, Before.QueueDepth + 1);
+	HelikaManager->Scheduler->RunAll();
+	TestEqual("Critical event is uploaded by the scheduled flush", HelikaManager->GetMetrics().QueueDepth, Before.QueueDepth);
+
+	for (int32 Index = 0; Index < 12; ++Index)
+	{
+		HelikaManager->SendEvent(MakeEvent("player_killed"), EHelikaPriority::HP_Bulk);
+	}
+	const FHelikaMetrics After = HelikaManager->GetMetrics();
+	TestEqual("Bulk lane keeps MaxQueuedEvents", After.QueueDepth - Before.QueueDepth, 5ll);
+	TestEqual("Oldest bulk events are shed", After.EventsShed - Before.EventsShed, 7ll);
+
+	HelikaManager->Flush();
+	TestEqual("Flush empties every lane", HelikaManager->GetMetrics().QueueDepth, Before.QueueDepth);
+
+	HelikaManager->DeinitializeSDK();
+	Settings->CriticalLane = OriginalCriticalLane;
+	Settings->BulkLane = OriginalBulkLane;
+	Settings->bPrintEventsToConsole = bOriginalPrintEventsToConsole;
+	LogHelika.SetVerbosity(OriginalVerbosity);
+
+	return true;
+}
+
+#endif
@@ -74,6 +74,16 @@ bool FHelikaSendEventTest::RunTest(const FString& Parameters)
 
 	TestTrue("Invalid Parameter Call", HelikaManager->SendEvent(EventData));
 
+	// The queue keeps an enriched copy, the caller's objects are left as they were
+	TSharedPtr<FJsonObject> SubEvent = MakeShareable(new FJsonObject());
+	SubEvent->SetStringField("event_sub_type", "player_killed");
+	TSharedPtr<FJsonObject> Reused = MakeShareable(new FJsonObject());
+	Reused->SetStringField("event_type", "gameplay");
+	Reused->SetObjectField("event", SubEvent);
+	TestTrue("Event is sent", HelikaManager->SendEvent(Reused));
+	TestTrue("Event is sent twice in one call", HelikaManager->SendEvents({Reused, Reused}));
+	TestFalse("Caller's event is not enriched", Reused->HasField(TEXT("game_id")) || Reused->HasField(TEXT("created_at")));
+	TestFalse("Caller's sub event is not enriched", SubEvent->HasField(TEXT("session_id")) || SubEvent->HasField(TEXT("user_id")));
 
 
 
@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaDefines.h"
+#include "HelikaLibrary.h"
+#include "HelikaManager.h"
+#include "HelikaMemoryCounters.h"
+#include "HelikaSettings.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaMemoryTest, "Helika.HelikaMemoryTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaMemoryTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// Estimates grow with the content of the tree
+	const TSharedPtr<FJsonObject> Small = MakeShareable(new FJsonObject());
+	Small->SetStringField("map", "arctic");
+	const TSharedPtr<FJsonObject> Large = MakeShareable(new FJsonObject());
+	Large->SetStringField("map", FString::ChrN(1000, TEXT('a')));
+	Large->SetObjectField("nested", Small);
+	TestTrue("Empty tree has no size", FHelikaMemoryCounters::EstimateJsonBytes(TSharedPtr<FJsonObject>()) == 0);
+	TestTrue("Long strings are counted", FHelikaMemoryCounters::EstimateJsonBytes(Large) > FHelikaMemoryCounters::EstimateJsonBytes(Small) + 1000);
+
+	UHelikaSettings* Settings = UHelikaLibrary::GetHelikaSettings();
+	const int32 OriginalMaxBatchSize = Settings->MaxBatchSize;
+	Settings->HelikaAPIKey = "TestAPIKey";
+	Settings->GameId = "ValidGameId";
+	Settings->MaxBatchSize = 1000;
+
+	UHelikaManager* HelikaManager = NewObject<UHelikaManager>();
+	HelikaManager->InitializeSDK();
+
+	// Counters are process wide, compare against a baseline
+	const FHelikaMemoryUsage Before = HelikaManager->GetMemoryUsage();
+	TestEqual("Every tag is reported", Before.Tags.Num(), static_cast<int32>(EHelikaMemoryTag::Count));
+
+	const FHelikaContext Context = HelikaManager->CreateContext(Large);
+	const int64 ContextBytes = HelikaManager->GetMemoryUsage().Get(EHelikaMemoryTag::Contexts).CurrentBytes - Before.Get(EHelikaMemoryTag::Contexts).CurrentBytes;
+	TestTrue("Context is accounted", ContextBytes > 1000);
+
+	HelikaManager->DestroyContext(Context);
+	TestEqual("Destroyed context is released", HelikaManager->GetMemoryUsage().Get(EHelikaMemoryTag::Contexts).CurrentBytes, Before.Get(EHelikaMemoryTag::Contexts).CurrentBytes);
+
+	for (int32 Index = 0; Index < 100; ++Index)
+	{
+		const TSharedPtr<FJsonObject> Event = MakeShareable(new FJsonObject());
+		Event->SetStringField("event_type", "gameplay");
+		Event->SetObjectField("event", MakeShareable(new FJsonObject()));
+		HelikaManager->SendEvent(Event);
+	}
+	const FHelikaMemoryUsage Queued = HelikaManager->GetMemoryUsage();
+	TestTrue("Queued events are accounted", Queued.Get(EHelikaMemoryTag::IngestQueue).CurrentBytes > Before.Get(EHelikaMemoryTag::IngestQueue).CurrentBytes);
+
+	HelikaManager->Flush();
+	const FHelikaMemoryUsage Flushed = HelikaManager->GetMemoryUsage();
+	TestTrue("Flushed queue releases its events", Flushed.Get(EHelikaMemoryTag::IngestQueue).CurrentBytes < Queued.Get(EHelikaMemoryTag::IngestQueue).CurrentBytes);
+	TestTrue("Serialization buffers are released after the flush", Flushed.Get(EHelikaMemoryTag::Serialization).CurrentBytes == Before.Get(EHelikaMemoryTag::Serialization).CurrentBytes);
+	TestTrue("Serialization peak is kept", Flushed.Get(EHelikaMemoryTag::Serialization).PeakBytes > Flushed.Get(EHelikaMemoryTag::Serialization).CurrentBytes);
+
+	HelikaManager->ResetMemoryPeaks();
+	const FHelikaMemoryTagUsage Reset = HelikaManager->GetMemoryUsage().Get(EHelikaMemoryTag::Serialization);
+	TestEqual("Reset peak starts from the current value", Reset.PeakBytes, Reset.CurrentBytes);
+
+	HelikaManager->DeinitializeSDK();
+	Settings->MaxBatchSize = OriginalMaxBatchSize;
+	LogHelika.SetVerbosity(OriginalVerbosity);
+
+	return true;
+}
+
+
+#endif
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaLibrary.h"
+#include "HelikaManager.h"
+#include "HelikaMetricsCounters.h"
+#include "Async/Async.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Compression.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaMetricsTest, "Helika.HelikaMetricsTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaMetricsTest::RunTest(const FString& Parameters)
+{
+	// Counters are process wide, compare against a baseline
+	const FHelikaMetrics Before = FHelikaMetricsCounters::Read();
+
+	// Per-thread counters are summed on read, including threads that already finished
+	TArray<TFuture<void>> Writers;
+	for (int32 WriterIndex = 0; WriterIndex < 4; ++WriterIndex)
+	{
+		Writers.Add(Async(EAsyncExecution::Thread, []()
+		{
+			for (int32 Index = 0; Index < 1000; ++Index)
+			{
+				FHelikaMetricsCounters::Add(EHelikaCounter::Retries);
+			}
+		}));
+	}
+	for (TFuture<void>& Writer : Writers)
+	{
+		Writer.Wait();
+	}
+
+	FHelikaMetricsCounters::RecordRequestLatency(0.005);
+	FHelikaMetricsCounters::RecordRequestLatency(60.0);
+
+	const FHelikaMetrics After = FHelikaMetricsCounters::Read();
+	TestEqual("Counters of every thread are aggregated", After.Retries - Before.Retries, 4000ll);
+	TestEqual("Histogram has one count per bucket", After.RequestLatencyHistogram.Num(), After.RequestLatencyBucketsMs.Num());
+	TestEqual("Fast request lands in the first bucket", After.RequestLatencyHistogram[0] - Before.RequestLatencyHistogram[0], 1ll);
+	TestEqual("Slow request lands in the unbounded bucket", After.RequestLatencyHistogram.Last() - Before.RequestLatencyHistogram.Last(), 1ll);
+
+	// Sends refused by validation are reported as rejected
+	UHelikaManager* Manager = NewObject<UHelikaManager>();
+	TArray<TSharedPtr<FJsonObject>> Events;
+	Events.Add(MakeShareable(new FJsonObject()));
+	Events.Add(MakeShareable(new FJsonObject()));
+	Manager->SendEvents(Events);
+	TestEqual("Events sent before initialization are rejected", Manager->GetMetrics().EventsRejected - After.EventsRejected, 2ll);
+
+	// Compressed payloads round trip
+	const FString Json = TEXT("{\"events\":[{\"event_type\":\"win\"},{\"event_type\":\"win\"},{\"event_type\":\"win\"},{\"event_type\":\"win\"}]}");
+	const FTCHARToUTF8 Utf8(*Json);
+	const TArray<uint8> Original(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	TArray<uint8> Payload = Original;
+	if (TestTrue("Repetitive payload is compressed", UHelikaLibrary::GzipCompress(Payload)))
+	{
+		TArray<uint8> Uncompressed;
+		Uncompressed.SetNumUninitialized(Original.Num());
+		TestTrue("Payload is valid gzip", FCompression::UncompressMemory(NAME_Gzip, Uncompressed.GetData(), Uncompressed.Num(), Payload.GetData(), Payload.Num()));
+		TestTrue("Payload round trips", Uncompressed == Original);
+	}
+
+	return true;
+}
+
+
+#endif
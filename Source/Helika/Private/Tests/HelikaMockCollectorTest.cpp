@@ -0,0 +1,170 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaAcknowledgement.h"
+#include "HelikaDefines.h"
+#include "HelikaLibrary.h"
+#include "MockCollector/HelikaMockCollector.h"
+#include "Common/TcpSocketBuilder.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Misc/AutomationTest.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	TArray<uint8> ToUtf8(const FString& Text)
+	{
+		const FTCHARToUTF8 Utf8(*Text);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	/// Sends one request with 'Connection: close' and returns everything received, empty if the connection was dropped
+	FString SendRawRequest(int32 Port, const FString& Body, const FString& ExtraHeaders = FString())
+	{
+		FSocket* Socket = FTcpSocketBuilder(TEXT("HelikaMockCollectorTest")).AsBlocking().Build();
+		const TSharedRef<FInternetAddr> Address = FIPv4Endpoint(FIPv4Address::InternalLoopback, Port).ToInternetAddr();
+		FString Response;
+		if (Socket != nullptr && Socket->Connect(*Address))
+		{
+			const TArray<uint8> BodyUtf8 = ToUtf8(Body);
+			const FString Header = FString::Printf(TEXT("POST /v1/events/ HTTP/1.1\r\nHost: localhost\r\nx-api-key: TestAPIKey\r\nContent-Type: application/json\r\n%sContent-Length: %d\r\nConnection: close\r\n\r\n"), *ExtraHeaders, BodyUtf8.Num());
+			TArray<uint8> Request = ToUtf8(Header);
+			Request.Append(BodyUtf8);
+
+			int32 Sent = 0;
+			Socket->Send(Request.GetData(), Request.Num(), Sent);
+
+			TArray<uint8> Received;
+			uint8 Chunk[4096];
+			int32 BytesRead = 0;
+			while (Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(5)) && Socket->Recv(Chunk, sizeof(Chunk), BytesRead) && BytesRead > 0)
+			{
+				Received.Append(Chunk, BytesRead);
+			}
+			Response = FString(Received.Num(), reinterpret_cast<const ANSICHAR*>(Received.GetData()));
+		}
+
+		if (Socket != nullptr)
+		{
+			Socket->Close();
+			ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		}
+		return Response;
+	}
+
+	const TCHAR* ValidEnvelope = TEXT("{\"id\":\"batch\",\"events\":[{\"event_type\":\"gameplay\",\"game_id\":\"game\",\"created_at\":\"2024-01-01T00:00:00.000Z\",\"event\":{\"session_id\":\"session\"}}]}");
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaMockCollectorEnvelopeTest, "Helika.HelikaMockCollectorEnvelopeTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaMockCollectorEnvelopeTest::RunTest(const FString& Parameters)
+{
+	FString Error;
+	TestEqual("Valid envelope is accepted", FHelikaMockCollector::ValidateEnvelope(ToUtf8(ValidEnvelope), Error), 1);
+	TestEqual("Empty events are rejected", FHelikaMockCollector::ValidateEnvelope(ToUtf8(TEXT("{\"id\":\"batch\",\"events\":[]}")), Error), static_cast<int32>(INDEX_NONE));
+	TestEqual("Events need a session", FHelikaMockCollector::ValidateEnvelope(ToUtf8(TEXT("{\"id\":\"batch\",\"events\":[{\"event_type\":\"a\",\"game_id\":\"g\",\"created_at\":\"t\",\"event\":{}}]}")), Error), static_cast<int32>(INDEX_NONE));
+	TestEqual("Not json is rejected", FHelikaMockCollector::ValidateEnvelope(ToUtf8(TEXT("events")), Error), static_cast<int32>(INDEX_NONE));
+
+	// Every encoding the SDK produces is decoded
+	const TArray<uint8> Original = ToUtf8(FString(ValidEnvelope) + FString(ValidEnvelope));
+	TArray<uint8> Compressed = Original;
+	TArray<uint8> Decoded;
+	if (TestTrue("Payload is compressed", UHelikaLibrary::GzipCompress(Compressed)))
+	{
+		TestTrue("Gzip is decoded", FHelikaMockCollector::DecodeBody(TEXT("gzip"), MoveTemp(Compressed), Decoded, Error));
+		TestTrue("Gzip round trips", Decoded == Original);
+	}
+	TestTrue("Identity is passed through", FHelikaMockCollector::DecodeBody(TEXT("identity"), TArray<uint8>(Original), Decoded, Error) && Decoded == Original);
+	TestFalse("Unknown encodings are refused", FHelikaMockCollector::DecodeBody(TEXT("br"), TArray<uint8>(Original), Decoded, Error));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaMockCollectorFaultTest, "Helika.HelikaMockCollectorFaultTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaMockCollectorFaultTest::RunTest(const FString& Parameters)
+{
+	FHelikaMockCollectorConfig Config;
+	Config.Port = 18181;
+	FHelikaMockCollector Collector(Config);
+	if (!TestTrue("Collector starts", Collector.Start()))
+	{
+		return false;
+	}
+
+	TestTrue("Valid batch is acknowledged", SendRawRequest(Config.Port, ValidEnvelope).StartsWith(TEXT("HTTP/1.1 200")));
+	TestTrue("Invalid batch is refused", SendRawRequest(Config.Port, TEXT("{}")).StartsWith(TEXT("HTTP/1.1 400")));
+	TestTrue("Corrupt gzip body is malformed", SendRawRequest(Config.Port, ValidEnvelope, TEXT("Content-Encoding: gzip\r\n")).StartsWith(TEXT("HTTP/1.1 400")));
+	TestTrue("Unknown encoding is unsupported", SendRawRequest(Config.Port, ValidEnvelope, TEXT("Content-Encoding: br\r\n")).StartsWith(TEXT("HTTP/1.1 415")));
+
+	Config.ErrorRate = 1.f;
+	Config.ErrorStatus = 503;
+	Config.RetryAfterSeconds = 2;
+	Collector.SetConfig(Config);
+	const FString Throttled = SendRawRequest(Config.Port, ValidEnvelope);
+	TestTrue("Injected status is returned", Throttled.StartsWith(TEXT("HTTP/1.1 503")));
+	TestTrue("Retry-After is sent", Throttled.Contains(TEXT("Retry-After: 2")));
+
+	Config.ErrorRate = 0.f;
+	Config.DropRate = 1.f;
+	Collector.SetConfig(Config);
+	TestTrue("Dropped connection has no answer", SendRawRequest(Config.Port, ValidEnvelope).IsEmpty());
+
+	Collector.Stop();
+
+	const FHelikaMockCollectorStats Stats = Collector.GetStats();
+	TestEqual("Every request is recorded", Stats.Requests, 6ll);
+	TestEqual("Accepted events are counted", Stats.Events, 1ll);
+	TestEqual("Invalid requests are counted", Stats.Invalid, 3ll);
+	TestEqual("Injected errors are counted", Stats.InjectedErrors, 1ll);
+	TestEqual("Drops are counted", Stats.Dropped, 1ll);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaMockCollectorPartialTest, "Helika.HelikaMockCollectorPartialTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaMockCollectorPartialTest::RunTest(const FString& Parameters)
+{
+	FHelikaMockCollectorConfig Config;
+	Config.Port = 18182;
+	FHelikaMockCollector Collector(Config);
+	if (!TestTrue("Collector starts", Collector.Start()))
+	{
+		return false;
+	}
+
+	// The second event has no session, only that one is refused
+	const FString Event = TEXT("{\"event_type\":\"gameplay\",\"game_id\":\"game\",\"created_at\":\"2024-01-01T00:00:00.000Z\",\"event\":{\"session_id\":\"session\"}}");
+	const FString Malformed = TEXT("{\"event_type\":\"gameplay\",\"game_id\":\"game\",\"created_at\":\"2024-01-01T00:00:00.000Z\",\"event\":{}}");
+	const FString Mixed = FString::Printf(TEXT("{\"id\":\"batch\",\"events\":[%s,%s,%s]}"), *Event, *Malformed, *Event);
+
+	FString Body;
+	const FString Response = SendRawRequest(Config.Port, Mixed);
+	TestTrue("Partially valid batch is acknowledged", Response.StartsWith(TEXT("HTTP/1.1 200")) && Response.Split(TEXT("\r\n\r\n"), nullptr, &Body));
+	const FHelikaAcknowledgement Partial = FHelikaAcknowledgement::Parse(3, 200, ToUtf8(Body));
+	TestEqual("Valid events are stored", Partial.NumAccepted, 2);
+	TestTrue("The malformed event is invalid", Partial.Results.IsValidIndex(1) && Partial.Results[1] == EHelikaEventResult::Invalid);
+
+	// Every valid event fails transiently
+	Config.EventRetryRate = 1.f;
+	Collector.SetConfig(Config);
+	SendRawRequest(Config.Port, Mixed).Split(TEXT("\r\n\r\n"), nullptr, &Body);
+	const FHelikaAcknowledgement Transient = FHelikaAcknowledgement::Parse(3, 200, ToUtf8(Body));
+	TestEqual("Valid events are retried", Transient.NumRetry, 2);
+	TestEqual("The malformed event stays invalid", Transient.NumInvalid, 1);
+
+	Collector.Stop();
+
+	const FHelikaMockCollectorStats Stats = Collector.GetStats();
+	TestEqual("Stored events are counted", Stats.Events, 2ll);
+	TestEqual("Rejected events are counted", Stats.RejectedEvents, 2ll);
+	TestEqual("Retryable events are counted", Stats.RetryableEvents, 2ll);
+
+	return true;
+}
+
+
+#endif
@@ -0,0 +1,313 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaPerfHarness.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "HelikaConfigSnapshot.h"
+#include "HelikaDefines.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonSerializer.h"
+#include <atomic>
+
+namespace
+{
+	/**
+	 * Forwards to the real allocator and counts the allocations of every thread while it is installed in GMalloc.
+	 * Calls in progress are counted too, so that the proxy is only freed once no thread is inside it.
+	 */
+	class FHelikaPerfMallocProxy final : public FMalloc
+	{
+	public:
+		explicit FHelikaPerfMallocProxy(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		uint64 GetAllocations() const
+		{
+			return Allocations;
+		}
+
+		uint64 GetBytes() const
+		{
+			return Bytes;
+		}
+
+		/// After GMalloc was restored, waits for the calls that entered the proxy before
+		void WaitForCalls() const
+		{
+			while (NumCalls.load(std::memory_order_acquire) > 0)
+			{
+				FPlatformProcess::Yield();
+			}
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			const FCallScope Scope(*this, Count);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			const FCallScope Scope(*this, Count);
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			const FCallScope Scope(*this, Count);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			const FCallScope Scope(*this, Count);
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			const FCallScope Scope(*this, 0);
+			Inner->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			const FCallScope Scope(*this, 0);
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			const FCallScope Scope(*this, 0);
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			const FCallScope Scope(*this, 0);
+			Inner->Trim(bTrimThreadCaches);
+		}
+
+		virtual void SetupTLSCachesOnCurrentThread() override
+		{
+			const FCallScope Scope(*this, 0);
+			Inner->SetupTLSCachesOnCurrentThread();
+		}
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			const FCallScope Scope(*this, 0);
+			Inner->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+
+		virtual bool ValidateHeap() override
+		{
+			const FCallScope Scope(*this, 0);
+			return Inner->ValidateHeap();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return Inner->GetDescriptiveName();
+		}
+
+	private:
+		/// One call into the proxy, Count is the size of an allocation and 0 for any other call
+		struct FCallScope
+		{
+			FCallScope(FHelikaPerfMallocProxy& InProxy, SIZE_T Count)
+				: Proxy(InProxy)
+			{
+				Proxy.NumCalls.fetch_add(1, std::memory_order_acquire);
+				// Frees through Realloc(Ptr, 0) are not allocations
+				if (Count > 0)
+				{
+					Proxy.Allocations.fetch_add(1, std::memory_order_relaxed);
+					Proxy.Bytes.fetch_add(Count, std::memory_order_relaxed);
+				}
+			}
+
+			~FCallScope()
+			{
+				Proxy.NumCalls.fetch_sub(1, std::memory_order_release);
+			}
+
+			FHelikaPerfMallocProxy& Proxy;
+		};
+
+		FMalloc* const Inner;
+		std::atomic<uint64> Allocations{0};
+		std::atomic<uint64> Bytes{0};
+		std::atomic<int32> NumCalls{0};
+	};
+
+	/// Threshold from [Helika.PerfThresholds], 0 when not configured
+	double GetThreshold(const FString& Name, const TCHAR* Metric)
+	{
+		double Threshold = 0.0;
+		if (GConfig != nullptr)
+		{
+			GConfig->GetDouble(TEXT("Helika.PerfThresholds"), *FString::Printf(TEXT("%s.%s"), *Name, Metric), Threshold, GEngineIni);
+		}
+
+		float Scale = 1.f;
+		FParse::Value(FCommandLine::Get(), TEXT("HelikaPerfThresholdScale="), Scale);
+		return Threshold * Scale;
+	}
+
+	void CheckThreshold(FAutomationTestBase& Test, const FString& Name, const TCHAR* Metric, double Value)
+	{
+		const double Threshold = GetThreshold(Name, Metric);
+		if (Threshold > 0.0 && Value > Threshold)
+		{
+			Test.AddError(FString::Printf(TEXT("%s: %s is %.2f, threshold is %.2f"), *Name, Metric, Value, Threshold));
+		}
+	}
+}
+
+FHelikaPerfResult HelikaPerf::Measure(const FString& Name, int32 NumEvents, int32 Iterations, TFunctionRef<void()> Body)
+{
+	// Warm-up so lazily created caches and first-use allocations are not counted
+	Body();
+
+	uint64 StartCycles = 0;
+	uint64 EndCycles = 0;
+	uint64 NumAllocations = 0;
+	uint64 NumBytes = 0;
+	{
+		// Published with a full barrier so that no thread sees the proxy before its Inner
+		FMalloc* const Inner = GMalloc;
+		FHelikaPerfMallocProxy* const Proxy = new FHelikaPerfMallocProxy(Inner);
+		verify(FPlatformAtomics::InterlockedExchangePtr(reinterpret_cast<void**>(&GMalloc), Proxy) == Inner);
+		ON_SCOPE_EXIT
+		{
+			FPlatformAtomics::InterlockedExchangePtr(reinterpret_cast<void**>(&GMalloc), Inner);
+			NumAllocations = Proxy->GetAllocations();
+			NumBytes = Proxy->GetBytes();
+			// A thread that loaded GMalloc just before the restore may not have entered the proxy yet, the grace period covers it
+			FPlatformProcess::Sleep(0.01f);
+			Proxy->WaitForCalls();
+			delete Proxy;
+		};
+
+		StartCycles = FPlatformTime::Cycles64();
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			Body();
+		}
+		EndCycles = FPlatformTime::Cycles64();
+	}
+
+	const double TotalEvents = static_cast<double>(FMath::Max(NumEvents, 1)) * FMath::Max(Iterations, 1);
+
+	FHelikaPerfResult Result;
+	Result.Name = Name;
+	Result.NumEvents = NumEvents;
+	Result.Iterations = Iterations;
+	Result.NsPerEvent = FPlatformTime::ToSeconds64(EndCycles - StartCycles) * 1e9 / TotalEvents;
+	Result.AllocsPerEvent = NumAllocations / TotalEvents;
+	Result.BytesPerEvent = NumBytes / TotalEvents;
+	return Result;
+}
+
+int32 HelikaPerf::GetIterations(int32 NumEvents)
+{
+	return FMath::Clamp(10000 / FMath::Max(NumEvents, 1), 3, 10000);
+}
+
+void HelikaPerf::Report(FAutomationTestBase& Test, const FHelikaPerfResult& Result)
+{
+	const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetStringField(TEXT("name"), Result.Name);
+	Json->SetNumberField(TEXT("events"), Result.NumEvents);
+	Json->SetNumberField(TEXT("iterations"), Result.Iterations);
+	Json->SetNumberField(TEXT("ns_per_event"), Result.NsPerEvent);
+	Json->SetNumberField(TEXT("allocs_per_event"), Result.AllocsPerEvent);
+	Json->SetNumberField(TEXT("bytes_per_event"), Result.BytesPerEvent);
+	Json->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+	Json->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+
+	FString Line;
+	const TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+	FJsonSerializer::Serialize(Json, Writer);
+
+	UE_LOG(LogHelika, Display, TEXT("HelikaPerf: %s"), *Line);
+	Test.AddInfo(FString::Printf(TEXT("%s: %.1f ns/event, %.2f allocs/event, %.1f bytes/event"), *Result.Name, Result.NsPerEvent, Result.AllocsPerEvent, Result.BytesPerEvent));
+
+	FString OutputDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Automation"), TEXT("HelikaPerf"));
+	FParse::Value(FCommandLine::Get(), TEXT("HelikaPerfOutput="), OutputDir);
+	FFileHelper::SaveStringToFile(Line, *FPaths::Combine(OutputDir, Result.Name + TEXT(".json")));
+
+	CheckThreshold(Test, Result.Name, TEXT("MaxNsPerEvent"), Result.NsPerEvent);
+	CheckThreshold(Test, Result.Name, TEXT("MaxAllocsPerEvent"), Result.AllocsPerEvent);
+	CheckThreshold(Test, Result.Name, TEXT("MaxBytesPerEvent"), Result.BytesPerEvent);
+}
+
+TSharedPtr<FJsonObject> HelikaPerf::MakeEvent(int32 Index)
+{
+	TSharedPtr<FJsonObject> EventDetail = MakeShareable(new FJsonObject());
+	EventDetail->SetStringField("map", "arctic");
+	EventDetail->SetStringField("team", "counter-terrorists");
+	EventDetail->SetNumberField("kills", Index % 30);
+	EventDetail->SetNumberField("damage", 12.5 * Index);
+	EventDetail->SetBoolField("headshot", Index % 3 == 0);
+
+	TSharedPtr<FJsonObject> SubEvent = MakeShareable(new FJsonObject());
+	SubEvent->SetStringField("event_sub_type", "player_killed");
+	SubEvent->SetObjectField("event_detail", EventDetail);
+
+	TSharedPtr<FJsonObject> Event = MakeShareable(new FJsonObject());
+	Event->SetStringField("event_type", "gameplay");
+	Event->SetObjectField("event", SubEvent);
+	return Event;
+}
+
+TArray<TSharedPtr<FJsonObject>> HelikaPerf::MakeEvents(int32 NumEvents)
+{
+	TArray<TSharedPtr<FJsonObject>> Events;
+	Events.Reserve(NumEvents);
+	for (int32 Index = 0; Index < NumEvents; ++Index)
+	{
+		Events.Add(MakeEvent(Index));
+	}
+	return Events;
+}
+
+TArray<FHelikaQueuedEvent> HelikaPerf::MakeQueuedEvents(int32 NumEvents)
+{
+	const TSharedRef<FHelikaConfigSnapshot, ESPMode::ThreadSafe> Config = MakeShared<FHelikaConfigSnapshot, ESPMode::ThreadSafe>();
+	Config->AppDetails = MakeShareable(new FJsonObject());
+	Config->AppDetails->SetStringField("platform_id", "Linux");
+	const TSharedRef<FHelikaContextData, ESPMode::ThreadSafe> Context = MakeShared<FHelikaContextData, ESPMode::ThreadSafe>();
+	Context->SessionId = FGuid::NewGuid().ToString();
+	Context->AnonymousId = "anon";
+	Context->UserDetails = MakeShareable(new FJsonObject());
+
+	TArray<FHelikaQueuedEvent> Events;
+	Events.Reserve(NumEvents);
+	for (const TSharedPtr<FJsonObject>& Event : MakeEvents(NumEvents))
+	{
+		FHelikaQueuedEvent& Queued = Events.AddDefaulted_GetRef();
+		Queued.Event = Event;
+		Queued.Context = Context;
+		Queued.Config = Config;
+	}
+	return Events;
+}
+
+#endif
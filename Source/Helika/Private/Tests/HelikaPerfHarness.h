@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+class FAutomationTestBase;
+class FJsonObject;
+struct FHelikaQueuedEvent;
+
+/// Cost of one benchmark, normalized per event
+struct FHelikaPerfResult
+{
+	FString Name;
+	int32 NumEvents = 0;
+	int32 Iterations = 0;
+	double NsPerEvent = 0.0;
+	double AllocsPerEvent = 0.0;
+	double BytesPerEvent = 0.0;
+};
+
+/**
+ * Helpers shared by the Helika.Perf.* automation tests.
+ *
+ * Results are logged as one 'HelikaPerf: {json}' line per benchmark and written to
+ * Saved/Automation/HelikaPerf/<Name>.json (or the directory passed with -HelikaPerfOutput=).
+ * Regression thresholds are read from the [Helika.PerfThresholds] section of the engine ini:
+ *   SendEvents.10000.MaxNsPerEvent=20000
+ *   SendEvents.10000.MaxAllocsPerEvent=60
+ * and can be scaled for slower machines with -HelikaPerfThresholdScale=2.0
+ */
+namespace HelikaPerf
+{
+	/// Runs Body once to warm up, then Iterations times while counting time and allocations. Allocations of every thread
+	/// are counted, work the pipeline hands to worker threads included, so unrelated engine threads add noise: run on an idle editor.
+	FHelikaPerfResult Measure(const FString& Name, int32 NumEvents, int32 Iterations, TFunctionRef<void()> Body);
+
+	/// Picks an iteration count so small workloads are repeated enough to be measurable
+	int32 GetIterations(int32 NumEvents);
+
+	/// Logs and writes the result, adds a test error for every exceeded threshold
+	void Report(FAutomationTestBase& Test, const FHelikaPerfResult& Result);
+
+	/// Typical gameplay event, about 300 bytes once enriched
+	TSharedPtr<FJsonObject> MakeEvent(int32 Index);
+
+	TArray<TSharedPtr<FJsonObject>> MakeEvents(int32 NumEvents);
+
+	/// MakeEvents as the serializer sees them, sharing one config and context as the events of a session do
+	TArray<FHelikaQueuedEvent> MakeQueuedEvents(int32 NumEvents);
+}
+
+#endif
@@ -0,0 +1,416 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaBatchSerializer.h"
+#include "HelikaColumnarBatch.h"
+#include "HelikaConfigSnapshot.h"
+#include "HelikaDefines.h"
+#include "HelikaHashing.h"
+#include "HelikaJsonLibrary.h"
+#include "HelikaLibrary.h"
+#include "HelikaManager.h"
+#include "HelikaPerfHarness.h"
+#include "HelikaSettings.h"
+#include "HelikaSha256.h"
+#include "HelikaStringKernels.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/// Initialized manager that only serializes, nothing is printed or uploaded
+	struct FHelikaPerfScope
+	{
+		FHelikaPerfScope()
+		{
+			UHelikaSettings* Settings = UHelikaLibrary::GetHelikaSettings();
+			OriginalSettings = {Settings->HelikaAPIKey, Settings->GameId, Settings->HelikaEnvironment, Settings->bPrintEventsToConsole};
+			OriginalVerbosity = LogHelika.GetVerbosity();
+			LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+			Settings->HelikaAPIKey = "TestAPIKey";
+			Settings->GameId = "PerfGameId";
+			Settings->HelikaEnvironment = EHelikaEnvironment::HE_Localhost;
+			Settings->bPrintEventsToConsole = false;
+
+			Manager = NewObject<UHelikaManager>();
+			Manager->InitializeSDK();
+		}
+
+		~FHelikaPerfScope()
+		{
+			Manager->DeinitializeSDK();
+
+			UHelikaSettings* Settings = UHelikaLibrary::GetHelikaSettings();
+			Settings->HelikaAPIKey = OriginalSettings.HelikaAPIKey;
+			Settings->GameId = OriginalSettings.GameId;
+			Settings->HelikaEnvironment = OriginalSettings.HelikaEnvironment;
+			Settings->bPrintEventsToConsole = OriginalSettings.bPrintEventsToConsole;
+			LogHelika.SetVerbosity(OriginalVerbosity);
+		}
+
+		UHelikaManager* Manager = nullptr;
+
+	private:
+		struct FSettings
+		{
+			FString HelikaAPIKey;
+			FString GameId;
+			EHelikaEnvironment HelikaEnvironment;
+			bool bPrintEventsToConsole;
+		};
+
+		FSettings OriginalSettings;
+		ELogVerbosity::Type OriginalVerbosity;
+	};
+
+	void GetEventCountTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands)
+	{
+		for (const TCHAR* NumEvents : {TEXT("1"), TEXT("100"), TEXT("10000")})
+		{
+			OutBeautifiedNames.Add(NumEvents);
+			OutTestCommands.Add(NumEvents);
+		}
+	}
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FHelikaPerfSendEventTest, "Helika.Perf.SendEvent", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FHelikaPerfSendEventTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	GetEventCountTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FHelikaPerfSendEventTest::RunTest(const FString& Parameters)
+{
+	const int32 NumEvents = FCString::Atoi(*Parameters);
+	FHelikaPerfScope Scope;
+	const TArray<TSharedPtr<FJsonObject>> Events = HelikaPerf::MakeEvents(NumEvents);
+
+	// Includes the flushes triggered by MaxBatchSize, the queue is drained after every run
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("SendEvent.") + Parameters, NumEvents, HelikaPerf::GetIterations(NumEvents), [&Scope, &Events]()
+	{
+		for (const TSharedPtr<FJsonObject>& Event : Events)
+		{
+			Scope.Manager->SendEvent(Event);
+		}
+		Scope.Manager->Flush();
+	});
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FHelikaPerfSendEventsTest, "Helika.Perf.SendEvents", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FHelikaPerfSendEventsTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	GetEventCountTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FHelikaPerfSendEventsTest::RunTest(const FString& Parameters)
+{
+	const int32 NumEvents = FCString::Atoi(*Parameters);
+	FHelikaPerfScope Scope;
+	const TArray<TSharedPtr<FJsonObject>> Events = HelikaPerf::MakeEvents(NumEvents);
+
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("SendEvents.") + Parameters, NumEvents, HelikaPerf::GetIterations(NumEvents), [&Scope, &Events]()
+	{
+		Scope.Manager->SendEvents(Events);
+		Scope.Manager->Flush();
+	});
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FHelikaPerfSendPrototypeEventTest, "Helika.Perf.SendPrototypeEvent", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FHelikaPerfSendPrototypeEventTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	GetEventCountTests(OutBeautifiedNames, OutTestCommands);
+}
+
+bool FHelikaPerfSendPrototypeEventTest::RunTest(const FString& Parameters)
+{
+	const int32 NumEvents = FCString::Atoi(*Parameters);
+	FHelikaPerfScope Scope;
+
+	// The fields of HelikaPerf::MakeEvent's detail, sent by handle
+	const FHelikaEventPrototype Prototype = Scope.Manager->RegisterEventPrototype(TEXT("gameplay"), TEXT("player_killed"), {TEXT("map"), TEXT("team"), TEXT("kills"), TEXT("damage"), TEXT("headshot")});
+	TArray<TArray<TSharedPtr<FJsonValue>>> Values;
+	Values.Reserve(NumEvents);
+	for (int32 Index = 0; Index < NumEvents; ++Index)
+	{
+		Values.Add({MakeShared<FJsonValueString>(TEXT("arctic")), MakeShared<FJsonValueString>(TEXT("counter-terrorists")), MakeShared<FJsonValueNumber>(Index % 30),
+			MakeShared<FJsonValueNumber>(12.5 * Index), MakeShared<FJsonValueBoolean>(Index % 3 == 0)});
+	}
+
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("SendPrototypeEvent.") + Parameters, NumEvents, HelikaPerf::GetIterations(NumEvents), [&Scope, &Prototype, &Values]()
+	{
+		for (const TArray<TSharedPtr<FJsonValue>>& EventValues : Values)
+		{
+			Scope.Manager->SendPrototypeEvent(Prototype, EventValues);
+		}
+		Scope.Manager->Flush();
+	});
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaPerfAppendAttributesTest, "Helika.Perf.AppendAttributesToJsonObject", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FHelikaPerfAppendAttributesTest::RunTest(const FString& Parameters)
+{
+	FHelikaPerfScope Scope;
+	const TSharedPtr<FJsonObject> Event = HelikaPerf::MakeEvent(0);
+	const TSharedPtr<const FHelikaConfigSnapshot, ESPMode::ThreadSafe> Snapshot = Scope.Manager->Config.Get();
+
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("AppendAttributesToJsonObject"), 1, 10000, [&Scope, &Event, &Snapshot]()
+	{
+		Scope.Manager->AppendAttributesToJsonObject(Event, true, *Snapshot->DefaultContext, *Snapshot);
+	});
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaPerfMergeJObjectsTest, "Helika.Perf.MergeJObjects", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FHelikaPerfMergeJObjectsTest::RunTest(const FString& Parameters)
+{
+	const TSharedPtr<FJsonObject> Defaults = MakeShareable(new FJsonObject());
+	Defaults->SetStringField("platform_id", "Linux");
+	Defaults->SetStringField("client_app_version", "1.0.0");
+	Defaults->SetStringField("server_app_version", "1.0.0");
+	Defaults->SetStringField("store_id", "EpicGames");
+	Defaults->SetStringField("source_id", "organic");
+
+	const TSharedPtr<FJsonObject> Target = MakeShareable(new FJsonObject());
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("MergeJObjects"), 1, 10000, [&Defaults, &Target]()
+	{
+		Target->Values.Reset();
+		Target->SetStringField("store_id", "Steam");
+		UHelikaJsonLibrary::MergeJObjects(Target, Defaults);
+	});
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaPerfConvertJsonObjectToStringTest, "Helika.Perf.ConvertJsonObjectToString", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FHelikaPerfConvertJsonObjectToStringTest::RunTest(const FString& Parameters)
+{
+	FHelikaJsonObject Event;
+	Event.Object = HelikaPerf::MakeEvent(0);
+
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("ConvertJsonObjectToString"), 1, 10000, [&Event]()
+	{
+		UHelikaJsonLibrary::ConvertJsonObjectToString(Event);
+	});
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaPerfConvertStringToJsonObjectTest, "Helika.Perf.ConvertStringToJsonObject", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FHelikaPerfConvertStringToJsonObjectTest::RunTest(const FString& Parameters)
+{
+	FHelikaJsonObject Event;
+	Event.Object = HelikaPerf::MakeEvent(0);
+	const FString Json = UHelikaJsonLibrary::ConvertJsonObjectToString(Event);
+
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("ConvertStringToJsonObject"), 1, 10000, [&Json]()
+	{
+		UHelikaJsonLibrary::ConvertStringToJsonObject(Json);
+	});
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaPerfComputeSha256HashTest, "Helika.Perf.ComputeSha256Hash", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FHelikaPerfComputeSha256HashTest::RunTest(const FString& Parameters)
+{
+	const FString Seed = FGuid::NewGuid().ToString();
+
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("ComputeSha256Hash"), 1, 10000, [&Seed]()
+	{
+		UHelikaLibrary::ComputeSha256Hash(Seed);
+	});
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FHelikaPerfHashBatchTest, "Helika.Perf.HashBatch", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FHelikaPerfHashBatchTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (uint8 Kernel = 0; Kernel < static_cast<uint8>(EHelikaSha256Kernel::Num); ++Kernel)
+	{
+		if (FHelikaSha256::IsSupported(static_cast<EHelikaSha256Kernel>(Kernel)))
+		{
+			OutBeautifiedNames.Add(FHelikaSha256::LexToString(static_cast<EHelikaSha256Kernel>(Kernel)));
+			OutTestCommands.Add(FString::FromInt(Kernel));
+		}
+	}
+	// Same players every batch, every value after the first batch is a cache hit
+	OutBeautifiedNames.Add(TEXT("Cached"));
+	OutTestCommands.Add(TEXT("Cached"));
+}
+
+bool FHelikaPerfHashBatchTest::RunTest(const FString& Parameters)
+{
+	const bool bCached = Parameters == TEXT("Cached");
+	if (!bCached && !TestTrue("Kernel is available", FHelikaSha256::SetKernel(static_cast<EHelikaSha256Kernel>(FCString::Atoi(*Parameters)))))
+	{
+		return false;
+	}
+
+	// Email, wallet and device id of 1000 players, salted like server side PII
+	TArray<FString> Values;
+	for (int32 Player = 0; Player < 1000; ++Player)
+	{
+		Values.Add(FString::Printf(TEXT("player.%d@example.com"), Player));
+		Values.Add(FString::Printf(TEXT("0x%040x"), Player * 2654435761u));
+		Values.Add(FGuid::NewGuid().ToString(EGuidFormats::DigitsWithHyphensLower));
+	}
+	TArray<FStringView> Views;
+	for (const FString& Value : Values)
+	{
+		Views.Add(Value);
+	}
+
+	FHelikaHasher Hasher(TEXT("PerfSalt"), bCached ? Values.Num() : 0);
+	TArray<ANSICHAR> Out;
+	Out.SetNumUninitialized(Values.Num() * FHelikaHasher::GetEncodedLength(EHelikaHashEncoding::HHE_Hex));
+	const FString Name = FString::Printf(TEXT("HashBatch.%s"), bCached ? TEXT("Cached") : FHelikaSha256::LexToString(FHelikaSha256::GetKernel()));
+	const FHelikaPerfResult Result = HelikaPerf::Measure(Name, Values.Num(), 200, [&Hasher, &Views, &Out]()
+	{
+		Hasher.HashBatch(Views, EHelikaHashEncoding::HHE_Hex, Out);
+	});
+	FHelikaSha256::ResetKernel();
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FHelikaPerfParallelSerializationTest, "Helika.Perf.ParallelSerialization", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FHelikaPerfParallelSerializationTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	// Tasks encoding the envelope, Serial is the calling thread alone and 0 every worker
+	for (const TCHAR* NumTasks : {TEXT("Serial"), TEXT("1"), TEXT("2"), TEXT("4"), TEXT("8"), TEXT("0")})
+	{
+		OutBeautifiedNames.Add(NumTasks);
+		OutTestCommands.Add(NumTasks);
+	}
+}
+
+bool FHelikaPerfParallelSerializationTest::RunTest(const FString& Parameters)
+{
+	// An end-of-match flush
+	const TArray<FHelikaQueuedEvent> Events = HelikaPerf::MakeQueuedEvents(5000);
+
+	FHelikaBatchLimits Limits;
+	Limits.MaxBatchBytes = 1ll << 30;
+	Limits.ParallelThreshold = Parameters == TEXT("Serial") ? 0 : 1;
+	Limits.MaxParallelTasks = FCString::Atoi(*Parameters);
+
+	FHelikaBatchSerializer Serializer;
+	TArray<uint8> Payload;
+	TArray<int32> Written;
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("ParallelSerialization.") + Parameters, Events.Num(), HelikaPerf::GetIterations(Events.Num()), [&Serializer, &Events, &Limits, &Payload, &Written]()
+	{
+		Payload.Reset();
+		Serializer.SerializeBudgeted(Events, Limits, Limits.MaxBatchBytes, Payload, Written);
+	});
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaPerfColumnarBatchTest, "Helika.Perf.ColumnarBatch", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FHelikaPerfColumnarBatchTest::RunTest(const FString& Parameters)
+{
+	const TArray<FHelikaQueuedEvent> Events = HelikaPerf::MakeQueuedEvents(5000);
+
+	FHelikaBatchLimits Limits;
+	Limits.MaxBatchBytes = 1ll << 30;
+	FHelikaBatchSerializer Serializer;
+	TArray<uint8> Payload;
+	TArray<int32> Written;
+	Serializer.SerializeBudgeted(Events, Limits, Limits.MaxBatchBytes, Payload, Written);
+
+	TArray<uint8> Columnar;
+	const FHelikaPerfResult Result = HelikaPerf::Measure(TEXT("ColumnarBatch"), Events.Num(), HelikaPerf::GetIterations(Events.Num()), [&Payload, &Columnar]()
+	{
+		FHelikaColumnarBatch::Encode(Payload, Columnar);
+	});
+
+	// Sizes before and after gzip, the reason to pay for the encoding
+	TArray<uint8> CompressedRows = Payload;
+	TArray<uint8> CompressedColumns = Columnar;
+	UHelikaLibrary::GzipCompress(CompressedRows);
+	UHelikaLibrary::GzipCompress(CompressedColumns);
+	AddInfo(FString::Printf(TEXT("Rows %d bytes (%d gzipped), columns %d bytes (%d gzipped)"), Payload.Num(), CompressedRows.Num(), Columnar.Num(), CompressedColumns.Num()));
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FHelikaPerfStringKernelsTest, "Helika.Perf.StringKernels", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FHelikaPerfStringKernelsTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (uint8 Set = 0; Set < static_cast<uint8>(EHelikaKernelSet::Num); ++Set)
+	{
+		if (FHelikaStringKernels::IsSupported(static_cast<EHelikaKernelSet>(Set)))
+		{
+			OutBeautifiedNames.Add(FHelikaStringKernels::LexToString(static_cast<EHelikaKernelSet>(Set)));
+			OutTestCommands.Add(FString::FromInt(Set));
+		}
+	}
+}
+
+bool FHelikaPerfStringKernelsTest::RunTest(const FString& Parameters)
+{
+	const EHelikaKernelSet KernelSet = static_cast<EHelikaKernelSet>(FCString::Atoi(*Parameters));
+	if (!TestTrue("Kernel set is available", FHelikaStringKernels::SetKernelSet(KernelSet)))
+	{
+		return false;
+	}
+
+	// The string values of a typical payload, one "event" per string
+	const TArray<FString> Values = {
+		FGuid::NewGuid().ToString(EGuidFormats::DigitsWithHyphensLower),
+		TEXT("arctic"),
+		TEXT("counter-terrorists"),
+		TEXT("0x71C7656EC7ab88b098defB751B7401B5f6d8976F"),
+		TEXT("2024-05-01T12:34:56.789Z"),
+		TEXT("\x041c\x043e\x0441\x043a\x0432\x0430 \x0441\x0435\x0440\x0432\x0435\x0440"),
+		TEXT("He said \"gg\"\n"),
+		FString::ChrN(1024, TEXT('x')),
+	};
+	TArray<uint8> Out;
+	const FHelikaPerfResult Result = HelikaPerf::Measure(FString::Printf(TEXT("StringKernels.%s"), FHelikaStringKernels::LexToString(KernelSet)), Values.Num(), 10000, [&Values, &Out]()
+	{
+		Out.Reset();
+		for (const FString& Value : Values)
+		{
+			FHelikaStringKernels::AppendEscapedUtf8(Out, Value);
+		}
+	});
+	FHelikaStringKernels::ResetKernelSet();
+
+	HelikaPerf::Report(*this, Result);
+	return true;
+}
+
+#endif
@@ -0,0 +1,85 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaDefines.h"
+#include "HelikaMetricsCounters.h"
+#include "HelikaScheduler.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaSchedulerTest, "Helika.HelikaSchedulerTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaSchedulerTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	FHelikaSchedulerConfig Config;
+	Config.BudgetMicroseconds = 100000;
+	Config.FrameTargetMs = 0.f;
+	Config.MaxDeferralSeconds = 60.f;
+	FHelikaScheduler Scheduler;
+	Scheduler.Configure(Config);
+	// SDK time spent before this test does not count against the first frame
+	Scheduler.Tick(0.0);
+
+	// Work runs in order, work that asks to continue runs again before anything scheduled after it
+	TArray<int32> Order;
+	int32 Remaining = 3;
+	Scheduler.Schedule([&Order]() { Order.Add(1); return true; });
+	Scheduler.Schedule([&Order, &Remaining]() { Order.Add(2); return --Remaining == 0; });
+	Scheduler.Schedule([&Order]() { Order.Add(3); return true; });
+	TestTrue("Budget is unlimited outside of Tick", Scheduler.HasBudget());
+	Scheduler.Tick(0.0);
+	TestEqual("Every item ran", Order, TArray<int32>({1, 2, 2, 2, 3}));
+	TestTrue("Nothing is left", Scheduler.IsEmpty());
+
+	// A frame over its target defers the work and counts it
+	Config.FrameTargetMs = 10.f;
+	Scheduler.Configure(Config);
+	Order.Reset();
+	Scheduler.Schedule([&Order]() { Order.Add(4); return true; });
+	const int64 DeferralsBefore = FHelikaMetricsCounters::Read().WorkDeferrals;
+	Scheduler.Tick(0.05);
+	TestEqual("Work waits while the frame is over its target", Order.Num(), 0);
+	TestEqual("The deferral is counted", FHelikaMetricsCounters::Read().WorkDeferrals - DeferralsBefore, 1ll);
+	Scheduler.Tick(0.005);
+	TestEqual("Work runs in a frame under its target", Order, TArray<int32>({4}));
+
+	// Work waiting for MaxDeferralSeconds runs even in a frame over its target
+	Config.MaxDeferralSeconds = 0.f;
+	Scheduler.Configure(Config);
+	Scheduler.Schedule([&Order]() { Order.Add(5); return true; });
+	Scheduler.Tick(0.05);
+	TestEqual("Overdue work makes progress", Order, TArray<int32>({4, 5}));
+
+	// Work checking the budget yields once it is spent, RunAll finishes everything
+	Config.BudgetMicroseconds = 0;
+	Config.FrameTargetMs = 0.f;
+	Scheduler.Configure(Config);
+	int32 Steps = 0;
+	Scheduler.Schedule([&Scheduler, &Steps]()
+	{
+		while (Steps < 10)
+		{
+			if (!Scheduler.HasBudget())
+			{
+				return false;
+			}
+			++Steps;
+		}
+		return true;
+	});
+	Scheduler.Schedule([&Order]() { Order.Add(6); return true; });
+	Scheduler.Tick(0.0);
+	TestTrue("A spent budget leaves work for later", Steps < 10 && !Scheduler.IsEmpty());
+	Scheduler.RunAll();
+	TestEqual("RunAll completes the work", Steps, 10);
+	TestEqual("RunAll runs everything", Order, TArray<int32>({4, 5, 6}));
+	TestTrue("Nothing is left after RunAll", Scheduler.IsEmpty());
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaDefines.h"
+#include "HelikaStringKernels.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	TArray<uint8> Escape(FStringView Value)
+	{
+		TArray<uint8> Out;
+		FHelikaStringKernels::AppendEscapedUtf8(Out, Value);
+		return Out;
+	}
+
+	TArray<uint8> ToBytes(const ANSICHAR* Utf8)
+	{
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Utf8), FCStringAnsi::Strlen(Utf8));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaStringKernelsTest, "Helika.HelikaStringKernelsTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaStringKernelsTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// The scalar kernels are the reference, checked against known encodings first
+	TestTrue("Scalar is always available", FHelikaStringKernels::SetKernelSet(EHelikaKernelSet::Scalar));
+	TestEqual("Plain ASCII is copied", Escape(TEXT("arctic_map-01")), ToBytes("arctic_map-01"));
+	TestEqual("Quotes and backslashes are escaped", Escape(TEXT("a\"b\\c")), ToBytes("a\\\"b\\\\c"));
+	TestEqual("Short escapes", Escape(TEXT("\b\f\n\r\t")), ToBytes("\\b\\f\\n\\r\\t"));
+	TestEqual("Other control characters", Escape(TEXT("\x01\x1f")), ToBytes("\\u0001\\u001f"));
+	TestEqual("Two byte characters", Escape(TEXT("\x00e9\x07ff")), ToBytes("\xc3\xa9\xdf\xbf"));
+	TestEqual("Three byte characters", Escape(TEXT("\x4e2d\xffff")), ToBytes("\xe4\xb8\xad\xef\xbf\xbf"));
+	TestEqual("Surrogate pairs are combined", Escape(TEXT("\xd83d\xde00")), ToBytes("\xf0\x9f\x98\x80"));
+	const TCHAR LoneSurrogates[] = {0xDE00, TEXT('a'), 0xD83D, 0};
+	TestEqual("Lone surrogates are replaced", Escape(LoneSurrogates), ToBytes("\xef\xbf\xbd" "a" "\xef\xbf\xbd"));
+
+	// Every other kernel set available here must produce the scalar bytes, appended after existing ones like in an envelope
+	TArray<EHelikaKernelSet> KernelSets;
+	for (uint8 Set = static_cast<uint8>(EHelikaKernelSet::Scalar) + 1; Set < static_cast<uint8>(EHelikaKernelSet::Num); ++Set)
+	{
+		if (FHelikaStringKernels::IsSupported(static_cast<EHelikaKernelSet>(Set)))
+		{
+			KernelSets.Add(static_cast<EHelikaKernelSet>(Set));
+		}
+		else
+		{
+			AddInfo(FString::Printf(TEXT("%s kernels are not available"), FHelikaStringKernels::LexToString(static_cast<EHelikaKernelSet>(Set))));
+		}
+	}
+	TArray<int32> NumMismatches;
+	NumMismatches.SetNumZeroed(KernelSets.Num());
+	TArray<uint8> Out;
+	const auto CheckCase = [&KernelSets, &NumMismatches, &Out](const FString& Case)
+	{
+		FHelikaStringKernels::SetKernelSet(EHelikaKernelSet::Scalar);
+		const TArray<uint8> Expected = Escape(Case);
+		for (int32 Index = 0; Index < KernelSets.Num(); ++Index)
+		{
+			FHelikaStringKernels::SetKernelSet(KernelSets[Index]);
+			Out.Reset();
+			Out.Add('x');
+			FHelikaStringKernels::AppendEscapedUtf8(Out, Case);
+			if (Out.Num() != Expected.Num() + 1 || FMemory::Memcmp(Out.GetData() + 1, Expected.GetData(), Expected.Num()) != 0)
+			{
+				++NumMismatches[Index];
+			}
+		}
+	};
+
+	// Every UTF-16 unit at every position of a block and across block edges, on ASCII, two and three byte backgrounds
+	for (const TCHAR Background : {TEXT('a'), static_cast<TCHAR>(0x00E9), static_cast<TCHAR>(0x4E2D)})
+	{
+		for (const int32 Position : {0, 1, 7, 8, 15, 16, 17, 31, 32, 39})
+		{
+			FString Case = FString::ChrN(40, Background);
+			for (uint32 Unit = 0; Unit < 0x10000; ++Unit)
+			{
+				Case[Position] = static_cast<TCHAR>(Unit);
+				CheckCase(Case);
+			}
+		}
+	}
+
+	// Random mixes of every class of unit
+	FRandomStream Random(47);
+	for (int32 Index = 0; Index < 20000; ++Index)
+	{
+		FString Case;
+		const int32 Length = Random.RandRange(0, 80);
+		for (int32 Unit = 0; Unit < Length; ++Unit)
+		{
+			switch (Random.RandRange(0, 4))
+			{
+			case 0: Case.AppendChar(static_cast<TCHAR>(Random.RandRange(1, 0x7F))); break;
+			case 1: Case.AppendChar(static_cast<TCHAR>(Random.RandRange(0x20, 0x7E))); break;
+			case 2: Case.AppendChar(static_cast<TCHAR>(Random.RandRange(0x80, 0x7FF))); break;
+			case 3: Case.AppendChar(static_cast<TCHAR>(Random.RandRange(0xD800, 0xDFFF))); break;
+			default: Case.AppendChar(static_cast<TCHAR>(Random.RandRange(1, 0xFFFF))); break;
+			}
+		}
+		CheckCase(Case);
+	}
+
+	// Long strings are encoded in segments, a surrogate pair may straddle two of them
+	FString Long = FString::ChrN(10000, TEXT('a'));
+	Long[4095] = 0xD83D;
+	Long[4096] = 0xDE00;
+	CheckCase(Long);
+	CheckCase(FString::ChrN(9000, TEXT('\x1f')));
+
+	for (int32 Index = 0; Index < KernelSets.Num(); ++Index)
+	{
+		TestEqual(FString::Printf(TEXT("%s matches the scalar kernels"), FHelikaStringKernels::LexToString(KernelSets[Index])), NumMismatches[Index], 0);
+	}
+
+	FHelikaStringKernels::ResetKernelSet();
+	TestTrue("Best kernels are picked again", FHelikaStringKernels::IsSupported(FHelikaStringKernels::GetKernelSet()));
+
+	LogHelika.SetVerbosity(OriginalVerbosity);
+	return true;
+}
+
+#endif
@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "HelikaConnectivity.h"
+#include "HelikaDefines.h"
+#include "HelikaLibrary.h"
+#include "HelikaManager.h"
+#include "HelikaScheduler.h"
+#include "HelikaSettings.h"
+#include "HelikaTransport.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHelikaTransportTest, "Helika.HelikaTransportTest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHelikaTransportTest::RunTest(const FString& Parameters)
+{
+	ELogVerbosity::Type OriginalVerbosity = LogHelika.GetVerbosity();
+	LogHelika.SetVerbosity(ELogVerbosity::NoLogging);
+
+	// Probes are HEAD requests, only an answer counts as reachable
+	FHelikaInMemoryTransport ProbeTransport;
+	TOptional<bool> bReached;
+	FHelikaConnectivity::SendProbe(ProbeTransport, TEXT("http://collector"), [&bReached](bool bReachedCollector) { bReached = bReachedCollector; });
+	TestEqual("Probe waits for its answer", ProbeTransport.GetNumPending(), 1);
+	TestEqual("Probe is a HEAD request", ProbeTransport.GetSent()[0].Verb, FString(TEXT("HEAD")));
+	ProbeTransport.SetHandler([](const FHelikaTransportRequest&) { return FHelikaTransportResponse(); });
+	ProbeTransport.AnswerPending();
+	TestTrue("Unanswered probe fails", bReached.IsSet() && !*bReached);
+
+	// Retry-After is delay seconds or an HTTP-date, anything else leaves the lane's backoff in charge
+	TestEqual("Retry-After seconds", IHelikaTransport::ParseRetryAfter(TEXT("120")), 120);
+	TestEqual("Retry-After past date", IHelikaTransport::ParseRetryAfter(TEXT("Wed, 21 Oct 2015 07:28:00 GMT")), 0);
+	TestTrue("Retry-After future date", IHelikaTransport::ParseRetryAfter((FDateTime::UtcNow() + FTimespan::FromMinutes(2)).ToHttpDate()) > 60);
+	TestEqual("Retry-After junk", IHelikaTransport::ParseRetryAfter(TEXT("soon")), 0);
+	TestEqual("Retry-After negative", IHelikaTransport::ParseRetryAfter(TEXT("-5")), 0);
+	TestEqual("Retry-After absent", IHelikaTransport::ParseRetryAfter(FString()), 0);
+
+	UHelikaSettings* Settings = UHelikaLibrary::GetHelikaSettings();
+	const EHelikaTransport OriginalTransport = Settings->Transport;
+	const ETelemetryLevel OriginalTelemetry = Settings->Telemetry;
+	const bool bOriginalUploadOnLocalhost = Settings->bUploadOnLocalhost;
+	const bool bOriginalPrintEventsToConsole = Settings->bPrintEventsToConsole;
+	Settings->HelikaAPIKey = "TestAPIKey";
+	Settings->GameId = "ValidGameId";
+	Settings->Transport = EHelikaTransport::HT_InMemory;
+	Settings->Telemetry = ETelemetryLevel::TL_TelemetryOnly;
+	Settings->bUploadOnLocalhost = true;
+	Settings->bPrintEventsToConsole = false;
+
+	UHelikaManager* HelikaManager = NewObject<UHelikaManager>();
+	HelikaManager->InitializeSDK();
+	TestEqual("Transport follows the settings", FString(HelikaManager->Transport->GetName()), FString(TEXT("InMemory")));
+	FHelikaInMemoryTransport& Transport = static_cast<FHelikaInMemoryTransport&>(HelikaManager->Transport->GetInner());
+
+	// The session event is uploaded through the selected transport, nothing leaves the process
+	const FHelikaMetrics Before = HelikaManager->GetMetrics();
+	HelikaManager->Scheduler->RunAll();
+	HelikaManager->Flush();
+	const TArray<FHelikaTransportRequest> Sent = Transport.GetSent();
+	TestTrue("Upload is sent", Sent.Num() > 0);
+	if (Sent.Num() > 0)
+	{
+		TestTrue("Upload goes to the events endpoint", Sent.Last().Url.EndsWith(TEXT("/events/")));
+		TestTrue("Upload carries the API key", Sent.Last().FindHeader(TEXT("x-api-key")) != nullptr && *Sent.Last().FindHeader(TEXT("x-api-key")) == TEXT("TestAPIKey"));
+		TestTrue("Upload carries the batch", Sent.Last().Body.Num() > 0);
+	}
+
+	const int32 NumAnswered = Transport.AnswerPending();
+	TestEqual("Answered uploads succeed", HelikaManager->GetMetrics().RequestsSucceeded - Before.RequestsSucceeded, static_cast<int64>(NumAnswered));
+	TestEqual("Nothing is in flight once answered", HelikaManager->GetMetrics().BytesInFlight, Before.BytesInFlight);
+
+	// An unanswered upload counts as failed
+	Transport.SetHandler([](const FHelikaTransportRequest&) { return FHelikaTransportResponse(); });
+	HelikaManager->SendEvent(MakeShareable(new FJsonObject()), EHelikaPriority::HP_Critical);
+	HelikaManager->Flush();
+	const FHelikaMetrics BeforeFailure = HelikaManager->GetMetrics();
+	Transport.AnswerPending();
+	TestTrue("Unanswered upload fails", HelikaManager->GetMetrics().RequestsFailed > BeforeFailure.RequestsFailed);
+
+	// Changing the setting swaps the transport, uploads in flight on the old one still complete on it
+	Transport.SetHandler(nullptr);
+	HelikaManager->SendEvent(MakeShareable(new FJsonObject()), EHelikaPriority::HP_Critical);
+	HelikaManager->Flush();
+	const TSharedRef<FHelikaTrackedTransport, ESPMode::ThreadSafe> Replaced = HelikaManager->Transport.ToSharedRef();
+	const FHelikaMetrics BeforeSwap = HelikaManager->GetMetrics();
+	Settings->Transport = EHelikaTransport::HT_HttpModule;
+	Settings->OnSettingsChanged.Broadcast();
+	TestEqual("Transport is replaced", FString(HelikaManager->Transport->GetName()), FString(TEXT("HttpModule")));
+	TestEqual("Replaced transport is kept while busy", HelikaManager->RetiredTransports.Num(), 1);
+	TestTrue("Upload in flight is not failed by the swap", HelikaManager->GetMetrics().RequestsFailed == BeforeSwap.RequestsFailed && !Replaced->IsIdle());
+	HelikaManager->HandleSchedulerTick(0.f);
+	TestTrue("Upload in flight completes on the replaced transport", HelikaManager->GetMetrics().RequestsSucceeded > BeforeSwap.RequestsSucceeded);
+	TestEqual("Replaced transport is released once idle", HelikaManager->RetiredTransports.Num(), 0);
+	Settings->Transport = EHelikaTransport::HT_InMemory;
+	Settings->OnSettingsChanged.Broadcast();
+
+	HelikaManager->DeinitializeSDK();
+	Settings->Transport = OriginalTransport;
+	Settings->Telemetry = OriginalTelemetry;
+	Settings->bUploadOnLocalhost = bOriginalUploadOnLocalhost;
+	Settings->bPrintEventsToConsole = bOriginalPrintEventsToConsole;
+	LogHelika.SetVerbosity(OriginalVerbosity);
+
+	return true;
+}
+
+#endif
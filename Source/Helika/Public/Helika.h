@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Ticker.h"
 #include "Modules/ModuleManager.h"
 
 class UHelikaSubsystem;
@@ -36,4 +37,7 @@ public:
 protected:
     /// Module Settings : will be editable in Unreal Editor and saved in DefaultEngine.ini
     UHelikaSettings* ModuleSettings = nullptr;
+
+    /// Refreshes 'stat Helika' every frame in builds with stats enabled
+    FTSTicker::FDelegateHandle StatsTickerHandle;
 };
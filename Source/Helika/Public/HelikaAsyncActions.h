@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaJsonLibrary.h"
+#include "HelikaTypes.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "HelikaAsyncActions.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FHelikaDeliveryPin, EHelikaDeliveryResult, Result);
+
+/**
+ * Latent 'Send Helika Event Async' node. The event goes through the same lanes and batches as SendEvent,
+ * the node only waits for the outcome of its event instead of issuing its own request.
+ */
+UCLASS()
+class HELIKA_API UHelikaSendEventAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/// Fires once the event is queued for upload, with HD_Queued
+	UPROPERTY(BlueprintAssignable)
+	FHelikaDeliveryPin OnQueued;
+
+	/// Fires once the collector stored the event
+	UPROPERTY(BlueprintAssignable)
+	FHelikaDeliveryPin OnDelivered;
+
+	/// Fires when the event was refused, sampled out, shed, ran out of retries or was spilled to disk, Result tells which
+	UPROPERTY(BlueprintAssignable)
+	FHelikaDeliveryPin OnFailed;
+
+	/// @param bIsUserEvent send it like SendUserEvent, with the user id of the user details
+	UFUNCTION(BlueprintCallable, Category="Helika|Events", meta=(BlueprintInternalUseOnly="true", WorldContext="WorldContextObject", DisplayName="Send Helika Event Async"))
+	static UHelikaSendEventAsyncAction* SendHelikaEventAsync(UObject* WorldContextObject, const FHelikaJsonObject& EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal, bool bIsUserEvent = false);
+
+	virtual void Activate() override;
+
+private:
+	void HandleSettled(EHelikaDeliveryResult Result);
+
+	FHelikaJsonObject EventProps;
+	EHelikaPriority Priority = EHelikaPriority::HP_Normal;
+	bool bIsUserEvent = false;
+};
+
+/**
+ * Latent 'Flush Helika Async' node. Uploads every queued event now and waits for the acknowledgement of the uploads it started.
+ */
+UCLASS()
+class HELIKA_API UHelikaFlushAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+	/// Fires once every batch of the flush was stored by the collector, or right away when nothing was queued
+	UPROPERTY(BlueprintAssignable)
+	FHelikaDeliveryPin OnDelivered;
+
+	/// Fires when any batch of the flush was not fully stored, Result is the first failure
+	UPROPERTY(BlueprintAssignable)
+	FHelikaDeliveryPin OnFailed;
+
+	UFUNCTION(BlueprintCallable, Category="Helika|Events", meta=(BlueprintInternalUseOnly="true", WorldContext="WorldContextObject", DisplayName="Flush Helika Async"))
+	static UHelikaFlushAsyncAction* FlushHelikaAsync(UObject* WorldContextObject);
+
+	virtual void Activate() override;
+
+private:
+	void HandleSettled(EHelikaDeliveryResult Result);
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Holds the latest version of an immutable, reference counted object.
+ *
+ * Readers never take a lock: they pin the current slot with an atomic counter just long enough
+ * to copy the shared pointer. Writers are serialized and publish into the other slot before
+ * flipping the index, so a published object is never modified and stays alive while referenced.
+ */
+template<typename T>
+class THelikaAtomicSnapshot
+{
+public:
+	typedef TSharedPtr<const T, ESPMode::ThreadSafe> FSnapshotPtr;
+
+	THelikaAtomicSnapshot() = default;
+	THelikaAtomicSnapshot(const THelikaAtomicSnapshot&) = delete;
+	THelikaAtomicSnapshot& operator=(const THelikaAtomicSnapshot&) = delete;
+
+	/// Returns the latest published snapshot, may be null before the first Publish
+	FSnapshotPtr Get() const
+	{
+		for (;;)
+		{
+			const int32 Index = CurrentIndex.load();
+			Readers[Index].fetch_add(1);
+			// A publish may have started reusing this slot between the two loads, retry on the new one
+			if (CurrentIndex.load() == Index)
+			{
+				FSnapshotPtr Snapshot = Slots[Index];
+				Readers[Index].fetch_sub(1);
+				return Snapshot;
+			}
+			Readers[Index].fetch_sub(1);
+		}
+	}
+
+	/// Makes NewSnapshot visible to every subsequent Get
+	void Publish(FSnapshotPtr NewSnapshot)
+	{
+		FScopeLock Lock(&WriterLock);
+		const int32 NextIndex = 1 - CurrentIndex.load();
+
+		// Readers still copying the previous-but-one snapshot finish in a few instructions
+		while (Readers[NextIndex].load() != 0)
+		{
+			FPlatformProcess::Sleep(0.0f);
+		}
+
+		Slots[NextIndex] = MoveTemp(NewSnapshot);
+		CurrentIndex.store(NextIndex);
+	}
+
+private:
+	FSnapshotPtr Slots[2];
+	mutable std::atomic<int32> Readers[2] = {0, 0};
+	std::atomic<int32> CurrentIndex = 0;
+	FCriticalSection WriterLock;
+};
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaContext.generated.h"
+
+/**
+ * Lightweight handle to a per-player context (user details, session id and match metadata).
+ * Contexts are owned by UHelikaManager, create one when a player joins and destroy it when they leave.
+ */
+USTRUCT(BlueprintType)
+struct HELIKA_API FHelikaContext
+{
+	GENERATED_BODY()
+
+	FHelikaContext() = default;
+	explicit FHelikaContext(int32 InId) : Id(InId) {}
+
+	bool IsValid() const { return Id != INDEX_NONE; }
+
+	int32 GetId() const { return Id; }
+
+	bool operator==(const FHelikaContext& Other) const { return Id == Other.Id; }
+	bool operator!=(const FHelikaContext& Other) const { return Id != Other.Id; }
+
+	friend uint32 GetTypeHash(const FHelikaContext& Context) { return ::GetTypeHash(Context.Id); }
+
+private:
+	UPROPERTY()
+	int32 Id = INDEX_NONE;
+};
@@ -1,10 +1,14 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
-// Defining custom Log category for Helika module
-DECLARE_LOG_CATEGORY_EXTERN(LogHelika, Log, All);
-
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// Defining custom Log category for Helika module
+DECLARE_LOG_CATEGORY_EXTERN(LogHelika, Log, All);
+
+// Pipeline health counters, shown with 'stat Helika'
+DECLARE_STATS_GROUP(TEXT("Helika"), STATGROUP_Helika, STATCAT_Advanced);
+
 // Add include statement for modules that are used in most of the module's source files
\ No newline at end of file
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaEventPrototype.generated.h"
+
+/**
+ * Lightweight handle to an event type registered at runtime with UHelikaManager::RegisterEventPrototype.
+ * The event type, sub type and field names are encoded once, sends by handle only carry the field values.
+ */
+USTRUCT(BlueprintType)
+struct HELIKA_API FHelikaEventPrototype
+{
+	GENERATED_BODY()
+
+	FHelikaEventPrototype() = default;
+	explicit FHelikaEventPrototype(int32 InId) : Id(InId) {}
+
+	bool IsValid() const { return Id != INDEX_NONE; }
+
+	int32 GetId() const { return Id; }
+
+	bool operator==(const FHelikaEventPrototype& Other) const { return Id == Other.Id; }
+	bool operator!=(const FHelikaEventPrototype& Other) const { return Id != Other.Id; }
+
+	friend uint32 GetTypeHash(const FHelikaEventPrototype& Prototype) { return ::GetTypeHash(Prototype.Id); }
+
+private:
+	UPROPERTY()
+	int32 Id = INDEX_NONE;
+};
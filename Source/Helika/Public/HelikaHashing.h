@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaHashing.generated.h"
+
+/// Text form of a SHA-256 digest
+UENUM(BlueprintType)
+enum class EHelikaHashEncoding : uint8
+{
+	/// 64 lowercase hex characters, what UHelikaLibrary::ComputeSha256Hash returns
+	HHE_Hex UMETA(DisplayName = "Hex"),
+	/// 44 characters of standard padded base64
+	HHE_Base64 UMETA(DisplayName = "Base64")
+};
+
+/**
+ * SHA-256 of identifiers and PII fields (emails, wallets, device ids) in batches.
+ *
+ * Values are hashed as UTF-8. The batch is padded up front and handed to the fastest compression kernel of the CPU:
+ * the x86 SHA extensions, eight messages side by side in AVX2 registers, or OpenSSL.
+ * With a salt the digest is HMAC-SHA256 keyed by the salt, the keyed states are computed once per hasher.
+ * With a cache the digests of the most recently hashed values are kept, repeated identifiers skip the hashing entirely.
+ *
+ * Not thread safe, servers hashing on several threads use one hasher per thread.
+ */
+class HELIKA_API FHelikaHasher
+{
+public:
+	/// An empty Salt gives plain SHA-256, CacheCapacity 0 disables the cache
+	explicit FHelikaHasher(const FString& Salt = FString(), int32 CacheCapacity = 0);
+
+	/// Characters written per value
+	static int32 GetEncodedLength(EHelikaHashEncoding Encoding);
+
+	/// Writes the digests of Values back to back into Out, GetEncodedLength(Encoding) characters each and no terminators.
+	/// Out must hold Values.Num() * GetEncodedLength(Encoding) characters.
+	void HashBatch(TConstArrayView<FStringView> Values, EHelikaHashEncoding Encoding, TArrayView<ANSICHAR> Out);
+
+	void HashBatch(const TArray<FString>& Values, EHelikaHashEncoding Encoding, TArray<FString>& OutHashes);
+
+	FString Hash(FStringView Value, EHelikaHashEncoding Encoding = EHelikaHashEncoding::HHE_Hex);
+
+	bool IsSalted() const { return bSalted; }
+
+	/// Values answered from the cache since the hasher was created
+	int64 GetCacheHits() const { return CacheHits; }
+
+	int32 GetCacheNum() const { return CacheIndex.Num(); }
+
+private:
+	/// Digests of up to MaxChunkValues values, into Digests (32 bytes per value)
+	void HashChunk(TConstArrayView<FStringView> Values, uint8* Digests);
+
+	bool FindCached(const FString& Value, uint8* OutDigest);
+	void AddCached(FString&& Value, const uint8* Digest);
+	void Unlink(int32 Entry);
+	void LinkFront(int32 Entry);
+
+	struct FCaseSensitiveKeyFuncs : TDefaultMapKeyFuncs<FString, int32, false>
+	{
+		static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+		static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+	};
+
+	struct FCacheEntry
+	{
+		FString Value;
+		uint8 Digest[32];
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+	};
+
+	bool bSalted = false;
+	/// States after the inner and outer HMAC key blocks
+	uint32 InnerState[8];
+	uint32 OuterState[8];
+
+	int32 CacheCapacity = 0;
+	int64 CacheHits = 0;
+	/// Least recently used list over CacheEntries, Head is the most recent
+	TArray<FCacheEntry> CacheEntries;
+	TMap<FString, int32, FDefaultSetAllocator, FCaseSensitiveKeyFuncs> CacheIndex;
+	int32 Head = INDEX_NONE;
+	int32 Tail = INDEX_NONE;
+
+	/// Reused between batches
+	TArray<uint8> Padded;
+	TArray<int32> Offsets;
+	TArray<uint32> States;
+	TArray<FString> Misses;
+	TArray<int32> MissSlots;
+};
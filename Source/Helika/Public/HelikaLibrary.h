@@ -1,70 +1,79 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "HelikaTypes.h"
-#include "Kismet/BlueprintFunctionLibrary.h"
-#include "HelikaLibrary.generated.h"
-
-enum class EHelikaEnvironment : uint8;
-class UHelikaSettings;
-/**
- * Useful methods that are independent and static
- */
-UCLASS()
-class HELIKA_API UHelikaLibrary : public UBlueprintFunctionLibrary
-{
-	GENERATED_BODY()
-
-public:
-	UFUNCTION(BlueprintPure, Category = "Helika|Common")
-	static UHelikaSettings* GetHelikaSettings();
-
-	static FString ConvertUrl(const EHelikaEnvironment InHelikaEnvironment);
-
-	static FString CreateNewGuid();
-
-	// Get Current Platform name (Windows, Mac, Android, IOS, Linux, etc.) return in FString
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
-	static FString GetPlatformName();
-
-	// Get Current Platform type (Windows, Mac, Android, IOS, Linux, etc.) return as enum
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
-	static EPlatformType GetPlatformType();
-
-	// Get the device unique identifier
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
-	static FString GetDeviceUniqueIdentifier();
-
-	// Get the device type (Desktop, Mobile, Console, etc.)
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
-	static FString GetDeviceType();
-	
-	// Get the device processor name
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
-	static FString GetDeviceProcessor();
-
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
-	static int64 GetUnixTimeLong();
-
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
-	static FString GetOSVersion();
-	
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
-	static FString GetLocalIpAddress();
-
-	static TSharedPtr<FJsonObject> GetDeviceIDs();
-
-public:
-
-	static void AddIfNull(const TSharedPtr<FJsonObject>& HelikaEvent, const FString& Key, const FString& NewValue);
-	static void AddIfNull(const TSharedPtr<FJsonObject>& HelikaEvent, const FString& Key, const TSharedPtr<FJsonObject>& NewValue);
-	static void AddOrReplace(const TSharedPtr<FJsonObject>& HelikaEvent, const FString& Key, const FString& NewValue);
-	static void AddOrReplace(const TSharedPtr<FJsonObject>& HelikaEvent, const FString& Key, const TSharedPtr<FJsonObject>& NewValue);
-
-	static FString GetIdfv();
-	static FString GetIdfa();
-	static FString GetAndroidAdID();
-	static FString ComputeSha256Hash(const FString& RawData);
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaHashing.h"
+#include "HelikaTypes.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "HelikaLibrary.generated.h"
+
+enum class EHelikaEnvironment : uint8;
+class UHelikaSettings;
+/**
+ * Useful methods that are independent and static
+ */
+UCLASS()
+class HELIKA_API UHelikaLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	UFUNCTION(BlueprintPure, Category = "Helika|Common")
+	static UHelikaSettings* GetHelikaSettings();
+
+	static FString ConvertUrl(const EHelikaEnvironment InHelikaEnvironment);
+
+	static FString CreateNewGuid();
+
+	// Get Current Platform name (Windows, Mac, Android, IOS, Linux, etc.) return in FString
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
+	static FString GetPlatformName();
+
+	// Get Current Platform type (Windows, Mac, Android, IOS, Linux, etc.) return as enum
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
+	static EPlatformType GetPlatformType();
+
+	// Get the device unique identifier
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
+	static FString GetDeviceUniqueIdentifier();
+
+	// Get the device type (Desktop, Mobile, Console, etc.)
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
+	static FString GetDeviceType();
+	
+	// Get the device processor name
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
+	static FString GetDeviceProcessor();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
+	static int64 GetUnixTimeLong();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
+	static FString GetOSVersion();
+	
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
+	static FString GetLocalIpAddress();
+
+	static TSharedPtr<FJsonObject> GetDeviceIDs();
+
+public:
+
+	static void AddIfNull(const TSharedPtr<FJsonObject>& HelikaEvent, const FString& Key, const FString& NewValue);
+	static void AddIfNull(const TSharedPtr<FJsonObject>& HelikaEvent, const FString& Key, const TSharedPtr<FJsonObject>& NewValue);
+	static void AddOrReplace(const TSharedPtr<FJsonObject>& HelikaEvent, const FString& Key, const FString& NewValue);
+	static void AddOrReplace(const TSharedPtr<FJsonObject>& HelikaEvent, const FString& Key, const TSharedPtr<FJsonObject>& NewValue);
+
+	static FString GetIdfv();
+	static FString GetIdfa();
+	static FString GetAndroidAdID();
+	static FString ComputeSha256Hash(const FString& RawData);
+
+	/// SHA-256 of every value in one batch, HMAC-SHA256 keyed by Salt when it is not empty.
+	/// Servers hashing many values with a cache for repeated ones use FHelikaHasher directly.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Helika|Common")
+	static TArray<FString> ComputeSha256Hashes(const TArray<FString>& Values, const FString& Salt, EHelikaHashEncoding Encoding = EHelikaHashEncoding::HHE_Hex);
+
+	/// Gzips Payload in place, leaves it untouched and returns false if compression fails or does not shrink it
+	static bool GzipCompress(TArray<uint8>& Payload);
+};
@@ -1,127 +1,353 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "HelikaJsonLibrary.h"
-#include "HelikaTypes.h"
-#include "HelikaManager.generated.h"
-
-struct FHelikaJsonValue;
-struct FHelikaJsonObject;
-/**
- * 
- */
-UCLASS(BlueprintType)
-class HELIKA_API UHelikaManager : public UObject
-{
-	GENERATED_BODY()
-
-private:
-
-	UHelikaManager():AppDetails(MakeShareable(new FJsonObject())), UserDetails(MakeShareable(new FJsonObject()))
-	{
-	    AppDetails->SetStringField("platform_id", TEXT(""));
-	    AppDetails->SetStringField("client_app_version", TEXT(""));
-	    AppDetails->SetStringField("server_app_version", TEXT(""));
-	    AppDetails->SetStringField("store_id", TEXT(""));
-	    AppDetails->SetStringField("source_id", TEXT(""));
-
-	    UserDetails->SetStringField("user_id", TEXT(""));
-	    UserDetails->SetStringField("email", TEXT(""));
-	    UserDetails->SetStringField("wallet", TEXT(""));
-	};
-
-	static UHelikaManager* Instance;
-
-public:
-	static inline UHelikaManager* Get()
-	{
-		if(!Instance)
-		{
-			Instance = NewObject<UHelikaManager>();
-			Instance->AddToRoot();
-		}
-		return Instance;
-	}
-
-	UFUNCTION(BlueprintCallable, Category = "Helika")
-	void InitializeSDK();
-	UFUNCTION(BlueprintCallable, Category = "Helika")
-	void DeinitializeSDK();
-
-	UFUNCTION(BlueprintCallable, Category="Helika|Events")
-	void SendEvent(const FHelikaJsonObject& EventProps);
-	UFUNCTION(BlueprintCallable, Category="Helika|Events")
-	void SendEvents(TArray<FHelikaJsonObject> EventProps); 
-
-	UFUNCTION(BlueprintCallable, Category="Helika|Events")
-	void SendUserEvent(const FHelikaJsonObject& EventProps);
-	UFUNCTION(BlueprintCallable, Category="Helika|Events")
-	void SendUserEvents(TArray<FHelikaJsonObject> EventProps);
-
-	
-	bool SendEvent(TSharedPtr<FJsonObject> EventProps);
-	bool SendEvents(TArray<TSharedPtr<FJsonObject>> EventProps);
-	
-	bool SendUserEvent(TSharedPtr<FJsonObject> EventProps);    
-	bool SendUserEvents(TArray<TSharedPtr<FJsonObject>> EventProps);
-
-	// Set weather to print events to console or not
-	UFUNCTION(BlueprintCallable, Category="Helika")
-	void SetPrintToConsole(bool bInPrintEventsToConsole);
-
-	UFUNCTION(BlueprintCallable, Category = "Helika")
-	bool IsSDKInitialized();
-
-	UFUNCTION(BlueprintCallable, Category = "Helika")
-	FString GetSessionId() const;
-
-	TSharedPtr<FJsonObject> GetUserDetails();
-	void SetUserDetails(TSharedPtr<FJsonObject> InUserDetails, bool bCreateNewAnonId = false);
-
-	UFUNCTION(BlueprintPure, Category="Helika")
-	FHelikaJsonObject GetUserDetailsAsJson();
-	UFUNCTION(BlueprintCallable, Category="Helika")
-	void SetUserDetails(const FHelikaJsonObject& InUserDetails, bool bCreateNewAnonId = false);
-
-	TSharedPtr<FJsonObject> GetAppDetails();
-	void SetAppDetails(const TSharedPtr<FJsonObject>& InAppDetails);
-
-	UFUNCTION(BlueprintPure, Category="Helika")
-	FHelikaJsonObject GetAppDetailsAsJson();
-	UFUNCTION(BlueprintCallable, Category="Helika")
-	void SetAppDetails(const FHelikaJsonObject& InAppDetails);
-
-	UFUNCTION(BlueprintPure, Category="Helika")
-	bool GetPIITracking() const;
-	UFUNCTION(BlueprintCallable, Category="Helika")
-	void SetPIITracking(bool bInPiiTracking, bool bSendPiiTrackingEvent = false);
-	
-protected:
-	FString BaseUrl;
-	FString SessionId;
-	ETelemetryLevel Telemetry = ETelemetryLevel::TL_None;
-	bool bIsInitialized = false;
-
-	bool bPiiTracking = false;
-	FString AnonymousId;
-
-	TSharedPtr<FJsonObject> AppDetails;
-	TSharedPtr<FJsonObject> UserDetails;
-
-private:
-	TSharedPtr<FJsonObject> AppendAttributesToJsonObject(TSharedPtr<FJsonObject> JsonObject, bool bIsUserEvent);
-	void CreateSession();
-	void SendHTTPPost(const FString& Url, const FString& Data) const;
-	static void ProcessEventTrackResponse(const FString& Data);
-	static void EndSession(bool bIsSimulating);
-
-	FString GenerateAnonymousId(FString Seed, bool bCreateNewAnonId = false);
-
-	TSharedPtr<FJsonObject> GetTemplateEvent(const FString& EventType, const FString& EventSubType) const;
-	void AppendHelikaData(const TSharedPtr<FJsonObject>& GameEvent) const;
-	void AppendUserDetails(const TSharedPtr<FJsonObject>& GameEvent) const;
-	void AppendAppDetails(const TSharedPtr<FJsonObject>& GameEvent) const;
-	void AppendPIITracking(const TSharedPtr<FJsonObject>& GameEvent);
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "HelikaAtomicSnapshot.h"
+#include "HelikaContext.h"
+#include "HelikaEventPrototype.h"
+#include "HelikaJsonLibrary.h"
+#include "HelikaMemory.h"
+#include "HelikaMetrics.h"
+#include "HelikaTypes.h"
+#include "HelikaManager.generated.h"
+
+struct FHelikaJsonValue;
+struct FHelikaJsonObject;
+struct FHelikaContextData;
+struct FHelikaConfigSnapshot;
+class FHelikaEventTemplate;
+enum class EHelikaRecordedSend : uint8;
+class FHelikaLane;
+class FHelikaConnectivity;
+class FHelikaSpillStore;
+class FHelikaScheduler;
+class FHelikaDelivery;
+class IHelikaTransport;
+class FHelikaTrackedTransport;
+struct FHelikaSpilledBatch;
+struct FHelikaQueuedEvent;
+struct FHelikaTransportResponse;
+class FHelikaPerfAppendAttributesTest;
+class FHelikaLaneTest;
+class FHelikaTransportTest;
+/**
+ * 
+ */
+UCLASS(BlueprintType)
+class HELIKA_API UHelikaManager : public UObject
+{
+	GENERATED_BODY()
+
+	// Benchmarks the private enrichment step
+	friend class FHelikaPerfAppendAttributesTest;
+	// Ticks the scheduler without a frame
+	friend class FHelikaLaneTest;
+	// Answers the uploads of the in-memory transport
+	friend class FHelikaTransportTest;
+
+private:
+
+	UHelikaManager():AppDetails(MakeShareable(new FJsonObject())), UserDetails(MakeShareable(new FJsonObject()))
+	{
+	    AppDetails->SetStringField("platform_id", TEXT(""));
+	    AppDetails->SetStringField("client_app_version", TEXT(""));
+	    AppDetails->SetStringField("server_app_version", TEXT(""));
+	    AppDetails->SetStringField("store_id", TEXT(""));
+	    AppDetails->SetStringField("source_id", TEXT(""));
+
+	    UserDetails->SetStringField("user_id", TEXT(""));
+	    UserDetails->SetStringField("email", TEXT(""));
+	    UserDetails->SetStringField("wallet", TEXT(""));
+	};
+
+	static UHelikaManager* Instance;
+
+public:
+	static inline UHelikaManager* Get()
+	{
+		if(!Instance)
+		{
+			Instance = NewObject<UHelikaManager>();
+			Instance->AddToRoot();
+		}
+		return Instance;
+	}
+
+	virtual void BeginDestroy() override;
+
+	UFUNCTION(BlueprintCallable, Category = "Helika")
+	void InitializeSDK();
+	UFUNCTION(BlueprintCallable, Category = "Helika")
+	void DeinitializeSDK();
+
+	/// Priority picks the upload lane, Normal events may be moved to another lane by UHelikaSettings::EventTypePriorities
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void SendEvent(const FHelikaJsonObject& EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void SendEvents(TArray<FHelikaJsonObject> EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal); 
+
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void SendUserEvent(const FHelikaJsonObject& EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void SendUserEvents(TArray<FHelikaJsonObject> EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+
+	
+	bool SendEvent(TSharedPtr<FJsonObject> EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	bool SendEvents(TArray<TSharedPtr<FJsonObject>> EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	
+	bool SendUserEvent(TSharedPtr<FJsonObject> EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);    
+	bool SendUserEvents(TArray<TSharedPtr<FJsonObject>> EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+
+	/// Sends the event like SendEvent or SendUserEvent and settles Delivery once it is stored by the collector or leaves the pipeline otherwise.
+	/// Backs the 'Send Helika Event Async' node. Returns whether the event was queued, Delivery is already settled otherwise.
+	bool SendTrackedEvent(TSharedPtr<FJsonObject> EventProps, EHelikaPriority Priority, bool bIsUserEvent, const TSharedPtr<FHelikaDelivery, ESPMode::ThreadSafe>& Delivery);
+
+	/// Uploads every queued event of every lane now, even a lane backing off, instead of waiting for the next flush interval.
+	/// Deferred SDK work (e.g. session events) runs first, regardless of GameThreadBudgetMicroseconds.
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void Flush();
+	/// Flush that settles Delivery once every upload it started is acknowledged. Backs the 'Flush Helika Async' node.
+	void Flush(const TSharedPtr<FHelikaDelivery, ESPMode::ThreadSafe>& Delivery);
+
+	/// Records every event accepted from now on to a binary trace for the HelikaReplay commandlet, replacing a running recording.
+	/// Starting the game with -HelikaRecord=<file> records from InitializeSDK on, except in Shipping builds.
+	UFUNCTION(BlueprintCallable, Category="Helika|Recording")
+	bool StartEventRecording(const FString& FilePath);
+	UFUNCTION(BlueprintCallable, Category="Helika|Recording")
+	void StopEventRecording();
+
+	/// Whether uploads are running, held because the collector is unreachable, or draining the backlog
+	UFUNCTION(BlueprintPure, Category="Helika|Connectivity")
+	EHelikaConnectivity GetConnectivityState() const;
+
+	/// Creates a player context with its own user details, session id and match metadata.
+	/// Events sent through a context share the batching pipeline with every other context.
+	/// 
+	/// @param InUserDetails user details of the player, an anonymous user id is generated if 'user_id' is missing
+	/// @param InMatchMetadata optional match information appended to every event of the context
+	/// @return handle to the context, invalid if the SDK is not initialized
+	UFUNCTION(BlueprintCallable, Category="Helika|Context")
+	FHelikaContext CreateContext(const FHelikaJsonObject& InUserDetails, const FHelikaJsonObject& InMatchMetadata);
+	FHelikaContext CreateContext(TSharedPtr<FJsonObject> InUserDetails, TSharedPtr<FJsonObject> InMatchMetadata = nullptr);
+
+	/// Releases the context, events already queued for it are still sent
+	UFUNCTION(BlueprintCallable, Category="Helika|Context")
+	void DestroyContext(FHelikaContext Context);
+
+	UFUNCTION(BlueprintPure, Category="Helika|Context")
+	bool IsContextValid(FHelikaContext Context) const;
+
+	UFUNCTION(BlueprintPure, Category="Helika|Context")
+	FString GetContextSessionId(FHelikaContext Context) const;
+
+	UFUNCTION(BlueprintCallable, Category="Helika|Context")
+	void SetContextUserDetails(FHelikaContext Context, const FHelikaJsonObject& InUserDetails);
+	void SetContextUserDetails(FHelikaContext Context, TSharedPtr<FJsonObject> InUserDetails);
+
+	UFUNCTION(BlueprintCallable, Category="Helika|Context")
+	void SetContextMatchMetadata(FHelikaContext Context, const FHelikaJsonObject& InMatchMetadata);
+	void SetContextMatchMetadata(FHelikaContext Context, TSharedPtr<FJsonObject> InMatchMetadata);
+
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void SendContextEvent(FHelikaContext Context, const FHelikaJsonObject& EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void SendContextEvents(FHelikaContext Context, TArray<FHelikaJsonObject> EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+
+	bool SendContextEvent(FHelikaContext Context, TSharedPtr<FJsonObject> EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	bool SendContextEvents(FHelikaContext Context, TArray<TSharedPtr<FJsonObject>> EventProps, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+
+	/// Registers an event type defined at runtime, e.g. by a data table. Its type, sub type and field names are encoded once,
+	/// sends by handle only supply the field values. Registering the same prototype again returns the same handle.
+	/// 
+	/// @param FieldNames fields of the 'event' object, in the order the values are passed
+	/// @return handle to the prototype, invalid if a field name is empty, repeated or one the SDK fills in (session_id, user_id, ...)
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	FHelikaEventPrototype RegisterEventPrototype(const FString& EventType, const FString& EventSubType, const TArray<FString>& FieldNames);
+
+	/// Sends an event of the prototype like SendEvent, Values holds one value per field in the order of registration
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void SendPrototypeEvent(FHelikaEventPrototype Prototype, const TArray<FHelikaJsonValue>& Values, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void SendUserPrototypeEvent(FHelikaEventPrototype Prototype, const TArray<FHelikaJsonValue>& Values, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	UFUNCTION(BlueprintCallable, Category="Helika|Events")
+	void SendContextPrototypeEvent(FHelikaContext Context, FHelikaEventPrototype Prototype, const TArray<FHelikaJsonValue>& Values, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+
+	/// SendPrototypeEvent with the values taken from the members of any Blueprint struct, in declaration order
+	UFUNCTION(BlueprintCallable, CustomThunk, Category="Helika|Events", meta=(CustomStructureParam="Values"))
+	void SendPrototypeEventFromStruct(FHelikaEventPrototype Prototype, const int32& Values, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	DECLARE_FUNCTION(execSendPrototypeEventFromStruct);
+
+	bool SendPrototypeEvent(FHelikaEventPrototype Prototype, TArray<TSharedPtr<FJsonValue>> Values, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	bool SendUserPrototypeEvent(FHelikaEventPrototype Prototype, TArray<TSharedPtr<FJsonValue>> Values, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	bool SendContextPrototypeEvent(FHelikaContext Context, FHelikaEventPrototype Prototype, TArray<TSharedPtr<FJsonValue>> Values, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+	bool SendPrototypeEventFromStruct(FHelikaEventPrototype Prototype, const UScriptStruct* Struct, const void* StructData, EHelikaPriority Priority = EHelikaPriority::HP_Normal);
+
+	// Set weather to print events to console or not
+	UFUNCTION(BlueprintCallable, Category="Helika")
+	void SetPrintToConsole(bool bInPrintEventsToConsole);
+
+	/// Publishes a new configuration snapshot, call it after changing UHelikaSettings from code.
+	/// Changes made in the editor settings panel are picked up automatically.
+	UFUNCTION(BlueprintCallable, Category="Helika")
+	void RefreshSettings();
+
+	UFUNCTION(BlueprintCallable, Category = "Helika")
+	bool IsSDKInitialized();
+
+	UFUNCTION(BlueprintCallable, Category = "Helika")
+	FString GetSessionId() const;
+
+	TSharedPtr<FJsonObject> GetUserDetails();
+	void SetUserDetails(TSharedPtr<FJsonObject> InUserDetails, bool bCreateNewAnonId = false);
+
+	UFUNCTION(BlueprintPure, Category="Helika")
+	FHelikaJsonObject GetUserDetailsAsJson();
+	UFUNCTION(BlueprintCallable, Category="Helika")
+	void SetUserDetails(const FHelikaJsonObject& InUserDetails, bool bCreateNewAnonId = false);
+
+	TSharedPtr<FJsonObject> GetAppDetails();
+	void SetAppDetails(const TSharedPtr<FJsonObject>& InAppDetails);
+
+	UFUNCTION(BlueprintPure, Category="Helika")
+	FHelikaJsonObject GetAppDetailsAsJson();
+	UFUNCTION(BlueprintCallable, Category="Helika")
+	void SetAppDetails(const FHelikaJsonObject& InAppDetails);
+
+	/// Pipeline health counters, also shown by 'stat Helika' in builds with stats enabled
+	UFUNCTION(BlueprintPure, Category="Helika|Metrics")
+	FHelikaMetrics GetMetrics() const;
+
+	/// Current and peak bytes held by each part of the SDK, process wide
+	UFUNCTION(BlueprintPure, Category="Helika|Metrics")
+	FHelikaMemoryUsage GetMemoryUsage() const;
+
+	/// Restarts peak tracking from the current values, e.g. at the start of a match
+	UFUNCTION(BlueprintCallable, Category="Helika|Metrics")
+	void ResetMemoryPeaks();
+
+	/// Sets a gauge such as FPS, ping or memory use to its latest value. Safe from any thread, lock-free once the series exists.
+	/// Gauges, counters and histograms are uploaded as one summary event per GameMetricsIntervalSeconds instead of an event per value.
+	/// 
+	/// @param Name name of the series
+	/// @param Value latest value
+	/// @param Tags a few dimensions of the series, e.g. map or platform, every combination is its own series
+	UFUNCTION(BlueprintCallable, Category="Helika|GameMetrics", meta=(AutoCreateRefTerm="Tags"))
+	void SetGauge(const FString& Name, double Value, const TMap<FString, FString>& Tags);
+
+	/// Adds Delta to a counter, the summary reports the sum of the interval
+	UFUNCTION(BlueprintCallable, Category="Helika|GameMetrics", meta=(AutoCreateRefTerm="Tags"))
+	void IncrementCounter(const FString& Name, double Delta, const TMap<FString, FString>& Tags);
+
+	/// Adds a value to a histogram, the summary reports quantiles within GameMetricsRelativeAccuracy and mergeable bins
+	UFUNCTION(BlueprintCallable, Category="Helika|GameMetrics", meta=(AutoCreateRefTerm="Tags"))
+	void RecordHistogram(const FString& Name, double Value, const TMap<FString, FString>& Tags);
+
+	UFUNCTION(BlueprintPure, Category="Helika")
+	bool GetPIITracking() const;
+	UFUNCTION(BlueprintCallable, Category="Helika")
+	void SetPIITracking(bool bInPiiTracking, bool bSendPiiTrackingEvent = false);
+	
+protected:
+	FString SessionId;
+	bool bIsInitialized = false;
+
+	bool bPiiTracking = false;
+	FString AnonymousId;
+
+	TSharedPtr<FJsonObject> AppDetails;
+	TSharedPtr<FJsonObject> UserDetails;
+
+	/// Immutable view of settings, app details and user details read by the send path without locking.
+	/// Setters publish a new version, queued events keep the version they were captured under.
+	THelikaAtomicSnapshot<FHelikaConfigSnapshot> Config;
+	uint32 ConfigVersion = 0;
+	FDelegateHandle SettingsChangedHandle;
+
+	TMap<int32, TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe>> Contexts;
+	mutable FRWLock ContextsLock;
+	int32 NextContextId = 0;
+
+	/// Registered event prototypes, a handle is an index
+	TArray<TSharedPtr<const FHelikaEventTemplate, ESPMode::ThreadSafe>> EventTemplates;
+	mutable FRWLock EventTemplatesLock;
+	int64 EventTemplatesMemoryBytes = 0;
+
+	/// Estimated bytes of this manager's contexts (guarded by ContextsLock) and published configuration
+	int64 ContextsMemoryBytes = 0;
+	int64 ConfigMemoryBytes = 0;
+
+	/// One upload lane per EHelikaPriority
+	TSharedPtr<FHelikaLane, ESPMode::ThreadSafe> Lanes[static_cast<int32>(EHelikaPriority::Count)];
+	FTSTicker::FDelegateHandle FlushTickerHandle;
+
+	/// Offline detection and controlled drain shared by every lane
+	TSharedPtr<FHelikaConnectivity, ESPMode::ThreadSafe> Connectivity;
+	/// Batches written to disk while offline
+	TSharedPtr<FHelikaSpillStore, ESPMode::ThreadSafe> SpillStore;
+
+	/// HTTP client of the uploads and probes, replaced by PublishConfig when its settings change
+	TSharedPtr<FHelikaTrackedTransport, ESPMode::ThreadSafe> Transport;
+	/// Replaced transports, ticked until their requests in flight completed
+	TArray<TSharedRef<FHelikaTrackedTransport, ESPMode::ThreadSafe>> RetiredTransports;
+
+	/// Deferred SDK work, run by its own ticker every frame under GameThreadBudgetMicroseconds
+	TSharedPtr<FHelikaScheduler, ESPMode::ThreadSafe> Scheduler;
+	FTSTicker::FDelegateHandle SchedulerTickerHandle;
+	/// Game thread only, an upload of spilled batches is already scheduled
+	bool bSpillDrainScheduled = false;
+
+	/// When the previous game metrics summary was enqueued
+	double LastGameMetricsTime = 0.0;
+
+private:
+	/// Enriches JsonObject in place, the send functions pass a copy of the caller's event
+	TSharedPtr<FJsonObject> AppendAttributesToJsonObject(TSharedPtr<FJsonObject> JsonObject, bool bIsUserEvent, const FHelikaContextData& Context, const FHelikaConfigSnapshot& InConfig);
+	/// Replaces every event by an enriched copy, on the task graph workers from BatchLimits.ParallelThreshold events on
+	void EnrichEvents(TArrayView<TSharedPtr<FJsonObject>> Events, bool bIsUserEvent, const FHelikaContextData& Context, const FHelikaConfigSnapshot& InConfig);
+	void EnqueueEvent(const TSharedPtr<FJsonObject>& Event, const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe>& Context, const TSharedPtr<const FHelikaConfigSnapshot, ESPMode::ThreadSafe>& InConfig, bool bIsUserEvent, EHelikaPriority Priority,
+		const TSharedPtr<FHelikaDelivery, ESPMode::ThreadSafe>& Delivery = nullptr);
+	/// Queues the event on the lane of Priority (already resolved) and sheds or schedules a flush as needed
+	void EnqueueToLane(FHelikaQueuedEvent&& QueuedEvent, const FHelikaConfigSnapshot& InConfig, EHelikaPriority Priority);
+	/// Common part of the prototype sends, Context is the default context or a player context
+	bool EnqueuePrototypeEvent(FHelikaEventPrototype Prototype, TArray<TSharedPtr<FJsonValue>>&& Values, const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe>& Context,
+		const TSharedPtr<const FHelikaConfigSnapshot, ESPMode::ThreadSafe>& InConfig, EHelikaRecordedSend Send, EHelikaPriority Priority);
+	static bool IsSampledOut(const FHelikaConfigSnapshot& InConfig);
+	bool HandleFlushTick(float DeltaTime);
+	bool HandleSchedulerTick(float DeltaTime);
+	void PublishConfig();
+	void RegisterFlushTicker(float IntervalSeconds);
+	TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe> FindContext(FHelikaContext Context) const;
+	void UpdateContext(FHelikaContext Context, TFunctionRef<void(FHelikaContextData&)> Update);
+	void AddContextsMemory(int64 Delta);
+	void CreateContextSession(const TSharedPtr<const FHelikaContextData, ESPMode::ThreadSafe>& Context, const TSharedPtr<const FHelikaConfigSnapshot, ESPMode::ThreadSafe>& InConfig);
+	void CreateSession();
+	/// Uploads the lane in batches, stops early when bRespectBackoff and the lane is backing off.
+	/// With bWithinBudget it returns false once the scheduler's budget is spent, the rest is uploaded in a later frame.
+	/// Delivery, when set, gets a pending item per upload (or spill) of this flush.
+	bool FlushLane(const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane, const FHelikaConfigSnapshot& InConfig, bool bRespectBackoff, bool bWithinBudget = false,
+		const TSharedPtr<FHelikaDelivery, ESPMode::ThreadSafe>& Delivery = nullptr);
+	/// Schedules a flush of the lane unless one is pending
+	void ScheduleLaneFlush(const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane);
+	/// Dequeues the next envelope of the lane within the byte budget, false once the lane is empty. OutEvents may be empty when every event was too large.
+	bool BuildEnvelope(FHelikaLane& Lane, const FHelikaConfigSnapshot& InConfig, TArray<FHelikaQueuedEvent>& OutEvents, TArray<uint8>& OutPayload);
+	/// Serializes queued batches of the lane to the spill store, only full ones unless bIncludePartialBatch
+	void SpillLane(FHelikaLane& Lane, const FHelikaConfigSnapshot& InConfig, bool bIncludePartialBatch);
+	/// Applies platform hints and sends the probes while offline, returns whether spilled batches may be uploaded
+	bool UpdateConnectivity(const FHelikaConfigSnapshot& InConfig, double Now);
+	/// Scheduled work uploading spilled batches within MaxDrainRequests, false when the budget ran out first
+	bool DrainSpillStore(const FHelikaConfigSnapshot& InConfig);
+	void SendHTTPPost(const FString& Url, TArray<uint8>&& Payload, TArray<FHelikaQueuedEvent>&& Events, const TSharedPtr<FHelikaLane, ESPMode::ThreadSafe>& Lane,
+		const TSharedPtr<FHelikaDelivery, ESPMode::ThreadSafe>& Delivery = nullptr) const;
+	void SendSpilledBatch(FHelikaSpilledBatch&& Batch, TArray<uint8>&& Payload, const FHelikaConfigSnapshot& InConfig) const;
+	/// Enqueues the summary of the game metrics recorded since the previous one, split when it would exceed MaxEventKilobytes
+	void SendGameMetrics(const TSharedPtr<const FHelikaConfigSnapshot, ESPMode::ThreadSafe>& InConfig, double IntervalSeconds);
+	static void ProcessEventTrackResponse(const FHelikaTransportResponse& Response, bool bPrintEventsToConsole);
+	static void EndSession(bool bIsSimulating);
+
+	FString GenerateAnonymousId(FString Seed, bool bCreateNewAnonId = false);
+
+	TSharedPtr<FJsonObject> GetTemplateEvent(const FString& EventType, const FString& EventSubType, const FHelikaContextData& Context, const FHelikaConfigSnapshot& InConfig) const;
+	void AppendPIITracking(const TSharedPtr<FJsonObject>& GameEvent);
+};
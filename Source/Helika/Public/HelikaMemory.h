@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaMemory.generated.h"
+
+/// Parts of the SDK whose memory is accounted separately, each one is also a 'Helika/...' LLM tag
+UENUM(BlueprintType)
+enum class EHelikaMemoryTag : uint8
+{
+	/// Events waiting for the next flush
+	IngestQueue,
+	/// Player contexts, event prototypes and the published configuration
+	Contexts,
+	/// Batch payloads and per-batch blocks while being serialized
+	Serialization,
+	/// Gzip output buffers
+	Compression,
+	/// Request bodies owned by the HTTP module until the request completes
+	HttpBodies,
+
+	Count UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType)
+struct HELIKA_API FHelikaMemoryTagUsage
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	EHelikaMemoryTag Tag = EHelikaMemoryTag::IngestQueue;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 CurrentBytes = 0;
+
+	/// Highest value since the process started or the last UHelikaManager::ResetMemoryPeaks
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 PeakBytes = 0;
+};
+
+/// Memory held by the SDK, process wide like FHelikaMetrics.
+/// Buffers are counted exactly, json trees of queued events and contexts are estimated.
+USTRUCT(BlueprintType)
+struct HELIKA_API FHelikaMemoryUsage
+{
+	GENERATED_BODY()
+
+	/// One entry per EHelikaMemoryTag, in enum order
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	TArray<FHelikaMemoryTagUsage> Tags;
+
+	/// Sum of the current bytes of every tag
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 TotalBytes = 0;
+
+	const FHelikaMemoryTagUsage& Get(EHelikaMemoryTag Tag) const { return Tags[static_cast<int32>(Tag)]; }
+};
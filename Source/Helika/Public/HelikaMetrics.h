@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HelikaMetrics.generated.h"
+
+/// Health counters of the event pipeline, totals since the process started.
+/// Counters are shared by every UHelikaManager instance of the process.
+USTRUCT(BlueprintType)
+struct HELIKA_API FHelikaMetrics
+{
+	GENERATED_BODY()
+
+	/// Events that passed validation, including the ones sampled out afterwards
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsAccepted = 0;
+
+	/// Accepted events discarded by UHelikaSettings::EventSampleRate
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsSampledOut = 0;
+
+	/// Events refused by validation or because the SDK was not initialized
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsRejected = 0;
+
+	/// Events added to the upload queue, SDK generated session events included
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsQueued = 0;
+
+	/// Events the collector acknowledged as stored
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsSent = 0;
+
+	/// Events refused by the collector as invalid, that failed transiently more than MaxEventRetries times or too large to upload
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsDropped = 0;
+
+	/// Events discarded because their lane held more than its MaxQueuedEvents or the spill directory more than MaxSpillMegabytes
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsShed = 0;
+
+	/// Events written to the spill directory while the collector was unreachable
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsSpilled = 0;
+
+	/// Events over MaxEventKilobytes, truncated or dropped according to OversizedEventPolicy
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsOversized = 0;
+
+	/// Events left out by a Drop rule of EventRules
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 EventsFiltered = 0;
+
+	/// Events waiting in the queues right now
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 QueueDepth = 0;
+
+	/// Size of the serialized payloads handed to the transport
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 BytesBeforeCompression = 0;
+
+	/// Size of the request bodies actually uploaded
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 BytesAfterCompression = 0;
+
+	/// Request bodies submitted and not completed yet
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 BytesInFlight = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 RequestsSent = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 RequestsSucceeded = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 RequestsFailed = 0;
+
+	/// Events queued again after a transient failure
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 Retries = 0;
+
+	/// Frames in which the SDK used more game thread time than GameThreadBudgetMicroseconds
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 BudgetOverruns = 0;
+
+	/// Frames in which deferred SDK work waited because the frame was over its target or the budget was spent
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	int64 WorkDeferrals = 0;
+
+	/// Upper bound in milliseconds of each latency bucket, the last bucket is unbounded
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	TArray<float> RequestLatencyBucketsMs;
+
+	/// Number of completed requests per latency bucket
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	TArray<int64> RequestLatencyHistogram;
+
+	/// Game thread time spent inside UHelikaManager during the last completed frame
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	float GameThreadMsLastFrame = 0.f;
+
+	/// Highest per-frame game thread time observed so far
+	UPROPERTY(BlueprintReadOnly, Category = "Helika|Metrics")
+	float GameThreadMsPeak = 0.f;
+};
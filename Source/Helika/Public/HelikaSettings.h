@@ -1,47 +1,293 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-#include "HelikaTypes.h"
-#include "HelikaSettings.generated.h"
-/**
- * 
- */
-UCLASS(Config = Engine, DefaultConfig)
-class HELIKA_API UHelikaSettings : public UObject
-{
-	GENERATED_BODY()
-
-public:
-	/// Helika API key received from the dashboard
-	UPROPERTY(Config, EditAnywhere, Category = "Helika")
-	FString HelikaAPIKey;
-
-	/// Game ID
-	UPROPERTY(Config, EditAnywhere, Category = "Helika")
-	FString GameId;
-
-	/// Player ID
-	UPROPERTY(Config, EditAnywhere, Category = "Helika")
-	FString PlayerId;
-
-	/// Helika environment to be used while sending API calls
-	UPROPERTY(Config, EditAnywhere, Category = "Helika")
-	EHelikaEnvironment HelikaEnvironment = EHelikaEnvironment::HE_Localhost;
-
-	/// Telemetry level, Allows to send selective data based on telemetry level
-	UPROPERTY(Config, EditAnywhere, Category = "Helika")
-	ETelemetryLevel Telemetry = ETelemetryLevel::TL_None;
-
-	/// Print Events to console
-	UPROPERTY(Config, EditAnywhere, Category = "Helika")
-	bool bPrintEventsToConsole = true;
-
-	UPROPERTY(Config, VisibleAnywhere, Category = "Helika")
-	FString SDKName = "Unreal";
-	
-	UPROPERTY(Config, VisibleAnywhere, Category = "Helika")
-	FString SDKVersion = "0.4.0";
-
-	UPROPERTY(Config, VisibleAnywhere, Category = "Helika")
-	FString SDKClass = "HelikaSubsystem";
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+#include "HelikaTypes.h"
+#include "HelikaSettings.generated.h"
+
+/// Batching, retries, shedding and backoff of one EHelikaPriority lane
+USTRUCT(BlueprintType)
+struct HELIKA_API FHelikaLaneSettings
+{
+	GENERATED_BODY()
+
+	FHelikaLaneSettings() = default;
+	FHelikaLaneSettings(int32 InMaxBatchSize, float InFlushIntervalSeconds, int32 InMaxEventRetries, int32 InMaxQueuedEvents, float InMaxBackoffSeconds)
+		: MaxBatchSize(InMaxBatchSize)
+		, FlushIntervalSeconds(InFlushIntervalSeconds)
+		, MaxEventRetries(InMaxEventRetries)
+		, MaxQueuedEvents(InMaxQueuedEvents)
+		, MaxBackoffSeconds(InMaxBackoffSeconds)
+	{
+	}
+
+	/// Maximum number of events of the lane uploaded in a single request, reaching it triggers a flush of the lane
+	UPROPERTY(EditAnywhere, Category = "Helika|Lanes", meta = (ClampMin = 1))
+	int32 MaxBatchSize = 100;
+
+	/// Longest time in seconds an event waits in the lane before it is uploaded
+	UPROPERTY(EditAnywhere, Category = "Helika|Lanes", meta = (ClampMin = 0.0))
+	float FlushIntervalSeconds = 1.0f;
+
+	/// Times an event that failed transiently is queued again before being dropped
+	UPROPERTY(EditAnywhere, Category = "Helika|Lanes", meta = (ClampMin = 0))
+	int32 MaxEventRetries = 3;
+
+	/// Events queued beyond this are shed oldest first, 0 keeps every event
+	UPROPERTY(EditAnywhere, Category = "Helika|Lanes", meta = (ClampMin = 0))
+	int32 MaxQueuedEvents = 0;
+
+	/// Longest pause in seconds after consecutive transient failures, a Retry-After from the collector wins
+	UPROPERTY(EditAnywhere, Category = "Helika|Lanes", meta = (ClampMin = 0.0))
+	float MaxBackoffSeconds = 60.0f;
+};
+
+/// One entry of UHelikaSettings::EventRules
+USTRUCT(BlueprintType)
+struct HELIKA_API FHelikaEventRule
+{
+	GENERATED_BODY()
+
+	/// event_type of the matched events, empty matches every type
+	UPROPERTY(EditAnywhere, Category = "Helika|Rules")
+	FString EventType;
+
+	/// event.event_sub_type of the matched events, empty matches every sub type
+	UPROPERTY(EditAnywhere, Category = "Helika|Rules")
+	FString EventSubType;
+
+	UPROPERTY(EditAnywhere, Category = "Helika|Rules")
+	EHelikaEventRuleAction Action = EHelikaEventRuleAction::HER_RemoveField;
+
+	/// Dot separated path of the field from the top of the event, e.g. "event.email". Arrays of objects are looked through. Unused by Drop.
+	UPROPERTY(EditAnywhere, Category = "Helika|Rules")
+	FString FieldPath;
+
+	/// Name the field is written under by Rename
+	UPROPERTY(EditAnywhere, Category = "Helika|Rules")
+	FString NewName;
+
+	/// Characters kept by Truncate
+	UPROPERTY(EditAnywhere, Category = "Helika|Rules", meta = (ClampMin = 0))
+	int32 MaxLength = 64;
+
+	/// The rule is only compiled into Shipping builds, e.g. to drop debug-only event types
+	UPROPERTY(EditAnywhere, Category = "Helika|Rules")
+	bool bShippingOnly = false;
+};
+
+/**
+ * 
+ */
+UCLASS(Config = Engine, DefaultConfig)
+class HELIKA_API UHelikaSettings : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/// Helika API key received from the dashboard
+	UPROPERTY(Config, EditAnywhere, Category = "Helika")
+	FString HelikaAPIKey;
+
+	/// Game ID
+	UPROPERTY(Config, EditAnywhere, Category = "Helika")
+	FString GameId;
+
+	/// Player ID
+	UPROPERTY(Config, EditAnywhere, Category = "Helika")
+	FString PlayerId;
+
+	/// Helika environment to be used while sending API calls
+	UPROPERTY(Config, EditAnywhere, Category = "Helika")
+	EHelikaEnvironment HelikaEnvironment = EHelikaEnvironment::HE_Localhost;
+
+	/// Telemetry level, Allows to send selective data based on telemetry level
+	UPROPERTY(Config, EditAnywhere, Category = "Helika")
+	ETelemetryLevel Telemetry = ETelemetryLevel::TL_None;
+
+	/// Print Events to console
+	UPROPERTY(Config, EditAnywhere, Category = "Helika")
+	bool bPrintEventsToConsole = true;
+
+	/// Destination of the printed events, formatting and writing happen on a background thread
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Debug")
+	EHelikaDebugOutput DebugOutput = EHelikaDebugOutput::HDO_Log;
+
+	/// Printed payloads and responses per second, the rest is counted and reported as suppressed
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Debug", meta = (ClampMin = 1))
+	int32 DebugMaxEntriesPerSecond = 10;
+
+	/// Printed bytes per payload or response, longer ones are truncated
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Debug", meta = (ClampMin = 256))
+	int32 DebugMaxEntryBytes = 4096;
+
+	/// Payloads and responses kept in memory for the 'Helika.DumpEvents' console command
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Debug", meta = (ClampMin = 0))
+	int32 DebugHistorySize = 50;
+
+	/// Upload to the local mock collector (-run=HelikaMockCollector) instead of only printing when the environment is Localhost
+	UPROPERTY(Config, EditAnywhere, Category = "Helika")
+	bool bUploadOnLocalhost = false;
+
+	/// Maximum number of events uploaded in a single request, reaching it triggers a flush
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 1))
+	int32 MaxBatchSize = 100;
+
+	/// Interval in seconds at which queued Normal priority events are uploaded
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 0.0))
+	float FlushIntervalSeconds = 1.0f;
+
+	/// Largest request body in kilobytes before compression, batches are cut once the next event would exceed it
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 1))
+	int32 MaxBatchKilobytes = 1024;
+
+	/// Largest request body in kilobytes after compression when bCompressPayloads is set, estimated from the recent compression ratio
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 1))
+	int32 MaxCompressedBatchKilobytes = 256;
+
+	/// Hard cap in kilobytes of a single encoded event, larger ones are handled by OversizedEventPolicy
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 1))
+	int32 MaxEventKilobytes = 64;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching")
+	EHelikaOversizedEventPolicy OversizedEventPolicy = EHelikaOversizedEventPolicy::HOE_Truncate;
+
+	/// SendEvents calls and envelopes with at least this many events are enriched and encoded on the task graph workers, 0 keeps everything on the calling thread
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 0))
+	int32 ParallelSerializationThreshold = 1024;
+
+	/// Fraction of the game's events that are uploaded, SDK session events are always kept
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float EventSampleRate = 1.0f;
+
+	/// Times a Normal priority event that failed transiently (connection error, 408, 429, 5xx or a retryable rejection) is queued again before being dropped
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 0))
+	int32 MaxEventRetries = 3;
+
+	/// Normal priority events queued beyond this are shed oldest first, 0 keeps every event
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 0))
+	int32 MaxQueuedEvents = 0;
+
+	/// Longest pause in seconds of the Normal lane after consecutive transient failures, a Retry-After from the collector wins
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching", meta = (ClampMin = 0.0))
+	float MaxBackoffSeconds = 60.0f;
+
+	/// Lane of Critical events, they are uploaded quickly, retried longer and never shed
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Lanes")
+	FHelikaLaneSettings CriticalLane = FHelikaLaneSettings(20, 0.1f, 10, 0, 5.0f);
+
+	/// Lane of Bulk telemetry, batched longer and shed first when it piles up
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Lanes")
+	FHelikaLaneSettings BulkLane = FHelikaLaneSettings(500, 10.0f, 1, 10000, 120.0f);
+
+	/// Events sent with Normal priority whose event_type is listed here go to the listed lane instead
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Lanes")
+	TMap<FString, EHelikaPriority> EventTypePriorities = {{TEXT("purchase"), EHelikaPriority::HP_Critical}, {TEXT("login"), EHelikaPriority::HP_Critical}};
+
+	/// Uploads that got no answer at all in a row before the collector is considered unreachable and uploads stop
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Connectivity", meta = (ClampMin = 1))
+	int32 OfflineAfterFailures = 3;
+
+	/// Seconds between reachability probes while offline, doubled after every unanswered probe up to MaxProbeIntervalSeconds
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Connectivity", meta = (ClampMin = 0.1))
+	float ProbeIntervalSeconds = 2.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Connectivity", meta = (ClampMin = 0.1))
+	float MaxProbeIntervalSeconds = 60.0f;
+
+	/// Requests in flight while the backlog is uploaded after the collector became reachable again
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Connectivity", meta = (ClampMin = 1))
+	int32 MaxDrainRequests = 2;
+
+	/// Go offline as soon as the platform reports no network connection (airplane mode, no interface), where it can tell
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Connectivity")
+	bool bUseConnectivityHints = true;
+
+	/// Write full batches to Saved/Helika/Spill while offline so the backlog neither grows in memory nor is lost on exit
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Connectivity")
+	bool bSpillWhileOffline = true;
+
+	/// Disk used by spilled batches, the oldest ones are deleted beyond it
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Connectivity", meta = (ClampMin = 1))
+	int32 MaxSpillMegabytes = 32;
+
+	/// Game thread time per frame for the SDK work that is not capture (flushes, session events, summaries), work beyond it waits for later frames
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Scheduling", meta = (ClampMin = 0))
+	int32 GameThreadBudgetMicroseconds = 500;
+
+	/// Deferred SDK work waits while the frame already took longer than this, 0 follows t.MaxFPS and never waits without a frame rate limit
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Scheduling", meta = (ClampMin = 0.0))
+	float FrameTargetMs = 0.0f;
+
+	/// Longest time deferred SDK work waits for a frame with budget left, then it runs anyway
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Scheduling", meta = (ClampMin = 0.0))
+	float MaxDeferralSeconds = 0.5f;
+
+	/// Record the gauges, counters and histograms of the game and upload one summary event per GameMetricsIntervalSeconds
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|GameMetrics")
+	bool bEnableGameMetrics = true;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|GameMetrics", meta = (ClampMin = 1.0))
+	float GameMetricsIntervalSeconds = 60.0f;
+
+	/// Relative error of the histogram quantiles, 0.01 reports p99 of 100 ms as 99 to 101 ms
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|GameMetrics", meta = (ClampMin = 0.0001, ClampMax = 0.2))
+	float GameMetricsRelativeAccuracy = 0.01f;
+
+	/// Bins of each histogram series, 4 bytes each. More bins cover a wider value range at the same accuracy.
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|GameMetrics", meta = (ClampMin = 16))
+	int32 GameMetricsHistogramBins = 2048;
+
+	/// Distinct name and tags combinations, values of further series are ignored
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|GameMetrics", meta = (ClampMin = 1))
+	int32 MaxGameMetricSeries = 256;
+
+	/// HTTP client of the uploads and probes, takes effect for requests sent after the change
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Transport")
+	EHelikaTransport Transport = EHelikaTransport::HT_HttpModule;
+
+	/// Connections per host of the Curl transport, HTTP/2 multiplexes the requests over them
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Transport", meta = (ClampMin = 1))
+	int32 TransportMaxConnections = 4;
+
+	/// Time an upload may take before it counts as unanswered, 0 keeps the client's default
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Transport", meta = (ClampMin = 0.0))
+	float TransportTimeoutSeconds = 30.0f;
+
+	/// Unix domain socket of the aggregator used by the Sidecar transport, empty for $XDG_RUNTIME_DIR/helika-aggregator.sock
+	/// or Saved/Helika/Sidecar/aggregator.sock. Only an aggregator run by the same user is used.
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Transport")
+	FString SidecarSocketPath;
+
+	/// Gzip the request bodies before upload
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching")
+	bool bCompressPayloads = false;
+
+	/// Send batches column by column, with repeated values written once, when that is smaller than the row JSON. The collector has to accept the x-helika-batch-format: columnar header.
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Batching")
+	bool bColumnarPayloads = false;
+
+	/// Drop, remove, hash, rename or truncate rules applied while events are serialized for upload. Events that no rule matches are written untouched.
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Rules")
+	TArray<FHelikaEventRule> EventRules;
+
+	/// Secret of this project keying the Hash Field rules (HMAC-SHA256), so that hashed emails or ids cannot be looked up in a dictionary.
+	/// Keep it out of source control and the same across builds that should produce matching digests. Empty falls back to GameId.
+	UPROPERTY(Config, EditAnywhere, Category = "Helika|Rules")
+	FString EventRuleHashSalt;
+
+	UPROPERTY(Config, VisibleAnywhere, Category = "Helika")
+	FString SDKName = "Unreal";
+	
+	UPROPERTY(Config, VisibleAnywhere, Category = "Helika")
+	FString SDKVersion = "0.4.0";
+
+	UPROPERTY(Config, VisibleAnywhere, Category = "Helika")
+	FString SDKClass = "HelikaSubsystem";
+
+	/// Broadcast when the settings are edited so the manager can publish a new configuration snapshot
+	FSimpleMulticastDelegate OnSettingsChanged;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+};
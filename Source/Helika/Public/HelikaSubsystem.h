@@ -1,28 +1,28 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Subsystems/EngineSubsystem.h"
-#include "HelikaSubsystem.generated.h"
-class UHelikaManager;
-/**
- * 
- */
-UCLASS()
-class HELIKA_API UHelikaSubsystem : public UEngineSubsystem
-{
-	GENERATED_BODY()
-
-public:
-	UHelikaSubsystem();
-
-	// Begin USubsystem
-	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
-	virtual void Deinitialize() override;
-	// End USubsystem
-
-	UFUNCTION(BlueprintCallable, Category="Helika")
-	UHelikaManager* GetHelikaManager();
-	
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "HelikaSubsystem.generated.h"
+class UHelikaManager;
+/**
+ * 
+ */
+UCLASS()
+class HELIKA_API UHelikaSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UHelikaSubsystem();
+
+	// Begin USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem
+
+	UFUNCTION(BlueprintCallable, Category="Helika")
+	UHelikaManager* GetHelikaManager();
+	
+};
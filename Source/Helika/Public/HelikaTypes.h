@@ -1,38 +1,136 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-
-/// Helika API Environment
-UENUM(BlueprintType)
-enum class EHelikaEnvironment : uint8
-{
-	HE_Localhost UMETA(DisplayName = "Localhost"),
-	HE_Develop UMETA(DisplayName = "Develop"),
-	HE_Production UMETA(DisplayName = "Production")
-};
-
-/// Helika Telemetry Level. Weather to send complete device details or not
-UENUM(BlueprintType)
-enum class ETelemetryLevel : uint8
-{
-	TL_None = 0 UMETA(DisplayName = "None"),
-	TL_TelemetryOnly = 100 UMETA(DisplayName = "TelemetryOnly"),
-	TL_All = 200 UMETA(DisplayName = "All"),
-};
-
-/// Platform Type
-UENUM(BlueprintType)
-enum class EPlatformType : uint8
-{
-	PT_DEFAULT UMETA(DisplayName = "Default"),
-	PT_WINDOWS UMETA(DisplayName = "Windows"),
-	PT_MAC UMETA(DisplayName = "Mac"),
-	PT_LINUX UMETA(DisplayName = "Linux"),
-	PT_IOS UMETA(DisplayName = "IOS"),
-	PT_ANDROID UMETA(DisplayName = "Android"),
-	PT_CONSOLE UMETA(DisplayName = "Console"),
-	PT_UNKNOWN UMETA(DisplayName = "Unknown")
-};
-
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// Helika API Environment
+UENUM(BlueprintType)
+enum class EHelikaEnvironment : uint8
+{
+	HE_Localhost UMETA(DisplayName = "Localhost"),
+	HE_Develop UMETA(DisplayName = "Develop"),
+	HE_Production UMETA(DisplayName = "Production")
+};
+
+/// Helika Telemetry Level. Weather to send complete device details or not
+UENUM(BlueprintType)
+enum class ETelemetryLevel : uint8
+{
+	TL_None = 0 UMETA(DisplayName = "None"),
+	TL_TelemetryOnly = 100 UMETA(DisplayName = "TelemetryOnly"),
+	TL_All = 200 UMETA(DisplayName = "All"),
+};
+
+/// Upload lane of an event, every lane has its own batching, flush age, retries, shedding and backoff
+UENUM(BlueprintType)
+enum class EHelikaPriority : uint8
+{
+	/// Business critical events (purchases, logins, sessions), uploaded within a short bounded delay and never shed
+	HP_Critical UMETA(DisplayName = "Critical"),
+	HP_Normal UMETA(DisplayName = "Normal"),
+	/// High volume telemetry, batched longer and shed first
+	HP_Bulk UMETA(DisplayName = "Bulk"),
+	Count UMETA(Hidden)
+};
+
+/// What happens to an event whose encoded size is over MaxEventKilobytes
+UENUM(BlueprintType)
+enum class EHelikaOversizedEventPolicy : uint8
+{
+	/// The largest values of the event are cut or removed until it fits, the event is marked "truncated"
+	HOE_Truncate UMETA(DisplayName = "Truncate"),
+	HOE_Reject UMETA(DisplayName = "Reject")
+};
+
+/// What an EventRules entry does to the events it matches
+UENUM(BlueprintType)
+enum class EHelikaEventRuleAction : uint8
+{
+	/// The event is not uploaded
+	HER_Drop UMETA(DisplayName = "Drop Event"),
+	HER_RemoveField UMETA(DisplayName = "Remove Field"),
+	/// The value is replaced by the hex HMAC-SHA256, keyed by EventRuleHashSalt, of its text (strings) or of its JSON (anything else)
+	HER_HashField UMETA(DisplayName = "Hash Field"),
+	/// The field keeps its value under NewName, unless the object already has a field of that name
+	HER_RenameField UMETA(DisplayName = "Rename Field"),
+	/// Strings longer than MaxLength characters are cut
+	HER_TruncateField UMETA(DisplayName = "Truncate Field")
+};
+
+/// Reachability of the collector as seen by the upload scheduler
+UENUM(BlueprintType)
+enum class EHelikaConnectivity : uint8
+{
+	HC_Online UMETA(DisplayName = "Online"),
+	/// Uploads are stopped, events accumulate and full batches are spilled to disk until a probe gets an answer
+	HC_Offline UMETA(DisplayName = "Offline"),
+	/// The collector answered again, the backlog is uploaded with a bounded number of requests in flight
+	HC_Draining UMETA(DisplayName = "Draining")
+};
+
+/// Final outcome of an event (or of a flush) reported to the Blueprint async nodes
+UENUM(BlueprintType)
+enum class EHelikaDeliveryResult : uint8
+{
+	/// Stored by the collector
+	HD_Delivered UMETA(DisplayName = "Delivered"),
+	/// Refused by the SDK (not initialized, malformed, over MaxEventKilobytes) or by the collector, sending it again cannot succeed
+	HD_Invalid UMETA(DisplayName = "Invalid"),
+	/// Left out by EventSampleRate
+	HD_SampledOut UMETA(DisplayName = "Sampled Out"),
+	/// Dropped because its lane was over MaxQueuedEvents
+	HD_Shed UMETA(DisplayName = "Shed"),
+	/// Failed transiently more than MaxEventRetries times
+	HD_OutOfRetries UMETA(DisplayName = "Out of Retries"),
+	/// Failed transiently and queued again, only reported for a flush
+	HD_Requeued UMETA(DisplayName = "Requeued"),
+	/// Written to disk while the collector is unreachable, it is uploaded once it answers again
+	HD_Spilled UMETA(DisplayName = "Spilled"),
+	/// Only printed because telemetry is off
+	HD_NotUploaded UMETA(DisplayName = "Not Uploaded"),
+	/// Discarded before it could be uploaded, e.g. at shutdown
+	HD_Dropped UMETA(DisplayName = "Dropped"),
+	/// Left out by a Drop rule of EventRules
+	HD_Filtered UMETA(DisplayName = "Filtered"),
+	/// Accepted into its lane, the outcome is still pending. Only passed to OnQueued, never a settled result
+	HD_Queued UMETA(DisplayName = "Queued")
+};
+
+/// Where the events printed by bPrintEventsToConsole are written
+UENUM(BlueprintType)
+enum class EHelikaDebugOutput : uint8
+{
+	HDO_Log UMETA(DisplayName = "Log"),
+	HDO_File UMETA(DisplayName = "File"),
+	HDO_LogAndFile UMETA(DisplayName = "Log and File")
+};
+
+/// HTTP client used for uploads and probes
+UENUM(BlueprintType)
+enum class EHelikaTransport : uint8
+{
+	/// The engine's FHttpModule
+	HT_HttpModule UMETA(DisplayName = "Http Module"),
+	/// libcurl multi handle on its own I/O thread, falls back to Http Module where libcurl is not linked
+	HT_Curl UMETA(DisplayName = "Curl"),
+	/// Kept in memory and answered with 200 every frame, for tests
+	HT_InMemory UMETA(DisplayName = "In Memory"),
+	/// Frames written to the host-local aggregator (-run=HelikaAggregator) over a Unix domain socket, Linux only
+	HT_Sidecar UMETA(DisplayName = "Sidecar Aggregator")
+};
+
+/// Platform Type
+UENUM(BlueprintType)
+enum class EPlatformType : uint8
+{
+	PT_DEFAULT UMETA(DisplayName = "Default"),
+	PT_WINDOWS UMETA(DisplayName = "Windows"),
+	PT_MAC UMETA(DisplayName = "Mac"),
+	PT_LINUX UMETA(DisplayName = "Linux"),
+	PT_IOS UMETA(DisplayName = "IOS"),
+	PT_ANDROID UMETA(DisplayName = "Android"),
+	PT_CONSOLE UMETA(DisplayName = "Console"),
+	PT_UNKNOWN UMETA(DisplayName = "Unknown")
+};
+